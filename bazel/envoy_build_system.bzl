@@ -24,6 +24,14 @@ def envoy_copts(repository, test = False):
     }) + select({
         repository + "//bazel:disable_signal_trace": [],
         "//conditions:default": ["-DENVOY_HANDLE_SIGNALS"],
+    }) + select({
+        # USDT probes are opt-in since <sys/sdt.h> requires the systemtap SDT package.
+        repository + "//bazel:enable_usdt": ["-DENVOY_USDT_PROBES"],
+        "//conditions:default": [],
+    }) + select({
+        # Mutex contention tracing costs a try_lock() on every traced acquire, so it is opt-in.
+        repository + "//bazel:enable_mutex_tracing": ["-DENVOY_MUTEX_TRACING"],
+        "//conditions:default": [],
     }) + select({
         # TCLAP command line parser needs this to support int64_t/uint64_t
         "@bazel_tools//tools/osx:darwin": ["-DHAVE_LONG_LONG"],
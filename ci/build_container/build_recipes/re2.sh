@@ -0,0 +1,10 @@
+#!/bin/bash
+
+set -e
+
+VERSION=2017-07-01
+
+wget -O re2-"$VERSION".tar.gz https://github.com/google/re2/archive/"$VERSION".tar.gz
+tar xf re2-"$VERSION".tar.gz
+cd re2-"$VERSION"
+make CXXFLAGS="${CXXFLAGS} ${CPPFLAGS} -O2" prefix="$THIRDPARTY_BUILD" static-install
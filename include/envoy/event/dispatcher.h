@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/event/file_event.h"
 #include "envoy/event/signal.h"
 #include "envoy/event/timer.h"
@@ -33,6 +34,19 @@ class Dispatcher {
 public:
   virtual ~Dispatcher() {}
 
+  /**
+   * Returns an approximation of the current monotonic time, maintained by the dispatcher as the
+   * event loop runs instead of read from the clock on every call. Suitable for per-request
+   * timestamps and other hot path consumers that can tolerate coarse timer granularity
+   * staleness; use the real clocks where sub-iteration accuracy matters.
+   */
+  virtual MonotonicTime approximateMonotonicTime() const PURE;
+
+  /**
+   * @return the wall clock counterpart of approximateMonotonicTime().
+   */
+  virtual SystemTime approximateSystemTime() const PURE;
+
   /**
    * Clear any items in the deferred deletion queue.
    */
@@ -132,6 +146,16 @@ public:
    */
   virtual void exit() PURE;
 
+  /**
+   * Initialize stats for this dispatcher. This cannot be done at construction time since the
+   * owner may want to scope the stats (e.g. per worker). Once initialized the dispatcher
+   * periodically samples its own event loop scheduling delay (the difference between when a
+   * timer was due to fire and when it actually fired) into a histogram in the given scope,
+   * which is the best available proxy for thread saturation.
+   * @param scope supplies the scope that will contain the per-dispatcher stats.
+   */
+  virtual void initializeStats(Stats::Scope& scope) PURE;
+
   /**
    * Listen for a signal event. Only a single dispatcher in the process can listen for signals.
    * If more than one dispatcher calls this routine in the process the behavior is undefined.
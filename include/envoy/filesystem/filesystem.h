@@ -1,5 +1,7 @@
 #pragma once
 
+#include <sys/uio.h>
+
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -26,6 +28,12 @@ public:
    */
   virtual ssize_t write(int fd, const void* buffer, size_t num_bytes) PURE;
 
+  /**
+   * Write num_iov buffers described by iov to fd in a single system call.
+   * @return total number of bytes written if non negative, otherwise error code.
+   */
+  virtual ssize_t writev(int fd, const iovec* iov, int num_iov) PURE;
+
   /**
    * Release all resources allocated for fd.
    * @return zero on success, -1 returned otherwise.
@@ -40,13 +48,29 @@ typedef std::unique_ptr<OsSysCalls> OsSysCallsPtr;
  */
 class File {
 public:
+  /**
+   * Callback invoked when an asynchronous write completes.
+   * @param success supplies whether the data was handed to the operating system. false means the
+   *        file could not be opened and the data was dropped.
+   */
+  typedef std::function<void(bool success)> WriteCompletionCb;
+
   virtual ~File() {}
 
   /**
-   * Write data to the file.
+   * Write data to the file. The data is appended directly to the file's internal flush buffer,
+   * so callers may pass a reusable buffer without making an intermediate copy.
    */
   virtual void write(const std::string& data) PURE;
 
+  /**
+   * Write data to the file and be notified when it has been flushed. The callback is posted to
+   * the dispatcher the file was created on once the implementation has handed the bytes to the
+   * operating system, so callers never observe disk latency directly. During file destruction
+   * any outstanding callbacks are invoked inline instead of being posted.
+   */
+  virtual void write(const std::string& data, WriteCompletionCb cb) PURE;
+
   /**
    * Reopen the file.
    */
@@ -43,6 +43,26 @@ enum ResponseFlag {
   RateLimited = 0x800
 };
 
+/**
+ * Fixed points in a request's lifetime whose timing is recorded on RequestInfo. Each phase is
+ * stored as the duration from request start to the point where the phase was reached, so a
+ * latency breakdown can be reconstructed by diffing adjacent phases. Request receive and
+ * response receive completion have their own dedicated accessors below for historical reasons.
+ */
+enum class RequestPhase {
+  // The route (virtual host and route entry) was resolved.
+  RouteMatched,
+  // A connection pool stream became available for the upstream request. For requests that had
+  // to open a fresh upstream connection this includes connection establishment.
+  PoolReady,
+  // The first byte (response headers) of the upstream response was received.
+  FirstUpstreamByte,
+  // The last byte of the response was encoded to the downstream connection.
+  EncodeComplete,
+  // Sentinel used to size storage. Not a real phase.
+  NumPhases
+};
+
 /**
  * Additional information about a completed request for logging.
  */
@@ -91,6 +111,18 @@ public:
    */
   virtual void responseReceivedDuration(MonotonicTime time) PURE;
 
+  /**
+   * Record that the given phase was reached at the given monotonic time. Only the duration from
+   * request start is stored. On retry the last attempt wins.
+   */
+  virtual void markPhase(RequestPhase phase, MonotonicTime time) PURE;
+
+  /**
+   * @return duration from request start to when the given phase was reached in microseconds.
+   * Note: if the phase was never reached, will return 0 microseconds.
+   */
+  virtual std::chrono::microseconds phaseDuration(RequestPhase phase) const PURE;
+
   /**
    * @return the # of body bytes received in the request.
    */
@@ -185,9 +217,27 @@ class Formatter {
 public:
   virtual ~Formatter() {}
 
-  virtual std::string format(const Http::HeaderMap& request_headers,
-                             const Http::HeaderMap& response_headers,
-                             const RequestInfo& request_info) const PURE;
+  /**
+   * Append a formatted log entry to an output buffer. The format is compiled once at
+   * construction time so that per request formatting serializes directly into the supplied
+   * buffer without intermediate strings.
+   * @param output supplies the buffer to append to. Callers on the hot path reuse the same
+   *        buffer across log entries to avoid an allocation per entry.
+   */
+  virtual void format(const Http::HeaderMap& request_headers,
+                      const Http::HeaderMap& response_headers, const RequestInfo& request_info,
+                      std::string& output) const PURE;
+
+  /**
+   * Convenience wrapper around the appending format() that returns a new string.
+   */
+  std::string format(const Http::HeaderMap& request_headers,
+                     const Http::HeaderMap& response_headers,
+                     const RequestInfo& request_info) const {
+    std::string output;
+    format(request_headers, response_headers, request_info, output);
+    return output;
+  }
 };
 
 typedef std::unique_ptr<Formatter> FormatterPtr;
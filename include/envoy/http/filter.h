@@ -9,6 +9,7 @@
 #include "envoy/http/access_log.h"
 #include "envoy/http/codec.h"
 #include "envoy/http/header_map.h"
+#include "envoy/http/query_params.h"
 #include "envoy/router/router.h"
 #include "envoy/ssl/connection.h"
 #include "envoy/tracing/http_tracer.h"
@@ -258,6 +259,15 @@ public:
    * @return the buffer limit the filter should apply.
    */
   virtual uint32_t decoderBufferLimit() PURE;
+
+  /**
+   * @return const QueryParams& the decoded query parameters of the request path. The
+   *         decomposition is built the first time any filter in the chain asks for it and then
+   *         cached on the stream, so the path is scanned at most once per request no matter how
+   *         many filters use it. The cache rebuilds itself if the path header no longer matches
+   *         the path it was built from (e.g. after a filter rewrites the path).
+   */
+  virtual const QueryParams& queryParams() PURE;
 };
 
 /**
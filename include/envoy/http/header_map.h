@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <string>
 
@@ -119,6 +120,13 @@ public:
    */
   void setReference(const std::string& ref_value);
 
+  /**
+   * Set the value of the string to a reference to another HeaderString's backing storage. The
+   * other string MUST be of type Reference, so the referenced data is known to outlive any
+   * request/response using this string.
+   */
+  void setReference(const HeaderString& ref_value);
+
   /**
    * @return the size of the string, not including the null terminator.
    */
@@ -377,6 +385,15 @@ public:
    */
   virtual void remove(const LowerCaseString& key) PURE;
 
+  /**
+   * Remove all instances of every header in a list of keys. Equivalent to calling remove() once
+   * per key, but applies all of the removals in a single pass over the map, so callers holding a
+   * removal list computed at configuration time (e.g. per listener response header rules) do not
+   * pay one map traversal per key.
+   * @param keys supplies the header keys to remove.
+   */
+  virtual void remove(const std::list<LowerCaseString>& keys) PURE;
+
   /**
    * @return the number of headers in the map.
    */
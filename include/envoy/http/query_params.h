@@ -0,0 +1,15 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Decoded query parameters from a request path, keyed by parameter name.
+ */
+typedef std::map<std::string, std::string> QueryParams;
+
+} // namespace Http
+} // namespace Envoy
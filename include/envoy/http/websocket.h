@@ -17,6 +17,14 @@ public:
    * client when there are errors establishing a connection to upstream server.
    */
   virtual void sendHeadersOnlyResponse(HeaderMap& headers) PURE;
+
+  /**
+   * Used by a WebSocket implementation to signal that the upgrade handshake has been relayed to
+   * the upstream server and the connection has become a raw data relay. No HTTP semantics remain
+   * after this point. The callee may tear down the HTTP stream that initiated the upgrade, so the
+   * caller must not touch the request headers or these callbacks after invoking this.
+   */
+  virtual void onHandshakeComplete() PURE;
 };
 
 } // namespace Http
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A shared accept budget for a single configured listener. All workers' listeners for the same
+ * listener config share one limiter; each worker pulls small batches of accept tokens into a
+ * local bucket so the common case accept path never touches shared state. Implementations must
+ * be safe to call from multiple worker threads.
+ */
+class AcceptRateLimiter {
+public:
+  virtual ~AcceptRateLimiter() {}
+
+  /**
+   * Attempts to take up to max_tokens tokens from the shared budget.
+   * @param max_tokens supplies the maximum number of tokens the caller can use.
+   * @return uint32_t the number of tokens actually granted, which may be zero.
+   */
+  virtual uint32_t take(uint32_t max_tokens) PURE;
+};
+
+typedef std::shared_ptr<AcceptRateLimiter> AcceptRateLimiterSharedPtr;
+
+} // namespace Network
+} // namespace Envoy
@@ -98,6 +98,13 @@ public:
    */
   virtual Event::Dispatcher& dispatcher() PURE;
 
+  /**
+   * @return int the file descriptor backing the connection, or -1 if the connection is closed.
+   *         This is meant for components that move data at the socket level (e.g., splice() based
+   *         proxying) and should not be used during normal filter processing.
+   */
+  virtual int fd() PURE;
+
   /**
    * @return uint64_t the unique local ID of this connection.
    */
@@ -205,6 +212,25 @@ public:
    * @return boolean telling if the connection is currently above the high watermark.
    */
   virtual bool aboveHighWatermark() const PURE;
+
+  /**
+   * Mark the connection as (in)eligible for socket migration to another process (e.g. handing an
+   * idle keep-alive connection to the new process during hot restart). The owner of the
+   * connection is responsible for keeping this up to date: a connection must only be marked
+   * migratable while no protocol state beyond "waiting for the next request" exists, since the
+   * adopting process starts from a fresh connection. Connections start out not migratable.
+   */
+  virtual void setMigratable(bool migratable) PURE;
+
+  /**
+   * Detach the socket from the connection so that it can be handed to another process. This only
+   * succeeds if the connection has been marked migratable, is open, is not encrypted, and has no
+   * buffered data in either direction; otherwise -1 is returned and nothing changes. On success
+   * the caller owns the returned fd and ConnectionEvent::LocalClose is raised so normal cleanup
+   * of the (now socketless) connection object runs.
+   * @return int the detached fd or -1 if the connection cannot be migrated.
+   */
+  virtual int detachFd() PURE;
 };
 
 typedef std::unique_ptr<Connection> ConnectionPtr;
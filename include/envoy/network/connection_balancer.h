@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/network/address.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A per-worker participant in connection balancing. There is one handler per worker for a given
+ * balanced listener.
+ */
+class BalancedConnectionHandler {
+public:
+  virtual ~BalancedConnectionHandler() {}
+
+  /**
+   * @return uint64_t the number of connections the handler is currently responsible for,
+   *         including accepted sockets that have been handed off to it but not yet picked up by
+   *         its thread. May be called from any worker thread.
+   */
+  virtual uint64_t numConnections() PURE;
+
+  /**
+   * Hands an accepted socket off to the handler. May be called from any worker thread. The
+   * handler takes ownership of the fd and finishes building the connection on its own thread.
+   * @param fd supplies the accepted socket's fd.
+   * @param remote_address supplies the remote address for the new connection.
+   * @param local_address supplies the local address for the new connection.
+   * @param using_original_dst supplies whether the connection was redirected using iptables.
+   */
+  virtual void post(int fd, Address::InstanceConstSharedPtr remote_address,
+                    Address::InstanceConstSharedPtr local_address, bool using_original_dst) PURE;
+};
+
+/**
+ * Balances accepted connections between the workers of a listener. Implementations must be safe
+ * to call from multiple worker threads.
+ */
+class ConnectionBalancer {
+public:
+  virtual ~ConnectionBalancer() {}
+
+  /**
+   * Registers a handler with the balancer. Called on the handler's thread when a worker adds the
+   * listener.
+   */
+  virtual void registerHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Unregisters a handler. Called on the handler's thread when a worker stops or removes the
+   * listener. The balancer will not pick the handler again, though handoffs already in flight
+   * may still be delivered to the handler's thread.
+   */
+  virtual void unregisterHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Picks the handler that should take a connection just accepted by current.
+   * @return BalancedConnectionHandler& the target handler. If it is not current, the caller is
+   *         expected to hand the socket off via post().
+   */
+  virtual BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current) PURE;
+};
+
+typedef std::shared_ptr<ConnectionBalancer> ConnectionBalancerSharedPtr;
+
+} // namespace Network
+} // namespace Envoy
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 
 #include "envoy/network/connection.h"
@@ -12,6 +13,20 @@
 namespace Envoy {
 namespace Network {
 
+/**
+ * Called with sockets detached from established connections that should outlive this process
+ * (e.g. idle keep-alive connections handed to the new process during hot restart).
+ * @param fd supplies the detached socket. The callee sends a duplicate across the process
+ *           boundary; the caller retains ownership of the fd and must close it.
+ * @param local_address supplies the connection's local address.
+ * @param remote_address supplies the connection's remote address.
+ * @return bool true if the socket was passed to another process, false if there was no process
+ *         to take it.
+ */
+typedef std::function<bool(int fd, const Address::Instance& local_address,
+                           const Address::Instance& remote_address)>
+    ConnectionPassHandler;
+
 /**
  * Abstract connection handler.
  */
@@ -75,6 +90,17 @@ public:
    * Stop all listeners. This will not close any connections and is used for draining.
    */
   virtual void stopListeners() PURE;
+
+  /**
+   * Stop accepting new connections on all listeners without closing the listen sockets. Pending
+   * connections queue in the kernel backlog. Used for load shedding under overload.
+   */
+  virtual void disableListeners() PURE;
+
+  /**
+   * Resume accepting new connections after a disableListeners() call.
+   */
+  virtual void enableListeners() PURE;
 };
 
 typedef std::unique_ptr<ConnectionHandler> ConnectionHandlerPtr;
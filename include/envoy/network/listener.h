@@ -5,7 +5,9 @@
 #include <string>
 
 #include "envoy/common/exception.h"
+#include "envoy/network/accept_rate_limiter.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 
 namespace Envoy {
 namespace Network {
@@ -25,6 +27,18 @@ struct ListenerOptions {
   bool use_original_dst_;
   // Soft limit on size of the listener's new connection read and write buffers.
   uint32_t per_connection_buffer_limit_bytes_;
+  // If non-null, the balancer that decides which worker's listener each accepted connection is
+  // handed to. All workers' listeners for the same listener config share a single balancer. If
+  // null, connections are processed on the worker that accepts them.
+  ConnectionBalancerSharedPtr connection_balancer_;
+  // If non-null, the shared accept budget for the listener. Accepted sockets that cannot obtain
+  // a token are closed immediately, before any connection machinery (TLS handshake, filter
+  // chain) is built for them. If null, accepts are not rate limited.
+  AcceptRateLimiterSharedPtr accept_rate_limiter_;
+  // Whether the listen socket has TCP_DEFER_ACCEPT enabled. Used to count connections the kernel
+  // handed over with no data ready, which with deferred accept means the defer timeout expired
+  // without the client ever sending anything.
+  bool deferred_accept_;
 
   /**
    * Factory for ListenerOptions with bind_to_port_ set.
@@ -58,6 +72,17 @@ public:
 class Listener {
 public:
   virtual ~Listener() {}
+
+  /**
+   * Temporarily stop accepting new connections. The socket remains bound, so pending connections
+   * queue in the kernel backlog until enable() is called. Used for load shedding.
+   */
+  virtual void disable() PURE;
+
+  /**
+   * Resume accepting new connections after a disable() call.
+   */
+  virtual void enable() PURE;
 };
 
 typedef std::unique_ptr<Listener> ListenerPtr;
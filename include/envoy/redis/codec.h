@@ -40,6 +40,26 @@ public:
   int64_t& asInteger();
   int64_t asInteger() const;
 
+  /**
+   * A BulkString value can alternatively hold its payload as buffer slices moved directly out of
+   * a network buffer rather than as a string. The decoder uses this form for large payloads and
+   * the encoder writes it back out without going through a string, so large values proxy through
+   * without being copied into intermediate storage. asString() remains valid for buffer backed
+   * values; it linearizes the buffer into the string on first access.
+   */
+  bool hasBufferStorage() const { return buffer_ != nullptr; }
+
+  /**
+   * Get the buffer storage for a BulkString value, creating empty storage if none exists. Buffer
+   * storage should only be created for values whose string has not been written.
+   */
+  Buffer::Instance& asBuffer();
+
+  /**
+   * @return the buffer storage for this value. Only valid if hasBufferStorage() is true.
+   */
+  const Buffer::Instance& asBuffer() const;
+
   /**
    * Get/set the type of the RespValue. A RespValue can only be a single type at a time. Each time
    * type() is called the type is changed and then the type specific as* methods can be used.
@@ -55,7 +75,9 @@ private:
   };
 
   void cleanup();
+  void copyBufferToString();
 
+  Buffer::InstancePtr buffer_;
   RespType type_;
 };
 
@@ -89,6 +111,14 @@ public:
    *        ProtocolError will be thrown.
    */
   virtual void decode(Buffer::Instance& data) PURE;
+
+  /**
+   * Return a previously decoded value to the decoder for reuse. Values handed back here keep
+   * their storage and are used in place of a fresh allocation for a subsequently decoded value,
+   * so callers must no longer reference the value.
+   * @param value supplies the value to recycle.
+   */
+  virtual void recycle(RespValuePtr&& value) PURE;
 };
 
 typedef std::unique_ptr<Decoder> DecoderPtr;
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/redis/codec.h"
 #include "envoy/upstream/cluster_manager.h"
@@ -104,6 +105,19 @@ public:
                            const Config& config) PURE;
 };
 
+/**
+ * A single fragment of a batched request. The referenced hash key, request, and callbacks must
+ * remain valid until Instance::makeRequests() returns.
+ */
+struct RequestFragment {
+  RequestFragment(const std::string& hash_key, const RespValue& request, PoolCallbacks& callbacks)
+      : hash_key_(hash_key), request_(request), callbacks_(callbacks) {}
+
+  const std::string& hash_key_;
+  const RespValue& request_;
+  PoolCallbacks& callbacks_;
+};
+
 /**
  * A redis connection pool. Wraps M connections to N upstream hosts, consistent hashing,
  * pipelining, failure handling, etc.
@@ -122,6 +136,40 @@ public:
    */
   virtual PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                                    PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Makes a batch of redis requests in one pass. Fragments are grouped by the upstream host their
+   * hash key maps to, so each host's connection is resolved once and that host's fragments are
+   * encoded back to back as a single pipelined batch.
+   * @param fragments supplies the requests to make.
+   * @return std::vector<PoolRequest*> handles parallel to fragments. An entry is nullptr if that
+   *         fragment could not be sent (e.g., no upstream host).
+   */
+  virtual std::vector<PoolRequest*>
+  makeRequests(const std::vector<RequestFragment>& fragments) PURE;
+
+  /**
+   * Makes a redis request to a specific upstream host, bypassing key hashing. Used to follow
+   * Redis Cluster MOVED/ASK redirections.
+   * @param host_address supplies the "ip:port" address from the redirection error.
+   * @param request supplies the request to make.
+   * @param callbacks supplies the request completion callbacks.
+   * @param asking supplies whether an ASKING command must precede the request (ASK redirection).
+   * @return PoolRequest* a handle to the active request or nullptr if the address does not map to
+   *         a known host in the cluster.
+   */
+  virtual PoolRequest* makeRequestToHost(const std::string& host_address,
+                                         const RespValue& request, PoolCallbacks& callbacks,
+                                         bool asking) PURE;
+
+  /**
+   * Records that a Redis Cluster hash slot is owned by the given host, as learned from a MOVED
+   * redirection. Subsequent requests whose key hashes to the slot are routed directly to that
+   * host instead of through the load balancer.
+   * @param slot supplies the hash slot from the redirection error.
+   * @param host_address supplies the owning host's "ip:port" address.
+   */
+  virtual void updateSlotOwner(uint32_t slot, const std::string& host_address) PURE;
 };
 
 typedef std::unique_ptr<Instance> InstancePtr;
@@ -11,6 +11,7 @@
 #include "envoy/common/optional.h"
 #include "envoy/http/codec.h"
 #include "envoy/http/header_map.h"
+#include "envoy/stats/stats.h"
 #include "envoy/tracing/http_tracer.h"
 #include "envoy/upstream/resource_manager.h"
 
@@ -179,6 +180,23 @@ public:
    * @return the name of the virtual cluster.
    */
   virtual const std::string& name() const PURE;
+
+  /**
+   * Charge the virtual cluster's response code stats for a response. The backing counters are
+   * resolved on first charge and reused afterwards, so every caller must supply the same scope.
+   * @param scope supplies the scope to charge stats against.
+   * @param response_code supplies the HTTP response code.
+   */
+  virtual void chargeResponseStat(Stats::Scope& scope, uint64_t response_code) const PURE;
+
+  /**
+   * Deliver a response timing to the virtual cluster's upstream_rq_time histogram. Same scope
+   * requirement as chargeResponseStat().
+   * @param scope supplies the scope to deliver the timing against.
+   * @param response_time supplies the measured response time.
+   */
+  virtual void chargeResponseTiming(Stats::Scope& scope,
+                                    std::chrono::milliseconds response_time) const PURE;
 };
 
 class RateLimitPolicy;
@@ -235,6 +253,14 @@ public:
    */
   virtual const std::string& clusterName() const PURE;
 
+  /**
+   * @return Optional<uint64_t> the cluster manager handle interned for clusterName() when the
+   *         route table was loaded, or an invalid optional if the cluster is selected
+   *         per-request (e.g. via a cluster header) and must be resolved by name. @see
+   *         Upstream::ClusterManager::clusterHandle().
+   */
+  virtual Optional<uint64_t> clusterHandle() const PURE;
+
   /**
    * @return const CorsPolicy* the CORS policy for this virtual host.
    */
@@ -4,28 +4,69 @@
 #include <memory>
 #include <string>
 
+#include "envoy/buffer/buffer.h"
+#include "envoy/http/header_map.h"
 #include "envoy/http/message.h"
 
 namespace Envoy {
 namespace Router {
 
 /**
- * Interface used to shadow complete requests to an alternate upstream cluster in a "fire and
- * forget" fashion. Right now this interface takes a fully buffered request and cannot be used for
- * streaming. This is sufficient for current use cases.
+ * An in-flight streaming shadow request. The handle is owned by the caller, which feeds body data
+ * and trailers through it as they flow through the primary stream. Destroying the handle before
+ * the request has been fully written cancels the shadow; destroying it afterwards lets the shadow
+ * run to completion in the background.
+ */
+class ShadowStream {
+public:
+  virtual ~ShadowStream() {}
+
+  /**
+   * Write a chunk of body data to the shadow. The supplied data is not consumed.
+   * @param data supplies the data to write.
+   * @param end_stream supplies whether this is the last data frame.
+   */
+  virtual void writeData(const Buffer::Instance& data, bool end_stream) PURE;
+
+  /**
+   * Write trailers to the shadow. This implicitly ends the stream.
+   * @param trailers supplies the trailers to write.
+   */
+  virtual void writeTrailers(const Http::HeaderMap& trailers) PURE;
+};
+
+typedef std::unique_ptr<ShadowStream> ShadowStreamPtr;
+
+/**
+ * Interface used to shadow requests to an alternate upstream cluster in a "fire and forget"
+ * fashion. Requests can either be shadowed from a complete buffered request or streamed
+ * incrementally as the primary request flows through.
  */
 class ShadowWriter {
 public:
   virtual ~ShadowWriter() {}
 
   /**
-   * Shadow a request.
+   * Shadow a complete request.
    * @param cluster supplies the cluster name to shadow to.
    * @param message supplies the complete request to shadow.
    * @param timeout supplies the shadowed request timeout.
    */
   virtual void shadow(const std::string& cluster, Http::MessagePtr&& request,
                       std::chrono::milliseconds timeout) PURE;
+
+  /**
+   * Start a streaming shadow. Body data and trailers are fed through the returned handle as they
+   * arrive instead of buffering the complete request.
+   * @param cluster supplies the cluster name to shadow to.
+   * @param headers supplies the finalized request headers.
+   * @param end_stream supplies whether the request is header only.
+   * @param timeout supplies the shadowed request timeout.
+   * @return ShadowStreamPtr a handle used to feed the rest of the request, or nullptr if the
+   *         shadow stream could not be established or has already completed.
+   */
+  virtual ShadowStreamPtr streamShadow(const std::string& cluster, Http::HeaderMapPtr&& headers,
+                                       bool end_stream, std::chrono::milliseconds timeout) PURE;
 };
 
 typedef std::unique_ptr<ShadowWriter> ShadowWriterPtr;
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "envoy/common/pure.h"
 
@@ -88,6 +89,16 @@ public:
    */
   virtual const std::string& get(const std::string& key) const PURE;
 
+  /**
+   * Check whether the snapshot contains any key starting with a prefix. The answer is computed
+   * from data assembled once when the snapshot is loaded, so callers can use it as a cheap guard
+   * in front of per-request key construction and lookups (e.g. a filter that is always installed
+   * but only rarely has runtime overrides present).
+   * @param prefix supplies the key prefix to check.
+   * @return true if at least one key in the snapshot begins with prefix.
+   */
+  virtual bool keysWithPrefixExist(const std::string& prefix) const PURE;
+
   /**
    * Fetch an integer runtime key.
    * @param key supplies the key to fetch.
@@ -98,6 +109,32 @@ public:
   virtual uint64_t getInteger(const std::string& key, uint64_t default_value) const PURE;
 };
 
+/**
+ * A runtime key that has been pre-resolved via Loader::registerKey(). The loader refreshes the
+ * held value every time a new snapshot is loaded, so per-request reads are a single atomic load
+ * instead of a string keyed map lookup. Handles are safe to read from any thread.
+ */
+class KeyHandle {
+public:
+  virtual ~KeyHandle() {}
+
+  /**
+   * @return uint64_t the key's integer value in the most recently loaded snapshot, or the default
+   *         value the handle was registered with if the key does not exist or is not an integer.
+   */
+  virtual uint64_t getInteger() const PURE;
+
+  /**
+   * Equivalent to Snapshot::featureEnabled() for the registered key and default value against the
+   * most recently loaded snapshot. The same caveat applies: a new random number is used on every
+   * call, so subsequent calls are not guaranteed to be consistent.
+   * @return true if the feature is enabled.
+   */
+  virtual bool featureEnabled() const PURE;
+};
+
+typedef std::shared_ptr<const KeyHandle> KeyHandleConstSharedPtr;
+
 /**
  * Loads runtime snapshots from storage (local disk, etc.).
  */
@@ -111,6 +148,26 @@ public:
    *         fetched again when needed.
    */
   virtual Snapshot& snapshot() PURE;
+
+  /**
+   * Merge the given map of key/value pairs into the loader's in memory override layer. Overridden
+   * values take precedence over values loaded from storage and are preserved across snapshot
+   * reloads. An empty string value removes the override for that key so the stored value shows
+   * through again. Must be called from the main thread.
+   * @param values supplies the overrides to merge.
+   */
+  virtual void mergeValues(const std::unordered_map<std::string, std::string>& values) PURE;
+
+  /**
+   * Pre-resolve a key so that its value can be read without a per-call map lookup. This walks the
+   * loader's handle registry and may take a lock, so it is intended to be called once at
+   * configuration time, not per request. Safe to call from any thread.
+   * @param key supplies the key to pre-resolve.
+   * @param default_value supplies the value the handle reports when the key does not exist or is
+   *        not an integer.
+   * @return KeyHandleConstSharedPtr the handle. The loader only keeps a weak reference to it.
+   */
+  virtual KeyHandleConstSharedPtr registerKey(const std::string& key, uint64_t default_value) PURE;
 };
 
 typedef std::unique_ptr<Loader> LoaderPtr;
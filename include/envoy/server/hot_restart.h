@@ -56,6 +56,22 @@ public:
    */
   virtual void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) PURE;
 
+  /**
+   * Pass an established connection's socket to our child process so the connection survives the
+   * restart. Only valid once the child has asked us to terminate, since before that there is no
+   * child guaranteed to be ready to adopt connections. Unlike most other routines on this
+   * interface this one is thread safe, as sockets are passed from worker threads during
+   * shutdown.
+   * @param fd supplies the detached socket. A duplicate is sent across the process boundary; the
+   *           caller retains ownership of the fd and must close it.
+   * @param local_address supplies the connection's local address URL (e.g. tcp://1.2.3.4:80),
+   *        used by the child to find the owning listener.
+   * @param remote_address supplies the connection's remote address URL.
+   * @return bool true if the socket was sent to the child.
+   */
+  virtual bool passConnection(int fd, const std::string& local_address,
+                              const std::string& remote_address) PURE;
+
   /**
    * Shutdown admin processing in the parent process if applicable. This allows admin processing
    * to start up in the new process.
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "envoy/network/accept_rate_limiter.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/server/drain_manager.h"
@@ -70,6 +72,26 @@ public:
    */
   virtual Network::ListenSocket& socket() PURE;
 
+  /**
+   * @return Network::ListenSocket& the socket a particular worker should accept on. When
+   *         per-worker SO_REUSEPORT sockets are in use each worker gets its own socket bound to
+   *         the same address, otherwise every worker shares socket().
+   */
+  virtual Network::ListenSocket& socketForWorker(uint32_t worker_index) PURE;
+
+  /**
+   * @return Network::ConnectionBalancerSharedPtr the balancer shared by all workers' listeners
+   *         for this listener, or nullptr if accepted connections should be processed on the
+   *         worker that accepts them.
+   */
+  virtual Network::ConnectionBalancerSharedPtr connectionBalancer() PURE;
+
+  /**
+   * @return Network::AcceptRateLimiterSharedPtr the accept budget shared by all workers'
+   *         listeners for this listener, or nullptr if accepts are not rate limited.
+   */
+  virtual Network::AcceptRateLimiterSharedPtr acceptRateLimiter() PURE;
+
   /**
    * @return Ssl::ServerContext* the SSL context
    */
@@ -81,6 +103,12 @@ public:
    */
   virtual bool useProxyProto() PURE;
 
+  /**
+   * @return bool whether the listen socket has TCP_DEFER_ACCEPT enabled, meaning the kernel only
+   *         hands over connections once data is ready (or the defer timeout expires).
+   */
+  virtual bool deferAccept() PURE;
+
   /**
    * @return bool specifies whether the listener should actually listen on the port.
    *         A listener that doesn't listen on a port can only receive connections
@@ -137,6 +165,20 @@ public:
    */
   virtual bool addOrUpdateListener(const envoy::api::v2::Listener& config) PURE;
 
+  /**
+   * Adopt an established connection passed to this process by its hot restart parent. The
+   * connection is handed to a worker owning a listener that matches the local address. Listeners
+   * that reconstruct per-connection state that did not cross the process boundary (SSL, PROXY
+   * protocol) cannot adopt connections.
+   * @param fd supplies the connection's socket. Ownership is taken on success.
+   * @param local_address supplies the connection's local address.
+   * @param remote_address supplies the connection's remote address.
+   * @return TRUE if a worker took ownership of the socket, FALSE if no eligible listener exists
+   *         (the caller still owns the fd).
+   */
+  virtual bool adoptPassedConnection(int fd, Network::Address::InstanceConstSharedPtr local_address,
+                                     Network::Address::InstanceConstSharedPtr remote_address) PURE;
+
   /**
    * @return std::vector<std::reference_wrapper<Listener>> a list of the currently loaded listeners.
    * Note that this routine returns references to the existing listeners. The references are only
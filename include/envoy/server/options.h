@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/common/pure.h"
 #include "envoy/network/address.h"
@@ -54,6 +55,14 @@ public:
    */
   virtual uint32_t concurrency() PURE;
 
+  /**
+   * @return the list of CPU ids that worker threads are pinned to, assigned round-robin by
+   *         worker index. An empty list leaves workers unpinned. Pinning workers keeps their
+   *         buffer memory NUMA-local on multi-socket machines and makes IRQ steering to
+   *         specific workers practical.
+   */
+  virtual const std::vector<uint32_t>& workerCpuAffinity() PURE;
+
   /**
    * @return the number of seconds that envoy will perform draining during a hot restart.
    */
@@ -90,6 +99,52 @@ public:
    */
   virtual uint64_t restartEpoch() PURE;
 
+  /**
+   * @return whether each worker should accept on its own SO_REUSEPORT listen socket (bound to
+   *         the same address) so that the kernel distributes new connections across workers.
+   */
+  virtual bool reusePort() PURE;
+
+  /**
+   * @return the TCP Fast Open SYN backlog queue length to enable on listen sockets, or 0 to
+   *         leave TFO disabled.
+   */
+  virtual uint32_t tcpFastOpenQueueLength() PURE;
+
+  /**
+   * @return the TCP_DEFER_ACCEPT timeout in seconds to set on listen sockets so that the kernel
+   *         only wakes a worker for connections that already have data ready, or 0 to leave
+   *         deferred accept disabled.
+   */
+  virtual uint32_t deferAcceptTimeoutSeconds() PURE;
+
+  /**
+   * @return whether each listener should hand accepted sockets off to the worker with the
+   *         fewest active connections instead of processing them on the accepting worker.
+   */
+  virtual bool exactConnectionBalance() PURE;
+
+  /**
+   * @return the maximum number of connections each listener may accept per second, summed
+   *         across all workers. Sockets accepted beyond the limit are closed before any
+   *         connection setup work is done for them. 0 disables accept rate limiting.
+   */
+  virtual uint32_t maxAcceptsPerSecond() PURE;
+
+  /**
+   * @return the maximum number of downstream connections the process may hold open across all
+   *         workers, enforced at accept time. Admin connections are not counted. 0 disables the
+   *         limit.
+   */
+  virtual uint64_t maxConnections() PURE;
+
+  /**
+   * @return whether active health checking runs on its own dispatcher thread rather than the
+   *         main thread. This keeps large health check bursts from delaying config updates and
+   *         other main thread work (and vice versa).
+   */
+  virtual bool dedicatedHealthCheckThread() PURE;
+
   /**
    * @return whether to verify the configuration file is valid, print any errors, and exit
    *         without serving.
@@ -2,6 +2,7 @@
 
 #include <functional>
 
+#include "envoy/network/address.h"
 #include "envoy/server/guarddog.h"
 
 namespace Envoy {
@@ -30,6 +31,17 @@ public:
    */
   virtual void addListener(Listener& listener, AddListenerCompletion completion) PURE;
 
+  /**
+   * Add an already established connection to the worker, e.g. one passed from a hot restart
+   * parent. The worker matches the connection to one of its listeners by local address on its
+   * own thread; if no listener is found by then the socket is closed.
+   * @param fd supplies the connection's socket. The worker takes ownership.
+   * @param local_address supplies the connection's local address.
+   * @param remote_address supplies the connection's remote address.
+   */
+  virtual void addPassedConnection(int fd, Network::Address::InstanceConstSharedPtr local_address,
+                                   Network::Address::InstanceConstSharedPtr remote_address) PURE;
+
   /**
    * @return uint64_t the number of connections across all listeners that the worker owns.
    */
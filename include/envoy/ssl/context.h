@@ -36,7 +36,18 @@ public:
 class ClientContext : public virtual Context {};
 typedef std::unique_ptr<ClientContext> ClientContextPtr;
 
-class ServerContext : public virtual Context {};
+class ServerContext : public virtual Context {
+public:
+  /**
+   * Registers an alternate server context to use for connections whose ClientHello carries the
+   * given SNI name, allowing one listener to serve certificates for multiple domains. Exact names
+   * and "*." prefixed wildcard names are supported. Must be called at configuration time, before
+   * this context starts serving handshakes, and the registered context must outlive this one.
+   * @param sni_name supplies the server name to match.
+   * @param context supplies the context to select for matching connections.
+   */
+  virtual void addSniContext(const std::string& sni_name, ServerContext& context) PURE;
+};
 typedef std::unique_ptr<ServerContext> ServerContextPtr;
 
 } // namespace Ssl
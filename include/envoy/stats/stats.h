@@ -48,6 +48,13 @@ public:
   virtual void add(uint64_t amount) PURE;
   virtual void dec() PURE;
   virtual void inc() PURE;
+
+  /**
+   * @return whether the gauge has changed since the last call to latchDirty(). Clears the flag,
+   *         so that a periodic flush can skip gauges that have not moved.
+   */
+  virtual bool latchDirty() PURE;
+
   virtual std::string name() PURE;
   virtual void set(uint64_t value) PURE;
   virtual void sub(uint64_t amount) PURE;
@@ -57,6 +64,31 @@ public:
 
 typedef std::shared_ptr<Gauge> GaugeSharedPtr;
 
+/**
+ * An in process histogram. Recording a value is an O(1) bucket increment with no per sample
+ * allocation or network cost; the recorded distribution can be summarized at read time (e.g.
+ * for the admin endpoint).
+ */
+class Histogram {
+public:
+  virtual ~Histogram() {}
+
+  virtual std::string name() PURE;
+
+  /**
+   * Record a single value into the histogram.
+   */
+  virtual void recordValue(uint64_t value) PURE;
+
+  /**
+   * @return a human readable summary of the recorded distribution (count, mean, and approximate
+   *         quantiles).
+   */
+  virtual std::string summary() const PURE;
+};
+
+typedef std::shared_ptr<Histogram> HistogramSharedPtr;
+
 /**
  * An individual timespan that is owned by a timer. The initial time is captured on construction.
  * A timespan must be completed via complete() for it to be stored. If the timespan is deleted
@@ -194,6 +226,11 @@ public:
    * @return a list of all known gauges.
    */
   virtual std::list<GaugeSharedPtr> gauges() const PURE;
+
+  /**
+   * @return a list of all known histograms.
+   */
+  virtual std::list<HistogramSharedPtr> histograms() const PURE;
 };
 
 /**
@@ -29,16 +29,21 @@ public:
   virtual ~Slot() {}
 
   /**
-   * @return ThreadLocalObjectSharedPtr a thread local object stored in the slot.
+   * @return ThreadLocalObject& the thread local object stored in the slot. The reference is
+   *         returned without taking shared ownership so there is no refcount bump on the read
+   *         path. It remains valid for the duration of the current dispatcher callback: the
+   *         stored object is only replaced or freed via callbacks posted to this thread by
+   *         set() and slot destruction, which cannot run until the current callback returns.
+   *         Callers that need the object beyond that must hold their own ownership.
    */
-  virtual ThreadLocalObjectSharedPtr get() PURE;
+  virtual ThreadLocalObject& get() PURE;
 
   /**
    * This is a helper on top of get() that casts the object stored in the slot to the specified
    * type. Since the slot only stores pointers to the base interface, dynamic_cast provides some
    * level of protection via RTTI.
    */
-  template <class T> T& getTyped() { return *std::dynamic_pointer_cast<T>(get()); }
+  template <class T> T& getTyped() { return dynamic_cast<T&>(get()); }
 
   /**
    * Run a callback on all registered threads.
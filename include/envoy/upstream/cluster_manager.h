@@ -65,6 +65,25 @@ public:
    */
   virtual ThreadLocalCluster* get(const std::string& cluster) PURE;
 
+  /**
+   * Intern a cluster name into a small integer handle. Handles are allocated on the main thread
+   * at configuration load time and remain stable for the lifetime of the server, even across
+   * CDS add/update/remove cycles, so they can be baked into route tables when those tables are
+   * built. A handle may be allocated for a name that has no cluster (yet); getByHandle() simply
+   * returns nullptr until a cluster with that name is added.
+   *
+   * This must only be called on the main thread.
+   */
+  virtual uint64_t clusterHandle(const std::string& cluster) PURE;
+
+  /**
+   * @return ThreadLocalCluster* the thread local cluster for a handle previously returned by
+   * clusterHandle(), or nullptr if no cluster with that name currently exists. This is the hot
+   * path equivalent of get(): resolution is an array index rather than a string hash and
+   * compare. The same pointer lifetime caveats as get() apply.
+   */
+  virtual ThreadLocalCluster* getByHandle(uint64_t handle) PURE;
+
   /**
    * Allocate a load balanced HTTP connection pool for a cluster. This is *per-thread* so that
    * callers do not need to worry about per thread synchronization. The load balancing policy that
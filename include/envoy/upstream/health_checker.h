@@ -34,6 +34,15 @@ public:
    * Start cyclic health checking based on the provided settings and the type of health checker.
    */
   virtual void start() PURE;
+
+  /**
+   * Stop all health checking activity and tear down the active sessions. This is called by the
+   * owning cluster before it destroys the health checker. When health checking runs on a
+   * dedicated dispatcher thread the sessions (and their timers and connections) are drained on
+   * that thread, so the checker itself may be destroyed from the main thread afterwards. No
+   * host status callbacks fire once this has been called.
+   */
+  virtual void shutdown() PURE;
 };
 
 typedef std::shared_ptr<HealthChecker> HealthCheckerSharedPtr;
@@ -2,13 +2,24 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "envoy/common/pure.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/protobuf/protobuf.h"
+
 namespace Envoy {
 namespace Upstream {
 
+/**
+ * A list of metadata key/value pairs that an upstream host must match to be eligible for a
+ * request, sorted by key. Values are matched against the host's "envoy.lb" filter metadata.
+ */
+typedef std::vector<std::pair<std::string, ProtobufWkt::Value>> SubsetMetadataCriteria;
+
 /**
  * Context information passed to a load balancer to use when choosing a host. Not all load
  * balancers make use of all context information.
@@ -27,6 +38,12 @@ public:
    * balancing.
    */
   virtual const Network::Connection* downstreamConnection() const PURE;
+
+  /**
+   * @return the metadata match criteria to use for subset load balancing, or nullptr if the
+   *         request does not select a subset. Only subset aware load balancers use this.
+   */
+  virtual const SubsetMetadataCriteria* metadataMatchCriteria() const { return nullptr; }
 };
 
 /**
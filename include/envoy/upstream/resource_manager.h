@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 
@@ -73,6 +74,12 @@ public:
    * @return Resource& active retries.
    */
   virtual Resource& retries() PURE;
+
+  /**
+   * Record a sampled upstream response time. Implementations may use this to adapt the effective
+   * request limit to measured upstream capacity.
+   */
+  virtual void recordResponseTime(std::chrono::milliseconds response_time) PURE;
 };
 
 } // namespace Upstream
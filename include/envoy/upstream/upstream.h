@@ -19,6 +19,11 @@
 #include "envoy/upstream/resource_manager.h"
 
 namespace Envoy {
+
+namespace Http {
+class ResponseCodeStatFamily;
+} // namespace Http
+
 namespace Upstream {
 
 /**
@@ -206,6 +211,8 @@ public:
   GAUGE  (upstream_cx_tx_bytes_buffered)                                                           \
   COUNTER(upstream_cx_protocol_error)                                                              \
   COUNTER(upstream_cx_max_requests)                                                                \
+  COUNTER(upstream_cx_idle_timeout)                                                                \
+  COUNTER(upstream_cx_idle_overflow)                                                               \
   COUNTER(upstream_cx_none_healthy)                                                                \
   COUNTER(upstream_rq_total)                                                                       \
   GAUGE  (upstream_rq_active)                                                                      \
@@ -316,6 +323,12 @@ public:
    */
   virtual ResourceManager& resourceManager(ResourcePriority priority) const PURE;
 
+  /**
+   * @return the pre-resolved response code counter family for this cluster's stats scope, used
+   *         to charge per-response-code stats without building stat names on the request path.
+   */
+  virtual Http::ResponseCodeStatFamily& responseCodeStatFamily() const PURE;
+
   /**
    * @return the SSL context to use when communicating with the cluster.
    */
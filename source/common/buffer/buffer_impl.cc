@@ -1,30 +1,125 @@
 #include "common/buffer/buffer_impl.h"
 
+#include <sys/socket.h>
+#include <sys/uio.h>
+
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "common/common/assert.h"
-
-#include "event2/buffer.h"
+#include "common/common/macros.h"
 
 namespace Envoy {
 namespace Buffer {
 
-// RawSlice is the same structure as evbuffer_iovec. This was put into place to avoid leaking
-// libevent into most code since we will likely replace evbuffer with our own implementation at
-// some point. However, we can avoid a bunch of copies since the structure is the same.
-static_assert(sizeof(RawSlice) == sizeof(evbuffer_iovec), "RawSlice != evbuffer_iovec");
-static_assert(offsetof(RawSlice, mem_) == offsetof(evbuffer_iovec, iov_base),
-              "RawSlice != evbuffer_iovec");
-static_assert(offsetof(RawSlice, len_) == offsetof(evbuffer_iovec, iov_len),
-              "RawSlice != evbuffer_iovec");
+constexpr uint64_t Slice::default_slice_size_;
+
+thread_local SlicePool* SlicePool::active_pool_ = nullptr;
+
+SlicePtr Slice::create(uint64_t min_capacity) {
+  if (min_capacity <= default_slice_size_ && SlicePool::activePool() != nullptr) {
+    SlicePtr recycled = SlicePool::activePool()->acquire();
+    if (recycled != nullptr) {
+      return recycled;
+    }
+  }
+  const uint64_t capacity =
+      ((min_capacity + default_slice_size_ - 1) / default_slice_size_) * default_slice_size_;
+  return SlicePtr{new Slice(capacity)};
+}
+
+void Slice::recycle(SlicePtr&& slice) {
+  if (slice->capacity() == default_slice_size_ && SlicePool::activePool() != nullptr) {
+    SlicePool::activePool()->release(std::move(slice));
+  }
+  // If not pooled, the slice frees here as it goes out of scope.
+}
+
+SlicePool::~SlicePool() {
+  // Make sure a dying pool is not left installed on its thread, e.g. in tests that create
+  // multiple dispatchers on one thread.
+  if (active_pool_ == this) {
+    active_pool_ = nullptr;
+  }
+}
+
+void SlicePool::installOnThread() { active_pool_ = this; }
+
+SlicePtr SlicePool::acquire() {
+  if (free_slices_.empty()) {
+    return nullptr;
+  }
+  SlicePtr slice = std::move(free_slices_.back());
+  free_slices_.pop_back();
+  return slice;
+}
+
+void SlicePool::release(SlicePtr&& slice) {
+  ASSERT(slice->capacity() == Slice::default_slice_size_);
+  if (free_slices_.size() < max_free_slices_) {
+    slice->reset();
+    free_slices_.emplace_back(std::move(slice));
+  }
+}
+
+uint64_t Slice::append(const void* data, uint64_t size) {
+  const uint64_t copy_size = std::min(size, reservableSize());
+  memcpy(reservableStart(), data, copy_size);
+  reservable_ += copy_size;
+  return copy_size;
+}
+
+void Slice::drain(uint64_t size) {
+  ASSERT(size <= dataSize());
+  data_ += size;
+}
+
+void Slice::commit(uint64_t size) {
+  ASSERT(size <= reservableSize());
+  reservable_ += size;
+}
+
+OwnedImpl::OwnedImpl() {}
 
-void OwnedImpl::add(const void* data, uint64_t size) { evbuffer_add(buffer_.get(), data, size); }
+OwnedImpl::OwnedImpl(const std::string& data) : OwnedImpl() { add(data); }
 
-void OwnedImpl::add(const std::string& data) {
-  evbuffer_add(buffer_.get(), data.c_str(), data.size());
+OwnedImpl::OwnedImpl(const Instance& data) : OwnedImpl() { add(data); }
+
+OwnedImpl::OwnedImpl(const void* data, uint64_t size) : OwnedImpl() { add(data, size); }
+
+OwnedImpl::~OwnedImpl() {
+  while (!slices_.empty()) {
+    popFront();
+  }
 }
 
+void OwnedImpl::popFront() {
+  Slice::recycle(std::move(slices_.front()));
+  slices_.pop_front();
+}
+
+void OwnedImpl::appendSlice(SlicePtr&& slice) {
+  length_ += slice->dataSize();
+  slices_.emplace_back(std::move(slice));
+}
+
+void OwnedImpl::add(const void* data, uint64_t size) {
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    if (slices_.empty() || slices_.back()->reservableSize() == 0) {
+      slices_.emplace_back(Slice::create(Slice::default_slice_size_));
+    }
+
+    uint64_t copied = slices_.back()->append(src, size);
+    src += copied;
+    size -= copied;
+    length_ += copied;
+  }
+}
+
+void OwnedImpl::add(const std::string& data) { add(data.c_str(), data.size()); }
+
 void OwnedImpl::add(const Instance& data) {
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   RawSlice slices[num_slices];
@@ -35,82 +130,365 @@ void OwnedImpl::add(const Instance& data) {
 }
 
 void OwnedImpl::commit(RawSlice* iovecs, uint64_t num_iovecs) {
-  int rc =
-      evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(rc == 0);
-  UNREFERENCED_PARAMETER(rc);
+  // Find each committed iovec among the empty reservable tails handed out by reserve() and
+  // grow the owning slice's data section. Reserved space that is not committed simply remains
+  // reservable for the next writer.
+  for (uint64_t i = 0; i < num_iovecs; i++) {
+    if (iovecs[i].len_ == 0) {
+      continue;
+    }
+    bool found = false;
+    for (SlicePtr& slice : slices_) {
+      if (iovecs[i].mem_ == slice->reservableStart()) {
+        slice->commit(iovecs[i].len_);
+        length_ += iovecs[i].len_;
+        found = true;
+        break;
+      }
+    }
+    ASSERT(found);
+    UNREFERENCED_PARAMETER(found);
+  }
 }
 
 void OwnedImpl::drain(uint64_t size) {
   ASSERT(size <= length());
-  int rc = evbuffer_drain(buffer_.get(), size);
-  ASSERT(rc == 0);
-  UNREFERENCED_PARAMETER(rc);
+  while (size > 0) {
+    ASSERT(!slices_.empty());
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= size) {
+      popFront();
+      length_ -= slice_size;
+      size -= slice_size;
+    } else {
+      slices_.front()->drain(size);
+      length_ -= size;
+      size = 0;
+    }
+  }
+
+  // Remove any leading empty slices left behind by uncommitted reservations.
+  while (!slices_.empty() && slices_.front()->dataSize() == 0) {
+    popFront();
+  }
 }
 
 uint64_t OwnedImpl::getRawSlices(RawSlice* out, uint64_t out_size) const {
-  return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
-                       out_size);
+  uint64_t num_slices = 0;
+  for (const SlicePtr& slice : slices_) {
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    if (out != nullptr) {
+      if (num_slices == out_size) {
+        break;
+      }
+      out[num_slices].mem_ = const_cast<uint8_t*>(slice->dataStart());
+      out[num_slices].len_ = slice->dataSize();
+    }
+    num_slices++;
+  }
+  return num_slices;
 }
 
-uint64_t OwnedImpl::length() const { return evbuffer_get_length(buffer_.get()); }
+uint64_t OwnedImpl::length() const { return length_; }
 
 void* OwnedImpl::linearize(uint32_t size) {
   ASSERT(size <= length());
-  return evbuffer_pullup(buffer_.get(), size);
+  if (size == 0) {
+    return nullptr;
+  }
+
+  // Skip leading empty slices so the fast path below sees real data.
+  while (slices_.front()->dataSize() == 0) {
+    popFront();
+  }
+
+  if (slices_.front()->dataSize() >= size) {
+    return slices_.front()->dataStart();
+  }
+
+  // Coalesce the front of the chain into a single new slice.
+  SlicePtr new_slice = Slice::create(size);
+  uint64_t remaining = size;
+  while (remaining > 0) {
+    Slice& front = *slices_.front();
+    const uint64_t copy_size = std::min(remaining, front.dataSize());
+    new_slice->append(front.dataStart(), copy_size);
+    front.drain(copy_size);
+    remaining -= copy_size;
+    if (front.dataSize() == 0) {
+      popFront();
+    }
+  }
+  slices_.emplace_front(std::move(new_slice));
+  return slices_.front()->dataStart();
 }
 
 void OwnedImpl::move(Instance& rhs) {
   // We do the static cast here because in practice we only have one buffer implementation right
-  // now and this is safe. Using the evbuffer move routines require having access to both evbuffers.
-  // This is a reasonable compromise in a high performance path where we want to maintain an
-  // abstraction in case we get rid of evbuffer later.
-  int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
-  ASSERT(rc == 0);
-  UNREFERENCED_PARAMETER(rc);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  // now and this is safe. This is a reasonable compromise in a high performance path where we
+  // want to maintain the buffer abstraction.
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  while (!other.slices_.empty()) {
+    const uint64_t slice_size = other.slices_.front()->dataSize();
+    appendSlice(std::move(other.slices_.front()));
+    other.slices_.pop_front();
+    other.length_ -= slice_size;
+  }
+  other.postProcess();
 }
 
 void OwnedImpl::move(Instance& rhs, uint64_t length) {
   // See move() above for why we do the static cast.
-  int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(), buffer_.get(),
-                                  length);
-  ASSERT(static_cast<uint64_t>(rc) == length);
-  UNREFERENCED_PARAMETER(rc);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  while (length > 0 && !other.slices_.empty()) {
+    const uint64_t slice_size = other.slices_.front()->dataSize();
+    if (slice_size <= length) {
+      appendSlice(std::move(other.slices_.front()));
+      other.slices_.pop_front();
+      other.length_ -= slice_size;
+      length -= slice_size;
+    } else {
+      // A partial slice move copies; transferring ownership of the remainder would require
+      // refcounted slices for little practical gain since codecs move entire buffers.
+      add(other.slices_.front()->dataStart(), length);
+      other.slices_.front()->drain(length);
+      other.length_ -= length;
+      length = 0;
+    }
+  }
+  other.postProcess();
 }
 
 int OwnedImpl::read(int fd, uint64_t max_length) {
-  return evbuffer_read(buffer_.get(), fd, max_length);
+  if (max_length == 0) {
+    return 0;
+  }
+  // Enough iovecs that a large read lands mostly in default sized slices, which can be recycled
+  // through the slice pool, rather than in one large bespoke slice.
+  constexpr uint64_t MaxSlices = 16;
+  RawSlice slices[MaxSlices];
+  const uint64_t num_slices = reserve(max_length, slices, MaxSlices);
+  struct iovec iov[MaxSlices];
+  uint64_t num_bytes_to_read = 0;
+  for (uint64_t i = 0; i < num_slices; i++) {
+    iov[i].iov_base = slices[i].mem_;
+    const uint64_t len = std::min(slices[i].len_, max_length - num_bytes_to_read);
+    iov[i].iov_len = len;
+    num_bytes_to_read += len;
+  }
+  const ssize_t rc = readv(fd, iov, num_slices);
+  if (rc > 0) {
+    uint64_t num_bytes_to_commit = rc;
+    for (uint64_t i = 0; i < num_slices; i++) {
+      slices[i].len_ = std::min(slices[i].len_, num_bytes_to_commit);
+      num_bytes_to_commit -= slices[i].len_;
+    }
+    commit(slices, num_slices);
+  }
+
+  // Release any trailing slices that were reserved but received no data. Without this a short
+  // read would retain the entire reservation as empty slices until enough data flowed to drain
+  // past them, which on a mostly idle connection means indefinitely.
+  while (!slices_.empty() && slices_.back()->dataSize() == 0) {
+    Slice::recycle(std::move(slices_.back()));
+    slices_.pop_back();
+  }
+  return rc;
 }
 
 uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) {
-  uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
-                                        reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(ret >= 1);
-  return ret;
+  ASSERT(num_iovecs >= 1);
+  uint64_t num_used = 0;
+  uint64_t remaining = length;
+
+  // First use any reservable tail on the last slice. Callers depend on the reservation covering
+  // the full requested length (e.g. the HTTP/1 codec reserves with a single iovec and then
+  // writes into it unchecked), so skip the tail when it cannot satisfy the request by itself
+  // and would consume the only iovec: the loop below then hands out one fresh slice sized to
+  // the whole length instead.
+  if (!slices_.empty() && slices_.back()->reservableSize() > 0 &&
+      (num_iovecs > 1 || slices_.back()->reservableSize() >= length)) {
+    Slice& last = *slices_.back();
+    iovecs[num_used].mem_ = last.reservableStart();
+    iovecs[num_used].len_ = std::min(remaining, last.reservableSize());
+    remaining -= iovecs[num_used].len_;
+    num_used++;
+  }
+
+  // Append fresh slices for the rest. The final slice is sized to cover all remaining space
+  // in case we are running out of iovecs.
+  while (remaining > 0 && num_used < num_iovecs) {
+    const uint64_t slice_size =
+        (num_used == num_iovecs - 1) ? remaining : Slice::default_slice_size_;
+    slices_.emplace_back(Slice::create(slice_size));
+    Slice& slice = *slices_.back();
+    iovecs[num_used].mem_ = slice.reservableStart();
+    iovecs[num_used].len_ = std::min(remaining, slice.reservableSize());
+    remaining -= iovecs[num_used].len_;
+    num_used++;
+  }
+
+  ASSERT(num_used >= 1);
+  return num_used;
 }
 
 ssize_t OwnedImpl::search(const void* data, uint64_t size, size_t start) const {
-  evbuffer_ptr start_ptr;
-  if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+  if (size == 0) {
+    return (start <= length_) ? start : -1;
+  }
+  if (start + size > length_) {
     return -1;
   }
 
-  evbuffer_ptr result_ptr =
-      evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
-  return result_ptr.pos;
-}
+  // Scan each slice for the needle's first byte with memchr(), which libc vectorizes, so the
+  // bulk of the work (skipping non-matching bytes, e.g. Redis payload between CRLFs) runs at
+  // memory bandwidth instead of one compare per byte. Candidates are then verified with
+  // memcmp(), continuing into subsequent slices when the match spans a slice boundary.
+  const uint8_t* needle = static_cast<const uint8_t*>(data);
+  size_t offset = 0;
+  for (size_t i = 0; i < slices_.size(); i++) {
+    const Slice& slice = *slices_[i];
+    const uint64_t slice_size = slice.dataSize();
+    if (start >= offset + slice_size) {
+      offset += slice_size;
+      continue;
+    }
 
-int OwnedImpl::write(int fd) { return evbuffer_write(buffer_.get(), fd); }
+    const uint8_t* base = slice.dataStart();
+    uint64_t scan = (start > offset) ? start - offset : 0;
+    while (scan < slice_size) {
+      const uint8_t* hit =
+          static_cast<const uint8_t*>(memchr(base + scan, needle[0], slice_size - scan));
+      if (hit == nullptr) {
+        break;
+      }
+      const size_t candidate = offset + (hit - base);
+      if (candidate + size > length_) {
+        // Too close to the end of the buffer for the needle to fit; no later candidate can
+        // match either.
+        return -1;
+      }
 
-OwnedImpl::OwnedImpl() : buffer_(evbuffer_new()) {}
+      // Verify the candidate, walking the slice chain from where the first byte was found.
+      uint64_t matched = 1;
+      uint64_t slice_index = (hit - base) + 1;
+      const uint8_t* verify_base = base;
+      uint64_t verify_size = slice_size;
+      size_t j = i;
+      bool is_match = true;
+      while (matched < size) {
+        if (slice_index == verify_size) {
+          j++;
+          ASSERT(j < slices_.size());
+          verify_base = slices_[j]->dataStart();
+          verify_size = slices_[j]->dataSize();
+          slice_index = 0;
+          continue;
+        }
+        const uint64_t compare_size = std::min(size - matched, verify_size - slice_index);
+        if (0 != memcmp(verify_base + slice_index, needle + matched, compare_size)) {
+          is_match = false;
+          break;
+        }
+        matched += compare_size;
+        slice_index += compare_size;
+      }
+      if (is_match) {
+        return candidate;
+      }
+      scan = (hit - base) + 1;
+    }
 
-OwnedImpl::OwnedImpl(const std::string& data) : OwnedImpl() { add(data); }
+    offset += slice_size;
+  }
+  return -1;
+}
 
-OwnedImpl::OwnedImpl(const Instance& data) : OwnedImpl() { add(data); }
+int OwnedImpl::write(int fd) {
+  constexpr uint64_t MaxSlices = 16;
+  RawSlice slices[MaxSlices];
+  const uint64_t num_slices = getRawSlices(slices, MaxSlices);
+  if (num_slices == 0) {
+    return 0;
+  }
+  struct iovec iov[MaxSlices];
+  for (uint64_t i = 0; i < num_slices; i++) {
+    iov[i].iov_base = slices[i].mem_;
+    iov[i].iov_len = slices[i].len_;
+  }
+  const ssize_t rc = writev(fd, iov, num_slices);
+  if (rc > 0) {
+    drain(rc);
+  }
+  return rc;
+}
 
-OwnedImpl::OwnedImpl(const void* data, uint64_t size) : OwnedImpl() { add(data, size); }
+int OwnedImpl::writeZeroCopy(int fd, std::vector<SlicePtr>& in_flight) {
+#if defined(__linux__) && defined(MSG_ZEROCOPY)
+  constexpr uint64_t MaxSlices = 16;
+  RawSlice slices[MaxSlices];
+  const uint64_t num_slices = getRawSlices(slices, MaxSlices);
+  if (num_slices == 0) {
+    return 0;
+  }
+  struct iovec iov[MaxSlices];
+  for (uint64_t i = 0; i < num_slices; i++) {
+    iov[i].iov_base = slices[i].mem_;
+    iov[i].iov_len = slices[i].len_;
+  }
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = num_slices;
+  const ssize_t rc = sendmsg(fd, &msg, MSG_ZEROCOPY);
+  if (rc <= 0) {
+    return rc;
+  }
+
+  // The kernel now references the sent bytes' pages directly, so every slice the send touched
+  // must stay allocated until the completion notification arrives. Fully sent slices move to
+  // the caller's in flight list. A partially sent front slice also moves there, with its unsent
+  // remainder copied into a fresh slice; the copy is bounded by one slice and is noise against
+  // the large writes that take this path.
+  uint64_t remaining = rc;
+  while (remaining > 0) {
+    ASSERT(!slices_.empty());
+    Slice& front = *slices_.front();
+    const uint64_t slice_size = front.dataSize();
+    if (slice_size == 0) {
+      // Empty slices were not part of the send and recycle as usual.
+      popFront();
+      continue;
+    }
+    if (slice_size <= remaining) {
+      in_flight.emplace_back(std::move(slices_.front()));
+      slices_.pop_front();
+      length_ -= slice_size;
+      remaining -= slice_size;
+    } else {
+      front.drain(remaining);
+      length_ -= remaining;
+      remaining = 0;
+      SlicePtr unsent = Slice::create(front.dataSize());
+      unsent->append(front.dataStart(), front.dataSize());
+      in_flight.emplace_back(std::move(slices_.front()));
+      slices_.pop_front();
+      slices_.emplace_front(std::move(unsent));
+    }
+  }
+
+  // As in drain(), remove any leading empty slices left behind by uncommitted reservations.
+  while (!slices_.empty() && slices_.front()->dataSize() == 0) {
+    popFront();
+  }
+  return rc;
+#else
+  UNREFERENCED_PARAMETER(in_flight);
+  return write(fd);
+#endif
+}
 
 } // namespace Buffer
 } // namespace Envoy
@@ -1,37 +1,152 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 
-#include "common/event/libevent.h"
-
 namespace Envoy {
 namespace Buffer {
 
-class LibEventInstance : public Instance {
+/**
+ * A contiguous block of buffer memory. Each slice has a data section, bracketed by a drained
+ * prefix and a reservable suffix:
+ *
+ *   +----------------+--------------+----------------------+
+ *   | drained        | data         | reservable           |
+ *   +----------------+--------------+----------------------+
+ *   ^storage_        ^dataStart()   ^reservableStart()     ^storage_ + capacity_
+ *
+ * Bytes are appended into the reservable section and drained from the front of the data
+ * section, so a slice never needs to shuffle memory.
+ */
+class Slice {
+public:
+  typedef std::unique_ptr<Slice> SlicePtr;
+
+  /**
+   * Default slice capacity. Slices are allocated at this fixed size unless a caller reserves
+   * a larger contiguous block.
+   */
+  static constexpr uint64_t default_slice_size_ = 4096;
+
+  /**
+   * Create a slice with at least min_capacity bytes of reservable space. The capacity is
+   * rounded up to a multiple of the default slice size so allocations stay uniform. Default
+   * size slices are recycled through the calling thread's SlicePool if one is installed.
+   */
+  static SlicePtr create(uint64_t min_capacity);
+
+  /**
+   * Return a slice that is no longer needed. Default size slices go back to the calling
+   * thread's SlicePool if one is installed; all others are freed.
+   */
+  static void recycle(SlicePtr&& slice);
+
+  uint64_t capacity() const { return capacity_; }
+
+  /**
+   * Reset the slice to the empty state so it can be reused.
+   */
+  void reset() {
+    data_ = 0;
+    reservable_ = 0;
+  }
+
+  uint64_t dataSize() const { return reservable_ - data_; }
+  uint64_t reservableSize() const { return capacity_ - reservable_; }
+  uint8_t* dataStart() { return storage_.get() + data_; }
+  const uint8_t* dataStart() const { return storage_.get() + data_; }
+  uint8_t* reservableStart() { return storage_.get() + reservable_; }
+
+  /**
+   * Copy as much of the supplied data as fits into the reservable section.
+   * @return the number of bytes copied.
+   */
+  uint64_t append(const void* data, uint64_t size);
+
+  /**
+   * Remove size bytes from the front of the data section. size must be <= dataSize().
+   */
+  void drain(uint64_t size);
+
+  /**
+   * Mark size bytes of the reservable section, previously exposed via reservableStart(),
+   * as containing valid data.
+   */
+  void commit(uint64_t size);
+
+private:
+  Slice(uint64_t capacity) : capacity_(capacity), storage_(new uint8_t[capacity]) {}
+
+  const uint64_t capacity_;
+  uint64_t data_{0};
+  uint64_t reservable_{0};
+  std::unique_ptr<uint8_t[]> storage_;
+};
+
+typedef Slice::SlicePtr SlicePtr;
+
+/**
+ * A free list of default size slices. A pool is installed as the active pool for the thread
+ * that owns it (one per dispatcher), so steady state proxying recycles buffer memory without
+ * hitting the allocator. The pool performs no locking and must only be used from its thread.
+ */
+class SlicePool {
 public:
-  // Allows access into the underlying buffer for move() optimizations.
-  virtual Event::Libevent::BufferPtr& buffer() PURE;
-  // Called after accessing the memory in buffer() directly to allow any post-processing.
-  virtual void postProcess() PURE;
+  SlicePool(uint64_t max_free_slices = DEFAULT_MAX_FREE_SLICES) : max_free_slices_(max_free_slices) {}
+  ~SlicePool();
+
+  /**
+   * Install this pool as the active pool for the calling thread. Replaces any previously
+   * installed pool.
+   */
+  void installOnThread();
+
+  /**
+   * @return SlicePtr a recycled slice, or nullptr if the free list is empty.
+   */
+  SlicePtr acquire();
+
+  /**
+   * Return a default size slice to the free list, or free it if the list is full.
+   */
+  void release(SlicePtr&& slice);
+
+  /**
+   * @return SlicePool* the pool installed on the calling thread, or nullptr.
+   */
+  static SlicePool* activePool() { return active_pool_; }
+
+  uint64_t freeSlices() const { return free_slices_.size(); }
+
+private:
+  // Bounds pool memory at 4MB of idle slices per worker.
+  static const uint64_t DEFAULT_MAX_FREE_SLICES = 1024;
+
+  static thread_local SlicePool* active_pool_;
+
+  const uint64_t max_free_slices_;
+  std::vector<SlicePtr> free_slices_;
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
- *
- * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
- * compatible with non-LibEventInstance buffers.
+ * A buffer implementation that owns a chain of fixed-size slices. move() transfers slice
+ * ownership without copying, and reserve()/commit() hand out the reservable tails of the
+ * slices directly so socket reads land in their final location.
  */
-class OwnedImpl : public LibEventInstance {
+class OwnedImpl : public Instance {
 public:
   OwnedImpl();
   OwnedImpl(const std::string& data);
   OwnedImpl(const Instance& data);
   OwnedImpl(const void* data, uint64_t size);
+  ~OwnedImpl();
 
-  // LibEventInstance
+  // Buffer::Instance
   void add(const void* data, uint64_t size) override;
   void add(const std::string& data) override;
   void add(const Instance& data) override;
@@ -46,12 +161,31 @@ public:
   uint64_t reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) override;
   ssize_t search(const void* data, uint64_t size, size_t start) const override;
   int write(int fd) override;
-  void postProcess() override {}
 
-  Event::Libevent::BufferPtr& buffer() override { return buffer_; }
+  /**
+   * Write the buffer to the file descriptor with a MSG_ZEROCOPY sendmsg, which makes the kernel
+   * reference the slices' pages directly instead of copying them. Every slice touched by the
+   * send is moved into in_flight and must stay allocated until the kernel's completion
+   * notification for the send has been reaped from the socket's error queue. The caller is
+   * responsible for having enabled SO_ZEROCOPY on the descriptor and for the completion
+   * accounting. On platforms without MSG_ZEROCOPY this falls back to write().
+   * @return the number of bytes written or -1 with errno set, as write().
+   */
+  virtual int writeZeroCopy(int fd, std::vector<SlicePtr>& in_flight);
+
+  // Called after another buffer moves data out of this buffer, to allow any post-processing
+  // such as watermark checks.
+  virtual void postProcess() {}
 
 private:
-  Event::Libevent::BufferPtr buffer_;
+  // Append a slice to the chain, taking ownership.
+  void appendSlice(SlicePtr&& slice);
+
+  // Remove the front slice from the chain and recycle it.
+  void popFront();
+
+  std::deque<SlicePtr> slices_;
+  uint64_t length_{0};
 };
 
 } // namespace Buffer
@@ -58,6 +58,12 @@ int WatermarkBuffer::write(int fd) {
   return bytes_written;
 }
 
+int WatermarkBuffer::writeZeroCopy(int fd, std::vector<SlicePtr>& in_flight) {
+  int bytes_written = OwnedImpl::writeZeroCopy(fd, in_flight);
+  checkLowWatermark();
+  return bytes_written;
+}
+
 void WatermarkBuffer::setWatermarks(uint32_t low_watermark, uint32_t high_watermark) {
   ASSERT(low_watermark < high_watermark || (high_watermark == 0 && low_watermark == 0));
   low_watermark_ = low_watermark;
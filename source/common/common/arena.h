@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * A simple bump pointer allocator. Allocations are pointer arithmetic out of larger chunks and
+ * the memory is freed wholesale when the arena is destroyed; there is no per-object free. This
+ * fits groups of small objects that share a lifetime (e.g. everything hanging off an HTTP
+ * stream), where it replaces a malloc/free pair per object with a pointer bump.
+ *
+ * The arena only manages memory. The owner of an object constructed via make() must still run
+ * its destructor before the arena goes away, typically by holding it in a unique_ptr with an
+ * ArenaDeleter.
+ */
+class Arena : NonCopyable {
+public:
+  Arena(size_t chunk_size = DefaultChunkSize) : chunk_size_(chunk_size) {}
+
+  /**
+   * Allocate raw memory from the arena.
+   * @param size supplies the number of bytes to allocate.
+   * @param alignment supplies the required alignment. Must be a power of two.
+   */
+  void* allocate(size_t size, size_t alignment) {
+    ASSERT((alignment & (alignment - 1)) == 0);
+    uintptr_t aligned = align(reinterpret_cast<uintptr_t>(next_), alignment);
+    if (aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+      // Allocations larger than the chunk size get a dedicated chunk.
+      addChunk(size + alignment);
+      aligned = align(reinterpret_cast<uintptr_t>(next_), alignment);
+    }
+
+    next_ = reinterpret_cast<uint8_t*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  /**
+   * Construct a T in the arena. @see the class comment for destruction requirements.
+   */
+  template <class T, class... Args> T* make(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @return the number of chunks backing the arena, exposed for testing.
+   */
+  size_t numChunks() const { return chunks_.size(); }
+
+private:
+  static uintptr_t align(uintptr_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+  }
+
+  void addChunk(size_t min_size) {
+    const size_t size = std::max(chunk_size_, min_size);
+    chunks_.emplace_back(new uint8_t[size]);
+    next_ = chunks_.back().get();
+    end_ = next_ + size;
+  }
+
+  static const size_t DefaultChunkSize = 4096;
+
+  const size_t chunk_size_;
+  std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+  uint8_t* next_{};
+  uint8_t* end_{};
+};
+
+/**
+ * Deleter for unique_ptrs to arena allocated objects: runs the destructor only. The memory
+ * itself is reclaimed when the owning arena is destroyed.
+ */
+struct ArenaDeleter {
+  template <class T> void operator()(T* object) const { object->~T(); }
+};
+
+} // namespace Envoy
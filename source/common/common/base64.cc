@@ -42,142 +42,147 @@ std::string Base64::decode(const std::string& input) {
     }
   }
   std::string result;
-  result.reserve(max_length);
-
-  uint64_t bytes_left = input.length();
-  uint64_t cur_read = 0;
-
-  // Read input string by group of 4 chars, length of input string must be divided evenly by 4.
-  // Decode 4 chars 6 bits each into 3 chars 8 bits each.
-  while (bytes_left > 0) {
-    // Take first 6 bits from 1st converted char and first 2 bits from 2nd converted char,
-    // make 8 bits char from it.
-    // Use conversion table to map char to decoded value (value is between 0 and 63 inclusive for a
-    // valid character).
-    const unsigned char a = REVERSE_LOOKUP_TABLE[static_cast<uint32_t>(input[cur_read])];
-    const unsigned char b = REVERSE_LOOKUP_TABLE[static_cast<uint32_t>(input[cur_read + 1])];
-    if (a == 64 || b == 64) {
-      // Input contains an invalid character.
+  result.resize(max_length);
+  char* out = &result[0];
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(input.data());
+
+  // Decode all groups but the last in a branch-light loop: padding is only legal in the last
+  // group, so any value of 64 (invalid character or '=') fails the whole input. Valid decoded
+  // values are < 64, so one test of the OR of the group catches all four characters.
+  const uint64_t full_groups = input.length() / 4 - 1;
+  for (uint64_t i = 0; i < full_groups; i++) {
+    const unsigned char a = REVERSE_LOOKUP_TABLE[in[0]];
+    const unsigned char b = REVERSE_LOOKUP_TABLE[in[1]];
+    const unsigned char c = REVERSE_LOOKUP_TABLE[in[2]];
+    const unsigned char d = REVERSE_LOOKUP_TABLE[in[3]];
+    if ((a | b | c | d) & 0x40) {
       return EMPTY_STRING;
     }
-    result.push_back(a << 2 | b >> 4);
-    const unsigned char c = REVERSE_LOOKUP_TABLE[static_cast<uint32_t>(input[cur_read + 2])];
-
-    // Decoded value 64 means invalid character unless we already know it is a valid padding.
-    // If so, following characters are all padding.
-    // Also we should check there are no unused bits.
-    if (c == 64) {
-      if (first_padding_index != cur_read + 2) {
-        // Input contains an invalid character.
-        return EMPTY_STRING;
-      } else if (b & 0b1111) {
-        // There are unused bits at tail.
-        return EMPTY_STRING;
-      } else {
-        return result;
-      }
+    out[0] = a << 2 | b >> 4;
+    out[1] = b << 4 | c >> 2;
+    out[2] = c << 6 | d;
+    in += 4;
+    out += 3;
+  }
+
+  // The last group may end in one or two padding characters, and the bits a padding character
+  // would have carried must be zero.
+  const unsigned char a = REVERSE_LOOKUP_TABLE[in[0]];
+  const unsigned char b = REVERSE_LOOKUP_TABLE[in[1]];
+  if ((a | b) & 0x40) {
+    return EMPTY_STRING;
+  }
+  *out++ = a << 2 | b >> 4;
+  const unsigned char c = REVERSE_LOOKUP_TABLE[in[2]];
+  if (c == 64) {
+    if (first_padding_index != input.length() - 2 || (b & 0b1111)) {
+      return EMPTY_STRING;
     }
-    // Take last 4 bits from 2nd converted char and 4 first bits from 3rd converted char.
-    result.push_back(b << 4 | c >> 2);
-
-    const unsigned char d = REVERSE_LOOKUP_TABLE[static_cast<uint32_t>(input[cur_read + 3])];
-    if (d == 64) {
-      if (first_padding_index != cur_read + 3) {
-        // Input contains an invalid character.
-        return EMPTY_STRING;
-      } else if (c & 0b11) {
-        // There are unused bits at tail.
-        return EMPTY_STRING;
-      } else {
-        return result;
-      }
+    return result;
+  }
+  *out++ = b << 4 | c >> 2;
+  const unsigned char d = REVERSE_LOOKUP_TABLE[in[3]];
+  if (d == 64) {
+    if (first_padding_index != input.length() - 1 || (c & 0b11)) {
+      return EMPTY_STRING;
     }
-    // Take last 2 bits from 3rd converted char and all(6) bits from 4th converted char.
-    result.push_back(c << 6 | d);
-
-    cur_read += 4;
-    bytes_left -= 4;
+    return result;
   }
-
+  *out = c << 6 | d;
   return result;
 }
 
-void Base64::encodeBase(const uint8_t cur_char, uint64_t pos, uint8_t& next_c, std::string& ret) {
-  switch (pos % 3) {
-  case 0:
-    ret.push_back(CHAR_TABLE[cur_char >> 2]);
-    next_c = (cur_char & 0x03) << 4;
-    break;
-  case 1:
-    ret.push_back(CHAR_TABLE[next_c | (cur_char >> 4)]);
-    next_c = (cur_char & 0x0f) << 2;
-    break;
-  case 2:
-    ret.push_back(CHAR_TABLE[next_c | (cur_char >> 6)]);
-    ret.push_back(CHAR_TABLE[cur_char & 0x3f]);
-    next_c = 0;
-    break;
-  }
+void Base64::encodeGroup(const uint8_t* in, char* out) {
+  out[0] = CHAR_TABLE[in[0] >> 2];
+  out[1] = CHAR_TABLE[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+  out[2] = CHAR_TABLE[((in[1] & 0x0f) << 2) | (in[2] >> 6)];
+  out[3] = CHAR_TABLE[in[2] & 0x3f];
 }
 
-void Base64::encodeLast(uint64_t pos, uint8_t last_char, std::string& ret) {
-  switch (pos % 3) {
-  case 1:
-    ret.push_back(CHAR_TABLE[last_char]);
-    ret.push_back('=');
-    ret.push_back('=');
-    break;
-  case 2:
-    ret.push_back(CHAR_TABLE[last_char]);
-    ret.push_back('=');
-    break;
-  default:
-    break;
+void Base64::encodeTail(const uint8_t* group, uint64_t group_len, char* out) {
+  if (group_len == 1) {
+    out[0] = CHAR_TABLE[group[0] >> 2];
+    out[1] = CHAR_TABLE[(group[0] & 0x03) << 4];
+    out[2] = '=';
+    out[3] = '=';
+  } else if (group_len == 2) {
+    out[0] = CHAR_TABLE[group[0] >> 2];
+    out[1] = CHAR_TABLE[((group[0] & 0x03) << 4) | (group[1] >> 4)];
+    out[2] = CHAR_TABLE[(group[1] & 0x0f) << 2];
+    out[3] = '=';
   }
 }
 
 std::string Base64::encode(const Buffer::Instance& buffer, uint64_t length) {
-  uint64_t output_length = (std::min(length, buffer.length()) + 2) / 3 * 4;
+  const uint64_t input_length = std::min(length, buffer.length());
   std::string ret;
-  ret.reserve(output_length);
+  ret.resize((input_length + 2) / 3 * 4);
+  char* out = &ret[0];
 
   uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
   Buffer::RawSlice slices[num_slices];
   buffer.getRawSlices(slices, num_slices);
 
-  uint64_t j = 0;
-  uint8_t next_c = 0;
-  for (Buffer::RawSlice& slice : slices) {
-    const uint8_t* slice_mem = static_cast<const uint8_t*>(slice.mem_);
+  // Encode whole 3-byte groups straight out of slice memory; only the (at most) 2 bytes of a
+  // group that spans a slice boundary take the byte-at-a-time path. The table lookups in the
+  // group kernel have no cross-iteration dependency, unlike the previous per-byte state machine,
+  // so the compiler can unroll and vectorize the inner loop.
+  uint8_t group[3];
+  uint64_t group_len = 0;
+  uint64_t remaining = input_length;
+  for (const Buffer::RawSlice& slice : slices) {
+    const uint8_t* mem = static_cast<const uint8_t*>(slice.mem_);
+    uint64_t len = std::min(static_cast<uint64_t>(slice.len_), remaining);
+    remaining -= len;
+
+    // Finish a group left over from the previous slice.
+    while (group_len > 0 && group_len < 3 && len > 0) {
+      group[group_len++] = *mem++;
+      len--;
+    }
+    if (group_len == 3) {
+      encodeGroup(group, out);
+      out += 4;
+      group_len = 0;
+    }
+
+    while (len >= 3) {
+      encodeGroup(mem, out);
+      mem += 3;
+      out += 4;
+      len -= 3;
+    }
 
-    for (uint64_t i = 0; i < slice.len_ && j < length; ++i, ++j) {
-      encodeBase(slice_mem[i], j, next_c, ret);
+    // Stash the tail for the next slice (or for final padding).
+    while (len > 0) {
+      group[group_len++] = *mem++;
+      len--;
     }
 
-    if (j == length) {
+    if (remaining == 0) {
       break;
     }
   }
 
-  encodeLast(j, next_c, ret);
-
+  encodeTail(group, group_len, out);
   return ret;
 }
 
 std::string Base64::encode(const char* input, uint64_t length) {
-  uint64_t output_length = (length + 2) / 3 * 4;
   std::string ret;
-  ret.reserve(output_length);
-
-  uint64_t pos = 0;
-  uint8_t next_c = 0;
-
-  for (uint64_t i = 0; i < length; ++i) {
-    encodeBase(input[i], pos++, next_c, ret);
+  ret.resize((length + 2) / 3 * 4);
+  char* out = &ret[0];
+
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(input);
+  uint64_t remaining = length;
+  while (remaining >= 3) {
+    encodeGroup(in, out);
+    in += 3;
+    out += 4;
+    remaining -= 3;
   }
 
-  encodeLast(pos, next_c, ret);
-
+  encodeTail(in, remaining, out);
   return ret;
 }
 } // namespace Envoy
@@ -33,14 +33,13 @@ public:
 
 private:
   /**
-   * Helper method for encoding. This is used to encode all of the characters from the input string.
+   * Encode one whole 3-byte group into 4 output characters.
    */
-  static void encodeBase(const uint8_t cur_char, uint64_t pos, uint8_t& next_c, std::string& ret);
+  static void encodeGroup(const uint8_t* in, char* out);
 
   /**
-   * Encode last characters. It appends '=' chars to the ret if input
-   * string length is not divisible by 3.
+   * Encode a final partial group (0-2 bytes), padding the output with '=' as needed.
    */
-  static void encodeLast(uint64_t pos, uint8_t last_char, std::string& ret);
+  static void encodeTail(const uint8_t* group, uint64_t group_len, char* out);
 };
 } // namespace Envoy
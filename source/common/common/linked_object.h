@@ -8,11 +8,12 @@
 namespace Envoy {
 /**
  * Mixin class that allows an object contained in a unique pointer to be easily linked and unlinked
- * from lists.
+ * from lists. The optional Deleter parameter supports objects whose storage is managed elsewhere
+ * (e.g. arena allocated objects that only need their destructor run).
  */
-template <class T> class LinkedObject {
+template <class T, class Deleter = std::default_delete<T>> class LinkedObject {
 public:
-  typedef std::list<std::unique_ptr<T>> ListType;
+  typedef std::list<std::unique_ptr<T, Deleter>> ListType;
 
   /**
    * @return the list iterator for the object.
@@ -44,7 +45,7 @@ public:
    * @param item supplies the item to move in.
    * @param list supplies the list to move the item into.
    */
-  void moveIntoList(std::unique_ptr<T>&& item, ListType& list) {
+  void moveIntoList(std::unique_ptr<T, Deleter>&& item, ListType& list) {
     ASSERT(!inserted_);
     inserted_ = true;
     entry_ = list.emplace(list.begin(), std::move(item));
@@ -55,7 +56,7 @@ public:
    * @param item supplies the item to move in.
    * @param list supplies the list to move the item into.
    */
-  void moveIntoListBack(std::unique_ptr<T>&& item, ListType& list) {
+  void moveIntoListBack(std::unique_ptr<T, Deleter>&& item, ListType& list) {
     ASSERT(!inserted_);
     inserted_ = true;
     entry_ = list.emplace(list.end(), std::move(item));
@@ -65,11 +66,11 @@ public:
    * Remove this item from a list.
    * @param list supplies the list to remove from. This item should be in this list.
    */
-  std::unique_ptr<T> removeFromList(ListType& list) {
+  std::unique_ptr<T, Deleter> removeFromList(ListType& list) {
     ASSERT(inserted_);
     ASSERT(std::find(list.begin(), list.end(), *entry_) != list.end());
 
-    std::unique_ptr<T> removed = std::move(*entry_);
+    std::unique_ptr<T, Deleter> removed = std::move(*entry_);
     list.erase(entry_);
     inserted_ = false;
     return removed;
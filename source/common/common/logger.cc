@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include <iostream>
+#include <list>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "envoy/thread/thread.h"
@@ -26,16 +29,85 @@ std::vector<Logger>& Registry::allLoggers() {
   return *all_loggers;
 }
 
-void LockingStderrSink::log(const spdlog::details::log_msg& msg) {
+LockingStderrSink::~LockingStderrSink() {
+  if (thread_) {
+    {
+      std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+      shutdown_ = true;
+    }
+    queue_event_.notify_one();
+    thread_->join();
+  }
+}
+
+void LockingStderrSink::startAsync(uint64_t max_buffered_lines) {
+  max_buffered_lines_ = max_buffered_lines;
+  thread_.reset(new std::thread([this]() -> void { threadRoutine(); }));
+}
+
+void LockingStderrSink::write(const std::string& message) {
   Thread::OptionalLockGuard<Thread::BasicLockable> guard(lock_);
-  std::cerr << msg.formatted.str();
+  std::cerr << message;
+}
+
+void LockingStderrSink::log(const spdlog::details::log_msg& msg) {
+  // err and above are written in line so that an immediately following abort cannot lose them.
+  if (thread_ && msg.level < spdlog::level::err) {
+    bool notify = false;
+    {
+      std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+      if (queue_.size() >= max_buffered_lines_) {
+        // Dropping is what makes runaway verbose logging survivable: the caller never blocks on
+        // log I/O. The drop count is surfaced as a server stat.
+        dropped_lines_++;
+      } else {
+        queue_.emplace_back(msg.formatted.str());
+        notify = true;
+      }
+    }
+    if (notify) {
+      queue_event_.notify_one();
+    }
+    return;
+  }
+
+  write(msg.formatted.str());
 }
 
 void LockingStderrSink::flush() {
+  if (thread_) {
+    // Wait for the log thread to drain what has been queued so far.
+    std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+    drained_event_.wait(queue_lock,
+                        [this]() -> bool { return queue_.empty() && !write_in_progress_; });
+  }
+
   Thread::OptionalLockGuard<Thread::BasicLockable> guard(lock_);
   std::cerr << std::flush;
 }
 
+void LockingStderrSink::threadRoutine() {
+  std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+  while (true) {
+    queue_event_.wait(queue_lock, [this]() -> bool { return shutdown_ || !queue_.empty(); });
+    while (!queue_.empty()) {
+      std::list<std::string> batch;
+      batch.swap(queue_);
+      write_in_progress_ = true;
+      queue_lock.unlock();
+      for (const std::string& message : batch) {
+        write(message);
+      }
+      queue_lock.lock();
+      write_in_progress_ = false;
+    }
+    drained_event_.notify_all();
+    if (shutdown_) {
+      return;
+    }
+  }
+}
+
 spdlog::logger& Registry::getLog(Id id) { return *allLoggers()[static_cast<int>(id)].logger_; }
 
 void Registry::initialize(uint64_t log_level, Thread::BasicLockable& lock) {
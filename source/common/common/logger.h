@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "envoy/thread/thread.h"
@@ -60,18 +65,52 @@ private:
 };
 
 /**
- * An optionally locking stderr logging sink.
+ * An optionally locking stderr logging sink. Writes can optionally be handed off to a dedicated
+ * thread (see startAsync()) so that verbose logging does not stall callers on stderr I/O.
  */
 class LockingStderrSink : public spdlog::sinks::sink {
 public:
+  ~LockingStderrSink();
+
   void setLock(Thread::BasicLockable& lock) { lock_ = &lock; }
 
+  /**
+   * Start writing buffered lines on a dedicated thread. Messages below the err level are queued
+   * and written by that thread; err and above (assertion failures, panics) are still written
+   * synchronously so that an immediately following abort cannot lose them. When the buffer is
+   * full new lines are dropped and counted rather than blocking the caller.
+   * @param max_buffered_lines supplies the buffer size in lines.
+   */
+  void startAsync(uint64_t max_buffered_lines = 4096);
+
+  /**
+   * @return uint64_t the number of log lines dropped due to a full buffer.
+   */
+  uint64_t droppedLines() const { return dropped_lines_; }
+
   // spdlog::sinks::sink
   void log(const spdlog::details::log_msg& msg) override;
   void flush() override;
 
 private:
+  void threadRoutine();
+  void write(const std::string& message);
+
   Thread::BasicLockable* lock_{};
+
+  // The members below are only used after startAsync(). This is a std::thread rather than
+  // Thread::Thread because the latter asserts through the logging system, which would be a
+  // dependency cycle; the routine does not throw so the exception concern from thread.h does not
+  // apply.
+  std::unique_ptr<std::thread> thread_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_event_;
+  std::condition_variable drained_event_;
+  std::list<std::string> queue_;
+  uint64_t max_buffered_lines_{};
+  bool write_in_progress_{};
+  bool shutdown_{};
+  std::atomic<uint64_t> dropped_lines_{};
 };
 
 /**
@@ -136,20 +175,33 @@ protected:
 
 /**
  * Base logging macros.  It is expected that users will use the convenience macros below rather than
- * invoke these directly.
+ * invoke these directly. The level check is a single relaxed atomic load and branch; the format
+ * arguments are not evaluated unless the line is actually going to be emitted.
  */
+#define ENVOY_LOG_CHECKED_TO_LOGGER(LOGGER, LEVEL, ...)                                            \
+  do {                                                                                             \
+    if ((LOGGER).should_log(spdlog::level::LEVEL)) {                                               \
+      (LOGGER).LEVEL(LOG_PREFIX __VA_ARGS__);                                                      \
+    }                                                                                              \
+  } while (0)
+
 #ifdef NVLOG
 #define ENVOY_LOG_trace_TO_LOGGER(LOGGER, ...)
 #define ENVOY_LOG_debug_TO_LOGGER(LOGGER, ...)
 #else
-#define ENVOY_LOG_trace_TO_LOGGER(LOGGER, ...) LOGGER.trace(LOG_PREFIX __VA_ARGS__)
-#define ENVOY_LOG_debug_TO_LOGGER(LOGGER, ...) LOGGER.debug(LOG_PREFIX __VA_ARGS__)
+#define ENVOY_LOG_trace_TO_LOGGER(LOGGER, ...)                                                    \
+  ENVOY_LOG_CHECKED_TO_LOGGER(LOGGER, trace, ##__VA_ARGS__)
+#define ENVOY_LOG_debug_TO_LOGGER(LOGGER, ...)                                                    \
+  ENVOY_LOG_CHECKED_TO_LOGGER(LOGGER, debug, ##__VA_ARGS__)
 #endif
 
-#define ENVOY_LOG_info_TO_LOGGER(LOGGER, ...) LOGGER.info(LOG_PREFIX __VA_ARGS__)
-#define ENVOY_LOG_warn_TO_LOGGER(LOGGER, ...) LOGGER.warn(LOG_PREFIX __VA_ARGS__)
-#define ENVOY_LOG_err_TO_LOGGER(LOGGER, ...) LOGGER.err(LOG_PREFIX __VA_ARGS__)
-#define ENVOY_LOG_critical_TO_LOGGER(LOGGER, ...) LOGGER.critical(LOG_PREFIX __VA_ARGS__)
+#define ENVOY_LOG_info_TO_LOGGER(LOGGER, ...)                                                     \
+  ENVOY_LOG_CHECKED_TO_LOGGER(LOGGER, info, ##__VA_ARGS__)
+#define ENVOY_LOG_warn_TO_LOGGER(LOGGER, ...)                                                     \
+  ENVOY_LOG_CHECKED_TO_LOGGER(LOGGER, warn, ##__VA_ARGS__)
+#define ENVOY_LOG_err_TO_LOGGER(LOGGER, ...) ENVOY_LOG_CHECKED_TO_LOGGER(LOGGER, err, ##__VA_ARGS__)
+#define ENVOY_LOG_critical_TO_LOGGER(LOGGER, ...)                                                  \
+  ENVOY_LOG_CHECKED_TO_LOGGER(LOGGER, critical, ##__VA_ARGS__)
 
 /**
  * Convenience macro to log to a user-specified logger.
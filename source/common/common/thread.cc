@@ -6,14 +6,55 @@
 #include <pthread.h>
 #endif
 
+#include <algorithm>
 #include <functional>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/macros.h"
 
+#include "fmt/format.h"
+
 namespace Envoy {
 namespace Thread {
 
+std::array<MutexTracer::Site, MutexTracer::MAX_SITES> MutexTracer::sites_;
+std::atomic<size_t> MutexTracer::num_sites_;
+
+MutexTracer::Site* MutexTracer::registerSite(const char* name) {
+  const size_t index = num_sites_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= MAX_SITES) {
+    return nullptr;
+  }
+  sites_[index].name_ = name;
+  return &sites_[index];
+}
+
+std::string MutexTracer::summary() {
+  std::vector<const Site*> sorted;
+  const size_t count = std::min(num_sites_.load(std::memory_order_relaxed), MAX_SITES);
+  for (size_t i = 0; i < count; i++) {
+    // A concurrent registerSite() may have claimed the slot but not yet published the name.
+    if (sites_[i].name_ != nullptr) {
+      sorted.push_back(&sites_[i]);
+    }
+  }
+
+  std::sort(sorted.begin(), sorted.end(), [](const Site* lhs, const Site* rhs) {
+    return lhs->wait_us_.load(std::memory_order_relaxed) >
+           rhs->wait_us_.load(std::memory_order_relaxed);
+  });
+
+  std::string output;
+  for (const Site* site : sorted) {
+    output += fmt::format("{}: acquires={} contended={} wait_us={}\n", site->name_,
+                          site->acquires_.load(std::memory_order_relaxed),
+                          site->contended_acquires_.load(std::memory_order_relaxed),
+                          site->wait_us_.load(std::memory_order_relaxed));
+  }
+  return output;
+}
+
 Thread::Thread(std::function<void()> thread_routine) : thread_routine_(thread_routine) {
   int rc = pthread_create(&thread_id_, nullptr,
                           [](void* arg) -> void* {
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 
 #include "envoy/thread/thread.h"
 
@@ -36,17 +40,85 @@ private:
 
 typedef std::unique_ptr<Thread> ThreadPtr;
 
+/**
+ * Registry of contention statistics for named mutexes. The instrumentation itself is compiled in
+ * with --define=mutex_tracing=enabled; without it named mutexes behave exactly like unnamed ones
+ * and the registry stays empty. Sites register once at mutex construction into a fixed size table
+ * of pre-allocated atomics, so recording on the lock path never allocates or locks.
+ */
+class MutexTracer {
+public:
+  struct Site {
+    const char* name_{};
+    std::atomic<uint64_t> acquires_{};
+    std::atomic<uint64_t> contended_acquires_{};
+    std::atomic<uint64_t> wait_us_{};
+  };
+
+  /**
+   * Register a contention tracking slot for a lock site.
+   * @param name supplies the site name. Must be a string literal (the registry does not copy).
+   * @return Site* the slot, or nullptr if the table is full.
+   */
+  static Site* registerSite(const char* name);
+
+  /**
+   * @return std::string a human readable summary of all registered sites, most total wait time
+   *         first.
+   */
+  static std::string summary();
+
+private:
+  static const size_t MAX_SITES = 64;
+
+  static std::array<Site, MAX_SITES> sites_;
+  static std::atomic<size_t> num_sites_;
+};
+
 /**
  * Implementation of BasicLockable
  */
 class MutexBasicLockable : public BasicLockable {
 public:
-  void lock() override { mutex_.lock(); }
+  MutexBasicLockable() {}
+
+  // Naming a mutex opts it into contention tracking when mutex tracing is compiled in; see
+  // MutexTracer. The name should identify the lock site.
+#ifdef ENVOY_MUTEX_TRACING
+  explicit MutexBasicLockable(const char* name) : site_(MutexTracer::registerSite(name)) {}
+#else
+  explicit MutexBasicLockable(const char*) {}
+#endif
+
+  // Thread::BasicLockable
+  void lock() override {
+#ifdef ENVOY_MUTEX_TRACING
+    if (site_ != nullptr) {
+      site_->acquires_.fetch_add(1, std::memory_order_relaxed);
+      if (mutex_.try_lock()) {
+        // Uncontended fast path: one try_lock() and one relaxed increment.
+        return;
+      }
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      mutex_.lock();
+      site_->contended_acquires_.fetch_add(1, std::memory_order_relaxed);
+      site_->wait_us_.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count(),
+                                std::memory_order_relaxed);
+      return;
+    }
+#endif
+    mutex_.lock();
+  }
   bool try_lock() override { return mutex_.try_lock(); }
   void unlock() override { mutex_.unlock(); }
 
 private:
   std::mutex mutex_;
+#ifdef ENVOY_MUTEX_TRACING
+  MutexTracer::Site* const site_{};
+#endif
 };
 
 } // namespace Thread
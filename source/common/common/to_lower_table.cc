@@ -1,5 +1,14 @@
 #include "common/common/to_lower_table.h"
 
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Envoy {
 ToLowerTable::ToLowerTable() {
   for (size_t c = 0; c < 256; c++) {
@@ -11,7 +20,49 @@ ToLowerTable::ToLowerTable() {
 }
 
 void ToLowerTable::toLowerCase(char* buffer, uint32_t size) const {
-  for (size_t i = 0; i < size; i++) {
+  // Branchless word-at-a-time path for the remaining tail (and for whole strings on
+  // architectures without a vector kernel above): set bit 0x20 on every byte in ['A', 'Z'].
+  // For each 7 bit value (high bit masked off), adding 0x3F carries into bit 7 iff the byte is
+  // >= 'A' and adding 0x25 carries into bit 7 iff the byte is > 'Z'; combining the two carries
+  // with the original high bit (to exclude non-ASCII bytes) yields a 0x80 mask over exactly the
+  // upper case bytes, which shifted down by two is the case bit.
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  // Vectorized path, 16 bytes at a time. Bytes in ['A', 'Z'] are found with two signed byte
+  // compares: non-ASCII bytes are negative in a signed compare so they fail the > 'A' - 1 test
+  // and are left untouched, exactly like the scalar paths. SSE2 is baseline for x86-64, so no
+  // runtime dispatch is needed.
+  for (; i + 16 <= size; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+    const __m128i is_upper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+                                           _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+    block = _mm_or_si128(block, _mm_and_si128(is_upper, _mm_set1_epi8(0x20)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i), block);
+  }
+#elif defined(__ARM_NEON)
+  // NEON has unsigned byte compares, so the range check is direct.
+  for (; i + 16 <= size; i += 16) {
+    uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(buffer + i));
+    const uint8x16_t is_upper =
+        vandq_u8(vcgeq_u8(block, vdupq_n_u8('A')), vcleq_u8(block, vdupq_n_u8('Z')));
+    block = vorrq_u8(block, vandq_u8(is_upper, vdupq_n_u8(0x20)));
+    vst1q_u8(reinterpret_cast<uint8_t*>(buffer + i), block);
+  }
+#endif
+
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, buffer + i, sizeof(word));
+    const uint64_t heptets = word & 0x7F7F7F7F7F7F7F7FULL;
+    const uint64_t ge_upper_a = heptets + 0x3F3F3F3F3F3F3F3FULL;
+    const uint64_t gt_upper_z = heptets + 0x2525252525252525ULL;
+    const uint64_t mask = ge_upper_a & ~gt_upper_z & ~word & 0x8080808080808080ULL;
+    word |= mask >> 2;
+    memcpy(buffer + i, &word, sizeof(word));
+  }
+
+  for (; i < size; i++) {
     buffer[i] = table_[static_cast<uint8_t>(buffer[i])];
   }
 }
@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * Static USDT tracepoints (provider "envoy") on request lifecycle hot paths. Tools such as
+ * bpftrace or perf can attach to them on live hosts without a redeploy, e.g.:
+ *
+ *   bpftrace -e 'usdt:/usr/local/bin/envoy:envoy:route_resolved { printf("%d %s\n", arg0,
+ *       str(arg1)); }'
+ *
+ * Probes are compiled in only when building with --define=usdt=enabled (which requires
+ * <sys/sdt.h> from the systemtap SDT development package). An unattached compiled-in probe is a
+ * single nop instruction; when the define is off the macros expand to nothing, so the default
+ * build is completely unchanged.
+ */
+#ifdef ENVOY_USDT_PROBES
+
+#include <sys/sdt.h>
+
+#define ENVOY_PROBE(name) DTRACE_PROBE(envoy, name)
+#define ENVOY_PROBE1(name, arg1) DTRACE_PROBE1(envoy, name, arg1)
+#define ENVOY_PROBE2(name, arg1, arg2) DTRACE_PROBE2(envoy, name, arg1, arg2)
+#define ENVOY_PROBE3(name, arg1, arg2, arg3) DTRACE_PROBE3(envoy, name, arg1, arg2, arg3)
+
+#else
+
+#define ENVOY_PROBE(name)
+#define ENVOY_PROBE1(name, arg1)
+#define ENVOY_PROBE2(name, arg1, arg2)
+#define ENVOY_PROBE3(name, arg1, arg2, arg3)
+
+#endif
@@ -17,8 +17,9 @@ namespace Config {
 
 /**
  * Filesystem inotify implementation of the API Subscription interface. This allows the API to be
- * consumed on filesystem changes to files containing the JSON canonical representation of
- * lists of ResourceType.
+ * consumed on filesystem changes to files containing a DiscoveryResponse, in any format
+ * MessageUtil::loadFromFile() understands (JSON canonical representation, or binary/text protobuf
+ * for .pb/.pb_text paths).
  */
 template <class ResourceType>
 class FilesystemSubscriptionImpl : public Config::Subscription<ResourceType>,
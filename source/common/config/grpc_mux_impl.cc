@@ -54,6 +54,11 @@ void GrpcMuxImpl::establishNewStream() {
   }
 
   for (const auto type_url : subscriptions_) {
+    // Nonces are stream scoped: replaying the nonce from a stream that died would make the first
+    // request on the new stream look like an ACK of a response this stream never sent. The last
+    // accepted version is retained so the management server can avoid resending config we already
+    // have.
+    requests_[type_url].clear_response_nonce();
     sendDiscoveryRequest(type_url);
   }
 }
@@ -21,9 +21,10 @@ namespace Config {
 /**
  * REST implementation of the API Subscription interface. This fetches the API via periodic polling
  * with jitter (based on RestApiFetcher). The REST requests are POSTs of the JSON canonical
- * representation of the DiscoveryRequest proto and the responses are in the form of the JSON
- * canonical representation of DiscoveryResponse. This implementation is responsible for translating
- * between the proto serializable objects in the Subscription API and the REST JSON representation.
+ * representation of the DiscoveryRequest proto. Responses may be either the JSON canonical
+ * representation of DiscoveryResponse or, if the management server honors the advertised Accept
+ * header, binary protobuf, which parses an order of magnitude faster and without the intermediate
+ * JSON DOM for large discovery payloads.
  */
 template <class ResourceType>
 class HttpSubscriptionImpl : public Http::RestApiFetcher,
@@ -68,16 +69,33 @@ public:
     stats_.update_attempt_.inc();
     request.headers().insertMethod().value().setReference(Http::Headers::get().MethodValues.Post);
     request.headers().insertPath().value(path_);
+    request.headers().insertContentType().value().setReference(
+        Http::Headers::get().ContentTypeValues.Json);
+    // Prefer a binary protobuf response; servers that do not support it keep replying with the
+    // JSON canonical representation.
+    request.headers().addReferenceKey(Http::Headers::get().Accept,
+                                      Http::Headers::get().ContentTypeValues.Protobuf + ", " +
+                                          Http::Headers::get().ContentTypeValues.Json);
     request.body().reset(new Buffer::OwnedImpl(MessageUtil::getJsonStringFromMessage(request_)));
   }
 
   void parseResponse(const Http::Message& response) override {
     envoy::api::v2::DiscoveryResponse message;
-    const auto status = Protobuf::util::JsonStringToMessage(response.bodyAsString(), &message);
-    if (!status.ok()) {
-      ENVOY_LOG(warn, "REST config JSON conversion error: {}", status.ToString());
-      handleFailure(nullptr);
-      return;
+    const Http::HeaderEntry* content_type = response.headers().ContentType();
+    if (content_type != nullptr &&
+        Http::Headers::get().ContentTypeValues.Protobuf == content_type->value().c_str()) {
+      if (!message.ParseFromString(response.bodyAsString())) {
+        ENVOY_LOG(warn, "REST config binary protobuf conversion error");
+        handleFailure(nullptr);
+        return;
+      }
+    } else {
+      const auto status = Protobuf::util::JsonStringToMessage(response.bodyAsString(), &message);
+      if (!status.ok()) {
+        ENVOY_LOG(warn, "REST config JSON conversion error: {}", status.ToString());
+        handleFailure(nullptr);
+        return;
+      }
     }
     const auto typed_resources = Config::Utility::getTypedResources<ResourceType>(message);
     try {
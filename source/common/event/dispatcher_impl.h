@@ -1,18 +1,20 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
-#include <list>
-#include <mutex>
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection_handler.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 #include "common/event/libevent.h"
+#include "common/event/timer_wheel.h"
 
 namespace Envoy {
 namespace Event {
@@ -31,7 +33,14 @@ public:
    */
   event_base& base() { return *base_; }
 
+  /**
+   * @return TimerWheel& the wheel backing this dispatcher's coarse granularity timers.
+   */
+  TimerWheel& timerWheel() { return timer_wheel_; }
+
   // Event::Dispatcher
+  MonotonicTime approximateMonotonicTime() const override { return approximate_monotonic_time_; }
+  SystemTime approximateSystemTime() const override { return approximate_system_time_; }
   void clearDeferredDeleteList() override;
   Network::ClientConnectionPtr
   createClientConnection(Network::Address::InstanceConstSharedPtr address,
@@ -56,13 +65,25 @@ public:
   TimerPtr createTimer(TimerCb cb) override;
   void deferredDelete(DeferredDeletablePtr&& to_delete) override;
   void exit() override;
+  void initializeStats(Stats::Scope& scope) override;
   SignalEventPtr listenForSignal(int signal_num, SignalCb cb) override;
   void post(std::function<void()> callback) override;
   void run(RunType type) override;
   Buffer::WatermarkFactory& getWatermarkFactory() override { return *buffer_factory_; }
 
 private:
+  // Node in the lock-free multi-producer post stack. The std::function member provides inline
+  // storage for small captures; only the node itself is a per-post allocation.
+  struct PostCallback {
+    PostCallback(std::function<void()>&& callback) : callback_(std::move(callback)) {}
+
+    std::function<void()> callback_;
+    PostCallback* next_{};
+  };
+
+  void onLoopDelayTimer();
   void runPostCallbacks();
+  void updateApproximateTime();
 #ifndef NDEBUG
   // Validate that an operation is thread safe, i.e. it's invoked on the same thread that the
   // dispatcher run loop is executing on. We allow run_tid_ == 0 for tests where we don't invoke
@@ -73,16 +94,31 @@ private:
 #endif
 
   Thread::ThreadId run_tid_{};
+  Buffer::SlicePool slice_pool_;
   Buffer::WatermarkFactoryPtr buffer_factory_;
   Libevent::BasePtr base_;
+  TimerWheel timer_wheel_;
   TimerPtr deferred_delete_timer_;
   TimerPtr post_timer_;
+  Stats::Scope* stats_scope_{};
+  TimerPtr loop_delay_timer_;
+  MonotonicTime expected_loop_delay_sample_;
   std::vector<DeferredDeletablePtr> to_delete_1_;
   std::vector<DeferredDeletablePtr> to_delete_2_;
   std::vector<DeferredDeletablePtr>* current_to_delete_;
-  std::mutex post_lock_;
-  std::list<std::function<void()>> post_callbacks_;
+  // Non-null while a bounded deletion pass over one of the vectors is in progress; the cursor
+  // tracks how far FIFO destruction has advanced through it.
+  std::vector<DeferredDeletablePtr>* draining_to_delete_{};
+  size_t deferred_delete_cursor_{};
+  // Head of the post stack. Producers push with a CAS; the dispatcher thread drains the whole
+  // stack with a single exchange. @see post() and runPostCallbacks().
+  std::atomic<PostCallback*> post_head_{nullptr};
   bool deferred_deleting_{};
+  // Cached clock readings behind approximateMonotonicTime()/approximateSystemTime(). Refreshed
+  // by the timer wheel as it ticks (and when it restarts from idle), so staleness is bounded by
+  // the wheel granularity whenever any timer is pending. See updateApproximateTime().
+  MonotonicTime approximate_monotonic_time_;
+  SystemTime approximate_system_time_;
 };
 
 } // namespace Event
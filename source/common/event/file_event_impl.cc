@@ -36,6 +36,7 @@ void FileEventImpl::activate(uint32_t events) {
 }
 
 void FileEventImpl::assignEvents(uint32_t events) {
+  enabled_events_ = events;
   event_assign(&raw_event_, base_, fd_,
                EV_PERSIST | (trigger_ == FileTriggerType::Level ? 0 : EV_ET) |
                    (events & FileReadyType::Read ? EV_READ : 0) |
@@ -63,6 +64,15 @@ void FileEventImpl::assignEvents(uint32_t events) {
 }
 
 void FileEventImpl::setEnabled(uint32_t events) {
+  // Connection code re-asserts its interest on every read/write toggle and most of the time the
+  // mask has not actually changed. Skipping the re-registration avoids a kernel visible
+  // epoll_ctl (or changelist entry) per call. This is safe in edge triggered mode because
+  // callers are required to read/write until EAGAIN; anyone needing a synthetic wakeup uses
+  // activate().
+  if (events == enabled_events_) {
+    return;
+  }
+
   event_del(&raw_event_);
   assignEvents(events);
   event_add(&raw_event_, nullptr);
@@ -30,6 +30,9 @@ private:
   event_base* base_;
   int fd_;
   FileTriggerType trigger_;
+  // The currently registered event mask, tracked so setEnabled() can skip re-registering (and
+  // the resulting epoll_ctl) when a caller re-asserts an unchanged mask.
+  uint32_t enabled_events_{};
 };
 
 } // namespace Event
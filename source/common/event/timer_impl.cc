@@ -10,18 +10,39 @@
 namespace Envoy {
 namespace Event {
 
-TimerImpl::TimerImpl(DispatcherImpl& dispatcher, TimerCb cb) : cb_(cb) {
+TimerImpl::TimerImpl(DispatcherImpl& dispatcher, TimerCb cb)
+    : cb_(cb), wheel_(dispatcher.timerWheel()) {
   ASSERT(cb_);
   evtimer_assign(
       &raw_event_, &dispatcher.base(),
       [](evutil_socket_t, short, void* arg) -> void { static_cast<TimerImpl*>(arg)->cb_(); }, this);
 }
 
-void TimerImpl::disableTimer() { event_del(&raw_event_); }
+TimerImpl::~TimerImpl() {
+  if (in_wheel_) {
+    wheel_.remove(*this);
+  }
+}
+
+void TimerImpl::disableTimer() {
+  if (in_wheel_) {
+    wheel_.remove(*this);
+  }
+  event_del(&raw_event_);
+}
 
 void TimerImpl::enableTimer(const std::chrono::milliseconds& d) {
+  if (in_wheel_) {
+    // Re-arming; pull the old entry out of the wheel first.
+    wheel_.remove(*this);
+  }
+
   if (d.count() == 0) {
     event_active(&raw_event_, EV_TIMEOUT, 0);
+  } else if (TimerWheel::suitableFor(d)) {
+    // Cancel any pending precise timeout or activation before handing over to the wheel.
+    event_del(&raw_event_);
+    wheel_.add(*this, d);
   } else {
     std::chrono::microseconds us = std::chrono::duration_cast<std::chrono::microseconds>(d);
     timeval tv;
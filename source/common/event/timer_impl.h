@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <list>
 
 #include "envoy/event/timer.h"
 
@@ -11,18 +13,29 @@ namespace Envoy {
 namespace Event {
 
 /**
- * libevent implementation of Event::Timer.
+ * libevent implementation of Event::Timer. Coarse granularity timers are backed by the
+ * dispatcher's timer wheel; short timers use libevent's precise timeout queue.
  */
 class TimerImpl : public Timer, ImplBase {
 public:
   TimerImpl(DispatcherImpl& dispatcher, TimerCb cb);
+  ~TimerImpl();
 
   // Event::Timer
   void disableTimer() override;
   void enableTimer(const std::chrono::milliseconds& d) override;
 
 private:
+  friend class TimerWheel;
+
   TimerCb cb_;
+  TimerWheel& wheel_;
+  // Wheel bookkeeping. wheel_deadline_tick_ is the absolute tick at which the timer is due; a
+  // hashed wheel slot holds timers for multiple revolutions so the wheel compares against this on
+  // each visit. wheel_entry_ allows O(1) cancellation.
+  uint64_t wheel_deadline_tick_{};
+  std::list<TimerImpl*>::iterator wheel_entry_;
+  bool in_wheel_{};
 };
 
 } // namespace Event
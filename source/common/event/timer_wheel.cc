@@ -0,0 +1,111 @@
+#include "common/event/timer_wheel.h"
+
+#include <chrono>
+
+#include "common/common/assert.h"
+#include "common/event/timer_impl.h"
+
+#include "event2/event.h"
+
+namespace Envoy {
+namespace Event {
+
+TimerWheel::TimerWheel(event_base& base, std::function<void()> tick_callback)
+    : start_time_(std::chrono::steady_clock::now()), tick_callback_(std::move(tick_callback)),
+      slots_(NUM_SLOTS) {
+  evtimer_assign(
+      &tick_event_, &base,
+      [](evutil_socket_t, short, void* arg) -> void { static_cast<TimerWheel*>(arg)->onTick(); },
+      this);
+}
+
+TimerWheel::~TimerWheel() { event_del(&tick_event_); }
+
+void TimerWheel::add(TimerImpl& timer, const std::chrono::milliseconds& d) {
+  ASSERT(!timer.in_wheel_);
+  if (count_ == 0) {
+    // Ticking is stopped while the wheel is empty, so fast forward before inserting. This is safe
+    // precisely because there are no entries that the skipped ticks could have fired.
+    current_tick_ = nowTick();
+    if (tick_callback_) {
+      tick_callback_();
+    }
+  }
+
+  // Round up so the timer never fires early. The deadline is computed from the wall clock tick
+  // rather than current_tick_, which may lag slightly while a tick event is in flight. The extra
+  // tick accounts for nowTick() truncating away the partially elapsed portion of the current
+  // tick: firing at tick T only guarantees that T * GRANULARITY_MS has elapsed since the wheel
+  // epoch, so a deadline of nowTick() + ticks could come up to one full tick short of the
+  // requested duration.
+  const uint64_t ticks = (d.count() + GRANULARITY_MS - 1) / GRANULARITY_MS;
+  timer.wheel_deadline_tick_ = nowTick() + ticks + 1;
+  std::list<TimerImpl*>& slot = slots_[timer.wheel_deadline_tick_ % NUM_SLOTS];
+  slot.push_front(&timer);
+  timer.wheel_entry_ = slot.begin();
+  timer.in_wheel_ = true;
+  count_++;
+  scheduleTick();
+}
+
+void TimerWheel::remove(TimerImpl& timer) {
+  ASSERT(timer.in_wheel_);
+  ASSERT(count_ > 0);
+  slots_[timer.wheel_deadline_tick_ % NUM_SLOTS].erase(timer.wheel_entry_);
+  timer.in_wheel_ = false;
+  count_--;
+}
+
+uint64_t TimerWheel::nowTick() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                               start_time_)
+             .count() /
+         GRANULARITY_MS;
+}
+
+void TimerWheel::scheduleTick() {
+  if (tick_scheduled_ || count_ == 0) {
+    return;
+  }
+
+  timeval tv;
+  tv.tv_sec = GRANULARITY_MS / 1000;
+  tv.tv_usec = (GRANULARITY_MS % 1000) * 1000;
+  event_add(&tick_event_, &tv);
+  tick_scheduled_ = true;
+}
+
+void TimerWheel::onTick() {
+  tick_scheduled_ = false;
+  if (tick_callback_) {
+    // Refresh before firing due timers so their callbacks observe up to date approximate time.
+    tick_callback_();
+  }
+
+  // Catch up to the tick implied by the monotonic clock rather than advancing by one, so that a
+  // delayed event loop does not skew every pending timer by the delay.
+  const uint64_t target_tick = nowTick();
+  while (current_tick_ < target_tick) {
+    current_tick_++;
+    std::list<TimerImpl*>& slot = slots_[current_tick_ % NUM_SLOTS];
+    for (auto i = slot.begin(); i != slot.end();) {
+      TimerImpl* timer = *i;
+      if (timer->wheel_deadline_tick_ <= current_tick_) {
+        i = slot.erase(i);
+        timer->in_wheel_ = false;
+        count_--;
+        // Activate the timer's event instead of invoking the callback directly so that it runs
+        // with normal event loop semantics.
+        event_active(&timer->raw_event_, EV_TIMEOUT, 0);
+      } else {
+        // Due in a later revolution of the wheel.
+        i++;
+      }
+    }
+  }
+
+  scheduleTick();
+}
+
+} // namespace Event
+} // namespace Envoy
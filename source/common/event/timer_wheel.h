@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+#include "common/event/libevent.h"
+
+#include "event2/event_struct.h"
+
+namespace Envoy {
+namespace Event {
+
+class TimerImpl;
+
+/**
+ * A hashed timer wheel for coarse granularity timers. Nearly all request and connection timeouts
+ * are cancelled before they fire, so arming and cancelling must be O(1); libevent's binary heap
+ * timeout queue is O(log n) and cache unfriendly with very large numbers of pending timers.
+ * Timers are hashed into fixed width slots and a single libevent tick event advances the wheel.
+ * Due timers are fired by activating their events so callbacks run with normal event loop
+ * semantics and can safely arm or cancel other timers. Deadlines are rounded up to the next tick
+ * so timers never fire early.
+ */
+class TimerWheel {
+public:
+  /**
+   * @param tick_callback invoked whenever the wheel reads the monotonic clock (each tick and
+   * when the wheel restarts from idle). The dispatcher uses this to refresh its approximate
+   * time, piggybacking on clock reads the wheel makes anyway.
+   */
+  TimerWheel(event_base& base, std::function<void()> tick_callback);
+  ~TimerWheel();
+
+  /**
+   * @return whether the wheel should back a timer of the given duration. Short timers stay on
+   * libevent's precise timeout queue since the wheel's granularity would skew them too much.
+   */
+  static bool suitableFor(const std::chrono::milliseconds& d) {
+    return static_cast<uint64_t>(d.count()) >= MIN_DURATION_MS;
+  }
+
+  /**
+   * Schedules a timer. The timer must not already be in the wheel.
+   */
+  void add(TimerImpl& timer, const std::chrono::milliseconds& d);
+
+  /**
+   * Cancels a timer previously added to the wheel.
+   */
+  void remove(TimerImpl& timer);
+
+private:
+  // 100ms slots over 512 slots cover ~51s per revolution. Longer timers stay in their slot for
+  // multiple revolutions since each entry carries its absolute deadline tick.
+  static const uint64_t GRANULARITY_MS = 100;
+  static const uint64_t NUM_SLOTS = 512;
+  static const uint64_t MIN_DURATION_MS = 500;
+
+  uint64_t nowTick() const;
+  void onTick();
+  void scheduleTick();
+
+  std::chrono::steady_clock::time_point start_time_;
+  std::function<void()> tick_callback_;
+  event tick_event_;
+  std::vector<std::list<TimerImpl*>> slots_;
+  uint64_t current_tick_{};
+  uint64_t count_{};
+  bool tick_scheduled_{};
+};
+
+} // namespace Event
+} // namespace Envoy
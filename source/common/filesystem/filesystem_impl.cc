@@ -2,15 +2,18 @@
 
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <chrono>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "envoy/common/exception.h"
 #include "envoy/event/dispatcher.h"
@@ -64,6 +67,10 @@ ssize_t OsSysCallsImpl::write(int fd, const void* buffer, size_t num_bytes) {
   return ::write(fd, buffer, num_bytes);
 }
 
+ssize_t OsSysCallsImpl::writev(int fd, const iovec* iov, int num_iov) {
+  return ::writev(fd, iov, num_iov);
+}
+
 FileImpl::FileImpl(const std::string& path, Event::Dispatcher& dispatcher,
                    Thread::BasicLockable& lock, OsSysCalls& os_sys_calls, Stats::Store& stats_store,
                    std::chrono::milliseconds flush_interval_msec)
@@ -72,7 +79,8 @@ FileImpl::FileImpl(const std::string& path, Event::Dispatcher& dispatcher,
         flush_event_.notify_one();
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
-      os_sys_calls_(os_sys_calls), flush_interval_msec_(flush_interval_msec),
+      dispatcher_(dispatcher), os_sys_calls_(os_sys_calls),
+      flush_interval_msec_(flush_interval_msec),
       stats_{FILESYSTEM_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {
   open();
@@ -101,13 +109,21 @@ FileImpl::~FileImpl() {
   }
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
+  std::vector<WriteCompletionCb> completions;
+  drainWriteBuffers(about_to_write_buffer_, completions);
   if (fd_ != -1) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    if (about_to_write_buffer_.length() > 0) {
+      doWrite(about_to_write_buffer_);
     }
 
     os_sys_calls_.close(fd_);
   }
+
+  // The dispatcher may already be shut down, so any outstanding completions are invoked inline
+  // rather than posted.
+  for (const WriteCompletionCb& cb : completions) {
+    cb(fd_ != -1);
+  }
 }
 
 void FileImpl::doWrite(Buffer::Instance& buffer) {
@@ -124,9 +140,22 @@ void FileImpl::doWrite(Buffer::Instance& buffer) {
   //            actually flush to disk. In the future it would be nice if we did away with the cross
   //            process lock or had multiple locks.
   std::unique_lock<Thread::BasicLockable> lock(flush_lock_);
-  for (Buffer::RawSlice& slice : slices) {
-    ssize_t rc = os_sys_calls_.write(fd_, slice.mem_, slice.len_);
-    ASSERT(rc == static_cast<ssize_t>(slice.len_));
+  // The file is opened with O_APPEND, so each writev() call atomically appends at the current end
+  // of the file even if another process rotated it out from under us.
+  uint64_t next_slice = 0;
+  while (next_slice < num_slices) {
+    iovec iov[MAX_SLICES_PER_WRITEV];
+    uint64_t num_iov = 0;
+    uint64_t num_bytes_to_write = 0;
+    while (next_slice < num_slices && num_iov < MAX_SLICES_PER_WRITEV) {
+      iov[num_iov].iov_base = slices[next_slice].mem_;
+      iov[num_iov].iov_len = slices[next_slice].len_;
+      num_bytes_to_write += slices[next_slice].len_;
+      num_iov++;
+      next_slice++;
+    }
+    const ssize_t rc = os_sys_calls_.writev(fd_, iov, static_cast<int>(num_iov));
+    ASSERT(rc == static_cast<ssize_t>(num_bytes_to_write));
     UNREFERENCED_PARAMETER(rc);
     stats_.write_completed_.inc();
   }
@@ -136,26 +165,63 @@ void FileImpl::doWrite(Buffer::Instance& buffer) {
   buffer.drain(buffer.length());
 }
 
-void FileImpl::flushThreadFunc() {
-  std::unique_lock<std::mutex> lock(write_lock_);
+void FileImpl::drainWriteBuffers(Buffer::Instance& destination,
+                                 std::vector<WriteCompletionCb>& completions) {
+  for (WriteBuffer& write_buffer : write_buffers_) {
+    std::unique_lock<std::mutex> lock(write_buffer.lock_);
+    const uint64_t length = write_buffer.buffer_.length();
+    if (length > 0) {
+      destination.move(write_buffer.buffer_);
+      buffered_bytes_ -= length;
+    }
+    if (!write_buffer.completions_.empty()) {
+      completions.insert(completions.end(),
+                         std::make_move_iterator(write_buffer.completions_.begin()),
+                         std::make_move_iterator(write_buffer.completions_.end()));
+      write_buffer.completions_.clear();
+    }
+  }
+}
 
-  while (true) {
-    // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-    // In case it was timer, flush_buffer_ can be empty.
-    while (flush_buffer_.length() == 0 && !flush_thread_exit_) {
-      flush_event_.wait(lock);
+void FileImpl::completeWrites(std::vector<WriteCompletionCb>&& completions, bool success) {
+  if (completions.empty()) {
+    return;
+  }
+
+  // C++11 lambdas cannot move capture, so the callbacks ride to the dispatcher in a shared_ptr.
+  std::shared_ptr<std::vector<WriteCompletionCb>> cbs(
+      new std::vector<WriteCompletionCb>(std::move(completions)));
+  dispatcher_.post([cbs, success]() -> void {
+    for (const WriteCompletionCb& cb : *cbs) {
+      cb(success);
     }
+  });
+}
 
-    if (flush_thread_exit_) {
-      return;
+void FileImpl::flushThreadFunc() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(write_lock_);
+
+      // flush_event_ can be woken up either by large enough buffered data or by timer.
+      // In case it was timer, the write buffers can be empty.
+      while (buffered_bytes_ == 0 && !flush_thread_exit_) {
+        flush_event_.wait(lock);
+      }
+
+      if (flush_thread_exit_) {
+        return;
+      }
     }
 
-    ASSERT(flush_buffer_.length() > 0);
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
-    lock.unlock();
+    // Take each stripe's contents with an O(1) move. Writers are only ever blocked for the
+    // duration of the swap, never for the write to disk.
+    std::vector<WriteCompletionCb> completions;
+    drainWriteBuffers(about_to_write_buffer_, completions);
+    ASSERT(about_to_write_buffer_.length() > 0);
 
     // if we failed to open file before (-1 == fd_), then simply ignore
+    bool write_completed = false;
     if (fd_ != -1) {
       try {
         if (reopen_file_) {
@@ -165,26 +231,51 @@ void FileImpl::flushThreadFunc() {
         }
 
         doWrite(about_to_write_buffer_);
+        write_completed = true;
       } catch (const EnvoyException&) {
         stats_.reopen_failed_.inc();
       }
     }
 
-    lock.lock();
+    completeWrites(std::move(completions), write_completed);
   }
 }
 
-void FileImpl::write(const std::string& data) {
-  std::unique_lock<std::mutex> lock(write_lock_);
+FileImpl::WriteBuffer& FileImpl::writeBufferForThisThread() {
+  // A given thread always maps to the same stripe so that its lines are flushed in the order
+  // they were written.
+  static thread_local const uint32_t stripe = Thread::Thread::currentThreadId();
+  return write_buffers_[stripe % NUM_WRITE_BUFFERS];
+}
 
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
-  }
+void FileImpl::write(const std::string& data) { write(data, nullptr); }
 
+void FileImpl::write(const std::string& data, WriteCompletionCb cb) {
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data);
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
+
+  uint64_t buffered;
+  {
+    WriteBuffer& write_buffer = writeBufferForThisThread();
+    std::unique_lock<std::mutex> lock(write_buffer.lock_);
+    write_buffer.buffer_.add(data);
+    if (cb != nullptr) {
+      write_buffer.completions_.emplace_back(std::move(cb));
+    }
+    buffered = (buffered_bytes_ += data.length());
+  }
+
+  // The data above must be buffered before the flush thread is created, so that the thread sees
+  // it as soon as it starts up and flushes it without waiting for the first timer tick.
+  if (!flush_structures_created_) {
+    std::unique_lock<std::mutex> lock(write_lock_);
+    if (!flush_structures_created_) {
+      createFlushStructures();
+      flush_structures_created_ = true;
+    }
+  }
+
+  if (buffered > MIN_FLUSH_SIZE) {
     flush_event_.notify_one();
   }
 }
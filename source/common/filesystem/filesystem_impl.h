@@ -1,11 +1,13 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/filesystem/filesystem.h"
@@ -51,6 +53,7 @@ public:
   // Filesystem::OsSysCalls
   int open(const std::string& full_path, int flags, int mode) override;
   ssize_t write(int fd, const void* buffer, size_t num_bytes) override;
+  ssize_t writev(int fd, const iovec* iov, int num_iov) override;
   int close(int fd) override;
 };
 
@@ -70,6 +73,7 @@ public:
 
   // Filesystem::File
   void write(const std::string& data) override;
+  void write(const std::string& data, WriteCompletionCb cb) override;
 
   /**
    * Filesystem::File
@@ -80,35 +84,63 @@ public:
   void reopen() override;
 
 private:
+  // A single striped write buffer. Log writers are spread across the stripes by thread id so
+  // that they do not all contend on one lock, and the flush thread takes each stripe's contents
+  // with an O(1) buffer move instead of copying under the lock. Completion callbacks for async
+  // writes ride along with the stripe and are posted back to the dispatcher once the stripe's
+  // data has been handed to the operating system.
+  struct WriteBuffer {
+    std::mutex lock_;
+    Buffer::OwnedImpl buffer_;
+    std::vector<WriteCompletionCb> completions_;
+  };
+
   void doWrite(Buffer::Instance& buffer);
+  void drainWriteBuffers(Buffer::Instance& destination,
+                         std::vector<WriteCompletionCb>& completions);
+  void completeWrites(std::vector<WriteCompletionCb>&& completions, bool success);
   void flushThreadFunc();
   void open();
   void createFlushStructures();
+  WriteBuffer& writeBufferForThisThread();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
 
+  // Number of striped write buffers. Enough to spread the default worker count so that workers
+  // rarely share a lock, while keeping the number of locks a flush cycle takes small.
+  static const size_t NUM_WRITE_BUFFERS = 8;
+
+  // Maximum number of slices passed to a single writev() call. IOV_MAX is at least 1024 on the
+  // platforms we run on.
+  static const uint64_t MAX_SLICES_PER_WRITEV = 1024;
+
   int fd_;
   std::string path_;
   Thread::BasicLockable& flush_lock_; // This lock is used only by the flush thread when writing
                                       // to disk. This is used to make sure that file blocks do
                                       // not get interleaved.
-  std::mutex write_lock_; // The lock is used when filling the flush buffer. It allows multiple
-                          // threads to write to the same file at relatively high performance.
-                          // It is always local to the process.
+  std::mutex write_lock_; // This lock only coordinates the flush thread's condition variable and
+                          // creation of the flush structures. Log writers take their stripe's
+                          // lock instead. It is always local to the process.
   Thread::ThreadPtr flush_thread_;
   std::condition_variable_any flush_event_;
   std::atomic<bool> flush_thread_exit_{};
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl flush_buffer_; // This buffer is used by multiple threads. It gets filled and
-                                   // then flushed either when max size is reached or when a timer
-                                   // fires.
+  std::atomic<bool> flush_structures_created_{};
+  std::atomic<uint64_t> buffered_bytes_{}; // Total bytes currently sitting in write_buffers_.
+  std::array<WriteBuffer, NUM_WRITE_BUFFERS> write_buffers_; // Striped buffers filled by log
+                                                             // writers. Each stripe has its own
+                                                             // lock and is handed off to the
+                                                             // flush thread wholesale.
   Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
-                                            // continue to fill. This buffer is then used for the
-                                            // final write to disk.
+                                            // is moved out of the striped buffers under their
+                                            // locks, which are then released so that the stripes
+                                            // can continue to fill. This buffer is then used for
+                                            // the final write to disk.
   Event::TimerPtr flush_timer_;
+  Event::Dispatcher& dispatcher_; // The dispatcher the file was created on. Async write
+                                  // completions are posted back to it from the flush thread.
   OsSysCalls& os_sys_calls_;
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
                                                         // matter if it reached the MIN_FLUSH_SIZE
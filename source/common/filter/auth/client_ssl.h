@@ -1,9 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <string>
-#include <unordered_set>
+#include <vector>
 
 #include "envoy/network/filter.h"
 #include "envoy/runtime/runtime.h"
@@ -43,22 +45,68 @@ struct GlobalStats {
 };
 
 /**
- * Wraps the principals currently allowed to authenticate.
+ * Wraps the principals currently allowed to authenticate. Digests are stored as raw SHA-256 bytes
+ * in a flat sorted array so that the per connection check is a binary search with no allocation,
+ * rather than a string compare of hex encodings.
  */
 class AllowedPrincipals : public ThreadLocal::ThreadLocalObject {
 public:
+  typedef std::array<uint8_t, 32> Sha256Digest;
+
   void add(const std::string& sha256_digest) {
-    if (!sha256_digest.empty()) {
-      allowed_sha256_digests_.emplace(sha256_digest);
+    Sha256Digest digest;
+    if (!decodeDigest(sha256_digest, digest)) {
+      // An entry that is not a valid hex encoded SHA-256 digest can never match a peer
+      // certificate digest, so there is no point in storing it.
+      return;
+    }
+    // The set is small and refreshed rarely, so sorted insertion is fine.
+    auto it = std::lower_bound(allowed_sha256_digests_.begin(), allowed_sha256_digests_.end(),
+                               digest);
+    if (it == allowed_sha256_digests_.end() || *it != digest) {
+      allowed_sha256_digests_.insert(it, digest);
     }
   }
   bool allowed(const std::string& sha256_digest) const {
-    return allowed_sha256_digests_.count(sha256_digest) != 0;
+    Sha256Digest digest;
+    if (!decodeDigest(sha256_digest, digest)) {
+      return false;
+    }
+    return std::binary_search(allowed_sha256_digests_.begin(), allowed_sha256_digests_.end(),
+                              digest);
   }
   size_t size() const { return allowed_sha256_digests_.size(); }
 
 private:
-  std::unordered_set<std::string> allowed_sha256_digests_;
+  static int decodeNibble(char c) {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+      return c - 'A' + 10;
+    }
+    return -1;
+  }
+
+  static bool decodeDigest(const std::string& hex, Sha256Digest& digest) {
+    if (hex.size() != 2 * digest.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < digest.size(); i++) {
+      const int hi = decodeNibble(hex[2 * i]);
+      const int lo = decodeNibble(hex[2 * i + 1]);
+      if (hi < 0 || lo < 0) {
+        return false;
+      }
+      digest[i] = (hi << 4) | lo;
+    }
+    return true;
+  }
+
+  std::vector<Sha256Digest> allowed_sha256_digests_;
 };
 
 typedef std::shared_ptr<AllowedPrincipals> AllowedPrincipalsSharedPtr;
@@ -47,6 +47,11 @@ TcpProxyConfig::TcpProxyConfig(const Json::Object& config,
     : stats_(generateStats(config.getString("stat_prefix"), scope)) {
   config.validateSchema(Json::Schema::TCP_PROXY_NETWORK_FILTER_SCHEMA);
 
+  splice_ = config.getBoolean("splice", false);
+  if (splice_ && !Network::Splicer::supported()) {
+    throw EnvoyException("tcp proxy: splice is not supported on this platform");
+  }
+
   for (const Json::ObjectSharedPtr& route_desc :
        config.getObject("route_config")->getObjectArray("routes")) {
     routes_.emplace_back(Route(*route_desc));
@@ -226,6 +231,13 @@ Network::FilterStatus TcpProxy::initializeUpstreamConnection() {
   upstream_connection_->connect();
   upstream_connection_->noDelay(true);
 
+  if (spliceEnabled()) {
+    // In splice mode data never enters the userspace filter path. Keep downstream data in the
+    // kernel socket buffer until the upstream connection is established and the splicer takes
+    // over in onUpstreamEvent().
+    read_callbacks_->connection().readDisable(true);
+  }
+
   connect_timeout_timer_ = read_callbacks_->connection().dispatcher().createTimer(
       [this]() -> void { onConnectTimeout(); });
   connect_timeout_timer_->enableTimer(cluster->connectTimeout());
@@ -261,6 +273,7 @@ void TcpProxy::onDownstreamEvent(Network::ConnectionEvent event) {
   if ((event == Network::ConnectionEvent::RemoteClose ||
        event == Network::ConnectionEvent::LocalClose) &&
       upstream_connection_) {
+    destroySplicer();
     // TODO(mattklein123): If we close without flushing here we may drop some data. The downstream
     // connection is about to go away. So to support this we need to either have a way for the
     // downstream connection to stick around, or, we need to be able to pass this connection to a
@@ -284,6 +297,7 @@ void TcpProxy::onUpstreamEvent(Network::ConnectionEvent event) {
   }
 
   if (event == Network::ConnectionEvent::RemoteClose) {
+    destroySplicer();
     if (connect_timeout_timer_) {
       read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_connect_fail_.inc();
       read_callbacks_->upstreamHost()->stats().cx_connect_fail_.inc();
@@ -292,6 +306,16 @@ void TcpProxy::onUpstreamEvent(Network::ConnectionEvent event) {
     onConnectionFailure();
   } else if (event == Network::ConnectionEvent::Connected) {
     connect_timespan_->complete();
+    if (spliceEnabled()) {
+      // Both connections are established and no data has entered userspace, so hand the rest of
+      // the session over to a kernel level splice. The splicer tells us when either side goes
+      // away.
+      upstream_connection_->readDisable(true);
+      splicer_.reset(new Network::Splicer(read_callbacks_->connection(), *upstream_connection_,
+                                          config_->stats().downstream_cx_rx_bytes_total_,
+                                          config_->stats().downstream_cx_tx_bytes_total_,
+                                          [this]() -> void { onSpliceClosed(); }));
+    }
     onConnectionSuccess();
   }
 
@@ -301,5 +325,27 @@ void TcpProxy::onUpstreamEvent(Network::ConnectionEvent event) {
   }
 }
 
+bool TcpProxy::spliceEnabled() {
+  // The WsHandlerImpl class uses TCP Proxy code with a null config. Splicing moves raw bytes
+  // between the sockets so it can never be used when either side does TLS.
+  return config_ != nullptr && config_->splice() &&
+         read_callbacks_->connection().ssl() == nullptr && upstream_connection_->ssl() == nullptr;
+}
+
+void TcpProxy::onSpliceClosed() {
+  ENVOY_CONN_LOG(debug, "splice finished", read_callbacks_->connection());
+  destroySplicer();
+  upstream_connection_->close(Network::ConnectionCloseType::NoFlush);
+  read_callbacks_->connection().close(Network::ConnectionCloseType::NoFlush);
+}
+
+void TcpProxy::destroySplicer() {
+  // The splicer may be calling us, so it must be destroyed via deferred delete. This must also
+  // happen before either connection closes its fd out from under the splicer's events.
+  if (splicer_) {
+    read_callbacks_->connection().dispatcher().deferredDelete(std::move(splicer_));
+  }
+}
+
 } // namespace Filter
 } // namespace Envoy
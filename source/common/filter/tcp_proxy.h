@@ -16,6 +16,7 @@
 #include "common/json/json_loader.h"
 #include "common/network/cidr_range.h"
 #include "common/network/filter_impl.h"
+#include "common/network/splicer.h"
 #include "common/network/utility.h"
 
 namespace Envoy {
@@ -63,6 +64,12 @@ public:
 
   const TcpProxyStats& stats() { return stats_; }
 
+  /**
+   * @return bool whether data should be moved between the downstream and upstream connections
+   *         in the kernel via splice(2) once both are established.
+   */
+  bool splice() const { return splice_; }
+
 private:
   struct Route {
     Route(const Json::Object& config);
@@ -78,6 +85,7 @@ private:
 
   std::vector<Route> routes_;
   const TcpProxyStats stats_;
+  bool splice_{};
 };
 
 typedef std::shared_ptr<TcpProxyConfig> TcpProxyConfigSharedPtr;
@@ -167,6 +175,9 @@ protected:
   void onDownstreamEvent(Network::ConnectionEvent event);
   void onUpstreamData(Buffer::Instance& data);
   void onUpstreamEvent(Network::ConnectionEvent event);
+  bool spliceEnabled();
+  void onSpliceClosed();
+  void destroySplicer();
 
   TcpProxyConfigSharedPtr config_;
   Upstream::ClusterManager& cluster_manager_;
@@ -178,6 +189,7 @@ protected:
   Stats::TimespanPtr connected_timespan_;
   std::shared_ptr<UpstreamCallbacks> upstream_callbacks_; // shared_ptr required for passing as a
                                                           // read filter.
+  Network::SplicerPtr splicer_;
 };
 
 } // Filter
@@ -127,9 +127,11 @@ Buffer::InstancePtr Common::serializeBody(const Protobuf::Message& message) {
   const uint32_t nsize = htonl(size);
   std::memcpy(current, reinterpret_cast<const void*>(&nsize), sizeof(uint32_t));
   current += sizeof(uint32_t);
-  Protobuf::io::ArrayOutputStream stream(current, size, -1);
-  Protobuf::io::CodedOutputStream codec_stream(&stream);
-  message.SerializeWithCachedSizes(&codec_stream);
+  // ByteSize() has just been called above, so the cached sizes are fresh and we can serialize
+  // straight into the reserved slice without the coded stream wrapper.
+  uint8_t* end = message.SerializeWithCachedSizesToArray(current);
+  ASSERT(end == current + size);
+  UNREFERENCED_PARAMETER(end);
   body->commit(&iovec, 1);
   return body;
 }
@@ -96,7 +96,9 @@ public:
                                       std::string* method);
 
   /**
-   * Serialize protobuf message.
+   * Serialize protobuf message into a gRPC data frame: the 5 byte frame header is written in
+   * place and the message body is serialized directly into reserved buffer memory, so the only
+   * copy is the serialization itself.
    */
   static Buffer::InstancePtr serializeBody(const Protobuf::Message& message);
 
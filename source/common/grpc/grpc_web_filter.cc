@@ -155,7 +155,9 @@ Http::FilterDataStatus GrpcWebFilter::encodeData(Buffer::Instance& data, bool) {
     const uint32_t length = htonl(frame.length_);
     temp.add(&length, 4);
     if (frame.length_ > 0) {
-      temp.add(*frame.data_);
+      // Move the payload instead of copying it; the filter never holds more than the frame
+      // being transcoded.
+      temp.move(*frame.data_);
     }
     data.add(Base64::encode(temp, temp.length()));
   }
@@ -52,7 +52,11 @@ Http::FilterDataStatus Http1BridgeFilter::encodeData(Buffer::Instance&, bool end
   if (!do_bridging_ || end_stream) {
     return Http::FilterDataStatus::Continue;
   } else {
-    // Buffer until the complete request has been processed.
+    // Buffer until the complete response has been processed. The buffering is inherent to what
+    // the bridge provides: HTTP/1.1 callers read grpc-status and content-length from the
+    // response headers, and hoisting those from the trailers requires holding the entire body.
+    // Callers that need streaming responses should speak HTTP/2 end to end (or use grpc-web,
+    // which transcodes frame by frame).
     return Http::FilterDataStatus::StopIterationAndBuffer;
   }
 }
@@ -1,5 +1,8 @@
 #include "common/grpc/json_transcoder_filter.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "envoy/common/exception.h"
 #include "envoy/http/filter.h"
 
@@ -29,7 +32,6 @@ using google::grpc::transcoding::PathMatcherBuilder;
 using google::grpc::transcoding::PathMatcherUtility;
 using google::grpc::transcoding::RequestInfo;
 using google::grpc::transcoding::ResponseToJsonTranslator;
-using google::grpc::transcoding::Transcoder;
 using google::grpc::transcoding::TranscoderInputStream;
 
 namespace Envoy {
@@ -55,13 +57,11 @@ public:
         response_stream_(response_translator_->CreateInputStream()) {}
 
   // Transcoder
-  ::google::grpc::transcoding::TranscoderInputStream* RequestOutput() {
-    return request_stream_.get();
-  }
-  ProtobufUtil::Status RequestStatus() { return request_translator_->Output().Status(); }
+  TranscoderInputStream* RequestOutput() override { return request_stream_.get(); }
+  ProtobufUtil::Status RequestStatus() override { return request_translator_->Output().Status(); }
 
-  ZeroCopyInputStream* ResponseOutput() { return response_stream_.get(); }
-  ProtobufUtil::Status ResponseStatus() { return response_translator_->Status(); }
+  TranscoderInputStream* ResponseOutput() override { return response_stream_.get(); }
+  ProtobufUtil::Status ResponseStatus() override { return response_translator_->Status(); }
 
 private:
   std::unique_ptr<JsonRequestTranslator> request_translator_;
@@ -121,8 +121,8 @@ JsonTranscoderConfig::JsonTranscoderConfig(const Json::Object& config) {
 
 ProtobufUtil::Status JsonTranscoderConfig::createTranscoder(
     const Http::HeaderMap& headers, ZeroCopyInputStream& request_input,
-    google::grpc::transcoding::TranscoderInputStream& response_input,
-    std::unique_ptr<Transcoder>& transcoder, const Protobuf::MethodDescriptor*& method_descriptor) {
+    google::grpc::transcoding::TranscoderInputStream& response_input, TranscoderPtr& transcoder,
+    const Protobuf::MethodDescriptor*& method_descriptor) {
   const ProtobufTypes::String method = headers.Method()->value().c_str();
   ProtobufTypes::String path = headers.Path()->value().c_str();
   ProtobufTypes::String args;
@@ -363,16 +363,58 @@ void JsonTranscoderFilter::setEncoderFilterCallbacks(
 }
 
 // TODO(lizan): Incorporate watermarks to bound buffer sizes
-bool JsonTranscoderFilter::readToBuffer(Protobuf::io::ZeroCopyInputStream& stream,
-                                        Buffer::Instance& data) {
+bool JsonTranscoderFilter::readToBuffer(TranscoderInputStream& stream, Buffer::Instance& data) {
   const void* out;
   int size;
-  while (stream.Next(&out, &size)) {
-    data.add(out, size);
 
+  // The translator reports how much translated output it has ready. Reserve that much space up
+  // front and copy the chunks straight into the reserved slices, so a large message lands in a
+  // single right-sized slice instead of being appended chunk by chunk.
+  uint64_t available = stream.BytesAvailable();
+  while (available > 0) {
+    Buffer::RawSlice iovecs[2];
+    const uint64_t num_iovecs = data.reserve(available, iovecs, 2);
+    const char* chunk = nullptr;
+    uint64_t chunk_left = 0;
+    bool more = true;
+    for (uint64_t i = 0; i < num_iovecs; i++) {
+      char* dest = static_cast<char*>(iovecs[i].mem_);
+      uint64_t space = iovecs[i].len_;
+      while (space > 0 && more) {
+        if (chunk_left == 0) {
+          more = stream.Next(&out, &size) && size > 0;
+          if (!more) {
+            break;
+          }
+          chunk = static_cast<const char*>(out);
+          chunk_left = size;
+        }
+        const uint64_t copy_length = std::min(chunk_left, space);
+        memcpy(dest, chunk, copy_length);
+        dest += copy_length;
+        chunk += copy_length;
+        chunk_left -= copy_length;
+        space -= copy_length;
+      }
+      iovecs[i].len_ -= space;
+    }
+    data.commit(iovecs, num_iovecs);
+    if (chunk_left > 0) {
+      // The last chunk ran past the advertised byte count; keep the remainder.
+      data.add(chunk, chunk_left);
+    }
+    if (!more) {
+      break;
+    }
+    available = stream.BytesAvailable();
+  }
+
+  // Drain anything the estimate missed and distinguish end of stream from no data ready.
+  while (stream.Next(&out, &size)) {
     if (size == 0) {
       return true;
     }
+    data.add(out, size);
   }
   return false;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/common/pure.h"
 #include "envoy/http/filter.h"
 #include "envoy/http/header_map.h"
 #include "envoy/json/json_object.h"
@@ -11,7 +12,6 @@
 
 #include "grpc_transcoding/path_matcher.h"
 #include "grpc_transcoding/request_message_translator.h"
-#include "grpc_transcoding/transcoder.h"
 #include "grpc_transcoding/type_helper.h"
 
 namespace Envoy {
@@ -34,6 +34,23 @@ struct VariableBinding {
   ProtobufTypes::String value;
 };
 
+/**
+ * Interface of the transcoder instance created per request. It mirrors
+ * google::grpc::transcoding::Transcoder, but exposes TranscoderInputStream for both directions
+ * so that the filter can size output buffer reservations from BytesAvailable().
+ */
+class Transcoder {
+public:
+  virtual ~Transcoder() {}
+
+  virtual google::grpc::transcoding::TranscoderInputStream* RequestOutput() PURE;
+  virtual ProtobufUtil::Status RequestStatus() PURE;
+  virtual google::grpc::transcoding::TranscoderInputStream* ResponseOutput() PURE;
+  virtual ProtobufUtil::Status ResponseStatus() PURE;
+};
+
+typedef std::unique_ptr<Transcoder> TranscoderPtr;
+
 /**
  * Global configuration for the gRPC JSON transcoder filter. Factory for the Transcoder interface.
  */
@@ -57,8 +74,7 @@ public:
   ProtobufUtil::Status
   createTranscoder(const Http::HeaderMap& headers, Protobuf::io::ZeroCopyInputStream& request_input,
                    google::grpc::transcoding::TranscoderInputStream& response_input,
-                   std::unique_ptr<google::grpc::transcoding::Transcoder>& transcoder,
-                   const Protobuf::MethodDescriptor*& method_descriptor);
+                   TranscoderPtr& transcoder, const Protobuf::MethodDescriptor*& method_descriptor);
 
 private:
   /**
@@ -99,10 +115,11 @@ public:
   void onDestroy() override { stream_reset_ = true; }
 
 private:
-  bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
+  bool readToBuffer(google::grpc::transcoding::TranscoderInputStream& stream,
+                    Buffer::Instance& data);
 
   JsonTranscoderConfig& config_;
-  std::unique_ptr<google::grpc::transcoding::Transcoder> transcoder_;
+  TranscoderPtr transcoder_;
   TranscoderInputStreamImpl request_in_;
   TranscoderInputStreamImpl response_in_;
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{nullptr};
@@ -36,8 +36,6 @@ public:
 
   ~RpcChannelImpl() { ASSERT(!http_request_ && !grpc_method_ && !grpc_response_); }
 
-  static Buffer::InstancePtr serializeBody(const Protobuf::Message& message);
-
   // Grpc::RpcChannel
   void cancel() override;
 
@@ -1,6 +1,7 @@
 #include "common/http/access_log/access_log_formatter.h"
 
 #include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -121,17 +122,44 @@ FormatterImpl::FormatterImpl(const std::string& format) {
   formatters_ = AccessLogFormatParser::parse(format);
 }
 
-std::string FormatterImpl::format(const Http::HeaderMap& request_headers,
-                                  const Http::HeaderMap& response_headers,
-                                  const RequestInfo& request_info) const {
-  std::string log_line;
-  log_line.reserve(256);
+void FormatterImpl::format(const Http::HeaderMap& request_headers,
+                           const Http::HeaderMap& response_headers,
+                           const RequestInfo& request_info, std::string& output) const {
+  for (const FormatterPtr& formatter : formatters_) {
+    formatter->format(request_headers, response_headers, request_info, output);
+  }
+}
+
+BinaryFormatterImpl::BinaryFormatterImpl(const std::string& schema) {
+  formatters_ = AccessLogFormatParser::parse(schema);
+}
 
+void BinaryFormatterImpl::format(const Http::HeaderMap& request_headers,
+                                 const Http::HeaderMap& response_headers,
+                                 const RequestInfo& request_info, std::string& output) const {
+  // Fields are serialized directly into the output buffer behind a length placeholder which is
+  // patched once the field size is known, so no per field intermediate string is needed.
+  const size_t record_index = output.size();
+  appendLengthPlaceholder(output);
   for (const FormatterPtr& formatter : formatters_) {
-    log_line += formatter->format(request_headers, response_headers, request_info);
+    const size_t field_index = output.size();
+    appendLengthPlaceholder(output);
+    formatter->format(request_headers, response_headers, request_info, output);
+    writeLength(output, field_index, output.size() - field_index - 4);
   }
+  writeLength(output, record_index, output.size() - record_index - 4);
+}
+
+void BinaryFormatterImpl::appendLengthPlaceholder(std::string& output) {
+  output.append(4, '\0');
+}
 
-  return log_line;
+void BinaryFormatterImpl::writeLength(std::string& output, size_t index, uint64_t length) {
+  ASSERT(length <= std::numeric_limits<uint32_t>::max());
+  output[index] = static_cast<char>(length & 0xff);
+  output[index + 1] = static_cast<char>((length >> 8) & 0xff);
+  output[index + 2] = static_cast<char>((length >> 16) & 0xff);
+  output[index + 3] = static_cast<char>((length >> 24) & 0xff);
 }
 
 void AccessLogFormatParser::parseCommand(const std::string& token, const size_t start,
@@ -226,82 +254,113 @@ std::vector<FormatterPtr> AccessLogFormatParser::parse(const std::string& format
   return formatters;
 }
 
+// Append a numeric value without going through an intermediate heap allocated string.
+static void appendUint(std::string& output, uint64_t value) {
+  fmt::FormatInt formatted(value);
+  output.append(formatted.c_str(), formatted.size());
+}
+
+// Each phase field logs the duration from request start to the phase in milliseconds, matching
+// the units of the other duration fields. An unreached phase logs 0.
+static std::function<void(const RequestInfo&, std::string&)> phaseExtractor(RequestPhase phase) {
+  return [phase](const RequestInfo& request_info, std::string& output) {
+    appendUint(output, std::chrono::duration_cast<std::chrono::milliseconds>(
+                           request_info.phaseDuration(phase))
+                           .count());
+  };
+}
+
 RequestInfoFormatter::RequestInfoFormatter(const std::string& field_name) {
   if (field_name == "START_TIME") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return AccessLogDateTimeFormatter::fromTime(request_info.startTime());
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      output.append(AccessLogDateTimeFormatter::fromTime(request_info.startTime()));
     };
   } else if (field_name == "REQUEST_DURATION") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
-                                request_info.requestReceivedDuration())
-                                .count());
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      appendUint(output, std::chrono::duration_cast<std::chrono::milliseconds>(
+                             request_info.requestReceivedDuration())
+                             .count());
     };
   } else if (field_name == "RESPONSE_DURATION") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
-                                request_info.responseReceivedDuration())
-                                .count());
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      appendUint(output, std::chrono::duration_cast<std::chrono::milliseconds>(
+                             request_info.responseReceivedDuration())
+                             .count());
     };
+  } else if (field_name == "ROUTE_MATCH_DURATION") {
+    field_extractor_ = phaseExtractor(RequestPhase::RouteMatched);
+  } else if (field_name == "POOL_READY_DURATION") {
+    field_extractor_ = phaseExtractor(RequestPhase::PoolReady);
+  } else if (field_name == "FIRST_UPSTREAM_BYTE_DURATION") {
+    field_extractor_ = phaseExtractor(RequestPhase::FirstUpstreamByte);
+  } else if (field_name == "ENCODE_COMPLETE_DURATION") {
+    field_extractor_ = phaseExtractor(RequestPhase::EncodeComplete);
   } else if (field_name == "BYTES_RECEIVED") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return std::to_string(request_info.bytesReceived());
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      appendUint(output, request_info.bytesReceived());
     };
   } else if (field_name == "PROTOCOL") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return AccessLogFormatUtils::protocolToString(request_info.protocol());
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      output.append(AccessLogFormatUtils::protocolToString(request_info.protocol()));
     };
   } else if (field_name == "RESPONSE_CODE") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return request_info.responseCode().valid()
-                 ? std::to_string(request_info.responseCode().value())
-                 : "0";
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      if (request_info.responseCode().valid()) {
+        appendUint(output, request_info.responseCode().value());
+      } else {
+        output.push_back('0');
+      }
     };
   } else if (field_name == "BYTES_SENT") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return std::to_string(request_info.bytesSent());
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      appendUint(output, request_info.bytesSent());
     };
   } else if (field_name == "DURATION") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return std::to_string(
-          std::chrono::duration_cast<std::chrono::milliseconds>(request_info.duration()).count());
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      appendUint(output, std::chrono::duration_cast<std::chrono::milliseconds>(
+                             request_info.duration())
+                             .count());
     };
   } else if (field_name == "RESPONSE_FLAGS") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      return ResponseFlagUtils::toShortString(request_info);
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      output.append(ResponseFlagUtils::toShortString(request_info));
     };
   } else if (field_name == "UPSTREAM_HOST") {
-    field_extractor_ = [](const RequestInfo& request_info) {
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
       if (request_info.upstreamHost()) {
-        return request_info.upstreamHost()->address()->asString();
+        output.append(request_info.upstreamHost()->address()->asString());
       } else {
-        return std::string("-");
+        output.push_back('-');
       }
     };
   } else if (field_name == "UPSTREAM_CLUSTER") {
-    field_extractor_ = [](const RequestInfo& request_info) {
-      std::string upstream_cluster_name;
+    field_extractor_ = [](const RequestInfo& request_info, std::string& output) {
+      const std::string* upstream_cluster_name = nullptr;
       if (nullptr != request_info.upstreamHost()) {
-        upstream_cluster_name = request_info.upstreamHost()->cluster().name();
+        upstream_cluster_name = &request_info.upstreamHost()->cluster().name();
       }
 
-      return upstream_cluster_name.empty() ? "-" : upstream_cluster_name;
+      if (upstream_cluster_name == nullptr || upstream_cluster_name->empty()) {
+        output.push_back('-');
+      } else {
+        output.append(*upstream_cluster_name);
+      }
     };
   } else {
     throw EnvoyException(fmt::format("Not supported field in RequestInfo: {}", field_name));
   }
 }
 
-std::string RequestInfoFormatter::format(const HeaderMap&, const HeaderMap&,
-                                         const RequestInfo& request_info) const {
-  return field_extractor_(request_info);
+void RequestInfoFormatter::format(const HeaderMap&, const HeaderMap&,
+                                  const RequestInfo& request_info, std::string& output) const {
+  field_extractor_(request_info, output);
 }
 
 PlainStringFormatter::PlainStringFormatter(const std::string& str) : str_(str) {}
 
-std::string PlainStringFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                         const RequestInfo&) const {
-  return str_;
+void PlainStringFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
+                                  const RequestInfo&, std::string& output) const {
+  output.append(str_);
 }
 
 HeaderFormatter::HeaderFormatter(const std::string& main_header,
@@ -309,25 +368,24 @@ HeaderFormatter::HeaderFormatter(const std::string& main_header,
                                  const Optional<size_t>& max_length)
     : main_header_(main_header), alternative_header_(alternative_header), max_length_(max_length) {}
 
-std::string HeaderFormatter::format(const HeaderMap& headers) const {
+void HeaderFormatter::format(const HeaderMap& headers, std::string& output) const {
   const HeaderEntry* header = headers.get(main_header_);
 
   if (!header && !alternative_header_.get().empty()) {
     header = headers.get(alternative_header_);
   }
 
-  std::string header_value_string;
   if (!header) {
-    header_value_string = "-";
-  } else {
-    header_value_string = header->value().c_str();
+    output.push_back('-');
+    return;
   }
 
-  if (max_length_.valid() && header_value_string.length() > max_length_.value()) {
-    return header_value_string.substr(0, max_length_.value());
+  size_t length = header->value().size();
+  if (max_length_.valid() && length > max_length_.value()) {
+    length = max_length_.value();
   }
 
-  return header_value_string;
+  output.append(header->value().c_str(), length);
 }
 
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
@@ -335,10 +393,10 @@ ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
                                                  const Optional<size_t>& max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string ResponseHeaderFormatter::format(const Http::HeaderMap&,
-                                            const Http::HeaderMap& response_headers,
-                                            const RequestInfo&) const {
-  return HeaderFormatter::format(response_headers);
+void ResponseHeaderFormatter::format(const Http::HeaderMap&,
+                                     const Http::HeaderMap& response_headers, const RequestInfo&,
+                                     std::string& output) const {
+  HeaderFormatter::format(response_headers, output);
 }
 
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
@@ -346,9 +404,9 @@ RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                const Optional<size_t>& max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string RequestHeaderFormatter::format(const Http::HeaderMap& request_headers,
-                                           const Http::HeaderMap&, const RequestInfo&) const {
-  return HeaderFormatter::format(request_headers);
+void RequestHeaderFormatter::format(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
+                                    const RequestInfo&, std::string& output) const {
+  HeaderFormatter::format(request_headers, output);
 }
 
 } // namespace AccessLog
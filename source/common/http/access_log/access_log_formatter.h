@@ -70,13 +70,40 @@ public:
   FormatterImpl(const std::string& format);
 
   // Formatter::format
-  std::string format(const HeaderMap& request_headers, const HeaderMap& response_headers,
-                     const RequestInfo& request_info) const override;
+  using Formatter::format;
+  void format(const HeaderMap& request_headers, const HeaderMap& response_headers,
+              const RequestInfo& request_info, std::string& output) const override;
 
 private:
   std::vector<FormatterPtr> formatters_;
 };
 
+/**
+ * Length prefixed binary record formatter. The schema is a standard access log format string;
+ * every element of it, including any literal text between commands, contributes one field to the
+ * record in schema order. Each record is serialized as a 4 byte little endian payload length
+ * followed by the payload, which is one 4 byte little endian length plus raw bytes per field.
+ * Consumers recover the field meanings from the schema they configured, so records are parsed
+ * back into fields without scanning for separators.
+ */
+class BinaryFormatterImpl : public Formatter {
+public:
+  BinaryFormatterImpl(const std::string& schema);
+
+  // Formatter::format
+  using Formatter::format;
+  void format(const HeaderMap& request_headers, const HeaderMap& response_headers,
+              const RequestInfo& request_info, std::string& output) const override;
+
+private:
+  // Append a 4 byte placeholder for a length that is not yet known.
+  static void appendLengthPlaceholder(std::string& output);
+  // Overwrite the placeholder at index with length, little endian.
+  static void writeLength(std::string& output, size_t index, uint64_t length);
+
+  std::vector<FormatterPtr> formatters_;
+};
+
 /**
  * Formatter for string literal. It ignores headers and request info and returns string by which it
  * was initialized.
@@ -86,7 +113,9 @@ public:
   PlainStringFormatter(const std::string& str);
 
   // Formatter::format
-  std::string format(const HeaderMap&, const HeaderMap&, const RequestInfo&) const override;
+  using Formatter::format;
+  void format(const HeaderMap&, const HeaderMap&, const RequestInfo&,
+              std::string& output) const override;
 
 private:
   std::string str_;
@@ -97,7 +126,7 @@ public:
   HeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                   const Optional<size_t>& max_length);
 
-  std::string format(const HeaderMap& headers) const;
+  void format(const HeaderMap& headers, std::string& output) const;
 
 private:
   LowerCaseString main_header_;
@@ -114,8 +143,9 @@ public:
                          const Optional<size_t>& max_length);
 
   // Formatter::format
-  std::string format(const HeaderMap& request_headers, const HeaderMap&,
-                     const RequestInfo&) const override;
+  using Formatter::format;
+  void format(const HeaderMap& request_headers, const HeaderMap&, const RequestInfo&,
+              std::string& output) const override;
 };
 
 /**
@@ -127,8 +157,9 @@ public:
                           const Optional<size_t>& max_length);
 
   // Formatter::format
-  std::string format(const HeaderMap&, const HeaderMap& response_headers,
-                     const RequestInfo&) const override;
+  using Formatter::format;
+  void format(const HeaderMap&, const HeaderMap& response_headers, const RequestInfo&,
+              std::string& output) const override;
 };
 
 /**
@@ -139,11 +170,12 @@ public:
   RequestInfoFormatter(const std::string& field_name);
 
   // Formatter::format
-  std::string format(const HeaderMap&, const HeaderMap&,
-                     const RequestInfo& request_info) const override;
+  using Formatter::format;
+  void format(const HeaderMap&, const HeaderMap&, const RequestInfo& request_info,
+              std::string& output) const override;
 
 private:
-  std::function<std::string(const RequestInfo&)> field_extractor_;
+  std::function<void(const RequestInfo&, std::string&)> field_extractor_;
 };
 
 } // namespace AccessLog
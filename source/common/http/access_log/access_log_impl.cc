@@ -24,16 +24,17 @@ namespace AccessLog {
 
 ComparisonFilter::ComparisonFilter(const envoy::api::v2::filter::ComparisonFilter& config,
                                    Runtime::Loader& runtime)
-    : config_(config), runtime_(runtime) {}
+    : op_(config.op()), default_value_(config.value().default_value()),
+      runtime_key_(config.value().runtime_key()), runtime_(runtime) {}
 
 bool ComparisonFilter::compareAgainstValue(uint64_t lhs) {
-  uint64_t value = config_.value().default_value();
+  uint64_t value = default_value_;
 
-  if (!config_.value().runtime_key().empty()) {
-    value = runtime_.snapshot().getInteger(config_.value().runtime_key(), value);
+  if (!runtime_key_.empty()) {
+    value = runtime_.snapshot().getInteger(runtime_key_, value);
   }
 
-  switch (config_.op()) {
+  switch (op_) {
   case envoy::api::v2::filter::ComparisonFilter::GE:
     return lhs >= value;
   case envoy::api::v2::filter::ComparisonFilter::EQ:
@@ -102,18 +103,37 @@ bool RuntimeFilter::evaluate(const RequestInfo&, const HeaderMap& request_header
 }
 
 OperatorFilter::OperatorFilter(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::filter::AccessLogFilter>& configs,
+    Runtime::Loader& runtime, Type type)
+    : type_(type) {
+  addFilters(configs, runtime);
+}
+
+void OperatorFilter::addFilters(
     const Protobuf::RepeatedPtrField<envoy::api::v2::filter::AccessLogFilter>& configs,
     Runtime::Loader& runtime) {
   for (const auto& config : configs) {
-    filters_.emplace_back(FilterFactory::fromProto(config, runtime));
+    // A nested operator of the same type evaluates identically with its children inlined into
+    // this filter's list, so deep and/or trees flatten at config time to a single dispatch level
+    // per leaf filter.
+    if (type_ == Type::And &&
+        config.filter_specifier_case() == envoy::api::v2::filter::AccessLogFilter::kAndFilter) {
+      addFilters(config.and_filter().filters(), runtime);
+    } else if (type_ == Type::Or &&
+               config.filter_specifier_case() ==
+                   envoy::api::v2::filter::AccessLogFilter::kOrFilter) {
+      addFilters(config.or_filter().filters(), runtime);
+    } else {
+      filters_.emplace_back(FilterFactory::fromProto(config, runtime));
+    }
   }
 }
 
 OrFilter::OrFilter(const envoy::api::v2::filter::OrFilter& config, Runtime::Loader& runtime)
-    : OperatorFilter(config.filters(), runtime) {}
+    : OperatorFilter(config.filters(), runtime, Type::Or) {}
 
 AndFilter::AndFilter(const envoy::api::v2::filter::AndFilter& config, Runtime::Loader& runtime)
-    : OperatorFilter(config.filters(), runtime) {}
+    : OperatorFilter(config.filters(), runtime, Type::And) {}
 
 bool OrFilter::evaluate(const RequestInfo& info, const HeaderMap& request_headers) {
   bool result = false;
@@ -183,8 +203,12 @@ void FileAccessLog::log(const HeaderMap* request_headers, const HeaderMap* respo
     }
   }
 
-  std::string access_log_line =
-      formatter_->format(*request_headers, *response_headers, request_info);
+  // The output buffer is reused for every entry logged on this thread so that after the first few
+  // entries formatting serializes into already allocated memory. write() appends the buffer
+  // directly to the file's flush buffer, so this is the only userspace copy of the entry.
+  thread_local static std::string access_log_line;
+  access_log_line.clear();
+  formatter_->format(*request_headers, *response_headers, request_info, access_log_line);
   log_file_->write(access_log_line);
 }
 
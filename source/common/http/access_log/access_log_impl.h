@@ -39,7 +39,11 @@ protected:
 
   bool compareAgainstValue(uint64_t lhs);
 
-  envoy::api::v2::filter::ComparisonFilter config_;
+  // Extracted from the proto config at construction so evaluation does not walk proto getters
+  // on every request.
+  const envoy::api::v2::filter::ComparisonFilter::Op op_;
+  const uint64_t default_value_;
+  const std::string runtime_key_; // Empty if the comparison value is fixed.
   Runtime::Loader& runtime_;
 };
 
@@ -72,11 +76,20 @@ public:
  */
 class OperatorFilter : public Filter {
 public:
+  enum class Type { And, Or };
+
   OperatorFilter(const Protobuf::RepeatedPtrField<envoy::api::v2::filter::AccessLogFilter>& configs,
-                 Runtime::Loader& runtime);
+                 Runtime::Loader& runtime, Type type);
 
 protected:
   std::vector<FilterPtr> filters_;
+
+private:
+  void
+  addFilters(const Protobuf::RepeatedPtrField<envoy::api::v2::filter::AccessLogFilter>& configs,
+             Runtime::Loader& runtime);
+
+  const Type type_;
 };
 
 /**
@@ -38,6 +38,19 @@ AsyncClientImpl::~AsyncClientImpl() {
   }
 }
 
+Router::RouteConstSharedPtr
+AsyncClientImpl::routeForTimeout(const Optional<std::chrono::milliseconds>& timeout) {
+  const int64_t key = timeout.valid() ? timeout.value().count() : -1;
+  auto entry = route_cache_.find(key);
+  if (entry == route_cache_.end()) {
+    entry = route_cache_
+                .emplace(key,
+                         std::make_shared<AsyncStreamImpl::RouteImpl>(cluster_.name(), timeout))
+                .first;
+  }
+  return entry->second;
+}
+
 AsyncClient::Request* AsyncClientImpl::send(MessagePtr&& request, AsyncClient::Callbacks& callbacks,
                                             const Optional<std::chrono::milliseconds>& timeout) {
   AsyncRequestImpl* async_request =
@@ -66,7 +79,7 @@ AsyncStreamImpl::AsyncStreamImpl(AsyncClientImpl& parent, AsyncClient::StreamCal
                                  const Optional<std::chrono::milliseconds>& timeout)
     : parent_(parent), stream_callbacks_(callbacks), stream_id_(parent.config_.random_.random()),
       router_(parent.config_), request_info_(Protocol::Http11),
-      route_(std::make_shared<RouteImpl>(parent_.cluster_.name(), timeout)) {
+      route_(parent.routeForTimeout(timeout)) {
 
   router_.setDecoderFilterCallbacks(*this);
   // TODO(mattklein123): Correctly set protocol in request info when we support access logging.
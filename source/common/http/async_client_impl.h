@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/event/dispatcher.h"
@@ -51,10 +52,19 @@ public:
   Event::Dispatcher& dispatcher() override { return dispatcher_; }
 
 private:
+  /**
+   * Returns the synthetic route for the given timeout. Async client routes are immutable and
+   * depend only on the cluster name and timeout, and callers overwhelmingly use one fixed
+   * timeout, so routes are shared across requests instead of allocated per request.
+   */
+  Router::RouteConstSharedPtr routeForTimeout(const Optional<std::chrono::milliseconds>& timeout);
+
   const Upstream::ClusterInfo& cluster_;
   Router::FilterConfig config_;
   Event::Dispatcher& dispatcher_;
   std::list<std::unique_ptr<AsyncStreamImpl>> active_streams_;
+  // Keyed by timeout in milliseconds, -1 for no timeout. See routeForTimeout().
+  std::unordered_map<int64_t, Router::RouteConstSharedPtr> route_cache_;
 
   friend class AsyncStreamImpl;
   friend class AsyncRequestImpl;
@@ -142,6 +152,7 @@ private:
 
     // Router::RouteEntry
     const std::string& clusterName() const override { return cluster_name_; }
+    Optional<uint64_t> clusterHandle() const override { return Optional<uint64_t>(); }
     const Router::CorsPolicy* corsPolicy() const override { return nullptr; }
     void finalizeRequestHeaders(Http::HeaderMap&) const override {}
     const Router::HashPolicy* hashPolicy() const override { return nullptr; }
@@ -220,13 +231,17 @@ private:
   void removeDownstreamWatermarkCallbacks(DownstreamWatermarkCallbacks&) override {}
   void setDecoderBufferLimit(uint32_t) override {}
   uint32_t decoderBufferLimit() override { return 0; }
+  const QueryParams& queryParams() override { return query_params_; }
 
   AsyncClient::StreamCallbacks& stream_callbacks_;
   const uint64_t stream_id_;
   Router::ProdFilter router_;
   AccessLog::RequestInfoImpl request_info_;
   Tracing::NullSpan active_span_;
-  std::shared_ptr<RouteImpl> route_;
+  // Shared with other streams using the same timeout. See AsyncClientImpl::routeForTimeout().
+  Router::RouteConstSharedPtr route_;
+  // Only the router runs on async client streams and it does not use query parameters.
+  const QueryParams query_params_;
   bool local_closed_{};
   bool remote_closed_{};
 
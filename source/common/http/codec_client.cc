@@ -32,15 +32,26 @@ CodecClient::~CodecClient() {}
 
 void CodecClient::close() { connection_->close(Network::ConnectionCloseType::NoFlush); }
 
-void CodecClient::deleteRequest(ActiveRequest& request) {
-  connection_->dispatcher().deferredDelete(request.removeFromList(active_requests_));
+void CodecClient::retireRequest(ActiveRequest& request) {
+  // The wrapper goes onto the free list rather than being deferred deleted. Decoder calls
+  // already dispatched on the stack resolved their target before the retirement, so rebinding
+  // the wrapper to a new request in the same dispatch cycle is safe.
+  ActiveRequestPtr removed = request.removeFromList(active_requests_);
+  request.moveIntoList(std::move(removed), spare_requests_);
   if (codec_client_callbacks_) {
     codec_client_callbacks_->onStreamDestroy();
   }
 }
 
 StreamEncoder& CodecClient::newStream(StreamDecoder& response_decoder) {
-  ActiveRequestPtr request(new ActiveRequest(*this, response_decoder));
+  ActiveRequestPtr request;
+  if (!spare_requests_.empty()) {
+    request = spare_requests_.front()->removeFromList(spare_requests_);
+    request->setInnerDecoder(response_decoder);
+  } else {
+    request.reset(new ActiveRequest(*this, response_decoder));
+  }
+
   request->encoder_ = &codec_->newStream(*request);
   request->encoder_->getStream().addCallbacks(*request);
   request->moveIntoList(std::move(request), active_requests_);
@@ -79,12 +90,13 @@ void CodecClient::onEvent(Network::ConnectionEvent event) {
 
 void CodecClient::responseDecodeComplete(ActiveRequest& request) {
   ENVOY_CONN_LOG(debug, "response complete", *connection_);
-  deleteRequest(request);
 
   // HTTP/2 can send us a reset after a complete response if the request was not complete. Users
   // of CodecClient will deal with the premature response case and we should not handle any
-  // further reset notification.
+  // further reset notification. Detach from the codec stream before the wrapper is retired so
+  // that a late reset can never reach a recycled wrapper.
   request.encoder_->getStream().removeCallbacks(request);
+  retireRequest(request);
 }
 
 void CodecClient::onReset(ActiveRequest& request, StreamResetReason reason) {
@@ -93,7 +105,7 @@ void CodecClient::onReset(ActiveRequest& request, StreamResetReason reason) {
     codec_client_callbacks_->onStreamReset(reason);
   }
 
-  deleteRequest(request);
+  retireRequest(request);
 }
 
 void CodecClient::onData(Buffer::Instance& data) {
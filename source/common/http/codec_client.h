@@ -149,12 +149,13 @@ private:
    * Wrapper for an outstanding request. Designed for handling stream multiplexing.
    */
   struct ActiveRequest : LinkedObject<ActiveRequest>,
-                         public Event::DeferredDeletable,
                          public StreamCallbacks,
                          public StreamDecoderWrapper {
     ActiveRequest(CodecClient& parent, StreamDecoder& inner)
         : StreamDecoderWrapper(inner), parent_(parent) {}
 
+    using StreamDecoderWrapper::setInnerDecoder;
+
     // StreamCallbacks
     void onResetStream(StreamResetReason reason) override { parent_.onReset(*this, reason); }
     void onAboveWriteBufferHighWatermark() override {}
@@ -176,7 +177,11 @@ private:
    */
   void responseDecodeComplete(ActiveRequest& request);
 
-  void deleteRequest(ActiveRequest& request);
+  /**
+   * Park a finished request wrapper on the free list for reuse by a later newStream() call.
+   */
+  void retireRequest(ActiveRequest& request);
+
   void onReset(ActiveRequest& request, StreamResetReason reason);
   void onData(Buffer::Instance& data);
 
@@ -192,6 +197,12 @@ private:
   }
 
   std::list<ActiveRequestPtr> active_requests_;
+  // Free list of request wrappers retired by retireRequest() and recycled by newStream(),
+  // avoiding a heap allocation per request on a reused connection. Bounded by the connection's
+  // peak concurrent stream count. A retired wrapper is detached from its codec stream and is
+  // only read again by already dispatched decoder calls on the stack, so it is safe to rebind
+  // within the same dispatch cycle.
+  std::list<ActiveRequestPtr> spare_requests_;
   Http::ConnectionCallbacks* codec_callbacks_{};
   CodecClientCallbacks* codec_client_callbacks_{};
   bool connected_{};
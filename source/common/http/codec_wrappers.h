@@ -16,7 +16,7 @@ public:
       onPreDecodeComplete();
     }
 
-    inner_.decodeHeaders(std::move(headers), end_stream);
+    inner_->decodeHeaders(std::move(headers), end_stream);
 
     if (end_stream) {
       onDecodeComplete();
@@ -28,7 +28,7 @@ public:
       onPreDecodeComplete();
     }
 
-    inner_.decodeData(data, end_stream);
+    inner_->decodeData(data, end_stream);
 
     if (end_stream) {
       onDecodeComplete();
@@ -37,12 +37,18 @@ public:
 
   void decodeTrailers(HeaderMapPtr&& trailers) override {
     onPreDecodeComplete();
-    inner_.decodeTrailers(std::move(trailers));
+    inner_->decodeTrailers(std::move(trailers));
     onDecodeComplete();
   }
 
 protected:
-  StreamDecoderWrapper(StreamDecoder& inner) : inner_(inner) {}
+  StreamDecoderWrapper(StreamDecoder& inner) : inner_(&inner) {}
+
+  /**
+   * Rebind the wrapper to a new inner decoder. Used by owners that recycle wrappers across
+   * requests instead of allocating a new one per request.
+   */
+  void setInnerDecoder(StreamDecoder& inner) { inner_ = &inner; }
 
   /**
    * Consumers of the wrapper generally want to know when a decode is complete. This is called
@@ -51,7 +57,7 @@ protected:
   virtual void onPreDecodeComplete() PURE;
   virtual void onDecodeComplete() PURE;
 
-  StreamDecoder& inner_;
+  StreamDecoder* inner_;
 };
 
 /**
@@ -55,6 +55,19 @@ void CodeUtility::chargeResponseStat(const ResponseStatInfo& info) {
         .inc();
   }
 
+  chargeVirtualClusterAndZoneStats(info, response_code);
+}
+
+void CodeUtility::chargeResponseStat(ResponseCodeStatFamily& family, const ResponseStatInfo& info) {
+  uint64_t response_code = Utility::getResponseStatus(info.response_headers_);
+  family.charge(response_code, info.internal_request_, info.upstream_canary_);
+  chargeVirtualClusterAndZoneStats(info, response_code);
+}
+
+void CodeUtility::chargeVirtualClusterAndZoneStats(const ResponseStatInfo& info,
+                                                   uint64_t response_code) {
+  std::string group_string = groupStringForResponseCode(static_cast<Code>(response_code));
+
   // Handle request virtual cluster.
   if (!info.request_vcluster_name_.empty()) {
     info.global_scope_
@@ -95,6 +108,16 @@ void CodeUtility::chargeResponseTiming(const ResponseTimingInfo& info) {
                                              info.response_time_);
   }
 
+  chargeVirtualClusterAndZoneTiming(info);
+}
+
+void CodeUtility::chargeResponseTiming(ResponseCodeStatFamily& family,
+                                       const ResponseTimingInfo& info) {
+  family.chargeTiming(info.response_time_, info.internal_request_, info.upstream_canary_);
+  chargeVirtualClusterAndZoneTiming(info);
+}
+
+void CodeUtility::chargeVirtualClusterAndZoneTiming(const ResponseTimingInfo& info) {
   if (!info.request_vcluster_name_.empty()) {
     info.global_scope_.deliverTimingToSinks("vhost." + info.request_vhost_name_ + ".vcluster." +
                                                 info.request_vcluster_name_ + ".upstream_rq_time",
@@ -123,6 +146,72 @@ std::string CodeUtility::groupStringForResponseCode(Code response_code) {
   }
 }
 
+void ResponseCodeStatFamily::charge(uint64_t response_code, bool internal_request,
+                                    bool upstream_canary) {
+  base_.charge(response_code);
+  if (upstream_canary) {
+    canary_.charge(response_code);
+  }
+  if (internal_request) {
+    internal_.charge(response_code);
+  } else {
+    external_.charge(response_code);
+  }
+}
+
+void ResponseCodeStatFamily::chargeTiming(std::chrono::milliseconds response_time,
+                                          bool internal_request, bool upstream_canary) {
+  base_.chargeTiming(response_time);
+  if (upstream_canary) {
+    canary_.chargeTiming(response_time);
+  }
+  if (internal_request) {
+    internal_.chargeTiming(response_time);
+  } else {
+    external_.chargeTiming(response_time);
+  }
+}
+
+void ResponseCodeStats::charge(uint64_t response_code) {
+  if (response_code < MIN_CODE || response_code >= MIN_CODE + NUM_CODES) {
+    // Not a real HTTP code; fall back to the dynamic path so the charged names stay identical.
+    CodeUtility::chargeBasicResponseStat(scope_, prefix_, static_cast<Code>(response_code));
+    return;
+  }
+
+  std::atomic<Stats::Counter*>& group_slot = group_counters_[response_code / 100 - 1];
+  Stats::Counter* group_counter = group_slot.load(std::memory_order_relaxed);
+  if (group_counter == nullptr) {
+    group_counter = &scope_.counter(
+        fmt::format("{}upstream_rq_{}", prefix_,
+                    CodeUtility::groupStringForResponseCode(static_cast<Code>(response_code))));
+    group_slot.store(group_counter, std::memory_order_relaxed);
+  }
+  group_counter->inc();
+
+  std::atomic<Stats::Counter*>& code_slot = code_counters_[response_code - MIN_CODE];
+  Stats::Counter* code_counter = code_slot.load(std::memory_order_relaxed);
+  if (code_counter == nullptr) {
+    code_counter = &scope_.counter(fmt::format("{}upstream_rq_{}", prefix_, response_code));
+    code_slot.store(code_counter, std::memory_order_relaxed);
+  }
+  code_counter->inc();
+}
+
+ResponseCodeStats& LazyResponseCodeStats::get(Stats::Scope& scope) {
+  ResponseCodeStats* stats = stats_.load(std::memory_order_acquire);
+  if (stats == nullptr) {
+    ResponseCodeStats* new_stats = new ResponseCodeStats(scope, prefix_);
+    if (stats_.compare_exchange_strong(stats, new_stats, std::memory_order_acq_rel)) {
+      stats = new_stats;
+    } else {
+      // Another thread won the race; stats now holds its pointer.
+      delete new_stats;
+    }
+  }
+  return *stats;
+}
+
 const char* CodeUtility::toString(Code code) {
   // clang-format off
   switch (code) {
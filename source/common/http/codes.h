@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <string>
@@ -11,6 +13,8 @@
 namespace Envoy {
 namespace Http {
 
+class ResponseCodeStatFamily;
+
 /**
  * General utility routines for HTTP codes.
  */
@@ -42,6 +46,14 @@ public:
    */
   static void chargeResponseStat(const ResponseStatInfo& info);
 
+  /**
+   * Same as above, but charge the base/canary/internal/external counters through a pre-resolved
+   * response code stat family instead of building stat names per charge. The family must have
+   * been created over info.cluster_scope_ and info.prefix_. The virtual cluster and zone stats
+   * embed per-request names and are still charged dynamically.
+   */
+  static void chargeResponseStat(ResponseCodeStatFamily& family, const ResponseStatInfo& info);
+
   struct ResponseTimingInfo {
     Stats::Scope& global_scope_;
     Stats::Scope& cluster_scope_;
@@ -60,6 +72,13 @@ public:
    */
   static void chargeResponseTiming(const ResponseTimingInfo& info);
 
+  /**
+   * Same as above, but deliver the base/canary/internal/external timings through pre-built
+   * histogram names held by the family instead of concatenating them per response. The virtual
+   * cluster and zone timings are still delivered dynamically from the info.
+   */
+  static void chargeResponseTiming(ResponseCodeStatFamily& family, const ResponseTimingInfo& info);
+
   /**
    * Convert an HTTP response code to a descriptive string.
    * @param code supplies the code to convert.
@@ -74,6 +93,99 @@ public:
   static bool is5xx(uint64_t code) { return code >= 500 && code < 600; }
 
   static std::string groupStringForResponseCode(Code response_code);
+
+private:
+  static void chargeVirtualClusterAndZoneStats(const ResponseStatInfo& info,
+                                               uint64_t response_code);
+  static void chargeVirtualClusterAndZoneTiming(const ResponseTimingInfo& info);
+};
+
+/**
+ * Response code counters and the response timing histogram for a single stat prefix over a fixed
+ * scope. Counters are resolved on first charge and then held in direct-indexed arrays, so in the
+ * steady state charging a response code is a pair of indexed increments with no string work. The
+ * timing histogram name is materialized once at construction.
+ */
+class ResponseCodeStats {
+public:
+  ResponseCodeStats(Stats::Scope& scope, const std::string& prefix)
+      : scope_(scope), prefix_(prefix), rq_time_name_(prefix + "upstream_rq_time") {}
+
+  /**
+   * Charge the group (*xx) and code specific counters for a response code.
+   */
+  void charge(uint64_t response_code);
+
+  /**
+   * Deliver a response timing under the pre-built histogram name.
+   */
+  void chargeTiming(std::chrono::milliseconds response_time) {
+    scope_.deliverTimingToSinks(rq_time_name_, response_time);
+  }
+
+private:
+  // Direct-indexed coverage for response codes [100, 600). Anything else takes the dynamic path.
+  static const uint64_t MIN_CODE = 100;
+  static const uint64_t NUM_CODES = 500;
+  static const uint64_t NUM_GROUPS = 5;
+
+  Stats::Scope& scope_;
+  const std::string prefix_;
+  const std::string rq_time_name_;
+  // Counter lookups for the same name always return the same central counter, so racing
+  // threads resolving a slot store the same pointer.
+  std::array<std::atomic<Stats::Counter*>, NUM_GROUPS> group_counters_{};
+  std::array<std::atomic<Stats::Counter*>, NUM_CODES> code_counters_{};
+};
+
+/**
+ * A ResponseCodeStats that is created on first charge, for config objects (such as route table
+ * virtual clusters) that are built before any stats scope is available. Creation is thread safe;
+ * every caller must supply the same scope.
+ */
+class LazyResponseCodeStats {
+public:
+  LazyResponseCodeStats(const std::string& prefix) : prefix_(prefix) {}
+  ~LazyResponseCodeStats() { delete stats_.load(); }
+
+  ResponseCodeStats& get(Stats::Scope& scope);
+
+private:
+  const std::string prefix_;
+  std::atomic<ResponseCodeStats*> stats_{};
+};
+
+/**
+ * Holds the response code counters charged by CodeUtility::chargeResponseStat() for a fixed
+ * scope and prefix: the base counters plus the canary./internal./external. variants. Counters
+ * are resolved on first charge and then held in direct-indexed arrays, so in the steady state
+ * charging a response code is a pair of indexed increments with no string work. Intended to be
+ * created once per cluster at config time.
+ */
+class ResponseCodeStatFamily {
+public:
+  ResponseCodeStatFamily(Stats::Scope& scope, const std::string& prefix)
+      : base_(scope, prefix), canary_(scope, prefix + "canary."),
+        internal_(scope, prefix + "internal."), external_(scope, prefix + "external.") {}
+
+  /**
+   * Charge the group (*xx) and code specific counters for the base family plus the applicable
+   * canary/internal/external variants.
+   */
+  void charge(uint64_t response_code, bool internal_request, bool upstream_canary);
+
+  /**
+   * Deliver a response timing to the base family plus the applicable canary/internal/external
+   * variants.
+   */
+  void chargeTiming(std::chrono::milliseconds response_time, bool internal_request,
+                    bool upstream_canary);
+
+private:
+  ResponseCodeStats base_;
+  ResponseCodeStats canary_;
+  ResponseCodeStats internal_;
+  ResponseCodeStats external_;
 };
 
 } // namespace Http
@@ -18,6 +18,7 @@
 #include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
+#include "common/common/tracepoint.h"
 #include "common/common/utility.h"
 #include "common/http/codes.h"
 #include "common/http/conn_manager_utility.h"
@@ -80,6 +81,11 @@ void ConnectionManagerImpl::initializeReadFilterCallbacks(Network::ReadFilterCal
       {stats_.named_.downstream_cx_rx_bytes_total_, stats_.named_.downstream_cx_rx_bytes_buffered_,
        stats_.named_.downstream_cx_tx_bytes_total_, stats_.named_.downstream_cx_tx_bytes_buffered_,
        nullptr});
+
+  // Until the client sends its first byte there is no protocol state, so the socket is safe to
+  // hand to a hot restart child. See doDeferredStreamDestroy() for when this is re-established
+  // between requests.
+  read_callbacks_->connection().setMigratable(true);
 }
 
 ConnectionManagerImpl::~ConnectionManagerImpl() {
@@ -89,15 +95,14 @@ ConnectionManagerImpl::~ConnectionManagerImpl() {
     stats_.named_.downstream_cx_ssl_active_.dec();
   }
 
-  if (codec_) {
+  // The codec is released when a WebSocket upgrade completes, so check for the relay first.
+  if (isWebSocketConnection()) {
+    stats_.named_.downstream_cx_websocket_active_.dec();
+  } else if (codec_) {
     if (codec_->protocol() == Protocol::Http2) {
       stats_.named_.downstream_cx_http2_active_.dec();
     } else {
-      if (isWebSocketConnection()) {
-        stats_.named_.downstream_cx_websocket_active_.dec();
-      } else {
-        stats_.named_.downstream_cx_http1_active_.dec();
-      }
+      stats_.named_.downstream_cx_http1_active_.dec();
     }
   }
 
@@ -165,6 +170,15 @@ void ConnectionManagerImpl::doDeferredStreamDestroy(ActiveStream& stream) {
   }
 
   read_callbacks_->connection().dispatcher().deferredDelete(stream.removeFromList(streams_));
+
+  // With no streams in flight an HTTP/1 connection is simply waiting for the next request, so
+  // its socket may be handed to a hot restart child. HTTP/2 and WebSocket connections carry
+  // protocol state that cannot cross the process boundary, and a draining connection is about
+  // to be closed anyway.
+  if (streams_.empty() && !isWebSocketConnection() && drain_state_ == DrainState::NotDraining &&
+      codec_ != nullptr && codec_->protocol() != Protocol::Http2) {
+    read_callbacks_->connection().setMigratable(true);
+  }
 }
 
 StreamDecoder& ConnectionManagerImpl::newStream(StreamEncoder& response_encoder) {
@@ -173,6 +187,7 @@ StreamDecoder& ConnectionManagerImpl::newStream(StreamEncoder& response_encoder)
   }
 
   ENVOY_CONN_LOG(debug, "new stream", read_callbacks_->connection());
+  read_callbacks_->connection().setMigratable(false);
   ActiveStreamPtr new_stream(new ActiveStream(*this));
   new_stream->response_encoder_ = &response_encoder;
   new_stream->response_encoder_->getStream().addCallbacks(*new_stream);
@@ -196,6 +211,10 @@ Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data) {
     return ws_connection_->onData(data);
   }
 
+  // Incoming bytes mean protocol state is (or is about to be) in play, so the socket can no
+  // longer be migrated until the resulting streams complete.
+  read_callbacks_->connection().setMigratable(false);
+
   if (!codec_) {
     codec_ = config_.createCodec(read_callbacks_->connection(), data, *this);
     if (codec_->protocol() == Protocol::Http2) {
@@ -231,18 +250,27 @@ Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data) {
     // Processing incoming data may release outbound data so check for closure here as well.
     checkForDeferredClose();
 
+    // If the dispatch upgraded this connection to a WebSocket, any bytes left in the buffer are
+    // already WebSocket frames that the codec stopped in front of. Hand them to the relay now
+    // rather than waiting for the next read event.
+    if (isWebSocketConnection()) {
+      if (data.length() > 0) {
+        return ws_connection_->onData(data);
+      }
+      return Network::FilterStatus::StopIteration;
+    }
+
     // The HTTP/1 codec will pause dispatch after a single message is complete. We want to
     // either redispatch if there are no streams and we have more data. If we have a single
-    // complete non-WebSocket stream but have not responded yet we will pause socket reads
-    // to apply back pressure.
+    // complete stream but have not responded yet we will pause socket reads to apply back
+    // pressure.
     if (codec_->protocol() != Protocol::Http2) {
       if (read_callbacks_->connection().state() == Network::Connection::State::Open &&
           data.length() > 0 && streams_.empty()) {
         redispatch = true;
       }
 
-      if (!streams_.empty() && streams_.front()->state_.remote_complete_ &&
-          !isWebSocketConnection()) {
+      if (!streams_.empty() && streams_.front()->state_.remote_complete_) {
         read_callbacks_->connection().readDisable(true);
       }
     }
@@ -251,6 +279,18 @@ Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data) {
   return Network::FilterStatus::StopIteration;
 }
 
+void ConnectionManagerImpl::onWebSocketHandshakeComplete(ActiveStream& stream) {
+  ENVOY_CONN_LOG(debug, "websocket handshake complete, releasing HTTP resources",
+                 read_callbacks_->connection());
+
+  // This is invoked from an upstream connection event, so we are never inside the downstream
+  // codec's dispatch loop here. The stream's destruction is still deferred to allow the event
+  // to finish unwinding through the WebSocket handler.
+  doDeferredStreamDestroy(stream);
+  ASSERT(streams_.empty());
+  codec_.reset();
+}
+
 void ConnectionManagerImpl::resetAllStreams() {
   while (!streams_.empty()) {
     // Mimic a downstream reset in this case.
@@ -343,7 +383,8 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
       stream_id_(ConnectionManagerUtility::generateStreamId(*snapped_route_config_,
                                                             connection_manager.random_generator_)),
       request_timer_(connection_manager_.stats_.named_.downstream_rq_time_.allocateSpan()),
-      request_info_(connection_manager_.codec_->protocol()) {
+      request_info_(connection_manager_.codec_->protocol(),
+                    connection_manager.read_callbacks_->connection().dispatcher()) {
   connection_manager_.stats_.named_.downstream_rq_total_.inc();
   connection_manager_.stats_.named_.downstream_rq_active_.inc();
   if (connection_manager_.codec_->protocol() == Protocol::Http2) {
@@ -374,14 +415,16 @@ ConnectionManagerImpl::ActiveStream::~ActiveStream() {
 
 void ConnectionManagerImpl::ActiveStream::addStreamDecoderFilterWorker(
     StreamDecoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamDecoderFilterPtr wrapper(new ActiveStreamDecoderFilter(*this, filter, dual_filter));
+  ActiveStreamDecoderFilterPtr wrapper(
+      arena_.make<ActiveStreamDecoderFilter>(*this, filter, dual_filter));
   filter->setDecoderFilterCallbacks(*wrapper);
   wrapper->moveIntoListBack(std::move(wrapper), decoder_filters_);
 }
 
 void ConnectionManagerImpl::ActiveStream::addStreamEncoderFilterWorker(
     StreamEncoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamEncoderFilterPtr wrapper(new ActiveStreamEncoderFilter(*this, filter, dual_filter));
+  ActiveStreamEncoderFilterPtr wrapper(
+      arena_.make<ActiveStreamEncoderFilter>(*this, filter, dual_filter));
   filter->setEncoderFilterCallbacks(*wrapper);
   wrapper->moveIntoListBack(std::move(wrapper), encoder_filters_);
 }
@@ -423,8 +466,12 @@ Ssl::Connection* ConnectionManagerImpl::ActiveStream::ssl() {
 }
 
 void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers, bool end_stream) {
+  ENVOY_PROBE1(stream_decode_start, stream_id_);
   ASSERT(!state_.remote_complete_);
   state_.remote_complete_ = end_stream;
+  if (state_.remote_complete_) {
+    ENVOY_PROBE1(stream_decode_end, stream_id_);
+  }
 
   request_headers_ = std::move(headers);
   ENVOY_STREAM_LOG(debug, "request headers complete (end_stream={}):", *this, end_stream);
@@ -446,14 +493,14 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
     // The protocol may have shifted in the HTTP/1.0 case so reset it.
     request_info_.protocol(protocol);
     HeaderMapImpl headers{
-        {Headers::get().Status, std::to_string(enumToInt(Code::UpgradeRequired))}};
+        {Headers::get().Status, Utility::numericStatusString(Code::UpgradeRequired)}};
     encodeHeaders(nullptr, headers, true);
     return;
   }
 
   // Require host header. For HTTP/1.1 Host has already been translated to :authority.
   if (!request_headers_->Host()) {
-    HeaderMapImpl headers{{Headers::get().Status, std::to_string(enumToInt(Code::BadRequest))}};
+    HeaderMapImpl headers{{Headers::get().Status, Utility::numericStatusString(Code::BadRequest)}};
     encodeHeaders(nullptr, headers, true);
     return;
   }
@@ -467,7 +514,7 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
   // envoy users who do not wish to proxy large headers.
   if (request_headers_->byteSize() > (60 * 1024)) {
     HeaderMapImpl headers{
-        {Headers::get().Status, std::to_string(enumToInt(Code::RequestHeaderFieldsTooLarge))}};
+        {Headers::get().Status, Utility::numericStatusString(Code::RequestHeaderFieldsTooLarge)}};
     encodeHeaders(nullptr, headers, true);
     return;
   }
@@ -479,7 +526,7 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
   // don't support that currently.
   if (!request_headers_->Path() || request_headers_->Path()->value().c_str()[0] != '/') {
     connection_manager_.stats_.named_.downstream_rq_non_relative_path_.inc();
-    HeaderMapImpl headers{{Headers::get().Status, std::to_string(enumToInt(Code::NotFound))}};
+    HeaderMapImpl headers{{Headers::get().Status, Utility::numericStatusString(Code::NotFound)}};
     encodeHeaders(nullptr, headers, true);
     return;
   }
@@ -497,7 +544,7 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
       connection_manager_.runtime_, connection_manager_.local_info_);
 
   ASSERT(!cached_route_.valid());
-  cached_route_.value(snapped_route_config_->route(*request_headers_, stream_id_));
+  refreshCachedRoute();
 
   // Check for WebSocket upgrade request if the route exists, and supports WebSockets.
   // TODO if there are no filters when starting a filter iteration, the connection manager
@@ -521,13 +568,14 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
       } else if (websocket_requested) {
         // Do not allow WebSocket upgrades if the route does not support it.
         connection_manager_.stats_.named_.downstream_rq_ws_on_non_ws_route_.inc();
-        HeaderMapImpl headers{{Headers::get().Status, std::to_string(enumToInt(Code::Forbidden))}};
+        HeaderMapImpl headers{
+            {Headers::get().Status, Utility::numericStatusString(Code::Forbidden)}};
         encodeHeaders(nullptr, headers, true);
       } else {
         // Do not allow normal connections on WebSocket routes.
         connection_manager_.stats_.named_.downstream_rq_non_ws_on_ws_route_.inc();
         HeaderMapImpl headers{
-            {Headers::get().Status, std::to_string(enumToInt(Code::UpgradeRequired))}};
+            {Headers::get().Status, Utility::numericStatusString(Code::UpgradeRequired)}};
         encodeHeaders(nullptr, headers, true);
       }
       return;
@@ -555,6 +603,24 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
   decodeHeaders(nullptr, *request_headers_, end_stream);
 }
 
+void ConnectionManagerImpl::ActiveStream::refreshCachedRoute() {
+  cached_route_.value(snapped_route_config_->route(*request_headers_, stream_id_));
+}
+
+const QueryParams& ConnectionManagerImpl::ActiveStream::queryParams() {
+  ASSERT(request_headers_ != nullptr);
+  const HeaderEntry* path = request_headers_->Path();
+  const char* current_path = path != nullptr ? path->value().c_str() : "";
+  // Rebuilding only when the path has changed keeps the check to a string compare when a filter
+  // rewrites the path, while every other caller gets the cached decomposition.
+  if (!query_params_valid_ || query_params_path_ != current_path) {
+    query_params_ = Utility::parseQueryString(current_path);
+    query_params_path_ = current_path;
+    query_params_valid_ = true;
+  }
+  return query_params_;
+}
+
 void ConnectionManagerImpl::ActiveStream::decodeHeaders(ActiveStreamDecoderFilter* filter,
                                                         HeaderMap& headers, bool end_stream) {
   std::list<ActiveStreamDecoderFilterPtr>::iterator entry;
@@ -602,6 +668,7 @@ void ConnectionManagerImpl::ActiveStream::decodeData(Buffer::Instance& data, boo
   ASSERT(!state_.remote_complete_);
   state_.remote_complete_ = end_stream;
   if (state_.remote_complete_) {
+    ENVOY_PROBE1(stream_decode_end, stream_id_);
     ENVOY_STREAM_LOG(debug, "request end stream", *this);
   }
 
@@ -660,6 +727,7 @@ void ConnectionManagerImpl::ActiveStream::decodeTrailers(HeaderMapPtr&& trailers
   request_trailers_ = std::move(trailers);
   ASSERT(!state_.remote_complete_);
   state_.remote_complete_ = true;
+  ENVOY_PROBE1(stream_decode_end, stream_id_);
   decodeTrailers(nullptr, *request_trailers_);
 }
 
@@ -883,6 +951,10 @@ void ConnectionManagerImpl::ActiveStream::encodeTrailers(ActiveStreamEncoderFilt
 
 void ConnectionManagerImpl::ActiveStream::maybeEndEncode(bool end_stream) {
   if (end_stream) {
+    request_info_.markPhase(AccessLog::RequestPhase::EncodeComplete,
+                            connection_manager_.read_callbacks_->connection()
+                                .dispatcher()
+                                .approximateMonotonicTime());
     request_timer_->complete();
     connection_manager_.doEndStream(*this);
   }
@@ -1061,8 +1133,7 @@ Tracing::Span& ConnectionManagerImpl::ActiveStreamFilterBase::activeSpan() {
 
 Router::RouteConstSharedPtr ConnectionManagerImpl::ActiveStreamFilterBase::route() {
   if (!parent_.cached_route_.valid()) {
-    parent_.cached_route_.value(
-        parent_.snapped_route_config_->route(*parent_.request_headers_, parent_.stream_id_));
+    parent_.refreshCachedRoute();
   }
 
   return parent_.cached_route_.value();
@@ -24,6 +24,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/buffer/watermark_buffer.h"
+#include "common/common/arena.h"
 #include "common/common/linked_object.h"
 #include "common/http/access_log/request_info_impl.h"
 #include "common/http/date_provider.h"
@@ -345,7 +346,7 @@ private:
    */
   struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
                                      public StreamDecoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamDecoderFilter> {
+                                     LinkedObject<ActiveStreamDecoderFilter, ArenaDeleter> {
     ActiveStreamDecoderFilter(ActiveStream& parent, StreamDecoderFilterSharedPtr filter,
                               bool dual_filter)
         : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
@@ -380,6 +381,7 @@ private:
     removeDownstreamWatermarkCallbacks(DownstreamWatermarkCallbacks& watermark_callbacks) override;
     void setDecoderBufferLimit(uint32_t limit) override { parent_.setBufferLimit(limit); }
     uint32_t decoderBufferLimit() override { return parent_.buffer_limit_; }
+    const QueryParams& queryParams() override { return parent_.queryParams(); }
 
     void requestDataTooLarge();
     void requestDataDrained();
@@ -387,14 +389,14 @@ private:
     StreamDecoderFilterSharedPtr handle_;
   };
 
-  typedef std::unique_ptr<ActiveStreamDecoderFilter> ActiveStreamDecoderFilterPtr;
+  typedef std::unique_ptr<ActiveStreamDecoderFilter, ArenaDeleter> ActiveStreamDecoderFilterPtr;
 
   /**
    * Wrapper for a stream encoder filter.
    */
   struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
                                      public StreamEncoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamEncoderFilter> {
+                                     LinkedObject<ActiveStreamEncoderFilter, ArenaDeleter> {
     ActiveStreamEncoderFilter(ActiveStream& parent, StreamEncoderFilterSharedPtr filter,
                               bool dual_filter)
         : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
@@ -429,7 +431,7 @@ private:
     StreamEncoderFilterSharedPtr handle_;
   };
 
-  typedef std::unique_ptr<ActiveStreamEncoderFilter> ActiveStreamEncoderFilterPtr;
+  typedef std::unique_ptr<ActiveStreamEncoderFilter, ArenaDeleter> ActiveStreamEncoderFilterPtr;
 
   /**
    * Wraps a single active stream on the connection. These are either full request/response pairs
@@ -464,6 +466,15 @@ private:
     void maybeEndEncode(bool end_stream);
     uint64_t streamId() { return stream_id_; }
 
+    // Resolve the route once and cache it on the stream. Filters read the cached entry via
+    // StreamFilterCallbacks::route() and must call clearRouteCache() after mutating headers in
+    // a way that affects routing.
+    void refreshCachedRoute();
+
+    // Lazily parse the request path's query string once and cache the result for the stream.
+    // See StreamDecoderFilterCallbacks::queryParams().
+    const QueryParams& queryParams();
+
     // Http::StreamCallbacks
     void onResetStream(StreamResetReason reason) override;
     void onAboveWriteBufferHighWatermark() override;
@@ -491,6 +502,9 @@ private:
     void sendHeadersOnlyResponse(HeaderMap& headers) override {
       encodeHeaders(nullptr, headers, true);
     }
+    void onHandshakeComplete() override {
+      connection_manager_.onWebSocketHandshakeComplete(*this);
+    }
 
     // Tracing::TracingConfig
     virtual Tracing::OperationName operationName() const override;
@@ -535,6 +549,10 @@ private:
     void setBufferLimit(uint32_t limit);
 
     ConnectionManagerImpl& connection_manager_;
+    // Arena for per-stream objects that all die with the stream (currently the filter chain
+    // wrappers). Must be declared before the filter lists below so that it is destroyed after
+    // the wrappers' destructors have run.
+    Arena arena_;
     Router::ConfigConstSharedPtr snapped_route_config_;
     Tracing::SpanPtr active_span_{new Tracing::NullSpan()};
     const uint64_t stream_id_;
@@ -553,6 +571,11 @@ private:
     AccessLog::RequestInfoImpl request_info_;
     std::string downstream_address_;
     Optional<Router::RouteConstSharedPtr> cached_route_;
+    // Query parameter cache along with the path it was parsed from, so that a path rewrite
+    // invalidates it; only filled in once a filter asks for the parameters.
+    QueryParams query_params_;
+    std::string query_params_path_;
+    bool query_params_valid_{};
     DownstreamWatermarkCallbacks* watermark_callbacks_{nullptr};
     uint32_t buffer_limit_{0};
     uint32_t high_watermark_count_{0};
@@ -577,6 +600,13 @@ private:
    */
   void doEndStream(ActiveStream& stream);
 
+  /**
+   * Release the HTTP machinery once a WebSocket upgrade handshake has been relayed upstream. The
+   * stream that initiated the upgrade, its filter chain and the codec are all dead weight at that
+   * point: every subsequent byte moves through the raw relay in ws_connection_.
+   */
+  void onWebSocketHandshakeComplete(ActiveStream& stream);
+
   void resetAllStreams();
   void onIdleTimeout();
   void onDrainTimeout();
@@ -41,7 +41,10 @@ FilterDataStatus BufferFilter::decodeData(Buffer::Instance&, bool end_stream) {
   }
 
   // Buffer until the complete request has been processed or the ConnectionManagerImpl sends a 413.
-  return FilterDataStatus::StopIterationAndBuffer;
+  // In backpressure mode the connection manager instead stops reading from the downstream
+  // connection when the buffer hits its high watermark, and resumes once it drains.
+  return config_->watermark_backpressure_ ? FilterDataStatus::StopIterationAndWatermark
+                                          : FilterDataStatus::StopIterationAndBuffer;
 }
 
 FilterTrailersStatus BufferFilter::decodeTrailers(HeaderMap&) {
@@ -35,6 +35,9 @@ struct BufferFilterConfig {
   BufferFilterStats stats_;
   uint64_t max_request_bytes_;
   std::chrono::seconds max_request_time_;
+  // If true, reaching max_request_bytes_ raises the stream's high watermark and pauses downstream
+  // reads instead of failing the request with a 413.
+  bool watermark_backpressure_;
 };
 
 typedef std::shared_ptr<const BufferFilterConfig> BufferFilterConfigConstSharedPtr;
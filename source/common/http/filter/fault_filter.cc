@@ -24,6 +24,7 @@
 namespace Envoy {
 namespace Http {
 
+const std::string FaultFilter::FAULT_KEY_PREFIX = "fault.http.";
 const std::string FaultFilter::DELAY_PERCENT_KEY = "fault.http.delay.fixed_delay_percent";
 const std::string FaultFilter::ABORT_PERCENT_KEY = "fault.http.abort.abort_percent";
 const std::string FaultFilter::DELAY_DURATION_KEY = "fault.http.delay.fixed_duration_ms";
@@ -62,10 +63,12 @@ FaultFilterConfig::FaultFilterConfig(const Json::Object& json_config, Runtime::L
   if (json_config.hasObject("headers")) {
     std::vector<Json::ObjectSharedPtr> config_headers = json_config.getObjectArray("headers");
     for (const Json::ObjectSharedPtr& header_map : config_headers) {
-      fault_filter_headers_.push_back(*header_map);
+      fault_filter_headers_.add(*header_map);
     }
   }
 
+  fault_configured_ = abort_percent_ > 0 || fixed_delay_percent_ > 0;
+
   upstream_cluster_ = json_config.getString("upstream_cluster", EMPTY_STRING);
 
   if (json_config.hasObject("downstream_nodes")) {
@@ -83,6 +86,17 @@ FaultFilter::~FaultFilter() { ASSERT(!delay_timer_); }
 // if we inject a delay, then we will inject the abort in the delay timer
 // callback.
 FilterHeadersStatus FaultFilter::decodeHeaders(HeaderMap& headers, bool) {
+  // The filter is typically installed everywhere so that faults can be injected the moment an
+  // incident calls for them, which means the common case is a request where nothing fires. If the
+  // static config cannot fire a fault on its own and the current snapshot holds no fault.http.
+  // overrides (including per downstream cluster keys), skip all of the matching and key
+  // construction below. keysWithPrefixExist() is answered from state precomputed once per
+  // snapshot load.
+  if (!config_->faultConfigured() &&
+      !config_->runtime().snapshot().keysWithPrefixExist(FAULT_KEY_PREFIX)) {
+    return FilterHeadersStatus::Continue;
+  }
+
   if (!matchesTargetUpstreamCluster()) {
     return FilterHeadersStatus::Continue;
   }
@@ -92,7 +106,7 @@ FilterHeadersStatus FaultFilter::decodeHeaders(HeaderMap& headers, bool) {
   }
 
   // Check for header matches
-  if (!Router::ConfigUtility::matchHeaders(headers, config_->filterHeaders())) {
+  if (!config_->filterHeaders().matches(headers)) {
     return FilterHeadersStatus::Continue;
   }
 
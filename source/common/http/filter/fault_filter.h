@@ -39,10 +39,11 @@ public:
   FaultFilterConfig(const Json::Object& json_config, Runtime::Loader& runtime,
                     const std::string& stats_prefix, Stats::Scope& scope);
 
-  const std::vector<Router::ConfigUtility::HeaderData>& filterHeaders() {
+  const Router::ConfigUtility::HeaderMatchProgram& filterHeaders() {
     return fault_filter_headers_;
   }
   uint64_t abortPercent() { return abort_percent_; }
+  bool faultConfigured() { return fault_configured_; }
   uint64_t delayPercent() { return fixed_delay_percent_; }
   uint64_t delayDuration() { return fixed_duration_ms_; }
   uint64_t abortCode() { return http_status_; }
@@ -60,8 +61,10 @@ private:
   uint64_t http_status_{};         // HTTP or gRPC return codes
   uint64_t fixed_delay_percent_{}; // 0-100
   uint64_t fixed_duration_ms_{};   // in milliseconds
+  bool fault_configured_{};        // true if a non-zero percent is statically configured, i.e. a
+                                   // fault can fire without any runtime override present
   std::string upstream_cluster_;   // restrict faults to specific upstream cluster
-  std::vector<Router::ConfigUtility::HeaderData> fault_filter_headers_;
+  Router::ConfigUtility::HeaderMatchProgram fault_filter_headers_;
   std::unordered_set<std::string> downstream_nodes_{}; // Inject failures for specific downstream
                                                        // nodes. If not set then inject for all.
   Runtime::Loader& runtime_;
@@ -114,6 +117,7 @@ private:
   std::string downstream_cluster_delay_duration_key_{};
   std::string downstream_cluster_abort_http_status_key_{};
 
+  const static std::string FAULT_KEY_PREFIX;
   const static std::string DELAY_PERCENT_KEY;
   const static std::string ABORT_PERCENT_KEY;
   const static std::string DELAY_DURATION_KEY;
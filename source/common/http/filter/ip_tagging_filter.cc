@@ -1,15 +1,72 @@
 #include "common/http/filter/ip_tagging_filter.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/network/utility.h"
+
 namespace Envoy {
 namespace Http {
 
+IpTaggingFilterConfig::IpTaggingFilterConfig(const Json::Object& json_config)
+    : Json::Validator(json_config, Json::Schema::IP_TAGGING_HTTP_FILTER_SCHEMA),
+      request_type_(stringToType(json_config.getString("request_type", "both"))) {
+  std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>> tag_data;
+  for (const Json::ObjectSharedPtr& ip_tag : json_config.getObjectArray("ip_tags", true)) {
+    std::pair<std::string, std::vector<Network::Address::CidrRange>> entry;
+    entry.first = ip_tag->getString("ip_tag_name");
+    for (const std::string& ip : ip_tag->getStringArray("ip_list")) {
+      // Bare addresses are allowed in ip_list; treat them as full length ranges. create() caps
+      // the length at 32 for IPv4 addresses.
+      Network::Address::CidrRange range = ip.find('/') != std::string::npos
+                                              ? Network::Address::CidrRange::create(ip)
+                                              : Network::Address::CidrRange::create(ip, 128);
+      if (!range.isValid()) {
+        throw EnvoyException(
+            fmt::format("invalid ip/mask combo '{}' in ip_tags entry '{}'", ip, entry.first));
+      }
+      entry.second.push_back(range);
+    }
+    tag_data.push_back(std::move(entry));
+  }
+  trie_.reset(new Network::LcTrie<std::string>(tag_data));
+}
+
 IpTaggingFilter::IpTaggingFilter(IpTaggingFilterConfigSharedPtr config) : config_(config) {}
 
 IpTaggingFilter::~IpTaggingFilter() {}
 
 void IpTaggingFilter::onDestroy() {}
 
-FilterHeadersStatus IpTaggingFilter::decodeHeaders(HeaderMap&, bool) {
+FilterHeadersStatus IpTaggingFilter::decodeHeaders(HeaderMap& headers, bool) {
+  const bool internal_request = Utility::isInternalRequest(headers);
+  if ((config_->requestType() == FilterRequestType::Internal && !internal_request) ||
+      (config_->requestType() == FilterRequestType::External && internal_request)) {
+    return FilterHeadersStatus::Continue;
+  }
+
+  const std::string xff_address = Utility::getLastAddressFromXFF(headers);
+  if (xff_address.empty()) {
+    return FilterHeadersStatus::Continue;
+  }
+
+  Network::Address::InstanceConstSharedPtr address;
+  try {
+    address = Network::Utility::parseInternetAddress(xff_address);
+  } catch (const EnvoyException&) {
+    // An unparseable XFF entry is simply not tagged.
+    return FilterHeadersStatus::Continue;
+  }
+
+  const std::vector<std::string> tags = config_->trie().getTags(*address);
+  if (!tags.empty()) {
+    headers.addReferenceKey(Headers::get().EnvoyIpTags, StringUtil::join(tags, ","));
+  }
+
   return FilterHeadersStatus::Continue;
 }
 
@@ -1,16 +1,26 @@
 #include "common/http/header_map_impl.h"
 
 #include <cstdint>
+#include <cstring>
 #include <list>
+#include <random>
 #include <string>
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
+#include "common/common/hash.h"
 #include "common/common/singleton.h"
 #include "common/common/utility.h"
 
 namespace Envoy {
 namespace Http {
+namespace {
+
+// Below this many headers a linear scan of the list is cheaper than hashing the key, so get()
+// only builds and consults the lookup index for larger maps.
+constexpr size_t MinHeadersForLookupIndex = 16;
+
+} // namespace
 
 HeaderString::HeaderString() : type_(Type::Inline) {
   buffer_.dynamic_ = inline_buffer_;
@@ -187,6 +197,14 @@ void HeaderString::setReference(const std::string& ref_value) {
   string_length_ = ref_value.size();
 }
 
+void HeaderString::setReference(const HeaderString& ref_value) {
+  ASSERT(ref_value.type() == Type::Reference);
+  freeDynamic();
+  type_ = Type::Reference;
+  buffer_.ref_ = ref_value.c_str();
+  string_length_ = ref_value.size();
+}
+
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key) : key_(key) {}
 
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value)
@@ -221,35 +239,81 @@ HeaderMapImpl::StaticLookupTable::StaticLookupTable() {
   add(Headers::get().HostLegacy.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {
     return {&h.inline_headers_.Host_, &Headers::get().Host};
   });
-}
 
-void HeaderMapImpl::StaticLookupTable::add(const char* key, StaticLookupEntry::EntryCb cb) {
-  StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    if (!current->entries_[c]) {
-      current->entries_[c].reset(new StaticLookupEntry());
+  build();
+}
+
+void HeaderMapImpl::StaticLookupTable::add(const char* key, EntryCb cb) {
+  Entry entry;
+  entry.key_ = key;
+  entry.size_ = strlen(key);
+  entry.cb_ = cb;
+  // find() only samples characters for keys of at least 2 characters, which all known inline
+  // headers satisfy.
+  ASSERT(entry.size_ >= 2);
+  entries_.push_back(entry);
+}
+
+uint64_t HeaderMapImpl::StaticLookupTable::hash(const char* key, uint32_t size) const {
+  // The key set is fixed and the seed is chosen by build() so that sampling a handful of
+  // characters is collision free; a full comparison in find() rejects unknown keys that happen
+  // to land on an occupied slot.
+  const uint8_t samples[] = {static_cast<uint8_t>(size), static_cast<uint8_t>(key[0]),
+                             static_cast<uint8_t>(key[size - 1]),
+                             static_cast<uint8_t>(key[size / 2]),
+                             static_cast<uint8_t>(key[size - 2])};
+  uint64_t hash = 14695981039346656037ULL;
+  for (uint8_t sample : samples) {
+    hash = (hash ^ sample) * seed_;
+  }
+  return (hash >> 32) & mask_;
+}
+
+void HeaderMapImpl::StaticLookupTable::build() {
+  uint64_t size = 4;
+  while (size < 4 * entries_.size()) {
+    size *= 2;
+  }
+
+  // Deterministically seeded so that every process builds an identical table. If a table size
+  // does not admit a perfect seed (only possible if the inline header set grows substantially),
+  // fall back to the next power of two; the search terminates quickly in practice.
+  std::mt19937_64 prng(0);
+  while (true) {
+    mask_ = size - 1;
+    for (uint32_t attempt = 0; attempt < 10000; attempt++) {
+      seed_ = prng() | 1;
+      std::vector<Entry> table(size);
+      bool collision = false;
+      for (const Entry& entry : entries_) {
+        Entry& slot = table[hash(entry.key_, entry.size_)];
+        if (slot.cb_ != nullptr) {
+          collision = true;
+          break;
+        }
+        slot = entry;
+      }
+      if (!collision) {
+        table_.swap(table);
+        entries_.clear();
+        return;
+      }
     }
-
-    current = current->entries_[c].get();
-    key++;
+    size *= 2;
   }
-
-  current->cb_ = cb;
 }
 
-HeaderMapImpl::StaticLookupEntry::EntryCb
-HeaderMapImpl::StaticLookupTable::find(const char* key) const {
-  const StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    current = current->entries_[c].get();
-    if (current) {
-      key++;
-    } else {
-      return nullptr;
-    }
+HeaderMapImpl::StaticLookupTable::EntryCb
+HeaderMapImpl::StaticLookupTable::find(const char* key, uint32_t size) const {
+  if (size < 2) {
+    return nullptr;
   }
 
-  return current->cb_;
+  const Entry& entry = table_[hash(key, size)];
+  if (entry.cb_ != nullptr && entry.size_ == size && 0 == memcmp(entry.key_, key, size)) {
+    return entry.cb_;
+  }
+  return nullptr;
 }
 
 HeaderMapImpl::HeaderMapImpl() { memset(&inline_headers_, 0, sizeof(inline_headers_)); }
@@ -257,11 +321,20 @@ HeaderMapImpl::HeaderMapImpl() { memset(&inline_headers_, 0, sizeof(inline_heade
 HeaderMapImpl::HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() {
   rhs.iterate(
       [](const HeaderEntry& header, void* context) -> void {
-        // TODO(mattklein123) PERF: Avoid copying here is not necessary.
+        // Reference strings point at data that outlives any request/response (e.g. the static
+        // strings in HeaderValues), so the copy can share them instead of allocating.
         HeaderString key_string;
-        key_string.setCopy(header.key().c_str(), header.key().size());
+        if (header.key().type() == HeaderString::Type::Reference) {
+          key_string.setReference(header.key());
+        } else {
+          key_string.setCopy(header.key().c_str(), header.key().size());
+        }
         HeaderString value_string;
-        value_string.setCopy(header.value().c_str(), header.value().size());
+        if (header.value().type() == HeaderString::Type::Reference) {
+          value_string.setReference(header.value());
+        } else {
+          value_string.setCopy(header.value().c_str(), header.value().size());
+        }
 
         static_cast<HeaderMapImpl*>(context)->addViaMove(std::move(key_string),
                                                          std::move(value_string));
@@ -296,7 +369,8 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
 }
 
 void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.c_str());
+  StaticLookupTable::EntryCb cb =
+      ConstSingleton<StaticLookupTable>::get().find(key.c_str(), key.size());
   if (cb) {
     // TODO(mattklein123): Currently, for all of the inline headers, we don't support appending. The
     // only inline header where we should be converting multiple headers into a comma delimited
@@ -310,6 +384,7 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
     std::list<HeaderEntryImpl>::iterator i =
         headers_.emplace(headers_.end(), std::move(key), std::move(value));
     i->entry_ = i;
+    addToLookupIndex(*i);
   }
 }
 
@@ -370,6 +445,35 @@ uint64_t HeaderMapImpl::byteSize() const {
 }
 
 const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
+  // If the key has an O(1) slot, the static table tells us exactly where the entry lives (or that
+  // it is absent) without touching the list. The callback only hands back a pointer to the slot
+  // and does not mutate the map.
+  StaticLookupTable::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(
+      key.get().c_str(), static_cast<uint32_t>(key.get().size()));
+  if (cb) {
+    StaticLookupResponse ref_lookup_response = cb(const_cast<HeaderMapImpl&>(*this));
+    if (ref_lookup_response.key_->get() == key.get()) {
+      return *ref_lookup_response.entry_;
+    }
+    // An aliased key (the legacy host header, which shares the :authority slot) stores a
+    // different key than the one being looked up; fall through so its lookup behavior is
+    // unchanged.
+  }
+
+  if (headers_.size() >= MinHeadersForLookupIndex) {
+    if (!lookup_index_valid_) {
+      buildLookupIndex();
+    }
+    const auto index_entry = lookup_index_.find(HashUtil::xxHash64(key.get()));
+    if (index_entry == lookup_index_.end()) {
+      return nullptr;
+    }
+    if (index_entry->second->key() == key.get().c_str()) {
+      return index_entry->second;
+    }
+    // Two distinct keys hashed identically; let the scan below disambiguate.
+  }
+
   for (const HeaderEntryImpl& header : headers_) {
     if (header.key() == key.get().c_str()) {
       return &header;
@@ -386,11 +490,16 @@ void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
 }
 
 void HeaderMapImpl::remove(const LowerCaseString& key) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupTable::EntryCb cb =
+      ConstSingleton<StaticLookupTable>::get().find(key.get().c_str(),
+                                                    static_cast<uint32_t>(key.get().size()));
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
+    // Removal invalidates the lookup index; it is rare enough that rebuilding on the next indexed
+    // lookup beats surgically repairing the index here.
+    lookup_index_valid_ = false;
     for (auto i = headers_.begin(); i != headers_.end();) {
       if (i->key() == key.get().c_str()) {
         i = headers_.erase(i);
@@ -401,6 +510,46 @@ void HeaderMapImpl::remove(const LowerCaseString& key) {
   }
 }
 
+void HeaderMapImpl::remove(const std::list<LowerCaseString>& keys) {
+  // Inline headers are O(1) removals via their latched entry pointer, so handle them up front.
+  // Any remaining keys are applied together in a single walk of the backing list below, rather
+  // than one walk per key as repeated remove() calls would do.
+  bool need_scan = false;
+  for (const LowerCaseString& key : keys) {
+    StaticLookupTable::EntryCb cb =
+        ConstSingleton<StaticLookupTable>::get().find(key.get().c_str(),
+                                                      static_cast<uint32_t>(key.get().size()));
+    if (cb) {
+      StaticLookupResponse ref_lookup_response = cb(*this);
+      removeInline(ref_lookup_response.entry_);
+    } else {
+      need_scan = true;
+    }
+  }
+
+  if (!need_scan) {
+    return;
+  }
+
+  lookup_index_valid_ = false;
+  for (auto i = headers_.begin(); i != headers_.end();) {
+    bool removed = false;
+    // Inline keys already handled above cannot match here since their entries are gone from the
+    // list, so re-checking them only costs a failed compare on the rare mixed removal list.
+    for (const LowerCaseString& key : keys) {
+      if (i->key() == key.get().c_str()) {
+        i = headers_.erase(i);
+        removed = true;
+        break;
+      }
+    }
+
+    if (!removed) {
+      ++i;
+    }
+  }
+}
+
 HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl** entry,
                                                                  const LowerCaseString& key) {
   if (*entry) {
@@ -410,6 +559,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
   std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key);
   i->entry_ = i;
   *entry = &(*i);
+  addToLookupIndex(*i);
   return **entry;
 }
 
@@ -424,6 +574,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
   std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key, std::move(value));
   i->entry_ = i;
   *entry = &(*i);
+  addToLookupIndex(*i);
   return **entry;
 }
 
@@ -434,8 +585,27 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
+  lookup_index_valid_ = false;
   headers_.erase(entry->entry_);
 }
 
+void HeaderMapImpl::addToLookupIndex(const HeaderEntryImpl& entry) {
+  // Before the first indexed lookup the index does not exist and inserts should not pay for
+  // hashing the key; buildLookupIndex() picks this entry up if get() decides an index is needed.
+  if (lookup_index_valid_) {
+    lookup_index_.emplace(HashUtil::xxHash64(entry.key().c_str(), entry.key().size()), &entry);
+  }
+}
+
+void HeaderMapImpl::buildLookupIndex() const {
+  lookup_index_.clear();
+  for (const HeaderEntryImpl& header : headers_) {
+    // emplace() keeps the first entry for a repeated key, matching the first match semantics of a
+    // linear scan.
+    lookup_index_.emplace(HashUtil::xxHash64(header.key().c_str(), header.key().size()), &header);
+  }
+  lookup_index_valid_ = true;
+}
+
 } // namespace Http
 } // namespace Envoy
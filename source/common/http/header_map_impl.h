@@ -1,10 +1,11 @@
 #pragma once
 
-#include <array>
 #include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
@@ -64,6 +65,7 @@ public:
   const HeaderEntry* get(const LowerCaseString& key) const override;
   void iterate(ConstIterateCb cb, void* context) const override;
   void remove(const LowerCaseString& key) override;
+  void remove(const std::list<LowerCaseString>& keys) override;
   size_t size() const override { return headers_.size(); }
 
 protected:
@@ -91,23 +93,33 @@ protected:
     const LowerCaseString* key_;
   };
 
-  struct StaticLookupEntry {
-    typedef StaticLookupResponse (*EntryCb)(HeaderMapImpl&);
-
-    EntryCb cb_{};
-    std::array<std::unique_ptr<StaticLookupEntry>, 256> entries_;
-  };
-
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
-   * headers. This uses a trie for lookup time at most equal to the size of the incoming string.
+   * headers. The key set is fixed, so the table is indexed by a perfect hash built once at
+   * startup: classifying an incoming header costs one hash over a few sampled characters plus a
+   * single comparison, rather than a pointer chase per character as with a trie.
    */
   struct StaticLookupTable {
-    StaticLookupTable();
-    void add(const char* key, StaticLookupEntry::EntryCb cb);
-    StaticLookupEntry::EntryCb find(const char* key) const;
+    typedef StaticLookupResponse (*EntryCb)(HeaderMapImpl&);
 
-    StaticLookupEntry root_;
+    StaticLookupTable();
+    EntryCb find(const char* key, uint32_t size) const;
+
+  private:
+    struct Entry {
+      const char* key_{};
+      uint32_t size_{};
+      EntryCb cb_{};
+    };
+
+    void add(const char* key, EntryCb cb);
+    void build();
+    uint64_t hash(const char* key, uint32_t size) const;
+
+    uint64_t seed_{};
+    uint64_t mask_{};
+    std::vector<Entry> entries_;
+    std::vector<Entry> table_;
   };
 
   struct AllInlineHeaders {
@@ -119,9 +131,15 @@ protected:
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key,
                                      HeaderString&& value);
   void removeInline(HeaderEntryImpl** entry);
+  void addToLookupIndex(const HeaderEntryImpl& entry);
+  void buildLookupIndex() const;
 
   AllInlineHeaders inline_headers_;
   std::list<HeaderEntryImpl> headers_;
+  // Index over headers_ keyed by a hash of the header key, used by get() to avoid a linear scan
+  // once the map is large. Mutable because it is lazily built by the first indexed lookup.
+  mutable std::unordered_map<uint64_t, const HeaderEntryImpl*> lookup_index_;
+  mutable bool lookup_index_valid_{};
 
   ALL_INLINE_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
 };
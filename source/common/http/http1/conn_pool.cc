@@ -1,5 +1,7 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <list>
 
@@ -9,6 +11,7 @@
 #include "envoy/stats/stats.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/tracepoint.h"
 #include "common/common/utility.h"
 #include "common/http/codec_client.h"
 #include "common/http/codes.h"
@@ -19,6 +22,16 @@
 namespace Envoy {
 namespace Http {
 namespace Http1 {
+namespace {
+
+// When idle closes are due, only a fraction of the ready list is closed per timer wakeup and the
+// timer is re-armed with this short interval. A spike's worth of connections that all went idle
+// together then drains over multiple wakeups instead of closing (and potentially reconnecting)
+// in one synchronized burst.
+const std::chrono::milliseconds IdleCloseStaggerInterval{100};
+constexpr uint64_t IdleCloseDivisor = 8;
+
+} // namespace
 
 ConnPoolImpl::~ConnPoolImpl() {
   while (!ready_clients_.empty()) {
@@ -42,6 +55,7 @@ void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& re
                                          ConnectionPool::Callbacks& callbacks) {
   ASSERT(!client.stream_wrapper_);
   client.stream_wrapper_.reset(new StreamWrapper(response_decoder, client));
+  ENVOY_PROBE1(upstream_pool_checkout, host_->cluster().name().c_str());
   callbacks.onPoolReady(*client.stream_wrapper_, client.real_host_description_);
 }
 
@@ -63,12 +77,112 @@ void ConnPoolImpl::createNewConnection() {
   client->moveIntoList(std::move(client), busy_clients_);
 }
 
+uint64_t ConnPoolImpl::idleTimeoutMs() {
+  // The per cluster key overrides the global one. Defaults to 0 (idle connections are kept until
+  // the upstream closes them).
+  return runtime_.snapshot().getInteger(
+      idle_timeout_runtime_key_,
+      runtime_.snapshot().getInteger("upstream.conn_pool.idle_timeout_ms", 0));
+}
+
+uint64_t ConnPoolImpl::maxIdleConnections() {
+  // The per cluster key overrides the global one. Defaults to 0 (unlimited).
+  return runtime_.snapshot().getInteger(
+      max_idle_runtime_key_, runtime_.snapshot().getInteger("upstream.conn_pool.max_idle", 0));
+}
+
+void ConnPoolImpl::armIdleTimer() {
+  const uint64_t timeout_ms = idleTimeoutMs();
+  if (timeout_ms == 0 || ready_clients_.empty() || idle_timer_armed_) {
+    return;
+  }
+
+  if (!idle_timer_) {
+    idle_timer_ = dispatcher_.createTimer([this]() -> void { onIdleTimeout(); });
+  }
+
+  // Wake up when the longest idle client (the back of the ready list) is due.
+  const std::chrono::milliseconds timeout(timeout_ms);
+  const auto idle = time_source_.currentTime() - ready_clients_.back()->idle_since_;
+  idle_timer_->enableTimer(
+      idle >= timeout ? IdleCloseStaggerInterval
+                      : std::chrono::duration_cast<std::chrono::milliseconds>(timeout - idle));
+  idle_timer_armed_ = true;
+}
+
+void ConnPoolImpl::maybeDisableIdleTimer() {
+  // An empty ready list has nothing to reap, so cancel any pending wakeup rather than letting it
+  // fire as a no-op. processIdleClient() re-arms the timer when a client next goes idle.
+  if (idle_timer_armed_ && ready_clients_.empty()) {
+    idle_timer_->disableTimer();
+    idle_timer_armed_ = false;
+  }
+}
+
+void ConnPoolImpl::onIdleTimeout() {
+  idle_timer_armed_ = false;
+  const uint64_t timeout_ms = idleTimeoutMs();
+  if (timeout_ms == 0) {
+    // The timeout was disabled via runtime after the timer was armed.
+    return;
+  }
+
+  const MonotonicTime now = time_source_.currentTime();
+  const std::chrono::milliseconds timeout(timeout_ms);
+  uint64_t allowed = std::max<uint64_t>(1, ready_clients_.size() / IdleCloseDivisor);
+  while (allowed > 0 && !ready_clients_.empty() &&
+         now - ready_clients_.back()->idle_since_ >= timeout) {
+    ActiveClient& client = *ready_clients_.back();
+    ENVOY_CONN_LOG(debug, "closing idle connection", *client.codec_client_);
+    host_->cluster().stats().upstream_cx_idle_timeout_.inc();
+    // Closing synchronously raises LocalClose which removes the client from the ready list.
+    client.codec_client_->close();
+    allowed--;
+  }
+
+  armIdleTimer();
+}
+
+void ConnPoolImpl::maybePrefetch() {
+  // Never create new connections for a pool that is draining down.
+  if (!drained_callbacks_.empty()) {
+    return;
+  }
+
+  // The per cluster key overrides the global one so individual clusters can be warmed
+  // independently. Defaults to 0 (disabled).
+  const uint64_t prefetch = runtime_.snapshot().getInteger(
+      prefetch_runtime_key_, runtime_.snapshot().getInteger("upstream.conn_pool.prefetch", 0));
+  if (prefetch == 0) {
+    return;
+  }
+
+  // Busy clients that still have a connect timer are connecting. They count towards supply so
+  // that back to back prefetches do not overshoot. Pending requests will consume connecting
+  // clients as they complete their handshakes, so the target is demand plus the warm count.
+  uint64_t connecting = 0;
+  for (const ActiveClientPtr& client : busy_clients_) {
+    if (client->connect_timer_) {
+      connecting++;
+    }
+  }
+
+  while (ready_clients_.size() + connecting < pending_requests_.size() + prefetch &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching connection");
+    createNewConnection();
+    connecting++;
+  }
+}
+
 ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_decoder,
                                                      ConnectionPool::Callbacks& callbacks) {
   if (!ready_clients_.empty()) {
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
+    maybeDisableIdleTimer();
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
     attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    maybePrefetch();
     return nullptr;
   }
 
@@ -87,6 +201,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     ENVOY_LOG(debug, "queueing request due to no available connections");
     PendingRequestPtr pending_request(new PendingRequest(*this, response_decoder, callbacks));
     pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+    maybePrefetch();
     return pending_requests_.front().get();
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
@@ -103,6 +218,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
     ENVOY_CONN_LOG(debug, "client disconnected", *client.codec_client_);
     ActiveClientPtr removed;
     bool check_for_drained = true;
+    bool saw_connect_failure = false;
     if (client.stream_wrapper_) {
       if (!client.stream_wrapper_->decode_complete_) {
         if (event == Network::ConnectionEvent::LocalClose) {
@@ -122,9 +238,11 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       // The connect timer is destroyed on connect. The lack of a connect timer means that this
       // client is idle and in the ready pool.
       removed = client.removeFromList(ready_clients_);
+      maybeDisableIdleTimer();
       check_for_drained = false;
     } else {
       // The only time this happens is if we actually saw a connect failure.
+      saw_connect_failure = true;
       host_->cluster().stats().upstream_cx_connect_fail_.inc();
       host_->stats().cx_connect_fail_.inc();
       removed = client.removeFromList(busy_clients_);
@@ -152,6 +270,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       createNewConnection();
     }
 
+    // Replace prefetched connections that the upstream closed while idle. We don't prefetch after
+    // a connect failure since immediately dialing again would spin against a dead upstream.
+    if (!saw_connect_failure) {
+      maybePrefetch();
+    }
+
     if (check_for_drained) {
       checkForDrained();
     }
@@ -206,7 +330,20 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client) {
   if (pending_requests_.empty()) {
     // There is nothing to service so just move the connection into the ready list.
     ENVOY_CONN_LOG(debug, "moving to ready", *client.codec_client_);
+    client.idle_since_ = time_source_.currentTime();
     client.moveBetweenLists(busy_clients_, ready_clients_);
+
+    // If the pool now holds more idle connections than allowed, shed the longest idle one. This
+    // happens one connection per transition to idle, so no staggering is needed.
+    const uint64_t max_idle = maxIdleConnections();
+    if (max_idle > 0 && ready_clients_.size() > max_idle) {
+      ENVOY_CONN_LOG(debug, "closing connection over max idle limit",
+                     *ready_clients_.back()->codec_client_);
+      host_->cluster().stats().upstream_cx_idle_overflow_.inc();
+      ready_clients_.back()->codec_client_->close();
+    }
+
+    armIdleTimer();
   } else {
     // There is work to do so bind a request to the client and move it to the busy list. Pending
     // requests are pushed onto the front, so pull from the back.
@@ -5,13 +5,16 @@
 #include <memory>
 
 #include "envoy/common/optional.h"
+#include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/event/timer.h"
 #include "envoy/http/conn_pool.h"
 #include "envoy/network/connection.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/upstream/upstream.h"
 
 #include "common/common/linked_object.h"
+#include "common/common/utility.h"
 #include "common/http/codec_client.h"
 #include "common/http/codec_wrappers.h"
 
@@ -28,8 +31,13 @@ namespace Http1 {
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
   ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
-               Upstream::ResourcePriority priority)
-      : dispatcher_(dispatcher), host_(host), priority_(priority) {}
+               Upstream::ResourcePriority priority, Runtime::Loader& runtime,
+               MonotonicTimeSource& time_source)
+      : dispatcher_(dispatcher), host_(host), priority_(priority), runtime_(runtime),
+        time_source_(time_source),
+        prefetch_runtime_key_("upstream.conn_pool.prefetch." + host->cluster().name()),
+        idle_timeout_runtime_key_("upstream.conn_pool.idle_timeout_ms." + host->cluster().name()),
+        max_idle_runtime_key_("upstream.conn_pool.max_idle." + host->cluster().name()) {}
 
   ~ConnPoolImpl();
 
@@ -90,6 +98,10 @@ protected:
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
+    // Set each time the client enters the ready list. Since idle clients are pushed onto the
+    // front of the list and taken from the front, the back of the list is always the longest
+    // idle client.
+    MonotonicTime idle_since_;
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -109,11 +121,17 @@ protected:
 
   typedef std::unique_ptr<PendingRequest> PendingRequestPtr;
 
+  void armIdleTimer();
   void attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                              ConnectionPool::Callbacks& callbacks);
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   void checkForDrained();
   void createNewConnection();
+  uint64_t idleTimeoutMs();
+  uint64_t maxIdleConnections();
+  void maybeDisableIdleTimer();
+  void maybePrefetch();
+  void onIdleTimeout();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onDownstreamReset(ActiveClient& client);
   void onPendingRequestCancel(PendingRequest& request);
@@ -128,6 +146,15 @@ protected:
   std::list<PendingRequestPtr> pending_requests_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
+  Runtime::Loader& runtime_;
+  MonotonicTimeSource& time_source_;
+  // Created lazily the first time a client goes idle with an idle timeout configured.
+  Event::TimerPtr idle_timer_;
+  bool idle_timer_armed_{};
+  // Cached so the hot path does not rebuild the per cluster runtime keys on every lookup.
+  const std::string prefetch_runtime_key_;
+  const std::string idle_timeout_runtime_key_;
+  const std::string max_idle_runtime_key_;
 };
 
 /**
@@ -136,8 +163,8 @@ protected:
 class ConnPoolImplProd : public ConnPoolImpl {
 public:
   ConnPoolImplProd(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
-                   Upstream::ResourcePriority priority)
-      : ConnPoolImpl(dispatcher, host, priority) {}
+                   Upstream::ResourcePriority priority, Runtime::Loader& runtime)
+      : ConnPoolImpl(dispatcher, host, priority, runtime, ProdMonotonicTimeSource::instance_) {}
 
   // ConnPoolImpl
   CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) override;
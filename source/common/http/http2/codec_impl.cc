@@ -38,7 +38,6 @@ bool Utility::reconstituteCrumbledCookies(const HeaderString& key, const HeaderS
 }
 
 ConnectionImpl::Http2Callbacks ConnectionImpl::http2_callbacks_;
-ConnectionImpl::Http2Options ConnectionImpl::http2_options_;
 const std::unique_ptr<const Http::HeaderMap> ConnectionImpl::CONTINUE_HEADER{
     new Http::HeaderMapImpl{
         {Http::Headers::get().Status, std::to_string(enumToInt(Code::Continue))}}};
@@ -56,12 +55,18 @@ ConnectionImpl::StreamImpl::StreamImpl(ConnectionImpl& parent, uint32_t buffer_l
       remote_end_stream_(false), data_deferred_(false),
       waiting_for_non_informational_headers_(false),
       pending_receive_buffer_high_watermark_called_(false),
-      pending_send_buffer_high_watermark_called_(false) {
+      pending_send_buffer_high_watermark_called_(false), window_stalled_(false) {
   if (buffer_limit > 0) {
     setWriteBufferWatermarks(buffer_limit / 2, buffer_limit);
   }
 }
 
+static bool isSensitiveHeader(const HeaderString& key) {
+  return key == Headers::get().Authorization.get().c_str() ||
+         key == Headers::get().ProxyAuthorization.get().c_str() ||
+         key == Headers::get().SetCookie.get().c_str();
+}
+
 static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header) {
   uint8_t flags = 0;
   if (header.key().type() == HeaderString::Type::Reference) {
@@ -70,6 +75,12 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
   if (header.value().type() == HeaderString::Type::Reference) {
     flags |= NGHTTP2_NV_FLAG_NO_COPY_VALUE;
   }
+  if (isSensitiveHeader(header.key())) {
+    // Credentials must not enter the HPACK dynamic table, where their presence can be probed via
+    // compression oracle attacks. Never-index also tells the peer not to index them if the header
+    // is forwarded.
+    flags |= NGHTTP2_NV_FLAG_NO_INDEX;
+  }
   headers.push_back({remove_const<uint8_t>(header.key().c_str()),
                      remove_const<uint8_t>(header.value().c_str()), header.key().size(),
                      header.value().size(), flags});
@@ -99,9 +110,19 @@ void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_hea
       &final_headers);
 }
 
+// The uncompressed size of a header block, for comparison against the HPACK output on the wire.
+static uint64_t uncompressedHeaderBytes(const std::vector<nghttp2_nv>& headers) {
+  uint64_t bytes = 0;
+  for (const nghttp2_nv& header : headers) {
+    bytes += header.namelen + header.valuelen;
+  }
+  return bytes;
+}
+
 void ConnectionImpl::StreamImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
   std::vector<nghttp2_nv> final_headers;
   buildHeaders(final_headers, headers);
+  parent_.stats_.tx_headers_uncompressed_bytes_.add(uncompressedHeaderBytes(final_headers));
 
   nghttp2_data_provider provider;
   if (!end_stream) {
@@ -185,6 +206,7 @@ void ConnectionImpl::StreamImpl::saveHeader(HeaderString&& name, HeaderString&&
 void ConnectionImpl::StreamImpl::submitTrailers(const HeaderMap& trailers) {
   std::vector<nghttp2_nv> final_headers;
   buildHeaders(final_headers, trailers);
+  parent_.stats_.tx_headers_uncompressed_bytes_.add(uncompressedHeaderBytes(final_headers));
   int rc =
       nghttp2_submit_trailer(parent_.session_, stream_id_, &final_headers[0], final_headers.size());
   ASSERT(rc == 0);
@@ -197,6 +219,8 @@ ssize_t ConnectionImpl::StreamImpl::onDataSourceRead(uint64_t length, uint32_t*
     data_deferred_ = true;
     return NGHTTP2_ERR_DEFERRED;
   } else {
+    // nghttp2 only asks for data when flow control admits it, so any previous stall is over.
+    window_stalled_ = false;
     *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
     if (local_end_stream_ && pending_send_data_.length() <= length) {
       *data_flags |= NGHTTP2_DATA_FLAG_EOF;
@@ -218,9 +242,8 @@ int ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t
   // https://nghttp2.org/documentation/types.html#c.nghttp2_send_data_callback
   static const uint64_t FRAME_HEADER_SIZE = 9;
 
-  Buffer::OwnedImpl output(framehd, FRAME_HEADER_SIZE);
-  output.move(pending_send_data_, length);
-  parent_.connection_.write(output);
+  parent_.pending_send_output_.add(framehd, FRAME_HEADER_SIZE);
+  parent_.pending_send_output_.move(pending_send_data_, length);
   return 0;
 }
 
@@ -254,6 +277,19 @@ void ConnectionImpl::StreamImpl::encodeData(Buffer::Instance& data, bool end_str
   }
 
   parent_.sendPendingFrames();
+
+  // Flow control visibility: if data is still queued, nghttp2 did not defer it on our behalf, and
+  // either the stream or connection send window is exhausted, the peer's flow control is the
+  // bottleneck for this stream. Count the start of each stall so operators can tell window
+  // starvation apart from a slow downstream connection.
+  if (!window_stalled_ && pending_send_data_.length() > 0 && !data_deferred_ &&
+      (nghttp2_session_get_stream_remote_window_size(parent_.session_, stream_id_) <= 0 ||
+       nghttp2_session_get_remote_window_size(parent_.session_) <= 0)) {
+    window_stalled_ = true;
+    parent_.stats_.tx_flow_control_stalled_.inc();
+    ENVOY_CONN_LOG(debug, "stream {} stalled on flow control window", parent_.connection_,
+                   stream_id_);
+  }
 }
 
 void ConnectionImpl::StreamImpl::resetStream(StreamResetReason reason) {
@@ -367,6 +403,7 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
 
   switch (frame->hd.type) {
   case NGHTTP2_HEADERS: {
+    stats_.rx_headers_wire_bytes_.add(frame->hd.length);
     stream->remote_end_stream_ = frame->hd.flags & NGHTTP2_FLAG_END_STREAM;
     if (!stream->cookies_.empty()) {
       HeaderString key(Headers::get().Cookie);
@@ -478,6 +515,8 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   }
 
   case NGHTTP2_HEADERS:
+    stats_.tx_headers_wire_bytes_.add(frame->hd.length);
+    FALLTHRU;
   case NGHTTP2_DATA: {
     StreamImpl* stream = getStream(frame->hd.stream_id);
     stream->local_end_stream_sent_ = frame->hd.flags & NGHTTP2_FLAG_END_STREAM;
@@ -503,8 +542,9 @@ int ConnectionImpl::onInvalidFrame(int error_code) {
 
 ssize_t ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   ENVOY_CONN_LOG(trace, "send data: bytes={}", connection_, length);
-  Buffer::OwnedImpl buffer(data, length);
-  connection_.write(buffer);
+  // Frames are appended contiguously into the tail of the pending output and flushed with a
+  // single connection write at the end of the send pass. See sendPendingFrames().
+  pending_send_output_.add(data, length);
   return length;
 }
 
@@ -534,6 +574,7 @@ int ConnectionImpl::onStreamClose(int32_t stream_id, uint32_t error_code) {
 
 int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
                                HeaderString&& value) {
+  stats_.rx_headers_uncompressed_bytes_.add(name.size() + value.size());
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     // We have seen 1 or 2 crashes where we get a headers callback but there is no associated
@@ -567,6 +608,15 @@ void ConnectionImpl::sendPendingFrames() {
     throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
   }
 
+  // Everything nghttp2 emitted during this pass (potentially HEADERS, DATA, WINDOW_UPDATE, etc.
+  // for many streams) is flushed to the connection in one write. The accumulated slices are
+  // moved out so that the pending output is always empty at the start of the next pass.
+  if (pending_send_output_.length() > 0) {
+    Buffer::OwnedImpl output;
+    output.move(pending_send_output_);
+    connection_.write(output);
+  }
+
   // See ConnectionImpl::StreamImpl::resetStream() for why we do this. This is an uncommon event,
   // so iterating through every stream to find the ones that have a deferred reset is not a big
   // deal. Furthermore, queueing a reset frame does not actually invoke the close stream callback.
@@ -728,7 +778,7 @@ ConnectionImpl::Http2Callbacks::Http2Callbacks() {
 
 ConnectionImpl::Http2Callbacks::~Http2Callbacks() { nghttp2_session_callbacks_del(callbacks_); }
 
-ConnectionImpl::Http2Options::Http2Options() {
+ConnectionImpl::Http2Options::Http2Options(const Http2Settings& http2_settings) {
   nghttp2_option_new(&options_);
   // Currently we do not do anything with stream priority. Setting the following option prevents
   // nghttp2 from keeping around closed streams for use during stream priority dependency graph
@@ -736,6 +786,14 @@ ConnectionImpl::Http2Options::Http2Options() {
   // of kept alive HTTP/2 connections.
   nghttp2_option_set_no_closed_streams(options_, 1);
   nghttp2_option_set_no_auto_window_update(options_, 1);
+
+  // The SETTINGS we advertise only sizes the table our peer encodes with. Our own encoder is
+  // additionally bounded by nghttp2's deflater limit (4kB by default), so raise that bound to the
+  // configured size; the table actually used is still negotiated down to whatever the peer
+  // advertises.
+  if (http2_settings.hpack_table_size_ != NGHTTP2_DEFAULT_HEADER_TABLE_SIZE) {
+    nghttp2_option_set_max_deflate_dynamic_table_size(options_, http2_settings.hpack_table_size_);
+  }
 }
 
 ConnectionImpl::Http2Options::~Http2Options() { nghttp2_option_del(options_); }
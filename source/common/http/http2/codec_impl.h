@@ -41,7 +41,12 @@ const std::string CLIENT_MAGIC_PREFIX = "PRI * HTTP/2";
   COUNTER(tx_reset)                                                                                \
   COUNTER(header_overflow)                                                                         \
   COUNTER(trailers)                                                                                \
-  COUNTER(headers_cb_no_stream)
+  COUNTER(headers_cb_no_stream)                                                                    \
+  COUNTER(rx_headers_uncompressed_bytes)                                                           \
+  COUNTER(rx_headers_wire_bytes)                                                                   \
+  COUNTER(tx_headers_uncompressed_bytes)                                                           \
+  COUNTER(tx_headers_wire_bytes)                                                                   \
+  COUNTER(tx_flow_control_stalled)
 // clang-format on
 
 /**
@@ -71,7 +76,8 @@ class ConnectionImpl : public virtual Connection, protected Logger::Loggable<Log
 public:
   ConnectionImpl(Network::Connection& connection, Stats::Scope& stats,
                  const Http2Settings& http2_settings)
-      : stats_{ALL_HTTP2_CODEC_STATS(POOL_COUNTER_PREFIX(stats, "http2."))},
+      : http2_options_(http2_settings),
+        stats_{ALL_HTTP2_CODEC_STATS(POOL_COUNTER_PREFIX(stats, "http2."))},
         connection_(connection),
         per_stream_buffer_limit_(http2_settings.initial_stream_window_size_), dispatching_(false),
         raised_goaway_(false), pending_deferred_reset_(false) {}
@@ -112,11 +118,11 @@ protected:
   };
 
   /**
-   * Wrapper for static nghttp2 session options.
+   * Wrapper for nghttp2 session options, built per connection from the codec settings.
    */
   class Http2Options {
   public:
-    Http2Options();
+    Http2Options(const Http2Settings& http2_settings);
     ~Http2Options();
 
     const nghttp2_option* options() { return options_; }
@@ -201,6 +207,9 @@ protected:
     bool waiting_for_non_informational_headers_ : 1;
     bool pending_receive_buffer_high_watermark_called_ : 1;
     bool pending_send_buffer_high_watermark_called_ : 1;
+    // Set while the stream has pending data that the peer's flow control window will not admit.
+    // Used so that tx_flow_control_stalled counts stall events, not stalled write attempts.
+    bool window_stalled_ : 1;
   };
 
   typedef std::unique_ptr<StreamImpl> StreamImplPtr;
@@ -234,13 +243,17 @@ protected:
   void sendSettings(const Http2Settings& http2_settings, bool disable_push);
 
   static Http2Callbacks http2_callbacks_;
-  static Http2Options http2_options_;
+  Http2Options http2_options_;
 
   std::list<StreamImplPtr> active_streams_;
   nghttp2_session* session_{};
   CodecStats stats_;
   Network::Connection& connection_;
   uint32_t per_stream_buffer_limit_;
+  // Frames emitted by nghttp2 during a single send pass accumulate here and are written to the
+  // connection in one batch at the end of sendPendingFrames(). This avoids a connection write
+  // (and its filter traversal) per frame for HEADERS+DATA sequences.
+  Buffer::OwnedImpl pending_send_output_;
 
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
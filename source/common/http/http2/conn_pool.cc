@@ -6,6 +6,7 @@
 #include "envoy/event/timer.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/macros.h"
 #include "common/http/http2/codec_impl.h"
 #include "common/network/utility.h"
 #include "common/upstream/upstream_impl.h"
@@ -19,12 +20,13 @@ ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSha
     : dispatcher_(dispatcher), host_(host), priority_(priority) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  // close() fires the connection event callback inline which removes the client from its list.
+  while (!active_clients_.empty()) {
+    active_clients_.front()->client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  while (!draining_clients_.empty()) {
+    draining_clients_.front()->client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -41,22 +43,23 @@ void ConnPoolImpl::checkForDrained() {
     return;
   }
 
-  bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
-    } else {
-      drained = false;
+  // Close any active connections that no longer carry streams. close() fires the connection
+  // event callback inline which removes the client from the list, so advance the iterator first.
+  for (auto it = active_clients_.begin(); it != active_clients_.end();) {
+    ActiveClient& client = **it++;
+    if (client.client_->numActiveRequests() == 0) {
+      client.client_->close();
     }
   }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    drained = false;
+  // Draining connections always have streams in flight; they close themselves when the last
+  // stream ends.
+  for (const ActiveClientPtr& client : draining_clients_) {
+    ASSERT(client->client_->numActiveRequests() > 0);
+    UNREFERENCED_PARAMETER(client);
   }
 
-  if (drained) {
+  if (active_clients_.empty() && draining_clients_.empty()) {
     ENVOY_LOG(debug, "invoking drained callbacks");
     for (const DrainedCb& cb : drained_callbacks_) {
       cb();
@@ -74,12 +77,35 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     max_streams = maxTotalStreams();
   }
 
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
+  for (auto it = active_clients_.begin(); it != active_clients_.end();) {
+    // moveClientToDraining() removes the client from the active list, so advance first.
+    ActiveClient& active_client = **it++;
+    if (active_client.total_streams_ >= max_streams) {
+      moveClientToDraining(active_client);
+    }
+  }
+
+  // Pick the connection with the fewest in-flight streams that is below the concurrency cap.
+  // Biasing new streams toward the least loaded connection spreads load across connections and
+  // refills connections that have drained down.
+  const uint32_t max_concurrent_streams = maxConcurrentStreams();
+  ActiveClient* client = nullptr;
+  for (const ActiveClientPtr& active_client : active_clients_) {
+    const uint64_t active_requests = active_client->client_->numActiveRequests();
+    if (active_requests >= max_concurrent_streams) {
+      continue;
+    }
+    if (client == nullptr || active_requests < client->client_->numActiveRequests()) {
+      client = active_client.get();
+    }
   }
 
-  if (!primary_client_) {
-    primary_client_.reset(new ActiveClient(*this));
+  if (client == nullptr) {
+    // Either no connections exist or every connection is at its concurrency limit, so establish
+    // an additional one.
+    ActiveClientPtr new_client{new ActiveClient(*this)};
+    client = new_client.get();
+    new_client->moveIntoList(std::move(new_client), active_clients_);
   }
 
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
@@ -87,15 +113,15 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ENVOY_CONN_LOG(debug, "creating stream", *client->client_);
+    client->total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    callbacks.onPoolReady(client->client_->newStream(response_decoder),
+                          client->real_host_description_);
   }
 
   return nullptr;
@@ -114,12 +140,13 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       }
     }
 
-    if (&client == primary_client_.get()) {
-      ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
-    } else {
-      ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+    // A client can see a second close event (e.g. a local close racing a remote close) after it
+    // has already been unlinked for deferred deletion; in that case there is nothing to do.
+    if (client.inserted()) {
+      ENVOY_CONN_LOG(debug, "destroying {} client", *client.client_,
+                     client.draining_ ? "draining" : "active");
+      dispatcher_.deferredDelete(
+          client.removeFromList(client.draining_ ? draining_clients_ : active_clients_));
     }
 
     if (client.connect_timer_) {
@@ -142,25 +169,18 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
-  }
-
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
-    // If we are making a new connection and the primary does not have any active requests just
-    // close it now.
-    primary_client_->client_->close();
-  } else {
-    draining_client_ = std::move(primary_client_);
+void ConnPoolImpl::moveClientToDraining(ActiveClient& client) {
+  ENVOY_CONN_LOG(debug, "moving client to draining", *client.client_);
+  ASSERT(!client.draining_);
+  if (client.client_->numActiveRequests() == 0) {
+    // If the connection does not have any active requests there is nothing to drain; just close
+    // it now.
+    client.client_->close();
+    return;
   }
 
-  ASSERT(!primary_client_);
+  client.draining_ = true;
+  client.moveBetweenLists(active_clients_, draining_clients_);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -172,8 +192,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    moveClientToDraining(client);
   }
 }
 
@@ -183,7 +203,7 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (client.draining_ && client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
   }
@@ -250,6 +270,13 @@ CodecClientPtr ProdConnPoolImpl::createCodecClient(Upstream::Host::CreateConnect
 
 uint32_t ProdConnPoolImpl::maxTotalStreams() { return MAX_STREAMS; }
 
+uint32_t ProdConnPoolImpl::maxConcurrentStreams() {
+  // The cluster's advertised max_concurrent_streams doubles as the cap on locally initiated
+  // streams per upstream connection. The default (2^31 - 1) preserves the historical behavior of
+  // funneling everything onto a single connection.
+  return host_->cluster().http2Settings().max_concurrent_streams_;
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
@@ -9,6 +9,7 @@
 #include "envoy/network/connection.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/linked_object.h"
 #include "common/http/codec_client.h"
 
 namespace Envoy {
@@ -17,8 +18,11 @@ namespace Http2 {
 
 /**
  * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
- * shifting to a new connection if we reach max streams on the primary. This is a base class
- * used for both the prod implementation as well as the testing one.
+ * spreading streams across multiple connections. New streams go to the active connection with
+ * the fewest in-flight streams that is below the per-connection concurrency cap; when every
+ * connection is at the cap an additional connection is established. Connections that reach max
+ * total streams (or receive a goaway) are drained and replaced. This is a base class used for
+ * both the prod implementation as well as the testing one.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
@@ -32,7 +36,8 @@ public:
                                          ConnectionPool::Callbacks& callbacks) override;
 
 protected:
-  struct ActiveClient : public Network::ConnectionCallbacks,
+  struct ActiveClient : LinkedObject<ActiveClient>,
+                        public Network::ConnectionCallbacks,
                         public CodecClientCallbacks,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
@@ -64,6 +69,7 @@ protected:
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     bool closed_with_active_rq_{};
+    bool draining_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -71,7 +77,8 @@ protected:
   void checkForDrained();
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+  virtual uint32_t maxConcurrentStreams() PURE;
+  void moveClientToDraining(ActiveClient& client);
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
@@ -81,8 +88,13 @@ protected:
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  // Connections accepting new streams. The number of connections is implicitly bounded: a new
+  // one is only established when every active connection has maxConcurrentStreams() streams in
+  // flight, and total streams are capped by the request circuit breaker.
+  std::list<ActiveClientPtr> active_clients_;
+  // Connections which no longer accept new streams (max total streams reached or goaway
+  // received) but still carry in-flight streams. They are closed when their last stream ends.
+  std::list<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
 };
@@ -97,6 +109,7 @@ public:
 private:
   CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) override;
   uint32_t maxTotalStreams() override;
+  uint32_t maxConcurrentStreams() override;
 
   // All streams are 2^31. Client streams are half that, minus stream 0. Just to be on the safe
   // side we do 2^29.
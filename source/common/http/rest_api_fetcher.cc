@@ -5,6 +5,8 @@
 #include <string>
 
 #include "common/common/enum_to_int.h"
+#include "common/common/hash.h"
+#include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/http/utility.h"
 
@@ -28,13 +30,34 @@ void RestApiFetcher::initialize() { refresh(); }
 
 void RestApiFetcher::onSuccess(Http::MessagePtr&& response) {
   uint64_t response_code = Http::Utility::getResponseStatus(response->headers());
+  if (response_code == enumToInt(Http::Code::NotModified)) {
+    // The server confirmed via If-None-Match that the document is unchanged, so there is nothing
+    // to parse.
+    requestComplete();
+    return;
+  }
+
   if (response_code != enumToInt(Http::Code::OK)) {
     onFailure(Http::AsyncClient::FailureReason::Reset);
     return;
   }
 
+  // Servers without conditional request support re-send the full document every cycle. Skip the
+  // parse when the body is byte for byte identical to the last successfully parsed response.
+  const uint64_t body_hash = HashUtil::xxHash64(response->bodyAsString());
+  if (last_body_hash_.valid() && last_body_hash_.value() == body_hash) {
+    requestComplete();
+    return;
+  }
+
   try {
     parseResponse(*response);
+
+    // The ETag and body hash are only remembered for responses that parsed successfully so that
+    // a rejected config is fetched and parsed again on the next cycle.
+    const HeaderEntry* etag = response->headers().get(Headers::get().Etag);
+    last_etag_ = etag != nullptr ? etag->value().c_str() : "";
+    last_body_hash_.value(body_hash);
   } catch (EnvoyException& e) {
     onFetchFailure(&e);
   }
@@ -51,6 +74,9 @@ void RestApiFetcher::refresh() {
   MessagePtr message(new RequestMessageImpl());
   createRequest(*message);
   message->headers().insertHost().value(remote_cluster_name_);
+  if (!last_etag_.empty()) {
+    message->headers().addCopy(Headers::get().IfNoneMatch, last_etag_);
+  }
   active_request_ = cm_.httpAsyncClientForCluster(remote_cluster_name_)
                         .send(std::move(message), *this,
                               Optional<std::chrono::milliseconds>(std::chrono::milliseconds(1000)));
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <string>
 
+#include "envoy/common/optional.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/cluster_manager.h"
@@ -65,6 +67,12 @@ private:
   const std::chrono::milliseconds refresh_interval_;
   Event::TimerPtr refresh_timer_;
   Http::AsyncClient::Request* active_request_{};
+  // ETag of the last successfully parsed response, sent as If-None-Match on the next fetch so a
+  // server that supports conditional requests can answer with a bodyless 304.
+  std::string last_etag_;
+  // Hash of the last successfully parsed body. Even without server side ETag support this lets us
+  // skip re-parsing a byte for byte identical document.
+  Optional<uint64_t> last_body_hash_;
 };
 
 } // namespace Http
@@ -171,6 +171,25 @@ Http1Settings Utility::parseHttp1Settings(const envoy::api::v2::Http1ProtocolOpt
   return ret;
 }
 
+const std::string& Utility::numericStatusString(Code response_code) {
+  // One table entry per code in [100, 600), built once. Local replies (404s, ratelimit 429s,
+  // overload 503s) are served at peak rate during incidents, so they should not format a string
+  // per response.
+  static const uint64_t MIN_CODE = 100;
+  static const uint64_t NUM_CODES = 500;
+  static const std::vector<std::string>* const strings = [] {
+    std::vector<std::string>* strings = new std::vector<std::string>();
+    for (uint64_t i = MIN_CODE; i < MIN_CODE + NUM_CODES; i++) {
+      strings->push_back(std::to_string(i));
+    }
+    return strings;
+  }();
+
+  const uint64_t value = enumToInt(response_code);
+  ASSERT(value >= MIN_CODE && value < MIN_CODE + NUM_CODES);
+  return (*strings)[value - MIN_CODE];
+}
+
 void Utility::sendLocalReply(StreamDecoderFilterCallbacks& callbacks, const bool& is_reset,
                              Code response_code, const std::string& body_text) {
   sendLocalReply(
@@ -188,7 +207,7 @@ void Utility::sendLocalReply(
     std::function<void(Buffer::Instance& data, bool end_stream)> encode_data, const bool& is_reset,
     Code response_code, const std::string& body_text) {
   HeaderMapPtr response_headers{
-      new HeaderMapImpl{{Headers::get().Status, std::to_string(enumToInt(response_code))}}};
+      new HeaderMapImpl{{Headers::get().Status, numericStatusString(response_code)}}};
   if (!body_text.empty()) {
     response_headers->insertContentLength().value(body_text.size());
     response_headers->insertContentType().value(Headers::get().ContentTypeValues.Text);
@@ -203,7 +222,7 @@ void Utility::sendLocalReply(
 
 void Utility::sendRedirect(StreamDecoderFilterCallbacks& callbacks, const std::string& new_path) {
   HeaderMapPtr response_headers{
-      new HeaderMapImpl{{Headers::get().Status, std::to_string(enumToInt(Code::MovedPermanently))},
+      new HeaderMapImpl{{Headers::get().Status, numericStatusString(Code::MovedPermanently)},
                         {Headers::get().Location, new_path}}};
 
   callbacks.encodeHeaders(std::move(response_headers), true);
@@ -5,6 +5,7 @@
 
 #include "envoy/http/codes.h"
 #include "envoy/http/filter.h"
+#include "envoy/http/query_params.h"
 
 #include "common/json/json_loader.h"
 
@@ -18,7 +19,7 @@ namespace Http {
  */
 class Utility {
 public:
-  typedef std::map<std::string, std::string> QueryParams;
+  typedef Http::QueryParams QueryParams;
 
   /**
    * Append to x-forwarded-for header.
@@ -93,6 +94,15 @@ public:
    */
   static Http1Settings parseHttp1Settings(const envoy::api::v2::Http1ProtocolOptions& config);
 
+  /**
+   * Convert an HTTP response code to its numeric string form (e.g. "404"). The returned string
+   * is a static, so locally generated responses can build their :status header without
+   * formatting a string per response.
+   * @param response_code supplies the code to convert. Must be in [100, 600).
+   * @return const std::string& the numeric string.
+   */
+  static const std::string& numericStatusString(Code response_code);
+
   /**
    * Create a locally generated response using filter callbacks.
    * @param callbacks supplies the filter callbacks to use.
@@ -78,6 +78,11 @@ void WsHandlerImpl::onConnectionSuccess() {
   Http1::ClientConnectionImpl upstream_http(*upstream_connection_, http_conn_callbacks_);
   Http1::RequestStreamEncoderImpl upstream_request = Http1::RequestStreamEncoderImpl(upstream_http);
   upstream_request.encodeHeaders(request_headers_, false);
+
+  // From here on the connection is a raw relay between the two sockets. Let the connection
+  // manager release the HTTP stream and codec that initiated the upgrade. This may destroy
+  // request_headers_, route_entry_ and ws_callbacks_, so they must not be used again.
+  ws_callbacks_.onHandshakeComplete();
 }
 
 } // namespace WebSocket
@@ -460,6 +460,7 @@ const std::string Json::Schema::TCP_PROXY_NETWORK_FILTER_SCHEMA(R"EOF(
       "type" : "object",
       "properties": {
         "stat_prefix": {"type" : "string"},
+        "splice": {"type" : "boolean"},
         "route_config": {
           "type": "object",
           "properties": {
@@ -899,7 +900,8 @@ const std::string Json::Schema::BUFFER_HTTP_FILTER_SCHEMA(R"EOF(
     "type" : "object",
     "properties" : {
       "max_request_bytes" : {"type" : "integer"},
-      "max_request_time_s" : {"type" : "integer"}
+      "max_request_time_s" : {"type" : "integer"},
+      "watermark_backpressure" : {"type" : "boolean"}
     },
     "required" : ["max_request_bytes", "max_request_time_s"],
     "additionalProperties" : false
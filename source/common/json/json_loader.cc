@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <fstream>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stack>
 #include <string>
@@ -60,6 +62,12 @@ public:
     checkType(Type::Array);
     value_.array_value_.push_back(field_ptr);
   }
+  FieldSharedPtr detachLast() {
+    checkType(Type::Array);
+    FieldSharedPtr last = value_.array_value_.back();
+    value_.array_value_.pop_back();
+    return last;
+  }
   void insert(const std::string& key, FieldSharedPtr field_ptr) {
     checkType(Type::Object);
     value_.object_value_[key] = field_ptr;
@@ -168,9 +176,10 @@ private:
     return value_.integer_value_;
   }
 
-  rapidjson::Document asRapidJsonDocument() const;
-  static void buildRapidJsonDocument(const Field& field, rapidjson::Value& value,
-                                     rapidjson::Document::AllocatorType& allocator);
+  // Walks the field tree and replays it as SAX events into a rapidjson handler (e.g. a Writer or
+  // a SchemaValidator). This avoids materializing a second, rapidjson copy of the document just to
+  // serialize, hash or validate it. Returns false if the handler aborted the traversal.
+  template <class Handler> bool dispatchToHandler(Handler& handler) const;
 
   uint64_t line_number_start_;
   uint64_t line_number_end_;
@@ -204,6 +213,11 @@ private:
 class ObjectHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ObjectHandler> {
 public:
   ObjectHandler(LineCountingStringStream& stream) : state_(expectRoot), stream_(stream){};
+  // Streaming variant: elements of the root object's streaming_key array are handed to callback
+  // as they complete and are not retained in the built document.
+  ObjectHandler(LineCountingStringStream& stream, const std::string& streaming_key,
+                const std::function<void(ObjectSharedPtr)>& callback)
+      : state_(expectRoot), stream_(stream), streaming_key_(streaming_key), callback_(&callback){};
 
   bool StartObject();
   bool EndObject(rapidjson::SizeType);
@@ -224,6 +238,7 @@ public:
 
 private:
   bool handleValueEvent(FieldSharedPtr ptr);
+  void deliverStreamedElement();
 
   enum State {
     expectRoot,
@@ -239,91 +254,62 @@ private:
   std::string key_;
 
   FieldSharedPtr root_;
-};
 
-void Field::buildRapidJsonDocument(const Field& field, rapidjson::Value& value,
-                                   rapidjson::Document::AllocatorType& allocator) {
+  // Streaming mode state. expect_streaming_array_ is set when the root object's streaming key
+  // has just been seen; the array that follows (if any) becomes the streaming array for the
+  // remainder of the parse.
+  const std::string streaming_key_;
+  const std::function<void(ObjectSharedPtr)>* callback_{};
+  bool expect_streaming_array_{};
+  Field* streaming_array_{};
+};
 
-  switch (field.type_) {
+template <class Handler> bool Field::dispatchToHandler(Handler& handler) const {
+  switch (type_) {
   case Type::Array: {
-    value.SetArray();
-    value.Reserve(field.value_.array_value_.size(), allocator);
-    for (const auto& element : field.value_.array_value_) {
-      switch (element->type_) {
-      case Type::Array:
-      case Type::Object: {
-        rapidjson::Value nested_value;
-        buildRapidJsonDocument(*element, nested_value, allocator);
-        value.PushBack(nested_value, allocator);
-        break;
-      }
-      case Type::Boolean:
-        value.PushBack(element->value_.boolean_value_, allocator);
-        break;
-      case Type::Double:
-        value.PushBack(element->value_.double_value_, allocator);
-        break;
-      case Type::Integer:
-        value.PushBack(element->value_.integer_value_, allocator);
-        break;
-      case Type::Null:
-        value.PushBack(rapidjson::Value(), allocator);
-        break;
-      case Type::String:
-        value.PushBack(rapidjson::StringRef(element->value_.string_value_.c_str()), allocator);
+    if (!handler.StartArray()) {
+      return false;
+    }
+    for (const FieldSharedPtr& element : value_.array_value_) {
+      if (!element->dispatchToHandler(handler)) {
+        return false;
       }
     }
-    break;
+    return handler.EndArray(static_cast<rapidjson::SizeType>(value_.array_value_.size()));
   }
   case Type::Object: {
-    value.SetObject();
-    for (const auto& item : field.value_.object_value_) {
-      auto name = rapidjson::StringRef(item.first.c_str());
-
-      switch (item.second->type_) {
-      case Type::Array:
-      case Type::Object: {
-        rapidjson::Value nested_value;
-        buildRapidJsonDocument(*item.second, nested_value, allocator);
-        value.AddMember(name, nested_value, allocator);
-        break;
-      }
-      case Type::Boolean:
-        value.AddMember(name, item.second->value_.boolean_value_, allocator);
-        break;
-      case Type::Double:
-        value.AddMember(name, item.second->value_.double_value_, allocator);
-        break;
-      case Type::Integer:
-        value.AddMember(name, item.second->value_.integer_value_, allocator);
-        break;
-      case Type::Null:
-        value.AddMember(name, rapidjson::Value(), allocator);
-        break;
-      case Type::String:
-        value.AddMember(name, rapidjson::StringRef(item.second->value_.string_value_.c_str()),
-                        allocator);
-        break;
+    if (!handler.StartObject()) {
+      return false;
+    }
+    for (const auto& item : value_.object_value_) {
+      if (!handler.Key(item.first.c_str(), static_cast<rapidjson::SizeType>(item.first.size()),
+                       false) ||
+          !item.second->dispatchToHandler(handler)) {
+        return false;
       }
     }
-    break;
+    return handler.EndObject(static_cast<rapidjson::SizeType>(value_.object_value_.size()));
   }
-  default:
-    NOT_REACHED;
+  case Type::Boolean:
+    return handler.Bool(value_.boolean_value_);
+  case Type::Double:
+    return handler.Double(value_.double_value_);
+  case Type::Integer:
+    return handler.Int64(value_.integer_value_);
+  case Type::Null:
+    return handler.Null();
+  case Type::String:
+    return handler.String(value_.string_value_.c_str(),
+                          static_cast<rapidjson::SizeType>(value_.string_value_.size()), false);
   }
-}
 
-rapidjson::Document Field::asRapidJsonDocument() const {
-  rapidjson::Document document;
-  rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
-  buildRapidJsonDocument(*this, document, allocator);
-  return document;
+  NOT_REACHED;
 }
 
 uint64_t Field::hash() const {
   rapidjson::StringBuffer buffer;
   rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-  asRapidJsonDocument().Accept(writer);
+  dispatchToHandler(writer);
   return HashUtil::xxHash64(buffer.GetString());
 }
 
@@ -474,8 +460,7 @@ std::vector<ObjectSharedPtr> Field::asObjectArray() const {
 std::string Field::asJsonString() const {
   rapidjson::StringBuffer buffer;
   rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-  rapidjson::Document document = asRapidJsonDocument();
-  document.Accept(writer);
+  dispatchToHandler(writer);
   return buffer.GetString();
 }
 
@@ -507,17 +492,41 @@ void Field::iterate(const ObjectCallback& callback) const {
 }
 
 void Field::validateSchema(const std::string& schema) const {
-  rapidjson::Document schema_document;
-  if (schema_document.Parse<0>(schema.c_str()).HasParseError()) {
-    throw std::invalid_argument(fmt::format(
-        "Schema supplied to validateSchema is not valid JSON\n Error(offset {}) : {}\n",
-        schema_document.GetErrorOffset(), GetParseError_En(schema_document.GetParseError())));
+  // Schemas are almost always one of the static strings in config_schemas.cc and each one is
+  // validated against many times during config load (once per cluster, route, filter, etc.).
+  // Parse and compile every unique schema once and reuse the compiled form; a
+  // rapidjson::SchemaDocument is immutable after construction so it can be shared by any number
+  // of validators.
+  static std::mutex schema_cache_lock;
+  static std::unordered_map<std::string, std::unique_ptr<const rapidjson::SchemaDocument>>*
+      schema_cache =
+          new std::unordered_map<std::string, std::unique_ptr<const rapidjson::SchemaDocument>>();
+
+  const rapidjson::SchemaDocument* compiled_schema;
+  {
+    std::unique_lock<std::mutex> lock(schema_cache_lock);
+    auto it = schema_cache->find(schema);
+    if (it == schema_cache->end()) {
+      rapidjson::Document schema_document;
+      if (schema_document.Parse<0>(schema.c_str()).HasParseError()) {
+        throw std::invalid_argument(fmt::format(
+            "Schema supplied to validateSchema is not valid JSON\n Error(offset {}) : {}\n",
+            schema_document.GetErrorOffset(), GetParseError_En(schema_document.GetParseError())));
+      }
+      it = schema_cache
+               ->emplace(schema, std::unique_ptr<const rapidjson::SchemaDocument>(
+                                     new rapidjson::SchemaDocument(schema_document)))
+               .first;
+    }
+    compiled_schema = it->second.get();
   }
 
-  rapidjson::SchemaDocument schema_document_for_validator(schema_document);
-  rapidjson::SchemaValidator schema_validator(schema_document_for_validator);
+  rapidjson::SchemaValidator schema_validator(*compiled_schema);
 
-  if (!asRapidJsonDocument().Accept(schema_validator)) {
+  // The validator consumes the same SAX events a parser would emit, so the field tree can be fed
+  // to it directly; nested configs are validated at several levels during load, and this keeps
+  // each validation from rebuilding a rapidjson copy of the (sub)document.
+  if (!dispatchToHandler(schema_validator)) {
     rapidjson::StringBuffer schema_string_buffer;
     rapidjson::StringBuffer document_string_buffer;
 
@@ -534,6 +543,7 @@ void Field::validateSchema(const std::string& schema) const {
 }
 
 bool ObjectHandler::StartObject() {
+  expect_streaming_array_ = false;
   FieldSharedPtr object = Field::createObject();
   object->setLineNumberStart(stream_.getLineNumber());
 
@@ -570,6 +580,7 @@ bool ObjectHandler::EndObject(rapidjson::SizeType) {
       state_ = expectKeyOrEndObject;
     } else if (stack_.top()->isArray()) {
       state_ = expectArrayValueOrEndArray;
+      deliverStreamedElement();
     }
     return true;
   default:
@@ -582,6 +593,10 @@ bool ObjectHandler::Key(const char* value, rapidjson::SizeType size, bool) {
   case expectKeyOrEndObject:
     key_ = std::string(value, size);
     state_ = expectValueOrStartObjectArray;
+    // Only a key of the root object can open the streaming array.
+    expect_streaming_array_ =
+        callback_ != nullptr && streaming_array_ == nullptr && stack_.size() == 1 &&
+        stack_.top() == root_ && key_ == streaming_key_;
     return true;
   default:
     NOT_REACHED;
@@ -591,6 +606,10 @@ bool ObjectHandler::Key(const char* value, rapidjson::SizeType size, bool) {
 bool ObjectHandler::StartArray() {
   FieldSharedPtr array = Field::createArray();
   array->setLineNumberStart(stream_.getLineNumber());
+  if (expect_streaming_array_) {
+    expect_streaming_array_ = false;
+    streaming_array_ = array.get();
+  }
 
   switch (state_) {
   case expectValueOrStartObjectArray:
@@ -614,19 +633,26 @@ bool ObjectHandler::StartArray() {
 
 bool ObjectHandler::EndArray(rapidjson::SizeType) {
   switch (state_) {
-  case expectArrayValueOrEndArray:
-    stack_.top()->setLineNumberEnd(stream_.getLineNumber());
+  case expectArrayValueOrEndArray: {
+    FieldSharedPtr finished = stack_.top();
+    finished->setLineNumberEnd(stream_.getLineNumber());
     stack_.pop();
 
+    if (finished.get() == streaming_array_) {
+      streaming_array_ = nullptr;
+    }
+
     if (stack_.empty()) {
       state_ = expectFinished;
     } else if (stack_.top()->isObject()) {
       state_ = expectKeyOrEndObject;
     } else if (stack_.top()->isArray()) {
       state_ = expectArrayValueOrEndArray;
+      deliverStreamedElement();
     }
 
     return true;
+  }
   default:
     NOT_REACHED;
   }
@@ -662,6 +688,7 @@ bool ObjectHandler::RawNumber(const char*, rapidjson::SizeType, bool) {
 }
 
 bool ObjectHandler::handleValueEvent(FieldSharedPtr ptr) {
+  expect_streaming_array_ = false;
   ptr->setLineNumberStart(stream_.getLineNumber());
 
   switch (state_) {
@@ -671,12 +698,22 @@ bool ObjectHandler::handleValueEvent(FieldSharedPtr ptr) {
     return true;
   case expectArrayValueOrEndArray:
     stack_.top()->append(ptr);
+    deliverStreamedElement();
     return true;
   default:
     return false;
   }
 }
 
+void ObjectHandler::deliverStreamedElement() {
+  // Called after an element has been appended to the array now on top of the stack. If that
+  // array is the streaming array, hand the element to the callback and drop it from the
+  // document so the parse never holds more than one element at a time.
+  if (streaming_array_ != nullptr && stack_.top().get() == streaming_array_) {
+    (*callback_)(stack_.top()->detachLast());
+  }
+}
+
 } // namespace
 
 ObjectSharedPtr Factory::loadFromFile(const std::string& file_path) {
@@ -763,6 +800,24 @@ ObjectSharedPtr Factory::loadFromString(const std::string& json) {
   return handler.getRoot();
 }
 
+ObjectSharedPtr
+Factory::loadFromStringStreaming(const std::string& json, const std::string& streaming_key,
+                                 const std::function<void(ObjectSharedPtr)>& callback) {
+  LineCountingStringStream json_stream(json.c_str());
+
+  ObjectHandler handler(json_stream, streaming_key, callback);
+  rapidjson::Reader reader;
+  reader.Parse(json_stream, handler);
+
+  if (reader.HasParseError()) {
+    throw Exception(fmt::format("JSON supplied is not valid. Error(offset {}, line {}): {}\n",
+                                reader.GetErrorOffset(), json_stream.getLineNumber(),
+                                GetParseError_En(reader.GetParseErrorCode())));
+  }
+
+  return handler.getRoot();
+}
+
 const std::string Factory::listAsJsonString(const std::list<std::string>& items) {
   rapidjson::StringBuffer writer_string_buffer;
   rapidjson::Writer<rapidjson::StringBuffer> writer(writer_string_buffer);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <list>
 #include <string>
 
@@ -20,6 +21,19 @@ public:
    */
   static ObjectSharedPtr loadFromString(const std::string& json);
 
+  /**
+   * Constructs a Json Object from a string, streaming the elements of one top-level array
+   * instead of retaining them in the returned document. If the document root is an object and
+   * the member named streaming_key is an array, each element of that array is passed to callback
+   * as soon as it has been fully parsed and is released afterwards. This bounds peak memory by
+   * the largest single element rather than the whole document, which matters for large
+   * management server responses. The returned root contains all other members unchanged; the
+   * streamed array member is present but left empty.
+   */
+  static ObjectSharedPtr
+  loadFromStringStreaming(const std::string& json, const std::string& streaming_key,
+                          const std::function<void(ObjectSharedPtr)>& callback);
+
   /**
    * Constructs a Json Object from a YAML string.
    */
@@ -21,6 +21,20 @@ uint64_t Stats::totalCurrentlyReserved() {
   return value;
 }
 
+uint64_t Stats::totalPageHeapFree() {
+  size_t value = 0;
+  MallocExtension::instance()->GetNumericProperty("tcmalloc.pageheap_free_bytes", &value);
+  return value;
+}
+
+uint64_t Stats::totalPageHeapUnmapped() {
+  size_t value = 0;
+  MallocExtension::instance()->GetNumericProperty("tcmalloc.pageheap_unmapped_bytes", &value);
+  return value;
+}
+
+void Stats::releaseFreeMemory() { MallocExtension::instance()->ReleaseFreeMemory(); }
+
 } // namespace Memory
 } // namespace Envoy
 
@@ -31,6 +45,9 @@ namespace Memory {
 
 uint64_t Stats::totalCurrentlyAllocated() { return 0; }
 uint64_t Stats::totalCurrentlyReserved() { return 0; }
+uint64_t Stats::totalPageHeapFree() { return 0; }
+uint64_t Stats::totalPageHeapUnmapped() { return 0; }
+void Stats::releaseFreeMemory() {}
 
 } // namespace Memory
 } // namespace Envoy
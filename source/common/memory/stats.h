@@ -20,6 +20,24 @@ public:
    *                  allocated.
    */
   static uint64_t totalCurrentlyReserved();
+
+  /**
+   * @return uint64_t the number of bytes in free, mapped pages in the page heap. These bytes
+   *                  count towards RSS but can be released back to the OS.
+   */
+  static uint64_t totalPageHeapFree();
+
+  /**
+   * @return uint64_t the number of bytes in free, unmapped pages in the page heap. These bytes
+   *                  have already been released back to the OS.
+   */
+  static uint64_t totalPageHeapUnmapped();
+
+  /**
+   * Release free pages in the page heap back to the OS. This can be slow on large heaps and
+   * should not be called from a latency sensitive thread.
+   */
+  static void releaseFreeMemory();
 };
 
 } // namespace Memory
@@ -4,6 +4,7 @@
 #include <sstream>
 #include <string>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/byte_order.h"
 #include "common/common/hex.h"
@@ -358,17 +359,41 @@ std::string FieldImpl::toString() const {
 void DocumentImpl::fromBuffer(Buffer::Instance& data) {
   uint64_t original_buffer_length = data.length();
   int32_t message_length = BufferHelper::removeInt32(data);
-  if (static_cast<uint64_t>(message_length) > original_buffer_length) {
+  if (message_length < 5 || static_cast<uint64_t>(message_length) > original_buffer_length) {
     throw EnvoyException("invalid BSON message length");
   }
 
   ENVOY_LOG(trace, "BSON document length: {} data length: {}", message_length,
             original_buffer_length);
 
+  // Element parsing is deferred until a caller actually needs the fields (see materialize()).
+  // Only the document's bytes are pulled out of the buffer here; the trailing NUL is the only
+  // structure that can be validated without walking the elements.
+  const uint64_t payload_length = message_length - sizeof(int32_t);
+  raw_.resize(payload_length);
+  BufferHelper::removeBytes(data, reinterpret_cast<uint8_t*>(&raw_[0]), payload_length);
+  if (raw_[payload_length - 1] != 0) {
+    throw EnvoyException("invalid document");
+  }
+}
+
+void DocumentImpl::materialize() const {
+  if (raw_.empty()) {
+    return;
+  }
+
+  // The fields are a parsed view of the raw bytes, so filling them in does not change the
+  // document's logical state.
+  DocumentImpl& mutable_this = const_cast<DocumentImpl&>(*this);
+  Buffer::OwnedImpl data(raw_.data(), raw_.size());
+  mutable_this.raw_.clear();
+  mutable_this.parseElements(data);
+}
+
+void DocumentImpl::parseElements(Buffer::Instance& data) {
   while (true) {
-    uint64_t document_bytes_remaining = data.length() - (original_buffer_length - message_length);
-    ENVOY_LOG(trace, "BSON document bytes remaining: {}", document_bytes_remaining);
-    if (document_bytes_remaining == 1) {
+    ENVOY_LOG(trace, "BSON document bytes remaining: {}", data.length());
+    if (data.length() == 1) {
       uint8_t last_byte = BufferHelper::removeByte(data);
       if (last_byte != 0) {
         throw EnvoyException("invalid document");
@@ -479,6 +504,10 @@ void DocumentImpl::fromBuffer(Buffer::Instance& data) {
 }
 
 int32_t DocumentImpl::byteSize() const {
+  if (!raw_.empty()) {
+    return static_cast<int32_t>(sizeof(int32_t) + raw_.size());
+  }
+
   // Minimum size is 5.
   int32_t total_size = sizeof(int32_t) + 1;
   for (const FieldPtr& field : fields_) {
@@ -489,6 +518,13 @@ int32_t DocumentImpl::byteSize() const {
 }
 
 void DocumentImpl::encode(Buffer::Instance& output) const {
+  if (!raw_.empty()) {
+    // Re-emit the original bytes untouched.
+    BufferHelper::writeInt32(output, byteSize());
+    output.add(raw_.data(), raw_.size());
+    return;
+  }
+
   BufferHelper::writeInt32(output, byteSize());
   for (const FieldPtr& field : fields_) {
     field->encode(output);
@@ -515,6 +551,8 @@ bool DocumentImpl::operator==(const Document& rhs) const {
 }
 
 std::string DocumentImpl::toString() const {
+  materialize();
+
   std::stringstream out;
   out << "{";
 
@@ -533,6 +571,7 @@ std::string DocumentImpl::toString() const {
 }
 
 const Field* DocumentImpl::find(const std::string& name) const {
+  materialize();
   for (const FieldPtr& field : fields_) {
     if (field->key() == name) {
       return field.get();
@@ -543,6 +582,7 @@ const Field* DocumentImpl::find(const std::string& name) const {
 }
 
 const Field* DocumentImpl::find(const std::string& name, Field::Type type) const {
+  materialize();
   for (const FieldPtr& field : fields_) {
     if (field->key() == name && field->type() == type) {
       return field.get();
@@ -251,14 +251,28 @@ public:
   const Field* find(const std::string& name) const override;
   const Field* find(const std::string& name, Field::Type type) const override;
   std::string toString() const override;
-  const std::list<FieldPtr>& values() const override { return fields_; }
+  const std::list<FieldPtr>& values() const override {
+    materialize();
+    return fields_;
+  }
 
 private:
   DocumentImpl() {}
 
   void fromBuffer(Buffer::Instance& data);
 
+  /**
+   * Parse raw document bytes into fields if this document was decoded from a buffer and has not
+   * been accessed yet. Decoding defers element parsing (see fromBuffer()) since most documents
+   * are only scanned for a handful of keys or never looked at; nested documents stay unparsed
+   * until they are accessed themselves.
+   */
+  void materialize() const;
+  void parseElements(Buffer::Instance& data);
+
   std::list<FieldPtr> fields_;
+  // Unparsed document bytes (without the leading length), empty once materialized.
+  std::string raw_;
 };
 
 } // namespace Bson
@@ -11,12 +11,19 @@
 
 #include "common/common/assert.h"
 #include "common/common/utility.h"
+#include "common/mongo/bson_impl.h"
 #include "common/mongo/codec_impl.h"
 
 #include "fmt/format.h"
 
 namespace Envoy {
 namespace Mongo {
+namespace {
+
+// Size of the standard message header: message length, request ID, response to, and op code.
+constexpr uint32_t MessageHeaderSize = 4 * sizeof(int32_t);
+
+} // namespace
 
 AccessLog::AccessLog(const std::string& file_name,
                      Envoy::AccessLog::AccessLogManager& log_manager) {
@@ -213,7 +220,32 @@ void ProxyFilter::doDecode(Buffer::Instance& buffer) {
   }
 
   try {
-    decoder_->onData(buffer);
+    // Fully decoding every message is expensive on passthrough heavy listeners where only
+    // aggregate stats are needed. When a sample rate N > 1 is configured, 1 in N messages is
+    // decoded fully and the rest are counted from the fixed offset header fields alone.
+    const uint64_t sample_rate =
+        runtime_.snapshot().getInteger(MongoRuntimeConfig::get().DecodeSampleRate, 1);
+    if (sample_rate <= 1) {
+      decoder_->onData(buffer);
+      return;
+    }
+
+    while (buffer.length() >= sizeof(int32_t)) {
+      const uint32_t message_length = Bson::BufferHelper::peakInt32(buffer);
+      if (buffer.length() < message_length) {
+        break;
+      }
+
+      // Undersized messages also take the decode path so that the decoder raises the normal
+      // decoding error.
+      if (message_counter_++ % sample_rate == 0 || message_length < MessageHeaderSize) {
+        Buffer::OwnedImpl message;
+        message.move(buffer, message_length);
+        decoder_->onData(message);
+      } else {
+        countMessageFromHeader(buffer, message_length);
+      }
+    }
   } catch (EnvoyException& e) {
     ENVOY_LOG(info, "mongo decoding error: {}", e.what());
     stats_.decoding_error_.inc();
@@ -221,6 +253,50 @@ void ProxyFilter::doDecode(Buffer::Instance& buffer) {
   }
 }
 
+void ProxyFilter::countMessageFromHeader(Buffer::Instance& buffer, uint32_t message_length) {
+  Bson::BufferHelper::removeInt32(buffer); // Message length.
+  Bson::BufferHelper::removeInt32(buffer); // Request ID.
+  const int32_t response_to = Bson::BufferHelper::removeInt32(buffer);
+  const int32_t op_code = Bson::BufferHelper::removeInt32(buffer);
+  buffer.drain(message_length - MessageHeaderSize);
+
+  switch (static_cast<Message::OpCode>(op_code)) {
+  case Message::OpCode::OP_REPLY: {
+    stats_.op_reply_.inc();
+
+    // If the query that this reply answers was decoded, retire it so that the active query list
+    // does not grow without bound. No reply stats are charged since the reply was not decoded.
+    for (auto i = active_query_list_.begin(); i != active_query_list_.end(); i++) {
+      if ((*i)->query_info_.requestId() == response_to) {
+        active_query_list_.erase(i);
+        break;
+      }
+    }
+    break;
+  }
+  case Message::OpCode::OP_QUERY: {
+    stats_.op_query_.inc();
+    break;
+  }
+  case Message::OpCode::OP_GET_MORE: {
+    stats_.op_get_more_.inc();
+    break;
+  }
+  case Message::OpCode::OP_INSERT: {
+    stats_.op_insert_.inc();
+    break;
+  }
+  case Message::OpCode::OP_KILL_CURSORS: {
+    stats_.op_kill_cursors_.inc();
+    break;
+  }
+  default:
+    // Unlike the full decoder we do not throw on unknown op codes here. The message was well
+    // framed, so keep sniffing and let a sampled message surface any real decoding problem.
+    break;
+  }
+}
+
 void ProxyFilter::logMessage(Message& message, bool full) {
   if (access_log_ &&
       runtime_.snapshot().featureEnabled(MongoRuntimeConfig::get().LoggingEnabled, 100)) {
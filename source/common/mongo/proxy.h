@@ -33,6 +33,7 @@ public:
   const std::string LoggingEnabled{"mongo.logging_enabled"};
   const std::string ProxyEnabled{"mongo.proxy_enabled"};
   const std::string ConnectionLoggingEnabled{"mongo.connection_logging_enabled"};
+  const std::string DecodeSampleRate{"mongo.decode_sample_rate"};
 };
 
 typedef ConstSingleton<MongoRuntimeConfigKeys> MongoRuntimeConfig;
@@ -171,6 +172,7 @@ private:
   void chargeQueryStats(const std::string& prefix, QueryMessageInfo::QueryType query_type);
   void chargeReplyStats(ActiveQuery& active_query, const std::string& prefix,
                         const ReplyMessage& message);
+  void countMessageFromHeader(Buffer::Instance& buffer, uint32_t message_length);
   void doDecode(Buffer::Instance& buffer);
   void logMessage(Message& message, bool full);
 
@@ -186,6 +188,7 @@ private:
   Buffer::OwnedImpl read_buffer_;
   Buffer::OwnedImpl write_buffer_;
   bool sniffing_{true};
+  uint64_t message_counter_{};
   std::list<ActiveQueryPtr> active_query_list_;
   AccessLogSharedPtr access_log_;
   Network::ReadFilterCallbacks* read_callbacks_{};
@@ -0,0 +1,31 @@
+#include "common/network/accept_rate_limiter_impl.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Envoy {
+namespace Network {
+
+AcceptRateLimiterImpl::AcceptRateLimiterImpl(uint32_t tokens_per_second,
+                                             MonotonicTimeSource& time_source)
+    : tokens_per_second_(tokens_per_second), time_source_(time_source),
+      tokens_(tokens_per_second), last_fill_(time_source.currentTime()) {}
+
+uint32_t AcceptRateLimiterImpl::take(uint32_t max_tokens) {
+  std::lock_guard<std::mutex> guard(lock_);
+
+  const MonotonicTime now = time_source_.currentTime();
+  const double elapsed_seconds =
+      std::chrono::duration_cast<std::chrono::duration<double>>(now - last_fill_).count();
+  last_fill_ = now;
+
+  tokens_ = std::min(static_cast<double>(tokens_per_second_),
+                     tokens_ + elapsed_seconds * tokens_per_second_);
+
+  const uint32_t granted = std::min(max_tokens, static_cast<uint32_t>(tokens_));
+  tokens_ -= granted;
+  return granted;
+}
+
+} // namespace Network
+} // namespace Envoy
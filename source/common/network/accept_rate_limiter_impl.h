@@ -0,0 +1,33 @@
+#pragma once
+
+#include <mutex>
+
+#include "envoy/common/time.h"
+#include "envoy/network/accept_rate_limiter.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Monotonic clock based token bucket. The bucket holds at most one second worth of tokens and
+ * starts full, so a listener that has been idle can absorb a burst of up to tokens_per_second
+ * accepts before shedding begins.
+ */
+class AcceptRateLimiterImpl : public AcceptRateLimiter {
+public:
+  AcceptRateLimiterImpl(uint32_t tokens_per_second, MonotonicTimeSource& time_source);
+
+  // Network::AcceptRateLimiter
+  uint32_t take(uint32_t max_tokens) override;
+
+private:
+  const uint32_t tokens_per_second_;
+  MonotonicTimeSource& time_source_;
+  std::mutex lock_;
+  // Fractional so that frequent small refills do not round the budget away.
+  double tokens_;
+  MonotonicTime last_fill_;
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -8,6 +8,7 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 
 #include "envoy/common/exception.h"
 
@@ -19,6 +20,63 @@
 namespace Envoy {
 namespace Network {
 namespace Address {
+namespace {
+
+// The accept path constructs a new address object per connection, but a proxy typically sees
+// only a handful of distinct downstream source IPs (e.g. the LBs in front of it), so the
+// formatted IP string is cached per worker and inet_ntop() runs once per distinct IP rather
+// than once per accepted connection. The caches are bounded so that a flood of distinct source
+// addresses (e.g. spoofed traffic) cannot grow them without limit.
+const size_t MaxCachedAddressStrings = 1024;
+
+const std::string& ipv4AddressAsString(const in_addr& address) {
+  static thread_local std::unordered_map<uint32_t, std::string> cache;
+  auto it = cache.find(address.s_addr);
+  if (it == cache.end()) {
+    if (cache.size() >= MaxCachedAddressStrings) {
+      cache.clear();
+    }
+    char str[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &address, str, INET_ADDRSTRLEN);
+    it = cache.emplace(address.s_addr, str).first;
+  }
+  return it->second;
+}
+
+const std::string& ipv6AddressAsString(const in6_addr& address) {
+  static thread_local std::unordered_map<std::string, std::string> cache;
+  std::string key(reinterpret_cast<const char*>(&address), sizeof(address));
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    if (cache.size() >= MaxCachedAddressStrings) {
+      cache.clear();
+    }
+    char str[INET6_ADDRSTRLEN];
+    inet_ntop(AF_INET6, &address, str, INET6_ADDRSTRLEN);
+    it = cache.emplace(std::move(key), str).first;
+  }
+  return it->second;
+}
+
+// Build "ip:port" (or "[ip]:port" for v6) without going through the formatting library.
+std::string friendlyNameFromIpAndPort(const std::string& address, uint32_t port, bool v6) {
+  char port_str[32];
+  const uint32_t port_len = StringUtil::itoa(port_str, sizeof(port_str), port);
+  std::string name;
+  name.reserve(address.size() + port_len + 3);
+  if (v6) {
+    name.push_back('[');
+  }
+  name.append(address);
+  if (v6) {
+    name.push_back(']');
+  }
+  name.push_back(':');
+  name.append(port_str, port_len);
+  return name;
+}
+
+} // namespace
 
 Address::InstanceConstSharedPtr addressFromSockAddr(const sockaddr_storage& ss, socklen_t ss_len) {
   RELEASE_ASSERT(ss_len == 0 || ss_len >= sizeof(sa_family_t));
@@ -121,10 +179,8 @@ int InstanceBase::socketFromSocketType(SocketType socketType) const {
 
 Ipv4Instance::Ipv4Instance(const sockaddr_in* address) : InstanceBase(Type::Ip) {
   ip_.ipv4_.address_ = *address;
-  char str[INET_ADDRSTRLEN];
-  inet_ntop(AF_INET, &address->sin_addr, str, INET_ADDRSTRLEN);
-  friendly_name_ = fmt::format("{}:{}", str, ntohs(address->sin_port));
-  ip_.friendly_address_ = str;
+  ip_.friendly_address_ = ipv4AddressAsString(address->sin_addr);
+  friendly_name_ = friendlyNameFromIpAndPort(ip_.friendly_address_, ntohs(address->sin_port), false);
 }
 
 Ipv4Instance::Ipv4Instance(const std::string& address) : Ipv4Instance(address, 0) {}
@@ -181,8 +237,8 @@ std::string Ipv6Instance::Ipv6Helper::makeFriendlyAddress() const {
 
 Ipv6Instance::Ipv6Instance(const sockaddr_in6& address) : InstanceBase(Type::Ip) {
   ip_.ipv6_.address_ = address;
-  ip_.friendly_address_ = ip_.ipv6_.makeFriendlyAddress();
-  friendly_name_ = fmt::format("[{}]:{}", ip_.friendly_address_, ip_.port());
+  ip_.friendly_address_ = ipv6AddressAsString(address.sin6_addr);
+  friendly_name_ = friendlyNameFromIpAndPort(ip_.friendly_address_, ip_.port(), true);
 }
 
 Ipv6Instance::Ipv6Instance(const std::string& address) : Ipv6Instance(address, 0) {}
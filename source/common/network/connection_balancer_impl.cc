@@ -0,0 +1,37 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Network {
+
+void ExactConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  std::lock_guard<std::mutex> guard(lock_);
+  handlers_.push_back(&handler);
+}
+
+void ExactConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  std::lock_guard<std::mutex> guard(lock_);
+  handlers_.erase(std::remove(handlers_.begin(), handlers_.end(), &handler), handlers_.end());
+}
+
+BalancedConnectionHandler&
+ExactConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler& current) {
+  std::lock_guard<std::mutex> guard(lock_);
+
+  // Starting from current biases ties toward not handing the connection off.
+  BalancedConnectionHandler* min_handler = &current;
+  uint64_t min_connections = current.numConnections();
+  for (BalancedConnectionHandler* handler : handlers_) {
+    const uint64_t connections = handler->numConnections();
+    if (connections < min_connections) {
+      min_handler = handler;
+      min_connections = connections;
+    }
+  }
+
+  return *min_handler;
+}
+
+} // namespace Network
+} // namespace Envoy
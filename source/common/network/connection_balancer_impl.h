@@ -0,0 +1,31 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "envoy/network/connection_balancer.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A connection balancer that hands each accepted socket to the registered handler with the
+ * fewest connections. This trades a lock acquisition per accept (and potentially a thread hop)
+ * for exact balance, so it is most useful for small numbers of long lived connections where
+ * kernel level accept distribution can leave one worker with a multiple of the connections of
+ * its siblings.
+ */
+class ExactConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current) override;
+
+private:
+  std::mutex lock_;
+  std::vector<BalancedConnectionHandler*> handlers_;
+};
+
+} // namespace Network
+} // namespace Envoy
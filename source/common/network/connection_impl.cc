@@ -5,6 +5,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 
@@ -23,6 +28,35 @@ namespace Envoy {
 namespace Network {
 
 namespace {
+// Bounds for the adaptive per-readv() budget. The budget starts at the minimum, doubles while
+// reads keep filling it (bulk transfer), and halves while reads come up mostly empty (idle
+// keep-alive), so each connection only reserves buffer space proportional to its actual
+// throughput. The bytes land in multiple preallocated buffer slices, so a large read costs one
+// syscall without requiring contiguous memory.
+constexpr uint64_t MinReadChunkSize = 4 * 1024;
+constexpr uint64_t MaxReadChunkSize = 64 * 1024;
+
+// Maximum number of bytes read from the socket per readiness event when no read buffer limit is
+// configured. Reading until EAGAIN with no bound would let a connection with a fast peer starve
+// other connections on the same event loop.
+constexpr uint64_t MaxReadSizePerEvent = 1024 * 1024;
+
+// Writes at or below this size are copied into the reservable tail of the write buffer instead
+// of moved in as whole slices. See the comment in ConnectionImpl::write().
+constexpr uint64_t SmallWriteSize = 1024;
+
+// Writes are attempted with MSG_ZEROCOPY when at least this much data is buffered. Below it, the
+// per send completion bookkeeping costs more than the copy it saves; the win is in multi-megabyte
+// transfers (e.g. proxied video segments) where copy bandwidth dominates.
+constexpr uint64_t ZeroCopyWriteThreshold = 64 * 1024;
+
+// Byte totals accumulate in connection local counters and are only pushed to the shared (atomic)
+// total counters once this many bytes are pending, plus a final flush when the connection closes.
+// On pass-through listeners the per event counter increments are a measurable cost, and stat
+// sinks only observe counters at the flush interval anyway, so each connection can understate the
+// shared totals by at most this much between flushes.
+constexpr uint64_t BufferStatsFlushThreshold = 64 * 1024;
+
 // TODO(mattklein123): Currently we don't populate local address for client connections. Nothing
 // looks at this currently, but we may want to populate this later for logging purposes.
 Address::InstanceConstSharedPtr getNullLocalAddress(const Address::Instance& address) {
@@ -35,10 +69,13 @@ Address::InstanceConstSharedPtr getNullLocalAddress(const Address::Instance& add
 } // namespace
 
 void ConnectionImplUtility::updateBufferStats(uint64_t delta, uint64_t new_total,
-                                              uint64_t& previous_total, Stats::Counter& stat_total,
+                                              uint64_t& previous_total, uint64_t& unflushed_total,
+                                              Stats::Counter& stat_total,
                                               Stats::Gauge& stat_current) {
-  if (delta) {
-    stat_total.add(delta);
+  unflushed_total += delta;
+  if (unflushed_total >= BufferStatsFlushThreshold) {
+    stat_total.add(unflushed_total);
+    unflushed_total = 0;
   }
 
   if (new_total != previous_total) {
@@ -63,7 +100,8 @@ ConnectionImpl::ConnectionImpl(Event::DispatcherImpl& dispatcher, int fd,
       write_buffer_(
           dispatcher.getWatermarkFactory().create([this]() -> void { this->onLowWatermark(); },
                                                   [this]() -> void { this->onHighWatermark(); })),
-      dispatcher_(dispatcher), fd_(fd), id_(++next_global_id_),
+      read_chunk_size_(MinReadChunkSize), dispatcher_(dispatcher), fd_(fd),
+      id_(++next_global_id_),
       using_original_dst_(using_original_dst) {
 
   // Treat the lack of a valid fd (which in practice only happens if we run out of FDs) as an OOM
@@ -161,8 +199,18 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
   // Drain input and output buffers.
   updateReadBufferStats(0, 0);
   updateWriteBufferStats(0, 0);
+  flushBufferStats();
   connection_stats_.reset();
 
+  if (!zerocopy_in_flight_.empty()) {
+    // Reap whatever completions have already arrived. Any send still in flight after this is
+    // freed with the connection; the kernel may still reference its pages for queued
+    // retransmits of this dying connection, so the slices are destroyed outright rather than
+    // recycled through the slice pool where another connection could overwrite them.
+    drainZeroCopyCompletions();
+    zerocopy_in_flight_.clear();
+  }
+
   file_event_.reset();
   ::close(fd_);
   fd_ = -1;
@@ -170,6 +218,32 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
   raiseEvent(close_type);
 }
 
+int ConnectionImpl::detachFd() {
+  // A migratable socket must carry no connection state: nothing buffered for reading or writing,
+  // no zero copy sends awaiting kernel completions, and no close in progress. The adopting
+  // process sees the socket exactly as if it had just been accepted.
+  if (!migratable_ || fd_ == -1 || state() != State::Open || read_buffer_.length() > 0 ||
+      write_buffer_->length() > 0 || !zerocopy_in_flight_.empty()) {
+    return -1;
+  }
+
+  ENVOY_CONN_LOG(debug, "detaching socket for migration", *this);
+
+  // Same teardown as closeSocket(), except that the fd is handed to the caller instead of being
+  // closed.
+  updateReadBufferStats(0, 0);
+  updateWriteBufferStats(0, 0);
+  flushBufferStats();
+  connection_stats_.reset();
+
+  file_event_.reset();
+  const int fd = fd_;
+  fd_ = -1;
+
+  raiseEvent(ConnectionEvent::LocalClose);
+  return fd;
+}
+
 Event::Dispatcher& ConnectionImpl::dispatcher() { return dispatcher_; }
 
 void ConnectionImpl::noDelay(bool enable) {
@@ -295,13 +369,21 @@ void ConnectionImpl::write(Buffer::Instance& data) {
 
   if (data.length() > 0) {
     ENVOY_CONN_LOG(trace, "writing {} bytes", *this, data.length());
-    // TODO(mattklein123): All data currently gets moved from the source buffer to the write buffer.
-    // This can lead to inefficient behavior if writing a bunch of small chunks. In this case, it
-    // would likely be more efficient to copy data below a certain size. VERY IMPORTANT: If this is
-    // ever changed, read the comment in Ssl::ConnectionImpl::doWriteToSocket() VERY carefully.
-    // That code assumes that we never change existing write_buffer_ chain elements between calls
-    // to SSL_write(). That code will have to change if we ever copy here.
-    write_buffer_->move(data);
+    if (coalesce_small_writes_ && data.length() <= SmallWriteSize) {
+      // Copy small chunks into the reservable tail of the write buffer rather than moving them
+      // in as whole slices. A filter chain that emits headers, body, and trailers separately
+      // would otherwise produce a chain of tiny slices that each consume an iovec when the
+      // buffer is flushed. The actual flush still happens at most once per event loop iteration
+      // via the activated write event below.
+      write_buffer_->add(data);
+      data.drain(data.length());
+    } else {
+      // VERY IMPORTANT: The SSL connection sets coalesce_small_writes_ to false so that data only
+      // ever gets moved into its write buffer. Ssl::ConnectionImpl::doWriteToSocket() assumes
+      // that existing write_buffer_ chain elements never grow between calls to SSL_write(); the
+      // copy above would violate that by appending into the tail slice.
+      write_buffer_->move(data);
+    }
 
     // Activating a write event before the socket is connected has the side-effect of tricking
     // doWriteReady into thinking the socket is connected. On OS X, the underlying write may fail
@@ -402,12 +484,7 @@ ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
   PostIoAction action = PostIoAction::KeepOpen;
   uint64_t bytes_read = 0;
   do {
-    // 16K read is arbitrary. IIRC, libevent will currently clamp this to 4K. libevent will also
-    // use an ioctl() before every read to figure out how much data there is to read.
-    //
-    // TODO(mattklein123) PERF: Tune the read size and figure out a way of getting rid of the
-    // ioctl(). The extra syscall is not worth it.
-    int rc = read_buffer_.read(fd_, 16384);
+    int rc = read_buffer_.read(fd_, read_chunk_size_);
     ENVOY_CONN_LOG(trace, "read returns: {}", *this, rc);
 
     // Remote close. Might need to raise data before raising close.
@@ -424,10 +501,27 @@ ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
       break;
     } else {
       bytes_read += rc;
+
+      // Adapt the budget for the next read to this connection's behavior. A read that filled
+      // the entire budget suggests bulk transfer, so the budget doubles; a read that left most
+      // of the budget unused shrinks it back toward the minimum.
+      if (static_cast<uint64_t>(rc) == read_chunk_size_) {
+        read_chunk_size_ = std::min(read_chunk_size_ * 2, MaxReadChunkSize);
+      } else if (static_cast<uint64_t>(rc) < read_chunk_size_ / 4) {
+        read_chunk_size_ = std::max(read_chunk_size_ / 2, MinReadChunkSize);
+      }
       if (shouldDrainReadBuffer()) {
         setReadBufferReady();
         break;
       }
+
+      // Yield after a fixed budget even when no buffer limit is configured. The activated read
+      // event resumes the read on the next event loop iteration after other connections have had
+      // a chance to run.
+      if (bytes_read >= MaxReadSizePerEvent) {
+        setReadBufferReady();
+        break;
+      }
     }
   } while (true);
 
@@ -457,7 +551,33 @@ ConnectionImpl::IoResult ConnectionImpl::doWriteToSocket() {
       action = PostIoAction::KeepOpen;
       break;
     }
-    int rc = write_buffer_->write(fd_);
+
+    // Probe for zero copy support the first time a write is large enough to benefit from it.
+    if (!zerocopy_probed_ && write_buffer_->length() >= ZeroCopyWriteThreshold) {
+      zerocopy_probed_ = true;
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+      const int on = 1;
+      zerocopy_enabled_ = 0 == setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on));
+#endif
+    }
+
+    int rc;
+    if (zerocopy_enabled_ && write_buffer_->length() >= ZeroCopyWriteThreshold) {
+      ZeroCopySend send;
+      send.seq_ = zerocopy_send_seq_;
+      // The write buffer is always the single concrete buffer implementation; see the note in
+      // Buffer::OwnedImpl::move().
+      rc = static_cast<Buffer::OwnedImpl&>(*write_buffer_).writeZeroCopy(fd_, send.slices_);
+      if (rc > 0) {
+        zerocopy_send_seq_++;
+        zerocopy_in_flight_.emplace_back(std::move(send));
+      } else if (rc == -1 && errno == ENOBUFS) {
+        // The kernel is out of locked page budget; do this pass as a plain copying write.
+        rc = write_buffer_->write(fd_);
+      }
+    } else {
+      rc = write_buffer_->write(fd_);
+    }
     ENVOY_CONN_LOG(trace, "write returns: {}", *this, rc);
     if (rc == -1) {
       ENVOY_CONN_LOG(trace, "write error: {}", *this, errno);
@@ -476,6 +596,45 @@ ConnectionImpl::IoResult ConnectionImpl::doWriteToSocket() {
   return {action, bytes_written};
 }
 
+void ConnectionImpl::drainZeroCopyCompletions() {
+#if defined(__linux__) && defined(MSG_ZEROCOPY)
+  while (!zerocopy_in_flight_.empty()) {
+    uint8_t control[128];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(fd_, &msg, MSG_ERRQUEUE) == -1) {
+      // EAGAIN: no completions pending yet. An error queue event raises EPOLLERR, which the
+      // event loop delivers as read+write readiness, so we get back here when one arrives.
+      return;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      const sock_extended_err* err =
+          reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+
+      // [ee_info, ee_data] is an inclusive range of completed send sequence numbers, and TCP
+      // completes sends in order, so everything up to ee_data can be released.
+      while (!zerocopy_in_flight_.empty() && zerocopy_in_flight_.front().seq_ <= err->ee_data) {
+        for (Buffer::SlicePtr& slice : zerocopy_in_flight_.front().slices_) {
+          Buffer::Slice::recycle(std::move(slice));
+        }
+        zerocopy_in_flight_.pop_front();
+      }
+
+      if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        // The kernel copied after all (e.g. a device without scatter/gather); stop paying the
+        // completion overhead on this connection.
+        zerocopy_enabled_ = false;
+      }
+    }
+  }
+#endif
+}
+
 void ConnectionImpl::onConnected() { raiseEvent(ConnectionEvent::Connected); }
 
 void ConnectionImpl::onWriteReady() {
@@ -504,6 +663,10 @@ void ConnectionImpl::onWriteReady() {
     }
   }
 
+  if (!zerocopy_in_flight_.empty()) {
+    drainZeroCopyCompletions();
+  }
+
   IoResult result = doWriteToSocket();
   uint64_t new_buffer_size = write_buffer_->length();
   updateWriteBufferStats(result.bytes_processed_, new_buffer_size);
@@ -550,7 +713,7 @@ void ConnectionImpl::updateReadBufferStats(uint64_t num_read, uint64_t new_size)
   }
 
   ConnectionImplUtility::updateBufferStats(num_read, new_size, last_read_buffer_size_,
-                                           connection_stats_->read_total_,
+                                           unflushed_read_bytes_, connection_stats_->read_total_,
                                            connection_stats_->read_current_);
 }
 
@@ -560,10 +723,25 @@ void ConnectionImpl::updateWriteBufferStats(uint64_t num_written, uint64_t new_s
   }
 
   ConnectionImplUtility::updateBufferStats(num_written, new_size, last_write_buffer_size_,
-                                           connection_stats_->write_total_,
+                                           unflushed_write_bytes_, connection_stats_->write_total_,
                                            connection_stats_->write_current_);
 }
 
+void ConnectionImpl::flushBufferStats() {
+  if (!connection_stats_) {
+    return;
+  }
+
+  if (unflushed_read_bytes_ > 0) {
+    connection_stats_->read_total_.add(unflushed_read_bytes_);
+    unflushed_read_bytes_ = 0;
+  }
+  if (unflushed_write_bytes_ > 0) {
+    connection_stats_->write_total_.add(unflushed_write_bytes_);
+    unflushed_write_bytes_ = 0;
+  }
+}
+
 ClientConnectionImpl::ClientConnectionImpl(
     Event::DispatcherImpl& dispatcher, Address::InstanceConstSharedPtr address,
     const Network::Address::InstanceConstSharedPtr source_address)
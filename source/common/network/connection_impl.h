@@ -5,6 +5,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/common/optional.h"
 #include "envoy/network/connection.h"
@@ -29,12 +30,16 @@ public:
    * @param new_total supplies the final total buffer size.
    * @param previous_total supplies the previous final total buffer size. previous_total will be
    *        updated to new_total when the call is complete.
+   * @param unflushed_total supplies the connection local accumulator for stat_total. The delta is
+   *        added here and only pushed to the shared counter once the accumulator crosses a
+   *        threshold; the connection flushes whatever remains when it closes.
    * @param stat_total supplies the counter to increment with the delta.
    * @param stat_current supplies the guage that should be updated with the delta of previous_total
    *        and new_total.
    */
   static void updateBufferStats(uint64_t delta, uint64_t new_total, uint64_t& previous_total,
-                                Stats::Counter& stat_total, Stats::Gauge& stat_current);
+                                uint64_t& unflushed_total, Stats::Counter& stat_total,
+                                Stats::Gauge& stat_current);
 };
 
 /**
@@ -62,6 +67,7 @@ public:
   void addConnectionCallbacks(ConnectionCallbacks& cb) override;
   void close(ConnectionCloseType type) override;
   Event::Dispatcher& dispatcher() override;
+  int fd() override { return fd_; }
   uint64_t id() const override;
   std::string nextProtocol() const override { return ""; }
   void noDelay(bool enable) override;
@@ -79,6 +85,8 @@ public:
   uint32_t bufferLimit() const override { return read_buffer_limit_; }
   bool usingOriginalDst() const override { return using_original_dst_; }
   bool aboveHighWatermark() const override { return above_high_watermark_; }
+  void setMigratable(bool migratable) override { migratable_ = migratable; }
+  int detachFd() override;
 
   // Network::BufferSource
   Buffer::Instance& getReadBuffer() override { return read_buffer_; }
@@ -105,6 +113,12 @@ protected:
   // fair sharing of CPU resources, the underlying event loop does not make any fairness guarantees.
   // Reconsider how to make fairness happen.
   void setReadBufferReady() { file_event_->activate(Event::FileReadyType::Read); }
+  // Re-run both the read and write event handlers. This is used to replay events that were
+  // observed but deliberately not acted upon (e.g. while an SSL handshake was offloaded), since
+  // with edge triggered events they will not fire again on their own.
+  void setReadWriteReady() {
+    file_event_->activate(Event::FileReadyType::Read | Event::FileReadyType::Write);
+  }
 
   void onLowWatermark();
   void onHighWatermark();
@@ -117,6 +131,14 @@ protected:
   // a generic pointer.
   Buffer::InstancePtr write_buffer_;
   uint32_t read_buffer_limit_ = 0;
+  // Current adaptive per-readv() budget. It grows while the connection sustains bulk transfer
+  // and shrinks back toward the minimum while the connection is mostly idle, so idle
+  // keep-alives do not reserve bulk transfer sized buffers. See doReadFromSocket().
+  uint64_t read_chunk_size_;
+  // Whether small writes may be copied into the tail of the write buffer instead of moved in as
+  // whole slices. Disabled by the SSL connection, whose doWriteToSocket() requires that existing
+  // write buffer chain elements never grow between calls to SSL_write().
+  bool coalesce_small_writes_{true};
 
 private:
   // clang-format off
@@ -131,6 +153,7 @@ private:
 
   virtual IoResult doReadFromSocket();
   virtual IoResult doWriteToSocket();
+  void drainZeroCopyCompletions();
   virtual void onConnected();
   void onFileEvent(uint32_t events);
   void onRead(uint64_t read_buffer_size);
@@ -138,6 +161,7 @@ private:
   void onWriteReady();
   void updateReadBufferStats(uint64_t num_read, uint64_t new_size);
   void updateWriteBufferStats(uint64_t num_written, uint64_t new_size);
+  void flushBufferStats();
 
   static std::atomic<uint64_t> next_global_id_;
 
@@ -150,6 +174,11 @@ private:
   Buffer::Instance* current_write_buffer_{};
   uint64_t last_read_buffer_size_{};
   uint64_t last_write_buffer_size_{};
+  // Bytes not yet pushed to the shared total counters. The shared counters are atomics touched
+  // by every connection on every thread, so per-event deltas are batched here and flushed when
+  // they cross a threshold or when the connection closes.
+  uint64_t unflushed_read_bytes_{};
+  uint64_t unflushed_write_bytes_{};
   std::unique_ptr<ConnectionStats> connection_stats_;
   // Tracks the number of times reads have been disabled.  If N different components call
   // readDisabled(true) this allows the connection to only resume reads when readDisabled(false)
@@ -158,6 +187,24 @@ private:
   const bool using_original_dst_;
   bool above_high_watermark_{false};
   bool detect_early_close_{true};
+  // Set by the connection's owner when the socket may be handed to another process. See
+  // Connection::setMigratable().
+  bool migratable_{false};
+
+  // State for MSG_ZEROCOPY writes. Each successful zero copy sendmsg consumes one kernel
+  // sequence number and retains the slices whose pages the kernel references until the matching
+  // completion has been reaped from the socket error queue. See doWriteToSocket() and
+  // drainZeroCopyCompletions().
+  struct ZeroCopySend {
+    uint32_t seq_;
+    std::vector<Buffer::SlicePtr> slices_;
+  };
+  std::list<ZeroCopySend> zerocopy_in_flight_;
+  uint32_t zerocopy_send_seq_{};
+  // Probed lazily on the first write large enough to qualify; cleared again if the kernel
+  // reports that it fell back to copying anyway.
+  bool zerocopy_enabled_{};
+  bool zerocopy_probed_{};
 };
 
 /**
@@ -15,6 +15,7 @@
 #include "common/network/utility.h"
 
 #include "ares.h"
+#include "fmt/format.h"
 
 namespace Envoy {
 namespace Network {
@@ -202,5 +203,81 @@ void DnsResolverImpl::PendingResolution::getHostByName(int family) {
                      this);
 }
 
+CachingDnsResolverImpl::CachingDnsResolverImpl(DnsResolverSharedPtr resolver,
+                                               MonotonicTimeSource& time_source,
+                                               std::chrono::milliseconds ttl)
+    : time_source_(time_source), ttl_(ttl), resolver_(resolver) {}
+
+ActiveDnsQuery* CachingDnsResolverImpl::resolve(const std::string& dns_name,
+                                                DnsLookupFamily dns_lookup_family,
+                                                ResolveCb callback) {
+  const std::string key =
+      fmt::format("{}|{}", static_cast<int>(dns_lookup_family), dns_name);
+  CacheEntry& entry = cache_[key];
+  const MonotonicTime now = time_source_.currentTime();
+
+  if (entry.resolved_ && now < entry.expiry_) {
+    // Refresh in the background once the entry passes half of its TTL so that names which are
+    // resolved regularly never expire and never wait on the network.
+    if (!entry.query_in_flight_ && now >= entry.expiry_ - ttl_ / 2) {
+      ENVOY_LOG(debug, "dns cache refresh ahead of expiry for '{}'", dns_name);
+      startQuery(key, dns_name, dns_lookup_family);
+    }
+
+    std::list<Address::InstanceConstSharedPtr> address_list = entry.addresses_;
+    callback(std::move(address_list));
+    return nullptr;
+  }
+
+  entry.waiters_.emplace_back(new PendingQuery(callback));
+  PendingQuery* pending_query = entry.waiters_.back().get();
+  if (!entry.query_in_flight_) {
+    startQuery(key, dns_name, dns_lookup_family);
+
+    // The query may have completed synchronously (e.g., an immediate failure), in which case
+    // the waiters have already been completed and freed.
+    if (entry.waiters_.empty()) {
+      return nullptr;
+    }
+  }
+
+  return pending_query;
+}
+
+void CachingDnsResolverImpl::startQuery(const std::string& key, const std::string& dns_name,
+                                        DnsLookupFamily dns_lookup_family) {
+  cache_[key].query_in_flight_ = true;
+
+  // The upstream query is deliberately never cancelled; even if every waiter cancels, the
+  // answer is still used to refresh the cache.
+  resolver_->resolve(dns_name, dns_lookup_family,
+                     [this, key](std::list<Address::InstanceConstSharedPtr>&& address_list)
+                         -> void { onQueryComplete(key, std::move(address_list)); });
+}
+
+void CachingDnsResolverImpl::onQueryComplete(
+    const std::string& key, std::list<Address::InstanceConstSharedPtr>&& address_list) {
+  CacheEntry& entry = cache_[key];
+  entry.query_in_flight_ = false;
+  if (!address_list.empty()) {
+    entry.addresses_ = std::move(address_list);
+    entry.resolved_ = true;
+    entry.expiry_ = time_source_.currentTime() + ttl_;
+  }
+  // On failure any previously cached addresses are kept and served until a later query
+  // succeeds, which matches how the DNS cluster types hold on to their last good hosts.
+
+  // The waiter list is detached before invoking callbacks so that a callback which re-enters
+  // resolve() starts from a clean slate.
+  std::list<std::unique_ptr<PendingQuery>> waiters;
+  waiters.swap(entry.waiters_);
+  for (const std::unique_ptr<PendingQuery>& waiter : waiters) {
+    if (!waiter->cancelled_) {
+      std::list<Address::InstanceConstSharedPtr> copy = entry.addresses_;
+      waiter->callback_(std::move(copy));
+    }
+  }
+}
+
 } // namespace Network
 } // namespace Envoy
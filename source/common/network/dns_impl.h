@@ -2,10 +2,14 @@
 
 #include <netdb.h>
 
+#include <chrono>
 #include <cstdint>
+#include <list>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/file_event.h"
 #include "envoy/network/dns.h"
@@ -93,5 +97,56 @@ private:
   std::unordered_map<int, Event::FileEventPtr> events_;
 };
 
+/**
+ * A DnsResolver decorator that caches successful resolutions, coalesces concurrent queries for
+ * the same name, and refreshes cached entries in the background once they pass half of their
+ * TTL so that steadily used names are always answered from the cache. c-ares's hostent
+ * interface does not expose per-record TTLs, so a single resolver-wide TTL is applied to every
+ * entry. All calls and callbacks are assumed to happen on the thread that owns the wrapped
+ * resolver's dispatcher.
+ */
+class CachingDnsResolverImpl : public DnsResolver,
+                               protected Logger::Loggable<Logger::Id::upstream> {
+public:
+  CachingDnsResolverImpl(DnsResolverSharedPtr resolver, MonotonicTimeSource& time_source,
+                         std::chrono::milliseconds ttl = std::chrono::milliseconds(30000));
+
+  // Network::DnsResolver
+  ActiveDnsQuery* resolve(const std::string& dns_name, DnsLookupFamily dns_lookup_family,
+                          ResolveCb callback) override;
+
+private:
+  struct PendingQuery : public ActiveDnsQuery {
+    PendingQuery(ResolveCb callback) : callback_(callback) {}
+
+    // Network::ActiveDnsQuery
+    void cancel() override { cancelled_ = true; }
+
+    const ResolveCb callback_;
+    bool cancelled_{};
+  };
+
+  struct CacheEntry {
+    // Waiters coalesced onto an in-flight query; all are completed when the query finishes.
+    std::list<std::unique_ptr<PendingQuery>> waiters_;
+    std::list<Address::InstanceConstSharedPtr> addresses_;
+    MonotonicTime expiry_;
+    bool resolved_{};
+    bool query_in_flight_{};
+  };
+
+  void startQuery(const std::string& key, const std::string& dns_name,
+                  DnsLookupFamily dns_lookup_family);
+  void onQueryComplete(const std::string& key,
+                       std::list<Address::InstanceConstSharedPtr>&& address_list);
+
+  MonotonicTimeSource& time_source_;
+  const std::chrono::milliseconds ttl_;
+  std::unordered_map<std::string, CacheEntry> cache_;
+  // The wrapped resolver is declared last so that any queries it completes during destruction
+  // run while the cache is still valid.
+  DnsResolverSharedPtr resolver_;
+};
+
 } // namespace Network
 } // namespace Envoy
@@ -0,0 +1,350 @@
+#include "common/network/happy_eyeballs_connection_impl.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+// Delay before starting the next connection attempt while earlier attempts are still pending.
+// RFC 8305 calls this the "connection attempt delay" and recommends 250ms as the default.
+const std::chrono::milliseconds CONNECTION_ATTEMPT_DELAY{250};
+} // namespace
+
+HappyEyeballsConnectionImpl::HappyEyeballsConnectionImpl(
+    Event::Dispatcher& dispatcher, const std::vector<Address::InstanceConstSharedPtr>& address_list,
+    ConnectionFactory connection_factory)
+    : dispatcher_(dispatcher), address_list_(address_list),
+      connection_factory_(connection_factory),
+      next_attempt_timer_(dispatcher.createTimer([this]() -> void { startNextAttempt(); })) {
+  ASSERT(!address_list_.empty());
+
+  // Create (but do not connect) the first attempt eagerly so that delegating calls such as id()
+  // and remoteAddress() work before connect() is called, like they do on a plain connection.
+  attempts_.emplace_back(
+      new ConnectionAttempt(*this, connection_factory_(address_list_[next_address_])));
+  next_address_++;
+}
+
+HappyEyeballsConnectionImpl::~HappyEyeballsConnectionImpl() {
+  // As with a plain connection, the owner is expected to close() before destruction. Make sure
+  // any attempts that are still open get closed regardless since the underlying connections
+  // cannot be destroyed while open. Mark the facade closed first so that the close events raised
+  // below do not kick off replacement attempts.
+  closed_ = true;
+  for (const ConnectionAttemptPtr& attempt : attempts_) {
+    if (attempt->connection_ != nullptr &&
+        attempt->connection_->state() != Connection::State::Closed) {
+      attempt->connection_->close(ConnectionCloseType::NoFlush);
+    }
+  }
+}
+
+void HappyEyeballsConnectionImpl::connect() {
+  ASSERT(!connect_called_);
+  connect_called_ = true;
+  ENVOY_CONN_LOG(debug, "starting connection attempt 1 of {}", *attempts_[0]->connection_,
+                 address_list_.size());
+  attempts_[0]->connection_->connect();
+  if (next_address_ < address_list_.size()) {
+    next_attempt_timer_->enableTimer(CONNECTION_ATTEMPT_DELAY);
+  }
+}
+
+void HappyEyeballsConnectionImpl::startNextAttempt() {
+  if (winner_ != nullptr || closed_ || next_address_ >= address_list_.size()) {
+    return;
+  }
+
+  ConnectionAttemptPtr attempt(
+      new ConnectionAttempt(*this, connection_factory_(address_list_[next_address_])));
+  next_address_++;
+  ENVOY_CONN_LOG(debug, "starting connection attempt {} of {}", *attempt->connection_,
+                 next_address_, address_list_.size());
+  attempt->connection_->connect();
+  attempts_.emplace_back(std::move(attempt));
+  if (next_address_ < address_list_.size()) {
+    next_attempt_timer_->enableTimer(CONNECTION_ATTEMPT_DELAY);
+  }
+}
+
+void HappyEyeballsConnectionImpl::onAttemptEvent(ConnectionAttempt& attempt,
+                                                 ConnectionEvent event) {
+  if (&attempt == winner_) {
+    raiseEvent(event);
+    return;
+  }
+
+  if (attempt.connection_ == nullptr || closed_) {
+    // Close events from losing attempts being torn down, or from a user initiated close.
+    return;
+  }
+
+  if (event == ConnectionEvent::Connected) {
+    setUpWinner(attempt);
+    return;
+  }
+
+  ENVOY_CONN_LOG(debug, "connection attempt failed", *attempt.connection_);
+  failed_attempts_++;
+  const bool attempts_in_flight = liveAttempts() > 1;
+  const bool addresses_remaining = next_address_ < address_list_.size();
+  if (!attempts_in_flight && !addresses_remaining) {
+    // Every attempt has failed. Raise the final failure like a plain connection would. The closed
+    // connection is kept as the delegate so that callers can still query id(), state(), etc.
+    raiseEvent(event);
+    return;
+  }
+
+  dispatcher_.deferredDelete(std::move(attempt.connection_));
+  if (!attempts_in_flight) {
+    // The only pending attempt just failed; don't wait out the stagger delay.
+    next_attempt_timer_->disableTimer();
+    startNextAttempt();
+  }
+}
+
+void HappyEyeballsConnectionImpl::onAttemptAboveWriteBufferHighWatermark(
+    ConnectionAttempt& attempt) {
+  if (&attempt == winner_) {
+    for (ConnectionCallbacks* callback : callbacks_) {
+      callback->onAboveWriteBufferHighWatermark();
+    }
+  }
+}
+
+void HappyEyeballsConnectionImpl::onAttemptBelowWriteBufferLowWatermark(
+    ConnectionAttempt& attempt) {
+  if (&attempt == winner_) {
+    for (ConnectionCallbacks* callback : callbacks_) {
+      callback->onBelowWriteBufferLowWatermark();
+    }
+  }
+}
+
+void HappyEyeballsConnectionImpl::setUpWinner(ConnectionAttempt& attempt) {
+  ASSERT(winner_ == nullptr);
+  winner_ = &attempt;
+  next_attempt_timer_->disableTimer();
+  ENVOY_CONN_LOG(debug, "connection attempt won after {} failed attempts", *attempt.connection_,
+                 failed_attempts_);
+
+  for (const ConnectionAttemptPtr& other : attempts_) {
+    if (other.get() != &attempt && other->connection_ != nullptr) {
+      closeAndDeferredDelete(*other);
+    }
+  }
+
+  // Replay the state queued while the race was in progress onto the winning connection.
+  ClientConnection& connection = *attempt.connection_;
+  if (connection_stats_ != nullptr) {
+    connection.setConnectionStats(*connection_stats_);
+  }
+  if (buffer_limits_.valid()) {
+    connection.setBufferLimits(buffer_limits_.value());
+  }
+  if (no_delay_.valid()) {
+    connection.noDelay(no_delay_.value());
+  }
+  if (!detect_early_close_) {
+    connection.detectEarlyCloseWhenReadDisabled(false);
+  }
+  for (const ReadFilterSharedPtr& filter : pending_read_filters_) {
+    connection.addReadFilter(filter);
+  }
+  for (const WriteFilterSharedPtr& filter : pending_write_filters_) {
+    connection.addWriteFilter(filter);
+  }
+  for (const FilterSharedPtr& filter : pending_filters_) {
+    connection.addFilter(filter);
+  }
+  pending_read_filters_.clear();
+  pending_write_filters_.clear();
+  pending_filters_.clear();
+  if (initialize_read_filters_) {
+    connection.initializeReadFilters();
+  }
+  for (uint32_t i = 0; i < read_disable_count_; i++) {
+    connection.readDisable(true);
+  }
+  if (pending_write_data_.length() > 0) {
+    connection.write(pending_write_data_);
+  }
+
+  raiseEvent(ConnectionEvent::Connected);
+}
+
+void HappyEyeballsConnectionImpl::raiseEvent(ConnectionEvent event) {
+  for (ConnectionCallbacks* callback : callbacks_) {
+    callback->onEvent(event);
+  }
+}
+
+void HappyEyeballsConnectionImpl::closeAndDeferredDelete(ConnectionAttempt& attempt) {
+  // Move the connection out first; a null connection_ marks the attempt as dead so that the
+  // close event raised below is ignored.
+  ClientConnectionPtr connection = std::move(attempt.connection_);
+  connection->close(ConnectionCloseType::NoFlush);
+  dispatcher_.deferredDelete(std::move(connection));
+}
+
+size_t HappyEyeballsConnectionImpl::liveAttempts() const {
+  size_t live = 0;
+  for (const ConnectionAttemptPtr& attempt : attempts_) {
+    if (attempt->connection_ != nullptr) {
+      live++;
+    }
+  }
+  return live;
+}
+
+const Connection& HappyEyeballsConnectionImpl::leading() const {
+  if (winner_ != nullptr) {
+    return *winner_->connection_;
+  }
+
+  // Prefer the most recently started attempt that is still around.
+  for (auto it = attempts_.rbegin(); it != attempts_.rend(); ++it) {
+    if ((*it)->connection_ != nullptr) {
+      return *(*it)->connection_;
+    }
+  }
+
+  NOT_REACHED;
+}
+
+void HappyEyeballsConnectionImpl::addConnectionCallbacks(ConnectionCallbacks& cb) {
+  // Callbacks always stay on the facade. Events from the winning connection are forwarded via
+  // its attempt wrapper, so attaching user callbacks directly to the winner would deliver events
+  // twice.
+  callbacks_.push_back(&cb);
+}
+
+void HappyEyeballsConnectionImpl::close(ConnectionCloseType type) {
+  if (winner_ != nullptr) {
+    winner_->connection_->close(type);
+    return;
+  }
+
+  if (closed_) {
+    return;
+  }
+
+  // No attempt has connected yet so there is no data to flush anywhere; close every in-flight
+  // attempt and raise LocalClose once on their behalf. The last attempt's connection is kept
+  // (closed) as the delegate for post-close queries.
+  closed_ = true;
+  next_attempt_timer_->disableTimer();
+  ConnectionAttempt* last = nullptr;
+  for (const ConnectionAttemptPtr& attempt : attempts_) {
+    if (attempt->connection_ != nullptr) {
+      if (last != nullptr) {
+        closeAndDeferredDelete(*last);
+      }
+      last = attempt.get();
+    }
+  }
+  ASSERT(last != nullptr);
+  last->connection_->close(ConnectionCloseType::NoFlush);
+  raiseEvent(ConnectionEvent::LocalClose);
+}
+
+void HappyEyeballsConnectionImpl::noDelay(bool enable) {
+  if (winner_ != nullptr) {
+    winner_->connection_->noDelay(enable);
+  } else {
+    no_delay_.value(enable);
+  }
+}
+
+void HappyEyeballsConnectionImpl::readDisable(bool disable) {
+  if (winner_ != nullptr) {
+    winner_->connection_->readDisable(disable);
+  } else if (disable) {
+    read_disable_count_++;
+  } else {
+    ASSERT(read_disable_count_ > 0);
+    read_disable_count_--;
+  }
+}
+
+void HappyEyeballsConnectionImpl::detectEarlyCloseWhenReadDisabled(bool should_detect) {
+  if (winner_ != nullptr) {
+    winner_->connection_->detectEarlyCloseWhenReadDisabled(should_detect);
+  } else {
+    detect_early_close_ = should_detect;
+  }
+}
+
+bool HappyEyeballsConnectionImpl::readEnabled() const {
+  if (winner_ != nullptr) {
+    return winner_->connection_->readEnabled();
+  }
+  return read_disable_count_ == 0;
+}
+
+void HappyEyeballsConnectionImpl::setConnectionStats(const ConnectionStats& stats) {
+  if (winner_ != nullptr) {
+    winner_->connection_->setConnectionStats(stats);
+  } else {
+    // ConnectionStats holds references so it cannot go in an Optional; copy it on the heap.
+    connection_stats_.reset(new ConnectionStats(stats));
+  }
+}
+
+Connection::State HappyEyeballsConnectionImpl::state() const { return leading().state(); }
+
+void HappyEyeballsConnectionImpl::write(Buffer::Instance& data) {
+  if (winner_ != nullptr) {
+    winner_->connection_->write(data);
+  } else {
+    pending_write_data_.move(data);
+  }
+}
+
+void HappyEyeballsConnectionImpl::setBufferLimits(uint32_t limit) {
+  if (winner_ != nullptr) {
+    winner_->connection_->setBufferLimits(limit);
+  } else {
+    buffer_limits_.value(limit);
+  }
+}
+
+void HappyEyeballsConnectionImpl::addWriteFilter(WriteFilterSharedPtr filter) {
+  if (winner_ != nullptr) {
+    winner_->connection_->addWriteFilter(filter);
+  } else {
+    pending_write_filters_.push_back(filter);
+  }
+}
+
+void HappyEyeballsConnectionImpl::addFilter(FilterSharedPtr filter) {
+  if (winner_ != nullptr) {
+    winner_->connection_->addFilter(filter);
+  } else {
+    pending_filters_.push_back(filter);
+  }
+}
+
+void HappyEyeballsConnectionImpl::addReadFilter(ReadFilterSharedPtr filter) {
+  if (winner_ != nullptr) {
+    winner_->connection_->addReadFilter(filter);
+  } else {
+    pending_read_filters_.push_back(filter);
+  }
+}
+
+bool HappyEyeballsConnectionImpl::initializeReadFilters() {
+  if (winner_ != nullptr) {
+    return winner_->connection_->initializeReadFilters();
+  }
+  initialize_read_filters_ = true;
+  return !pending_read_filters_.empty();
+}
+
+} // namespace Network
+} // namespace Envoy
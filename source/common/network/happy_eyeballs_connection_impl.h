@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/optional.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/connection.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Implementation of ClientConnection which races connection attempts across a list of resolved
+ * addresses, in the style of RFC 8305 ("happy eyeballs"). The first attempt starts on connect();
+ * while no attempt has succeeded, each subsequent attempt starts after a fixed stagger delay or
+ * immediately when the previous attempt fails. The first attempt to connect wins and the losers
+ * are closed, which converts the worst case connect latency for a blackholed address from
+ * timeout-bound to roughly RTT-bound.
+ *
+ * Until a winner is known there is no single underlying connection to operate on, so calls that
+ * mutate connection state (writes, filters, callbacks, socket options) are queued and replayed
+ * onto the winning connection. If every attempt fails, the final failure event is raised to the
+ * registered callbacks exactly like a plain connection failure.
+ */
+class HappyEyeballsConnectionImpl : public ClientConnection,
+                                    protected Logger::Loggable<Logger::Id::connection> {
+public:
+  /**
+   * Creates a (not yet connected) client connection for one address in the list. This indirection
+   * lets the caller decide how attempts are built (e.g. raw vs. SSL connections, buffer limits).
+   */
+  typedef std::function<ClientConnectionPtr(Address::InstanceConstSharedPtr)> ConnectionFactory;
+
+  HappyEyeballsConnectionImpl(Event::Dispatcher& dispatcher,
+                              const std::vector<Address::InstanceConstSharedPtr>& address_list,
+                              ConnectionFactory connection_factory);
+  ~HappyEyeballsConnectionImpl();
+
+  // Network::ClientConnection
+  void connect() override;
+
+  // Network::Connection
+  void addConnectionCallbacks(ConnectionCallbacks& cb) override;
+  void close(ConnectionCloseType type) override;
+  Event::Dispatcher& dispatcher() override { return dispatcher_; }
+  int fd() override { return leading().fd(); }
+  uint64_t id() const override { return leading().id(); }
+  std::string nextProtocol() const override { return leading().nextProtocol(); }
+  void noDelay(bool enable) override;
+  void readDisable(bool disable) override;
+  void detectEarlyCloseWhenReadDisabled(bool should_detect) override;
+  bool readEnabled() const override;
+  const Address::Instance& remoteAddress() const override { return leading().remoteAddress(); }
+  const Address::Instance& localAddress() const override { return leading().localAddress(); }
+  void setConnectionStats(const ConnectionStats& stats) override;
+  Ssl::Connection* ssl() override { return leading().ssl(); }
+  const Ssl::Connection* ssl() const override { return leading().ssl(); }
+  State state() const override;
+  void write(Buffer::Instance& data) override;
+  void setBufferLimits(uint32_t limit) override;
+  uint32_t bufferLimit() const override { return leading().bufferLimit(); }
+  bool usingOriginalDst() const override { return false; }
+  bool aboveHighWatermark() const override { return leading().aboveHighWatermark(); }
+  // Upstream client connections are never migrated across processes.
+  void setMigratable(bool) override {}
+  int detachFd() override { return -1; }
+
+  // Network::FilterManager
+  void addWriteFilter(WriteFilterSharedPtr filter) override;
+  void addFilter(FilterSharedPtr filter) override;
+  void addReadFilter(ReadFilterSharedPtr filter) override;
+  bool initializeReadFilters() override;
+
+private:
+  struct ConnectionAttempt : public ConnectionCallbacks {
+    ConnectionAttempt(HappyEyeballsConnectionImpl& parent, ClientConnectionPtr&& connection)
+        : parent_(parent), connection_(std::move(connection)) {
+      connection_->addConnectionCallbacks(*this);
+    }
+
+    // Network::ConnectionCallbacks
+    void onEvent(ConnectionEvent event) override { parent_.onAttemptEvent(*this, event); }
+    // Nothing is written to an attempt before it wins, so watermark events cannot fire until
+    // the winner's events are being forwarded anyway.
+    void onAboveWriteBufferHighWatermark() override {
+      parent_.onAttemptAboveWriteBufferHighWatermark(*this);
+    }
+    void onBelowWriteBufferLowWatermark() override {
+      parent_.onAttemptBelowWriteBufferLowWatermark(*this);
+    }
+
+    HappyEyeballsConnectionImpl& parent_;
+    ClientConnectionPtr connection_;
+  };
+
+  typedef std::unique_ptr<ConnectionAttempt> ConnectionAttemptPtr;
+
+  /**
+   * @return the connection all const delegating calls go to: the winner once there is one,
+   *         otherwise the most recently started attempt.
+   */
+  const Connection& leading() const;
+  Connection& leading() {
+    return const_cast<Connection&>(static_cast<const HappyEyeballsConnectionImpl*>(this)->leading());
+  }
+  void startNextAttempt();
+  size_t liveAttempts() const;
+  void onAttemptEvent(ConnectionAttempt& attempt, ConnectionEvent event);
+  void onAttemptAboveWriteBufferHighWatermark(ConnectionAttempt& attempt);
+  void onAttemptBelowWriteBufferLowWatermark(ConnectionAttempt& attempt);
+  void setUpWinner(ConnectionAttempt& attempt);
+  void raiseEvent(ConnectionEvent event);
+  void closeAndDeferredDelete(ConnectionAttempt& attempt);
+
+  Event::Dispatcher& dispatcher_;
+  const std::vector<Address::InstanceConstSharedPtr> address_list_;
+  ConnectionFactory connection_factory_;
+  Event::TimerPtr next_attempt_timer_;
+  // Attempt wrappers live for the facade's lifetime: the winner's wrapper keeps forwarding
+  // events (there is no way to unregister connection callbacks), and keeping losers around
+  // avoids deleting a wrapper from inside its own event callback.
+  std::vector<ConnectionAttemptPtr> attempts_;
+  ConnectionAttempt* winner_{};
+  size_t next_address_{};
+  size_t failed_attempts_{};
+  bool connect_called_{};
+  bool closed_{};
+
+  // State queued until a winner is known, then replayed onto the winning connection.
+  std::list<ConnectionCallbacks*> callbacks_;
+  std::list<ReadFilterSharedPtr> pending_read_filters_;
+  std::list<WriteFilterSharedPtr> pending_write_filters_;
+  std::list<FilterSharedPtr> pending_filters_;
+  Buffer::OwnedImpl pending_write_data_;
+  uint32_t read_disable_count_{};
+  bool detect_early_close_{true};
+  bool initialize_read_filters_{};
+  Optional<bool> no_delay_;
+  Optional<uint32_t> buffer_limits_;
+  std::unique_ptr<ConnectionStats> connection_stats_;
+};
+
+} // namespace Network
+} // namespace Envoy
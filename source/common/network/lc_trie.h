@@ -0,0 +1,279 @@
+#pragma once
+
+#include <arpa/inet.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/exception.h"
+#include "envoy/network/address.h"
+
+#include "common/common/assert.h"
+#include "common/network/cidr_range.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A level compressed trie (LC-trie, Nilsson & Karlsson) mapping CIDR ranges to tags. The trie is
+ * built once at configuration load and is immutable afterwards, so it can be shared read-only
+ * across all workers. Lookups do longest-prefix style matching in a handful of cache lines:
+ * single child chains are path compressed (skip) and dense regions branch on several bits at once
+ * (branch), so the number of node hops is far below the address width even for large range sets.
+ *
+ * Nested ranges are supported; a lookup returns the tags of every range containing the address.
+ * This is implemented by pushing the tags of enclosing ranges down to the disjoint leaves they
+ * cover during construction, trading some build time memory for branchless lookups.
+ */
+template <class T> class LcTrie {
+public:
+  /**
+   * @param tag_data supplies a vector of (tag, CIDR ranges) pairs to index. Both IPv4 and IPv6
+   *        ranges are supported; an invalid range throws EnvoyException.
+   */
+  LcTrie(const std::vector<std::pair<T, std::vector<Address::CidrRange>>>& tag_data) {
+    std::vector<typename Trie<uint32_t, 32>::Prefix> ipv4_prefixes;
+    std::vector<typename Trie<Uint128, 128>::Prefix> ipv6_prefixes;
+    for (const auto& entry : tag_data) {
+      for (const Address::CidrRange& range : entry.second) {
+        if (!range.isValid()) {
+          throw EnvoyException(fmt::format("invalid CIDR range for tag '{}'", entry.first));
+        }
+        if (range.version() == Address::IpVersion::v4) {
+          ipv4_prefixes.push_back({ntohl(range.ipv4()->address()),
+                                   static_cast<uint32_t>(range.length()), entry.first});
+        } else {
+          ipv6_prefixes.push_back(
+              {toUint128(range.ipv6()->address()), static_cast<uint32_t>(range.length()),
+               entry.first});
+        }
+      }
+    }
+    ipv4_trie_.build(ipv4_prefixes);
+    ipv6_trie_.build(ipv6_prefixes);
+  }
+
+  /**
+   * @return the tags of every range containing the address. Empty if the address matches nothing
+   *         or is not an IP address.
+   */
+  std::vector<T> getTags(const Address::Instance& address) const {
+    if (address.ip() == nullptr) {
+      return {};
+    }
+    if (address.ip()->version() == Address::IpVersion::v4) {
+      return ipv4_trie_.getTags(ntohl(address.ip()->ipv4()->address()));
+    }
+    return ipv6_trie_.getTags(toUint128(address.ip()->ipv6()->address()));
+  }
+
+private:
+  typedef unsigned __int128 Uint128;
+
+  static Uint128 toUint128(const std::array<uint8_t, 16>& bytes) {
+    Uint128 result = 0;
+    for (uint8_t byte : bytes) {
+      result = (result << 8) | byte;
+    }
+    return result;
+  }
+
+  /**
+   * The trie over a single address family. IntType holds addresses in host order so that bit 0 is
+   * the most significant bit of the address.
+   */
+  template <class IntType, uint32_t MAX_BITS> class Trie {
+  public:
+    struct Prefix {
+      IntType value_;
+      uint32_t length_;
+      T tag_;
+    };
+
+    void build(const std::vector<Prefix>& prefixes) {
+      if (prefixes.empty()) {
+        return;
+      }
+
+      // Build an uncompressed binary trie with each prefix's tag at its node.
+      binary_nodes_.emplace_back();
+      for (const Prefix& prefix : prefixes) {
+        int32_t node = 0;
+        for (uint32_t i = 0; i < prefix.length_; i++) {
+          const uint32_t bit = static_cast<uint32_t>(prefix.value_ >> (MAX_BITS - 1 - i)) & 1;
+          if (binary_nodes_[node].children_[bit] == -1) {
+            binary_nodes_[node].children_[bit] = binary_nodes_.size();
+            binary_nodes_.emplace_back();
+          }
+          node = binary_nodes_[node].children_[bit];
+        }
+        binary_nodes_[node].tags_.push_back(prefix.tag_);
+      }
+
+      // Push tags down so that only disjoint leaves carry answers, then level compress. The
+      // binary trie is only needed during construction.
+      pushDown(0, std::vector<T>());
+      nodes_.emplace_back();
+      compress(0, 0, 0, 0);
+      binary_nodes_.clear();
+      binary_nodes_.shrink_to_fit();
+    }
+
+    std::vector<T> getTags(IntType address) const {
+      if (nodes_.empty()) {
+        return {};
+      }
+
+      const Node* node = &nodes_[0];
+      uint32_t position = 0;
+      while (node->branch_ != 0) {
+        position += node->skip_;
+        const uint32_t branch = node->branch_;
+        node = &nodes_[node->index_ + extractBits(address, position, branch)];
+        position += branch;
+      }
+
+      // Bits skipped during the descent were not compared, so verify the leaf's full prefix.
+      const Leaf& leaf = leaves_[node->index_];
+      if (leaf.length_ == 0 || ((address ^ leaf.value_) >> (MAX_BITS - leaf.length_)) == 0) {
+        return leaf.tags_;
+      }
+      return {};
+    }
+
+  private:
+    struct BinaryNode {
+      int32_t children_[2]{-1, -1};
+      std::vector<T> tags_;
+    };
+
+    struct Node {
+      uint32_t branch_{};
+      uint32_t skip_{};
+      uint32_t index_{};
+    };
+
+    struct Leaf {
+      IntType value_;
+      uint32_t length_;
+      std::vector<T> tags_;
+    };
+
+    static uint32_t extractBits(IntType address, uint32_t position, uint32_t bits) {
+      return static_cast<uint32_t>((address << position) >> (MAX_BITS - bits));
+    }
+
+    /**
+     * Pushes the tags of enclosing prefixes down to the leaves they cover. Internal nodes with
+     * tags grow a leaf child on any missing side so that every covered address terminates at a
+     * leaf carrying the tags of all of its enclosing prefixes.
+     */
+    void pushDown(int32_t node_index, std::vector<T> inherited) {
+      std::vector<T> merged = std::move(inherited);
+      merged.insert(merged.end(), binary_nodes_[node_index].tags_.begin(),
+                    binary_nodes_[node_index].tags_.end());
+
+      if (binary_nodes_[node_index].children_[0] == -1 &&
+          binary_nodes_[node_index].children_[1] == -1) {
+        binary_nodes_[node_index].tags_ = std::move(merged);
+        return;
+      }
+
+      binary_nodes_[node_index].tags_.clear();
+      for (uint32_t bit = 0; bit < 2; bit++) {
+        if (!merged.empty() && binary_nodes_[node_index].children_[bit] == -1) {
+          binary_nodes_[node_index].children_[bit] = binary_nodes_.size();
+          binary_nodes_.emplace_back();
+        }
+        const int32_t child = binary_nodes_[node_index].children_[bit];
+        if (child != -1) {
+          pushDown(child, merged);
+        }
+      }
+    }
+
+    /**
+     * @return whether every node in the first 'levels' levels below node_index exists, i.e. the
+     * subtree is complete and can be collapsed into one multi-bit branch.
+     */
+    bool isComplete(int32_t node_index, uint32_t levels) const {
+      if (levels == 0) {
+        return true;
+      }
+      const int32_t left = binary_nodes_[node_index].children_[0];
+      const int32_t right = binary_nodes_[node_index].children_[1];
+      return left != -1 && right != -1 && isComplete(left, levels - 1) &&
+             isComplete(right, levels - 1);
+    }
+
+    /**
+     * Emits the compressed node for the binary subtree at node_index into nodes_[out_index].
+     * 'value' and 'depth' track the address bits of the path taken so far, which become the
+     * leaf's stored prefix for verification at lookup time.
+     */
+    void compress(int32_t node_index, uint32_t out_index, IntType value, uint32_t depth) {
+      // Path compression: count single child chains into the skip field.
+      uint32_t skip = 0;
+      while (true) {
+        const int32_t left = binary_nodes_[node_index].children_[0];
+        const int32_t right = binary_nodes_[node_index].children_[1];
+        if (left != -1 && right != -1) {
+          break;
+        }
+        if (left == -1 && right == -1) {
+          nodes_[out_index].branch_ = 0;
+          nodes_[out_index].skip_ = skip;
+          nodes_[out_index].index_ = leaves_.size();
+          leaves_.push_back(Leaf{value, depth, std::move(binary_nodes_[node_index].tags_)});
+          return;
+        }
+        const uint32_t bit = left != -1 ? 0 : 1;
+        if (bit == 1) {
+          value |= IntType(1) << (MAX_BITS - 1 - depth);
+        }
+        node_index = binary_nodes_[node_index].children_[bit];
+        depth++;
+        skip++;
+      }
+
+      // Level compression: branch on the largest number of bits whose subtree is complete.
+      uint32_t branch = 1;
+      while (depth + branch < MAX_BITS && isComplete(node_index, branch + 1)) {
+        branch++;
+      }
+
+      const uint32_t first_child = nodes_.size();
+      nodes_[out_index].branch_ = branch;
+      nodes_[out_index].skip_ = skip;
+      nodes_[out_index].index_ = first_child;
+      nodes_.resize(nodes_.size() + (1u << branch));
+      for (uint32_t path = 0; path < (1u << branch); path++) {
+        int32_t child = node_index;
+        IntType child_value = value;
+        for (uint32_t i = 0; i < branch; i++) {
+          const uint32_t bit = (path >> (branch - 1 - i)) & 1;
+          if (bit == 1) {
+            child_value |= IntType(1) << (MAX_BITS - 1 - (depth + i));
+          }
+          child = binary_nodes_[child].children_[bit];
+        }
+        compress(child, first_child + path, child_value, depth + branch);
+      }
+    }
+
+    std::vector<BinaryNode> binary_nodes_;
+    std::vector<Node> nodes_;
+    std::vector<Leaf> leaves_;
+  };
+
+  Trie<uint32_t, 32> ipv4_trie_;
+  Trie<Uint128, 128> ipv6_trie_;
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/network/listen_socket_impl.h"
 
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -30,7 +31,8 @@ void ListenSocketImpl::doBind() {
   }
 }
 
-TcpListenSocket::TcpListenSocket(Address::InstanceConstSharedPtr address, bool bind_to_port) {
+TcpListenSocket::TcpListenSocket(Address::InstanceConstSharedPtr address, bool bind_to_port,
+                                 const TcpListenSocketOptions& options) {
   local_address_ = address;
   fd_ = local_address_->socket(Address::SocketType::Stream);
   RELEASE_ASSERT(fd_ != -1);
@@ -39,6 +41,43 @@ TcpListenSocket::TcpListenSocket(Address::InstanceConstSharedPtr address, bool b
   int rc = setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
   RELEASE_ASSERT(rc != -1);
 
+  if (options.reuse_port_) {
+    // SO_REUSEPORT allows multiple sockets to bind the same address, each with a private accept
+    // queue that the kernel load balances new connections across.
+    rc = setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+    RELEASE_ASSERT(rc != -1);
+  }
+
+  if (options.tcp_fastopen_queue_length_ > 0) {
+#ifdef TCP_FASTOPEN
+    int qlen = options.tcp_fastopen_queue_length_;
+    rc = setsockopt(fd_, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen));
+    if (rc == -1) {
+      close();
+      throw EnvoyException(fmt::format("cannot enable TCP Fast Open on '{}': {}",
+                                       local_address_->asString(), strerror(errno)));
+    }
+#else
+    close();
+    throw EnvoyException("TCP Fast Open is not supported on this platform");
+#endif
+  }
+
+  if (options.defer_accept_timeout_seconds_ > 0) {
+#ifdef TCP_DEFER_ACCEPT
+    int timeout = options.defer_accept_timeout_seconds_;
+    rc = setsockopt(fd_, IPPROTO_TCP, TCP_DEFER_ACCEPT, &timeout, sizeof(timeout));
+    if (rc == -1) {
+      close();
+      throw EnvoyException(fmt::format("cannot enable TCP_DEFER_ACCEPT on '{}': {}",
+                                       local_address_->asString(), strerror(errno)));
+    }
+#else
+    close();
+    throw EnvoyException("TCP_DEFER_ACCEPT is not supported on this platform");
+#endif
+  }
+
   if (bind_to_port) {
     doBind();
   }
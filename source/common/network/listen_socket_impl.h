@@ -34,12 +34,30 @@ protected:
   Address::InstanceConstSharedPtr local_address_;
 };
 
+/**
+ * Socket options applied to TCP listen sockets at creation time, before they are bound.
+ */
+struct TcpListenSocketOptions {
+  // Bind a private socket with SO_REUSEPORT so multiple sockets can share the address, each with
+  // its own accept queue that the kernel load balances new connections across.
+  bool reuse_port_{};
+  // When non-zero, enable TCP Fast Open with this SYN backlog queue length so that data carried
+  // on a SYN from a client with a valid TFO cookie is delivered without waiting for the
+  // handshake to complete.
+  uint32_t tcp_fastopen_queue_length_{};
+  // When non-zero, enable TCP_DEFER_ACCEPT with this timeout in seconds so that the kernel only
+  // signals the socket readable once the first data segment arrives, instead of on the bare
+  // handshake completion.
+  uint32_t defer_accept_timeout_seconds_{};
+};
+
 /**
  * Wraps a unix socket.
  */
 class TcpListenSocket : public ListenSocketImpl {
 public:
-  TcpListenSocket(Address::InstanceConstSharedPtr address, bool bind_to_port);
+  TcpListenSocket(Address::InstanceConstSharedPtr address, bool bind_to_port,
+                  const TcpListenSocketOptions& options = TcpListenSocketOptions());
   TcpListenSocket(int fd, Address::InstanceConstSharedPtr address);
 };
 
@@ -1,6 +1,8 @@
 #include "common/network/listener_impl.h"
 
+#include <sys/ioctl.h>
 #include <sys/un.h>
+#include <unistd.h>
 
 #include "envoy/common/exception.h"
 #include "envoy/network/connection_handler.h"
@@ -19,6 +21,13 @@
 namespace Envoy {
 namespace Network {
 
+namespace {
+// Number of accept tokens a worker pulls from the shared budget at a time. Small batches keep
+// shared bucket contention to one lock acquisition per batch while bounding how many tokens can
+// sit unused in an idle worker's local bucket.
+constexpr uint32_t AcceptTokenBatchSize = 8;
+} // namespace
+
 Address::InstanceConstSharedPtr ListenerImpl::getLocalAddress(int fd) {
   return Address::addressFromFd(fd);
 }
@@ -30,6 +39,28 @@ Address::InstanceConstSharedPtr ListenerImpl::getOriginalDst(int fd) {
 void ListenerImpl::listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr* remote_addr,
                                   int remote_addr_len, void* arg) {
   ListenerImpl* listener = static_cast<ListenerImpl*>(arg);
+
+  // Shed accept pressure before doing any other work on the socket: a connection rejected here
+  // costs one accept and one close rather than a TLS handshake and filter chain setup. The
+  // kernel has already completed the TCP handshake, so the peer sees a connect followed by an
+  // immediate close and can back off and retry.
+  if (listener->options_.accept_rate_limiter_ != nullptr && !listener->tryAcquireAcceptToken()) {
+    listener->accepts_limited_.inc();
+    ::close(fd);
+    return;
+  }
+
+  // With TCP_DEFER_ACCEPT the kernel only hands over a connection once data arrives, so an
+  // empty socket here means the defer timeout expired without the client ever sending anything
+  // (port scanners, bare probes). Connections the kernel dropped in the deferred state never
+  // reach userspace, so this counter is the visible measure of junk accepts.
+  if (listener->options_.deferred_accept_) {
+    int bytes_ready = 0;
+    if (ioctl(fd, FIONREAD, &bytes_ready) == 0 && bytes_ready == 0) {
+      listener->deferred_accepts_no_data_.inc();
+    }
+  }
+
   Address::InstanceConstSharedPtr final_local_address = listener->socket_.localAddress();
   bool using_original_dst = false;
 
@@ -63,33 +94,79 @@ void ListenerImpl::listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr*
     }
   }
 
-  if (listener->options_.use_proxy_proto_) {
-    listener->proxy_protocol_.newConnection(listener->dispatcher_, fd, *listener);
+  Address::InstanceConstSharedPtr final_remote_address;
+  if (remote_addr->sa_family == AF_UNIX) {
+    // The accept() call that filled in remote_addr doesn't fill in more than the sa_family field
+    // for Unix domain sockets; apparently there isn't a mechanism in the kernel to get the
+    // sockaddr_un associated with the client socket when starting from the server socket.
+    // We work around this by using our own name for the socket in this case.
+    final_remote_address = Address::peerAddressFromFd(fd);
   } else {
-    Address::InstanceConstSharedPtr final_remote_address;
-    if (remote_addr->sa_family == AF_UNIX) {
-      // The accept() call that filled in remote_addr doesn't fill in more than the sa_family field
-      // for Unix domain sockets; apparently there isn't a mechanism in the kernel to get the
-      // sockaddr_un associated with the client socket when starting from the server socket.
-      // We work around this by using our own name for the socket in this case.
-      final_remote_address = Address::peerAddressFromFd(fd);
-    } else {
-      final_remote_address = Address::addressFromSockAddr(
-          *reinterpret_cast<const sockaddr_storage*>(remote_addr), remote_addr_len);
+    final_remote_address = Address::addressFromSockAddr(
+        *reinterpret_cast<const sockaddr_storage*>(remote_addr), remote_addr_len);
+  }
+
+  // When a connection balancer is configured, ask it which worker's listener should take the
+  // connection before any of the connection machinery is built. Everything done so far only
+  // touches the fd, so the socket can still be handed to another thread.
+  if (listener->options_.connection_balancer_ != nullptr) {
+    BalancedConnectionHandler& target =
+        listener->options_.connection_balancer_->pickTargetHandler(*listener);
+    if (&target != static_cast<BalancedConnectionHandler*>(listener)) {
+      target.post(fd, final_remote_address, final_local_address, using_original_dst);
+      return;
     }
+  }
+
+  listener->dispatchNewConnection(fd, final_remote_address, final_local_address,
+                                  using_original_dst);
+}
+
+void ListenerImpl::dispatchNewConnection(int fd, Address::InstanceConstSharedPtr remote_address,
+                                         Address::InstanceConstSharedPtr local_address,
+                                         bool using_original_dst) {
+  if (options_.use_proxy_proto_) {
+    proxy_protocol_.newConnection(dispatcher_, fd, *this);
+  } else {
     // TODO(jamessynge): We need to keep per-family stats. BUT, should it be based on the original
     // family or the local family? Probably local family, as the original proxy can take care of
     // stats for the original family.
-    listener->newConnection(fd, final_remote_address, final_local_address, using_original_dst);
+    newConnection(fd, remote_address, local_address, using_original_dst);
   }
 }
 
+void ListenerImpl::post(int fd, Address::InstanceConstSharedPtr remote_address,
+                        Address::InstanceConstSharedPtr local_address, bool using_original_dst) {
+  ++pending_handoffs_;
+
+  // The listener is deliberately not captured: it may be stopped or removed on its own thread
+  // while the handoff is in flight, so once we are running on its thread it is looked up again
+  // by address, the same way redirected original destination connections are. Both the lookup
+  // and any listener teardown run on the dispatcher's thread, so if the listener is found it is
+  // safe to use.
+  ConnectionHandler* connection_handler = &connection_handler_;
+  dispatcher_.post(
+      [connection_handler, fd, remote_address, local_address, using_original_dst]() -> void {
+        ListenerImpl* listener =
+            dynamic_cast<ListenerImpl*>(connection_handler->findListenerByAddress(*local_address));
+        if (listener == nullptr) {
+          ::close(fd);
+          return;
+        }
+
+        --listener->pending_handoffs_;
+        listener->dispatchNewConnection(fd, remote_address, local_address, using_original_dst);
+      });
+}
+
 ListenerImpl::ListenerImpl(Network::ConnectionHandler& conn_handler,
                            Event::DispatcherImpl& dispatcher, ListenSocket& socket,
                            ListenerCallbacks& cb, Stats::Scope& scope,
                            const Network::ListenerOptions& listener_options)
     : connection_handler_(conn_handler), dispatcher_(dispatcher), socket_(socket), cb_(cb),
-      proxy_protocol_(scope), options_(listener_options), listener_(nullptr) {
+      proxy_protocol_(scope), options_(listener_options), listener_(nullptr),
+      accepts_limited_(scope.counter("downstream_cx_accept_limited")),
+      deferred_accepts_no_data_(scope.counter("downstream_cx_deferred_accept_no_data")) {
 
   if (options_.bind_to_port_) {
     listener_.reset(
@@ -102,6 +179,42 @@ ListenerImpl::ListenerImpl(Network::ConnectionHandler& conn_handler,
 
     evconnlistener_set_error_cb(listener_.get(), errorCallback);
   }
+
+  if (options_.connection_balancer_ != nullptr) {
+    options_.connection_balancer_->registerHandler(*this);
+  }
+}
+
+ListenerImpl::~ListenerImpl() {
+  if (options_.connection_balancer_ != nullptr) {
+    options_.connection_balancer_->unregisterHandler(*this);
+  }
+}
+
+void ListenerImpl::disable() {
+  // Listeners that do not bind to a port (e.g. original dst forwarding targets) have no
+  // evconnlistener to pause.
+  if (listener_ != nullptr) {
+    evconnlistener_disable(listener_.get());
+  }
+}
+
+void ListenerImpl::enable() {
+  if (listener_ != nullptr) {
+    evconnlistener_enable(listener_.get());
+  }
+}
+
+bool ListenerImpl::tryAcquireAcceptToken() {
+  if (local_accept_tokens_ == 0) {
+    local_accept_tokens_ = options_.accept_rate_limiter_->take(AcceptTokenBatchSize);
+    if (local_accept_tokens_ == 0) {
+      return false;
+    }
+  }
+
+  local_accept_tokens_--;
+  return true;
 }
 
 void ListenerImpl::errorCallback(evconnlistener*, void*) {
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
+
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/listener.h"
+#include "envoy/stats/stats.h"
 
 #include "common/event/dispatcher_impl.h"
 #include "common/event/libevent.h"
@@ -16,11 +20,23 @@ namespace Network {
 /**
  * libevent implementation of Network::Listener.
  */
-class ListenerImpl : public Listener {
+class ListenerImpl : public Listener, public BalancedConnectionHandler {
 public:
   ListenerImpl(Network::ConnectionHandler& conn_handler, Event::DispatcherImpl& dispatcher,
                ListenSocket& socket, ListenerCallbacks& cb, Stats::Scope& scope,
                const ListenerOptions& listener_options);
+  ~ListenerImpl();
+
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() override {
+    return connection_handler_.numConnections() + pending_handoffs_;
+  }
+  void post(int fd, Address::InstanceConstSharedPtr remote_address,
+            Address::InstanceConstSharedPtr local_address, bool using_original_dst) override;
+
+  // Network::Listener
+  void disable() override;
+  void enable() override;
 
   /**
    * Accept/process a new connection.
@@ -41,6 +57,14 @@ protected:
   virtual Address::InstanceConstSharedPtr getLocalAddress(int fd);
   virtual Address::InstanceConstSharedPtr getOriginalDst(int fd);
 
+  /**
+   * Finish accepting a connection on this listener's thread, either via the proxy protocol
+   * reader or by building the connection directly.
+   */
+  void dispatchNewConnection(int fd, Address::InstanceConstSharedPtr remote_address,
+                             Address::InstanceConstSharedPtr local_address,
+                             bool using_original_dst);
+
   Network::ConnectionHandler& connection_handler_;
   Event::DispatcherImpl& dispatcher_;
   ListenSocket& socket_;
@@ -53,7 +77,23 @@ private:
   static void listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr* remote_addr,
                              int remote_addr_len, void* arg);
 
+  /**
+   * Attempt to take an accept token from the worker local bucket, pulling a fresh batch from
+   * the shared budget when the local bucket is empty. Only called when an accept rate limiter
+   * is configured.
+   * @return bool whether a token was available.
+   */
+  bool tryAcquireAcceptToken();
+
   Event::Libevent::ListenerPtr listener_;
+  Stats::Counter& accepts_limited_;
+  Stats::Counter& deferred_accepts_no_data_;
+  // Accept tokens already pulled from the shared budget and owned by this worker's listener.
+  uint32_t local_accept_tokens_{};
+  // Accepted sockets handed to this listener by a connection balancer but not yet picked up by
+  // this listener's thread. These are counted so that the balancer sees them as load as soon as
+  // the handoff is posted.
+  std::atomic<uint64_t> pending_handoffs_{};
 };
 
 class SslListenerImpl : public ListenerImpl {
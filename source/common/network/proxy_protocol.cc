@@ -1,8 +1,10 @@
 #include "common/network/proxy_protocol.h"
 
+#include <netinet/in.h>
 #include <unistd.h>
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -20,6 +22,24 @@
 namespace Envoy {
 namespace Network {
 
+namespace {
+
+// The 12 byte signature that starts every v2 binary header. The first byte differs from the 'P'
+// that starts a v1 text line, so the version can be decided from the first mismatching byte.
+const uint8_t PROXY_PROTO_V2_SIGNATURE[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d,
+                                            0x0a, 0x51, 0x55, 0x49, 0x54, 0x0a};
+
+// v2 version/command byte: upper nibble is the version, lower nibble is the command.
+const uint8_t PROXY_PROTO_V2_VERSION = 0x20;
+const uint8_t PROXY_PROTO_V2_LOCAL = 0x00;
+const uint8_t PROXY_PROTO_V2_PROXY = 0x01;
+
+// v2 address family/transport byte for TCP over IPv4 and IPv6.
+const uint8_t PROXY_PROTO_V2_AF_INET = 0x11;
+const uint8_t PROXY_PROTO_V2_AF_INET6 = 0x21;
+
+} // namespace
+
 ProxyProtocol::ProxyProtocol(Stats::Scope& scope)
     : stats_{ALL_PROXY_PROTOCOL_STATS(POOL_COUNTER(scope))} {}
 
@@ -58,9 +78,153 @@ void ProxyProtocol::ActiveConnection::onRead() {
 }
 
 void ProxyProtocol::ActiveConnection::onReadWorker() {
+  if (header_version_ == HeaderVersion::Unknown && !detectHeaderVersion()) {
+    return;
+  }
+
+  Address::InstanceConstSharedPtr remote_address;
+  Address::InstanceConstSharedPtr local_address;
+  if (header_version_ == HeaderVersion::V2) {
+    if (!parseV2Header(remote_address, local_address)) {
+      return;
+    }
+  } else {
+    if (!parseV1Header(remote_address, local_address)) {
+      return;
+    }
+  }
+
+  // Check that both addresses are valid unicast addresses, as required for TCP
+  if (!remote_address->ip()->isUnicastAddress() || !local_address->ip()->isUnicastAddress()) {
+    throw EnvoyException("failed to read proxy protocol");
+  }
+  ListenerImpl& listener = listener_;
+  int fd = fd_;
+  fd_ = -1;
+
+  removeFromList(parent_.connections_);
+
+  listener.newConnection(fd, remote_address, local_address, true);
+}
+
+bool ProxyProtocol::ActiveConnection::detectHeaderVersion() {
+  // A single peek serves both versions: the v2 signature starts with '\r' while a v1 line starts
+  // with 'P', so the first byte that differs from the signature selects v1.
+  const ssize_t nread = recv(fd_, buf_, V2_SIGNATURE_LEN, MSG_PEEK);
+  if (nread == -1 && errno == EAGAIN) {
+    return false;
+  } else if (nread < 1) {
+    throw EnvoyException("failed to read proxy protocol");
+  }
+
+  // At most V2_SIGNATURE_LEN bytes were requested, so nread bytes of the signature can be
+  // compared directly.
+  if (memcmp(buf_, PROXY_PROTO_V2_SIGNATURE, nread) == 0) {
+    if (static_cast<size_t>(nread) < V2_SIGNATURE_LEN) {
+      // All of the bytes seen so far match the signature; wait for the rest of it.
+      return false;
+    }
+    header_version_ = HeaderVersion::V2;
+  } else {
+    header_version_ = HeaderVersion::V1;
+  }
+  return true;
+}
+
+bool ProxyProtocol::ActiveConnection::parseV2Header(
+    Address::InstanceConstSharedPtr& remote_address,
+    Address::InstanceConstSharedPtr& local_address) {
+  // Peek at as much of the header as has arrived so that in the common case the fixed header and
+  // the address block are parsed in place out of a single read.
+  ssize_t nread = recv(fd_, buf_, MAX_PROXY_PROTO_LEN, MSG_PEEK);
+  if (nread == -1 && errno == EAGAIN) {
+    return false;
+  } else if (nread < 1) {
+    throw EnvoyException("failed to read proxy protocol");
+  } else if (static_cast<size_t>(nread) < V2_HEADER_LEN) {
+    return false;
+  }
+
+  const uint8_t* buf = reinterpret_cast<const uint8_t*>(buf_);
+  if ((buf[12] & 0xf0) != PROXY_PROTO_V2_VERSION) {
+    throw EnvoyException("failed to read proxy protocol");
+  }
+  const uint8_t command = buf[12] & 0x0f;
+  const uint8_t address_family = buf[13];
+  const size_t addr_len = (static_cast<size_t>(buf[14]) << 8) | buf[15];
+  const size_t header_len = V2_HEADER_LEN + addr_len;
+  if (header_len > MAX_PROXY_PROTO_LEN) {
+    // More TLV data than we are willing to buffer.
+    throw EnvoyException("failed to read proxy protocol");
+  }
+  if (static_cast<size_t>(nread) < header_len) {
+    return false;
+  }
+
+  if (command == PROXY_PROTO_V2_PROXY) {
+    const uint8_t* addr = buf + V2_HEADER_LEN;
+    if (address_family == PROXY_PROTO_V2_AF_INET) {
+      if (addr_len < V2_ADDR_LEN_INET) {
+        throw EnvoyException("failed to read proxy protocol");
+      }
+      sockaddr_in remote_sockaddr;
+      sockaddr_in local_sockaddr;
+      memset(&remote_sockaddr, 0, sizeof(remote_sockaddr));
+      memset(&local_sockaddr, 0, sizeof(local_sockaddr));
+      remote_sockaddr.sin_family = AF_INET;
+      local_sockaddr.sin_family = AF_INET;
+      // Addresses and ports are already in network byte order.
+      memcpy(&remote_sockaddr.sin_addr.s_addr, addr, 4);
+      memcpy(&local_sockaddr.sin_addr.s_addr, addr + 4, 4);
+      memcpy(&remote_sockaddr.sin_port, addr + 8, 2);
+      memcpy(&local_sockaddr.sin_port, addr + 10, 2);
+      remote_address.reset(new Address::Ipv4Instance(&remote_sockaddr));
+      local_address.reset(new Address::Ipv4Instance(&local_sockaddr));
+    } else if (address_family == PROXY_PROTO_V2_AF_INET6) {
+      if (addr_len < V2_ADDR_LEN_INET6) {
+        throw EnvoyException("failed to read proxy protocol");
+      }
+      sockaddr_in6 remote_sockaddr;
+      sockaddr_in6 local_sockaddr;
+      memset(&remote_sockaddr, 0, sizeof(remote_sockaddr));
+      memset(&local_sockaddr, 0, sizeof(local_sockaddr));
+      remote_sockaddr.sin6_family = AF_INET6;
+      local_sockaddr.sin6_family = AF_INET6;
+      memcpy(&remote_sockaddr.sin6_addr, addr, 16);
+      memcpy(&local_sockaddr.sin6_addr, addr + 16, 16);
+      memcpy(&remote_sockaddr.sin6_port, addr + 32, 2);
+      memcpy(&local_sockaddr.sin6_port, addr + 34, 2);
+      remote_address.reset(new Address::Ipv6Instance(remote_sockaddr));
+      local_address.reset(new Address::Ipv6Instance(local_sockaddr));
+    } else {
+      // Only TCP over IPv4 and IPv6 is supported.
+      throw EnvoyException("failed to read proxy protocol");
+    }
+  } else if (command != PROXY_PROTO_V2_LOCAL) {
+    throw EnvoyException("failed to read proxy protocol");
+  }
+
+  // Consume the entire header, including any TLV data beyond the address block, but nothing past
+  // it. This should never fail as only bytes already seen above are requested.
+  nread = recv(fd_, buf_, header_len, 0);
+  ASSERT(static_cast<size_t>(nread) == header_len);
+  UNREFERENCED_PARAMETER(nread);
+
+  if (command == PROXY_PROTO_V2_LOCAL) {
+    // LOCAL connections (e.g. load balancer health checks) carry no address information; use the
+    // addresses of the connection itself.
+    remote_address = Address::peerAddressFromFd(fd_);
+    local_address = Address::addressFromFd(fd_);
+  }
+  return true;
+}
+
+bool ProxyProtocol::ActiveConnection::parseV1Header(
+    Address::InstanceConstSharedPtr& remote_address,
+    Address::InstanceConstSharedPtr& local_address) {
   std::string proxy_line;
   if (!readLine(fd_, proxy_line)) {
-    return;
+    return false;
   }
 
   // Remove the line feed at the end
@@ -75,8 +239,6 @@ void ProxyProtocol::ActiveConnection::onReadWorker() {
   }
 
   Address::IpVersion protocol_version;
-  Address::InstanceConstSharedPtr remote_address;
-  Address::InstanceConstSharedPtr local_address;
   if (line_parts[1] == "TCP4") {
     protocol_version = Address::IpVersion::v4;
     remote_address = Utility::parseInternetAddressAndPort(line_parts[2] + ":" + line_parts[4]);
@@ -100,17 +262,7 @@ void ProxyProtocol::ActiveConnection::onReadWorker() {
   if (remote_version != protocol_version || local_version != protocol_version) {
     throw EnvoyException("failed to read proxy protocol");
   }
-  // Check that both addresses are valid unicast addresses, as required for TCP
-  if (!remote_address->ip()->isUnicastAddress() || !local_address->ip()->isUnicastAddress()) {
-    throw EnvoyException("failed to read proxy protocol");
-  }
-  ListenerImpl& listener = listener_;
-  int fd = fd_;
-  fd_ = -1;
-
-  removeFromList(parent_.connections_);
-
-  listener.newConnection(fd, remote_address, local_address, true);
+  return true;
 }
 
 void ProxyProtocol::ActiveConnection::close() {
@@ -120,8 +272,8 @@ void ProxyProtocol::ActiveConnection::close() {
 }
 
 bool ProxyProtocol::ActiveConnection::readLine(int fd, std::string& s) {
-  while (buf_off_ < MAX_PROXY_PROTO_LEN) {
-    ssize_t nread = recv(fd, buf_ + buf_off_, MAX_PROXY_PROTO_LEN - buf_off_, MSG_PEEK);
+  while (buf_off_ < MAX_V1_PROXY_PROTO_LEN) {
+    ssize_t nread = recv(fd, buf_ + buf_off_, MAX_V1_PROXY_PROTO_LEN - buf_off_, MSG_PEEK);
 
     if (nread == -1 && errno == EAGAIN) {
       return false;
@@ -5,6 +5,7 @@
 #include <string>
 
 #include "envoy/event/dispatcher.h"
+#include "envoy/network/address.h"
 #include "envoy/stats/stats_macros.h"
 
 #include "common/common/linked_object.h"
@@ -30,8 +31,10 @@ struct ProxyProtocolStats {
 };
 
 /**
- * Implementation the PROXY Protocol V1
- * (http://www.haproxy.org/download/1.5/doc/proxy-protocol.txt)
+ * Implementation of the PROXY Protocol, versions 1 (text) and 2 (binary)
+ * (http://www.haproxy.org/download/1.8/doc/proxy-protocol.txt). The version in use is detected
+ * from the first bytes of the connection and the header is parsed in place out of a single
+ * buffered read in the common case.
  */
 class ProxyProtocol {
 public:
@@ -42,17 +45,54 @@ public:
     ~ActiveConnection();
 
   private:
-    static const size_t MAX_PROXY_PROTO_LEN = 108;
+    enum class HeaderVersion { Unknown, V1, V2 };
+
+    // The longest v1 line ("PROXY " + addresses/ports + CRLF) is 107 bytes; allow one more so a
+    // line that is exactly at the limit but missing its line feed is detected as too long.
+    static const size_t MAX_V1_PROXY_PROTO_LEN = 108;
+    static const size_t V2_SIGNATURE_LEN = 12;
+    static const size_t V2_HEADER_LEN = 16;
+    static const size_t V2_ADDR_LEN_INET = 12;
+    static const size_t V2_ADDR_LEN_INET6 = 36;
+
+    // Large enough for any v1 line as well as a v2 header with a modest amount of trailing TLV
+    // data. Senders that attach more TLV data than this are rejected.
+    static const size_t MAX_PROXY_PROTO_LEN = 256;
 
     void onRead();
     void onReadWorker();
 
+    /**
+     * Peeks at the start of the connection and decides whether the header is a v1 text line or a
+     * v2 binary header. throws EnvoyException on any socket errors.
+     * @return bool true if the version was determined, false if more data is needed.
+     */
+    bool detectHeaderVersion();
+
     /**
      * Helper function that attempts to read a line (delimited by '\r\n') from the socket.
      * throws EnvoyException on any socket errors.
      * @return bool true if a line should be read, false if more data is needed.
      */
     bool readLine(int fd, std::string& s);
+
+    /**
+     * Parses a v1 text line into the advertised addresses. throws EnvoyException on socket errors
+     * or a malformed line.
+     * @return bool true if the header was consumed, false if more data is needed.
+     */
+    bool parseV1Header(Address::InstanceConstSharedPtr& remote_address,
+                       Address::InstanceConstSharedPtr& local_address);
+
+    /**
+     * Parses a v2 binary header in place out of a single peeked read, consuming the header
+     * (including any TLV data) exactly. throws EnvoyException on socket errors or a malformed
+     * header.
+     * @return bool true if the header was consumed, false if more data is needed.
+     */
+    bool parseV2Header(Address::InstanceConstSharedPtr& remote_address,
+                       Address::InstanceConstSharedPtr& local_address);
+
     void close();
 
     ProxyProtocol& parent_;
@@ -60,13 +100,16 @@ public:
     ListenerImpl& listener_;
     Event::FileEventPtr file_event_;
 
+    // The header version in use, once enough data has arrived to decide.
+    HeaderVersion header_version_{HeaderVersion::Unknown};
+
     // The offset in buf_ that has been fully read
     size_t buf_off_{};
 
     // The index in buf_ where the search for '\r\n' should continue from
     size_t search_index_;
 
-    // Stores the portion of the first line that has been read so far.
+    // Stores the portion of the header that has been read so far.
     char buf_[MAX_PROXY_PROTO_LEN];
   };
 
@@ -0,0 +1,173 @@
+#include "common/network/splicer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+bool Splicer::supported() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef __linux__
+
+Splicer::Splicer(Connection& downstream, Connection& upstream,
+                 Stats::Counter& downstream_rx_bytes_total,
+                 Stats::Counter& downstream_tx_bytes_total, ClosedCb closed_cb)
+    : closed_cb_(closed_cb),
+      downstream_to_upstream_(downstream, upstream, downstream_rx_bytes_total),
+      upstream_to_downstream_(upstream, downstream, downstream_tx_bytes_total) {
+  ASSERT(!downstream.readEnabled());
+  ASSERT(!upstream.readEnabled());
+  initializePipe(downstream_to_upstream_);
+  initializePipe(upstream_to_downstream_);
+
+  // Both events are edge triggered so they can stay registered for read and write without
+  // spinning on a writable socket. EOF surfaces as a readable event with splice() returning 0.
+  downstream_event_ = downstream.dispatcher().createFileEvent(
+      downstream.fd(),
+      [this](uint32_t events) -> void {
+        onReady(events, downstream_to_upstream_, upstream_to_downstream_);
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  upstream_event_ = upstream.dispatcher().createFileEvent(
+      upstream.fd(),
+      [this](uint32_t events) -> void {
+        onReady(events, upstream_to_downstream_, downstream_to_upstream_);
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+
+  // Data may already be waiting in the socket buffers (e.g., client data that arrived while the
+  // upstream connection was being established), so prime both directions. This is done via
+  // activation rather than inline so that a close during priming is delivered via closed_cb_
+  // after the owner has finished constructing us.
+  downstream_event_->activate(Event::FileReadyType::Read);
+  upstream_event_->activate(Event::FileReadyType::Read);
+}
+
+Splicer::~Splicer() {
+  for (Direction* direction : {&downstream_to_upstream_, &upstream_to_downstream_}) {
+    for (int fd : direction->pipe_fds_) {
+      if (fd != -1) {
+        ::close(fd);
+      }
+    }
+  }
+}
+
+void Splicer::initializePipe(Direction& direction) {
+  const int rc = pipe2(direction.pipe_fds_, O_NONBLOCK | O_CLOEXEC);
+  RELEASE_ASSERT(rc == 0);
+}
+
+void Splicer::onReady(uint32_t events, Direction& read_direction, Direction& write_direction) {
+  // A readable socket feeds one direction while a writable socket drains the other. pump()
+  // handles both halves so a single call per direction suffices.
+  if (events & Event::FileReadyType::Read) {
+    if (!pump(read_direction)) {
+      onClose();
+      return;
+    }
+  }
+
+  if (events & Event::FileReadyType::Write) {
+    if (!pump(write_direction)) {
+      onClose();
+      return;
+    }
+  }
+}
+
+bool Splicer::pump(Direction& direction) {
+  while (true) {
+    if (!flushPipe(direction)) {
+      return false;
+    }
+
+    if (direction.source_eof_) {
+      // Keep the session alive until the remaining piped data has been flushed to the
+      // destination, then tear it down.
+      return direction.queued_bytes_ > 0;
+    }
+
+    const ssize_t rc = splice(direction.source_.fd(), nullptr, direction.pipe_fds_[1], nullptr,
+                              SPLICE_SIZE, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (rc > 0) {
+      direction.queued_bytes_ += rc;
+    } else if (rc == 0) {
+      ENVOY_CONN_LOG(debug, "splice: source EOF", direction.source_);
+      direction.source_eof_ = true;
+    } else if (errno == EAGAIN) {
+      // Either the socket has no data or the pipe is full. In the latter case the destination's
+      // next writable event will drain the pipe and re-enter the pump.
+      return true;
+    } else {
+      ENVOY_CONN_LOG(debug, "splice: read error: {}", direction.source_, strerror(errno));
+      return false;
+    }
+  }
+}
+
+bool Splicer::flushPipe(Direction& direction) {
+  while (direction.queued_bytes_ > 0) {
+    const ssize_t rc = splice(direction.pipe_fds_[0], nullptr, direction.dest_.fd(), nullptr,
+                              direction.queued_bytes_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (rc > 0) {
+      direction.queued_bytes_ -= rc;
+      direction.bytes_total_.add(rc);
+    } else if (rc == -1 && errno == EAGAIN) {
+      // The destination's socket buffer is full. Wait for its writable event.
+      return true;
+    } else {
+      ENVOY_CONN_LOG(debug, "splice: write error: {}", direction.dest_, strerror(errno));
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Splicer::onClose() {
+  // Tear down our events before firing the callback since the owner will close the underlying
+  // fds, and the callback may defer delete us.
+  downstream_event_.reset();
+  upstream_event_.reset();
+  closed_cb_();
+}
+
+#else // !__linux__
+
+Splicer::Splicer(Connection& downstream, Connection& upstream,
+                 Stats::Counter& downstream_rx_bytes_total,
+                 Stats::Counter& downstream_tx_bytes_total, ClosedCb closed_cb)
+    : closed_cb_(closed_cb),
+      downstream_to_upstream_(downstream, upstream, downstream_rx_bytes_total),
+      upstream_to_downstream_(upstream, downstream, downstream_tx_bytes_total) {
+  NOT_IMPLEMENTED;
+}
+
+Splicer::~Splicer() {}
+
+void Splicer::initializePipe(Direction&) { NOT_IMPLEMENTED; }
+void Splicer::onReady(uint32_t, Direction&, Direction&) { NOT_IMPLEMENTED; }
+bool Splicer::pump(Direction&) { NOT_IMPLEMENTED; }
+bool Splicer::flushPipe(Direction&) { NOT_IMPLEMENTED; }
+void Splicer::onClose() { NOT_IMPLEMENTED; }
+
+#endif // __linux__
+
+} // namespace Network
+} // namespace Envoy
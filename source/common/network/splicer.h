@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/file_event.h"
+#include "envoy/network/connection.h"
+#include "envoy/stats/stats.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Moves bytes between two established connections entirely within the kernel using splice(2)
+ * and a pair of pipes, one per direction. This is only available on Linux. The caller must read
+ * disable both connections before constructing a Splicer so that no data flows through the
+ * normal userspace buffer path, and must destroy the Splicer before either connection closes
+ * its fd. Only raw TCP connections are supported (no TLS).
+ */
+class Splicer : public Event::DeferredDeletable, Logger::Loggable<Logger::Id::connection> {
+public:
+  /**
+   * Callback fired when the splicer observes EOF or a socket error on either side. Remaining
+   * piped data has already been flushed on a best effort basis; the owner should close both
+   * connections and destroy the splicer (via deferred delete since the callback is invoked from
+   * within the splicer's own event processing).
+   */
+  typedef std::function<void()> ClosedCb;
+
+  /**
+   * @return bool whether splice() based proxying is supported on this platform.
+   */
+  static bool supported();
+
+  /**
+   * @param downstream supplies the downstream connection. Both connections must be established
+   *        and read disabled.
+   * @param upstream supplies the upstream connection.
+   * @param downstream_rx_bytes_total supplies the counter to increment with bytes moved from the
+   *        downstream to the upstream connection.
+   * @param downstream_tx_bytes_total supplies the counter to increment with bytes moved from the
+   *        upstream to the downstream connection.
+   * @param closed_cb supplies the close callback described above.
+   */
+  Splicer(Connection& downstream, Connection& upstream, Stats::Counter& downstream_rx_bytes_total,
+          Stats::Counter& downstream_tx_bytes_total, ClosedCb closed_cb);
+  ~Splicer();
+
+private:
+  struct Direction {
+    Direction(Connection& source, Connection& dest, Stats::Counter& bytes_total)
+        : source_(source), dest_(dest), bytes_total_(bytes_total) {}
+
+    Connection& source_;
+    Connection& dest_;
+    Stats::Counter& bytes_total_;
+    int pipe_fds_[2]{-1, -1};
+    // Bytes currently held in the pipe waiting for the destination socket to accept them.
+    uint64_t queued_bytes_{};
+    bool source_eof_{};
+  };
+
+  // Maximum number of bytes moved by a single splice() call.
+  static const uint64_t SPLICE_SIZE = 65536;
+
+  void initializePipe(Direction& direction);
+  void onReady(uint32_t events, Direction& read_direction, Direction& write_direction);
+  bool pump(Direction& direction);
+  bool flushPipe(Direction& direction);
+  void onClose();
+
+  ClosedCb closed_cb_;
+  Direction downstream_to_upstream_;
+  Direction upstream_to_downstream_;
+  Event::FileEventPtr downstream_event_;
+  Event::FileEventPtr upstream_event_;
+};
+
+typedef std::unique_ptr<Splicer> SplicerPtr;
+
+} // namespace Network
+} // namespace Envoy
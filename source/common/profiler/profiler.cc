@@ -1,5 +1,6 @@
 #include "common/profiler/profiler.h"
 
+#include <cstdlib>
 #include <string>
 
 #ifdef TCMALLOC
@@ -18,11 +19,32 @@ bool Cpu::startProfiler(const std::string& output_path) {
 
 void Cpu::stopProfiler() { ProfilerStop(); }
 
-void Heap::forceLink() {
-  // Currently this is here to force the inclusion of the heap profiler during static linking.
-  // Without this call the heap profiler will not be included and cannot be started via env
-  // variable. In the future we can add admin support.
-  HeapProfilerDump("");
+bool Heap::profilerEnabled() { return IsHeapProfilerRunning(); }
+
+bool Heap::startProfiler(const std::string& output_path) {
+  if (IsHeapProfilerRunning()) {
+    return false;
+  }
+
+  HeapProfilerStart(output_path.c_str());
+  return true;
+}
+
+std::string Heap::profileDump() {
+  if (!IsHeapProfilerRunning()) {
+    return "";
+  }
+
+  char* profile = GetHeapProfile();
+  std::string output(profile);
+  free(profile);
+  return output;
+}
+
+void Heap::stopProfiler() {
+  if (IsHeapProfilerRunning()) {
+    HeapProfilerStop();
+  }
 }
 
 } // namespace Profiler
@@ -37,6 +59,11 @@ bool Cpu::profilerEnabled() { return false; }
 bool Cpu::startProfiler(const std::string&) { return false; }
 void Cpu::stopProfiler() {}
 
+bool Heap::profilerEnabled() { return false; }
+bool Heap::startProfiler(const std::string&) { return false; }
+std::string Heap::profileDump() { return ""; }
+void Heap::stopProfiler() {}
+
 } // namespace Profiler
 } // namespace Envoy
 
@@ -31,8 +31,28 @@ public:
  * Process wide heap profiling
  */
 class Heap {
-private:
-  static void forceLink();
+public:
+  /**
+   * @return whether the profiler is enabled or not.
+   */
+  static bool profilerEnabled();
+
+  /**
+   * Start the profiler. Dump files are written with the specified path as a prefix.
+   * @return bool whether the call to start the profiler succeeded.
+   */
+  static bool startProfiler(const std::string& output_path);
+
+  /**
+   * @return std::string the current heap profile, or an empty string if the profiler is not
+   *         running.
+   */
+  static std::string profileDump();
+
+  /**
+   * Stop the profiler.
+   */
+  static void stopProfiler();
 };
 
 } // namespace Profiler
@@ -50,9 +50,11 @@ public:
 
 class MessageUtil {
 public:
-  static std::size_t hash(const Protobuf::Message& message) {
-    // Use Protobuf::io::CodedOutputStream to force deterministic serialization, so that the same
-    // message doesn't hash to different values.
+  /**
+   * Serialize a message deterministically, so that the same message always produces the same
+   * bytes. Suitable as hash input or as a map key.
+   */
+  static ProtobufTypes::String deterministicSerialization(const Protobuf::Message& message) {
     ProtobufTypes::String text;
     {
       // For memory safety, the StringOutputStream needs to be destroyed before
@@ -62,7 +64,11 @@ public:
       coded_stream.SetSerializationDeterministic(true);
       message.SerializeToCodedStream(&coded_stream);
     }
-    return HashUtil::xxHash64(text);
+    return text;
+  }
+
+  static std::size_t hash(const Protobuf::Message& message) {
+    return HashUtil::xxHash64(deterministicSerialization(message));
   }
 
   static void loadFromJson(const std::string& json, Protobuf::Message& message);
@@ -1,5 +1,6 @@
 #include "common/ratelimit/ratelimit_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <string>
@@ -8,7 +9,7 @@
 #include "envoy/tracing/context.h"
 
 #include "common/common/assert.h"
-#include "common/common/empty_string.h"
+#include "common/common/utility.h"
 #include "common/grpc/async_client_impl.h"
 #include "common/http/headers.h"
 
@@ -17,88 +18,313 @@
 namespace Envoy {
 namespace RateLimit {
 
-GrpcClientImpl::GrpcClientImpl(RateLimitAsyncClientPtr&& async_client,
-                               const Optional<std::chrono::milliseconds>& timeout)
+namespace {
+
+// Over limit decisions are cached for at most this long, regardless of the unit of the limit
+// that fired, and the cache never holds more than this many descriptors.
+const std::chrono::seconds OVER_LIMIT_CACHE_MAX_TTL{5};
+const uint64_t OVER_LIMIT_CACHE_MAX_ENTRIES = 1000;
+
+Optional<std::chrono::seconds> overLimitTtl(pb::lyft::ratelimit::RateLimit_Unit unit) {
+  switch (unit) {
+  case pb::lyft::ratelimit::RateLimit_Unit_SECOND:
+    return std::chrono::seconds(1);
+  case pb::lyft::ratelimit::RateLimit_Unit_MINUTE:
+    return std::chrono::seconds(60);
+  case pb::lyft::ratelimit::RateLimit_Unit_HOUR:
+    return std::chrono::seconds(3600);
+  case pb::lyft::ratelimit::RateLimit_Unit_DAY:
+    return std::chrono::seconds(86400);
+  default:
+    return Optional<std::chrono::seconds>();
+  }
+}
+
+std::string overLimitCacheKey(const std::string& domain, const Descriptor& descriptor) {
+  std::string key = domain;
+  for (const DescriptorEntry& entry : descriptor.entries_) {
+    key.push_back('\0');
+    key.append(entry.key_);
+    key.push_back('\0');
+    key.append(entry.value_);
+  }
+  return key;
+}
+
+} // namespace
+
+GrpcBatcherImpl::GrpcBatcherImpl(RateLimitAsyncClientPtr&& async_client,
+                                 Event::Dispatcher& dispatcher, MonotonicTimeSource& time_source)
     : service_method_(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
           "pb.lyft.ratelimit.RateLimitService.ShouldRateLimit")),
-      async_client_(std::move(async_client)), timeout_(timeout) {}
+      async_client_(std::move(async_client)), time_source_(time_source),
+      batch_timer_(dispatcher.createTimer([this]() -> void { flush(); })) {}
 
-GrpcClientImpl::~GrpcClientImpl() { ASSERT(!callbacks_); }
+GrpcBatcherImpl::~GrpcBatcherImpl() {
+  // The batcher is torn down during thread local shutdown. Every filter stack was destroyed (and
+  // cancelled its check) first, but the RPCs that carried checks cancelled in flight may still be
+  // open.
+  for (ActiveBatchPtr& batch : active_batches_) {
+    if (batch->request_ != nullptr) {
+      batch->request_->cancel();
+    }
+  }
+}
 
-void GrpcClientImpl::cancel() {
-  ASSERT(callbacks_ != nullptr);
-  request_->cancel();
-  callbacks_ = nullptr;
+void GrpcBatcherImpl::limit(GrpcClientImpl& client, RequestCallbacks& callbacks,
+                            const std::string& domain, const std::vector<Descriptor>& descriptors,
+                            const Tracing::TransportContext& context) {
+  ASSERT(client.pending_check_ == nullptr);
+  if (isCachedOverLimit(domain, descriptors)) {
+    callbacks.complete(LimitStatus::OverLimit);
+    return;
+  }
+
+  if (pending_batches_.empty()) {
+    // Coalesce every check issued before control returns to the dispatcher into a single request
+    // per domain; a zero delay timer fires once the current iteration has drained.
+    batch_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+
+  std::vector<PendingCheckPtr>& batch = pending_batches_[domain];
+  batch.emplace_back(new PendingCheck(client, callbacks, descriptors, context, client.timeout_));
+  client.pending_check_ = batch.back().get();
 }
 
-void GrpcClientImpl::createRequest(pb::lyft::ratelimit::RateLimitRequest& request,
-                                   const std::string& domain,
-                                   const std::vector<Descriptor>& descriptors) {
-  request.set_domain(domain);
-  for (const Descriptor& descriptor : descriptors) {
-    pb::lyft::ratelimit::RateLimitDescriptor* new_descriptor = request.add_descriptors();
-    for (const DescriptorEntry& entry : descriptor.entries_) {
-      pb::lyft::ratelimit::RateLimitDescriptor::Entry* new_entry = new_descriptor->add_entries();
-      new_entry->set_key(entry.key_);
-      new_entry->set_value(entry.value_);
+void GrpcBatcherImpl::cancel(GrpcClientImpl& client) {
+  // The check is only detached here; if its batch is already on the wire the response still
+  // arrives and feeds the over limit cache.
+  ASSERT(client.pending_check_ != nullptr);
+  client.pending_check_->callbacks_ = nullptr;
+  client.pending_check_->client_ = nullptr;
+  client.pending_check_ = nullptr;
+}
+
+void GrpcBatcherImpl::flush() {
+  std::unordered_map<std::string, std::vector<PendingCheckPtr>> batches;
+  batches.swap(pending_batches_);
+  for (auto& domain_batch : batches) {
+    ActiveBatchPtr batch{new ActiveBatch(*this, domain_batch.first)};
+    pb::lyft::ratelimit::RateLimitRequest request;
+    Optional<std::chrono::milliseconds> timeout;
+    for (PendingCheckPtr& check : domain_batch.second) {
+      if (check->callbacks_ == nullptr) {
+        // Cancelled before the batch was sent; leave it out of the request entirely.
+        continue;
+      }
+
+      GrpcClientImpl::createRequest(request, domain_batch.first, check->descriptors_);
+      if (check->timeout_.valid() &&
+          (!timeout.valid() || check->timeout_.value() < timeout.value())) {
+        timeout = check->timeout_;
+      }
+      batch->checks_.emplace_back(std::move(check));
+    }
+
+    if (batch->checks_.empty()) {
+      continue;
+    }
+
+    ActiveBatch* raw_batch = batch.get();
+    active_batches_.emplace_back(std::move(batch));
+
+    // If the request cannot be started, onFailure() has already run inline and removed the batch,
+    // so it must not be touched when send() returns nullptr.
+    Grpc::AsyncRequest* request_handle =
+        async_client_->send(service_method_, request, *raw_batch, timeout);
+    if (request_handle != nullptr) {
+      raw_batch->request_ = request_handle;
     }
   }
 }
 
-void GrpcClientImpl::limit(RequestCallbacks& callbacks, const std::string& domain,
-                           const std::vector<Descriptor>& descriptors,
-                           const Tracing::TransportContext& context) {
-  ASSERT(callbacks_ == nullptr);
-  callbacks_ = &callbacks;
-  context_ = context;
+void GrpcBatcherImpl::completeCheck(PendingCheck& check, LimitStatus status) {
+  if (check.callbacks_ == nullptr) {
+    // Cancelled while in flight.
+    return;
+  }
+
+  check.client_->pending_check_ = nullptr;
+  RequestCallbacks* callbacks = check.callbacks_;
+  check.callbacks_ = nullptr;
+  callbacks->complete(status);
+}
+
+void GrpcBatcherImpl::onBatchSuccess(ActiveBatch& batch,
+                                     const pb::lyft::ratelimit::RateLimitResponse& response) {
+  ASSERT(response.overall_code() != pb::lyft::ratelimit::RateLimitResponse_Code_UNKNOWN);
+
+  uint64_t total_descriptors = 0;
+  for (const PendingCheckPtr& check : batch.checks_) {
+    total_descriptors += check->descriptors_.size();
+  }
+
+  // The status list matches the request descriptor order, so each check's verdict comes from its
+  // own slice. If the service did not return per descriptor statuses, fall back to the batch wide
+  // verdict for every check.
+  const bool have_statuses = static_cast<uint64_t>(response.statuses_size()) == total_descriptors;
+  int index = 0;
+  for (PendingCheckPtr& check : batch.checks_) {
+    LimitStatus status = LimitStatus::OK;
+    if (have_statuses) {
+      for (uint64_t i = 0; i < check->descriptors_.size(); i++, index++) {
+        const pb::lyft::ratelimit::RateLimitResponse_DescriptorStatus& descriptor_status =
+            response.statuses(index);
+        if (descriptor_status.code() == pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT) {
+          status = LimitStatus::OverLimit;
+          maybeCacheOverLimit(batch.domain_, check->descriptors_[i], descriptor_status);
+        }
+      }
+    } else if (response.overall_code() ==
+               pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT) {
+      status = LimitStatus::OverLimit;
+    }
 
-  pb::lyft::ratelimit::RateLimitRequest request;
-  createRequest(request, domain, descriptors);
+    completeCheck(*check, status);
+  }
 
-  request_ = async_client_->send(service_method_, request, *this, timeout_);
+  removeBatch(batch);
 }
 
-void GrpcClientImpl::onCreateInitialMetadata(Http::HeaderMap& metadata) {
-  if (!context_.request_id_.empty()) {
-    metadata.insertRequestId().value(context_.request_id_);
+void GrpcBatcherImpl::onBatchFailure(ActiveBatch& batch) {
+  for (PendingCheckPtr& check : batch.checks_) {
+    completeCheck(*check, LimitStatus::Error);
   }
 
-  if (!context_.span_context_.empty()) {
-    metadata.insertOtSpanContext().value(context_.span_context_);
+  removeBatch(batch);
+}
+
+void GrpcBatcherImpl::removeBatch(ActiveBatch& batch) {
+  for (auto it = active_batches_.begin(); it != active_batches_.end(); ++it) {
+    if (it->get() == &batch) {
+      active_batches_.erase(it);
+      return;
+    }
+  }
+
+  NOT_REACHED;
+}
+
+bool GrpcBatcherImpl::isCachedOverLimit(const std::string& domain,
+                                        const std::vector<Descriptor>& descriptors) {
+  if (over_limit_cache_.empty()) {
+    return false;
+  }
+
+  const MonotonicTime now = time_source_.currentTime();
+  for (const Descriptor& descriptor : descriptors) {
+    auto it = over_limit_cache_.find(overLimitCacheKey(domain, descriptor));
+    if (it != over_limit_cache_.end()) {
+      if (now < it->second) {
+        return true;
+      }
+
+      over_limit_cache_.erase(it);
+    }
+  }
+
+  return false;
+}
+
+void GrpcBatcherImpl::maybeCacheOverLimit(
+    const std::string& domain, const Descriptor& descriptor,
+    const pb::lyft::ratelimit::RateLimitResponse_DescriptorStatus& status) {
+  // The rate limit protocol carries no explicit TTL, so a decision is only cached when the
+  // service reports the limit that fired, and then for at most the unit of that limit, capped.
+  const Optional<std::chrono::seconds> unit_ttl = overLimitTtl(status.current_limit().unit());
+  if (!unit_ttl.valid()) {
+    return;
+  }
+
+  const MonotonicTime now = time_source_.currentTime();
+  if (over_limit_cache_.size() >= OVER_LIMIT_CACHE_MAX_ENTRIES) {
+    for (auto it = over_limit_cache_.begin(); it != over_limit_cache_.end();) {
+      if (now < it->second) {
+        ++it;
+      } else {
+        it = over_limit_cache_.erase(it);
+      }
+    }
+
+    if (over_limit_cache_.size() >= OVER_LIMIT_CACHE_MAX_ENTRIES) {
+      return;
+    }
   }
+
+  over_limit_cache_[overLimitCacheKey(domain, descriptor)] =
+      now + std::min(unit_ttl.value(), OVER_LIMIT_CACHE_MAX_TTL);
 }
 
-void GrpcClientImpl::onSuccess(std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse>&& response) {
-  LimitStatus status = LimitStatus::OK;
-  ASSERT(response->overall_code() != pb::lyft::ratelimit::RateLimitResponse_Code_UNKNOWN);
-  if (response->overall_code() == pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT) {
-    status = LimitStatus::OverLimit;
+void GrpcBatcherImpl::ActiveBatch::onCreateInitialMetadata(Http::HeaderMap& metadata) {
+  // A batched request carries the tracing context of the first check it coalesced.
+  ASSERT(!checks_.empty());
+  const Tracing::TransportContext& context = checks_.front()->context_;
+  if (!context.request_id_.empty()) {
+    metadata.insertRequestId().value(context.request_id_);
+  }
+
+  if (!context.span_context_.empty()) {
+    metadata.insertOtSpanContext().value(context.span_context_);
   }
-  callbacks_->complete(status);
-  callbacks_ = nullptr;
 }
 
-void GrpcClientImpl::onFailure(Grpc::Status::GrpcStatus status, const std::string&) {
+void GrpcBatcherImpl::ActiveBatch::onSuccess(
+    std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse>&& response) {
+  parent_.onBatchSuccess(*this, *response);
+}
+
+void GrpcBatcherImpl::ActiveBatch::onFailure(Grpc::Status::GrpcStatus status, const std::string&) {
   ASSERT(status != Grpc::Status::GrpcStatus::Ok);
   UNREFERENCED_PARAMETER(status);
-  callbacks_->complete(LimitStatus::Error);
-  callbacks_ = nullptr;
+  parent_.onBatchFailure(*this);
+}
+
+GrpcClientImpl::GrpcClientImpl(GrpcBatcherImpl& batcher,
+                               const Optional<std::chrono::milliseconds>& timeout)
+    : batcher_(batcher), timeout_(timeout) {}
+
+GrpcClientImpl::~GrpcClientImpl() { ASSERT(pending_check_ == nullptr); }
+
+void GrpcClientImpl::cancel() { batcher_.cancel(*this); }
+
+void GrpcClientImpl::createRequest(pb::lyft::ratelimit::RateLimitRequest& request,
+                                   const std::string& domain,
+                                   const std::vector<Descriptor>& descriptors) {
+  request.set_domain(domain);
+  for (const Descriptor& descriptor : descriptors) {
+    pb::lyft::ratelimit::RateLimitDescriptor* new_descriptor = request.add_descriptors();
+    for (const DescriptorEntry& entry : descriptor.entries_) {
+      pb::lyft::ratelimit::RateLimitDescriptor::Entry* new_entry = new_descriptor->add_entries();
+      new_entry->set_key(entry.key_);
+      new_entry->set_value(entry.value_);
+    }
+  }
+}
+
+void GrpcClientImpl::limit(RequestCallbacks& callbacks, const std::string& domain,
+                           const std::vector<Descriptor>& descriptors,
+                           const Tracing::TransportContext& context) {
+  batcher_.limit(*this, callbacks, domain, descriptors, context);
 }
 
 GrpcFactoryImpl::GrpcFactoryImpl(const envoy::api::v2::RateLimitServiceConfig& config,
-                                 Upstream::ClusterManager& cm)
-    : cluster_name_(config.cluster_name()), cm_(cm) {
+                                 Upstream::ClusterManager& cm, ThreadLocal::SlotAllocator& tls)
+    : cluster_name_(config.cluster_name()), cm_(cm), tls_(tls.allocateSlot()) {
   if (!cm_.get(cluster_name_)) {
     throw EnvoyException(fmt::format("unknown rate limit service cluster '{}'", cluster_name_));
   }
+
+  tls_->set([this](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<GrpcBatcherImpl>(
+        RateLimitAsyncClientPtr{new Grpc::AsyncClientImpl<pb::lyft::ratelimit::RateLimitRequest,
+                                                          pb::lyft::ratelimit::RateLimitResponse>(
+            cm_, cluster_name_)},
+        dispatcher, ProdMonotonicTimeSource::instance_);
+  });
 }
 
 ClientPtr GrpcFactoryImpl::create(const Optional<std::chrono::milliseconds>& timeout) {
-  return ClientPtr{new GrpcClientImpl(
-      RateLimitAsyncClientPtr{
-          new Grpc::AsyncClientImpl<pb::lyft::ratelimit::RateLimitRequest,
-                                    pb::lyft::ratelimit::RateLimitResponse>(cm_, cluster_name_)},
-      timeout)};
+  return ClientPtr{new GrpcClientImpl(tls_->getTyped<GrpcBatcherImpl>(), timeout)};
 }
 
 } // namespace RateLimit
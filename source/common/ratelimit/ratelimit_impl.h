@@ -2,11 +2,17 @@
 
 #include <chrono>
 #include <cstdint>
+#include <list>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/ratelimit/ratelimit.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/tracing/context.h"
 #include "envoy/upstream/cluster_manager.h"
 
@@ -24,13 +30,99 @@ typedef std::unique_ptr<RateLimitAsyncClient> RateLimitAsyncClientPtr;
 
 typedef Grpc::AsyncRequestCallbacks<pb::lyft::ratelimit::RateLimitResponse> RateLimitAsyncCallbacks;
 
-// TODO(htuch): We should have only one client per thread, but today we create one per filter stack.
-// This will require support for more than one outstanding request per client (limit() assumes only
-// one today).
-class GrpcClientImpl : public Client, public RateLimitAsyncCallbacks {
+class GrpcClientImpl;
+
+/**
+ * Per thread rate limit machinery shared by every filter stack on a worker: a single persistent
+ * gRPC client, the batch of checks collected during the current dispatcher iteration, and a short
+ * lived cache of over limit decisions.
+ *
+ * Checks issued in the same dispatcher iteration that target the same domain are coalesced into a
+ * single RateLimitRequest. The response status list matches the request descriptor order, so each
+ * check's verdict is recovered from its own slice of the list. Descriptors the service recently
+ * reported as over limit are cached locally and answered without a round trip; the rate limit
+ * protocol carries no explicit TTL, so the cache duration is derived from the unit of the limit
+ * that fired, capped at a small constant.
+ */
+class GrpcBatcherImpl : public ThreadLocal::ThreadLocalObject {
 public:
-  GrpcClientImpl(RateLimitAsyncClientPtr&& async_client,
-                 const Optional<std::chrono::milliseconds>& timeout);
+  GrpcBatcherImpl(RateLimitAsyncClientPtr&& async_client, Event::Dispatcher& dispatcher,
+                  MonotonicTimeSource& time_source);
+  ~GrpcBatcherImpl();
+
+  /**
+   * An individual limit check waiting on the service. Owned by the batcher; the issuing client
+   * handle keeps a raw pointer so that it can cancel.
+   */
+  struct PendingCheck {
+    PendingCheck(GrpcClientImpl& client, RequestCallbacks& callbacks,
+                 const std::vector<Descriptor>& descriptors,
+                 const Tracing::TransportContext& context,
+                 const Optional<std::chrono::milliseconds>& timeout)
+        : client_(&client), callbacks_(&callbacks), descriptors_(descriptors), context_(context),
+          timeout_(timeout) {}
+
+    GrpcClientImpl* client_;
+    RequestCallbacks* callbacks_; // Cleared on cancel; the check still rides out the RPC.
+    const std::vector<Descriptor> descriptors_;
+    const Tracing::TransportContext context_;
+    const Optional<std::chrono::milliseconds> timeout_;
+  };
+
+  /**
+   * Issue a limit check on behalf of a client handle. Completion may occur inline if the decision
+   * is served from the over limit cache; otherwise the check joins the current batch and the
+   * handle's pending check pointer is set until completion or cancellation.
+   */
+  void limit(GrpcClientImpl& client, RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Descriptor>& descriptors, const Tracing::TransportContext& context);
+  void cancel(GrpcClientImpl& client);
+
+private:
+  typedef std::unique_ptr<PendingCheck> PendingCheckPtr;
+
+  struct ActiveBatch : public RateLimitAsyncCallbacks {
+    ActiveBatch(GrpcBatcherImpl& parent, const std::string& domain)
+        : parent_(parent), domain_(domain) {}
+
+    // Grpc::AsyncRequestCallbacks
+    void onCreateInitialMetadata(Http::HeaderMap& metadata) override;
+    void onSuccess(std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse>&& response) override;
+    void onFailure(Grpc::Status::GrpcStatus status, const std::string& message) override;
+
+    GrpcBatcherImpl& parent_;
+    const std::string domain_;
+    std::vector<PendingCheckPtr> checks_;
+    Grpc::AsyncRequest* request_{};
+  };
+
+  typedef std::unique_ptr<ActiveBatch> ActiveBatchPtr;
+
+  void flush();
+  void completeCheck(PendingCheck& check, LimitStatus status);
+  void onBatchSuccess(ActiveBatch& batch, const pb::lyft::ratelimit::RateLimitResponse& response);
+  void onBatchFailure(ActiveBatch& batch);
+  void removeBatch(ActiveBatch& batch);
+  bool isCachedOverLimit(const std::string& domain, const std::vector<Descriptor>& descriptors);
+  void maybeCacheOverLimit(const std::string& domain, const Descriptor& descriptor,
+                           const pb::lyft::ratelimit::RateLimitResponse_DescriptorStatus& status);
+
+  const Protobuf::MethodDescriptor& service_method_;
+  RateLimitAsyncClientPtr async_client_;
+  MonotonicTimeSource& time_source_;
+  Event::TimerPtr batch_timer_;
+  std::unordered_map<std::string, std::vector<PendingCheckPtr>> pending_batches_;
+  std::list<ActiveBatchPtr> active_batches_;
+  std::unordered_map<std::string, MonotonicTime> over_limit_cache_;
+};
+
+/**
+ * Handle given to each filter stack. Checks are forwarded to the thread local batcher which owns
+ * the persistent gRPC client for the thread, so creating and destroying these is cheap.
+ */
+class GrpcClientImpl : public Client {
+public:
+  GrpcClientImpl(GrpcBatcherImpl& batcher, const Optional<std::chrono::milliseconds>& timeout);
   ~GrpcClientImpl();
 
   static void createRequest(pb::lyft::ratelimit::RateLimitRequest& request,
@@ -42,24 +134,18 @@ public:
              const std::vector<Descriptor>& descriptors,
              const Tracing::TransportContext& context) override;
 
-  // Grpc::AsyncRequestCallbacks
-  void onCreateInitialMetadata(Http::HeaderMap& metadata) override;
-  void onSuccess(std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse>&& response) override;
-  void onFailure(Grpc::Status::GrpcStatus status, const std::string& message) override;
-
 private:
-  const Protobuf::MethodDescriptor& service_method_;
-  std::unique_ptr<RateLimitAsyncClient> async_client_;
-  Grpc::AsyncRequest* request_{};
+  friend class GrpcBatcherImpl;
+
+  GrpcBatcherImpl& batcher_;
   Optional<std::chrono::milliseconds> timeout_;
-  RequestCallbacks* callbacks_{};
-  Tracing::TransportContext context_;
+  GrpcBatcherImpl::PendingCheck* pending_check_{};
 };
 
 class GrpcFactoryImpl : public ClientFactory {
 public:
   GrpcFactoryImpl(const envoy::api::v2::RateLimitServiceConfig& config,
-                  Upstream::ClusterManager& cm);
+                  Upstream::ClusterManager& cm, ThreadLocal::SlotAllocator& tls);
 
   // RateLimit::ClientFactory
   ClientPtr create(const Optional<std::chrono::milliseconds>& timeout) override;
@@ -67,6 +153,7 @@ public:
 private:
   const std::string cluster_name_;
   Upstream::ClusterManager& cm_;
+  ThreadLocal::SlotPtr tls_;
 };
 
 class NullClientImpl : public Client {
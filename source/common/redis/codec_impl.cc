@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/utility.h"
 
@@ -50,15 +51,56 @@ const std::vector<RespValue>& RespValue::asArray() const {
 std::string& RespValue::asString() {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  // A mutable reference allows the caller to modify the string, which would leave any buffer
+  // storage stale, so linearize the buffer into the string and drop it.
+  if (buffer_ != nullptr) {
+    copyBufferToString();
+    buffer_.reset();
+  }
   return string_;
 }
 
 const std::string& RespValue::asString() const {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  // Lazily materialize the string for buffer backed values. The buffer remains authoritative
+  // (the encoder prefers it); the string is just a cache and cannot diverge since any mutable
+  // access drops the buffer.
+  if (buffer_ != nullptr && string_.empty()) {
+    const_cast<RespValue*>(this)->copyBufferToString();
+  }
   return string_;
 }
 
+Buffer::Instance& RespValue::asBuffer() {
+  ASSERT(type_ == RespType::BulkString);
+  if (buffer_ == nullptr) {
+    ASSERT(string_.empty());
+    buffer_.reset(new Buffer::OwnedImpl());
+  }
+  return *buffer_;
+}
+
+const Buffer::Instance& RespValue::asBuffer() const {
+  ASSERT(buffer_ != nullptr);
+  return *buffer_;
+}
+
+void RespValue::copyBufferToString() {
+  ASSERT(buffer_ != nullptr && string_.empty());
+  uint64_t num_slices = buffer_->getRawSlices(nullptr, 0);
+  if (num_slices == 0) {
+    return;
+  }
+
+  Buffer::RawSlice slices[num_slices];
+  buffer_->getRawSlices(slices, num_slices);
+  string_.reserve(buffer_->length());
+  for (const Buffer::RawSlice& slice : slices) {
+    string_.append(reinterpret_cast<const char*>(slice.mem_), slice.len_);
+  }
+}
+
 int64_t& RespValue::asInteger() {
   ASSERT(type_ == RespType::Integer);
   return integer_;
@@ -70,6 +112,8 @@ int64_t RespValue::asInteger() const {
 }
 
 void RespValue::cleanup() {
+  buffer_.reset();
+
   // Need to manually delete because of the union.
   switch (type_) {
   case RespType::Array: {
@@ -90,6 +134,29 @@ void RespValue::cleanup() {
 }
 
 void RespValue::type(RespType type) {
+  if (type == type_) {
+    // Same-type changes clear the value in place so that reused values (e.g., recycled decoder
+    // roots) keep their array or string capacity instead of reallocating it.
+    buffer_.reset();
+    switch (type_) {
+    case RespType::Array: {
+      array_.clear();
+      break;
+    }
+    case RespType::SimpleString:
+    case RespType::BulkString:
+    case RespType::Error: {
+      string_.clear();
+      break;
+    }
+    case RespType::Null:
+    case RespType::Integer: {
+      break;
+    }
+    }
+    return;
+  }
+
   cleanup();
 
   // Need to use placement new because of the union.
@@ -112,27 +179,52 @@ void RespValue::type(RespType type) {
   }
 }
 
+const uint64_t DecoderImpl::BULK_STRING_BUFFER_THRESHOLD = 1024;
+
 void DecoderImpl::decode(Buffer::Instance& data) {
-  uint64_t num_slices = data.getRawSlices(nullptr, 0);
-  Buffer::RawSlice slices[num_slices];
-  data.getRawSlices(slices, num_slices);
-  for (const Buffer::RawSlice& slice : slices) {
-    parseSlice(slice);
+  while (data.length() > 0) {
+    if (state_ == State::BulkStringBuffer) {
+      // Move the payload out of the input buffer instead of copying it. Complete slices transfer
+      // ownership without touching the bytes.
+      ASSERT(!pending_integer_.negative_);
+      uint64_t length_to_move =
+          std::min(static_cast<uint64_t>(pending_integer_.integer_), data.length());
+      pending_value_stack_.front().value_->asBuffer().move(data, length_to_move);
+      pending_integer_.integer_ -= length_to_move;
+      if (pending_integer_.integer_ == 0) {
+        ENVOY_LOG(trace, "parse slice: BulkStringBuffer complete");
+        state_ = State::CR;
+      }
+
+      continue;
+    }
+
+    Buffer::RawSlice slice;
+    data.getRawSlices(&slice, 1);
+    data.drain(parseSlice(slice));
   }
+}
 
-  data.drain(data.length());
+void DecoderImpl::recycle(RespValuePtr&& value) {
+  if (spare_root_ == nullptr) {
+    spare_root_ = std::move(value);
+  }
 }
 
-void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
+uint64_t DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
   const char* buffer = reinterpret_cast<const char*>(slice.mem_);
   uint64_t remaining = slice.len_;
 
-  while (remaining || state_ == State::ValueComplete) {
+  while ((remaining || state_ == State::ValueComplete) && state_ != State::BulkStringBuffer) {
     ENVOY_LOG(trace, "parse slice: {} remaining", remaining);
     switch (state_) {
     case State::ValueRootStart: {
       ENVOY_LOG(trace, "parse slice: ValueRootStart");
-      pending_value_root_.reset(new RespValue());
+      if (spare_root_ != nullptr) {
+        pending_value_root_ = std::move(spare_root_);
+      } else {
+        pending_value_root_.reset(new RespValue());
+      }
       pending_value_stack_.push_front({pending_value_root_.get(), 0});
       state_ = State::ValueStart;
       break;
@@ -223,8 +315,9 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
         } else if (pending_integer_.integer_ == 0) {
           state_ = State::ValueComplete;
         } else {
-          std::vector<RespValue> values(pending_integer_.integer_);
-          current_value.value_->asArray().swap(values);
+          // resize() rather than swapping in a fresh vector so that a recycled value's array
+          // storage is reused.
+          current_value.value_->asArray().resize(pending_integer_.integer_);
           pending_value_stack_.push_front({&current_value.value_->asArray()[0], 0});
           state_ = State::ValueStart;
         }
@@ -242,8 +335,15 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
       } else {
         ASSERT(current_value.value_->type() == RespType::BulkString);
         if (!pending_integer_.negative_) {
-          // TODO(mattklein123): reserve and define max length since we don't stream currently.
-          state_ = State::BulkStringBody;
+          // TODO(mattklein123): define a max length since we don't stream currently.
+          if (pending_integer_.integer_ >= BULK_STRING_BUFFER_THRESHOLD) {
+            // Large payloads are moved out of the input buffer as slices (see decode()) rather
+            // than copied byte by byte into a string.
+            state_ = State::BulkStringBuffer;
+          } else {
+            current_value.value_->asString().reserve(pending_integer_.integer_);
+            state_ = State::BulkStringBody;
+          }
         } else {
           // Null bulk string. Switch type to null and move to value complete.
           current_value.value_->type(RespType::Null);
@@ -331,6 +431,8 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
     }
     }
   }
+
+  return slice.len_ - remaining;
 }
 
 void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
@@ -344,7 +446,7 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
     break;
   }
   case RespType::BulkString: {
-    encodeBulkString(value.asString(), out);
+    encodeBulkString(value, out);
     break;
   }
   case RespType::Error: {
@@ -375,15 +477,23 @@ void EncoderImpl::encodeArray(const std::vector<RespValue>& array, Buffer::Insta
   }
 }
 
-void EncoderImpl::encodeBulkString(const std::string& string, Buffer::Instance& out) {
+void EncoderImpl::encodeBulkString(const RespValue& value, Buffer::Instance& out) {
+  // Prefer the buffer form so that large decoded values are written without first being
+  // materialized into a string.
+  const uint64_t size =
+      value.hasBufferStorage() ? value.asBuffer().length() : value.asString().size();
   char buffer[32];
   char* current = buffer;
   *current++ = '$';
-  current += StringUtil::itoa(current, 31, string.size());
+  current += StringUtil::itoa(current, 31, size);
   *current++ = '\r';
   *current++ = '\n';
   out.add(buffer, current - buffer);
-  out.add(string);
+  if (value.hasBufferStorage()) {
+    out.add(value.asBuffer());
+  } else {
+    out.add(value.asString());
+  }
   out.add("\r\n", 2);
 }
 
@@ -16,6 +16,8 @@ namespace Redis {
  * Decoder implementation of https://redis.io/topics/protocol
  *
  * This implementation buffers when needed and will always consume all bytes passed for decoding.
+ * Bulk string payloads at or above BULK_STRING_BUFFER_THRESHOLD are moved out of the input buffer
+ * as slices into the value's buffer storage instead of being copied into a string.
  */
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::redis> {
 public:
@@ -23,6 +25,10 @@ public:
 
   // Redis::Decoder
   void decode(Buffer::Instance& data) override;
+  void recycle(RespValuePtr&& value) override;
+
+  // Bulk string payloads at least this large use buffer storage instead of a string.
+  static const uint64_t BULK_STRING_BUFFER_THRESHOLD;
 
 private:
   enum class State {
@@ -32,6 +38,7 @@ private:
     Integer,
     IntegerLF,
     BulkStringBody,
+    BulkStringBuffer,
     CR,
     LF,
     SimpleString,
@@ -53,13 +60,18 @@ private:
     uint64_t current_array_element_;
   };
 
-  void parseSlice(const Buffer::RawSlice& slice);
+  uint64_t parseSlice(const Buffer::RawSlice& slice);
 
   DecoderCallbacks& callbacks_;
   State state_{State::ValueRootStart};
   PendingInteger pending_integer_;
   RespValuePtr pending_value_root_;
   std::forward_list<PendingValue> pending_value_stack_;
+  // A single recycled root value. Reusing it (and its array storage, see RespValue::type())
+  // removes the per-command root and array allocations for a connection sending a steady stream
+  // of commands, at the cost of holding the last completed command's storage until the next one
+  // starts parsing.
+  RespValuePtr spare_root_;
 };
 
 /**
@@ -83,7 +95,7 @@ public:
 
 private:
   void encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out);
-  void encodeBulkString(const std::string& string, Buffer::Instance& out);
+  void encodeBulkString(const RespValue& value, Buffer::Instance& out);
   void encodeError(const std::string& string, Buffer::Instance& out);
   void encodeInteger(int64_t integer, Buffer::Instance& out);
   void encodeSimpleString(const std::string& string, Buffer::Instance& out);
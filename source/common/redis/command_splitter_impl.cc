@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "common/common/assert.h"
+#include "common/common/utility.h"
 #include "common/redis/supported_commands.h"
 
 #include "fmt/format.h"
@@ -21,6 +22,38 @@ RespValuePtr Utility::makeError(const std::string& error) {
   return response;
 }
 
+bool Utility::parseRedirectError(const std::string& error, RedirectInfo& info) {
+  // "MOVED <slot> <ip:port>" or "ASK <slot> <ip:port>".
+  const size_t first_space = error.find(' ');
+  if (first_space == std::string::npos) {
+    return false;
+  }
+
+  const std::string type = error.substr(0, first_space);
+  if (type == "MOVED") {
+    info.ask_ = false;
+  } else if (type == "ASK") {
+    info.ask_ = true;
+  } else {
+    return false;
+  }
+
+  const size_t second_space = error.find(' ', first_space + 1);
+  if (second_space == std::string::npos || second_space == error.size() - 1) {
+    return false;
+  }
+
+  uint64_t slot;
+  if (!StringUtil::atoul(error.substr(first_space + 1, second_space - first_space - 1).c_str(),
+                         slot)) {
+    return false;
+  }
+
+  info.slot_ = slot;
+  info.host_address_ = error.substr(second_space + 1);
+  return true;
+}
+
 void SplitRequestBase::onWrongNumberOfArguments(SplitCallbacks& callbacks,
                                                 const RespValue& request) {
   callbacks.onResponse(Utility::makeError(
@@ -31,6 +64,24 @@ SingleServerRequest::~SingleServerRequest() { ASSERT(!handle_); }
 
 void SingleServerRequest::onResponse(RespValuePtr&& response) {
   handle_ = nullptr;
+
+  if (response->type() == RespType::Error && !redirected_) {
+    Utility::RedirectInfo redirect;
+    if (Utility::parseRedirectError(response->asString(), redirect)) {
+      handle_ = conn_pool_.makeRequestToHost(redirect.host_address_, incoming_request_, *this,
+                                             redirect.ask_);
+      if (handle_ != nullptr) {
+        redirected_ = true;
+        if (!redirect.ask_) {
+          conn_pool_.updateSlotOwner(redirect.slot_, redirect.host_address_);
+        }
+        return;
+      }
+      // If the redirection target is unknown to the cluster, fall through and forward the
+      // redirection error downstream as before.
+    }
+  }
+
   callbacks_.onResponse(std::move(response));
 }
 
@@ -47,7 +98,8 @@ void SingleServerRequest::cancel() {
 SplitRequestPtr SimpleRequest::create(ConnPool::Instance& conn_pool,
                                       const RespValue& incoming_request,
                                       SplitCallbacks& callbacks) {
-  std::unique_ptr<SimpleRequest> request_ptr{new SimpleRequest(callbacks)};
+  std::unique_ptr<SimpleRequest> request_ptr{
+      new SimpleRequest(conn_pool, incoming_request, callbacks)};
 
   request_ptr->handle_ = conn_pool.makeRequest(incoming_request.asArray()[1].asString(),
                                                incoming_request, *request_ptr);
@@ -69,7 +121,8 @@ SplitRequestPtr EvalRequest::create(ConnPool::Instance& conn_pool,
     return nullptr;
   }
 
-  std::unique_ptr<EvalRequest> request_ptr{new EvalRequest(callbacks)};
+  std::unique_ptr<EvalRequest> request_ptr{
+      new EvalRequest(conn_pool, incoming_request, callbacks)};
   request_ptr->handle_ = conn_pool.makeRequest(incoming_request.asArray()[3].asString(),
                                                incoming_request, *request_ptr);
   if (!request_ptr->handle_) {
@@ -101,9 +154,33 @@ void FragmentedRequest::onChildFailure(uint32_t index) {
   onChildResponse(Utility::makeError("upstream failure"), index);
 }
 
+bool FragmentedRequest::maybeRedirect(const RespValue& response, uint32_t index) {
+  if (response.type() != RespType::Error || pending_requests_[index].redirected_) {
+    return false;
+  }
+
+  Utility::RedirectInfo redirect;
+  if (!Utility::parseRedirectError(response.asString(), redirect)) {
+    return false;
+  }
+
+  ConnPool::PoolRequest* handle = conn_pool_.makeRequestToHost(
+      redirect.host_address_, fragment_values_[index], pending_requests_[index], redirect.ask_);
+  if (handle == nullptr) {
+    return false;
+  }
+
+  pending_requests_[index].redirected_ = true;
+  pending_requests_[index].handle_ = handle;
+  if (!redirect.ask_) {
+    conn_pool_.updateSlotOwner(redirect.slot_, redirect.host_address_);
+  }
+  return true;
+}
+
 SplitRequestPtr MGETRequest::create(ConnPool::Instance& conn_pool,
                                     const RespValue& incoming_request, SplitCallbacks& callbacks) {
-  std::unique_ptr<MGETRequest> request_ptr{new MGETRequest(callbacks)};
+  std::unique_ptr<MGETRequest> request_ptr{new MGETRequest(conn_pool, callbacks)};
 
   request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
   request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
@@ -113,24 +190,34 @@ SplitRequestPtr MGETRequest::create(ConnPool::Instance& conn_pool,
   std::vector<RespValue> responses(request_ptr->num_pending_responses_);
   request_ptr->pending_response_->asArray().swap(responses);
 
-  std::vector<RespValue> values(2);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = "get";
-  values[1].type(RespType::BulkString);
-  RespValue single_mget;
-  single_mget.type(RespType::Array);
-  single_mget.asArray().swap(values);
-
+  // Build all fragments up front so they can be handed to the connection pool as one batch,
+  // letting it group them by destination host instead of traversing the pool once per key. The
+  // fragments live on the request so they can be re-sent after a cluster redirection.
+  request_ptr->fragment_values_.resize(request_ptr->num_pending_responses_);
+  std::vector<ConnPool::RequestFragment> batch;
+  batch.reserve(request_ptr->num_pending_responses_);
   for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
     request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
 
-    single_mget.asArray()[1].asString() = incoming_request.asArray()[i].asString();
+    RespValue& single_mget = request_ptr->fragment_values_[i - 1];
+    std::vector<RespValue> values(2);
+    values[0].type(RespType::BulkString);
+    values[0].asString() = "get";
+    values[1].type(RespType::BulkString);
+    values[1].asString() = incoming_request.asArray()[i].asString();
+    single_mget.type(RespType::Array);
+    single_mget.asArray().swap(values);
+
     ENVOY_LOG(debug, "redis: parallel get: '{}'", single_mget.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_mget, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError("no upstream host"));
+    batch.emplace_back(incoming_request.asArray()[i].asString(), single_mget,
+                       request_ptr->pending_requests_.back());
+  }
+
+  std::vector<ConnPool::PoolRequest*> handles = conn_pool.makeRequests(batch);
+  for (uint64_t i = 0; i < handles.size(); i++) {
+    request_ptr->pending_requests_[i].handle_ = handles[i];
+    if (!handles[i]) {
+      request_ptr->pending_requests_[i].onResponse(Utility::makeError("no upstream host"));
     }
   }
 
@@ -155,7 +242,13 @@ void MGETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
     FALLTHRU;
   }
   case RespType::BulkString: {
-    pending_response_->asArray()[index].asString().swap(value->asString());
+    if (value->hasBufferStorage()) {
+      // Move large values as buffer slices so they are not copied into a string just to be
+      // merged into the response array.
+      pending_response_->asArray()[index].asBuffer().move(value->asBuffer());
+    } else {
+      pending_response_->asArray()[index].asString().swap(value->asString());
+    }
     break;
   }
   case RespType::Null:
@@ -176,7 +269,7 @@ SplitRequestPtr MSETRequest::create(ConnPool::Instance& conn_pool,
     return nullptr;
   }
 
-  std::unique_ptr<MSETRequest> request_ptr{new MSETRequest(callbacks)};
+  std::unique_ptr<MSETRequest> request_ptr{new MSETRequest(conn_pool, callbacks)};
 
   request_ptr->num_pending_responses_ = (incoming_request.asArray().size() - 1) / 2;
   request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
@@ -184,28 +277,35 @@ SplitRequestPtr MSETRequest::create(ConnPool::Instance& conn_pool,
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::SimpleString);
 
-  std::vector<RespValue> values(3);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = "set";
-  values[1].type(RespType::BulkString);
-  values[2].type(RespType::BulkString);
-  RespValue single_mset;
-  single_mset.type(RespType::Array);
-  single_mset.asArray().swap(values);
-
+  // As with MGET, build the fragments up front and send them as one host-grouped batch.
+  request_ptr->fragment_values_.resize(request_ptr->num_pending_responses_);
+  std::vector<ConnPool::RequestFragment> batch;
+  batch.reserve(request_ptr->num_pending_responses_);
   uint64_t fragment_index = 0;
   for (uint64_t i = 1; i < incoming_request.asArray().size(); i += 2) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, fragment_index++);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
-
-    single_mset.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    single_mset.asArray()[2].asString() = incoming_request.asArray()[i + 1].asString();
+    request_ptr->pending_requests_.emplace_back(*request_ptr, fragment_index);
+
+    RespValue& single_mset = request_ptr->fragment_values_[fragment_index++];
+    std::vector<RespValue> values(3);
+    values[0].type(RespType::BulkString);
+    values[0].asString() = "set";
+    values[1].type(RespType::BulkString);
+    values[1].asString() = incoming_request.asArray()[i].asString();
+    values[2].type(RespType::BulkString);
+    values[2].asString() = incoming_request.asArray()[i + 1].asString();
+    single_mset.type(RespType::Array);
+    single_mset.asArray().swap(values);
 
     ENVOY_LOG(debug, "redis: parallel set: '{}'", single_mset.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_mset, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError("no upstream host"));
+    batch.emplace_back(incoming_request.asArray()[i].asString(), single_mset,
+                       request_ptr->pending_requests_.back());
+  }
+
+  std::vector<ConnPool::PoolRequest*> handles = conn_pool.makeRequests(batch);
+  for (uint64_t i = 0; i < handles.size(); i++) {
+    request_ptr->pending_requests_[i].handle_ = handles[i];
+    if (!handles[i]) {
+      request_ptr->pending_requests_[i].onResponse(Utility::makeError("no upstream host"));
     }
   }
 
@@ -243,7 +343,8 @@ void MSETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
 SplitRequestPtr SplitKeysSumResultRequest::create(ConnPool::Instance& conn_pool,
                                                   const RespValue& incoming_request,
                                                   SplitCallbacks& callbacks) {
-  std::unique_ptr<SplitKeysSumResultRequest> request_ptr{new SplitKeysSumResultRequest(callbacks)};
+  std::unique_ptr<SplitKeysSumResultRequest> request_ptr{
+      new SplitKeysSumResultRequest(conn_pool, callbacks)};
 
   request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
   request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
@@ -251,25 +352,33 @@ SplitRequestPtr SplitKeysSumResultRequest::create(ConnPool::Instance& conn_pool,
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::Integer);
 
-  std::vector<RespValue> values(2);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = incoming_request.asArray()[0].asString();
-  values[1].type(RespType::BulkString);
-  RespValue single_fragment;
-  single_fragment.type(RespType::Array);
-  single_fragment.asArray().swap(values);
-
+  // As with MGET, build the fragments up front and send them as one host-grouped batch.
+  request_ptr->fragment_values_.resize(request_ptr->num_pending_responses_);
+  std::vector<ConnPool::RequestFragment> batch;
+  batch.reserve(request_ptr->num_pending_responses_);
   for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
     request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
 
-    single_fragment.asArray()[1].asString() = incoming_request.asArray()[i].asString();
+    RespValue& single_fragment = request_ptr->fragment_values_[i - 1];
+    std::vector<RespValue> values(2);
+    values[0].type(RespType::BulkString);
+    values[0].asString() = incoming_request.asArray()[0].asString();
+    values[1].type(RespType::BulkString);
+    values[1].asString() = incoming_request.asArray()[i].asString();
+    single_fragment.type(RespType::Array);
+    single_fragment.asArray().swap(values);
+
     ENVOY_LOG(debug, "redis: parallel {}: '{}'", incoming_request.asArray()[0].asString(),
               single_fragment.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_fragment, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError("no upstream host"));
+    batch.emplace_back(incoming_request.asArray()[i].asString(), single_fragment,
+                       request_ptr->pending_requests_.back());
+  }
+
+  std::vector<ConnPool::PoolRequest*> handles = conn_pool.makeRequests(batch);
+  for (uint64_t i = 0; i < handles.size(); i++) {
+    request_ptr->pending_requests_[i].handle_ = handles[i];
+    if (!handles[i]) {
+      request_ptr->pending_requests_[i].onResponse(Utility::makeError("no upstream host"));
     }
   }
 
@@ -308,7 +417,6 @@ InstanceImpl::InstanceImpl(ConnPool::InstancePtr&& conn_pool, Stats::Scope& scop
       eval_command_handler_(*conn_pool_), mget_handler_(*conn_pool_), mset_handler_(*conn_pool_),
       split_keys_sum_result_handler_(*conn_pool_),
       stats_{ALL_COMMAND_SPLITTER_STATS(POOL_COUNTER_PREFIX(scope, stat_prefix + "splitter."))} {
-  // TODO(mattklein123) PERF: Make this a trie (like in header_map_impl).
   for (const std::string& command : SupportedCommands::simpleCommands()) {
     addHandler(scope, stat_prefix, command, simple_command_handler_);
   }
@@ -338,11 +446,8 @@ SplitRequestPtr InstanceImpl::makeRequest(const RespValue& request, SplitCallbac
     }
   }
 
-  std::string to_lower_string(request.asArray()[0].asString());
-  to_lower_table_.toLowerCase(to_lower_string);
-
-  auto handler = command_map_.find(to_lower_string);
-  if (handler == command_map_.end()) {
+  const HandlerData* handler = findHandler(request.asArray()[0].asString());
+  if (handler == nullptr) {
     stats_.unsupported_command_.inc();
     callbacks.onResponse(Utility::makeError(
         fmt::format("unsupported command '{}'", request.asArray()[0].asString())));
@@ -350,8 +455,26 @@ SplitRequestPtr InstanceImpl::makeRequest(const RespValue& request, SplitCallbac
   }
 
   ENVOY_LOG(debug, "redis: splitting '{}'", request.toString());
-  handler->second.total_.inc();
-  return handler->second.handler_.get().startRequest(request, callbacks);
+  handler->total_.inc();
+  return handler->handler_.get().startRequest(request, callbacks);
+}
+
+const InstanceImpl::HandlerData* InstanceImpl::findHandler(const std::string& command) const {
+  const CommandTrieNode* node = &command_trie_root_;
+  for (const char c : command) {
+    // Lower case by setting the ASCII case bit. The cast happens before the OR so that negative
+    // chars cannot index out of range, and no non-alphabetic byte maps into the a-z range once the
+    // bit is set, so anything outside that range is an unsupported command.
+    const uint8_t lower = static_cast<uint8_t>(c) | 0x20;
+    if (lower < 'a' || lower > 'z') {
+      return nullptr;
+    }
+    node = node->children_[lower - 'a'].get();
+    if (node == nullptr) {
+      return nullptr;
+    }
+  }
+  return node->handler_data_.get();
 }
 
 void InstanceImpl::onInvalidRequest(SplitCallbacks& callbacks) {
@@ -363,10 +486,17 @@ void InstanceImpl::addHandler(Stats::Scope& scope, const std::string& stat_prefi
                               const std::string& name, CommandHandler& handler) {
   std::string to_lower_name(name);
   to_lower_table_.toLowerCase(to_lower_name);
-  command_map_.emplace(
-      to_lower_name,
-      HandlerData{scope.counter(fmt::format("{}command.{}.total", stat_prefix, to_lower_name)),
-                  handler});
+  CommandTrieNode* node = &command_trie_root_;
+  for (const char c : to_lower_name) {
+    ASSERT(c >= 'a' && c <= 'z');
+    if (node->children_[c - 'a'] == nullptr) {
+      node->children_[c - 'a'].reset(new CommandTrieNode());
+    }
+    node = node->children_[c - 'a'].get();
+  }
+  ASSERT(node->handler_data_ == nullptr);
+  node->handler_data_.reset(new HandlerData{
+      scope.counter(fmt::format("{}command.{}.total", stat_prefix, to_lower_name)), handler});
 }
 
 } // namespace CommandSplitter
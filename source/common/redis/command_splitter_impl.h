@@ -1,8 +1,9 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "envoy/redis/command_splitter.h"
@@ -18,6 +19,22 @@ namespace CommandSplitter {
 class Utility {
 public:
   static RespValuePtr makeError(const std::string& error);
+
+  /**
+   * Parsed form of a Redis Cluster "MOVED <slot> <ip:port>" or "ASK <slot> <ip:port>" error.
+   */
+  struct RedirectInfo {
+    bool ask_;
+    uint32_t slot_;
+    std::string host_address_;
+  };
+
+  /**
+   * Parse a redirection error.
+   * @return bool whether the error is a well-formed MOVED/ASK redirection; info is only valid if
+   *         true is returned.
+   */
+  static bool parseRedirectError(const std::string& error, RedirectInfo& info);
 };
 
 class CommandHandler {
@@ -54,10 +71,19 @@ public:
   void cancel() override;
 
 protected:
-  SingleServerRequest(SplitCallbacks& callbacks) : callbacks_(callbacks) {}
+  SingleServerRequest(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
+                      SplitCallbacks& callbacks)
+      : conn_pool_(conn_pool), incoming_request_(incoming_request), callbacks_(callbacks) {}
 
+  ConnPool::Instance& conn_pool_;
+  // Owned by the proxy filter's pending request, which outlives this object, so the request can
+  // be re-sent if the server answers with a cluster redirection.
+  const RespValue& incoming_request_;
   SplitCallbacks& callbacks_;
   ConnPool::PoolRequest* handle_{};
+  // Each request follows at most one redirection so a confused or moving cluster cannot bounce
+  // a request around indefinitely.
+  bool redirected_{};
 };
 
 /**
@@ -69,7 +95,9 @@ public:
                                 SplitCallbacks& callbacks);
 
 private:
-  SimpleRequest(SplitCallbacks& callbacks) : SingleServerRequest(callbacks) {}
+  SimpleRequest(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
+                SplitCallbacks& callbacks)
+      : SingleServerRequest(conn_pool, incoming_request, callbacks) {}
 };
 
 /**
@@ -81,7 +109,9 @@ public:
                                 SplitCallbacks& callbacks);
 
 private:
-  EvalRequest(SplitCallbacks& callbacks) : SingleServerRequest(callbacks) {}
+  EvalRequest(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
+              SplitCallbacks& callbacks)
+      : SingleServerRequest(conn_pool, incoming_request, callbacks) {}
 };
 
 /**
@@ -97,28 +127,38 @@ public:
   void cancel() override;
 
 protected:
-  FragmentedRequest(SplitCallbacks& callbacks) : callbacks_(callbacks) {}
+  FragmentedRequest(ConnPool::Instance& conn_pool, SplitCallbacks& callbacks)
+      : conn_pool_(conn_pool), callbacks_(callbacks) {}
 
   struct PendingRequest : public ConnPool::PoolCallbacks {
     PendingRequest(FragmentedRequest& parent, uint32_t index) : parent_(parent), index_(index) {}
 
     // Redis::ConnPool::PoolCallbacks
     void onResponse(RespValuePtr&& value) override {
-      parent_.onChildResponse(std::move(value), index_);
+      if (!parent_.maybeRedirect(*value, index_)) {
+        parent_.onChildResponse(std::move(value), index_);
+      }
     }
     void onFailure() override { parent_.onChildFailure(index_); }
 
     FragmentedRequest& parent_;
     const uint32_t index_;
     ConnPool::PoolRequest* handle_{};
+    // See SingleServerRequest::redirected_.
+    bool redirected_{};
   };
 
   virtual void onChildResponse(RespValuePtr&& value, uint32_t index) PURE;
   void onChildFailure(uint32_t index);
+  bool maybeRedirect(const RespValue& response, uint32_t index);
 
+  ConnPool::Instance& conn_pool_;
   SplitCallbacks& callbacks_;
   RespValuePtr pending_response_;
   std::vector<PendingRequest> pending_requests_;
+  // The per-key fragment commands, retained for the request's lifetime so a fragment can be
+  // re-sent if its server answers with a cluster redirection.
+  std::vector<RespValue> fragment_values_;
   uint32_t num_pending_responses_;
   uint32_t error_count_{0};
 };
@@ -133,7 +173,8 @@ public:
                                 SplitCallbacks& callbacks);
 
 private:
-  MGETRequest(SplitCallbacks& callbacks) : FragmentedRequest(callbacks) {}
+  MGETRequest(ConnPool::Instance& conn_pool, SplitCallbacks& callbacks)
+      : FragmentedRequest(conn_pool, callbacks) {}
 
   // Redis::CommandSplitter::FragmentedRequest
   void onChildResponse(RespValuePtr&& value, uint32_t index) override;
@@ -151,7 +192,8 @@ public:
                                 SplitCallbacks& callbacks);
 
 private:
-  SplitKeysSumResultRequest(SplitCallbacks& callbacks) : FragmentedRequest(callbacks) {}
+  SplitKeysSumResultRequest(ConnPool::Instance& conn_pool, SplitCallbacks& callbacks)
+      : FragmentedRequest(conn_pool, callbacks) {}
 
   // Redis::CommandSplitter::FragmentedRequest
   void onChildResponse(RespValuePtr&& value, uint32_t index) override;
@@ -170,7 +212,8 @@ public:
                                 SplitCallbacks& callbacks);
 
 private:
-  MSETRequest(SplitCallbacks& callbacks) : FragmentedRequest(callbacks) {}
+  MSETRequest(ConnPool::Instance& conn_pool, SplitCallbacks& callbacks)
+      : FragmentedRequest(conn_pool, callbacks) {}
 
   // Redis::CommandSplitter::FragmentedRequest
   void onChildResponse(RespValuePtr&& value, uint32_t index) override;
@@ -219,8 +262,19 @@ private:
     std::reference_wrapper<CommandHandler> handler_;
   };
 
+  /**
+   * A trie over the fixed vocabulary of supported command names. Commands are matched case
+   * insensitively byte by byte, so classification needs neither a lowercased copy of the incoming
+   * command nor a hash of it.
+   */
+  struct CommandTrieNode {
+    std::array<std::unique_ptr<CommandTrieNode>, 26> children_;
+    std::unique_ptr<HandlerData> handler_data_;
+  };
+
   void addHandler(Stats::Scope& scope, const std::string& stat_prefix, const std::string& name,
                   CommandHandler& handler);
+  const HandlerData* findHandler(const std::string& command) const;
   void onInvalidRequest(SplitCallbacks& callbacks);
 
   ConnPool::InstancePtr conn_pool_;
@@ -229,7 +283,7 @@ private:
   CommandHandlerFactory<MGETRequest> mget_handler_;
   CommandHandlerFactory<MSETRequest> mset_handler_;
   CommandHandlerFactory<SplitKeysSumResultRequest> split_keys_sum_result_handler_;
-  std::unordered_map<std::string, HandlerData> command_map_;
+  CommandTrieNode command_trie_root_;
   InstanceStats stats_;
   const ToLowerTable to_lower_table_;
 };
@@ -9,11 +9,25 @@
 #include "common/common/enum_to_int.h"
 #include "common/http/codes.h"
 #include "common/json/config_schemas.h"
+#include "common/redis/crc16.h"
 
 namespace Envoy {
 namespace Redis {
 namespace ConnPool {
 
+namespace {
+
+// Swallows the "+OK" response to the ASKING command that precedes an ASK-redirected request.
+// ASKING failures surface through the redirected request itself, which shares the connection.
+struct AskingCallbacks : public PoolCallbacks {
+  void onResponse(RespValuePtr&&) override {}
+  void onFailure() override {}
+};
+
+AskingCallbacks asking_callbacks;
+
+} // namespace
+
 ConfigImpl::ConfigImpl(const Json::Object& config)
     : Validator(config, Json::Schema::REDIS_CONN_POOL_SCHEMA),
       op_timeout_(config.getInteger("op_timeout_ms")) {}
@@ -36,7 +50,8 @@ ClientImpl::ClientImpl(Upstream::HostConstSharedPtr host, Event::Dispatcher& dis
                        EncoderPtr&& encoder, DecoderFactory& decoder_factory, const Config& config)
     : host_(host), encoder_(std::move(encoder)), decoder_(decoder_factory.create(*this)),
       config_(config),
-      connect_or_op_timer_(dispatcher.createTimer([this]() -> void { onConnectOrOpTimeout(); })) {
+      connect_or_op_timer_(dispatcher.createTimer([this]() -> void { onConnectOrOpTimeout(); })),
+      flush_timer_(dispatcher.createTimer([this]() -> void { flushEncoderBuffer(); })) {
   host->cluster().stats().upstream_cx_total_.inc();
   host->cluster().stats().upstream_cx_active_.inc();
   host->stats().cx_total_.inc();
@@ -57,7 +72,14 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
   ASSERT(connection_->state() == Network::Connection::State::Open);
   pending_requests_.emplace_back(*this, callbacks);
   encoder_->encode(request, encoder_buffer_);
-  connection_->write(encoder_buffer_);
+
+  // Since the protocol is pipelined, all requests that are encoded during a single event loop
+  // iteration (e.g., all fragments of a multi-key command from the splitter) are coalesced
+  // into one buffer and flushed with a single write instead of one syscall per command.
+  if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    flush_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
 
   // Only boost the op timeout if we are not already connected. Otherwise, we are governed by
   // the connect timeout and the timer will be reset when/if connection occurs. This allows a
@@ -69,6 +91,15 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
   return &pending_requests_.back();
 }
 
+void ClientImpl::flushEncoderBuffer() {
+  flush_scheduled_ = false;
+  // The connection may have been closed (failing all pending requests) between the time the
+  // flush was scheduled and now; if so just drop the buffered data.
+  if (encoder_buffer_.length() > 0 && connection_->state() == Network::Connection::State::Open) {
+    connection_->write(encoder_buffer_);
+  }
+}
+
 void ClientImpl::onConnectOrOpTimeout() {
   host_->outlierDetector().putHttpResponseCode(enumToInt(Http::Code::GatewayTimeout));
   if (connected_) {
@@ -189,6 +220,22 @@ PoolRequest* InstanceImpl::makeRequest(const std::string& hash_key, const RespVa
   return tls_->getTyped<ThreadLocalPool>().makeRequest(hash_key, value, callbacks);
 }
 
+std::vector<PoolRequest*>
+InstanceImpl::makeRequests(const std::vector<RequestFragment>& fragments) {
+  return tls_->getTyped<ThreadLocalPool>().makeRequests(fragments);
+}
+
+PoolRequest* InstanceImpl::makeRequestToHost(const std::string& host_address,
+                                             const RespValue& request, PoolCallbacks& callbacks,
+                                             bool asking) {
+  return tls_->getTyped<ThreadLocalPool>().makeRequestToHost(host_address, request, callbacks,
+                                                             asking);
+}
+
+void InstanceImpl::updateSlotOwner(uint32_t slot, const std::string& host_address) {
+  tls_->getTyped<ThreadLocalPool>().updateSlotOwner(slot, host_address);
+}
+
 InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher,
                                                const std::string& cluster_name)
     : parent_(parent), dispatcher_(dispatcher), cluster_(parent_.cm_.get(cluster_name)) {
@@ -200,6 +247,9 @@ InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Disp
   local_host_set_member_update_cb_handle_ = cluster_->hostSet().addMemberUpdateCb(
       [this](const std::vector<Upstream::HostSharedPtr>&,
              const std::vector<Upstream::HostSharedPtr>& hosts_removed) -> void {
+        // Drop the address index on any membership change; it is rebuilt on the next
+        // redirection that needs it.
+        host_address_map_.clear();
         onHostsRemoved(hosts_removed);
       });
 }
@@ -220,18 +270,118 @@ void InstanceImpl::ThreadLocalPool::onHostsRemoved(
       // we just close the connection. This will fail any pending requests.
       it->second->redis_client_->close();
     }
+
+    // Slots owned by a removed host go back to load balancer routing until a new MOVED
+    // redirection re-learns their owner.
+    for (auto slot_it = slot_owners_.begin(); slot_it != slot_owners_.end();) {
+      if (slot_it->second == host) {
+        slot_it = slot_owners_.erase(slot_it);
+      } else {
+        ++slot_it;
+      }
+    }
   }
 }
 
 PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_key,
                                                         const RespValue& request,
                                                         PoolCallbacks& callbacks) {
+  Upstream::HostConstSharedPtr host = hostForHashKey(hash_key);
+  if (!host) {
+    return nullptr;
+  }
+
+  return clientForHost(host).redis_client_->makeRequest(request, callbacks);
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::hostForHashKey(const std::string& hash_key) {
+  // Once any MOVED redirection has populated the slot owner map, keys are routed by their Redis
+  // Cluster hash slot so each request goes straight to the owning node. Unknown slots (and
+  // non-cluster deployments, whose map stays empty) fall back to the load balancer.
+  if (!slot_owners_.empty()) {
+    auto it = slot_owners_.find(Crc16::hashSlot(hash_key));
+    if (it != slot_owners_.end()) {
+      return it->second;
+    }
+  }
+
   LbContextImpl lb_context(hash_key);
-  Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(&lb_context);
+  return cluster_->loadBalancer().chooseHost(&lb_context);
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::hostForAddress(const std::string& host_address) {
+  if (host_address_map_.empty()) {
+    for (const auto& host : cluster_->hostSet().hosts()) {
+      host_address_map_[host->address()->asString()] = host;
+    }
+  }
+
+  auto it = host_address_map_.find(host_address);
+  return it != host_address_map_.end() ? it->second : nullptr;
+}
+
+PoolRequest* InstanceImpl::ThreadLocalPool::makeRequestToHost(const std::string& host_address,
+                                                              const RespValue& request,
+                                                              PoolCallbacks& callbacks,
+                                                              bool asking) {
+  Upstream::HostConstSharedPtr host = hostForAddress(host_address);
   if (!host) {
+    // The redirection target is not (yet) a member of the cluster; the caller forwards the
+    // redirection error downstream as before.
     return nullptr;
   }
 
+  ThreadLocalActiveClient& client = clientForHost(host);
+  if (asking) {
+    RespValue asking_request;
+    asking_request.type(RespType::Array);
+    asking_request.asArray().resize(1);
+    asking_request.asArray()[0].type(RespType::BulkString);
+    asking_request.asArray()[0].asString() = "asking";
+    client.redis_client_->makeRequest(asking_request, asking_callbacks);
+  }
+
+  return client.redis_client_->makeRequest(request, callbacks);
+}
+
+void InstanceImpl::ThreadLocalPool::updateSlotOwner(uint32_t slot,
+                                                    const std::string& host_address) {
+  Upstream::HostConstSharedPtr host = hostForAddress(host_address);
+  if (host) {
+    slot_owners_[slot] = host;
+  }
+}
+
+std::vector<PoolRequest*>
+InstanceImpl::ThreadLocalPool::makeRequests(const std::vector<RequestFragment>& fragments) {
+  std::vector<PoolRequest*> handles(fragments.size(), nullptr);
+
+  // Resolve the destination host for every fragment first, bucketing fragment indexes by host so
+  // that each host's connection is looked up once and its fragments are encoded contiguously as
+  // one pipelined batch.
+  std::unordered_map<Upstream::HostConstSharedPtr, std::vector<uint64_t>> fragments_by_host;
+  for (uint64_t i = 0; i < fragments.size(); i++) {
+    Upstream::HostConstSharedPtr host = hostForHashKey(fragments[i].hash_key_);
+    if (host) {
+      fragments_by_host[host].push_back(i);
+    }
+  }
+
+  for (const auto& host_fragments : fragments_by_host) {
+    ThreadLocalActiveClient& client = clientForHost(host_fragments.first);
+    for (uint64_t i : host_fragments.second) {
+      handles[i] = client.redis_client_->makeRequest(fragments[i].request_,
+                                                     fragments[i].callbacks_);
+    }
+  }
+
+  return handles;
+}
+
+InstanceImpl::ThreadLocalActiveClient&
+InstanceImpl::ThreadLocalPool::clientForHost(Upstream::HostConstSharedPtr host) {
   ThreadLocalActiveClientPtr& client = client_map_[host];
   if (!client) {
     client.reset(new ThreadLocalActiveClient(*this));
@@ -240,7 +390,7 @@ PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_
     client->redis_client_->addConnectionCallbacks(*client);
   }
 
-  return client->redis_client_->makeRequest(request, callbacks);
+  return *client;
 }
 
 void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent event) {
@@ -77,6 +77,7 @@ private:
              DecoderFactory& decoder_factory, const Config& config);
   void onConnectOrOpTimeout();
   void onData(Buffer::Instance& data);
+  void flushEncoderBuffer();
 
   // Redis::DecoderCallbacks
   void onRespValue(RespValuePtr&& value) override;
@@ -94,7 +95,9 @@ private:
   const Config& config_;
   std::list<PendingRequest> pending_requests_;
   Event::TimerPtr connect_or_op_timer_;
+  Event::TimerPtr flush_timer_;
   bool connected_{};
+  bool flush_scheduled_{};
 };
 
 class ClientFactoryImpl : public ClientFactory {
@@ -118,6 +121,10 @@ public:
   // Redis::ConnPool::Instance
   PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                            PoolCallbacks& callbacks) override;
+  std::vector<PoolRequest*> makeRequests(const std::vector<RequestFragment>& fragments) override;
+  PoolRequest* makeRequestToHost(const std::string& host_address, const RespValue& request,
+                                 PoolCallbacks& callbacks, bool asking) override;
+  void updateSlotOwner(uint32_t slot, const std::string& host_address) override;
 
 private:
   struct ThreadLocalPool;
@@ -143,12 +150,26 @@ private:
     ~ThreadLocalPool();
     PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                              PoolCallbacks& callbacks);
+    std::vector<PoolRequest*> makeRequests(const std::vector<RequestFragment>& fragments);
+    PoolRequest* makeRequestToHost(const std::string& host_address, const RespValue& request,
+                                   PoolCallbacks& callbacks, bool asking);
+    void updateSlotOwner(uint32_t slot, const std::string& host_address);
+    Upstream::HostConstSharedPtr hostForHashKey(const std::string& hash_key);
+    Upstream::HostConstSharedPtr hostForAddress(const std::string& host_address);
+    ThreadLocalActiveClient& clientForHost(Upstream::HostConstSharedPtr host);
     void onHostsRemoved(const std::vector<Upstream::HostSharedPtr>& hosts_removed);
 
     InstanceImpl& parent_;
     Event::Dispatcher& dispatcher_;
     Upstream::ThreadLocalCluster* cluster_;
     std::unordered_map<Upstream::HostConstSharedPtr, ThreadLocalActiveClientPtr> client_map_;
+    // Redis Cluster hash slot owners learned from MOVED redirections. Empty until the first
+    // redirection, so non-cluster deployments never pay for slot hashing and keep routing purely
+    // through the load balancer.
+    std::unordered_map<uint32_t, Upstream::HostConstSharedPtr> slot_owners_;
+    // Hosts in the local host set indexed by "ip:port", used to resolve redirection targets.
+    // Rebuilt lazily after membership changes.
+    std::unordered_map<std::string, Upstream::HostConstSharedPtr> host_address_map_;
     Common::CallbackHandle* local_host_set_member_update_cb_handle_;
   };
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Envoy {
+namespace Redis {
+
+/**
+ * CRC16 (CCITT/XMODEM variant) as used by Redis Cluster to map keys to hash slots.
+ */
+class Crc16 {
+public:
+  // Total number of hash slots in a Redis Cluster.
+  static constexpr uint32_t NumSlots = 16384;
+
+  /**
+   * @return the CRC16 of the supplied data.
+   */
+  static uint16_t crc16(const char* data, uint64_t length);
+
+  /**
+   * Compute the Redis Cluster hash slot for a key. If the key contains a non-empty hash tag
+   * (a "{...}" section), only the tag contents are hashed so that keys sharing a tag land in the
+   * same slot, per the Redis Cluster specification.
+   * @return the slot in [0, NumSlots).
+   */
+  static uint16_t hashSlot(const std::string& key);
+};
+
+} // namespace Redis
+} // namespace Envoy
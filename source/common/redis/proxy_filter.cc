@@ -59,6 +59,15 @@ void ProxyFilter::onRespValue(RespValuePtr&& value) {
     // The splitter can immediately respond and destroy the pending request. Only store the handle
     // if the request is still alive.
     request.request_handle_ = std::move(split);
+
+    // An in-flight request keeps its parsed value: the splitter holds references into it and may
+    // re-send it if the upstream answers with a cluster redirection. It is recycled once the
+    // response has been flushed.
+    request.request_value_ = std::move(value);
+  } else {
+    // The command was answered inline, so the parsed value can go back to the decoder for reuse
+    // by the next command on this connection.
+    decoder_->recycle(std::move(value));
   }
 }
 
@@ -82,7 +91,11 @@ void ProxyFilter::onResponse(PendingRequest& request, RespValuePtr&& value) {
   // The response we got might not be in order, so flush out what we can. (A new response may
   // unlock several out of order responses).
   while (!pending_requests_.empty() && pending_requests_.front().pending_response_) {
-    encoder_->encode(*pending_requests_.front().pending_response_, encoder_buffer_);
+    PendingRequest& front = pending_requests_.front();
+    encoder_->encode(*front.pending_response_, encoder_buffer_);
+    if (front.request_value_) {
+      decoder_->recycle(std::move(front.request_value_));
+    }
     pending_requests_.pop_front();
   }
 
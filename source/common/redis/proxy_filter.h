@@ -95,6 +95,10 @@ private:
     void onResponse(RespValuePtr&& value) override { parent_.onResponse(*this, std::move(value)); }
 
     ProxyFilter& parent_;
+    // The parsed request, held for the request's lifetime because the splitter may need to
+    // re-send it if the upstream answers with a cluster redirection. Recycled to the decoder
+    // once the response is flushed.
+    RespValuePtr request_value_;
     RespValuePtr pending_response_;
     CommandSplitter::SplitRequestPtr request_handle_;
   };
@@ -1,10 +1,10 @@
 #include "common/router/config_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <vector>
 
@@ -16,6 +16,7 @@
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/hash.h"
+#include "common/common/tracepoint.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -101,17 +102,19 @@ void DecoratorImpl::apply(Tracing::Span& span) const {
 const uint64_t RouteEntryImplBase::WeightedClusterEntry::MAX_CLUSTER_WEIGHT = 100UL;
 
 RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
-                                       const envoy::api::v2::Route& route, Runtime::Loader& loader)
+                                       const envoy::api::v2::Route& route, Runtime::Loader& loader,
+                                       Upstream::ClusterManager& cm)
     : case_sensitive_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.match(), case_sensitive, true)),
-      prefix_rewrite_(route.route().prefix_rewrite()), host_rewrite_(route.route().host_rewrite()),
-      vhost_(vhost),
+      prefix_rewrite_(vhost.intern(route.route().prefix_rewrite())),
+      host_rewrite_(vhost.intern(route.route().host_rewrite())), vhost_(vhost),
       auto_host_rewrite_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.route(), auto_host_rewrite, false)),
       use_websocket_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.route(), use_websocket, false)),
-      cluster_name_(route.route().cluster()), cluster_header_name_(route.route().cluster_header()),
+      cluster_name_(vhost.intern(route.route().cluster())),
+      cluster_header_name_(route.route().cluster_header()),
       timeout_(PROTOBUF_GET_MS_OR_DEFAULT(route.route(), timeout, DEFAULT_ROUTE_TIMEOUT_MS)),
       runtime_(loadRuntimeData(route.match())), loader_(loader),
-      host_redirect_(route.redirect().host_redirect()),
-      path_redirect_(route.redirect().path_redirect()), retry_policy_(route.route()),
+      host_redirect_(vhost.intern(route.redirect().host_redirect())),
+      path_redirect_(vhost.intern(route.redirect().path_redirect())), retry_policy_(route.route()),
       rate_limit_policy_(route.route().rate_limits()), shadow_policy_(route.route()),
       priority_(ConfigUtility::parsePriority(route.route().priority())),
       opaque_config_(parseOpaqueConfig(route)), decorator_(parseDecorator(route)) {
@@ -124,9 +127,13 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
 
     for (const auto& cluster : route.route().weighted_clusters().clusters()) {
       const std::string& cluster_name = cluster.name();
+      std::string runtime_key;
+      if (!runtime_key_prefix.empty()) {
+        runtime_key = runtime_key_prefix + "." + cluster_name;
+      }
       std::unique_ptr<WeightedClusterEntry> cluster_entry(
-          new WeightedClusterEntry(this, runtime_key_prefix + "." + cluster_name, loader_,
-                                   cluster_name, PROTOBUF_GET_WRAPPED_REQUIRED(cluster, weight)));
+          new WeightedClusterEntry(this, runtime_key, loader_, cm, cluster_name,
+                                   PROTOBUF_GET_WRAPPED_REQUIRED(cluster, weight)));
       weighted_clusters_.emplace_back(std::move(cluster_entry));
       total_weight += weighted_clusters_.back()->clusterWeight();
     }
@@ -135,20 +142,42 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
       throw EnvoyException(fmt::format("Sum of weights in the weighted_cluster should add up to {}",
                                        WeightedClusterEntry::MAX_CLUSTER_WEIGHT));
     }
+
+    if (runtime_key_prefix.empty()) {
+      // The weights cannot change at runtime, so compile the weighted choice into a direct
+      // lookup table over the weight space. See the note on weighted_cluster_table_.
+      weighted_cluster_table_.reserve(WeightedClusterEntry::MAX_CLUSTER_WEIGHT);
+      for (size_t i = 0; i < weighted_clusters_.size(); i++) {
+        weighted_cluster_table_.insert(weighted_cluster_table_.end(),
+                                       weighted_clusters_[i]->clusterWeight(),
+                                       static_cast<uint8_t>(i));
+      }
+      ASSERT(weighted_cluster_table_.size() == WeightedClusterEntry::MAX_CLUSTER_WEIGHT);
+    }
   }
 
   for (const auto& header_map : route.match().headers()) {
-    config_headers_.push_back(header_map);
+    config_headers_.add(header_map);
   }
 
   if (!route.route().hash_policy().empty()) {
     hash_policy_.reset(new HashPolicyImpl(route.route().hash_policy()));
   }
 
+  // Compile the full set of request headers to add into a single flat list: route-level headers,
+  // then virtual host level headers, then global connection manager level headers. This matches
+  // the documented application order and means finalizeRequestHeaders() walks one list instead of
+  // chasing three levels of config per request.
   for (const auto& header_value_option : route.route().request_headers_to_add()) {
     request_headers_to_add_.push_back({Http::LowerCaseString(header_value_option.header().key()),
                                        header_value_option.header().value()});
   }
+  for (const auto& to_add : vhost.requestHeadersToAdd()) {
+    request_headers_to_add_.push_back(to_add);
+  }
+  for (const auto& to_add : vhost.globalRouteConfig().requestHeadersToAdd()) {
+    request_headers_to_add_.push_back(to_add);
+  }
 
   // Only set include_vh_rate_limits_ to true if the rate limit policy for the route is empty
   // or the route set `include_vh_rate_limits` to true.
@@ -159,6 +188,14 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
   if (route.route().has_cors()) {
     cors_policy_.reset(new CorsPolicyImpl(route.route().cors()));
   }
+
+  if (!cluster_name_.empty()) {
+    // Bind the interned cluster handle now so that per-request forwarding resolves the cluster
+    // with an array index instead of hashing the name. Handles can be bound even if the cluster
+    // does not exist yet (e.g. an RDS route table that refers to a not yet delivered CDS
+    // cluster); resolution simply returns no cluster until it shows up.
+    cluster_handle_.value(cm.clusterHandle(cluster_name_));
+  }
 }
 
 bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers, uint64_t random_value) const {
@@ -169,7 +206,7 @@ bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers, uint64_t ran
                                                  random_value);
   }
 
-  matches &= ConfigUtility::matchHeaders(headers, config_headers_);
+  matches &= config_headers_.matches(headers);
 
   return matches;
 }
@@ -177,18 +214,12 @@ bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers, uint64_t ran
 const std::string& RouteEntryImplBase::clusterName() const { return cluster_name_; }
 
 void RouteEntryImplBase::finalizeRequestHeaders(Http::HeaderMap& headers) const {
-  // Append user-specified request headers in the following order: route-level headers,
-  // virtual host level headers and finally global connection manager level headers.
+  // request_headers_to_add_ was flattened at config load time and already contains the
+  // route-level, virtual host level and global connection manager level headers in application
+  // order.
   for (const std::pair<Http::LowerCaseString, std::string>& to_add : requestHeadersToAdd()) {
     headers.addReference(to_add.first, to_add.second);
   }
-  for (const std::pair<Http::LowerCaseString, std::string>& to_add : vhost_.requestHeadersToAdd()) {
-    headers.addReference(to_add.first, to_add.second);
-  }
-  for (const std::pair<Http::LowerCaseString, std::string>& to_add :
-       vhost_.globalRouteConfig().requestHeadersToAdd()) {
-    headers.addReference(to_add.first, to_add.second);
-  }
 
   if (host_rewrite_.empty()) {
     return;
@@ -313,6 +344,11 @@ RouteConstSharedPtr RouteEntryImplBase::clusterEntry(const Http::HeaderMap& head
   }
 
   uint64_t selected_value = random_value % WeightedClusterEntry::MAX_CLUSTER_WEIGHT;
+  if (!weighted_cluster_table_.empty()) {
+    // Fixed weights were compiled into a direct lookup table at config load.
+    return weighted_clusters_[weighted_cluster_table_[selected_value]];
+  }
+
   uint64_t begin = 0UL;
   uint64_t end = 0UL;
 
@@ -362,8 +398,8 @@ void RouteEntryImplBase::validateClusters(Upstream::ClusterManager& cm) const {
 
 PrefixRouteEntryImpl::PrefixRouteEntryImpl(const VirtualHostImpl& vhost,
                                            const envoy::api::v2::Route& route,
-                                           Runtime::Loader& loader)
-    : RouteEntryImplBase(vhost, route, loader), prefix_(route.match().prefix()) {}
+                                           Runtime::Loader& loader, Upstream::ClusterManager& cm)
+    : RouteEntryImplBase(vhost, route, loader, cm), prefix_(route.match().prefix()) {}
 
 void PrefixRouteEntryImpl::finalizeRequestHeaders(Http::HeaderMap& headers) const {
   RouteEntryImplBase::finalizeRequestHeaders(headers);
@@ -381,8 +417,9 @@ RouteConstSharedPtr PrefixRouteEntryImpl::matches(const Http::HeaderMap& headers
 }
 
 PathRouteEntryImpl::PathRouteEntryImpl(const VirtualHostImpl& vhost,
-                                       const envoy::api::v2::Route& route, Runtime::Loader& loader)
-    : RouteEntryImplBase(vhost, route, loader), path_(route.match().path()) {}
+                                       const envoy::api::v2::Route& route, Runtime::Loader& loader,
+                                       Upstream::ClusterManager& cm)
+    : RouteEntryImplBase(vhost, route, loader, cm), path_(route.match().path()) {}
 
 void PathRouteEntryImpl::finalizeRequestHeaders(Http::HeaderMap& headers) const {
   RouteEntryImplBase::finalizeRequestHeaders(headers);
@@ -420,16 +457,23 @@ RouteConstSharedPtr PathRouteEntryImpl::matches(const Http::HeaderMap& headers,
 
 RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::Route& route,
-                                         Runtime::Loader& loader)
-    : RouteEntryImplBase(vhost, route, loader),
-      regex_(std::regex{route.match().regex().c_str(), std::regex::optimize}) {}
+                                         Runtime::Loader& loader, Upstream::ClusterManager& cm)
+    : RouteEntryImplBase(vhost, route, loader, cm),
+      regex_(route.match().regex(), re2::RE2::Quiet) {
+  // RE2 reports compilation failures through ok() rather than throwing.
+  if (!regex_.ok()) {
+    throw EnvoyException(
+        fmt::format("Invalid regex '{}': {}", route.match().regex(), regex_.error()));
+  }
+}
 
 void RegexRouteEntryImpl::finalizeRequestHeaders(Http::HeaderMap& headers) const {
   RouteEntryImplBase::finalizeRequestHeaders(headers);
 
   const Http::HeaderString& path = headers.Path()->value();
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(re2::RE2::FullMatch(
+      re2::StringPiece(path.c_str(), query_string_start - path.c_str()), regex_));
   std::string matched_path(path.c_str(), query_string_start);
   finalizePathHeader(headers, matched_path);
 }
@@ -439,7 +483,8 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
   if (RouteEntryImplBase::matchRoute(headers, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (re2::RE2::FullMatch(re2::StringPiece(path.c_str(), query_string_start - path.c_str()),
+                            regex_)) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -449,8 +494,8 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
 VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host,
                                  const ConfigImpl& global_route_config, Runtime::Loader& runtime,
                                  Upstream::ClusterManager& cm, bool validate_clusters)
-    : name_(virtual_host.name()), rate_limit_policy_(virtual_host.rate_limits()),
-      global_route_config_(global_route_config) {
+    : name_(virtual_host.name()), virtual_cluster_catch_all_(virtual_host.name()),
+      rate_limit_policy_(virtual_host.rate_limits()), global_route_config_(global_route_config) {
   switch (virtual_host.require_tls()) {
   case envoy::api::v2::VirtualHost::NONE:
     ssl_requirements_ = SslRequirements::NONE;
@@ -477,13 +522,13 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
     const bool has_regex =
         route.match().path_specifier_case() == envoy::api::v2::RouteMatch::kRegex;
     if (has_prefix) {
-      routes_.emplace_back(new PrefixRouteEntryImpl(*this, route, runtime));
+      routes_.emplace_back(new PrefixRouteEntryImpl(*this, route, runtime, cm));
     } else if (has_path) {
-      routes_.emplace_back(new PathRouteEntryImpl(*this, route, runtime));
+      routes_.emplace_back(new PathRouteEntryImpl(*this, route, runtime, cm));
     } else {
       ASSERT(has_regex);
       UNREFERENCED_PARAMETER(has_regex);
-      routes_.emplace_back(new RegexRouteEntryImpl(*this, route, runtime));
+      routes_.emplace_back(new RegexRouteEntryImpl(*this, route, runtime, cm));
     }
 
     if (validate_clusters) {
@@ -497,8 +542,27 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
     }
   }
 
-  for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
-    virtual_clusters_.push_back(VirtualClusterEntry(virtual_cluster));
+  buildRouteTrie();
+
+  if (virtual_host.virtual_clusters_size() > 0) {
+    // All patterns go into a single anchored RE2 set so that matching a request path against the
+    // virtual clusters costs one automaton pass no matter how many are configured.
+    re2::RE2::Options options;
+    options.set_log_errors(false);
+    virtual_cluster_set_.reset(new re2::RE2::Set(options, re2::RE2::ANCHOR_BOTH));
+    for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
+      std::string error;
+      if (virtual_cluster_set_->Add(virtual_cluster.pattern(), &error) < 0) {
+        throw EnvoyException(
+            fmt::format("Invalid regex '{}': {}", virtual_cluster.pattern(), error));
+      }
+      virtual_clusters_.push_back(VirtualClusterEntry(name_, virtual_cluster));
+    }
+
+    if (!virtual_cluster_set_->Compile()) {
+      // Compile() only fails when the combined program exceeds RE2's memory budget.
+      throw EnvoyException("virtual cluster patterns are too large to compile into one program");
+    }
   }
 
   if (virtual_host.has_cors()) {
@@ -506,6 +570,10 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
   }
 }
 
+const std::string& VirtualHostImpl::intern(const std::string& value) const {
+  return global_route_config_.stringPool().intern(value);
+}
+
 bool VirtualHostImpl::usesRuntime() const {
   bool uses = false;
   for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
@@ -517,14 +585,16 @@ bool VirtualHostImpl::usesRuntime() const {
 }
 
 VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
-    const envoy::api::v2::VirtualCluster& virtual_cluster) {
+    const std::string& vhost_name, const envoy::api::v2::VirtualCluster& virtual_cluster) {
   if (virtual_cluster.method() != envoy::api::v2::RequestMethod::METHOD_UNSPECIFIED) {
     method_ = envoy::api::v2::RequestMethod_Name(virtual_cluster.method());
   }
 
-  const std::string pattern = virtual_cluster.pattern();
-  pattern_ = std::regex{pattern, std::regex::optimize};
+  // The pattern itself is compiled into the enclosing virtual host's RE2 set, which also
+  // validates it.
   name_ = virtual_cluster.name();
+  stats_.reset(new Http::LazyResponseCodeStats(
+      fmt::format("vhost.{}.vcluster.{}.", vhost_name, name_)));
 }
 
 const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
@@ -585,8 +655,24 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+  // Check for a route that matches the request. Candidates from the path trie are merged with
+  // the unindexed routes in config order since the first matching route wins.
+  std::vector<IndexedRoute> candidates;
+  collectTrieCandidates(headers, candidates);
+  std::sort(candidates.begin(), candidates.end(),
+            [](const IndexedRoute& lhs, const IndexedRoute& rhs) { return lhs.index_ < rhs.index_; });
+
+  auto trie_entry = candidates.begin();
+  auto linear_entry = unindexed_routes_.begin();
+  while (trie_entry != candidates.end() || linear_entry != unindexed_routes_.end()) {
+    const RouteEntryImplBase* route;
+    if (linear_entry == unindexed_routes_.end() ||
+        (trie_entry != candidates.end() && trie_entry->index_ < linear_entry->index_)) {
+      route = (trie_entry++)->route_;
+    } else {
+      route = (linear_entry++)->route_;
+    }
+
     RouteConstSharedPtr route_entry = route->matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
@@ -596,6 +682,63 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
   return nullptr;
 }
 
+void VirtualHostImpl::buildRouteTrie() {
+  for (uint32_t i = 0; i < routes_.size(); i++) {
+    const RouteEntryImplBase& route = *routes_[i];
+    // A '?' in the match string can never be reached by the trie walk, which stops at the start
+    // of the query string, but such routes still match linearly (prefix matching runs over the
+    // full :path including the query string). Keep them out of the trie.
+    if (!route.caseSensitive() ||
+        route.pathMatchType() == RouteEntryImplBase::PathMatchType::None ||
+        route.pathMatchString().find('?') != std::string::npos) {
+      unindexed_routes_.push_back({i, &route});
+      continue;
+    }
+
+    RouteTrieNode* node = &route_trie_root_;
+    for (char path_char : route.pathMatchString()) {
+      std::unique_ptr<RouteTrieNode>& child = node->children_[static_cast<uint8_t>(path_char)];
+      if (child == nullptr) {
+        child.reset(new RouteTrieNode());
+      }
+      node = child.get();
+    }
+    if (route.pathMatchType() == RouteEntryImplBase::PathMatchType::Prefix) {
+      node->prefix_routes_.push_back({i, &route});
+    } else {
+      node->exact_routes_.push_back({i, &route});
+    }
+  }
+}
+
+void VirtualHostImpl::collectTrieCandidates(const Http::HeaderMap& headers,
+                                            std::vector<IndexedRoute>& candidates) const {
+  if (route_trie_root_.children_.empty() && route_trie_root_.prefix_routes_.empty() &&
+      route_trie_root_.exact_routes_.empty()) {
+    return;
+  }
+
+  const char* path = headers.Path()->value().c_str();
+  const RouteTrieNode* node = &route_trie_root_;
+  while (true) {
+    // Any prefix route stored at this node matches the bytes consumed so far.
+    candidates.insert(candidates.end(), node->prefix_routes_.begin(), node->prefix_routes_.end());
+    const uint8_t path_char = static_cast<uint8_t>(*path);
+    if (path_char == '\0' || path_char == '?') {
+      // The path (not including any query string) has been fully consumed, so exact path routes
+      // stored at this node match as well.
+      candidates.insert(candidates.end(), node->exact_routes_.begin(), node->exact_routes_.end());
+      return;
+    }
+    const auto child = node->children_.find(path_char);
+    if (child == node->children_.end()) {
+      return;
+    }
+    node = child->second.get();
+    path++;
+  }
+}
+
 const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
   if (virtual_hosts_.empty() && default_virtual_host_) {
@@ -621,31 +764,42 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& head
 RouteConstSharedPtr RouteMatcher::route(const Http::HeaderMap& headers,
                                         uint64_t random_value) const {
   const VirtualHostImpl* virtual_host = findVirtualHost(headers);
+  RouteConstSharedPtr route;
   if (virtual_host) {
-    return virtual_host->getRouteFromEntries(headers, random_value);
-  } else {
-    return nullptr;
+    route = virtual_host->getRouteFromEntries(headers, random_value);
   }
+  // random_value is the stream id when routing a downstream request (see
+  // ActiveStream::refreshCachedRoute()).
+  ENVOY_PROBE2(route_resolved, random_value,
+               route != nullptr && route->routeEntry() != nullptr
+                   ? route->routeEntry()->clusterName().c_str()
+                   : "");
+  return route;
 }
 
-const VirtualHostImpl::CatchAllVirtualCluster VirtualHostImpl::VIRTUAL_CLUSTER_CATCH_ALL;
 const SslRedirector SslRedirectRoute::SSL_REDIRECTOR;
 const std::shared_ptr<const SslRedirectRoute> VirtualHostImpl::SSL_REDIRECT_ROUTE{
     new SslRedirectRoute()};
 
 const VirtualCluster*
 VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const {
-  for (const VirtualClusterEntry& entry : virtual_clusters_) {
-    bool method_matches =
-        !entry.method_.valid() || headers.Method()->value().c_str() == entry.method_.value();
-
-    if (method_matches && std::regex_match(headers.Path()->value().c_str(), entry.pattern_)) {
-      return &entry;
+  if (virtual_cluster_set_ != nullptr) {
+    // One pass over the path evaluates every pattern; the matched indices are then checked in
+    // config order so precedence is the same as the old per-entry scan.
+    std::vector<int> matches;
+    if (virtual_cluster_set_->Match(headers.Path()->value().c_str(), &matches)) {
+      std::sort(matches.begin(), matches.end());
+      for (int match : matches) {
+        const VirtualClusterEntry& entry = virtual_clusters_[match];
+        if (!entry.method_.valid() || headers.Method()->value().c_str() == entry.method_.value()) {
+          return &entry;
+        }
+      }
     }
   }
 
   if (virtual_clusters_.size() > 0) {
-    return &VIRTUAL_CLUSTER_CATCH_ALL;
+    return &virtual_cluster_catch_all_;
   }
 
   return nullptr;
@@ -653,10 +807,6 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
 
 ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config, Runtime::Loader& runtime,
                        Upstream::ClusterManager& cm, bool validate_clusters_default) {
-  route_matcher_.reset(new RouteMatcher(
-      config, *this, runtime, cm,
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default)));
-
   for (const std::string& header : config.internal_only_headers()) {
     internal_only_headers_.push_back(Http::LowerCaseString(header));
   }
@@ -674,6 +824,12 @@ ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config, Runtime
     request_headers_to_add_.push_back({Http::LowerCaseString(header_value_option.header().key()),
                                        header_value_option.header().value()});
   }
+
+  // The route matcher is built last: route entries flatten the global request headers to add into
+  // their own lists at construction time, so the list above must be complete first.
+  route_matcher_.reset(new RouteMatcher(
+      config, *this, runtime, cm,
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default)));
 }
 
 } // namespace Router
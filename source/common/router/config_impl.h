@@ -5,9 +5,9 @@
 #include <list>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "envoy/common/optional.h"
@@ -15,10 +15,15 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/empty_string.h"
+#include "common/http/codes.h"
 #include "common/router/config_utility.h"
 #include "common/router/router_ratelimit.h"
 
 #include "api/rds.pb.h"
+#include "fmt/format.h"
+#include "re2/re2.h"
+#include "re2/set.h"
 
 namespace Envoy {
 namespace Router {
@@ -90,6 +95,26 @@ private:
   bool enabled_;
 };
 
+/**
+ * Interns strings that repeat across route entries (cluster names, rewrite hosts, redirect
+ * targets). A large route table typically references a small set of clusters, so storing each
+ * distinct value once and handing out references cuts the table's footprint roughly in proportion
+ * to the duplication, both at steady state and at the peak during an RDS swap when two
+ * generations are alive. The pool is owned by the enclosing ConfigImpl and only mutated while the
+ * route table is being built; entries hold references into it for their lifetime.
+ */
+class StringPool {
+public:
+  /**
+   * @return a reference to a pooled copy of value, valid for the lifetime of the pool.
+   */
+  const std::string& intern(const std::string& value) { return *strings_.insert(value).first; }
+
+private:
+  // Node based container: references remain valid as more strings are interned.
+  std::unordered_set<std::string> strings_;
+};
+
 class ConfigImpl;
 /**
  * Holds all routing configuration for an entire virtual host.
@@ -109,6 +134,14 @@ public:
   }
   const ConfigImpl& globalRouteConfig() const { return global_route_config_; }
 
+  /**
+   * Intern a string in the global route config's pool. Used by route entries during construction
+   * for values that tend to repeat across a table. Defined in the .cc since ConfigImpl is
+   * incomplete here.
+   * @return a reference valid for the lifetime of the config.
+   */
+  const std::string& intern(const std::string& value) const;
+
   // Router::VirtualHost
   const CorsPolicy* corsPolicy() const override { return cors_policy_.get(); }
   const std::string& name() const override { return name_; }
@@ -118,29 +151,79 @@ private:
   enum class SslRequirements { NONE, EXTERNAL_ONLY, ALL };
 
   struct VirtualClusterEntry : public VirtualCluster {
-    VirtualClusterEntry(const envoy::api::v2::VirtualCluster& virtual_cluster);
+    VirtualClusterEntry(const std::string& vhost_name,
+                        const envoy::api::v2::VirtualCluster& virtual_cluster);
 
     // Router::VirtualCluster
     const std::string& name() const override { return name_; }
+    void chargeResponseStat(Stats::Scope& scope, uint64_t response_code) const override {
+      stats_->get(scope).charge(response_code);
+    }
+    void chargeResponseTiming(Stats::Scope& scope,
+                              std::chrono::milliseconds response_time) const override {
+      stats_->get(scope).chargeTiming(response_time);
+    }
 
-    std::regex pattern_;
     Optional<std::string> method_;
     std::string name_;
+    // Held by pointer so entries can move when the enclosing vector grows: the lazy stats embed
+    // atomics.
+    std::unique_ptr<Http::LazyResponseCodeStats> stats_;
   };
 
   struct CatchAllVirtualCluster : public VirtualCluster {
+    CatchAllVirtualCluster(const std::string& vhost_name)
+        : stats_(fmt::format("vhost.{}.vcluster.{}.", vhost_name, name_)) {}
+
     // Router::VirtualCluster
     const std::string& name() const override { return name_; }
+    void chargeResponseStat(Stats::Scope& scope, uint64_t response_code) const override {
+      stats_.get(scope).charge(response_code);
+    }
+    void chargeResponseTiming(Stats::Scope& scope,
+                              std::chrono::milliseconds response_time) const override {
+      stats_.get(scope).chargeTiming(response_time);
+    }
 
     std::string name_{"other"};
+    mutable Http::LazyResponseCodeStats stats_;
   };
 
-  static const CatchAllVirtualCluster VIRTUAL_CLUSTER_CATCH_ALL;
   static const std::shared_ptr<const SslRedirectRoute> SSL_REDIRECT_ROUTE;
 
+  // A route along with its position in the config. Matching must consider candidates in config
+  // order since the first matching route wins.
+  struct IndexedRoute {
+    uint32_t index_;
+    const RouteEntryImplBase* route_; // Raw pointer into routes_ which owns the entry.
+  };
+
+  /**
+   * A trie over the paths of case sensitive prefix and exact path routes. Lookup walks the
+   * request path byte by byte collecting candidate routes, so matching cost is proportional to
+   * path length rather than route count. Regex and case insensitive routes stay on a linear
+   * scan list and are merged with the trie candidates in config order.
+   */
+  struct RouteTrieNode {
+    std::unordered_map<uint8_t, std::unique_ptr<RouteTrieNode>> children_;
+    std::vector<IndexedRoute> prefix_routes_;
+    std::vector<IndexedRoute> exact_routes_;
+  };
+
+  void buildRouteTrie();
+  void collectTrieCandidates(const Http::HeaderMap& headers,
+                             std::vector<IndexedRoute>& candidates) const;
+
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  RouteTrieNode route_trie_root_;
+  std::vector<IndexedRoute> unindexed_routes_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
+  // All virtual cluster patterns compiled into one RE2 set, so stat attribution costs a single
+  // automaton pass over the path regardless of how many virtual clusters are configured. Indices
+  // into the set match indices into virtual_clusters_.
+  std::unique_ptr<re2::RE2::Set> virtual_cluster_set_;
+  const CatchAllVirtualCluster virtual_cluster_catch_all_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
   std::unique_ptr<const CorsPolicyImpl> cors_policy_;
@@ -225,10 +308,25 @@ class RouteEntryImplBase : public RouteEntry,
                            public std::enable_shared_from_this<RouteEntryImplBase> {
 public:
   RouteEntryImplBase(const VirtualHostImpl& vhost, const envoy::api::v2::Route& route,
-                     Runtime::Loader& loader);
+                     Runtime::Loader& loader, Upstream::ClusterManager& cm);
 
   bool isRedirect() const { return !host_redirect_.empty() || !path_redirect_.empty(); }
   bool usesRuntime() const { return runtime_.valid(); }
+  bool caseSensitive() const { return case_sensitive_; }
+
+  /**
+   * The type of path matching a route performs. Used by the virtual host to index prefix and
+   * exact path routes into a trie. Routes that match on a regex return None and are only
+   * evaluated via the linear scan path.
+   */
+  enum class PathMatchType { None, Prefix, Exact };
+  virtual PathMatchType pathMatchType() const { return PathMatchType::None; }
+
+  /**
+   * @return the prefix or exact path this route matches on, or the empty string for routes
+   *         that are not indexable.
+   */
+  virtual const std::string& pathMatchString() const { return EMPTY_STRING; }
 
   bool matchRoute(const Http::HeaderMap& headers, uint64_t random_value) const;
   void validateClusters(Upstream::ClusterManager& cm) const;
@@ -238,6 +336,7 @@ public:
 
   // Router::RouteEntry
   const std::string& clusterName() const override;
+  Optional<uint64_t> clusterHandle() const override { return cluster_handle_; }
   const CorsPolicy* corsPolicy() const override { return cors_policy_.get(); }
   void finalizeRequestHeaders(Http::HeaderMap& headers) const override;
   const HashPolicy* hashPolicy() const override { return hash_policy_.get(); }
@@ -267,8 +366,10 @@ public:
 
 protected:
   const bool case_sensitive_;
-  const std::string prefix_rewrite_;
-  const std::string host_rewrite_;
+  // References into the owning ConfigImpl's string pool: rewrite and redirect strings and cluster
+  // names repeat heavily across large route tables, so each distinct value is stored once.
+  const std::string& prefix_rewrite_;
+  const std::string& host_rewrite_;
   bool include_vh_rate_limits_;
 
   RouteConstSharedPtr clusterEntry(const Http::HeaderMap& headers, uint64_t random_value) const;
@@ -288,6 +389,10 @@ private:
     // Router::RouteEntry
     const std::string& clusterName() const override { return cluster_name_; }
 
+    // The cluster name is only known per-request, so there is no handle to bind. Weighted
+    // cluster entries override this since their names are static.
+    Optional<uint64_t> clusterHandle() const override { return Optional<uint64_t>(); }
+
     void finalizeRequestHeaders(Http::HeaderMap& headers) const override {
       return parent_->finalizeRequestHeaders(headers);
     }
@@ -334,12 +439,18 @@ private:
   class WeightedClusterEntry : public DynamicRouteEntry {
   public:
     WeightedClusterEntry(const RouteEntryImplBase* parent, const std::string runtime_key,
-                         Runtime::Loader& loader, const std::string& name, uint64_t weight)
+                         Runtime::Loader& loader, Upstream::ClusterManager& cm,
+                         const std::string& name, uint64_t weight)
         : DynamicRouteEntry(parent, name), runtime_key_(runtime_key), loader_(loader),
-          cluster_weight_(weight) {}
+          cluster_handle_(cm.clusterHandle(name)), cluster_weight_(weight) {}
+
+    // Router::RouteEntry
+    Optional<uint64_t> clusterHandle() const override { return cluster_handle_; }
 
     uint64_t clusterWeight() const {
-      return loader_.snapshot().getInteger(runtime_key_, cluster_weight_);
+      // An empty key means no runtime_key_prefix was configured, so the weight is fixed.
+      return runtime_key_.empty() ? cluster_weight_
+                                  : loader_.snapshot().getInteger(runtime_key_, cluster_weight_);
     }
 
     static const uint64_t MAX_CLUSTER_WEIGHT;
@@ -347,6 +458,7 @@ private:
   private:
     const std::string runtime_key_;
     Runtime::Loader& loader_;
+    const Optional<uint64_t> cluster_handle_;
     const uint64_t cluster_weight_;
   };
 
@@ -367,19 +479,25 @@ private:
                                  // to virtual host is currently safe.
   const bool auto_host_rewrite_;
   const bool use_websocket_;
-  const std::string cluster_name_;
+  const std::string& cluster_name_; // Interned, see note on prefix_rewrite_.
+  Optional<uint64_t> cluster_handle_;
   const Http::LowerCaseString cluster_header_name_;
   const std::chrono::milliseconds timeout_;
   const Optional<RuntimeData> runtime_;
   Runtime::Loader& loader_;
-  const std::string host_redirect_;
-  const std::string path_redirect_;
+  const std::string& host_redirect_; // Interned, see note on prefix_rewrite_.
+  const std::string& path_redirect_; // Interned, see note on prefix_rewrite_.
   const RetryPolicyImpl retry_policy_;
   const RateLimitPolicyImpl rate_limit_policy_;
   const ShadowPolicyImpl shadow_policy_;
   const Upstream::ResourcePriority priority_;
-  std::vector<ConfigUtility::HeaderData> config_headers_;
+  ConfigUtility::HeaderMatchProgram config_headers_;
   std::vector<WeightedClusterEntrySharedPtr> weighted_clusters_;
+  // When no runtime_key_prefix is configured the weights are fixed at config load, and the
+  // weighted choice is compiled into a direct lookup table over the weight space: entry i holds
+  // the index into weighted_clusters_ that a selected value of i routes to. Empty when weights
+  // can be overridden through runtime, which takes the dynamic scan in clusterEntry().
+  std::vector<uint8_t> weighted_cluster_table_;
   std::unique_ptr<const HashPolicyImpl> hash_policy_;
   std::list<std::pair<Http::LowerCaseString, std::string>> request_headers_to_add_;
 
@@ -395,7 +513,7 @@ private:
 class PrefixRouteEntryImpl : public RouteEntryImplBase {
 public:
   PrefixRouteEntryImpl(const VirtualHostImpl& vhost, const envoy::api::v2::Route& route,
-                       Runtime::Loader& loader);
+                       Runtime::Loader& loader, Upstream::ClusterManager& cm);
 
   // Router::RouteEntry
   void finalizeRequestHeaders(Http::HeaderMap& headers) const override;
@@ -403,6 +521,10 @@ public:
   // Router::Matchable
   RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
 
+  // Router::RouteEntryImplBase
+  PathMatchType pathMatchType() const override { return PathMatchType::Prefix; }
+  const std::string& pathMatchString() const override { return prefix_; }
+
 private:
   const std::string prefix_;
 };
@@ -413,7 +535,7 @@ private:
 class PathRouteEntryImpl : public RouteEntryImplBase {
 public:
   PathRouteEntryImpl(const VirtualHostImpl& vhost, const envoy::api::v2::Route& route,
-                     Runtime::Loader& loader);
+                     Runtime::Loader& loader, Upstream::ClusterManager& cm);
 
   // Router::RouteEntry
   void finalizeRequestHeaders(Http::HeaderMap& headers) const override;
@@ -421,6 +543,10 @@ public:
   // Router::Matchable
   RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
 
+  // Router::RouteEntryImplBase
+  PathMatchType pathMatchType() const override { return PathMatchType::Exact; }
+  const std::string& pathMatchString() const override { return path_; }
+
 private:
   const std::string path_;
 };
@@ -431,7 +557,7 @@ private:
 class RegexRouteEntryImpl : public RouteEntryImplBase {
 public:
   RegexRouteEntryImpl(const VirtualHostImpl& vhost, const envoy::api::v2::Route& route,
-                      Runtime::Loader& loader);
+                      Runtime::Loader& loader, Upstream::ClusterManager& cm);
 
   // Router::RouteEntry
   void finalizeRequestHeaders(Http::HeaderMap& headers) const override;
@@ -440,7 +566,7 @@ public:
   RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
 
 private:
-  const std::regex regex_;
+  const re2::RE2 regex_;
 };
 
 /**
@@ -488,6 +614,12 @@ public:
     return request_headers_to_add_;
   }
 
+  /**
+   * @return the pool strings shared across this config's route entries are interned in. Only
+   *         mutated while the route table is being constructed.
+   */
+  StringPool& stringPool() const { return string_pool_; }
+
   // Router::Config
   RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value) const override {
     return route_matcher_->route(headers, random_value);
@@ -509,6 +641,10 @@ public:
   bool usesRuntime() const override { return route_matcher_->usesRuntime(); }
 
 private:
+  // Mutable so route entries can intern through the const reference they hold while the
+  // (logically immutable) table is being built. Declared before route_matcher_ so the pooled
+  // strings outlive the entries referencing them.
+  mutable StringPool string_pool_;
   std::unique_ptr<RouteMatcher> route_matcher_;
   std::list<Http::LowerCaseString> internal_only_headers_;
   std::list<std::pair<Http::LowerCaseString, std::string>> response_headers_to_add_;
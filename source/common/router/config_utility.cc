@@ -1,6 +1,6 @@
 #include "common/router/config_utility.h"
 
-#include <regex>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -21,28 +21,70 @@ ConfigUtility::parsePriority(const envoy::api::v2::RoutingPriority& priority) {
   }
 }
 
-bool ConfigUtility::matchHeaders(const Http::HeaderMap& request_headers,
-                                 const std::vector<HeaderData>& config_headers) {
-  bool matches = true;
-
-  if (!config_headers.empty()) {
-    for (const HeaderData& cfg_header_data : config_headers) {
-      const Http::HeaderEntry* header = request_headers.get(cfg_header_data.name_);
-      if (cfg_header_data.value_.empty()) {
-        matches &= (header != nullptr);
-      } else if (!cfg_header_data.is_regex_) {
-        matches &= (header != nullptr) && (header->value() == cfg_header_data.value_.c_str());
-      } else {
-        matches &= (header != nullptr) &&
-                   std::regex_match(header->value().c_str(), cfg_header_data.regex_pattern_);
+void ConfigUtility::HeaderMatchProgram::add(const HeaderData& header_data) {
+  Step* step = nullptr;
+  for (Step& existing : steps_) {
+    if (existing.name_.get() == header_data.name_.get()) {
+      step = &existing;
+      break;
+    }
+  }
+  if (step == nullptr) {
+    steps_.emplace_back(header_data.name_);
+    step = &steps_.back();
+  }
+
+  Check check;
+  check.value_ = header_data.value_;
+  if (header_data.value_.empty()) {
+    check.type_ = CheckType::Presence;
+  } else if (!header_data.is_regex_) {
+    check.type_ = CheckType::Exact;
+  } else {
+    check.type_ = CheckType::Regex;
+    check.regex_pattern_ = header_data.regex_pattern_;
+    // Matchers that use the same pattern share one compiled program. Programs are small so a
+    // linear scan at config time is fine.
+    for (const Step& existing : steps_) {
+      for (const Check& existing_check : existing.checks_) {
+        if (existing_check.type_ == CheckType::Regex && existing_check.value_ == check.value_) {
+          check.regex_pattern_ = existing_check.regex_pattern_;
+          break;
+        }
       }
-      if (!matches) {
+    }
+  }
+  step->checks_.push_back(std::move(check));
+}
+
+bool ConfigUtility::HeaderMatchProgram::matches(const Http::HeaderMap& request_headers) const {
+  for (const Step& step : steps_) {
+    // Every check requires the header to be present, so one fetch covers all the checks that
+    // reference it.
+    const Http::HeaderEntry* header = request_headers.get(step.name_);
+    if (header == nullptr) {
+      return false;
+    }
+    for (const Check& check : step.checks_) {
+      switch (check.type_) {
+      case CheckType::Presence:
+        break;
+      case CheckType::Exact:
+        if (header->value().size() != check.value_.size() ||
+            0 != memcmp(header->value().c_str(), check.value_.c_str(), check.value_.size())) {
+          return false;
+        }
+        break;
+      case CheckType::Regex:
+        if (!re2::RE2::FullMatch(header->value().c_str(), *check.regex_pattern_)) {
+          return false;
+        }
         break;
       }
     }
   }
 
-  return matches;
+  return true;
 }
 
 } // namespace Router
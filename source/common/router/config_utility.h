@@ -1,9 +1,10 @@
 #pragma once
 
-#include <regex>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "envoy/common/exception.h"
 #include "envoy/json/json_object.h"
 #include "envoy/upstream/resource_manager.h"
 
@@ -13,6 +14,8 @@
 #include "common/protobuf/utility.h"
 
 #include "api/rds.pb.h"
+#include "fmt/format.h"
+#include "re2/re2.h"
 
 namespace Envoy {
 namespace Router {
@@ -28,8 +31,16 @@ public:
     // exact string matching.
     HeaderData(const envoy::api::v2::HeaderMatcher& config)
         : name_(config.name()), value_(config.value()),
-          regex_pattern_(value_, std::regex::optimize),
-          is_regex_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, regex, false)) {}
+          is_regex_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, regex, false)),
+          regex_pattern_(is_regex_ ? new re2::RE2(value_, re2::RE2::Quiet) : nullptr) {
+      // The pattern is only compiled when regex matching was requested, so exact match values
+      // that happen to contain regex metacharacters are not rejected. RE2 reports compilation
+      // failures through ok() rather than throwing.
+      if (is_regex_ && !regex_pattern_->ok()) {
+        throw EnvoyException(
+            fmt::format("Invalid regex '{}': {}", value_, regex_pattern_->error()));
+      }
+    }
     HeaderData(const Json::Object& config)
         : HeaderData([&config] {
             envoy::api::v2::HeaderMatcher header_matcher;
@@ -39,24 +50,56 @@ public:
 
     const Http::LowerCaseString name_;
     const std::string value_;
-    const std::regex regex_pattern_;
     const bool is_regex_;
+    // Shared so that HeaderData remains copyable; RE2 programs are immutable and thread safe.
+    const std::shared_ptr<const re2::RE2> regex_pattern_;
   };
 
   /**
-   * @return the resource priority parsed from proto.
+   * A set of header matchers compiled at config time into a program evaluated in a single pass.
+   * Matchers are grouped by header name so each referenced request header is fetched exactly
+   * once per evaluation regardless of how many matchers reference it, exact matches reject on
+   * the precomputed value length before comparing bytes, and compiled regex programs are shared
+   * across matchers that use the same pattern.
    */
-  static Upstream::ResourcePriority parsePriority(const envoy::api::v2::RoutingPriority& priority);
+  class HeaderMatchProgram {
+  public:
+    /**
+     * Add a matcher to the program. All added matchers must pass for matches() to return true.
+     */
+    void add(const HeaderData& header_data);
+
+    /**
+     * @return whether every matcher in the program is satisfied by the request headers. An empty
+     *         program matches everything.
+     */
+    bool matches(const Http::HeaderMap& request_headers) const;
+
+  private:
+    enum class CheckType { Presence, Exact, Regex };
+
+    struct Check {
+      CheckType type_;
+      // The exact match value or the regex pattern; used to share compiled regex programs.
+      std::string value_;
+      std::shared_ptr<const re2::RE2> regex_pattern_;
+    };
+
+    // All checks against a single header, so the header is fetched once per evaluation.
+    struct Step {
+      Step(const Http::LowerCaseString& name) : name_(name) {}
+
+      Http::LowerCaseString name_;
+      std::vector<Check> checks_;
+    };
+
+    std::vector<Step> steps_;
+  };
 
   /**
-   * See if the specified headers are present in the request headers.
-   * @param headers supplies the list of headers to match
-   * @param request_headers supplies the list of request headers to compare against search_list
-   * @return true all the headers (and values) in the search_list set are found in the
-   * request_headers
+   * @return the resource priority parsed from proto.
    */
-  static bool matchHeaders(const Http::HeaderMap& headers,
-                           const std::vector<HeaderData>& request_headers);
+  static Upstream::ResourcePriority parsePriority(const envoy::api::v2::RoutingPriority& priority);
 };
 
 } // namespace Router
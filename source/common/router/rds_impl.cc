@@ -110,6 +110,8 @@ void RdsRouteConfigProviderImpl::onConfigUpdate(const ResourceVector& resources)
   }
   const uint64_t new_hash = MessageUtil::hash(route_config);
   if (new_hash != last_config_hash_ || !initialized_) {
+    // The expensive route table build happens exactly once here on the main thread. Workers only
+    // swap a shared_ptr to the immutable config, so a config reload never blocks the data path.
     ConfigConstSharedPtr new_config(new ConfigImpl(route_config, runtime_, cm_, false));
     initialized_ = true;
     last_config_hash_ = new_hash;
@@ -119,6 +121,9 @@ void RdsRouteConfigProviderImpl::onConfigUpdate(const ResourceVector& resources)
     tls_->runOnAllThreads(
         [this, new_config]() -> void { tls_->getTyped<ThreadLocalConfig>().config_ = new_config; });
     route_config_proto_ = route_config;
+  } else {
+    ENVOY_LOG(debug, "rds: no change in configuration, skipping update: config_name={} hash={}",
+              route_config_name_, new_hash);
   }
   runInitializeCallbackIfAny();
 }
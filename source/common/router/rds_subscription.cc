@@ -44,9 +44,20 @@ void RdsSubscription::createRequest(Http::Message& request) {
 void RdsSubscription::parseResponse(const Http::Message& response) {
   ENVOY_LOG(debug, "rds: parsing response");
   const std::string response_body = response.bodyAsString();
-  Json::ObjectSharedPtr response_json = Json::Factory::loadFromString(response_body);
   Protobuf::RepeatedPtrField<envoy::api::v2::RouteConfiguration> resources;
-  Envoy::Config::RdsJson::translateRouteConfiguration(*response_json, *resources.Add());
+  auto* route_config = resources.Add();
+
+  // The virtual host array is the bulk of any non-trivial route configuration; stream it out of
+  // the response so each virtual host is translated to its proto form as soon as it has been
+  // parsed and its JSON is released immediately. translateVirtualHost() performs the per-host
+  // schema validation; translateRouteConfiguration() validates the (now drained) envelope and
+  // fills in the remaining fields.
+  Json::ObjectSharedPtr response_json = Json::Factory::loadFromStringStreaming(
+      response_body, "virtual_hosts", [route_config](Json::ObjectSharedPtr virtual_host) -> void {
+        Envoy::Config::RdsJson::translateVirtualHost(*virtual_host,
+                                                     *route_config->mutable_virtual_hosts()->Add());
+      });
+  Envoy::Config::RdsJson::translateRouteConfiguration(*response_json, *route_config);
   resources[0].set_name(route_config_name_);
   callbacks_->onConfigUpdate(resources);
   version_info_ = Envoy::Config::Utility::computeHashedVersion(response_body);
@@ -27,6 +27,7 @@ const uint32_t RetryPolicy::RETRY_ON_GRPC_RESOURCE_EXHAUSTED;
 RetryStatePtr RetryStateImpl::create(const RetryPolicy& route_policy,
                                      Http::HeaderMap& request_headers,
                                      const Upstream::ClusterInfo& cluster, Runtime::Loader& runtime,
+                                     const Runtime::KeyHandleConstSharedPtr& use_retry_handle,
                                      Runtime::RandomGenerator& random,
                                      Event::Dispatcher& dispatcher,
                                      Upstream::ResourcePriority priority) {
@@ -35,8 +36,8 @@ RetryStatePtr RetryStateImpl::create(const RetryPolicy& route_policy,
   // We short circuit here and do not both with an allocation if there is no chance we will retry.
   if (request_headers.EnvoyRetryOn() || request_headers.EnvoyRetryGrpcOn() ||
       route_policy.retryOn()) {
-    ret.reset(new RetryStateImpl(route_policy, request_headers, cluster, runtime, random,
-                                 dispatcher, priority));
+    ret.reset(new RetryStateImpl(route_policy, request_headers, cluster, runtime, use_retry_handle,
+                                 random, dispatcher, priority));
   }
 
   request_headers.removeEnvoyRetryOn();
@@ -47,10 +48,11 @@ RetryStatePtr RetryStateImpl::create(const RetryPolicy& route_policy,
 
 RetryStateImpl::RetryStateImpl(const RetryPolicy& route_policy, Http::HeaderMap& request_headers,
                                const Upstream::ClusterInfo& cluster, Runtime::Loader& runtime,
+                               const Runtime::KeyHandleConstSharedPtr& use_retry_handle,
                                Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
                                Upstream::ResourcePriority priority)
-    : cluster_(cluster), runtime_(runtime), random_(random), dispatcher_(dispatcher),
-      priority_(priority) {
+    : cluster_(cluster), runtime_(runtime), use_retry_handle_(use_retry_handle), random_(random),
+      dispatcher_(dispatcher), priority_(priority) {
 
   if (request_headers.EnvoyRetryOn()) {
     retry_on_ = parseRetryOn(request_headers.EnvoyRetryOn()->value().c_str());
@@ -143,7 +145,7 @@ RetryStatus RetryStateImpl::shouldRetry(const Http::HeaderMap* response_headers,
     return RetryStatus::No;
   }
 
-  if (!runtime_.snapshot().featureEnabled("upstream.use_retry", 100)) {
+  if (!use_retry_handle_->featureEnabled()) {
     return RetryStatus::No;
   }
 
@@ -21,6 +21,7 @@ class RetryStateImpl : public RetryState {
 public:
   static RetryStatePtr create(const RetryPolicy& route_policy, Http::HeaderMap& request_headers,
                               const Upstream::ClusterInfo& cluster, Runtime::Loader& runtime,
+                              const Runtime::KeyHandleConstSharedPtr& use_retry_handle,
                               Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
                               Upstream::ResourcePriority priority);
   ~RetryStateImpl();
@@ -39,6 +40,7 @@ public:
 private:
   RetryStateImpl(const RetryPolicy& route_policy, Http::HeaderMap& request_headers,
                  const Upstream::ClusterInfo& cluster, Runtime::Loader& runtime,
+                 const Runtime::KeyHandleConstSharedPtr& use_retry_handle,
                  Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
                  Upstream::ResourcePriority priority);
 
@@ -49,6 +51,9 @@ private:
 
   const Upstream::ClusterInfo& cluster_;
   Runtime::Loader& runtime_;
+  // Pre-resolved by the filter config at construction time; checking it per retry decision is an
+  // atomic load rather than a snapshot map lookup.
+  const Runtime::KeyHandleConstSharedPtr use_retry_handle_;
   Runtime::RandomGenerator& random_;
   Event::Dispatcher& dispatcher_;
   uint32_t retry_on_{};
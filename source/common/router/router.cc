@@ -15,6 +15,7 @@
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
+#include "common/common/tracepoint.h"
 #include "common/common/utility.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
@@ -119,19 +120,26 @@ void Filter::chargeUpstreamCode(const Http::HeaderMap& response_headers,
     // TODO(mattklein123): Remove copy when G string compat issues are fixed.
     const std::string zone_name = config_.local_info_.zoneName();
 
+    // The virtual cluster is charged through its own pre-resolved counters below, so the info
+    // carries empty vhost/vcluster names to keep chargeResponseStat() from rebuilding them.
     Http::CodeUtility::ResponseStatInfo info{config_.scope_,
                                              cluster_->statsScope(),
                                              EMPTY_STRING,
                                              response_headers,
                                              internal_request,
-                                             route_entry_->virtualHost().name(),
-                                             request_vcluster_ ? request_vcluster_->name()
-                                                               : EMPTY_STRING,
+                                             EMPTY_STRING,
+                                             EMPTY_STRING,
                                              zone_name,
                                              upstreamZone(upstream_host),
                                              is_canary};
 
-    Http::CodeUtility::chargeResponseStat(info);
+    // The base family is fixed per cluster, so charge it through the pre-resolved counters.
+    Http::CodeUtility::chargeResponseStat(cluster_->responseCodeStatFamily(), info);
+
+    if (request_vcluster_) {
+      request_vcluster_->chargeResponseStat(config_.scope_,
+                                            Http::Utility::getResponseStatus(response_headers));
+    }
 
     if (!alt_stat_prefix_.empty()) {
       Http::CodeUtility::ResponseStatInfo info{config_.scope_,
@@ -185,9 +193,16 @@ Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool e
     return Http::FilterHeadersStatus::StopIteration;
   }
 
-  // A route entry matches for the request.
+  // A route entry matches for the request. Routes with a statically known cluster carry an
+  // interned handle bound at config load time; resolving it is an array index rather than a
+  // string hash. Per-request (cluster header) selections fall back to lookup by name.
   route_entry_ = route_->routeEntry();
-  Upstream::ThreadLocalCluster* cluster = config_.cm_.get(route_entry_->clusterName());
+  callbacks_->requestInfo().markPhase(Http::AccessLog::RequestPhase::RouteMatched,
+                                      callbacks_->dispatcher().approximateMonotonicTime());
+  const Optional<uint64_t>& cluster_handle = route_entry_->clusterHandle();
+  Upstream::ThreadLocalCluster* cluster = cluster_handle.valid()
+                                              ? config_.cm_.getByHandle(cluster_handle.value())
+                                              : config_.cm_.get(route_entry_->clusterName());
   if (!cluster) {
     config_.stats_.no_cluster_.inc();
     ENVOY_STREAM_LOG(debug, "unknown cluster '{}'", *callbacks_, route_entry_->clusterName());
@@ -261,6 +276,8 @@ Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool e
   ASSERT(headers.Host());
   ASSERT(headers.Path());
 
+  maybeStartShadow(headers, end_stream);
+
   upstream_request_.reset(new UpstreamRequest(*this, *conn_pool));
   upstream_request_->encodeHeaders(end_stream);
   if (end_stream) {
@@ -283,18 +300,30 @@ void Filter::sendNoHealthyUpstreamResponse() {
 }
 
 Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_stream) {
-  bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_;
+  bool buffering = (retry_state_ && retry_state_->enabled());
   if (buffering && buffer_limit_ > 0 &&
       getLength(callbacks_->decodingBuffer()) + data.length() > buffer_limit_) {
-    // The request is larger than we should buffer.  Give up on the retry/shadow
+    // The request is larger than we should buffer.  Give up on the retry.
     cluster_->stats().retry_or_shadow_abandoned_.inc();
     retry_state_.reset();
     buffering = false;
-    do_shadowing_ = false;
   }
 
-  // If we are going to buffer for retries or shadowing, we need to make a copy before encoding
-  // since it's all moves from here on.
+  // Shadowing is streamed and does not require buffering the primary. The shadow is bounded by
+  // the same limit that used to bound the shadow buffer; past it we cancel the shadow since we
+  // will not apply backpressure to the primary on its behalf.
+  if (shadow_stream_ != nullptr) {
+    shadow_bytes_ += data.length();
+    if (buffer_limit_ > 0 && shadow_bytes_ > buffer_limit_) {
+      cluster_->stats().retry_or_shadow_abandoned_.inc();
+      shadow_stream_.reset();
+    } else {
+      shadow_stream_->writeData(data, end_stream);
+    }
+  }
+
+  // If we are going to buffer for retries, we need to make a copy before encoding since it's all
+  // moves from here on.
   if (buffering) {
     Buffer::OwnedImpl copy(data);
     upstream_request_->encodeData(copy, end_stream);
@@ -306,7 +335,7 @@ Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_strea
     onRequestComplete();
   }
 
-  // If we are potentially going to retry or shadow this request we need to buffer.
+  // If we are potentially going to retry this request we need to buffer.
   // This will not cause the connection manager to 413 because before we hit the
   // buffer limit we give up on retries and buffering.
   return buffering ? Http::FilterDataStatus::StopIterationAndBuffer
@@ -315,6 +344,9 @@ Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_strea
 
 Http::FilterTrailersStatus Filter::decodeTrailers(Http::HeaderMap& trailers) {
   downstream_trailers_ = &trailers;
+  if (shadow_stream_ != nullptr) {
+    shadow_stream_->writeTrailers(trailers);
+  }
   upstream_request_->encodeTrailers(trailers);
   onRequestComplete();
   return Http::FilterTrailersStatus::StopIteration;
@@ -330,30 +362,28 @@ void Filter::setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callb
 
 void Filter::cleanup() {
   upstream_request_.reset();
+  retry_upstream_request_.reset();
   retry_state_.reset();
+  // If the shadow stream was fully written this lets it finish in the background; otherwise it
+  // cancels the shadow.
+  shadow_stream_.reset();
   if (response_timeout_) {
     response_timeout_->disableTimer();
     response_timeout_.reset();
   }
 }
 
-void Filter::maybeDoShadowing() {
+void Filter::maybeStartShadow(const Http::HeaderMap& headers, bool end_stream) {
   if (!do_shadowing_) {
     return;
   }
 
+  // The shadow is fed incrementally as the request streams through, so only the headers need to
+  // be copied here. Body data and trailers follow in decodeData()/decodeTrailers().
   ASSERT(!route_entry_->shadowPolicy().cluster().empty());
-  Http::MessagePtr request(new Http::RequestMessageImpl(
-      Http::HeaderMapPtr{new Http::HeaderMapImpl(*downstream_headers_)}));
-  if (callbacks_->decodingBuffer()) {
-    request->body().reset(new Buffer::OwnedImpl(*callbacks_->decodingBuffer()));
-  }
-  if (downstream_trailers_) {
-    request->trailers(Http::HeaderMapPtr{new Http::HeaderMapImpl(*downstream_trailers_)});
-  }
-
-  config_.shadowWriter().shadow(route_entry_->shadowPolicy().cluster(), std::move(request),
-                                timeout_.global_timeout_);
+  shadow_stream_ = config_.shadowWriter().streamShadow(
+      route_entry_->shadowPolicy().cluster(), Http::HeaderMapPtr{new Http::HeaderMapImpl(headers)},
+      end_stream, timeout_.global_timeout_);
 }
 
 void Filter::onRequestComplete() {
@@ -363,10 +393,6 @@ void Filter::onRequestComplete() {
 
   // Possible that we got an immediate reset.
   if (upstream_request_) {
-    // Even if we got an immediate reset, we could still shadow, but that is a riskier change and
-    // seems unnecessary right now.
-    maybeDoShadowing();
-
     upstream_request_->setupPerTryTimeout();
     if (timeout_.global_timeout_.count() > 0) {
       response_timeout_ =
@@ -480,6 +506,8 @@ Filter::streamResetReasonToResponseFlag(Http::StreamResetReason reset_reason) {
 void Filter::onUpstreamHeaders(Http::HeaderMapPtr&& headers, bool end_stream) {
   ENVOY_STREAM_LOG(debug, "upstream headers complete: end_stream={}", *callbacks_, end_stream);
   ASSERT(!downstream_response_started_);
+  ENVOY_PROBE2(upstream_response_start, callbacks_->streamId(),
+               route_entry_->clusterName().c_str());
 
   upstream_request_->upstream_host_->outlierDetector().putHttpResponseCode(
       Http::Utility::getResponseStatus(*headers));
@@ -505,10 +533,13 @@ void Filter::onUpstreamHeaders(Http::HeaderMapPtr&& headers, bool end_stream) {
     retry_state_.reset();
   }
 
+  const MonotonicTime response_received_time = std::chrono::steady_clock::now();
+  callbacks_->requestInfo().markPhase(Http::AccessLog::RequestPhase::FirstUpstreamByte,
+                                      response_received_time);
+
   // Only send upstream service time if we received the complete request and this is not a
   // premature response.
   if (DateUtil::timePointValid(downstream_request_complete_time_)) {
-    MonotonicTime response_received_time = std::chrono::steady_clock::now();
     std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         response_received_time - downstream_request_complete_time_);
     headers->insertEnvoyUpstreamServiceTime().value(ms.count());
@@ -552,6 +583,34 @@ void Filter::onUpstreamComplete() {
         std::chrono::steady_clock::now() - downstream_request_complete_time_);
 
     upstream_request_->upstream_host_->outlierDetector().putResponseTime(response_time);
+    cluster_->resourceManager(route_entry_->priority()).recordResponseTime(response_time);
+
+    // Per-phase breakdown of where this request's time went. Each histogram is charged with the
+    // delta from the preceding phase, so the phase histograms of a cluster sum (approximately)
+    // to its upstream_rq_time. Phases that were never reached (e.g. pool ready after a retry
+    // that short circuited) deliver nothing rather than a bogus zero.
+    const Http::AccessLog::RequestInfo& request_info = callbacks_->requestInfo();
+    const std::chrono::microseconds route_matched =
+        request_info.phaseDuration(Http::AccessLog::RequestPhase::RouteMatched);
+    const std::chrono::microseconds pool_ready =
+        request_info.phaseDuration(Http::AccessLog::RequestPhase::PoolReady);
+    const std::chrono::microseconds first_byte =
+        request_info.phaseDuration(Http::AccessLog::RequestPhase::FirstUpstreamByte);
+    if (route_matched.count() > 0) {
+      cluster_->statsScope().deliverTimingToSinks(
+          "upstream_rq_phase.route_match",
+          std::chrono::duration_cast<std::chrono::milliseconds>(route_matched));
+    }
+    if (pool_ready >= route_matched && route_matched.count() > 0) {
+      cluster_->statsScope().deliverTimingToSinks(
+          "upstream_rq_phase.pool_ready",
+          std::chrono::duration_cast<std::chrono::milliseconds>(pool_ready - route_matched));
+    }
+    if (first_byte >= pool_ready && pool_ready.count() > 0) {
+      cluster_->statsScope().deliverTimingToSinks(
+          "upstream_rq_phase.first_byte",
+          std::chrono::duration_cast<std::chrono::milliseconds>(first_byte - pool_ready));
+    }
 
     const Http::HeaderEntry* internal_request_header = downstream_headers_->EnvoyInternalRequest();
     const bool internal_request =
@@ -560,19 +619,24 @@ void Filter::onUpstreamComplete() {
     // TODO(mattklein123): Remove copy when G string compat issues are fixed.
     const std::string zone_name = config_.local_info_.zoneName();
 
+    // As with chargeUpstreamCode(), the virtual cluster timing is delivered through its own
+    // pre-built histogram name below, so the info carries empty vhost/vcluster names.
     Http::CodeUtility::ResponseTimingInfo info{config_.scope_,
                                                cluster_->statsScope(),
                                                EMPTY_STRING,
                                                response_time,
                                                upstream_request_->upstream_canary_,
                                                internal_request,
-                                               route_entry_->virtualHost().name(),
-                                               request_vcluster_ ? request_vcluster_->name()
-                                                                 : EMPTY_STRING,
+                                               EMPTY_STRING,
+                                               EMPTY_STRING,
                                                zone_name,
                                                upstreamZone(upstream_request_->upstream_host_)};
 
-    Http::CodeUtility::chargeResponseTiming(info);
+    Http::CodeUtility::chargeResponseTiming(cluster_->responseCodeStatFamily(), info);
+
+    if (request_vcluster_) {
+      request_vcluster_->chargeResponseTiming(config_.scope_, response_time);
+    }
 
     if (!alt_stat_prefix_.empty()) {
       Http::CodeUtility::ResponseTimingInfo info{config_.scope_,
@@ -608,7 +672,11 @@ bool Filter::setupRetry(bool end_stream) {
     upstream_request_->resetStream();
   }
 
-  upstream_request_.reset();
+  // Park the request for reuse by doRetry() rather than destroying it. With per try timeouts and
+  // multiple retries, reallocating the request along with its timer and buffers for every attempt
+  // adds allocator pressure on top of whatever is making the upstream fail.
+  upstream_request_->prepareForReuse();
+  retry_upstream_request_ = std::move(upstream_request_);
   return true;
 }
 
@@ -622,7 +690,11 @@ void Filter::doRetry() {
 
   ASSERT(response_timeout_ || timeout_.global_timeout_.count() == 0);
   ASSERT(!upstream_request_);
-  upstream_request_.reset(new UpstreamRequest(*this, *conn_pool));
+  ASSERT(retry_upstream_request_);
+  // Rebind the parked request from the previous attempt. The pool may be different since the retry
+  // may have selected a different host.
+  retry_upstream_request_->conn_pool_ = conn_pool;
+  upstream_request_ = std::move(retry_upstream_request_);
   upstream_request_->encodeHeaders(!callbacks_->decodingBuffer() && !downstream_trailers_);
   // It's possible we got immediately reset.
   if (upstream_request_) {
@@ -667,7 +739,7 @@ void Filter::UpstreamRequest::encodeHeaders(bool end_stream) {
   // It's possible for a reset to happen inline within the newStream() call. In this case, we might
   // get deleted inline as well. Only write the returned handle out if it is not nullptr to deal
   // with this case.
-  Http::ConnectionPool::Cancellable* handle = conn_pool_.newStream(*this, *this);
+  Http::ConnectionPool::Cancellable* handle = conn_pool_->newStream(*this, *this);
   if (handle) {
     conn_pool_stream_handle_ = handle;
   }
@@ -730,11 +802,35 @@ void Filter::UpstreamRequest::resetStream() {
   }
 }
 
+void Filter::UpstreamRequest::prepareForReuse() {
+  if (per_try_timeout_) {
+    per_try_timeout_->disableTimer();
+  }
+  clearRequestEncoder();
+
+  // If the stream was pending in the pool when it failed the pool invalidated the handle, so just
+  // forget it; resetStream() has already cancelled any handle that was still live.
+  conn_pool_stream_handle_ = nullptr;
+  deferred_reset_reason_ = Optional<Http::StreamResetReason>();
+  if (buffered_request_body_) {
+    // Keep the buffer but drop any body left over from the previous attempt; doRetry() re-encodes
+    // the body from the filter manager's buffered copy.
+    buffered_request_body_->drain(buffered_request_body_->length());
+  }
+  upstream_host_.reset();
+  calling_encode_headers_ = false;
+  upstream_canary_ = false;
+  encode_complete_ = false;
+  encode_trailers_ = false;
+}
+
 void Filter::UpstreamRequest::setupPerTryTimeout() {
-  ASSERT(!per_try_timeout_);
   if (parent_.timeout_.per_try_timeout_.count() > 0) {
-    per_try_timeout_ =
-        parent_.callbacks_->dispatcher().createTimer([this]() -> void { onPerTryTimeout(); });
+    // The timer object is retained across retries; only the first attempt allocates it.
+    if (!per_try_timeout_) {
+      per_try_timeout_ =
+          parent_.callbacks_->dispatcher().createTimer([this]() -> void { onPerTryTimeout(); });
+    }
     per_try_timeout_->enableTimer(parent_.timeout_.per_try_timeout_);
   }
 }
@@ -770,6 +866,9 @@ void Filter::UpstreamRequest::onPoolFailure(Http::ConnectionPool::PoolFailureRea
 void Filter::UpstreamRequest::onPoolReady(Http::StreamEncoder& request_encoder,
                                           Upstream::HostDescriptionConstSharedPtr host) {
   ENVOY_STREAM_LOG(debug, "pool ready", *parent_.callbacks_);
+  parent_.callbacks_->requestInfo().markPhase(
+      Http::AccessLog::RequestPhase::PoolReady,
+      parent_.callbacks_->dispatcher().approximateMonotonicTime());
   onUpstreamHostSelected(host);
   request_encoder.getStream().addCallbacks(*this);
 
@@ -807,8 +906,8 @@ ProdFilter::createRetryState(const RetryPolicy& policy, Http::HeaderMap& request
                              const Upstream::ClusterInfo& cluster, Runtime::Loader& runtime,
                              Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
                              Upstream::ResourcePriority priority) {
-  return RetryStateImpl::create(policy, request_headers, cluster, runtime, random, dispatcher,
-                                priority);
+  return RetryStateImpl::create(policy, request_headers, cluster, runtime,
+                                config_.use_retry_handle_, random, dispatcher, priority);
 }
 
 void Filter::UpstreamRequest::setRequestEncoder(Http::StreamEncoder& request_encoder) {
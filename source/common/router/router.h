@@ -83,7 +83,8 @@ public:
                Runtime::RandomGenerator& random, ShadowWriterPtr&& shadow_writer,
                bool emit_dynamic_stats)
       : scope_(scope), local_info_(local_info), cm_(cm), runtime_(runtime),
-        random_(random), stats_{ALL_ROUTER_STATS(POOL_COUNTER_PREFIX(scope, stat_prefix))},
+        random_(random), use_retry_handle_(runtime.registerKey("upstream.use_retry", 100)),
+        stats_{ALL_ROUTER_STATS(POOL_COUNTER_PREFIX(scope, stat_prefix))},
         emit_dynamic_stats_(emit_dynamic_stats), shadow_writer_(std::move(shadow_writer)) {}
 
   ShadowWriter& shadowWriter() { return *shadow_writer_; }
@@ -93,6 +94,9 @@ public:
   Upstream::ClusterManager& cm_;
   Runtime::Loader& runtime_;
   Runtime::RandomGenerator& random_;
+  // Pre-resolved handle for the key that gates all retries, registered once here so the
+  // per-request check in the retry state is an atomic load rather than a map lookup.
+  Runtime::KeyHandleConstSharedPtr use_retry_handle_;
   FilterStats stats_;
   const bool emit_dynamic_stats_;
 
@@ -146,7 +150,7 @@ private:
                            public Http::StreamCallbacks,
                            public Http::ConnectionPool::Callbacks {
     UpstreamRequest(Filter& parent, Http::ConnectionPool::Instance& pool)
-        : parent_(parent), conn_pool_(pool), calling_encode_headers_(false),
+        : parent_(parent), conn_pool_(&pool), calling_encode_headers_(false),
           upstream_canary_(false), encode_complete_(false), encode_trailers_(false) {}
 
     ~UpstreamRequest();
@@ -155,6 +159,10 @@ private:
     void encodeData(Buffer::Instance& data, bool end_stream);
     void encodeTrailers(const Http::HeaderMap& trailers);
     void resetStream();
+    // Returns the request to its initial state so it can encode another attempt, keeping the per
+    // try timer and body buffer allocations. Mirrors what the destructor releases, so nothing from
+    // the previous attempt stays live across the retry backoff.
+    void prepareForReuse();
     void setupPerTryTimeout();
     void onPerTryTimeout();
 
@@ -204,7 +212,9 @@ private:
     void readEnable();
 
     Filter& parent_;
-    Http::ConnectionPool::Instance& conn_pool_;
+    // A pointer rather than a reference since a retry may select a different host, and with it a
+    // different pool, and the request object is reused across attempts.
+    Http::ConnectionPool::Instance* conn_pool_;
     Event::TimerPtr per_try_timeout_;
     Http::ConnectionPool::Cancellable* conn_pool_stream_handle_{};
     Http::StreamEncoder* request_encoder_{};
@@ -238,7 +248,7 @@ private:
                                          Event::Dispatcher& dispatcher,
                                          Upstream::ResourcePriority priority) PURE;
   Http::ConnectionPool::Instance* getConnPool();
-  void maybeDoShadowing();
+  void maybeStartShadow(const Http::HeaderMap& headers, bool end_stream);
   void onRequestComplete();
   void onResponseTimeout();
   void onUpstreamHeaders(Http::HeaderMapPtr&& headers, bool end_stream);
@@ -251,7 +261,10 @@ private:
   bool setupRetry(bool end_stream);
   void doRetry();
 
+protected:
   FilterConfig& config_;
+
+private:
   Http::StreamDecoderFilterCallbacks* callbacks_{};
   RouteConstSharedPtr route_;
   const RouteEntry* route_entry_{};
@@ -262,10 +275,15 @@ private:
   FilterUtility::TimeoutData timeout_;
   Http::Code timeout_response_code_ = Http::Code::GatewayTimeout;
   UpstreamRequestPtr upstream_request_;
+  // Holds the upstream request between setupRetry() and doRetry() so the next attempt reuses it
+  // instead of reallocating it along with its timer and buffers.
+  UpstreamRequestPtr retry_upstream_request_;
   Http::HeaderMap* downstream_headers_{};
   Http::HeaderMap* downstream_trailers_{};
   MonotonicTime downstream_request_complete_time_;
   uint32_t buffer_limit_{0};
+  ShadowStreamPtr shadow_stream_;
+  uint64_t shadow_bytes_{0};
   bool stream_destroyed_{};
 
   bool downstream_response_started_ : 1;
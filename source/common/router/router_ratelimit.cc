@@ -67,7 +67,7 @@ HeaderValueMatchAction::HeaderValueMatchAction(
     : descriptor_value_(action.descriptor_value()),
       expect_match_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(action, expect_match, true)) {
   for (const auto& header_matcher : action.headers()) {
-    action_headers_.push_back(header_matcher);
+    action_headers_.add(header_matcher);
   }
 }
 
@@ -75,7 +75,7 @@ bool HeaderValueMatchAction::populateDescriptor(const Router::RouteEntry&,
                                                 RateLimit::Descriptor& descriptor,
                                                 const std::string&, const Http::HeaderMap& headers,
                                                 const std::string&) const {
-  if (expect_match_ == ConfigUtility::matchHeaders(headers, action_headers_)) {
+  if (expect_match_ == action_headers_.matches(headers)) {
     descriptor.entries_.push_back({"header_match", descriptor_value_});
     return true;
   } else {
@@ -98,7 +98,7 @@ public:
 private:
   const std::string descriptor_value_;
   const bool expect_match_;
-  std::vector<Router::ConfigUtility::HeaderData> action_headers_;
+  Router::ConfigUtility::HeaderMatchProgram action_headers_;
 };
 
 /*
@@ -3,20 +3,30 @@
 #include <chrono>
 #include <string>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
+#include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 
 namespace Envoy {
 namespace Router {
 
-void ShadowWriterImpl::shadow(const std::string& cluster, Http::MessagePtr&& request,
-                              std::chrono::milliseconds timeout) {
+namespace {
+
+void mangleShadowHost(Http::HeaderMap& headers) {
   // Switch authority to add a shadow postfix. This allows upstream logging to make a more sense.
   // TODO PERF: Avoid copy.
-  std::string host = request->headers().Host()->value().c_str();
+  std::string host = headers.Host()->value().c_str();
   ASSERT(!host.empty());
   host += "-shadow";
-  request->headers().Host()->value(host);
+  headers.Host()->value(host);
+}
+
+} // namespace
+
+void ShadowWriterImpl::shadow(const std::string& cluster, Http::MessagePtr&& request,
+                              std::chrono::milliseconds timeout) {
+  mangleShadowHost(request->headers());
 
   // Configuration should guarantee that cluster exists before calling here. This is basically
   // fire and forget. We don't handle cancelling.
@@ -24,5 +34,113 @@ void ShadowWriterImpl::shadow(const std::string& cluster, Http::MessagePtr&& req
                                               Optional<std::chrono::milliseconds>(timeout));
 }
 
+ShadowStreamPtr ShadowWriterImpl::streamShadow(const std::string& cluster,
+                                               Http::HeaderMapPtr&& headers, bool end_stream,
+                                               std::chrono::milliseconds timeout) {
+  mangleShadowHost(*headers);
+
+  // As with buffered shadowing, this is fire and forget: the stream object owns itself and runs
+  // to completion (or reset) in the background. The returned handle only feeds it.
+  ActiveShadowStream* shadow =
+      new ActiveShadowStream(cm_.httpAsyncClientForCluster(cluster), std::move(headers));
+  shadow->start(end_stream, timeout);
+  if (!shadow->active()) {
+    return nullptr;
+  }
+  return ShadowStreamPtr{new ShadowStreamImpl(*shadow)};
+}
+
+ActiveShadowStream::ActiveShadowStream(Http::AsyncClient& client, Http::HeaderMapPtr&& headers)
+    : client_(client), headers_(std::move(headers)), self_(this) {}
+
+void ActiveShadowStream::start(bool end_stream, std::chrono::milliseconds timeout) {
+  stream_ = client_.start(*this, Optional<std::chrono::milliseconds>(timeout));
+  if (stream_ == nullptr) {
+    cleanup();
+    return;
+  }
+
+  // Sending headers can fail the stream inline, in which case onReset() has already run and
+  // closeLocal() below is a no-op on a cleaned up stream.
+  stream_->sendHeaders(*headers_, end_stream);
+  closeLocal(end_stream);
+}
+
+void ActiveShadowStream::writeData(const Buffer::Instance& data, bool end_stream) {
+  ASSERT(!local_complete_);
+  if (remote_complete_) {
+    // The shadow response completed before the request finished streaming. There is nothing
+    // useful left to shadow, so tear the stream down.
+    stream_->reset();
+    return;
+  }
+
+  // A copy is unavoidable here since the primary stream consumes the original data when encoding
+  // it upstream.
+  Buffer::OwnedImpl copy(data);
+  stream_->sendData(copy, end_stream);
+  closeLocal(end_stream);
+}
+
+void ActiveShadowStream::writeTrailers(const Http::HeaderMap& trailers) {
+  ASSERT(!local_complete_);
+  if (remote_complete_) {
+    stream_->reset();
+    return;
+  }
+
+  trailers_.reset(new Http::HeaderMapImpl(trailers));
+  stream_->sendTrailers(*trailers_);
+  closeLocal(true);
+}
+
+void ActiveShadowStream::onHandleDestroyed() {
+  handle_ = nullptr;
+  if (stream_ != nullptr && !local_complete_) {
+    // The caller went away before the request was fully written; cancel the shadow. onReset()
+    // is called inline and cleans up.
+    stream_->reset();
+  }
+}
+
+void ActiveShadowStream::onHeaders(Http::HeaderMapPtr&&, bool end_stream) {
+  closeRemote(end_stream);
+}
+
+void ActiveShadowStream::onData(Buffer::Instance& data, bool end_stream) {
+  data.drain(data.length());
+  closeRemote(end_stream);
+}
+
+void ActiveShadowStream::onTrailers(Http::HeaderMapPtr&&) { closeRemote(true); }
+
+void ActiveShadowStream::onReset() { cleanup(); }
+
+void ActiveShadowStream::closeLocal(bool end_stream) {
+  local_complete_ |= end_stream;
+  if (local_complete_ && remote_complete_) {
+    cleanup();
+  }
+}
+
+void ActiveShadowStream::closeRemote(bool end_stream) {
+  remote_complete_ |= end_stream;
+  if (local_complete_ && remote_complete_) {
+    cleanup();
+  }
+}
+
+void ActiveShadowStream::cleanup() {
+  stream_ = nullptr;
+  if (handle_ != nullptr) {
+    handle_->active_ = nullptr;
+    handle_ = nullptr;
+  }
+  if (self_ != nullptr) {
+    // Deletion is deferred since cleanup can be reached from within our own stream callbacks.
+    client_.dispatcher().deferredDelete(std::move(self_));
+  }
+}
+
 } // namespace Router
 } // namespace Envoy
@@ -1,17 +1,23 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
 #include <string>
 
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/http/async_client.h"
 #include "envoy/router/shadow_writer.h"
 #include "envoy/upstream/cluster_manager.h"
 
 namespace Envoy {
 namespace Router {
 
+class ShadowStreamImpl;
+
 /**
  * Implementation of ShadowWriter that takes incoming requests to shadow and implements "fire and
- * forget" behavior using an async client.
+ * forget" behavior using an async client. Complete requests are sent via the async client's
+ * request API; streaming shadows are fed through an async client stream as data arrives.
  */
 class ShadowWriterImpl : public ShadowWriter, public Http::AsyncClient::Callbacks {
 public:
@@ -20,6 +26,8 @@ public:
   // Router::ShadowWriter
   void shadow(const std::string& cluster, Http::MessagePtr&& request,
               std::chrono::milliseconds timeout) override;
+  ShadowStreamPtr streamShadow(const std::string& cluster, Http::HeaderMapPtr&& headers,
+                               bool end_stream, std::chrono::milliseconds timeout) override;
 
   // Http::AsyncClient::Callbacks
   void onSuccess(Http::MessagePtr&&) override {}
@@ -29,5 +37,79 @@ private:
   Upstream::ClusterManager& cm_;
 };
 
+/**
+ * Writer side of an in-flight streaming shadow. The object owns itself and lives until the shadow
+ * stream completes or is reset, which can be well after the caller releases its handle. The
+ * response is thrown away as it arrives.
+ */
+class ActiveShadowStream : public Http::AsyncClient::StreamCallbacks,
+                           public Event::DeferredDeletable {
+public:
+  ActiveShadowStream(Http::AsyncClient& client, Http::HeaderMapPtr&& headers);
+
+  void start(bool end_stream, std::chrono::milliseconds timeout);
+  bool active() const { return stream_ != nullptr; }
+  void writeData(const Buffer::Instance& data, bool end_stream);
+  void writeTrailers(const Http::HeaderMap& trailers);
+  void onHandleDestroyed();
+
+  // Http::AsyncClient::StreamCallbacks
+  void onHeaders(Http::HeaderMapPtr&& headers, bool end_stream) override;
+  void onData(Buffer::Instance& data, bool end_stream) override;
+  void onTrailers(Http::HeaderMapPtr&& trailers) override;
+  void onReset() override;
+
+private:
+  friend class ShadowStreamImpl;
+
+  void closeLocal(bool end_stream);
+  void closeRemote(bool end_stream);
+  void cleanup();
+
+  Http::AsyncClient& client_;
+
+  // The async client stream holds references into the headers and trailers it is sent, so they
+  // are owned here for the lifetime of the stream.
+  Http::HeaderMapPtr headers_;
+  Http::HeaderMapPtr trailers_;
+
+  Http::AsyncClient::Stream* stream_{};
+  ShadowStreamImpl* handle_{};
+  std::unique_ptr<ActiveShadowStream> self_;
+  bool local_complete_{};
+  bool remote_complete_{};
+};
+
+/**
+ * Caller owned handle to an in-flight streaming shadow. All methods become no-ops once the
+ * underlying stream has gone away.
+ */
+class ShadowStreamImpl : public ShadowStream {
+public:
+  ShadowStreamImpl(ActiveShadowStream& active) : active_(&active) { active.handle_ = this; }
+  ~ShadowStreamImpl() {
+    if (active_ != nullptr) {
+      active_->onHandleDestroyed();
+    }
+  }
+
+  // Router::ShadowStream
+  void writeData(const Buffer::Instance& data, bool end_stream) override {
+    if (active_ != nullptr) {
+      active_->writeData(data, end_stream);
+    }
+  }
+  void writeTrailers(const Http::HeaderMap& trailers) override {
+    if (active_ != nullptr) {
+      active_->writeTrailers(trailers);
+    }
+  }
+
+private:
+  friend class ActiveShadowStream;
+
+  ActiveShadowStream* active_;
+};
+
 } // namespace Router
 } // namespace Envoy
@@ -3,6 +3,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <random>
 #include <string>
@@ -93,23 +94,51 @@ std::string RandomGeneratorImpl::uuid() {
 }
 
 SnapshotImpl::SnapshotImpl(const std::string& root_path, const std::string& override_path,
-                           RuntimeStats& stats, RandomGenerator& generator)
+                           RuntimeStats& stats, RandomGenerator& generator, FileCache& file_cache,
+                           const std::unordered_map<std::string, std::string>& admin_overrides)
     : generator_(generator) {
+  FileCache new_cache;
+  new_cache.reserve(file_cache.size());
+  values_.reserve(file_cache.size());
   try {
-    walkDirectory(root_path, "");
+    walkDirectory(root_path, "", file_cache, new_cache);
     if (Filesystem::directoryExists(override_path)) {
-      walkDirectory(override_path, "");
+      walkDirectory(override_path, "", file_cache, new_cache);
       stats.override_dir_exists_.inc();
     } else {
       stats.override_dir_not_exists_.inc();
     }
 
     stats.load_success_.inc();
+
+    // Only a fully successful load advances the cache. This both drops entries for files that
+    // no longer exist and makes sure a failed walk does not mask files that the next reload
+    // still needs to pick up.
+    file_cache = std::move(new_cache);
   } catch (EnvoyException& e) {
     stats.load_error_.inc();
     ENVOY_LOG(debug, "error creating runtime snapshot: {}", e.what());
   }
 
+  // Admin overrides are layered on top of whatever was loaded from disk, including when the disk
+  // load itself failed.
+  for (const auto& override : admin_overrides) {
+    std::shared_ptr<Entry> entry(new Entry());
+    entry->string_value_ = override.second;
+    uint64_t converted;
+    if (StringUtil::atoul(entry->string_value_.c_str(), converted)) {
+      entry->uint_value_.value(converted);
+    }
+
+    values_[override.first] = entry;
+  }
+
+  sorted_keys_.reserve(values_.size());
+  for (const auto& value : values_) {
+    sorted_keys_.push_back(value.first);
+  }
+  std::sort(sorted_keys_.begin(), sorted_keys_.end());
+
   stats.num_keys_.set(values_.size());
 }
 
@@ -118,20 +147,28 @@ const std::string& SnapshotImpl::get(const std::string& key) const {
   if (entry == values_.end()) {
     return EMPTY_STRING;
   } else {
-    return entry->second.string_value_;
+    return entry->second->string_value_;
   }
 }
 
+bool SnapshotImpl::keysWithPrefixExist(const std::string& prefix) const {
+  // The first key >= prefix in sorted order is the only candidate: either it starts with the
+  // prefix or nothing does.
+  auto it = std::lower_bound(sorted_keys_.begin(), sorted_keys_.end(), prefix);
+  return it != sorted_keys_.end() && it->compare(0, prefix.size(), prefix) == 0;
+}
+
 uint64_t SnapshotImpl::getInteger(const std::string& key, uint64_t default_value) const {
   auto entry = values_.find(key);
-  if (entry == values_.end() || !entry->second.uint_value_.valid()) {
+  if (entry == values_.end() || !entry->second->uint_value_.valid()) {
     return default_value;
   } else {
-    return entry->second.uint_value_.value();
+    return entry->second->uint_value_.value();
   }
 }
 
-void SnapshotImpl::walkDirectory(const std::string& path, const std::string& prefix) {
+void SnapshotImpl::walkDirectory(const std::string& path, const std::string& prefix,
+                                 FileCache& old_cache, FileCache& new_cache) {
   ENVOY_LOG(debug, "walking directory: {}", path);
   Directory current_dir(path);
   while (true) {
@@ -155,28 +192,58 @@ void SnapshotImpl::walkDirectory(const std::string& path, const std::string& pre
 
     if (entry->d_type == DT_DIR && std::string(entry->d_name) != "." &&
         std::string(entry->d_name) != "..") {
-      walkDirectory(full_path, full_prefix);
+      walkDirectory(full_path, full_prefix, old_cache, new_cache);
     } else if (entry->d_type == DT_REG) {
+      struct stat file_stat;
+      if (::stat(full_path.c_str(), &file_stat) != 0) {
+        throw EnvoyException(fmt::format("unable to stat file: {}", full_path));
+      }
+
+      auto cached = old_cache.find(full_path);
+      if (cached != old_cache.end() && cached->second.device_ == file_stat.st_dev &&
+          cached->second.inode_ == file_stat.st_ino && cached->second.size_ == file_stat.st_size &&
+          cached->second.last_modified_ == file_stat.st_mtime) {
+        // Unchanged since the last load. Reuse the parsed entry without reading the file.
+        values_[full_prefix] = cached->second.entry_;
+        new_cache[full_path] = cached->second;
+        continue;
+      }
+
       // Suck the file into a string. This is not very efficient but it should be good enough
       // for small files. Also, as noted elsewhere, none of this is non-blocking which could
       // theoretically lead to issues.
       ENVOY_LOG(debug, "reading file: {}", full_path);
-      Entry entry;
-      entry.string_value_ = Filesystem::fileReadToEnd(full_path);
-      StringUtil::rtrim(entry.string_value_);
+      std::shared_ptr<Entry> parsed(new Entry());
+      parsed->string_value_ = Filesystem::fileReadToEnd(full_path);
+      StringUtil::rtrim(parsed->string_value_);
 
       // As a perf optimization, attempt to convert the string into an integer. If we don't
       // succeed that's fine.
       uint64_t converted;
-      if (StringUtil::atoul(entry.string_value_.c_str(), converted)) {
-        entry.uint_value_.value(converted);
+      if (StringUtil::atoul(parsed->string_value_.c_str(), converted)) {
+        parsed->uint_value_.value(converted);
       }
 
-      values_[full_prefix] = entry;
+      values_[full_prefix] = parsed;
+      new_cache[full_path] = {file_stat.st_dev, file_stat.st_ino, file_stat.st_size,
+                              file_stat.st_mtime, parsed};
     }
   }
 }
 
+bool KeyHandleImpl::featureEnabled() const {
+  // Mirrors SnapshotImpl::featureEnabled(): avoid the PRNG when the cutoff makes the answer
+  // certain.
+  uint64_t cutoff = std::min(getInteger(), static_cast<uint64_t>(100));
+  if (cutoff == 0) {
+    return false;
+  } else if (cutoff == 100) {
+    return true;
+  } else {
+    return generator_.random() % 100 < cutoff;
+  }
+}
+
 LoaderImpl::LoaderImpl(Event::Dispatcher& dispatcher, ThreadLocal::SlotAllocator& tls,
                        const std::string& root_symlink_path, const std::string& subdir,
                        const std::string& override_dir, Stats::Store& store,
@@ -197,15 +264,60 @@ RuntimeStats LoaderImpl::generateStats(Stats::Store& store) {
   return stats;
 }
 
-void LoaderImpl::onSymlinkSwap() {
-  current_snapshot_.reset(new SnapshotImpl(root_path_, override_path_, stats_, generator_));
+void LoaderImpl::loadNewSnapshot() {
+  {
+    std::lock_guard<std::mutex> guard(handles_lock_);
+    current_snapshot_.reset(new SnapshotImpl(root_path_, override_path_, stats_, generator_,
+                                             file_cache_, admin_overrides_));
+
+    // Re-resolve all live handles against the new snapshot and drop entries for handles that
+    // have been released.
+    handles_.erase(std::remove_if(handles_.begin(), handles_.end(),
+                                  [this](const std::weak_ptr<KeyHandleImpl>& weak_handle) -> bool {
+                                    std::shared_ptr<KeyHandleImpl> handle = weak_handle.lock();
+                                    if (handle == nullptr) {
+                                      return true;
+                                    }
+
+                                    handle->refresh(*current_snapshot_);
+                                    return false;
+                                  }),
+                   handles_.end());
+  }
+
   ThreadLocal::ThreadLocalObjectSharedPtr ptr_copy = current_snapshot_;
   tls_->set([ptr_copy](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return ptr_copy;
   });
 }
 
+void LoaderImpl::mergeValues(const std::unordered_map<std::string, std::string>& values) {
+  for (const auto& value : values) {
+    if (value.second.empty()) {
+      admin_overrides_.erase(value.first);
+    } else {
+      admin_overrides_[value.first] = value.second;
+    }
+  }
+
+  stats_.admin_overrides_active_.set(admin_overrides_.size());
+
+  // The file cache makes this cheap: unchanged files are revalidated with a stat() but not
+  // re-read, so publishing the new snapshot is dominated by the cross thread set below.
+  loadNewSnapshot();
+}
+
+void LoaderImpl::onSymlinkSwap() { loadNewSnapshot(); }
+
 Snapshot& LoaderImpl::snapshot() { return tls_->getTyped<Snapshot>(); }
 
+KeyHandleConstSharedPtr LoaderImpl::registerKey(const std::string& key, uint64_t default_value) {
+  std::shared_ptr<KeyHandleImpl> handle(new KeyHandleImpl(key, default_value, generator_));
+  std::lock_guard<std::mutex> guard(handles_lock_);
+  handle->refresh(*current_snapshot_);
+  handles_.push_back(handle);
+  return handle;
+}
+
 } // namespace Runtime
 } // namespace Envoy
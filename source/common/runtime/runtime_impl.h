@@ -1,13 +1,17 @@
 #pragma once
 
 #include <dirent.h>
+#include <sys/stat.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/common/exception.h"
 #include "envoy/common/optional.h"
@@ -55,6 +59,7 @@ private:
   COUNTER(override_dir_not_exists)                                                                 \
   COUNTER(override_dir_exists)                                                                     \
   COUNTER(load_success)                                                                            \
+  GAUGE  (admin_overrides_active)                                                                  \
   GAUGE  (num_keys)
 // clang-format on
 
@@ -72,8 +77,30 @@ class SnapshotImpl : public Snapshot,
                      public ThreadLocal::ThreadLocalObject,
                      Logger::Loggable<Logger::Id::runtime> {
 public:
+  struct Entry {
+    std::string string_value_;
+    Optional<uint64_t> uint_value_;
+  };
+  typedef std::shared_ptr<const Entry> EntrySharedPtr;
+
+  /**
+   * Cache of parsed runtime files that the loader keeps across snapshot rebuilds. Entries are
+   * immutable and shared with any snapshot still referencing them; a file is only re-read when
+   * its stat identity (device, inode, size, mtime) differs from the cached one, so a reload
+   * after a symlink swap only pays for the files that actually changed.
+   */
+  struct CachedFile {
+    dev_t device_;
+    ino_t inode_;
+    off_t size_;
+    time_t last_modified_;
+    EntrySharedPtr entry_;
+  };
+  typedef std::unordered_map<std::string, CachedFile> FileCache;
+
   SnapshotImpl(const std::string& root_path, const std::string& override_path, RuntimeStats& stats,
-               RandomGenerator& generator);
+               RandomGenerator& generator, FileCache& file_cache,
+               const std::unordered_map<std::string, std::string>& admin_overrides);
 
   // Runtime::Snapshot
   bool featureEnabled(const std::string& key, uint64_t default_value, uint64_t random_value,
@@ -100,6 +127,7 @@ public:
   }
 
   const std::string& get(const std::string& key) const override;
+  bool keysWithPrefixExist(const std::string& prefix) const override;
   uint64_t getInteger(const std::string&, uint64_t default_value) const override;
 
 private:
@@ -116,22 +144,49 @@ private:
     DIR* dir_;
   };
 
-  struct Entry {
-    std::string string_value_;
-    Optional<uint64_t> uint_value_;
-  };
+  void walkDirectory(const std::string& path, const std::string& prefix, FileCache& old_cache,
+                     FileCache& new_cache);
+
+  std::unordered_map<std::string, EntrySharedPtr> values_;
+  // All keys in values_, sorted, built once at load time so that prefix existence checks are a
+  // binary search with no per-call allocation.
+  std::vector<std::string> sorted_keys_;
+  RandomGenerator& generator_;
+};
 
-  void walkDirectory(const std::string& path, const std::string& prefix);
+/**
+ * Implementation of KeyHandle backed by an atomic value. The owning loader re-resolves the key
+ * every time a new snapshot is loaded, so reads never touch the snapshot's key map.
+ */
+class KeyHandleImpl : public KeyHandle {
+public:
+  KeyHandleImpl(const std::string& key, uint64_t default_value, RandomGenerator& generator)
+      : key_(key), default_value_(default_value), generator_(generator), value_(default_value) {}
+
+  /**
+   * Re-resolve the key against a newly loaded snapshot.
+   */
+  void refresh(const Snapshot& snapshot) {
+    value_.store(snapshot.getInteger(key_, default_value_), std::memory_order_relaxed);
+  }
 
-  std::unordered_map<std::string, Entry> values_;
+  // Runtime::KeyHandle
+  uint64_t getInteger() const override { return value_.load(std::memory_order_relaxed); }
+  bool featureEnabled() const override;
+
+private:
+  const std::string key_;
+  const uint64_t default_value_;
   RandomGenerator& generator_;
+  std::atomic<uint64_t> value_;
 };
 
 /**
  * Implementation of Loader that watches a symlink for swapping and loads a specified subdirectory
  * from disk. A single snapshot is shared among all threads and referenced by shared_ptr such that
  * a new runtime can be swapped in by the main thread while workers are still using the previous
- * version.
+ * version. Reloads are incremental: parsed file entries are cached across rebuilds so only files
+ * that actually changed in the swap are re-read.
  */
 class LoaderImpl : public Loader {
 public:
@@ -141,9 +196,12 @@ public:
 
   // Runtime::Loader
   Snapshot& snapshot() override;
+  void mergeValues(const std::unordered_map<std::string, std::string>& values) override;
+  KeyHandleConstSharedPtr registerKey(const std::string& key, uint64_t default_value) override;
 
 private:
   RuntimeStats generateStats(Stats::Store& store);
+  void loadNewSnapshot();
   void onSymlinkSwap();
 
   Filesystem::WatcherPtr watcher_;
@@ -151,7 +209,16 @@ private:
   RandomGenerator& generator_;
   std::string root_path_;
   std::string override_path_;
+  SnapshotImpl::FileCache file_cache_;
   std::shared_ptr<SnapshotImpl> current_snapshot_;
+  // In memory overrides merged via the admin endpoint. Layered on top of every snapshot built
+  // from disk until explicitly removed.
+  std::unordered_map<std::string, std::string> admin_overrides_;
+  // Handles returned by registerKey(). The lock guards both the handle list and
+  // current_snapshot_ since configuration built on worker threads (e.g. per thread async
+  // clients) may register keys while the main thread is loading a new snapshot.
+  std::mutex handles_lock_;
+  std::vector<std::weak_ptr<KeyHandleImpl>> handles_;
   RuntimeStats stats_;
 };
 
@@ -164,6 +231,13 @@ public:
 
   // Runtime::Loader
   Snapshot& snapshot() override { return snapshot_; }
+  void mergeValues(const std::unordered_map<std::string, std::string>&) override {
+    throw EnvoyException("the null runtime loader does not support overrides");
+  }
+  KeyHandleConstSharedPtr registerKey(const std::string& key, uint64_t default_value) override {
+    // There is no snapshot data to resolve against, so the handle just reports its default.
+    return KeyHandleConstSharedPtr{new KeyHandleImpl(key, default_value, snapshot_.generator_)};
+  }
 
 private:
   struct NullSnapshotImpl : public Snapshot {
@@ -193,6 +267,8 @@ private:
 
     const std::string& get(const std::string&) const override { return EMPTY_STRING; }
 
+    bool keysWithPrefixExist(const std::string&) const override { return false; }
+
     uint64_t getInteger(const std::string&, uint64_t default_value) const override {
       return default_value;
     }
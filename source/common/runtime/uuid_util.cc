@@ -3,7 +3,6 @@
 #include <cstdint>
 #include <string>
 
-#include "common/common/utility.h"
 #include "common/runtime/runtime_impl.h"
 
 namespace Envoy {
@@ -12,9 +11,22 @@ bool UuidUtils::uuidModBy(const std::string& uuid, uint16_t& out, uint16_t mod)
     return false;
   }
 
-  uint64_t value;
-  if (!StringUtil::atoul(uuid.substr(0, 8).c_str(), value, 16)) {
-    return false;
+  // Parse the leading 8 hex digits in place. This runs per request for sampling decisions, so
+  // the temporary string and general purpose strtoul of the previous implementation are avoided.
+  uint64_t value = 0;
+  for (size_t i = 0; i < 8; i++) {
+    const char c = uuid[i];
+    uint8_t digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return false;
+    }
+    value = (value << 4) | digit;
   }
 
   out = value % mod;
@@ -1,6 +1,8 @@
 #include "common/ssl/connection_impl.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -8,6 +10,7 @@
 #include "common/common/empty_string.h"
 #include "common/common/hex.h"
 #include "common/network/utility.h"
+#include "common/ssl/handshake_offload.h"
 
 #include "openssl/err.h"
 #include "openssl/x509v3.h"
@@ -16,6 +19,14 @@ namespace Envoy {
 namespace Ssl {
 
 namespace {
+// Maximum TLS plaintext record size. Write buffer chain elements smaller than
+// MinDirectWriteSize are coalesced into a staging buffer of up to this size before being handed
+// to SSL_write(), so fragmented writes (e.g. many small HTTP/2 frames) do not each pay per
+// record padding, MAC and cipher setup overhead. Elements at or above MinDirectWriteSize are
+// written in place; for those the copy would cost more than the record overhead it saves.
+constexpr uint64_t MaxRecordPlaintextSize = 16384;
+constexpr uint64_t MinDirectWriteSize = 4096;
+
 // TODO(mattklein123): Currently we don't populate local address for client connections. Nothing
 // looks at this currently, but we may want to populate this later for logging purposes.
 Network::Address::InstanceConstSharedPtr
@@ -42,8 +53,17 @@ ConnectionImpl::ConnectionImpl(Event::DispatcherImpl& dispatcher, int fd,
   SSL_set_bio(ssl_.get(), bio, bio);
 
   SSL_set_mode(ssl_.get(), SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+  // doWriteToSocket() retries SSL_write() with the same parameters after SSL_ERROR_WANT_WRITE,
+  // which requires that existing write buffer chain elements never grow between calls. See the
+  // comment in Network::ConnectionImpl::write().
+  coalesce_small_writes_ = false;
   if (state == InitialState::Client) {
     SSL_set_connect_state(ssl_.get());
+    // Key client sessions by the remote peer so that reconnects after connection pool churn can
+    // resume instead of doing a full handshake.
+    session_key_ = remote_address->asString();
+    ctx_.attachSession(session_key_, ssl_.get());
   } else {
     ASSERT(state == InitialState::Server);
     SSL_set_accept_state(ssl_.get());
@@ -51,6 +71,18 @@ ConnectionImpl::ConnectionImpl(Event::DispatcherImpl& dispatcher, int fd,
 }
 
 ConnectionImpl::~ConnectionImpl() {
+  if (offload_state_ != nullptr) {
+    // A handshake is still running on the offload pool. The SSL object and socket cannot be torn
+    // down until it finishes, so wait for it here and then detach so that the posted completion
+    // callback (if it has not run yet) does not touch this connection.
+    {
+      std::unique_lock<std::mutex> lock(offload_state_->lock_);
+      offload_state_->cv_.wait(lock, [this]() -> bool { return offload_state_->done_; });
+    }
+    offload_state_->parent_ = nullptr;
+    offload_state_.reset();
+  }
+
   // Filters may care about whether this connection is an SSL connection or not in their
   // destructors for stat reasons. We destroy the filters here vs. the base class destructors
   // to make sure they have the chance to still inspect SSL specific data via virtual functions.
@@ -59,6 +91,12 @@ ConnectionImpl::~ConnectionImpl() {
 
 Network::ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
   if (!handshake_complete_) {
+    if (offload_state_ != nullptr) {
+      // An offloaded handshake is running; remember the event so it can be replayed when the
+      // offload completes.
+      offload_read_pending_ = true;
+      return {PostIoAction::KeepOpen, 0};
+    }
     PostIoAction action = doHandshake();
     if (action == PostIoAction::Close || !handshake_complete_) {
       return {action, 0};
@@ -70,10 +108,11 @@ Network::ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
   uint64_t bytes_read = 0;
   while (keep_reading) {
     // We use 2 slices here so that we can use the remainder of an existing buffer chain element
-    // if there is extra space. 16K read is arbitrary and can be tuned later.
+    // if there is extra space. SSL_read() decrypts directly into the reserved slices, so a full
+    // record's worth of reservation means plaintext is never staged in a temporary and copied.
     Buffer::RawSlice slices[2];
     uint64_t slices_to_commit = 0;
-    uint64_t num_slices = read_buffer_.reserve(16384, slices, 2);
+    uint64_t num_slices = read_buffer_.reserve(MaxRecordPlaintextSize, slices, 2);
     for (uint64_t i = 0; i < num_slices; i++) {
       int rc = SSL_read(ssl_.get(), slices[i].mem_, slices[i].len_);
       ENVOY_CONN_LOG(trace, "ssl read returns: {}", *this, rc);
@@ -113,29 +152,116 @@ Network::ConnectionImpl::IoResult ConnectionImpl::doReadFromSocket() {
 
 Network::ConnectionImpl::PostIoAction ConnectionImpl::doHandshake() {
   ASSERT(!handshake_complete_);
+  if (ctx_.offloadHandshake()) {
+    startHandshakeOffload();
+    return PostIoAction::KeepOpen;
+  }
+
   int rc = SSL_do_handshake(ssl_.get());
+  return onHandshakeResult(rc, rc == 1 ? 0 : SSL_get_error(ssl_.get(), rc));
+}
+
+Network::ConnectionImpl::PostIoAction ConnectionImpl::onHandshakeResult(int rc, int err) {
   if (rc == 1) {
     ENVOY_CONN_LOG(debug, "handshake complete", *this);
     handshake_complete_ = true;
     ctx_.logHandshake(ssl_.get());
+    if (!session_key_.empty()) {
+      ctx_.cacheSession(session_key_, ssl_.get());
+    }
     raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
     return state() == State::Open ? PostIoAction::KeepOpen : PostIoAction::Close;
   } else {
-    int err = SSL_get_error(ssl_.get(), rc);
     ENVOY_CONN_LOG(debug, "handshake error: {}", *this, err);
     switch (err) {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
       return PostIoAction::KeepOpen;
     default:
+      // For an offloaded handshake the thread local error queue was already drained on the
+      // offload thread, so draining again here is a harmless no-op.
       drainErrorQueue();
       return PostIoAction::Close;
     }
   }
 }
 
+void ConnectionImpl::startHandshakeOffload() {
+  ASSERT(offload_state_ == nullptr);
+  offload_state_.reset(new HandshakeOffloadState());
+  offload_state_->parent_ = this;
+
+  std::shared_ptr<HandshakeOffloadState> state = offload_state_;
+  SSL* ssl = ssl_.get();
+  Event::Dispatcher* dispatcher = &this->dispatcher();
+  HandshakeOffloadPool::get().post([state, ssl, this, dispatcher]() -> void {
+    // This runs on an offload thread. Using the SSL object and the connection here is safe
+    // because the connection's destructor waits for done_ to be set below before tearing anything
+    // down, and socket closes are deferred until the offload completes.
+    int rc = SSL_do_handshake(ssl);
+    int err = 0;
+    if (rc != 1) {
+      err = SSL_get_error(ssl, rc);
+      if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
+        // The OpenSSL error queue is thread local, so fatal errors must be drained on this thread
+        // for stats and logging to see them.
+        drainErrorQueue();
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(state->lock_);
+      state->rc_ = rc;
+      state->err_ = err;
+      state->done_ = true;
+    }
+    state->cv_.notify_all();
+
+    dispatcher->post([state]() -> void {
+      // Back on the worker thread. The connection may have been destroyed while this callback was
+      // in flight; the destructor (which also runs on this thread) clears parent_ in that case.
+      if (state->parent_ != nullptr) {
+        state->parent_->completeHandshakeOffload();
+      }
+    });
+  });
+}
+
+void ConnectionImpl::completeHandshakeOffload() {
+  ASSERT(offload_state_ != nullptr);
+  ASSERT(offload_state_->done_);
+  const int rc = offload_state_->rc_;
+  const int err = offload_state_->err_;
+  const bool replay_io = offload_read_pending_ || offload_write_pending_;
+  offload_read_pending_ = false;
+  offload_write_pending_ = false;
+  offload_state_->parent_ = nullptr;
+  offload_state_.reset();
+
+  if (offload_close_pending_) {
+    // The connection was closed while the handshake was running; finish tearing down the socket
+    // now that the offload thread is guaranteed not to touch it again.
+    offload_close_pending_ = false;
+    closeSocket(offload_close_event_);
+    return;
+  }
+
+  PostIoAction action = onHandshakeResult(rc, err);
+  if (action == PostIoAction::Close) {
+    closeSocket(Network::ConnectionEvent::RemoteClose);
+    return;
+  }
+
+  if (handshake_complete_ || replay_io) {
+    // Replay any read/write events observed while the handshake was offloaded and, on completion,
+    // flush data that was buffered during the handshake. With edge triggered events nothing will
+    // fire again on its own.
+    setReadWriteReady();
+  }
+}
+
 void ConnectionImpl::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -161,59 +287,77 @@ void ConnectionImpl::drainErrorQueue() {
 
 Network::ConnectionImpl::IoResult ConnectionImpl::doWriteToSocket() {
   if (!handshake_complete_) {
+    if (offload_state_ != nullptr) {
+      offload_write_pending_ = true;
+      return {PostIoAction::KeepOpen, 0};
+    }
     PostIoAction action = doHandshake();
     if (action == PostIoAction::Close || !handshake_complete_) {
       return {action, 0};
     }
   }
 
-  uint64_t original_buffer_length = write_buffer_->length();
   uint64_t total_bytes_written = 0;
-  bool keep_writing = true;
-  while ((original_buffer_length != total_bytes_written) && keep_writing) {
-    // Protect against stack overflow if the buffer has a very large buffer chain.
-    // TODO(mattklein123): See the comment on getRawSlices() for why we have to also check
-    // original_buffer_length != total_bytes_written during loop iteration.
-    // TODO(mattklein123): As it relates to our fairness efforts, we might want to limit the number
-    // of iterations of this loop, either by pure iterations, bytes written, etc.
+  while (write_buffer_->length() > 0) {
+    // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
+    // it again with the same parameters. Most implementations keep track of the last write size.
+    // In our case we don't need to do that because: a) SSL_write() will not write partial
+    // buffers. b) We only move() into the write buffer (coalesce_small_writes_ is disabled for
+    // SSL connections), which means that it's impossible for a particular chain to increase in
+    // size, and nothing is drained from it until SSL_write() succeeds. So both a direct retry
+    // (front chain element unchanged) and a staged retry (staging buffer untouched) are
+    // guaranteed to call SSL_write() with the same parameters.
     const uint64_t MAX_SLICES = 32;
     Buffer::RawSlice slices[MAX_SLICES];
-    uint64_t num_slices = write_buffer_->getRawSlices(slices, MAX_SLICES);
-
-    uint64_t inner_bytes_written = 0;
-    for (uint64_t i = 0; (i < num_slices) && (original_buffer_length != total_bytes_written); i++) {
-      // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
-      // it again with the same parameters. Most implementations keep track of the last write size.
-      // In our case we don't need to do that because: a) SSL_write() will not write partial
-      // buffers. b) We only move() into the write buffer, which means that it's impossible for a
-      // particular chain to increase in size. So as long as we start writing where we left off we
-      // are guaranteed to call SSL_write() with the same parameters.
-      int rc = SSL_write(ssl_.get(), slices[i].mem_, slices[i].len_);
-      ENVOY_CONN_LOG(trace, "ssl write returns: {}", *this, rc);
-      if (rc > 0) {
-        inner_bytes_written += rc;
-        total_bytes_written += rc;
+    const uint8_t* mem;
+    uint64_t len;
+    if (staged_bytes_ > 0) {
+      // Retry a previously coalesced record after SSL_ERROR_WANT_WRITE.
+      mem = record_staging_.get();
+      len = staged_bytes_;
+    } else {
+      const uint64_t num_slices = write_buffer_->getRawSlices(slices, MAX_SLICES);
+      ASSERT(num_slices > 0);
+      if (slices[0].len_ >= MinDirectWriteSize || num_slices == 1) {
+        mem = static_cast<const uint8_t*>(slices[0].mem_);
+        len = slices[0].len_;
       } else {
-        int err = SSL_get_error(ssl_.get(), rc);
-        switch (err) {
-        case SSL_ERROR_WANT_WRITE:
-          keep_writing = false;
-          break;
-        case SSL_ERROR_WANT_READ:
-        // Renegotiation has started. We don't handle renegotiation so just fall through.
-        default:
-          drainErrorQueue();
-          return {PostIoAction::Close, total_bytes_written};
+        // Coalesce a run of small chain elements into one full sized record.
+        if (record_staging_ == nullptr) {
+          record_staging_.reset(new uint8_t[MaxRecordPlaintextSize]);
         }
-
-        break;
+        uint64_t copied = 0;
+        for (uint64_t i = 0; i < num_slices && slices[i].len_ < MinDirectWriteSize &&
+                             copied < MaxRecordPlaintextSize;
+             i++) {
+          const uint64_t copy_size = std::min(slices[i].len_, MaxRecordPlaintextSize - copied);
+          memcpy(record_staging_.get() + copied, slices[i].mem_, copy_size);
+          copied += copy_size;
+        }
+        staged_bytes_ = copied;
+        mem = record_staging_.get();
+        len = staged_bytes_;
       }
     }
 
-    // Draining must be done within the inner loop, otherwise we will keep getting the same slices
-    // at the beginning of the buffer.
-    if (inner_bytes_written > 0) {
-      write_buffer_->drain(inner_bytes_written);
+    int rc = SSL_write(ssl_.get(), mem, len);
+    ENVOY_CONN_LOG(trace, "ssl write returns: {}", *this, rc);
+    if (rc > 0) {
+      ASSERT(static_cast<uint64_t>(rc) == len);
+      write_buffer_->drain(len);
+      total_bytes_written += len;
+      staged_bytes_ = 0;
+    } else {
+      int err = SSL_get_error(ssl_.get(), rc);
+      switch (err) {
+      case SSL_ERROR_WANT_WRITE:
+        return {PostIoAction::KeepOpen, total_bytes_written};
+      case SSL_ERROR_WANT_READ:
+      // Renegotiation has started. We don't handle renegotiation so just fall through.
+      default:
+        drainErrorQueue();
+        return {PostIoAction::Close, total_bytes_written};
+      }
     }
   }
 
@@ -233,10 +377,14 @@ std::string ConnectionImpl::uriSanLocalCertificate() {
   if (!cert) {
     return "";
   }
-  return getUriSanFromCertificate(cert);
+  return ContextImpl::uriSanFromCertificate(cert);
 }
 
 std::string ConnectionImpl::sha256PeerCertificateDigest() {
+  if (cached_sha256_peer_certificate_digest_.valid()) {
+    return cached_sha256_peer_certificate_digest_.value();
+  }
+
   bssl::UniquePtr<X509> cert(SSL_get_peer_certificate(ssl_.get()));
   if (!cert) {
     return "";
@@ -246,63 +394,44 @@ std::string ConnectionImpl::sha256PeerCertificateDigest() {
   unsigned int n;
   X509_digest(cert.get(), EVP_sha256(), computed_hash.data(), &n);
   RELEASE_ASSERT(n == computed_hash.size());
-  return Hex::encode(computed_hash);
+  cached_sha256_peer_certificate_digest_.value(Hex::encode(computed_hash));
+  return cached_sha256_peer_certificate_digest_.value();
 }
 
 std::string ConnectionImpl::subjectPeerCertificate() {
-  bssl::UniquePtr<X509> cert(SSL_get_peer_certificate(ssl_.get()));
-  if (!cert) {
-    return "";
+  if (!cached_subject_peer_certificate_.valid()) {
+    bssl::UniquePtr<X509> cert(SSL_get_peer_certificate(ssl_.get()));
+    if (!cert) {
+      return "";
+    }
+    cachePeerCertificateStrings(cert.get());
   }
-
-  bssl::UniquePtr<BIO> buf(BIO_new(BIO_s_mem()));
-  RELEASE_ASSERT(buf != nullptr);
-
-  // flags=XN_FLAG_RFC2253 is the documented parameter for single-line output in RFC 2253 format.
-  X509_NAME_print_ex(buf.get(), X509_get_subject_name(cert.get()), 0 /* indent */, XN_FLAG_RFC2253);
-
-  const uint8_t* data;
-  size_t data_len;
-  int rc = BIO_mem_contents(buf.get(), &data, &data_len);
-  ASSERT(rc == 1);
-  UNREFERENCED_PARAMETER(rc);
-  return std::string(reinterpret_cast<const char*>(data), data_len);
+  return cached_subject_peer_certificate_.value();
 }
 
 std::string ConnectionImpl::uriSanPeerCertificate() {
-  bssl::UniquePtr<X509> cert(SSL_get_peer_certificate(ssl_.get()));
-  if (!cert) {
-    return "";
+  if (!cached_uri_san_peer_certificate_.valid()) {
+    bssl::UniquePtr<X509> cert(SSL_get_peer_certificate(ssl_.get()));
+    if (!cert) {
+      return "";
+    }
+    cachePeerCertificateStrings(cert.get());
   }
-  return getUriSanFromCertificate(cert.get());
+  return cached_uri_san_peer_certificate_.value();
 }
 
-std::string ConnectionImpl::getUriSanFromCertificate(X509* cert) {
-  STACK_OF(GENERAL_NAME)* altnames = static_cast<STACK_OF(GENERAL_NAME)*>(
-      X509_get_ext_d2i(cert, NID_subject_alt_name, nullptr, nullptr));
-
-  if (altnames == nullptr) {
-    return "";
-  }
-
-  std::string result;
-  int n = sk_GENERAL_NAME_num(altnames);
-  if (n > 0) {
-    // Only take the first item in altnames since we only set one uri in cert.
-    GENERAL_NAME* altname = sk_GENERAL_NAME_value(altnames, 0);
-    switch (altname->type) {
-    case GEN_URI:
-      result.append(
-          reinterpret_cast<const char*>(ASN1_STRING_data(altname->d.uniformResourceIdentifier)));
-      break;
-    default:
-      // Default to empty;
-      break;
-    }
+void ConnectionImpl::cachePeerCertificateStrings(X509* cert) {
+  // Repeat peers usually hit the context's verification cache, which parsed these strings when
+  // the chain was first verified; otherwise fall back to parsing the certificate here.
+  std::string uri_san;
+  std::string subject;
+  if (ctx_.lookupVerificationCache(ContextImpl::peerChainDigest(ssl_.get()), uri_san, subject)) {
+    cached_uri_san_peer_certificate_.value(uri_san);
+    cached_subject_peer_certificate_.value(subject);
+  } else {
+    cached_uri_san_peer_certificate_.value(ContextImpl::uriSanFromCertificate(cert));
+    cached_subject_peer_certificate_.value(ContextImpl::subjectFromCertificate(cert));
   }
-
-  sk_GENERAL_NAME_pop_free(altnames, GENERAL_NAME_free);
-  return result;
 }
 
 ClientConnectionImpl::ClientConnectionImpl(Event::DispatcherImpl& dispatcher, Context& ctx,
@@ -315,6 +444,14 @@ ClientConnectionImpl::ClientConnectionImpl(Event::DispatcherImpl& dispatcher, Co
 void ClientConnectionImpl::connect() { doConnect(); }
 
 void ConnectionImpl::closeSocket(Network::ConnectionEvent close_type) {
+  if (offload_state_ != nullptr) {
+    // A handshake is running on the offload pool; defer the close until it completes so the
+    // offload thread never touches a closed (and possibly reused) fd.
+    offload_close_pending_ = true;
+    offload_close_event_ = close_type;
+    return;
+  }
+
   if (handshake_complete_ && state() != State::Closed) {
     // Attempt to send a shutdown before closing the socket. It's possible this won't go out if
     // there is no room on the socket. We can extend the state machine to handle this at some point
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 
+#include "envoy/common/optional.h"
+
 #include "common/network/connection_impl.h"
 #include "common/ssl/context_impl.h"
 
@@ -26,6 +31,8 @@ public:
   std::string nextProtocol() const override;
   Ssl::Connection* ssl() override { return this; }
   const Ssl::Connection* ssl() const override { return this; }
+  // TLS session state cannot follow the socket to another process.
+  int detachFd() override { return -1; }
 
   // Ssl::Connection
   bool peerCertificatePresented() override;
@@ -37,9 +44,26 @@ public:
   SSL* rawSslForTest() { return ssl_.get(); }
 
 private:
+  /**
+   * State shared between the connection and an offloaded handshake running on the
+   * HandshakeOffloadPool. parent_ is only touched from the worker thread; the remaining members
+   * are guarded by lock_ so the destructor can wait for an in-flight offload to finish.
+   */
+  struct HandshakeOffloadState {
+    std::mutex lock_;
+    std::condition_variable cv_;
+    bool done_{};
+    int rc_;
+    int err_;
+    ConnectionImpl* parent_;
+  };
+
   PostIoAction doHandshake();
+  PostIoAction onHandshakeResult(int rc, int err);
+  void startHandshakeOffload();
+  void completeHandshakeOffload();
   void drainErrorQueue();
-  std::string getUriSanFromCertificate(X509* cert);
+  void cachePeerCertificateStrings(X509* cert);
 
   // Network::ConnectionImpl
   void closeSocket(Network::ConnectionEvent close_type) override;
@@ -50,6 +74,26 @@ private:
   ContextImpl& ctx_;
   bssl::UniquePtr<SSL> ssl_;
   bool handshake_complete_{};
+  // Set for client connections only; keys the context's session cache by remote peer.
+  std::string session_key_;
+  // Non-null while a handshake is running on the offload pool.
+  std::shared_ptr<HandshakeOffloadState> offload_state_;
+  // Read/write events that fired while a handshake was offloaded, to replay on completion.
+  bool offload_read_pending_{};
+  bool offload_write_pending_{};
+  // A socket close requested while a handshake was offloaded, deferred so the offload thread
+  // never touches a closed fd.
+  bool offload_close_pending_{};
+  Network::ConnectionEvent offload_close_event_;
+  // Staging space for coalescing small write buffer chain elements into full sized TLS records.
+  // staged_bytes_ is non-zero while a coalesced record awaits a retry after
+  // SSL_ERROR_WANT_WRITE. See doWriteToSocket().
+  std::unique_ptr<uint8_t[]> record_staging_;
+  uint64_t staged_bytes_{};
+  // Lazily computed once per connection; the peer certificate cannot change after the handshake.
+  Optional<std::string> cached_uri_san_peer_certificate_;
+  Optional<std::string> cached_subject_peer_certificate_;
+  Optional<std::string> cached_sha256_peer_certificate_digest_;
 };
 
 class ClientConnectionImpl final : public ConnectionImpl, public Network::ClientConnection {
@@ -1,6 +1,7 @@
 #include "common/ssl/context_impl.h"
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -10,13 +11,44 @@
 
 #include "common/common/assert.h"
 #include "common/common/hex.h"
+#include "common/common/utility.h"
 
 #include "fmt/format.h"
+#include "openssl/cipher.h"
+#include "openssl/hmac.h"
+#include "openssl/rand.h"
+#include "openssl/sha.h"
 #include "openssl/x509v3.h"
 
 namespace Envoy {
 namespace Ssl {
 
+namespace {
+
+// Size of the shared server side session cache. The cache only serves clients that do not
+// support ticket based resumption, so it does not need to cover the full connection rate.
+constexpr uint32_t ServerSessionCacheSize = 10240;
+
+// How long a successful peer chain verification is reused before the full X.509 path building
+// runs again, and the cache size at which the cache is reset. The bound is well above the
+// expected distinct peer population; hitting it means the key space is churning anyway.
+const std::chrono::minutes VerificationCacheTTL{5};
+constexpr uint32_t VerificationCacheMaxSize = 4096;
+
+void updateDigestWithCert(SHA256_CTX& digest_ctx, X509* cert) {
+  int len = i2d_X509(cert, nullptr);
+  if (len <= 0) {
+    return;
+  }
+
+  std::vector<uint8_t> der(len);
+  uint8_t* data = der.data();
+  i2d_X509(cert, &data);
+  SHA256_Update(&digest_ctx, der.data(), der.size());
+}
+
+} // namespace
+
 const unsigned char ContextImpl::SERVER_SESSION_ID_CONTEXT = 1;
 
 ContextImpl::ContextImpl(ContextManagerImpl& parent, Stats::Scope& scope, ContextConfig& config)
@@ -142,8 +174,26 @@ bssl::UniquePtr<SSL> ContextImpl::newSsl() const {
   return bssl::UniquePtr<SSL>(SSL_new(ctx_.get()));
 }
 
+void ContextImpl::attachSession(const std::string&, SSL*) {}
+
+void ContextImpl::cacheSession(const std::string&, SSL*) {}
+
+bool ContextImpl::offloadHandshake() const { return false; }
+
 int ContextImpl::verifyCallback(X509_STORE_CTX* store_ctx, void* arg) {
   ContextImpl* impl = reinterpret_cast<ContextImpl*>(arg);
+  SSL* ssl = reinterpret_cast<SSL*>(
+      X509_STORE_CTX_get_ex_data(store_ctx, SSL_get_ex_data_X509_STORE_CTX_idx()));
+
+  // Repeat peers present byte identical chains, so a digest hit means the exact same chain
+  // already passed full verification recently and path building can be skipped.
+  const std::string chain_digest = peerChainDigest(ssl);
+  std::string uri_san;
+  std::string subject;
+  if (!chain_digest.empty() && impl->lookupVerificationCache(chain_digest, uri_san, subject)) {
+    impl->stats_.verify_cache_hit_.inc();
+    return 1;
+  }
 
   int ret = X509_verify_cert(store_ctx);
   if (ret <= 0) {
@@ -151,10 +201,12 @@ int ContextImpl::verifyCallback(X509_STORE_CTX* store_ctx, void* arg) {
     return ret;
   }
 
-  SSL* ssl = reinterpret_cast<SSL*>(
-      X509_STORE_CTX_get_ex_data(store_ctx, SSL_get_ex_data_X509_STORE_CTX_idx()));
   bssl::UniquePtr<X509> cert(SSL_get_peer_certificate(ssl));
-  return impl->verifyCertificate(cert.get());
+  ret = impl->verifyCertificate(cert.get());
+  if (ret == 1 && !chain_digest.empty()) {
+    impl->insertVerificationCache(chain_digest, cert.get());
+  }
+  return ret;
 }
 
 int ContextImpl::verifyCertificate(X509* cert) {
@@ -172,9 +224,114 @@ int ContextImpl::verifyCertificate(X509* cert) {
   return 1;
 }
 
+std::string ContextImpl::peerChainDigest(SSL* ssl) {
+  bssl::UniquePtr<X509> leaf(SSL_get_peer_certificate(ssl));
+  if (leaf == nullptr) {
+    return "";
+  }
+
+  SHA256_CTX digest_ctx;
+  SHA256_Init(&digest_ctx);
+  updateDigestWithCert(digest_ctx, leaf.get());
+
+  // The chain as presented, excluding the leaf on the server side. Hashing everything the peer
+  // sent means any change to the intermediates forces a fresh verification.
+  STACK_OF(X509)* chain = SSL_get_peer_cert_chain(ssl);
+  if (chain != nullptr) {
+    for (size_t i = 0; i < sk_X509_num(chain); i++) {
+      updateDigestWithCert(digest_ctx, sk_X509_value(chain, i));
+    }
+  }
+
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &digest_ctx);
+  return Hex::encode(digest, SHA256_DIGEST_LENGTH);
+}
+
+bool ContextImpl::lookupVerificationCache(const std::string& chain_digest, std::string& uri_san,
+                                          std::string& subject) {
+  const MonotonicTime now = ProdMonotonicTimeSource::instance_.currentTime();
+  std::unique_lock<std::mutex> lock(verification_cache_lock_);
+  auto entry = verification_cache_.find(chain_digest);
+  if (entry == verification_cache_.end()) {
+    return false;
+  }
+
+  if (now >= entry->second.expiry_) {
+    verification_cache_.erase(entry);
+    return false;
+  }
+
+  uri_san = entry->second.uri_san_;
+  subject = entry->second.subject_;
+  return true;
+}
+
+void ContextImpl::insertVerificationCache(const std::string& chain_digest, X509* leaf_cert) {
+  VerificationCacheEntry entry;
+  entry.expiry_ = ProdMonotonicTimeSource::instance_.currentTime() + VerificationCacheTTL;
+  entry.uri_san_ = uriSanFromCertificate(leaf_cert);
+  entry.subject_ = subjectFromCertificate(leaf_cert);
+
+  std::unique_lock<std::mutex> lock(verification_cache_lock_);
+  if (verification_cache_.size() >= VerificationCacheMaxSize) {
+    // Crude but bounded: reset the whole cache rather than maintaining LRU ordering. With a
+    // stable peer population this never triggers.
+    verification_cache_.clear();
+  }
+  verification_cache_[chain_digest] = std::move(entry);
+}
+
+std::string ContextImpl::uriSanFromCertificate(X509* cert) {
+  STACK_OF(GENERAL_NAME)* altnames = static_cast<STACK_OF(GENERAL_NAME)*>(
+      X509_get_ext_d2i(cert, NID_subject_alt_name, nullptr, nullptr));
+
+  if (altnames == nullptr) {
+    return "";
+  }
+
+  std::string result;
+  int n = sk_GENERAL_NAME_num(altnames);
+  if (n > 0) {
+    // Only take the first item in altnames since we only set one uri in cert.
+    GENERAL_NAME* altname = sk_GENERAL_NAME_value(altnames, 0);
+    switch (altname->type) {
+    case GEN_URI:
+      result.append(
+          reinterpret_cast<const char*>(ASN1_STRING_data(altname->d.uniformResourceIdentifier)));
+      break;
+    default:
+      // Default to empty;
+      break;
+    }
+  }
+
+  sk_GENERAL_NAME_pop_free(altnames, GENERAL_NAME_free);
+  return result;
+}
+
+std::string ContextImpl::subjectFromCertificate(X509* cert) {
+  bssl::UniquePtr<BIO> buf(BIO_new(BIO_s_mem()));
+  RELEASE_ASSERT(buf != nullptr);
+
+  // flags=XN_FLAG_RFC2253 is the documented parameter for single-line output in RFC 2253 format.
+  X509_NAME_print_ex(buf.get(), X509_get_subject_name(cert), 0 /* indent */, XN_FLAG_RFC2253);
+
+  const uint8_t* data;
+  size_t data_len;
+  int rc = BIO_mem_contents(buf.get(), &data, &data_len);
+  ASSERT(rc == 1);
+  UNREFERENCED_PARAMETER(rc);
+  return std::string(reinterpret_cast<const char*>(data), data_len);
+}
+
 void ContextImpl::logHandshake(SSL* ssl) const {
   stats_.handshake_.inc();
 
+  if (SSL_session_reused(ssl)) {
+    stats_.session_reused_.inc();
+  }
+
   const char* cipher = SSL_get_cipher_name(ssl);
   scope_.counter(fmt::format("ssl.ciphers.{}", std::string{cipher})).inc();
 
@@ -329,6 +486,10 @@ ClientContextImpl::ClientContextImpl(ContextManagerImpl& parent, Stats::Scope& s
   }
 
   server_name_indication_ = config.serverNameIndication();
+
+  // Client side session caching so that reconnects to a recently used upstream host can resume
+  // instead of paying for a full handshake.
+  SSL_CTX_set_session_cache_mode(ctx_.get(), SSL_SESS_CACHE_CLIENT);
 }
 
 bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
@@ -343,6 +504,27 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
   return ssl_con;
 }
 
+void ClientContextImpl::attachSession(const std::string& session_key, SSL* ssl) {
+  std::unique_lock<std::mutex> lock(session_cache_lock_);
+  auto entry = session_cache_.find(session_key);
+  if (entry != session_cache_.end()) {
+    // SSL_set_session() takes its own reference on the session.
+    SSL_set_session(ssl, entry->second.get());
+  }
+}
+
+void ClientContextImpl::cacheSession(const std::string& session_key, SSL* ssl) {
+  bssl::UniquePtr<SSL_SESSION> session(SSL_get1_session(ssl));
+  if (session == nullptr) {
+    return;
+  }
+
+  // Store unconditionally so that a fresh ticket issued during a resumed handshake replaces the
+  // one it was derived from.
+  std::unique_lock<std::mutex> lock(session_cache_lock_);
+  session_cache_[session_key] = std::move(session);
+}
+
 ServerContextImpl::ServerContextImpl(ContextManagerImpl& parent, Stats::Scope& scope,
                                      ServerContextConfig& config, Runtime::Loader& runtime)
     : ContextImpl(parent, scope, config), runtime_(runtime) {
@@ -370,6 +552,166 @@ ServerContextImpl::ServerContextImpl(ContextManagerImpl& parent, Stats::Scope& s
                                },
                                this);
   }
+
+  // The SSL_CTX is shared by every worker, so BoringSSL's internal server session cache doubles
+  // as a process wide store: a session established on one worker can be resumed by a client that
+  // lands on a different one. Tickets are the preferred mechanism; the cache covers clients that
+  // do not support them.
+  SSL_CTX_set_session_cache_mode(ctx_.get(), SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size(ctx_.get(), ServerSessionCacheSize);
+
+  // Ticket keys come from the runtime so that they survive restarts and can be rotated without
+  // invalidating outstanding tickets. When no keys are configured BoringSSL keeps its default
+  // random per process key; enabling runtime keys after startup requires a listener reload.
+  raw_ticket_keys_ = runtime_.snapshot().get("ssl.ticket_keys");
+  std::vector<SessionTicketKey> initial_keys = parseTicketKeys(raw_ticket_keys_);
+  if (!initial_keys.empty()) {
+    ticket_keys_ = std::make_shared<const std::vector<SessionTicketKey>>(std::move(initial_keys));
+    SSL_CTX_set_app_data(ctx_.get(), this);
+    SSL_CTX_set_tlsext_ticket_key_cb(
+        ctx_.get(), [](SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* cipher_ctx,
+                       HMAC_CTX* hmac_ctx, int encrypt) -> int {
+          ServerContextImpl* context =
+              static_cast<ServerContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+          return context->ticketKeyCallback(key_name, iv, cipher_ctx, hmac_ctx, encrypt);
+        });
+  }
+}
+
+std::vector<ServerContextImpl::SessionTicketKey>
+ServerContextImpl::parseTicketKeys(const std::string& keys) {
+  std::vector<SessionTicketKey> parsed;
+  for (const std::string& hex_key : StringUtil::split(keys, ',')) {
+    std::vector<uint8_t> bytes;
+    try {
+      bytes = Hex::decode(hex_key);
+    } catch (const EnvoyException&) {
+      continue;
+    }
+
+    SessionTicketKey key;
+    if (bytes.size() != sizeof(key.name_) + sizeof(key.hmac_key_) + sizeof(key.aes_key_)) {
+      continue;
+    }
+
+    memcpy(key.name_, bytes.data(), sizeof(key.name_));
+    memcpy(key.hmac_key_, bytes.data() + sizeof(key.name_), sizeof(key.hmac_key_));
+    memcpy(key.aes_key_, bytes.data() + sizeof(key.name_) + sizeof(key.hmac_key_),
+           sizeof(key.aes_key_));
+    parsed.push_back(key);
+  }
+
+  return parsed;
+}
+
+ServerContextImpl::SessionTicketKeysConstSharedPtr ServerContextImpl::currentTicketKeys() {
+  const std::string& raw_keys = runtime_.snapshot().get("ssl.ticket_keys");
+  std::unique_lock<std::mutex> lock(ticket_keys_lock_);
+  if (raw_keys != raw_ticket_keys_) {
+    raw_ticket_keys_ = raw_keys;
+    std::vector<SessionTicketKey> parsed = parseTicketKeys(raw_keys);
+    if (!parsed.empty()) {
+      ticket_keys_ = std::make_shared<const std::vector<SessionTicketKey>>(std::move(parsed));
+    }
+    // An empty or unparseable value keeps the previous keys; dropping them would invalidate
+    // every outstanding ticket at once.
+  }
+  return ticket_keys_;
+}
+
+int ServerContextImpl::ticketKeyCallback(uint8_t* key_name, uint8_t* iv,
+                                         EVP_CIPHER_CTX* cipher_ctx, HMAC_CTX* hmac_ctx,
+                                         int encrypt) {
+  SessionTicketKeysConstSharedPtr keys = currentTicketKeys();
+  if (encrypt) {
+    // New tickets are always encrypted with the primary (first) key.
+    const SessionTicketKey& key = keys->front();
+    memcpy(key_name, key.name_, sizeof(key.name_));
+    if (!RAND_bytes(iv, EVP_MAX_IV_LENGTH)) {
+      return -1;
+    }
+
+    if (!EVP_EncryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key.aes_key_, iv) ||
+        !HMAC_Init_ex(hmac_ctx, key.hmac_key_, sizeof(key.hmac_key_), EVP_sha256(), nullptr)) {
+      return -1;
+    }
+    return 1;
+  } else {
+    for (const SessionTicketKey& key : *keys) {
+      if (memcmp(key_name, key.name_, sizeof(key.name_)) != 0) {
+        continue;
+      }
+
+      if (!HMAC_Init_ex(hmac_ctx, key.hmac_key_, sizeof(key.hmac_key_), EVP_sha256(), nullptr) ||
+          !EVP_DecryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), nullptr, key.aes_key_, iv)) {
+        return -1;
+      }
+
+      // A ticket encrypted with a non-primary key still resumes, but returning 2 makes BoringSSL
+      // issue the client a fresh ticket under the primary key.
+      return &key == &keys->front() ? 1 : 2;
+    }
+
+    // Unknown key name: fall back to a full handshake.
+    return 0;
+  }
+}
+
+void ServerContextImpl::addSniContext(const std::string& sni_name, ServerContext& context) {
+  // All server contexts are created by the context manager, so the concrete type is known.
+  sni_contexts_[sni_name] = dynamic_cast<ServerContextImpl*>(&context);
+  ASSERT(sni_contexts_[sni_name] != nullptr);
+
+  // The callback fires while BoringSSL processes the ClientHello, using bytes the transport has
+  // already read, so selection costs no additional syscalls. Re-registering on every call is
+  // harmless; the callback must simply be in place before the first handshake.
+  SSL_CTX_set_tlsext_servername_callback(ctx_.get(), [](SSL* ssl, int*, void* arg) -> int {
+    return static_cast<ServerContextImpl*>(arg)->serverNameCallback(ssl);
+  });
+  SSL_CTX_set_tlsext_servername_arg(ctx_.get(), this);
+}
+
+int ServerContextImpl::serverNameCallback(SSL* ssl) {
+  const char* server_name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  if (server_name == nullptr) {
+    // No SNI in the ClientHello: stay on the default context.
+    return SSL_TLSEXT_ERR_NOACK;
+  }
+
+  ServerContextImpl* selected = findSniContext(server_name);
+  if (selected != nullptr && selected != this) {
+    // Switch the connection to the selected context's certificate and settings. The verify mode
+    // is not carried over by SSL_set_SSL_CTX(), so it is re-applied explicitly.
+    SSL_set_SSL_CTX(ssl, selected->ctx_.get());
+    SSL_set_verify(ssl, SSL_CTX_get_verify_mode(selected->ctx_.get()), nullptr);
+  }
+
+  // An unknown name also stays on the default context, matching what a dedicated listener would
+  // have done for a client that sent the wrong SNI to its address.
+  return SSL_TLSEXT_ERR_OK;
+}
+
+ServerContextImpl* ServerContextImpl::findSniContext(const std::string& server_name) {
+  auto exact = sni_contexts_.find(server_name);
+  if (exact != sni_contexts_.end()) {
+    return exact->second;
+  }
+
+  // Try a wildcard covering the name with its first label replaced, e.g. "a.example.com" is
+  // served by a context registered for "*.example.com".
+  const size_t dot = server_name.find('.');
+  if (dot != std::string::npos) {
+    auto wildcard = sni_contexts_.find("*" + server_name.substr(dot));
+    if (wildcard != sni_contexts_.end()) {
+      return wildcard->second;
+    }
+  }
+
+  return nullptr;
+}
+
+bool ServerContextImpl::offloadHandshake() const {
+  return runtime_.snapshot().featureEnabled("ssl.handshake_offload", 0);
 }
 
 } // namespace Ssl
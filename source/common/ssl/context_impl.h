@@ -1,8 +1,12 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
@@ -25,7 +29,9 @@ namespace Ssl {
 #define ALL_SSL_STATS(COUNTER, GAUGE, TIMER)                                                       \
   COUNTER(connection_error)                                                                        \
   COUNTER(handshake)                                                                               \
+  COUNTER(session_reused)                                                                          \
   COUNTER(no_certificate)                                                                          \
+  COUNTER(verify_cache_hit)                                                                        \
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
@@ -51,6 +57,28 @@ public:
    */
   void logHandshake(SSL* ssl) const;
 
+  /**
+   * Attaches a cached TLS session for the given peer, if any, so the handshake can attempt
+   * resumption. Does nothing on server contexts.
+   * @param session_key supplies the peer key, e.g. the remote address.
+   * @param ssl supplies the connection to attach the session to.
+   */
+  virtual void attachSession(const std::string& session_key, SSL* ssl);
+
+  /**
+   * Caches the connection's TLS session for later resumption with the same peer. Does nothing on
+   * server contexts.
+   * @param session_key supplies the peer key, e.g. the remote address.
+   * @param ssl supplies the connection to cache the session of.
+   */
+  virtual void cacheSession(const std::string& session_key, SSL* ssl);
+
+  /**
+   * @return whether CPU heavy handshake work for connections using this context should run on the
+   * handshake offload pool instead of inline on the worker event loop.
+   */
+  virtual bool offloadHandshake() const;
+
   /**
    * Performs subjectAltName verification
    * @param ssl the certificate to verify
@@ -68,6 +96,31 @@ public:
    */
   static bool dNSNameMatch(const std::string& dnsName, const char* pattern);
 
+  /**
+   * @return the URI SAN from the certificate, or "" if there is none. Only the first SAN entry is
+   * examined.
+   */
+  static std::string uriSanFromCertificate(X509* cert);
+
+  /**
+   * @return the single line RFC 2253 subject of the certificate.
+   */
+  static std::string subjectFromCertificate(X509* cert);
+
+  /**
+   * @return the hex encoded SHA-256 digest over the peer's presented certificate chain (leaf plus
+   * intermediates), or "" if the peer did not present a certificate.
+   */
+  static std::string peerChainDigest(SSL* ssl);
+
+  /**
+   * Looks up a previously verified peer chain. On a hit the URI SAN and subject strings parsed
+   * during verification are copied out so callers do not re-parse the certificate.
+   * @return true if the digest maps to an unexpired successful verification.
+   */
+  bool lookupVerificationCache(const std::string& chain_digest, std::string& uri_san,
+                               std::string& subject);
+
   SslStats& stats() { return stats_; }
 
   // Ssl::Context
@@ -107,6 +160,18 @@ protected:
   std::string getCaFileName() { return ca_file_path_; };
   std::string getCertChainFileName() { return cert_chain_file_path_; };
 
+  /**
+   * A successful peer chain verification, cached so repeat peers skip X.509 path building and
+   * certificate re-parsing. Failures are never cached and always re-run the full verification.
+   */
+  struct VerificationCacheEntry {
+    MonotonicTime expiry_;
+    std::string uri_san_;
+    std::string subject_;
+  };
+
+  void insertVerificationCache(const std::string& chain_digest, X509* leaf_cert);
+
   ContextManagerImpl& parent_;
   bssl::UniquePtr<SSL_CTX> ctx_;
   std::vector<std::string> verify_subject_alt_name_list_;
@@ -118,6 +183,11 @@ protected:
   bssl::UniquePtr<X509> cert_chain_;
   std::string ca_file_path_;
   std::string cert_chain_file_path_;
+  // Verification results keyed by the hex encoded SHA-256 digest of the presented chain. The
+  // context is shared by every worker so the cache is guarded by a lock; entries carry a bounded
+  // TTL so revocation and CA changes are picked up.
+  std::mutex verification_cache_lock_;
+  std::unordered_map<std::string, VerificationCacheEntry> verification_cache_;
 };
 
 class ClientContextImpl : public ContextImpl, public ClientContext {
@@ -126,8 +196,17 @@ public:
 
   bssl::UniquePtr<SSL> newSsl() const override;
 
+  // Ssl::ContextImpl
+  void attachSession(const std::string& session_key, SSL* ssl) override;
+  void cacheSession(const std::string& session_key, SSL* ssl) override;
+
 private:
   std::string server_name_indication_;
+  // Client sessions keyed by remote peer. The context is shared by every worker's connection
+  // pools so the cache is guarded by a lock. Sessions are refcounted and immutable, so attaching
+  // one to a new connection is cheap.
+  std::mutex session_cache_lock_;
+  std::unordered_map<std::string, bssl::UniquePtr<SSL_SESSION>> session_cache_;
 };
 
 class ServerContextImpl : public ContextImpl, public ServerContext {
@@ -135,12 +214,53 @@ public:
   ServerContextImpl(ContextManagerImpl& parent, Stats::Scope& scope, ServerContextConfig& config,
                     Runtime::Loader& runtime);
 
+  /**
+   * A TLS session ticket key. The name identifies the key inside a client's ticket, the HMAC and
+   * AES halves authenticate and encrypt the ticket contents.
+   */
+  struct SessionTicketKey {
+    uint8_t name_[16];
+    uint8_t hmac_key_[32];
+    uint8_t aes_key_[32];
+  };
+
+  typedef std::shared_ptr<const std::vector<SessionTicketKey>> SessionTicketKeysConstSharedPtr;
+
+  /**
+   * Parses the runtime ticket key value: comma separated hex encoded 80 byte keys (16 byte name,
+   * 32 byte HMAC key, 32 byte AES key). The first key encrypts new tickets; the remainder are
+   * accepted for decryption only, so prepending a fresh key rotates without invalidating
+   * outstanding tickets. Malformed entries are skipped since runtime values are operator supplied.
+   * NOTE: public for testing.
+   */
+  static std::vector<SessionTicketKey> parseTicketKeys(const std::string& keys);
+
+  // Ssl::ContextImpl
+  bool offloadHandshake() const override;
+
+  // Ssl::ServerContext
+  void addSniContext(const std::string& sni_name, ServerContext& context) override;
+
 private:
   int alpnSelectCallback(const unsigned char** out, unsigned char* outlen, const unsigned char* in,
                          unsigned int inlen);
+  int serverNameCallback(SSL* ssl);
+  ServerContextImpl* findSniContext(const std::string& server_name);
+  int ticketKeyCallback(uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* cipher_ctx,
+                        HMAC_CTX* hmac_ctx, int encrypt);
+  SessionTicketKeysConstSharedPtr currentTicketKeys();
 
   Runtime::Loader& runtime_;
   std::vector<uint8_t> parsed_alt_alpn_protocols_;
+  // Contexts selected by SNI, keyed by exact name or "*." prefixed wildcard. Populated at
+  // configuration time only, so handshakes read the map without a lock. Entries are not owned;
+  // the listener owns every context on it and destroys them together.
+  std::unordered_map<std::string, ServerContextImpl*> sni_contexts_;
+  // Ticket keys are re-parsed only when the raw runtime value changes. Handshakes grab the
+  // shared_ptr under the lock and run the ticket crypto without holding it.
+  std::mutex ticket_keys_lock_;
+  std::string raw_ticket_keys_;
+  SessionTicketKeysConstSharedPtr ticket_keys_;
 };
 
 } // Ssl
@@ -0,0 +1,43 @@
+#include "common/ssl/handshake_offload.h"
+
+namespace Envoy {
+namespace Ssl {
+
+// The pool stays deliberately small. Handshake work arrives as short CPU bursts, so a couple of
+// threads are enough to absorb a connection storm without competing with the workers for cores.
+static const uint32_t NUM_THREADS = 2;
+
+HandshakeOffloadPool& HandshakeOffloadPool::get() {
+  static HandshakeOffloadPool* pool = new HandshakeOffloadPool();
+  return *pool;
+}
+
+HandshakeOffloadPool::HandshakeOffloadPool() {
+  for (uint32_t i = 0; i < NUM_THREADS; i++) {
+    threads_.emplace_back(new Thread::Thread([this]() -> void { workerRoutine(); }));
+  }
+}
+
+void HandshakeOffloadPool::post(std::function<void()> work) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    work_queue_.emplace_back(std::move(work));
+  }
+  work_available_.notify_one();
+}
+
+void HandshakeOffloadPool::workerRoutine() {
+  while (true) {
+    std::function<void()> work;
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      work_available_.wait(lock, [this]() -> bool { return !work_queue_.empty(); });
+      work = std::move(work_queue_.front());
+      work_queue_.pop_front();
+    }
+    work();
+  }
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A small process wide thread pool that runs CPU heavy TLS handshake work off the worker event
+ * loops. A reconnect storm of a few thousand TLS clients would otherwise freeze a worker for the
+ * duration of many asymmetric crypto operations. Work is enqueued by Ssl::ConnectionImpl and
+ * completion is posted back to the originating dispatcher.
+ */
+class HandshakeOffloadPool {
+public:
+  /**
+   * @return the process wide pool. Created on first use and intentionally never destroyed so that
+   * there are no shutdown ordering issues with in-flight work.
+   */
+  static HandshakeOffloadPool& get();
+
+  /**
+   * Enqueue work to run on one of the pool's threads.
+   */
+  void post(std::function<void()> work);
+
+private:
+  HandshakeOffloadPool();
+
+  void workerRoutine();
+
+  std::vector<Thread::ThreadPtr> threads_;
+  std::mutex lock_;
+  std::condition_variable work_available_;
+  std::list<std::function<void()>> work_queue_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
@@ -2,11 +2,17 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <string>
+#include <vector>
 
+#include "common/common/macros.h"
 #include "common/common/utility.h"
 
+#include "fmt/format.h"
+
 namespace Envoy {
 namespace Stats {
 
@@ -16,10 +22,111 @@ void TimerImpl::TimespanImpl::complete(const std::string& dynamic_name) {
   parent_.parent_.deliverTimingToSinks(dynamic_name, ms);
 }
 
+size_t HistogramImpl::bucketIndex(uint64_t value) {
+  if (value < 10) {
+    return value;
+  }
+
+  uint64_t scale = 10;
+  for (size_t decade = 0; decade < NUM_DECADES; decade++) {
+    if (value < scale * 10) {
+      return 10 + decade * 9 + (value / scale - 1);
+    }
+    scale *= 10;
+  }
+
+  // Overflow bucket.
+  return NUM_BUCKETS - 1;
+}
+
+uint64_t HistogramImpl::bucketValue(size_t index) {
+  // Inverse of bucketIndex(): the lower bound of the bucket, which is used as its representative
+  // value in summaries.
+  if (index < 10) {
+    return index;
+  }
+
+  uint64_t scale = 10;
+  for (size_t decade = 0; decade < (index - 10) / 9; decade++) {
+    scale *= 10;
+  }
+  return index == NUM_BUCKETS - 1 ? scale : ((index - 10) % 9 + 1) * scale;
+}
+
+void HistogramImpl::recordValue(uint64_t value) {
+  buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string HistogramImpl::summary() const {
+  // The loads race with concurrent recording, but this is only used for human consumption via
+  // the admin endpoint so slight tearing between buckets is acceptable.
+  std::array<uint64_t, NUM_BUCKETS> buckets;
+  uint64_t count = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    count += buckets[i];
+  }
+  if (count == 0) {
+    return "no values recorded";
+  }
+
+  std::string output = fmt::format(
+      "count={} mean={:.1f}", count,
+      static_cast<double>(sum_.load(std::memory_order_relaxed)) / count);
+  static const std::pair<const char*, double> quantiles[] = {
+      {"P50", 0.5}, {"P90", 0.9}, {"P95", 0.95}, {"P99", 0.99}, {"P100", 1.0}};
+  for (const auto& quantile : quantiles) {
+    // Report the representative value of the first bucket at which the cumulative count reaches
+    // the quantile.
+    const uint64_t target = static_cast<uint64_t>(std::ceil(quantile.second * count));
+    uint64_t cumulative = 0;
+    size_t i = 0;
+    for (; i < NUM_BUCKETS - 1; i++) {
+      cumulative += buckets[i];
+      if (cumulative >= target) {
+        break;
+      }
+    }
+    output += fmt::format(" {}={}", quantile.first, bucketValue(i));
+  }
+
+  return output;
+}
+
+SymbolTable::Symbol HeapSymbolTable::intern(const std::string& segment) {
+  std::unique_lock<std::mutex> lock(lock_);
+  auto existing = symbols_.find(segment);
+  if (existing != symbols_.end()) {
+    return existing->second;
+  }
+
+  segments_.push_back(segment);
+  const Symbol symbol = segments_.size();
+  symbols_.emplace(segment, symbol);
+  return symbol;
+}
+
+SymbolTable::Symbol HeapSymbolTable::find(const std::string& segment) const {
+  std::unique_lock<std::mutex> lock(lock_);
+  auto existing = symbols_.find(segment);
+  return existing != symbols_.end() ? existing->second : 0;
+}
+
+std::string HeapSymbolTable::segment(Symbol symbol) const {
+  std::unique_lock<std::mutex> lock(lock_);
+  ASSERT(symbol != 0 && symbol <= segments_.size());
+  return segments_[symbol - 1];
+}
+
 RawStatData* HeapRawStatDataAllocator::alloc(const std::string& name) {
   RawStatData* data = new RawStatData();
   memset(data, 0, sizeof(RawStatData));
-  data->initialize(name);
+  const bool initialized = data->initialize(name, symbol_table_);
+  // The heap symbol table is unbounded so interning cannot fail.
+  ASSERT(initialized);
+  UNREFERENCED_PARAMETER(initialized);
   return data;
 }
 
@@ -29,17 +136,51 @@ void HeapRawStatDataAllocator::free(RawStatData& data) {
   delete &data;
 }
 
-void RawStatData::initialize(const std::string& name) {
+bool RawStatData::initialize(const std::string& name, SymbolTable& table) {
   ASSERT(!initialized());
-  ASSERT(name.size() <= MAX_NAME_SIZE);
   ASSERT(std::string::npos == name.find(':'));
   ref_count_ = 1;
-  StringUtil::strlcpy(name_, name.substr(0, MAX_NAME_SIZE).c_str(), MAX_NAME_SIZE + 1);
+
+  const std::vector<std::string> segments = StringUtil::split(name, '.');
+  ASSERT(segments.size() <= MAX_NAME_SEGMENTS);
+  const size_t num_segments = std::min(segments.size(), MAX_NAME_SEGMENTS);
+  for (size_t i = 0; i < num_segments; i++) {
+    symbols_[i] = table.intern(segments[i]);
+    if (symbols_[i] == 0) {
+      // The symbol table is full or rejected the segment. Roll back so the slot stays reusable
+      // and let the caller fail the allocation instead of aborting the process.
+      memset(symbols_, 0, sizeof(symbols_));
+      ref_count_ = 0;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool RawStatData::matches(const std::string& name, const SymbolTable& table) const {
+  const std::vector<std::string> segments = StringUtil::split(name, '.');
+  const size_t num_segments = std::min(segments.size(), MAX_NAME_SEGMENTS);
+  for (size_t i = 0; i < num_segments; i++) {
+    const SymbolTable::Symbol symbol = table.find(segments[i]);
+    if (symbol == 0 || symbol != symbols_[i]) {
+      return false;
+    }
+  }
+
+  // Make sure this stat does not have extra trailing segments.
+  return num_segments == MAX_NAME_SEGMENTS || symbols_[num_segments] == 0;
 }
 
-bool RawStatData::matches(const std::string& name) {
-  // In case a stat got truncated, match on the truncated name.
-  return 0 == strcmp(name.substr(0, MAX_NAME_SIZE).c_str(), name_);
+std::string RawStatData::name(const SymbolTable& table) const {
+  std::string name;
+  for (size_t i = 0; i < MAX_NAME_SEGMENTS && symbols_[i] != 0; i++) {
+    if (!name.empty()) {
+      name.append(".");
+    }
+    name.append(table.segment(symbols_[i]));
+  }
+  return name;
 }
 
 } // namespace Stats
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/common/time.h"
 #include "envoy/stats/stats.h"
@@ -17,28 +20,74 @@
 namespace Envoy {
 namespace Stats {
 
+/**
+ * Interns the '.' delimited segments of stat names and maps each segment to a fixed Symbol.
+ * RawStatData stores only symbol arrays, so repeated segments (cluster names, stat suffixes,
+ * etc.) are stored once per process (or once per shared memory region) instead of once per stat.
+ * Symbol 0 is reserved as invalid. Symbols are never freed.
+ */
+class SymbolTable {
+public:
+  typedef uint32_t Symbol;
+
+  virtual ~SymbolTable() {}
+
+  /**
+   * Intern a name segment, allocating a new symbol if the segment has not been seen before.
+   * @return the symbol for the segment, or 0 if the table is full.
+   */
+  virtual Symbol intern(const std::string& segment) PURE;
+
+  /**
+   * @return the symbol for an already interned segment, or 0 if the segment is unknown.
+   */
+  virtual Symbol find(const std::string& segment) const PURE;
+
+  /**
+   * @return the segment backing a symbol previously returned by intern().
+   */
+  virtual std::string segment(Symbol symbol) const PURE;
+};
+
 /**
  * This structure is the backing memory for both CounterImpl and GaugeImpl. It is designed so that
- * it can be allocated from shared memory if needed.
+ * it can be allocated from shared memory if needed. Names are stored as symbol arrays which
+ * resolve through the owning allocator's SymbolTable.
  */
 struct RawStatData {
   struct Flags {
     static const uint8_t Used = 0x1;
+    // Set on every mutation and cleared by the flush path, so that a flush only visits stats
+    // that changed since the previous flush.
+    static const uint8_t Dirty = 0x2;
   };
 
+  // The maximum number of '.' delimited name segments per stat. At 4 bytes per symbol this
+  // bounds the name storage at 96 bytes per stat regardless of how long the segments are.
+  static const size_t MAX_NAME_SEGMENTS = 24;
+
+  // Maximum pre-symbolization name length used by producers of unbounded dynamic names (e.g.
+  // dynamo table stats) to bound what they feed into the symbol table.
   static const size_t MAX_NAME_SIZE = 127;
 
-  RawStatData() { memset(name_, 0, sizeof(name_)); }
-  void initialize(const std::string& name);
-  bool initialized() { return name_[0] != '\0'; }
-  bool matches(const std::string& name);
+  RawStatData() { memset(symbols_, 0, sizeof(symbols_)); }
+  /**
+   * Interns the '.' delimited segments of the name and takes the initial reference.
+   * @return whether every segment could be interned. On failure the object is rolled back to its
+   * uninitialized state so the caller can return the slot to its free list and fail the
+   * allocation (degrading to the heap allocator) instead of aborting.
+   */
+  bool initialize(const std::string& name, SymbolTable& table);
+  bool initialized() { return symbols_[0] != 0; }
+  bool matches(const std::string& name, const SymbolTable& table) const;
+  std::string name(const SymbolTable& table) const;
 
   std::atomic<uint64_t> value_;
   std::atomic<uint64_t> pending_increment_;
   std::atomic<uint16_t> flags_;
   std::atomic<uint16_t> ref_count_;
   std::atomic<uint32_t> unused_;
-  char name_[MAX_NAME_SIZE + 1];
+  SymbolTable::Symbol symbols_[MAX_NAME_SEGMENTS];
 };
 
 /**
@@ -61,6 +110,11 @@ public:
    * free the block if it is no longer needed.
    */
   virtual void free(RawStatData& data) PURE;
+
+  /**
+   * @return the symbol table that resolves names for stats allocated by this allocator.
+   */
+  virtual SymbolTable& symbolTable() PURE;
 };
 
 /**
@@ -80,7 +134,7 @@ public:
 
   void inc() override { add(1); }
   uint64_t latch() override { return data_.pending_increment_.exchange(0); }
-  std::string name() override { return data_.name_; }
+  std::string name() override { return data_.name(alloc_.symbolTable()); }
   void reset() override { data_.value_ = 0; }
   bool used() override { return data_.flags_ & RawStatData::Flags::Used; }
   uint64_t value() override { return data_.value_; }
@@ -101,19 +155,24 @@ public:
   // Stats::Gauge
   virtual void add(uint64_t amount) override {
     data_.value_ += amount;
-    data_.flags_ |= RawStatData::Flags::Used;
+    data_.flags_ |= (RawStatData::Flags::Used | RawStatData::Flags::Dirty);
   }
   virtual void dec() override { sub(1); }
   virtual void inc() override { add(1); }
-  virtual std::string name() override { return data_.name_; }
+  bool latchDirty() override {
+    return (data_.flags_.fetch_and(static_cast<uint16_t>(~RawStatData::Flags::Dirty)) &
+            RawStatData::Flags::Dirty) != 0;
+  }
+  virtual std::string name() override { return data_.name(alloc_.symbolTable()); }
   virtual void set(uint64_t value) override {
     data_.value_ = value;
-    data_.flags_ |= RawStatData::Flags::Used;
+    data_.flags_ |= (RawStatData::Flags::Used | RawStatData::Flags::Dirty);
   }
   virtual void sub(uint64_t amount) override {
     ASSERT(data_.value_ >= amount);
     ASSERT(used());
     data_.value_ -= amount;
+    data_.flags_ |= RawStatData::Flags::Dirty;
   }
   bool used() override { return data_.flags_ & RawStatData::Flags::Used; }
   virtual uint64_t value() override { return data_.value_; }
@@ -123,6 +182,38 @@ private:
   RawStatDataAllocator& alloc_;
 };
 
+/**
+ * Histogram implementation using fixed log linear buckets: exact buckets for values 0 through 9,
+ * then 9 linear sub buckets per decade up through 10^8, plus an overflow bucket. Recording is a
+ * relaxed atomic increment so it is safe and cheap from any thread. Histograms are heap only;
+ * they are not backed by shared memory and do not survive a hot restart.
+ */
+class HistogramImpl : public Histogram {
+public:
+  HistogramImpl(const std::string& name) : name_(name) {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Stats::Histogram
+  std::string name() override { return name_; }
+  void recordValue(uint64_t value) override;
+  std::string summary() const override;
+
+private:
+  static const size_t NUM_DECADES = 8;
+  static const size_t NUM_BUCKETS = 10 + NUM_DECADES * 9 + 1;
+
+  static size_t bucketIndex(uint64_t value);
+  static uint64_t bucketValue(size_t index);
+
+  const std::string name_;
+  std::atomic<uint64_t> count_{};
+  std::atomic<uint64_t> sum_{};
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_;
+};
+
 /**
  * Timer implementation for the heap.
  */
@@ -155,6 +246,25 @@ private:
   Store& parent_;
 };
 
+/**
+ * A SymbolTable that interns segments on the heap. Used whenever stats are not backed by a
+ * shared memory region.
+ */
+class HeapSymbolTable : public SymbolTable {
+public:
+  // Stats::SymbolTable
+  Symbol intern(const std::string& segment) override;
+  Symbol find(const std::string& segment) const override;
+  std::string segment(Symbol symbol) const override;
+
+private:
+  // Interning happens on stat allocation which can race across threads, hence the lock. Stat
+  // hot paths never touch the table.
+  mutable std::mutex lock_;
+  std::unordered_map<std::string, Symbol> symbols_;
+  std::vector<std::string> segments_; // Index is symbol - 1.
+};
+
 /**
  * Implementation of RawStatDataAllocator that just allocates a new structure in memory and returns
  * it.
@@ -164,6 +274,10 @@ public:
   // RawStatDataAllocator
   RawStatData* alloc(const std::string& name) override;
   void free(RawStatData& data) override;
+  SymbolTable& symbolTable() override { return symbol_table_; }
+
+private:
+  HeapSymbolTable symbol_table_;
 };
 
 /**
@@ -228,6 +342,10 @@ public:
   // Stats::Store
   std::list<CounterSharedPtr> counters() const override { return counters_.toList(); }
   std::list<GaugeSharedPtr> gauges() const override { return gauges_.toList(); }
+  // Histogram/timing deliveries are no-ops in the isolated store, so there are no histograms.
+  std::list<HistogramSharedPtr> histograms() const override {
+    return std::list<HistogramSharedPtr>{};
+  }
 
 private:
   struct ScopeImpl : public Scope {
@@ -1,7 +1,11 @@
 #include "common/stats/statsd.h"
 
+#include <sys/socket.h>
+
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "envoy/common/exception.h"
@@ -33,23 +37,97 @@ Writer::~Writer() {
   }
 }
 
-void Writer::writeCounter(const std::string& name, uint64_t increment) {
-  std::string message(fmt::format("envoy.{}:{}|c", name, increment));
-  send(message);
+void Writer::beginBatch() {
+  ASSERT(!in_batch_);
+  in_batch_ = true;
+}
+
+void Writer::endBatch() {
+  ASSERT(in_batch_);
+  flushBatch();
+  in_batch_ = false;
 }
 
-void Writer::writeGauge(const std::string& name, uint64_t value) {
-  std::string message(fmt::format("envoy.{}:{}|g", name, value));
-  send(message);
+void Writer::writeCounter(const std::string& name, uint64_t increment) {
+  append(name, increment, "c");
 }
 
+void Writer::writeGauge(const std::string& name, uint64_t value) { append(name, value, "g"); }
+
 void Writer::writeTimer(const std::string& name, const std::chrono::milliseconds& ms) {
-  std::string message(fmt::format("envoy.{}:{}|ms", name, ms.count()));
-  send(message);
+  append(name, ms.count(), "ms");
 }
 
-void Writer::send(const std::string& message) {
-  ::send(fd_, message.c_str(), message.size(), MSG_DONTWAIT);
+void Writer::append(const std::string& name, uint64_t value, const char* type) {
+  // Produces "envoy.{}:{}|{type}" into the reused scratch buffer. Like the TCP sink, this avoids
+  // a fresh format temporary per metric since with a large number of stats and a high flush rate
+  // this path is hot.
+  message_.clear();
+  message_.append("envoy.");
+  message_.append(name);
+  message_.push_back(':');
+  fmt::FormatInt formatted_value(value);
+  message_.append(formatted_value.c_str(), formatted_value.size());
+  message_.push_back('|');
+  message_.append(type);
+
+  if (!in_batch_) {
+    // Timers are emitted on worker threads outside of a flush cycle and keep their one datagram
+    // per metric behavior.
+    ::send(fd_, message_.data(), message_.size(), MSG_DONTWAIT);
+    return;
+  }
+
+  if (!currentPayload().empty() &&
+      currentPayload().size() + 1 + message_.size() > MAX_PAYLOAD_SIZE) {
+    // The current payload is full, move on to the next one, flushing the batch if it is full.
+    num_full_payloads_++;
+    if (num_full_payloads_ == MAX_BATCH_SIZE) {
+      flushBatch();
+    }
+  }
+
+  std::string& payload = currentPayload();
+  if (!payload.empty()) {
+    payload.push_back('\n');
+  }
+  payload.append(message_);
+}
+
+std::string& Writer::currentPayload() {
+  if (payloads_.size() == num_full_payloads_) {
+    payloads_.emplace_back();
+    payloads_.back().reserve(MAX_PAYLOAD_SIZE);
+  }
+  return payloads_[num_full_payloads_];
+}
+
+void Writer::flushBatch() {
+  const uint64_t num_payloads = num_full_payloads_ + (currentPayload().empty() ? 0 : 1);
+  if (num_payloads > 0) {
+#if defined(__linux__)
+    mmsghdr messages[MAX_BATCH_SIZE];
+    iovec iovecs[MAX_BATCH_SIZE];
+    memset(messages, 0, num_payloads * sizeof(mmsghdr));
+    for (uint64_t i = 0; i < num_payloads; i++) {
+      iovecs[i].iov_base = const_cast<char*>(payloads_[i].data());
+      iovecs[i].iov_len = payloads_[i].size();
+      messages[i].msg_hdr.msg_iov = &iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    sendmmsg(fd_, messages, num_payloads, MSG_DONTWAIT);
+#else
+    for (uint64_t i = 0; i < num_payloads; i++) {
+      ::send(fd_, payloads_[i].data(), payloads_[i].size(), MSG_DONTWAIT);
+    }
+#endif
+  }
+
+  // Clear the payloads for reuse but keep their allocations.
+  for (uint64_t i = 0; i < num_payloads; i++) {
+    payloads_[i].clear();
+  }
+  num_full_payloads_ = 0;
 }
 
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
@@ -60,6 +138,8 @@ UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
   });
 }
 
+void UdpStatsdSink::beginFlush() { tls_->getTyped<Writer>().beginBatch(); }
+
 void UdpStatsdSink::flushCounter(const std::string& name, uint64_t delta) {
   tls_->getTyped<Writer>().writeCounter(name, delta);
 }
@@ -68,6 +148,8 @@ void UdpStatsdSink::flushGauge(const std::string& name, uint64_t value) {
   tls_->getTyped<Writer>().writeGauge(name, value);
 }
 
+void UdpStatsdSink::endFlush() { tls_->getTyped<Writer>().endBatch(); }
+
 void UdpStatsdSink::onTimespanComplete(const std::string& name, std::chrono::milliseconds ms) {
   tls_->getTyped<Writer>().writeTimer(name, ms);
 }
@@ -76,9 +158,12 @@ char TcpStatsdSink::STAT_PREFIX[] = "envoy.";
 
 TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
                              const std::string& cluster_name, ThreadLocal::SlotAllocator& tls,
-                             Upstream::ClusterManager& cluster_manager, Stats::Scope& scope)
+                             Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
+                             Runtime::RandomGenerator& random, MonotonicTimeSource& time_source)
     : tls_(tls.allocateSlot()), cluster_manager_(cluster_manager),
-      cx_overflow_stat_(scope.counter("statsd.cx_overflow")) {
+      cx_overflow_stat_(scope.counter("statsd.cx_overflow")),
+      backoff_drop_stat_(scope.counter("statsd.backoff_drop")), random_(random),
+      time_source_(time_source) {
 
   Config::Utility::checkClusterAndLocalInfo("tcp statsd", cluster_name, cluster_manager,
                                             local_info);
@@ -159,6 +244,22 @@ void TcpStatsdSink::TlsSink::onEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::LocalClose ||
       event == Network::ConnectionEvent::RemoteClose) {
     dispatcher_.deferredDelete(std::move(connection_));
+
+    // Back off before reconnecting. The interval doubles per consecutive failure and the delay
+    // is jittered within the upper half of the interval, so that during a relay outage the
+    // workers (and a fleet of proxies behind the same relay) do not retry in lock step on every
+    // flush. A successful connect resets the failure count.
+    // The shift is clamped so the doubling cannot overflow; 6 doublings already exceed the
+    // maximum interval.
+    const uint64_t interval_ms =
+        std::min(RECONNECT_BASE_INTERVAL_MS << std::min<uint64_t>(connect_failures_, 6),
+                 RECONNECT_MAX_INTERVAL_MS);
+    connect_failures_++;
+    const uint64_t delay_ms = interval_ms / 2 + parent_.random_.random() % (interval_ms / 2 + 1);
+    next_connect_time_ =
+        parent_.time_source_.currentTime() + std::chrono::milliseconds(delay_ms);
+  } else if (event == Network::ConnectionEvent::Connected) {
+    connect_failures_ = 0;
   }
 }
 
@@ -193,6 +294,14 @@ void TcpStatsdSink::TlsSink::write(Buffer::Instance& buffer) {
   }
 
   if (!connection_) {
+    if (parent_.time_source_.currentTime() < next_connect_time_) {
+      // Still backing off after a connection failure. Dropping (and counting) the flush here is
+      // what keeps a relay outage from turning into a per flush reconnect storm.
+      parent_.backoff_drop_stat_.inc();
+      buffer.drain(buffer.length());
+      return;
+    }
+
     Upstream::Host::CreateConnectionData info =
         parent_.cluster_manager_.tcpConnForCluster(parent_.cluster_info_->name(), nullptr);
     if (!info.connection_) {
@@ -3,27 +3,37 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/stats/stats.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/utility.h"
 
 namespace Envoy {
 namespace Stats {
 namespace Statsd {
 
 /**
- * This is a simple UDP localhost writer for statsd messages.
+ * This is a simple UDP localhost writer for statsd messages. Between beginBatch() and endBatch()
+ * calls metrics are coalesced newline separated into MTU sized payloads which are submitted in
+ * batches with sendmmsg(), so a stats flush costs a handful of syscalls instead of one per
+ * metric. Writes outside of a batch (e.g. timers emitted on worker threads) are sent as
+ * individual datagrams as before.
  */
 class Writer : public ThreadLocal::ThreadLocalObject {
 public:
   Writer(Network::Address::InstanceConstSharedPtr address);
   ~Writer();
 
+  void beginBatch();
+  void endBatch();
   void writeCounter(const std::string& name, uint64_t increment);
   void writeGauge(const std::string& name, uint64_t value);
   void writeTimer(const std::string& name, const std::chrono::milliseconds& ms);
@@ -32,9 +42,24 @@ public:
   int getFdForTests() const { return fd_; };
 
 private:
-  void send(const std::string& message);
+  // Maximum payload per datagram. Fits a 1500 byte MTU with IP and UDP headers to spare; the
+  // common statsd server default.
+  static const uint64_t MAX_PAYLOAD_SIZE = 1432;
+
+  // Number of payloads submitted per sendmmsg() call.
+  static const uint64_t MAX_BATCH_SIZE = 64;
+
+  void append(const std::string& name, uint64_t value, const char* type);
+  std::string& currentPayload();
+  void flushBatch();
 
   int fd_;
+  bool in_batch_{};
+  uint64_t num_full_payloads_{};
+  // Scratch buffer a single metric is formatted into, and the completed payloads for the current
+  // batch. Both retain their allocations across flushes.
+  std::string message_;
+  std::vector<std::string> payloads_;
 };
 
 /**
@@ -45,10 +70,10 @@ public:
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address);
 
   // Stats::Sink
-  void beginFlush() override {}
+  void beginFlush() override;
   void flushCounter(const std::string& name, uint64_t delta) override;
   void flushGauge(const std::string& name, uint64_t value) override;
-  void endFlush() override {}
+  void endFlush() override;
   void onHistogramComplete(const std::string& name, uint64_t value) override {
     // For statsd histograms are just timers.
     onTimespanComplete(name, std::chrono::milliseconds(value));
@@ -69,7 +94,8 @@ class TcpStatsdSink : public Sink {
 public:
   TcpStatsdSink(const LocalInfo::LocalInfo& local_info, const std::string& cluster_name,
                 ThreadLocal::SlotAllocator& tls, Upstream::ClusterManager& cluster_manager,
-                Stats::Scope& scope);
+                Stats::Scope& scope, Runtime::RandomGenerator& random,
+                MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_);
 
   // Stats::Sink
   void beginFlush() override { tls_->getTyped<TlsSink>().beginFlush(true); }
@@ -119,6 +145,11 @@ private:
     Buffer::OwnedImpl buffer_;
     Buffer::RawSlice current_buffer_slice_;
     char* current_slice_mem_{};
+    // Reconnect backoff state. Each connection close pushes the next allowed connect time out by
+    // a jittered, exponentially growing interval; a successful connect resets it. Writes that
+    // occur while backing off are dropped and counted.
+    uint64_t connect_failures_{};
+    MonotonicTime next_connect_time_;
   };
 
   // Somewhat arbitrary 16MiB limit for buffered stats.
@@ -127,6 +158,12 @@ private:
   // 16KiB intermediate buffer for flushing.
   static constexpr uint32_t FLUSH_SLICE_SIZE_BYTES = (1024 * 16);
 
+  // Reconnect backoff interval bounds. The interval doubles per consecutive connection failure
+  // from the base up to the maximum, and the actual delay is jittered within the upper half of
+  // the interval so workers do not reconnect in lock step.
+  static constexpr uint64_t RECONNECT_BASE_INTERVAL_MS = 500;
+  static constexpr uint64_t RECONNECT_MAX_INTERVAL_MS = 30000;
+
   // Prefix for all flushed stats.
   static char STAT_PREFIX[];
 
@@ -134,6 +171,9 @@ private:
   ThreadLocal::SlotPtr tls_;
   Upstream::ClusterManager& cluster_manager_;
   Stats::Counter& cx_overflow_stat_;
+  Stats::Counter& backoff_drop_stat_;
+  Runtime::RandomGenerator& random_;
+  MonotonicTimeSource& time_source_;
 };
 
 } // namespace Statsd
@@ -8,8 +8,17 @@
 #include <string>
 #include <unordered_set>
 
+#include "common/common/assert.h"
+
 namespace Envoy {
 namespace Stats {
+namespace {
+
+// Upper bound on recycled per thread cache entries. Enough to absorb a config update's worth of
+// scope churn without holding on to map memory forever on threads that stop seeing churn.
+constexpr uint64_t MaxFreeCacheEntries = 16;
+
+} // namespace
 
 ThreadLocalStoreImpl::ThreadLocalStoreImpl(RawStatDataAllocator& alloc)
     : alloc_(alloc), default_scope_(createScope("")),
@@ -26,6 +35,7 @@ std::list<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
   std::list<CounterSharedPtr> ret;
   std::unordered_set<std::string> names;
   std::unique_lock<std::mutex> lock(lock_);
+  mergeCounterShards();
   for (ScopeImpl* scope : scopes_) {
     for (auto counter : scope->central_cache_.counters_) {
       if (names.insert(counter.first).second) {
@@ -60,6 +70,22 @@ std::list<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
   return ret;
 }
 
+std::list<HistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
+  // Handle de-dup due to overlapping scopes.
+  std::list<HistogramSharedPtr> ret;
+  std::unordered_set<std::string> names;
+  std::unique_lock<std::mutex> lock(lock_);
+  for (ScopeImpl* scope : scopes_) {
+    for (auto histogram : scope->central_cache_.histograms_) {
+      if (names.insert(histogram.first).second) {
+        ret.push_back(histogram.second);
+      }
+    }
+  }
+
+  return ret;
+}
+
 void ThreadLocalStoreImpl::initializeThreading(Event::Dispatcher& main_thread_dispatcher,
                                                ThreadLocal::Instance& tls) {
   main_thread_dispatcher_ = &main_thread_dispatcher;
@@ -75,25 +101,113 @@ void ThreadLocalStoreImpl::shutdownThreading() {
 }
 
 void ThreadLocalStoreImpl::releaseScopeCrossThread(ScopeImpl* scope) {
-  std::unique_lock<std::mutex> lock(lock_);
-  ASSERT(scopes_.count(scope) == 1);
-  scopes_.erase(scope);
+  bool schedule_clear = false;
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    ASSERT(scopes_.count(scope) == 1);
+    scopes_.erase(scope);
+
+    // Dying scopes are batched so that a config update which drops many scopes in quick
+    // succession produces a single cross thread cache clear instead of one per scope.
+    if (!shutting_down_ && main_thread_dispatcher_) {
+      scopes_to_clear_.push_back(scope);
+      if (!clear_scheduled_) {
+        clear_scheduled_ = true;
+        schedule_clear = true;
+      }
+    }
+  }
 
   // This can happen from any thread. We post() back to the main thread which will initiate the
-  // cache flush operation.
-  if (!shutting_down_ && main_thread_dispatcher_) {
-    main_thread_dispatcher_->post([this, scope]() -> void { clearScopeFromCaches(scope); });
+  // cache flush operation. The lock is dropped first since in tests the posted callback can run
+  // inline and counter shard teardown acquires the lock again.
+  if (schedule_clear) {
+    main_thread_dispatcher_->post([this]() -> void { clearScopesFromCaches(); });
+  }
+}
+
+void ThreadLocalStoreImpl::mergeCounterShards() const {
+  // Must be called under lock_. Folds each worker's pending deltas into the backing counters so
+  // that flushes and admin queries observe up to date values. The owning threads keep
+  // incrementing concurrently; exchange() makes sure no delta is lost or double counted.
+  for (const auto& shards : counter_shards_) {
+    for (ThreadLocalCounterImpl* shard : shards.second) {
+      const uint64_t delta = shard->pending_.exchange(0);
+      if (delta != 0) {
+        shards.first->add(delta);
+      }
+    }
+  }
+}
+
+void ThreadLocalStoreImpl::releaseCounterShard(ThreadLocalCounterImpl& shard) {
+  std::unique_lock<std::mutex> lock(lock_);
+  const uint64_t delta = shard.pending_.exchange(0);
+  if (delta != 0) {
+    shard.central_->add(delta);
+  }
+
+  auto it = counter_shards_.find(shard.central_.get());
+  ASSERT(it != counter_shards_.end());
+  it->second.remove(&shard);
+  if (it->second.empty()) {
+    counter_shards_.erase(it);
   }
 }
 
-void ThreadLocalStoreImpl::clearScopeFromCaches(ScopeImpl* scope) {
+void ThreadLocalStoreImpl::clearScopesFromCaches() {
+  // Swap out the current batch under lock. Scopes destroyed from here on schedule a new clear.
+  auto scopes = std::make_shared<std::vector<ScopeImpl*>>();
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    clear_scheduled_ = false;
+    scopes->swap(scopes_to_clear_);
+  }
+
   // If we are shutting down we no longer perform cache flushes as workers may be shutting down
   // at the same time.
-  if (!shutting_down_) {
-    // Perform a cache flush on all threads.
-    tls_->runOnAllThreads(
-        [this, scope]() -> void { tls_->getTyped<TlsCache>().scope_cache_.erase(scope); });
+  if (!shutting_down_ && !scopes->empty()) {
+    // Perform a single cache flush on all threads for the entire batch.
+    tls_->runOnAllThreads([this, scopes]() -> void {
+      TlsCache& cache = tls_->getTyped<TlsCache>();
+      for (ScopeImpl* scope : *scopes) {
+        cache.clearScope(scope);
+      }
+    });
+  }
+}
+
+ThreadLocalStoreImpl::TlsCacheEntry& ThreadLocalStoreImpl::TlsCache::scopeEntry(ScopeImpl* scope) {
+  auto entry = scope_cache_.find(scope);
+  if (entry == scope_cache_.end()) {
+    if (!free_entries_.empty()) {
+      entry = scope_cache_.emplace(scope, std::move(free_entries_.front())).first;
+      free_entries_.pop_front();
+    } else {
+      entry = scope_cache_.emplace(scope, TlsCacheEntry()).first;
+    }
+  }
+
+  return entry->second;
+}
+
+void ThreadLocalStoreImpl::TlsCache::clearScope(ScopeImpl* scope) {
+  auto entry = scope_cache_.find(scope);
+  if (entry == scope_cache_.end()) {
+    return;
+  }
+
+  // The cached shared pointers must be dropped now (that is the point of the flush), but clear()
+  // keeps the maps' bucket arrays so a recycled entry starts out with its tables already sized.
+  if (free_entries_.size() < MaxFreeCacheEntries) {
+    entry->second.counters_.clear();
+    entry->second.gauges_.clear();
+    entry->second.timers_.clear();
+    entry->second.histograms_.clear();
+    free_entries_.push_back(std::move(entry->second));
   }
+
+  scope_cache_.erase(entry);
 }
 
 ThreadLocalStoreImpl::SafeAllocData ThreadLocalStoreImpl::safeAlloc(const std::string& name) {
@@ -109,6 +223,25 @@ ThreadLocalStoreImpl::SafeAllocData ThreadLocalStoreImpl::safeAlloc(const std::s
   }
 }
 
+ThreadLocalStoreImpl::ThreadLocalCounterImpl::~ThreadLocalCounterImpl() {
+  parent_.releaseCounterShard(*this);
+}
+
+uint64_t ThreadLocalStoreImpl::ThreadLocalCounterImpl::latch() {
+  const uint64_t delta = pending_.exchange(0);
+  if (delta != 0) {
+    central_->add(delta);
+  }
+
+  return central_->latch();
+}
+
+void ThreadLocalStoreImpl::ThreadLocalCounterImpl::reset() {
+  pending_ = 0;
+  total_ = 0;
+  central_->reset();
+}
+
 ThreadLocalStoreImpl::ScopeImpl::~ScopeImpl() { parent_.releaseScopeCrossThread(this); }
 
 Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
@@ -120,7 +253,7 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
   // is no cache entry.
   CounterSharedPtr* tls_ref = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this].counters_[final_name];
+    tls_ref = &parent_.tls_->getTyped<TlsCache>().scopeEntry(this).counters_[final_name];
   }
 
   // If we have a valid cache entry, return it.
@@ -137,9 +270,14 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
     central_ref.reset(new CounterImpl(alloc.data_, alloc.free_));
   }
 
-  // If we have a TLS location to store or allocation into, do it.
+  // If we have a TLS location to store into, create a per thread shard of the backing counter so
+  // that increments on this thread do not contend with other workers. The shard is registered
+  // with the store (we are already locked) so its delta can be merged centrally.
   if (tls_ref) {
-    *tls_ref = central_ref;
+    ThreadLocalCounterImpl* shard = new ThreadLocalCounterImpl(parent_, central_ref);
+    parent_.counter_shards_[central_ref.get()].push_back(shard);
+    tls_ref->reset(shard);
+    return *shard;
   }
 
   // Finally we return the reference.
@@ -157,6 +295,10 @@ void ThreadLocalStoreImpl::ScopeImpl::deliverHistogramToSinks(const std::string&
     return;
   }
 
+  // Record into the in process histogram first so percentile data is available locally (via the
+  // admin endpoint) regardless of what sinks are configured.
+  histogram(name).recordValue(value);
+
   const std::string final_name = prefix_ + name;
   for (Sink& sink : parent_.timer_sinks_) {
     sink.onHistogramComplete(final_name, value);
@@ -170,19 +312,48 @@ void ThreadLocalStoreImpl::ScopeImpl::deliverTimingToSinks(const std::string& na
     return;
   }
 
+  // Timings feed the same local histograms as histogram deliveries.
+  histogram(name).recordValue(ms.count());
+
   const std::string final_name = prefix_ + name;
   for (Sink& sink : parent_.timer_sinks_) {
     sink.onTimespanComplete(final_name, ms);
   }
 }
 
+Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
+  // See comments in counter(). There is no super clean way (via templates or otherwise) to
+  // share this code so I'm leaving it largely duplicated for now.
+  std::string final_name = prefix_ + name;
+  HistogramSharedPtr* tls_ref = nullptr;
+  if (!parent_.shutting_down_ && parent_.tls_) {
+    tls_ref = &parent_.tls_->getTyped<TlsCache>().scopeEntry(this).histograms_[final_name];
+  }
+
+  if (tls_ref && *tls_ref) {
+    return **tls_ref;
+  }
+
+  std::unique_lock<std::mutex> lock(parent_.lock_);
+  HistogramSharedPtr& central_ref = central_cache_.histograms_[final_name];
+  if (!central_ref) {
+    central_ref.reset(new HistogramImpl(final_name));
+  }
+
+  if (tls_ref) {
+    *tls_ref = central_ref;
+  }
+
+  return *central_ref;
+}
+
 Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
   std::string final_name = prefix_ + name;
   GaugeSharedPtr* tls_ref = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this].gauges_[final_name];
+    tls_ref = &parent_.tls_->getTyped<TlsCache>().scopeEntry(this).gauges_[final_name];
   }
 
   if (tls_ref && *tls_ref) {
@@ -209,7 +380,7 @@ Timer& ThreadLocalStoreImpl::ScopeImpl::timer(const std::string& name) {
   std::string final_name = prefix_ + name;
   TimerSharedPtr* tls_ref = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this].timers_[final_name];
+    tls_ref = &parent_.tls_->getTyped<TlsCache>().scopeEntry(this).timers_[final_name];
   }
 
   if (tls_ref && *tls_ref) {
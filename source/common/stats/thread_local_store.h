@@ -8,6 +8,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "envoy/thread_local/thread_local.h"
 
@@ -20,6 +21,9 @@ namespace Stats {
  * Store implementation with thread local caching. This implementation supports the following
  * features:
  * - Thread local per scope stat caching.
+ * - Per thread counter shards: each worker increments a private shard so hot counters do not
+ *   bounce a shared cache line across cores. The pending deltas are folded into the backing
+ *   counters under the store lock whenever counters() is called (flush, admin).
  * - Overallaping scopes with proper reference counting (2 scopes with the same name will point to
  *   the same backing stats).
  * - Scope deletion.
@@ -33,7 +37,8 @@ namespace Stats {
  * - Per thread caches are checked, and if empty, they are populated from the central cache.
  * - Scopes are entirely owned by the caller. The store only keeps weak pointers.
  * - When a scope is destroyed, a cache flush operation is run on all threads to flush any cached
- *   data owned by the destroyed scope.
+ *   data owned by the destroyed scope. Flushes are batched: scopes destroyed in quick succession
+ *   (e.g. during a config update) are cleared by a single cross thread operation.
  * - NOTE: It is theoretically possible that when a scope is deleted, it could be reallocated
  *         with the same address, and a cache flush operation could race and delete cache data
  *         for the new scope. This is extremely unlikely, and if it happens the cache will be
@@ -65,6 +70,7 @@ public:
   // Stats::Store
   std::list<CounterSharedPtr> counters() const override;
   std::list<GaugeSharedPtr> gauges() const override;
+  std::list<HistogramSharedPtr> histograms() const override;
 
   // Stats::StoreRoot
   void addSink(Sink& sink) override { timer_sinks_.push_back(sink); }
@@ -73,10 +79,40 @@ public:
   void shutdownThreading() override;
 
 private:
+  /**
+   * A per thread shard of a counter. Only the owning thread writes the shard, so increments touch
+   * memory no other core writes. The shard registers itself with the store so that the pending
+   * delta can be folded into the backing counter from the main thread; any leftover delta is
+   * committed when the shard is destroyed during a cache flush.
+   */
+  struct ThreadLocalCounterImpl : public Counter {
+    ThreadLocalCounterImpl(ThreadLocalStoreImpl& parent, CounterSharedPtr central)
+        : parent_(parent), central_(std::move(central)) {}
+    ~ThreadLocalCounterImpl();
+
+    // Stats::Counter
+    void add(uint64_t amount) override {
+      pending_ += amount;
+      total_ += amount;
+    }
+    void inc() override { add(1); }
+    uint64_t latch() override;
+    std::string name() override { return central_->name(); }
+    void reset() override;
+    bool used() override { return total_ != 0 || central_->used(); }
+    uint64_t value() override { return central_->value() + pending_; }
+
+    ThreadLocalStoreImpl& parent_;
+    CounterSharedPtr central_;
+    std::atomic<uint64_t> pending_{};
+    std::atomic<uint64_t> total_{};
+  };
+
   struct TlsCacheEntry {
     std::unordered_map<std::string, CounterSharedPtr> counters_;
     std::unordered_map<std::string, GaugeSharedPtr> gauges_;
     std::unordered_map<std::string, TimerSharedPtr> timers_;
+    std::unordered_map<std::string, HistogramSharedPtr> histograms_;
   };
 
   struct ScopeImpl : public Scope {
@@ -94,13 +130,30 @@ private:
     Gauge& gauge(const std::string& name) override;
     Timer& timer(const std::string& name) override;
 
+    // Find or create the histogram that backs deliverHistogramToSinks()/deliverTimingToSinks().
+    Histogram& histogram(const std::string& name);
+
     ThreadLocalStoreImpl& parent_;
     const std::string prefix_;
     TlsCacheEntry central_cache_;
   };
 
   struct TlsCache : public ThreadLocal::ThreadLocalObject {
+    /**
+     * Find or create the cache entry for a scope, reusing a recycled entry when one is available
+     * so that scope churn does not reallocate map tables from scratch.
+     */
+    TlsCacheEntry& scopeEntry(ScopeImpl* scope);
+
+    /**
+     * Remove a scope's entry, dropping its cached stats and recycling the entry for reuse.
+     */
+    void clearScope(ScopeImpl* scope);
+
     std::unordered_map<ScopeImpl*, TlsCacheEntry> scope_cache_;
+    // Recycled entries whose cleared maps keep their bucket allocations. Bounded; see
+    // MaxFreeCacheEntries in thread_local_store.cc.
+    std::list<TlsCacheEntry> free_entries_;
   };
 
   struct SafeAllocData {
@@ -108,7 +161,9 @@ private:
     RawStatDataAllocator& free_;
   };
 
-  void clearScopeFromCaches(ScopeImpl* scope);
+  void clearScopesFromCaches();
+  void mergeCounterShards() const;
+  void releaseCounterShard(ThreadLocalCounterImpl& shard);
   void releaseScopeCrossThread(ScopeImpl* scope);
   SafeAllocData safeAlloc(const std::string& name);
 
@@ -117,6 +172,12 @@ private:
   ThreadLocal::SlotPtr tls_;
   mutable std::mutex lock_;
   std::unordered_set<ScopeImpl*> scopes_;
+  // Destroyed scopes waiting for the next batched cross thread cache clear. Guarded by lock_.
+  std::vector<ScopeImpl*> scopes_to_clear_;
+  // Whether a batched cache clear has been posted but not yet run. Guarded by lock_.
+  bool clear_scheduled_{};
+  // Maps each backing counter to its live per thread shards. Guarded by lock_.
+  std::unordered_map<Counter*, std::list<ThreadLocalCounterImpl*>> counter_shards_;
   ScopePtr default_scope_;
   std::list<std::reference_wrapper<Sink>> timer_sinks_;
   std::atomic<bool> shutting_down_{};
@@ -37,9 +37,12 @@ SlotPtr InstanceImpl::allocateSlot() {
   return std::move(slot);
 }
 
-ThreadLocalObjectSharedPtr InstanceImpl::SlotImpl::get() {
-  ASSERT(thread_local_data_.data_.size() > index_);
-  return thread_local_data_.data_[index_];
+ThreadLocalObject& InstanceImpl::SlotImpl::get() {
+  // The shared_ptr in the vector keeps the object alive; returning a reference avoids the atomic
+  // refcount bump that a copy would incur on every access. The object cannot be replaced or freed
+  // while the caller is using it because both happen via callbacks posted to this thread.
+  ASSERT(thread_local_data_.data_.size() > index_ && thread_local_data_.data_[index_] != nullptr);
+  return *thread_local_data_.data_[index_];
 }
 
 void InstanceImpl::registerThread(Event::Dispatcher& dispatcher, bool main_thread) {
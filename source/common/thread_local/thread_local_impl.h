@@ -32,7 +32,7 @@ private:
     ~SlotImpl() { parent_.removeSlot(*this); }
 
     // ThreadLocal::Slot
-    ThreadLocalObjectSharedPtr get() override;
+    ThreadLocalObject& get() override;
     void runOnAllThreads(Event::PostCb cb) override { parent_.runOnAllThreads(cb); }
     void set(InitializeCb cb) override;
 
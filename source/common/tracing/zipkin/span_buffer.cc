@@ -3,8 +3,7 @@
 namespace Envoy {
 namespace Zipkin {
 
-// TODO(fabolive): Need to avoid the copy to improve performance.
-bool SpanBuffer::addSpan(const Span& span) {
+bool SpanBuffer::addSpan(Span&& span) {
   if (span_buffer_.size() == span_buffer_.capacity()) {
     // Buffer full
     return false;
@@ -14,20 +13,19 @@ bool SpanBuffer::addSpan(const Span& span) {
   return true;
 }
 
-std::string SpanBuffer::toStringifiedJsonArray() {
-  std::string stringified_json_array = "[";
-
-  if (pendingSpans()) {
-    stringified_json_array += span_buffer_[0].toJson();
-    const uint64_t size = span_buffer_.size();
-    for (uint64_t i = 1; i < size; i++) {
-      stringified_json_array += ",";
-      stringified_json_array += span_buffer_[i].toJson();
-    }
+void SpanBuffer::serialize(rapidjson::StringBuffer& buffer) const {
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartArray();
+  for (const Span& span : span_buffer_) {
+    span.serialize(writer);
   }
-  stringified_json_array += "]";
+  writer.EndArray();
+}
 
-  return stringified_json_array;
+std::string SpanBuffer::toStringifiedJsonArray() {
+  rapidjson::StringBuffer buffer;
+  serialize(buffer);
+  return buffer.GetString();
 }
 } // namespace Zipkin
 } // namespace Envoy
@@ -2,6 +2,9 @@
 
 #include "common/tracing/zipkin/zipkin_core_types.h"
 
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
 namespace Envoy {
 namespace Zipkin {
 
@@ -38,7 +41,7 @@ public:
    *
    * @return true if the span was successfully added, or false if the buffer was full.
    */
-  bool addSpan(const Span& span);
+  bool addSpan(Span&& span);
 
   /**
    * Empties the buffer. This method is supposed to be called when all buffered spans
@@ -51,6 +54,15 @@ public:
    */
   uint64_t pendingSpans() { return span_buffer_.size(); }
 
+  /**
+   * Serializes all buffered spans as a JSON array into the given buffer. The buffer is
+   * typically owned by the caller and reused across flushes so that steady-state flushing
+   * does not reallocate.
+   *
+   * @param buffer The output buffer; existing contents are appended to.
+   */
+  void serialize(rapidjson::StringBuffer& buffer) const;
+
   /**
    * @return the contents of the buffer as a stringified array of JSONs, where
    * each JSON in the array corresponds to one Zipkin span.
@@ -14,6 +14,13 @@ namespace Envoy {
 
 namespace Zipkin {
 
+const std::string ZipkinBase::toJson() {
+  rapidjson::StringBuffer s;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+  serialize(writer);
+  return s.GetString();
+}
+
 Endpoint::Endpoint(const Endpoint& ep) {
   service_name_ = ep.serviceName();
   address_ = ep.address();
@@ -25,9 +32,7 @@ Endpoint& Endpoint::operator=(const Endpoint& ep) {
   return *this;
 }
 
-const std::string Endpoint::toJson() {
-  rapidjson::StringBuffer s;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+void Endpoint::serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const {
   writer.StartObject();
   if (!address_) {
     writer.Key(ZipkinJsonFieldNames::get().ENDPOINT_IPV4.c_str());
@@ -49,9 +54,6 @@ const std::string Endpoint::toJson() {
   writer.Key(ZipkinJsonFieldNames::get().ENDPOINT_SERVICE_NAME.c_str());
   writer.String(service_name_.c_str());
   writer.EndObject();
-  std::string json_string = s.GetString();
-
-  return json_string;
 }
 
 Annotation::Annotation(const Annotation& ann) {
@@ -78,24 +80,17 @@ void Annotation::changeEndpointServiceName(const std::string& service_name) {
   }
 }
 
-const std::string Annotation::toJson() {
-  rapidjson::StringBuffer s;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+void Annotation::serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const {
   writer.StartObject();
   writer.Key(ZipkinJsonFieldNames::get().ANNOTATION_TIMESTAMP.c_str());
   writer.Uint64(timestamp_);
   writer.Key(ZipkinJsonFieldNames::get().ANNOTATION_VALUE.c_str());
   writer.String(value_.c_str());
-  writer.EndObject();
-
-  std::string json_string = s.GetString();
-
   if (endpoint_.valid()) {
-    Util::mergeJsons(json_string, static_cast<Endpoint>(endpoint_.value()).toJson(),
-                     ZipkinJsonFieldNames::get().ANNOTATION_ENDPOINT.c_str());
+    writer.Key(ZipkinJsonFieldNames::get().ANNOTATION_ENDPOINT.c_str());
+    endpoint_.value().serialize(writer);
   }
-
-  return json_string;
+  writer.EndObject();
 }
 
 BinaryAnnotation::BinaryAnnotation(const BinaryAnnotation& ann) {
@@ -118,24 +113,17 @@ BinaryAnnotation& BinaryAnnotation::operator=(const BinaryAnnotation& ann) {
   return *this;
 }
 
-const std::string BinaryAnnotation::toJson() {
-  rapidjson::StringBuffer s;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+void BinaryAnnotation::serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const {
   writer.StartObject();
   writer.Key(ZipkinJsonFieldNames::get().BINARY_ANNOTATION_KEY.c_str());
   writer.String(key_.c_str());
   writer.Key(ZipkinJsonFieldNames::get().BINARY_ANNOTATION_VALUE.c_str());
   writer.String(value_.c_str());
-  writer.EndObject();
-
-  std::string json_string = s.GetString();
-
   if (endpoint_.valid()) {
-    Util::mergeJsons(json_string, static_cast<Endpoint>(endpoint_.value()).toJson(),
-                     ZipkinJsonFieldNames::get().BINARY_ANNOTATION_ENDPOINT.c_str());
+    writer.Key(ZipkinJsonFieldNames::get().BINARY_ANNOTATION_ENDPOINT.c_str());
+    endpoint_.value().serialize(writer);
   }
-
-  return json_string;
+  writer.EndObject();
 }
 
 const std::string Span::EMPTY_HEX_STRING_ = "0000000000000000";
@@ -169,9 +157,7 @@ void Span::setServiceName(const std::string& service_name) {
   }
 }
 
-const std::string Span::toJson() {
-  rapidjson::StringBuffer s;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+void Span::serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const {
   writer.StartObject();
   writer.Key(ZipkinJsonFieldNames::get().SPAN_TRACE_ID.c_str());
   writer.String(Hex::uint64ToHex(trace_id_).c_str());
@@ -195,26 +181,21 @@ const std::string Span::toJson() {
     writer.Int64(duration_.value());
   }
 
-  writer.EndObject();
-
-  std::string json_string = s.GetString();
-
-  std::vector<std::string> annotation_json_vector;
-
-  for (auto it = annotations_.begin(); it != annotations_.end(); it++) {
-    annotation_json_vector.push_back(it->toJson());
+  writer.Key(ZipkinJsonFieldNames::get().SPAN_ANNOTATIONS.c_str());
+  writer.StartArray();
+  for (const Annotation& annotation : annotations_) {
+    annotation.serialize(writer);
   }
-  Util::addArrayToJson(json_string, annotation_json_vector,
-                       ZipkinJsonFieldNames::get().SPAN_ANNOTATIONS.c_str());
+  writer.EndArray();
 
-  std::vector<std::string> binary_annotation_json_vector;
-  for (auto it = binary_annotations_.begin(); it != binary_annotations_.end(); it++) {
-    binary_annotation_json_vector.push_back(it->toJson());
+  writer.Key(ZipkinJsonFieldNames::get().SPAN_BINARY_ANNOTATIONS.c_str());
+  writer.StartArray();
+  for (const BinaryAnnotation& binary_annotation : binary_annotations_) {
+    binary_annotation.serialize(writer);
   }
-  Util::addArrayToJson(json_string, binary_annotation_json_vector,
-                       ZipkinJsonFieldNames::get().SPAN_BINARY_ANNOTATIONS.c_str());
+  writer.EndArray();
 
-  return json_string;
+  writer.EndObject();
 }
 
 void Span::finish() {
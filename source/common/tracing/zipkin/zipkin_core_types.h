@@ -10,6 +10,9 @@
 #include "common/tracing/zipkin/tracer_interface.h"
 #include "common/tracing/zipkin/util.h"
 
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
 namespace Envoy {
 namespace Zipkin {
 
@@ -25,10 +28,17 @@ public:
   virtual ~ZipkinBase() {}
 
   /**
-   * All classes defining Zipkin abstractions need to implement this method to convert
-   * the corresponding abstraction to a Zipkin-compliant JSON.
+   * All classes defining Zipkin abstractions need to implement this method to serialize
+   * the corresponding abstraction into the given writer as Zipkin-compliant JSON. Serializing
+   * through a shared writer lets a whole batch of spans be rendered into a single buffer
+   * without building intermediate strings for each nested object.
+   */
+  virtual void serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const PURE;
+
+  /**
+   * Serializes the abstraction as a stand-alone, Zipkin-compliant stringified JSON.
    */
-  virtual const std::string toJson() PURE;
+  const std::string toJson();
 };
 
 /**
@@ -82,11 +92,9 @@ public:
   void setServiceName(const std::string& service_name) { service_name_ = service_name; }
 
   /**
-   * Serializes the endpoint as a Zipkin-compliant JSON representation as a string.
-   *
-   * @return a stringified JSON.
+   * Serializes the endpoint as a Zipkin-compliant JSON object into the given writer.
    */
-  const std::string toJson() override;
+  void serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const override;
 
 private:
   std::string service_name_;
@@ -174,11 +182,9 @@ public:
   bool isSetEndpoint() const { return endpoint_.valid(); }
 
   /**
-   * Serializes the annotation as a Zipkin-compliant JSON representation as a string.
-   *
-   * @return a stringified JSON.
+   * Serializes the annotation as a Zipkin-compliant JSON object into the given writer.
    */
-  const std::string toJson() override;
+  void serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const override;
 
 private:
   uint64_t timestamp_;
@@ -273,11 +279,9 @@ public:
   void setValue(const std::string& value) { value_ = value; }
 
   /**
-   * Serializes the binary annotation as a Zipkin-compliant JSON representation as a string.
-   *
-   * @return a stringified JSON.
+   * Serializes the binary annotation as a Zipkin-compliant JSON object into the given writer.
    */
-  const std::string toJson() override;
+  void serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const override;
 
 private:
   std::string key_;
@@ -488,13 +492,11 @@ public:
   void setServiceName(const std::string& service_name);
 
   /**
-   * Serializes the span as a Zipkin-compliant JSON representation as a string.
-   * The resulting JSON string can be used as part of an HTTP POST call to
-   * send the span to Zipkin.
-   *
-   * @return a stringified JSON.
+   * Serializes the span as a Zipkin-compliant JSON object into the given writer, including
+   * its annotations and binary annotations. Spans belonging to the same batch are serialized
+   * back to back into one buffer so that flushing does not concatenate per-span strings.
    */
-  const std::string toJson() override;
+  void serialize(rapidjson::Writer<rapidjson::StringBuffer>& writer) const override;
 
   /**
    * Associates a Tracer object with the span. The tracer's reportSpan() method is invoked
@@ -153,9 +153,8 @@ ReporterPtr ReporterImpl::NewInstance(Driver& driver, Event::Dispatcher& dispatc
   return ReporterPtr(new ReporterImpl(driver, dispatcher, collector_endpoint));
 }
 
-// TODO(fabolive): Need to avoid the copy to improve performance.
-void ReporterImpl::reportSpan(const Span& span) {
-  span_buffer_.addSpan(span);
+void ReporterImpl::reportSpan(Span&& span) {
+  span_buffer_.addSpan(std::move(span));
 
   const uint64_t min_flush_spans =
       driver_.runtime().snapshot().getInteger("tracing.zipkin.min_flush_spans", 5U);
@@ -175,7 +174,9 @@ void ReporterImpl::flushSpans() {
   if (span_buffer_.pendingSpans()) {
     driver_.tracerStats().spans_sent_.add(span_buffer_.pendingSpans());
 
-    const std::string request_body = span_buffer_.toStringifiedJsonArray();
+    serialization_buffer_.Clear();
+    span_buffer_.serialize(serialization_buffer_);
+
     Http::MessagePtr message(new Http::RequestMessageImpl());
     message->headers().insertMethod().value().setReference(Http::Headers::get().MethodValues.Post);
     message->headers().insertPath().value(collector_endpoint_);
@@ -184,7 +185,7 @@ void ReporterImpl::flushSpans() {
         Http::Headers::get().ContentTypeValues.Json);
 
     Buffer::InstancePtr body(new Buffer::OwnedImpl());
-    body->add(request_body);
+    body->add(serialization_buffer_.GetString(), serialization_buffer_.GetSize());
     message->body() = std::move(body);
 
     const uint64_t timeout =
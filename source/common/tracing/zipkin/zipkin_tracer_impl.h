@@ -11,6 +11,8 @@
 #include "common/tracing/zipkin/span_buffer.h"
 #include "common/tracing/zipkin/tracer.h"
 
+#include "rapidjson/stringbuffer.h"
+
 namespace Envoy {
 namespace Zipkin {
 
@@ -163,7 +165,7 @@ public:
    *
    * @param span The span to be buffered.
    */
-  void reportSpan(const Span& span) override;
+  void reportSpan(Span&& span) override;
 
   // Http::AsyncClient::Callbacks.
   // The callbacks below record Zipkin-span-related stats.
@@ -198,6 +200,9 @@ private:
   Driver& driver_;
   Event::TimerPtr flush_timer_;
   SpanBuffer span_buffer_;
+  // Reused across flushes; Clear() keeps the underlying allocation so serializing a batch in
+  // steady state does not hit the allocator.
+  rapidjson::StringBuffer serialization_buffer_;
   const std::string collector_endpoint_;
 };
 } // Zipkin
@@ -1,7 +1,5 @@
 #include "common/upstream/cds_subscription.h"
 
-#include <vector>
-
 #include "common/config/cds_json.h"
 #include "common/config/utility.h"
 #include "common/http/headers.h"
@@ -42,14 +40,18 @@ void CdsSubscription::createRequest(Http::Message& request) {
 void CdsSubscription::parseResponse(const Http::Message& response) {
   ENVOY_LOG(debug, "cds: parsing response");
   const std::string response_body = response.bodyAsString();
-  Json::ObjectSharedPtr response_json = Json::Factory::loadFromString(response_body);
-  response_json->validateSchema(Json::Schema::CDS_SCHEMA);
-  std::vector<Json::ObjectSharedPtr> clusters = response_json->getObjectArray("clusters");
 
+  // Stream the cluster array out of the response so that a large CDS payload is never fully
+  // materialized as a JSON document: each cluster is translated to its proto form as soon as
+  // it has been parsed and its JSON is released immediately. translateCluster() performs the
+  // per-cluster schema validation; the envelope is validated below before the update is
+  // delivered.
   Protobuf::RepeatedPtrField<envoy::api::v2::Cluster> resources;
-  for (const Json::ObjectSharedPtr& cluster : clusters) {
-    Config::CdsJson::translateCluster(*cluster, eds_config_, *resources.Add());
-  }
+  Json::ObjectSharedPtr response_json = Json::Factory::loadFromStringStreaming(
+      response_body, "clusters", [this, &resources](Json::ObjectSharedPtr cluster) -> void {
+        Config::CdsJson::translateCluster(*cluster, eds_config_, *resources.Add());
+      });
+  response_json->validateSchema(Json::Schema::CDS_SCHEMA);
 
   callbacks_->onConfigUpdate(resources);
   version_info_ = Config::Utility::computeHashedVersion(response_body);
@@ -4,7 +4,9 @@
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "envoy/event/dispatcher.h"
@@ -38,16 +40,17 @@ void ClusterManagerInitHelper::addCluster(Cluster& cluster) {
     return;
   }
 
+  total_clusters_++;
   if (cluster.initializePhase() == Cluster::InitializePhase::Primary) {
     primary_init_clusters_.push_back(&cluster);
-    cluster.initialize();
+    startClusterInit(cluster);
   } else {
     ASSERT(cluster.initializePhase() == Cluster::InitializePhase::Secondary);
     secondary_init_clusters_.push_back(&cluster);
     if (started_secondary_initialize_) {
       // This can happen if we get a second CDS update that adds new clusters after we have
       // already started secondary init. In this case, just immediately initialize.
-      cluster.initialize();
+      startClusterInit(cluster);
     }
   }
 
@@ -77,11 +80,42 @@ void ClusterManagerInitHelper::removeCluster(Cluster& cluster) {
   // It is possible that the cluster we are removing has already been initialized, and is not
   // present in the initializer list. If so, this is fine.
   cluster_list->remove(&cluster);
+  active_init_clusters_.remove(&cluster);
+  init_queue_.remove(&cluster);
   ENVOY_LOG(info, "cm init: init complete: cluster={} primary={} secondary={}",
             cluster.info()->name(), primary_init_clusters_.size(), secondary_init_clusters_.size());
+  startQueuedClusterInits();
   maybeFinishInitialize();
 }
 
+void ClusterManagerInitHelper::startClusterInit(Cluster& cluster) {
+  if (max_parallel_init_ != 0 && active_init_clusters_.size() >= max_parallel_init_) {
+    init_queue_.push_back(&cluster);
+    return;
+  }
+
+  active_init_clusters_.push_back(&cluster);
+  cluster.initialize();
+}
+
+void ClusterManagerInitHelper::startQueuedClusterInits() {
+  // Cluster::initialize() can complete synchronously and re-enter here via removeCluster(), so
+  // flatten reentrant calls and let the loop below pick up any slots that free up.
+  if (starting_queued_inits_) {
+    return;
+  }
+
+  starting_queued_inits_ = true;
+  while (!init_queue_.empty() &&
+         (max_parallel_init_ == 0 || active_init_clusters_.size() < max_parallel_init_)) {
+    Cluster* cluster = init_queue_.front();
+    init_queue_.pop_front();
+    active_init_clusters_.push_back(cluster);
+    cluster->initialize();
+  }
+  starting_queued_inits_ = false;
+}
+
 void ClusterManagerInitHelper::maybeFinishInitialize() {
   // Do not do anything if we are still doing the initial static load or if we are waiting for
   // CDS initialize.
@@ -89,8 +123,23 @@ void ClusterManagerInitHelper::maybeFinishInitialize() {
     return;
   }
 
-  // If we are still waiting for primary clusters to initialize, do nothing.
   ASSERT(state_ == State::WaitingForStaticInitialize || state_ == State::CdsInitialized);
+
+  // If a ready percentage below 100 is configured, unblock the initialized callback as soon as
+  // enough clusters have warmed. The remaining clusters keep warming in the background and the
+  // state machine below still runs to completion.
+  if (!initialized_callback_fired_ && initialized_callback_ && ready_percent_ < 100 &&
+      total_clusters_ > 0) {
+    const uint64_t pending = primary_init_clusters_.size() + secondary_init_clusters_.size();
+    if ((total_clusters_ - pending) * 100 >= total_clusters_ * ready_percent_) {
+      ENVOY_LOG(info, "cm init: {}/{} clusters initialized, ready percent {} reached",
+                total_clusters_ - pending, total_clusters_, ready_percent_);
+      initialized_callback_fired_ = true;
+      initialized_callback_();
+    }
+  }
+
+  // If we are still waiting for primary clusters to initialize, do nothing.
   if (!primary_init_clusters_.empty()) {
     return;
   }
@@ -107,7 +156,7 @@ void ClusterManagerInitHelper::maybeFinishInitialize() {
       for (auto iter = secondary_init_clusters_.begin(); iter != secondary_init_clusters_.end();) {
         Cluster* cluster = *iter;
         ++iter;
-        cluster->initialize();
+        startClusterInit(*cluster);
       }
     }
 
@@ -124,7 +173,8 @@ void ClusterManagerInitHelper::maybeFinishInitialize() {
   } else {
     ENVOY_LOG(info, "cm init: all clusters initialized");
     state_ = State::AllClustersInitialized;
-    if (initialized_callback_) {
+    if (initialized_callback_ && !initialized_callback_fired_) {
+      initialized_callback_fired_ = true;
       initialized_callback_();
     }
   }
@@ -164,7 +214,16 @@ ClusterManagerImpl::ClusterManagerImpl(const envoy::api::v2::Bootstrap& bootstra
                                        AccessLog::AccessLogManager& log_manager,
                                        Event::Dispatcher& primary_dispatcher)
     : factory_(factory), runtime_(runtime), stats_(stats), tls_(tls.allocateSlot()),
-      random_(random), local_info_(local_info), cm_stats_(generateStats(stats)) {
+      random_(random), local_info_(local_info), cm_stats_(generateStats(stats)),
+      init_helper_(runtime.snapshot().getInteger("cluster_manager.init_parallelism", 0),
+                   runtime.snapshot().getInteger("cluster_manager.init_ready_percent", 100)),
+      update_settle_window_(std::chrono::milliseconds(
+          runtime.snapshot().getInteger("cluster_manager.update_settle_window_ms", 0))) {
+  if (update_settle_window_.count() > 0) {
+    update_settle_timer_ =
+        primary_dispatcher.createTimer([this]() -> void { applyPendingClusterUpdates(); });
+  }
+
   const auto& ads_config = bootstrap.dynamic_resources().ads_config();
   if (ads_config.cluster_name().empty()) {
     ENVOY_LOG(debug, "No ADS clusters defined, ADS will not be initialized.");
@@ -270,8 +329,9 @@ bool ClusterManagerImpl::addOrUpdatePrimaryCluster(const envoy::api::v2::Cluster
 
   loadCluster(cluster, true);
   ClusterInfoConstSharedPtr new_cluster = primary_clusters_.at(cluster_name).cluster_->info();
+  const uint64_t handle = clusterHandle(cluster_name);
   ENVOY_LOG(info, "add/update cluster {}", cluster_name);
-  tls_->runOnAllThreads([this, new_cluster]() -> void {
+  tls_->runOnAllThreads([this, new_cluster, handle]() -> void {
     ThreadLocalClusterManagerImpl& cluster_manager =
         tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
@@ -281,8 +341,10 @@ bool ClusterManagerImpl::addOrUpdatePrimaryCluster(const envoy::api::v2::Cluster
       ENVOY_LOG(debug, "adding TLS cluster {}", new_cluster->name());
     }
 
-    cluster_manager.thread_local_clusters_[new_cluster->name()].reset(
-        new ThreadLocalClusterManagerImpl::ClusterEntry(cluster_manager, new_cluster));
+    ThreadLocalClusterManagerImpl::ClusterEntryPtr& entry =
+        cluster_manager.thread_local_clusters_[new_cluster->name()];
+    entry.reset(new ThreadLocalClusterManagerImpl::ClusterEntry(cluster_manager, new_cluster));
+    cluster_manager.setClusterByHandle(handle, entry.get());
   });
 
   postInitializeCluster(*primary_clusters_.at(cluster_name).cluster_);
@@ -297,15 +359,22 @@ bool ClusterManagerImpl::removePrimaryCluster(const std::string& cluster_name) {
 
   init_helper_.removeCluster(*existing_cluster->second.cluster_);
   primary_clusters_.erase(existing_cluster);
+  // Drop any membership update still waiting out the settle window. The TLS cluster is erased
+  // below, so publishing a stale update for it later would hit the worker side assert.
+  if (pending_cluster_updates_.erase(cluster_name) > 0 && pending_cluster_updates_.empty()) {
+    update_settle_timer_->disableTimer();
+  }
   cm_stats_.cluster_removed_.inc();
   cm_stats_.total_clusters_.set(primary_clusters_.size());
   ENVOY_LOG(info, "removing cluster {}", cluster_name);
-  tls_->runOnAllThreads([this, cluster_name]() -> void {
+  const uint64_t handle = cluster_handle_map_.at(cluster_name);
+  tls_->runOnAllThreads([this, cluster_name, handle]() -> void {
     ThreadLocalClusterManagerImpl& cluster_manager =
         tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
     ASSERT(cluster_manager.thread_local_clusters_.count(cluster_name) == 1);
     ENVOY_LOG(debug, "removing TLS cluster {}", cluster_name);
+    cluster_manager.setClusterByHandle(handle, nullptr);
     cluster_manager.thread_local_clusters_.erase(cluster_name);
   });
 
@@ -339,6 +408,9 @@ void ClusterManagerImpl::loadCluster(const envoy::api::v2::Cluster& cluster, boo
       primary_cluster_reference.info()->name(),
       PrimaryClusterData{MessageUtil::hash(cluster), added_via_api, std::move(new_cluster)});
 
+  // Make sure the name has an interned handle before any thread local update references it.
+  clusterHandle(primary_cluster_reference.info()->name());
+
   cm_stats_.total_clusters_.set(primary_clusters_.size());
   if (num_erased) {
     cm_stats_.cluster_modified_.inc();
@@ -358,6 +430,28 @@ ThreadLocalCluster* ClusterManagerImpl::get(const std::string& cluster) {
   }
 }
 
+uint64_t ClusterManagerImpl::clusterHandle(const std::string& cluster) {
+  // Handles are never reclaimed: a name keeps its slot across CDS update/remove cycles so that
+  // route tables built against an earlier generation of the cluster set remain valid.
+  auto existing = cluster_handle_map_.find(cluster);
+  if (existing != cluster_handle_map_.end()) {
+    return existing->second;
+  }
+
+  const uint64_t handle = cluster_handle_map_.size();
+  cluster_handle_map_.emplace(cluster, handle);
+  return handle;
+}
+
+ThreadLocalCluster* ClusterManagerImpl::getByHandle(uint64_t handle) {
+  ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
+
+  if (handle >= cluster_manager.thread_local_clusters_by_handle_.size()) {
+    return nullptr;
+  }
+  return cluster_manager.thread_local_clusters_by_handle_[handle];
+}
+
 Http::ConnectionPool::Instance*
 ClusterManagerImpl::httpConnPoolForCluster(const std::string& cluster, ResourcePriority priority,
                                            LoadBalancerContext* context) {
@@ -376,6 +470,10 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(
     const Cluster& primary_cluster, const std::vector<HostSharedPtr>& hosts_added,
     const std::vector<HostSharedPtr>& hosts_removed) {
   const std::string& name = primary_cluster.info()->name();
+  // The lists are copied out of the primary cluster exactly once into immutable snapshots that
+  // all workers share. Posting the callback to each worker copies only the captured shared_ptrs
+  // (a reference count bump each); the worker then swaps the snapshots into its thread local
+  // host set in updateClusterMembership() below.
   HostVectorConstSharedPtr hosts_copy(new std::vector<HostSharedPtr>(primary_cluster.hosts()));
   HostVectorConstSharedPtr healthy_hosts_copy(
       new std::vector<HostSharedPtr>(primary_cluster.healthyHosts()));
@@ -383,12 +481,71 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(
       new std::vector<std::vector<HostSharedPtr>>(primary_cluster.hostsPerZone()));
   HostListsConstSharedPtr healthy_hosts_per_zone_copy(
       new std::vector<std::vector<HostSharedPtr>>(primary_cluster.healthyHostsPerZone()));
+  HostVectorConstSharedPtr hosts_added_copy(new std::vector<HostSharedPtr>(hosts_added));
+  HostVectorConstSharedPtr hosts_removed_copy(new std::vector<HostSharedPtr>(hosts_removed));
+
+  if (!update_settle_timer_) {
+    tls_->runOnAllThreads([this, name, hosts_copy, healthy_hosts_copy, hosts_per_zone_copy,
+                           healthy_hosts_per_zone_copy, hosts_added_copy,
+                           hosts_removed_copy]() -> void {
+      ThreadLocalClusterManagerImpl::updateClusterMembership(
+          name, hosts_copy, healthy_hosts_copy, hosts_per_zone_copy, healthy_hosts_per_zone_copy,
+          hosts_added_copy, hosts_removed_copy, *tls_);
+    });
+    return;
+  }
 
-  tls_->runOnAllThreads([this, name, hosts_copy, healthy_hosts_copy, hosts_per_zone_copy,
-                         healthy_hosts_per_zone_copy, hosts_added, hosts_removed]() -> void {
-    ThreadLocalClusterManagerImpl::updateClusterMembership(
-        name, hosts_copy, healthy_hosts_copy, hosts_per_zone_copy, healthy_hosts_per_zone_copy,
-        hosts_added, hosts_removed, *tls_);
+  // Coalescing is enabled: stash the update and publish everything that accumulated once the
+  // settle window elapses. A management server burst — e.g. EDS refreshing every cluster after a
+  // deploy — then costs a single cross worker post instead of one per cluster.
+  const bool was_empty = pending_cluster_updates_.empty();
+  auto result = pending_cluster_updates_.emplace(
+      name, PendingClusterUpdate{hosts_copy, healthy_hosts_copy, hosts_per_zone_copy,
+                                 healthy_hosts_per_zone_copy, hosts_added_copy,
+                                 hosts_removed_copy});
+  if (!result.second) {
+    // Keep only the newest snapshots but concatenate the deltas: the workers must see every host
+    // removed during the window so that its connection pools get drained.
+    PendingClusterUpdate& pending = result.first->second;
+    pending.hosts_ = hosts_copy;
+    pending.healthy_hosts_ = healthy_hosts_copy;
+    pending.hosts_per_zone_ = hosts_per_zone_copy;
+    pending.healthy_hosts_per_zone_ = healthy_hosts_per_zone_copy;
+    if (!hosts_added.empty()) {
+      HostVectorSharedPtr merged_added(new std::vector<HostSharedPtr>(*pending.hosts_added_));
+      merged_added->insert(merged_added->end(), hosts_added.begin(), hosts_added.end());
+      pending.hosts_added_ = merged_added;
+    }
+    if (!hosts_removed.empty()) {
+      HostVectorSharedPtr merged_removed(new std::vector<HostSharedPtr>(*pending.hosts_removed_));
+      merged_removed->insert(merged_removed->end(), hosts_removed.begin(), hosts_removed.end());
+      pending.hosts_removed_ = merged_removed;
+    }
+  }
+
+  if (was_empty) {
+    // The window is fixed rather than sliding so that a continuous stream of updates cannot
+    // starve the workers of a publication indefinitely.
+    update_settle_timer_->enableTimer(update_settle_window_);
+  }
+}
+
+void ClusterManagerImpl::applyPendingClusterUpdates() {
+  ASSERT(!pending_cluster_updates_.empty());
+  // Move the batch into a single immutable list that all workers share and publish it with one
+  // cross worker post, regardless of how many clusters changed during the window.
+  std::shared_ptr<std::vector<std::pair<std::string, PendingClusterUpdate>>> batch(
+      new std::vector<std::pair<std::string, PendingClusterUpdate>>(
+          pending_cluster_updates_.begin(), pending_cluster_updates_.end()));
+  pending_cluster_updates_.clear();
+
+  tls_->runOnAllThreads([this, batch]() -> void {
+    for (const auto& update : *batch) {
+      ThreadLocalClusterManagerImpl::updateClusterMembership(
+          update.first, update.second.hosts_, update.second.healthy_hosts_,
+          update.second.hosts_per_zone_, update.second.healthy_hosts_per_zone_,
+          update.second.hosts_added_, update.second.hosts_removed_, *tls_);
+    }
   });
 }
 
@@ -428,8 +585,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
   if (local_cluster_name.valid()) {
     ENVOY_LOG(debug, "adding TLS local cluster {}", local_cluster_name.value());
     auto& local_cluster = parent.primary_clusters_.at(local_cluster_name.value()).cluster_;
-    thread_local_clusters_[local_cluster_name.value()].reset(
-        new ClusterEntry(*this, local_cluster->info()));
+    ClusterEntryPtr& entry = thread_local_clusters_[local_cluster_name.value()];
+    entry.reset(new ClusterEntry(*this, local_cluster->info()));
+    setClusterByHandle(parent.cluster_handle_map_.at(local_cluster_name.value()), entry.get());
   }
 
   local_host_set_ = local_cluster_name.valid()
@@ -444,9 +602,18 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
 
     ENVOY_LOG(debug, "adding TLS initial cluster {}", cluster.first);
     ASSERT(thread_local_clusters_.count(cluster.first) == 0);
-    thread_local_clusters_[cluster.first].reset(
-        new ClusterEntry(*this, cluster.second.cluster_->info()));
+    ClusterEntryPtr& entry = thread_local_clusters_[cluster.first];
+    entry.reset(new ClusterEntry(*this, cluster.second.cluster_->info()));
+    setClusterByHandle(parent.cluster_handle_map_.at(cluster.first), entry.get());
+  }
+}
+
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::setClusterByHandle(uint64_t handle,
+                                                                           ClusterEntry* entry) {
+  if (handle >= thread_local_clusters_by_handle_.size()) {
+    thread_local_clusters_by_handle_.resize(handle + 1, nullptr);
   }
+  thread_local_clusters_by_handle_[handle] = entry;
 }
 
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImpl() {
@@ -458,6 +625,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
   //                     redis/conn_pool_impl.cc. Will fix at the same time.
   ENVOY_LOG(debug, "shutting down thread local cluster manager");
   host_http_conn_pool_map_.clear();
+  thread_local_clusters_by_handle_.clear();
   for (auto& cluster : thread_local_clusters_) {
     if (&cluster.second->host_set_ != local_host_set_) {
       cluster.second.reset();
@@ -513,14 +681,14 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::drainConnPools(
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
     const std::string& name, HostVectorConstSharedPtr hosts, HostVectorConstSharedPtr healthy_hosts,
     HostListsConstSharedPtr hosts_per_zone, HostListsConstSharedPtr healthy_hosts_per_zone,
-    const std::vector<HostSharedPtr>& hosts_added, const std::vector<HostSharedPtr>& hosts_removed,
+    HostVectorConstSharedPtr hosts_added, HostVectorConstSharedPtr hosts_removed,
     ThreadLocal::Slot& tls) {
 
   ThreadLocalClusterManagerImpl& config = tls.getTyped<ThreadLocalClusterManagerImpl>();
 
   ASSERT(config.thread_local_clusters_.find(name) != config.thread_local_clusters_.end());
   config.thread_local_clusters_[name]->host_set_.updateHosts(
-      hosts, healthy_hosts, hosts_per_zone, healthy_hosts_per_zone, hosts_added, hosts_removed);
+      hosts, healthy_hosts, hosts_per_zone, healthy_hosts_per_zone, *hosts_added, *hosts_removed);
 }
 
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
@@ -614,7 +782,7 @@ ProdClusterManagerFactory::allocateConnPool(Event::Dispatcher& dispatcher, HostC
         new Http::Http2::ProdConnPoolImpl(dispatcher, host, priority)};
   } else {
     return Http::ConnectionPool::InstancePtr{
-        new Http::Http1::ConnPoolImplProd(dispatcher, host, priority)};
+        new Http::Http1::ConnPoolImplProd(dispatcher, host, priority, runtime_)};
   }
 }
 
@@ -623,7 +791,7 @@ ClusterSharedPtr ProdClusterManagerFactory::clusterFromProto(
     Outlier::EventLoggerSharedPtr outlier_event_logger, bool added_via_api) {
   return ClusterImplBase::create(cluster, cm, stats_, tls_, dns_resolver_, ssl_context_manager_,
                                  runtime_, random_, primary_dispatcher_, local_info_,
-                                 outlier_event_logger, added_via_api);
+                                 outlier_event_logger, added_via_api, health_check_dispatcher_);
 }
 
 CdsApiPtr
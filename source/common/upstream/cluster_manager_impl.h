@@ -1,14 +1,18 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "envoy/event/timer.h"
 #include "envoy/http/codes.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/runtime/runtime.h"
@@ -30,15 +34,18 @@ namespace Upstream {
  */
 class ProdClusterManagerFactory : public ClusterManagerFactory {
 public:
+  // health_check_dispatcher optionally supplies a dedicated dispatcher that cluster health
+  // checkers run on; when nullptr they run on the primary dispatcher as before.
   ProdClusterManagerFactory(Runtime::Loader& runtime, Stats::Store& stats,
                             ThreadLocal::Instance& tls, Runtime::RandomGenerator& random,
                             Network::DnsResolverSharedPtr dns_resolver,
                             Ssl::ContextManager& ssl_context_manager,
                             Event::Dispatcher& primary_dispatcher,
-                            const LocalInfo::LocalInfo& local_info)
+                            const LocalInfo::LocalInfo& local_info,
+                            Event::Dispatcher* health_check_dispatcher = nullptr)
       : primary_dispatcher_(primary_dispatcher), runtime_(runtime), stats_(stats), tls_(tls),
         random_(random), dns_resolver_(dns_resolver), ssl_context_manager_(ssl_context_manager),
-        local_info_(local_info) {}
+        local_info_(local_info), health_check_dispatcher_(health_check_dispatcher) {}
 
   // Upstream::ClusterManagerFactory
   ClusterManagerPtr clusterManagerFromProto(const envoy::api::v2::Bootstrap& bootstrap,
@@ -68,6 +75,7 @@ private:
   Network::DnsResolverSharedPtr dns_resolver_;
   Ssl::ContextManager& ssl_context_manager_;
   const LocalInfo::LocalInfo& local_info_;
+  Event::Dispatcher* health_check_dispatcher_;
 };
 
 /**
@@ -76,6 +84,17 @@ private:
  */
 class ClusterManagerInitHelper : Logger::Loggable<Logger::Id::upstream> {
 public:
+  /**
+   * @param max_parallel_init supplies the maximum number of clusters that will warm concurrently.
+   *        0 means no limit.
+   * @param ready_percent supplies the percentage of known clusters that must finish initializing
+   *        before the initialized callback fires. Anything below 100 lets the server come up
+   *        while the remaining clusters continue to warm in the background.
+   */
+  ClusterManagerInitHelper(uint64_t max_parallel_init = 0, uint64_t ready_percent = 100)
+      : max_parallel_init_(max_parallel_init),
+        ready_percent_(std::min<uint64_t>(std::max<uint64_t>(ready_percent, 1), 100)) {}
+
   void addCluster(Cluster& cluster);
   void onStaticLoadComplete();
   void removeCluster(Cluster& cluster);
@@ -92,13 +111,24 @@ private:
   };
 
   void maybeFinishInitialize();
+  void startClusterInit(Cluster& cluster);
+  void startQueuedClusterInits();
 
+  const uint64_t max_parallel_init_;
+  const uint64_t ready_percent_;
   CdsApi* cds_{};
   std::function<void()> initialized_callback_;
   std::list<Cluster*> primary_init_clusters_;
   std::list<Cluster*> secondary_init_clusters_;
+  // Clusters that have had initialize() called but have not yet completed, and clusters waiting
+  // behind the parallelism cap for an initialization slot.
+  std::list<Cluster*> active_init_clusters_;
+  std::list<Cluster*> init_queue_;
+  uint64_t total_clusters_{};
   State state_{State::Loading};
   bool started_secondary_initialize_{};
+  bool initialized_callback_fired_{};
+  bool starting_queued_inits_{};
 };
 
 /**
@@ -145,6 +175,8 @@ public:
     return clusters_map;
   }
   ThreadLocalCluster* get(const std::string& cluster) override;
+  uint64_t clusterHandle(const std::string& cluster) override;
+  ThreadLocalCluster* getByHandle(uint64_t handle) override;
   Http::ConnectionPool::Instance* httpConnPoolForCluster(const std::string& cluster,
                                                          ResourcePriority priority,
                                                          LoadBalancerContext* context) override;
@@ -201,19 +233,23 @@ private:
     ThreadLocalClusterManagerImpl(ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
                                   const Optional<std::string>& local_cluster_name);
     ~ThreadLocalClusterManagerImpl();
+    void setClusterByHandle(uint64_t handle, ClusterEntry* entry);
     void drainConnPools(const std::vector<HostSharedPtr>& hosts);
     void drainConnPools(HostSharedPtr old_host, ConnPoolsContainer& container);
     static void updateClusterMembership(const std::string& name, HostVectorConstSharedPtr hosts,
                                         HostVectorConstSharedPtr healthy_hosts,
                                         HostListsConstSharedPtr hosts_per_zone,
                                         HostListsConstSharedPtr healthy_hosts_per_zone,
-                                        const std::vector<HostSharedPtr>& hosts_added,
-                                        const std::vector<HostSharedPtr>& hosts_removed,
+                                        HostVectorConstSharedPtr hosts_added,
+                                        HostVectorConstSharedPtr hosts_removed,
                                         ThreadLocal::Slot& tls);
 
     ClusterManagerImpl& parent_;
     Event::Dispatcher& thread_local_dispatcher_;
     std::unordered_map<std::string, ClusterEntryPtr> thread_local_clusters_;
+    // Raw aliases into thread_local_clusters_ indexed by interned cluster handle. Ownership
+    // stays with the map above; slots for names with no current cluster hold nullptr.
+    std::vector<ClusterEntry*> thread_local_clusters_by_handle_;
     std::unordered_map<HostConstSharedPtr, ConnPoolsContainer> host_http_conn_pool_map_;
     const HostSet* local_host_set_{};
   };
@@ -227,7 +263,23 @@ private:
     ClusterSharedPtr cluster_;
   };
 
+  /**
+   * A membership update held back while the settle window is open. The snapshots always reflect
+   * the newest state seen for the cluster during the window; the added/removed deltas accumulate
+   * across coalesced updates so that workers still drain connection pools for every host that was
+   * removed mid-window.
+   */
+  struct PendingClusterUpdate {
+    HostVectorConstSharedPtr hosts_;
+    HostVectorConstSharedPtr healthy_hosts_;
+    HostListsConstSharedPtr hosts_per_zone_;
+    HostListsConstSharedPtr healthy_hosts_per_zone_;
+    HostVectorConstSharedPtr hosts_added_;
+    HostVectorConstSharedPtr hosts_removed_;
+  };
+
   static ClusterManagerStats generateStats(Stats::Scope& scope);
+  void applyPendingClusterUpdates();
   void loadCluster(const envoy::api::v2::Cluster& cluster, bool added_via_api);
   void postInitializeCluster(Cluster& cluster);
   void postThreadLocalClusterUpdate(const Cluster& primary_cluster,
@@ -240,6 +292,9 @@ private:
   ThreadLocal::SlotPtr tls_;
   Runtime::RandomGenerator& random_;
   std::unordered_map<std::string, PrimaryClusterData> primary_clusters_;
+  // Interned cluster name -> handle map. Entries are never removed so that a handle bound into
+  // a route table stays valid across CDS update/remove cycles. Main thread only.
+  std::unordered_map<std::string, uint64_t> cluster_handle_map_;
   Optional<envoy::api::v2::ConfigSource> eds_config_;
   Network::Address::InstanceConstSharedPtr source_address_;
   Outlier::EventLoggerSharedPtr outlier_event_logger_;
@@ -247,6 +302,11 @@ private:
   CdsApiPtr cds_api_;
   ClusterManagerStats cm_stats_;
   ClusterManagerInitHelper init_helper_;
+  // How long membership updates are allowed to accumulate before they are published to the
+  // workers as one batch. 0 (the default) publishes every update immediately as before.
+  const std::chrono::milliseconds update_settle_window_;
+  Event::TimerPtr update_settle_timer_;
+  std::unordered_map<std::string, PendingClusterUpdate> pending_cluster_updates_;
   Config::GrpcMuxPtr ads_mux_;
 };
 
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Earliest deadline first scheduler for weighted fair picking. Each entry is assigned a deadline
+ * of 1/weight past the current virtual time when it is added, picking always selects the entry
+ * with the earliest deadline and then pushes its deadline 1/weight further out. Over time entries
+ * are therefore picked in proportion to their weights, picks are O(log n), and picking performs
+ * no allocation beyond the heap's initial growth.
+ */
+template <class C> class EdfScheduler {
+public:
+  /**
+   * Add an entry to the scheduler.
+   * @param weight supplies the entry's weight. Entries with a higher weight are picked
+   *        proportionally more often. Must be > 0.
+   * @param entry supplies the entry to add.
+   */
+  void add(double weight, std::shared_ptr<C> entry) {
+    ASSERT(weight > 0);
+    queue_.push({current_time_ + 1.0 / weight, weight, order_offset_++, std::move(entry)});
+  }
+
+  /**
+   * @return std::shared_ptr<C> the entry with the earliest deadline, or nullptr if the scheduler
+   *         is empty. The picked entry is rescheduled with a new deadline based on its weight.
+   */
+  std::shared_ptr<C> pick() {
+    if (queue_.empty()) {
+      return nullptr;
+    }
+
+    EdfEntry entry = queue_.top();
+    queue_.pop();
+    current_time_ = entry.deadline_;
+    std::shared_ptr<C> picked = entry.entry_;
+    entry.deadline_ += 1.0 / entry.weight_;
+    queue_.push(std::move(entry));
+    return picked;
+  }
+
+  bool empty() const { return queue_.empty(); }
+
+private:
+  struct EdfEntry {
+    double deadline_;
+    double weight_;
+    // Insertion order tie breaker so that entries with equal deadlines are picked first in,
+    // first out, which keeps picking deterministic.
+    uint64_t order_offset_;
+    std::shared_ptr<C> entry_;
+
+    bool operator>(const EdfEntry& other) const {
+      return deadline_ > other.deadline_ ||
+             (deadline_ == other.deadline_ && order_offset_ > other.order_offset_);
+    }
+  };
+
+  // Min heap on (deadline, insertion order).
+  std::priority_queue<EdfEntry, std::vector<EdfEntry>, std::greater<EdfEntry>> queue_;
+  double current_time_{};
+  uint64_t order_offset_{};
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -1,5 +1,9 @@
 #include "common/upstream/eds.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "envoy/common/exception.h"
 
 #include "common/config/metadata.h"
@@ -57,13 +61,31 @@ void EdsClusterImpl::onConfigUpdate(const ResourceVector& resources) {
     throw EnvoyException(fmt::format("Unexpected EDS cluster (expecting {}): {}", cluster_name_,
                                      cluster_load_assignment.cluster_name()));
   }
+  // Reuse the existing host object when an incoming endpoint matches a current host by address,
+  // so a steady state update does not reconstruct a host (and its stats) for every endpoint. Only
+  // genuinely new endpoints get new host objects, and an identical assignment falls through the
+  // diff below without raising a change notification.
+  std::unordered_map<std::string, HostSharedPtr> existing_hosts;
+  existing_hosts.reserve(hosts().size());
+  for (const HostSharedPtr& host : hosts()) {
+    existing_hosts[host->address()->asString()] = host;
+  }
+
   for (const auto& locality_lb_endpoint : cluster_load_assignment.endpoints()) {
     const std::string& zone = locality_lb_endpoint.locality().zone();
 
     for (const auto& lb_endpoint : locality_lb_endpoint.lb_endpoints()) {
-      new_hosts.emplace_back(new HostImpl(
-          info_, "", Network::Utility::fromProtoAddress(lb_endpoint.endpoint().address()),
-          lb_endpoint.metadata(), lb_endpoint.load_balancing_weight().value(), zone));
+      Network::Address::InstanceConstSharedPtr address =
+          Network::Utility::fromProtoAddress(lb_endpoint.endpoint().address());
+      auto existing_host = existing_hosts.find(address->asString());
+      if (existing_host != existing_hosts.end()) {
+        // Weight is the only endpoint property that is applied to an existing host in place.
+        existing_host->second->weight(lb_endpoint.load_balancing_weight().value());
+        new_hosts.emplace_back(existing_host->second);
+      } else {
+        new_hosts.emplace_back(new HostImpl(info_, "", address, lb_endpoint.metadata(),
+                                            lb_endpoint.load_balancing_weight().value(), zone));
+      }
     }
   }
 
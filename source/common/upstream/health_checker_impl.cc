@@ -1,8 +1,12 @@
 #include "common/upstream/health_checker_impl.h"
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "envoy/event/dispatcher.h"
@@ -14,6 +18,7 @@
 #include "common/buffer/buffer_impl.h"
 #include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
+#include "common/common/hash.h"
 #include "common/common/hex.h"
 #include "common/common/utility.h"
 #include "common/http/codec_client.h"
@@ -31,20 +36,32 @@ HealthCheckerSharedPtr HealthCheckerFactory::create(const envoy::api::v2::Health
                                                     Upstream::Cluster& cluster,
                                                     Runtime::Loader& runtime,
                                                     Runtime::RandomGenerator& random,
-                                                    Event::Dispatcher& dispatcher) {
+                                                    Event::Dispatcher& dispatcher,
+                                                    Event::Dispatcher* result_dispatcher) {
+  std::shared_ptr<HealthCheckerImplBase> health_checker;
   switch (hc_config.health_checker_case()) {
   case envoy::api::v2::HealthCheck::HealthCheckerCase::kHttpHealthCheck:
-    return std::make_shared<ProdHttpHealthCheckerImpl>(cluster, hc_config, dispatcher, runtime,
-                                                       random);
+    health_checker = std::make_shared<ProdHttpHealthCheckerImpl>(cluster, hc_config, dispatcher,
+                                                                 runtime, random);
+    break;
   case envoy::api::v2::HealthCheck::HealthCheckerCase::kTcpHealthCheck:
-    return std::make_shared<TcpHealthCheckerImpl>(cluster, hc_config, dispatcher, runtime, random);
+    health_checker =
+        std::make_shared<TcpHealthCheckerImpl>(cluster, hc_config, dispatcher, runtime, random);
+    break;
   case envoy::api::v2::HealthCheck::HealthCheckerCase::kRedisHealthCheck:
-    return std::make_shared<RedisHealthCheckerImpl>(cluster, hc_config, dispatcher, runtime, random,
-                                                    Redis::ConnPool::ClientFactoryImpl::instance_);
+    health_checker = std::make_shared<RedisHealthCheckerImpl>(
+        cluster, hc_config, dispatcher, runtime, random,
+        Redis::ConnPool::ClientFactoryImpl::instance_);
+    break;
   default:
     // TODO(htuch): This should be subsumed eventually by the constraint checking in #1308.
     throw EnvoyException("Health checker type not set");
   }
+
+  if (result_dispatcher != nullptr && result_dispatcher != &dispatcher) {
+    health_checker->setResultDispatcher(*result_dispatcher);
+  }
+  return health_checker;
 }
 
 const std::chrono::milliseconds HealthCheckerImplBase::NO_TRAFFIC_INTERVAL{60000};
@@ -120,6 +137,30 @@ void HealthCheckerImplBase::addHosts(const std::vector<HostSharedPtr>& hosts) {
 
 void HealthCheckerImplBase::onClusterMemberUpdate(const std::vector<HostSharedPtr>& hosts_added,
                                                   const std::vector<HostSharedPtr>& hosts_removed) {
+  if (result_dispatcher_ == nullptr) {
+    updateSessions(hosts_added, hosts_removed);
+    return;
+  }
+
+  // Member updates arrive on the main thread but the session map belongs to the health check
+  // dispatcher, so posting keeps all session mutation on one thread. Posts are processed in
+  // order, so additions and removals cannot be reordered relative to each other or to the
+  // initial host set from start(). The weak reference mirrors setUnhealthyCrossThread(): the
+  // cluster owns the only strong reference to the health checker and may destroy it before the
+  // posted callback runs.
+  std::weak_ptr<HealthCheckerImplBase> weak_this = shared_from_this();
+  std::vector<HostSharedPtr> added = hosts_added;
+  std::vector<HostSharedPtr> removed = hosts_removed;
+  dispatcher_.post([weak_this, added, removed]() -> void {
+    std::shared_ptr<HealthCheckerImplBase> shared_this = weak_this.lock();
+    if (shared_this != nullptr) {
+      shared_this->updateSessions(added, removed);
+    }
+  });
+}
+
+void HealthCheckerImplBase::updateSessions(const std::vector<HostSharedPtr>& hosts_added,
+                                           const std::vector<HostSharedPtr>& hosts_removed) {
   addHosts(hosts_added);
   for (const HostSharedPtr& host : hosts_removed) {
     auto session_iter = active_sessions_.find(host);
@@ -141,11 +182,84 @@ void HealthCheckerImplBase::runCallbacks(HostSharedPtr host, bool changed_state)
   // any HC happens against a host so just refresh the healthy stat here so that it is correct.
   refreshHealthyStat();
 
-  for (const HostStatusCb& cb : callbacks_) {
-    cb(host, changed_state);
+  if (result_dispatcher_ == nullptr) {
+    for (const HostStatusCb& cb : callbacks_) {
+      cb(host, changed_state);
+    }
+    return;
+  }
+
+  // Check completions happen on the health check dispatcher but the callbacks mutate cluster
+  // state that belongs to the main thread. Results are batched: only the first result since the
+  // last flush pays for a cross thread post, and a burst of completions (e.g. a large cluster
+  // with aligned check intervals) is delivered to the main thread as a single wakeup.
+  bool flush_needed;
+  {
+    std::lock_guard<std::mutex> guard(pending_results_lock_);
+    flush_needed = pending_results_.empty();
+    pending_results_.emplace_back(host, changed_state);
+  }
+  if (flush_needed) {
+    std::weak_ptr<HealthCheckerImplBase> weak_this = shared_from_this();
+    result_dispatcher_->post([weak_this]() -> void {
+      std::shared_ptr<HealthCheckerImplBase> shared_this = weak_this.lock();
+      if (shared_this != nullptr) {
+        shared_this->flushResults();
+      }
+    });
   }
 }
 
+void HealthCheckerImplBase::flushResults() {
+  std::vector<std::pair<HostSharedPtr, bool>> results;
+  {
+    std::lock_guard<std::mutex> guard(pending_results_lock_);
+    results.swap(pending_results_);
+  }
+
+  for (const std::pair<HostSharedPtr, bool>& result : results) {
+    for (const HostStatusCb& cb : callbacks_) {
+      cb(result.first, result.second);
+    }
+  }
+}
+
+void HealthCheckerImplBase::setResultDispatcher(Event::Dispatcher& dispatcher) {
+  ASSERT(active_sessions_.empty());
+  result_dispatcher_ = &dispatcher;
+}
+
+void HealthCheckerImplBase::shutdown() {
+  if (result_dispatcher_ == nullptr) {
+    active_sessions_.clear();
+    return;
+  }
+
+  // The cluster is going away: no further status callbacks may run against it. callbacks_ is
+  // only touched on the main thread in dedicated dispatcher mode, so a flush that is already in
+  // flight turns into a no-op.
+  callbacks_.clear();
+
+  // The sessions (and their timers and connections) belong to the health check dispatcher, so
+  // they must be torn down there, after any member updates that are already queued. The caller
+  // is about to destroy the cluster, and live sessions still dereference cluster_ (interval and
+  // stats lookups on every check), so the teardown must complete before this returns: block on
+  // the posted drain, the same way the SSL connection destructor waits for an offloaded
+  // handshake to finish.
+  std::mutex drain_lock;
+  std::condition_variable drained_event;
+  bool drained = false;
+  dispatcher_.post([this, &drain_lock, &drained_event, &drained]() -> void {
+    active_sessions_.clear();
+    std::unique_lock<std::mutex> lock(drain_lock);
+    drained = true;
+    drained_event.notify_one();
+  });
+
+  std::unique_lock<std::mutex> lock(drain_lock);
+  drained_event.wait(lock, [&drained]() -> bool { return drained; });
+}
+
 void HealthCheckerImplBase::HealthCheckHostMonitorImpl::setUnhealthy() {
   // This is called cross thread. The cluster/health checker might already be gone.
   std::shared_ptr<HealthCheckerImplBase> health_checker = health_checker_.lock();
@@ -178,7 +292,22 @@ void HealthCheckerImplBase::setUnhealthyCrossThread(const HostSharedPtr& host) {
   });
 }
 
-void HealthCheckerImplBase::start() { addHosts(cluster_.hosts()); }
+void HealthCheckerImplBase::start() {
+  if (result_dispatcher_ == nullptr) {
+    addHosts(cluster_.hosts());
+    return;
+  }
+
+  // Session setup (timers, connections) must happen on the dispatcher the checks run on.
+  std::weak_ptr<HealthCheckerImplBase> weak_this = shared_from_this();
+  std::vector<HostSharedPtr> hosts = cluster_.hosts();
+  dispatcher_.post([weak_this, hosts]() -> void {
+    std::shared_ptr<HealthCheckerImplBase> shared_this = weak_this.lock();
+    if (shared_this != nullptr) {
+      shared_this->addHosts(hosts);
+    }
+  });
+}
 
 HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
     HealthCheckerImplBase& parent, HostSharedPtr host)
@@ -191,6 +320,25 @@ HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
   }
 }
 
+void HealthCheckerImplBase::ActiveHealthCheckSession::start() {
+  // By default the first check happens immediately. If a spread window is configured, the first
+  // check is instead delayed by a stable hash of the host address modulo the window, so that a
+  // config reload or large member update does not produce a synchronized burst of health check
+  // connections across the cluster. The hash keeps each host at the same phase of the interval
+  // from reload to reload. Steady state checks stay spread out since each session re-arms its
+  // interval timer when its check completes.
+  const uint64_t spread_window_ms =
+      std::min<uint64_t>(parent_.runtime_.snapshot().getInteger("health_check.initial_spread_ms", 0),
+                         parent_.interval_.count());
+  if (spread_window_ms == 0) {
+    onIntervalBase();
+    return;
+  }
+
+  interval_timer_->enableTimer(std::chrono::milliseconds(
+      HashUtil::xxHash64(host_->address()->asString()) % spread_window_ms));
+}
+
 HealthCheckerImplBase::ActiveHealthCheckSession::~ActiveHealthCheckSession() {
   if (!host_->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
     parent_.decHealthy();
@@ -290,8 +438,24 @@ void HttpHealthCheckerImpl::HttpActiveHealthCheckSession::decodeHeaders(
     Http::HeaderMapPtr&& headers, bool end_stream) {
   ASSERT(!response_headers_);
   response_headers_ = std::move(headers);
+
+  // The verdict depends only on the response head, so it is latched here instead of when the
+  // response finishes. A slow or large body does not delay the result; the rest of the stream is
+  // discarded as it arrives purely to keep the connection reusable.
+  if (isHealthCheckSucceeded()) {
+    handleSuccess();
+  } else {
+    handleFailure(FailureType::Active);
+  }
+
   if (end_stream) {
     onResponseComplete();
+  } else if (shouldCloseConnection()) {
+    // There is no point in draining a body on a connection the server is going to close anyway.
+    // The close resets the in flight stream, which must be ignored.
+    expect_reset_ = true;
+    client_->close();
+    response_headers_.reset();
   }
 }
 
@@ -306,11 +470,21 @@ void HttpHealthCheckerImpl::HttpActiveHealthCheckSession::onEvent(Network::Conne
 }
 
 void HttpHealthCheckerImpl::HttpActiveHealthCheckSession::onInterval() {
+  if (response_headers_) {
+    // The previous response's body was still draining when this interval fired (the verdict was
+    // already delivered off the response head). Recycle the connection rather than starting a new
+    // request behind a stream that may never finish.
+    expect_reset_ = true;
+    client_->close();
+    response_headers_.reset();
+  }
+
   if (!client_) {
     Upstream::Host::CreateConnectionData conn = host_->createConnection(parent_.dispatcher_);
     client_.reset(parent_.createCodecClient(conn));
     client_->addConnectionCallbacks(connection_callback_impl_);
     expect_reset_ = false;
+    requests_on_connection_ = 0;
   }
 
   request_encoder_ = &client_->newStream(*this);
@@ -359,17 +533,21 @@ bool HttpHealthCheckerImpl::HttpActiveHealthCheckSession::isHealthCheckSucceeded
   return true;
 }
 
-void HttpHealthCheckerImpl::HttpActiveHealthCheckSession::onResponseComplete() {
-  if (isHealthCheckSucceeded()) {
-    handleSuccess();
-  } else {
-    handleFailure(FailureType::Active);
-  }
+bool HttpHealthCheckerImpl::HttpActiveHealthCheckSession::shouldCloseConnection() {
+  return response_headers_->Connection() &&
+         0 == StringUtil::caseInsensitiveCompare(
+                  response_headers_->Connection()->value().c_str(),
+                  Http::Headers::get().ConnectionValues.Close.c_str());
+}
 
-  if (response_headers_->Connection() &&
-      0 ==
-          StringUtil::caseInsensitiveCompare(response_headers_->Connection()->value().c_str(),
-                                             Http::Headers::get().ConnectionValues.Close.c_str())) {
+void HttpHealthCheckerImpl::HttpActiveHealthCheckSession::onResponseComplete() {
+  // The verdict was already delivered when the response head arrived; all that is left is to
+  // decide whether the connection can be reused. Long lived connections are periodically cycled
+  // when a runtime limit is configured so that checks eventually exercise a fresh connect.
+  requests_on_connection_++;
+  const uint64_t cycle_limit =
+      parent_.runtime_.snapshot().getInteger("health_check.requests_per_connection", 0);
+  if (shouldCloseConnection() || (cycle_limit != 0 && requests_on_connection_ >= cycle_limit)) {
     client_->close();
   }
 
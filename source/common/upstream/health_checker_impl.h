@@ -4,8 +4,10 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "envoy/event/timer.h"
@@ -37,13 +39,17 @@ public:
    * @param cluster supplies the owning cluster.
    * @param runtime supplies the runtime loader.
    * @param random supplies the random generator.
-   * @param dispatcher supplies the dispatcher.
+   * @param dispatcher supplies the dispatcher the health checks run on.
+   * @param result_dispatcher supplies the dispatcher host status callbacks are delivered to when
+   *        health checking runs on a dedicated dispatcher thread. nullptr (the default) runs
+   *        callbacks inline on dispatcher, which is the classic single threaded setup.
    * @return a health checker.
    */
   static HealthCheckerSharedPtr create(const envoy::api::v2::HealthCheck& hc_config,
                                        Upstream::Cluster& cluster, Runtime::Loader& runtime,
                                        Runtime::RandomGenerator& random,
-                                       Event::Dispatcher& dispatcher);
+                                       Event::Dispatcher& dispatcher,
+                                       Event::Dispatcher* result_dispatcher = nullptr);
 };
 
 /**
@@ -76,8 +82,18 @@ class HealthCheckerImplBase : public HealthChecker,
 public:
   // Upstream::HealthChecker
   void addHostCheckCompleteCb(HostStatusCb callback) override { callbacks_.push_back(callback); }
+  void shutdown() override;
   void start() override;
 
+  /**
+   * Route host status callbacks through another dispatcher. By default completed checks run
+   * their callbacks inline on the dispatcher the checker was constructed with. When health
+   * checking runs on a dedicated thread the cluster lives on the main dispatcher, so results
+   * are instead batched and posted there, and cluster member updates (which arrive on the main
+   * thread) are posted onto the health check dispatcher. Must be called before start().
+   */
+  void setResultDispatcher(Event::Dispatcher& dispatcher);
+
 protected:
   class ActiveHealthCheckSession {
   public:
@@ -85,7 +101,7 @@ protected:
 
     virtual ~ActiveHealthCheckSession();
     void setUnhealthy(FailureType type);
-    void start() { onIntervalBase(); }
+    void start();
 
   protected:
     ActiveHealthCheckSession(HealthCheckerImplBase& parent, HostSharedPtr host);
@@ -141,6 +157,7 @@ private:
 
   void addHosts(const std::vector<HostSharedPtr>& hosts);
   void decHealthy();
+  void flushResults();
   HealthCheckerStats generateStats(Stats::Scope& scope);
   void incHealthy();
   std::chrono::milliseconds interval() const;
@@ -149,6 +166,8 @@ private:
   void refreshHealthyStat();
   void runCallbacks(HostSharedPtr host, bool changed_state);
   void setUnhealthyCrossThread(const HostSharedPtr& host);
+  void updateSessions(const std::vector<HostSharedPtr>& hosts_added,
+                      const std::vector<HostSharedPtr>& hosts_removed);
 
   static const std::chrono::milliseconds NO_TRAFFIC_INTERVAL;
 
@@ -157,6 +176,13 @@ private:
   const std::chrono::milliseconds interval_jitter_;
   std::unordered_map<HostSharedPtr, ActiveHealthCheckSessionPtr> active_sessions_;
   uint64_t local_process_healthy_{};
+  // Non-null when health checking runs on its own dispatcher thread. dispatcher_ is then the
+  // health check dispatcher and result_dispatcher_ the main dispatcher. Completed checks are
+  // accumulated in pending_results_ (written on the health check thread, drained on the main
+  // thread) so that a burst of completions costs a single cross thread post.
+  Event::Dispatcher* result_dispatcher_{};
+  std::mutex pending_results_lock_;
+  std::vector<std::pair<HostSharedPtr, bool>> pending_results_;
 };
 
 /**
@@ -177,6 +203,7 @@ private:
 
     void onResponseComplete();
     bool isHealthCheckSucceeded();
+    bool shouldCloseConnection();
 
     // ActiveHealthCheckSession
     void onInterval() override;
@@ -216,6 +243,8 @@ private:
     Http::StreamEncoder* request_encoder_{};
     Http::HeaderMapPtr response_headers_;
     bool expect_reset_{};
+    // Number of checks performed on the current connection, for runtime configured cycling.
+    uint64_t requests_on_connection_{};
   };
 
   typedef std::unique_ptr<HttpActiveHealthCheckSession> HttpActiveHealthCheckSessionPtr;
@@ -22,6 +22,18 @@ LoadBalancerBase::LoadBalancerBase(const HostSet& host_set, const HostSet* local
                                    Runtime::RandomGenerator& random)
     : stats_(stats), runtime_(runtime), random_(random), host_set_(host_set),
       local_host_set_(local_host_set) {
+  host_set_.addMemberUpdateCb([this](const std::vector<HostSharedPtr>&,
+                                     const std::vector<HostSharedPtr>&) -> void {
+    // Host lists (and potentially weights) have changed, so any EDF schedules built from them
+    // are stale. They are rebuilt lazily on the next weighted pick.
+    edf_schedulers_.clear();
+
+    // Membership and health changes both funnel through this callback, so the panic decision
+    // can be made here once instead of rescanning health state on every pick.
+    global_panic_ = LoadBalancerUtility::isGlobalPanic(host_set_, runtime_);
+  });
+  global_panic_ = LoadBalancerUtility::isGlobalPanic(host_set_, runtime_);
+
   if (local_host_set_) {
     host_set_.addMemberUpdateCb(
         [this](const std::vector<HostSharedPtr>&, const std::vector<HostSharedPtr>&) -> void {
@@ -31,6 +43,7 @@ LoadBalancerBase::LoadBalancerBase(const HostSet& host_set, const HostSet* local
         [this](const std::vector<HostSharedPtr>&, const std::vector<HostSharedPtr>&) -> void {
           regenerateZoneRoutingStructures();
         });
+    regenerateZoneRoutingStructures();
   }
 }
 
@@ -43,6 +56,11 @@ LoadBalancerBase::~LoadBalancerBase() {
 void LoadBalancerBase::regenerateZoneRoutingStructures() {
   stats_.lb_recalculate_zone_structures_.inc();
 
+  // Both host sets funnel their updates through here, so the panic flags consulted on every pick
+  // can be refreshed at the same time as the zone routing table.
+  global_panic_ = LoadBalancerUtility::isGlobalPanic(host_set_, runtime_);
+  local_panic_ = LoadBalancerUtility::isGlobalPanic(*local_host_set_, runtime_);
+
   // Do not perform any calculations if we cannot perform zone routing based on non runtime params.
   if (earlyExitNonZoneRouting()) {
     zone_routing_state_ = ZoneRoutingState::NoZoneRouting;
@@ -67,41 +85,47 @@ void LoadBalancerBase::regenerateZoneRoutingStructures() {
 
   zone_routing_state_ = ZoneRoutingState::ZoneResidual;
 
-  // If we cannot route all requests to the same zone, calculate what percentage can be routed.
-  // For example, if local percentage is 20% and upstream is 10%
-  // we can route only 50% of requests directly.
-  local_percent_to_route_ = upstream_percentage[0] * 10000 / local_percentage[0];
-
-  // Local zone does not have additional capacity (we have already routed what we could).
-  // Now we need to figure out how much traffic we can route cross zone and to which exact zone
-  // we should route. Percentage of requests routed cross zone to a specific zone needed be
-  // proportional to the residual capacity upstream zone has.
+  // The full zone decision is compiled into a single table of cumulative thresholds scaled to
+  // [0, 10000] so that one random draw selects the zone at pick time.
   //
-  // residual_capacity contains capacity left in a given zone, we keep accumulating residual
-  // capacity to make search for sampled value easier.
-  // For example, if we have the following upstream and local percentage:
-  // local_percentage: 40000 40000 20000
-  // upstream_percentage: 25000 50000 25000
-  // Residual capacity would look like: 0 10000 5000. Now we need to sample proportionally to
-  // bucket sizes (residual capacity). For simplicity of finding where specific
-  // sampled value is, we accumulate values in residual capacity. This is what it will look like:
-  // residual_capacity: 0 10000 15000
-  // Now to find a zone to route (bucket) we could simply iterate over residual_capacity searching
-  // where sampled value is placed.
-  residual_capacity_.resize(num_zones);
-
-  // Local zone (index 0) does not have residual capacity as we have routed all we could.
-  residual_capacity_[0] = 0;
+  // Entry 0 is the percentage of requests that can still be routed directly to the local zone.
+  // For example, if local percentage is 20% and upstream is 10% we can route only 50% of
+  // requests directly.
+  zone_routing_thresholds_.resize(num_zones);
+  zone_routing_thresholds_[0] = upstream_percentage[0] * 10000 / local_percentage[0];
+
+  // The local zone does not have additional capacity (we have already routed what we could).
+  // The remaining requests are routed cross zone, proportionally to the residual capacity each
+  // upstream zone has (how much its percentage exceeds the local cluster's percentage there).
+  // Accumulate the residual capacities so each zone owns a contiguous bucket.
+  // For example, with:
+  // local_percentage: 4000 4000 2000
+  // upstream_percentage: 2500 5000 2500
+  // the residual capacity is 0 1000 500 and accumulates to 0 1000 1500.
+  uint64_t cumulative_residual = 0;
   for (size_t i = 1; i < num_zones; ++i) {
     // Only route to the zones that have additional capacity.
     if (upstream_percentage[i] > local_percentage[i]) {
-      residual_capacity_[i] =
-          residual_capacity_[i - 1] + upstream_percentage[i] - local_percentage[i];
-    } else {
-      // Zone with index "i" does not have residual capacity, but we keep accumulating previous
-      // values to make search easier on the next step.
-      residual_capacity_[i] = residual_capacity_[i - 1];
+      cumulative_residual += upstream_percentage[i] - local_percentage[i];
     }
+    zone_routing_thresholds_[i] = cumulative_residual;
+  }
+
+  // This is *extremely* unlikely but possible due to rounding errors when calculating
+  // zone percentages. Cross zone traffic then picks a uniformly random zone at pick time.
+  zone_residual_exhausted_ = cumulative_residual == 0;
+  if (zone_residual_exhausted_) {
+    return;
+  }
+
+  // Map the accumulated residual buckets onto the [direct threshold, 10000] remainder of the
+  // draw range. The last bucket closes exactly at 10000, so the pick time scan always
+  // terminates. Zones without residual capacity get empty buckets and are never selected.
+  const uint64_t direct_threshold = zone_routing_thresholds_[0];
+  const uint64_t cross_zone_range = 10000 - direct_threshold;
+  for (size_t i = 1; i < num_zones; ++i) {
+    zone_routing_thresholds_[i] =
+        direct_threshold + zone_routing_thresholds_[i] * cross_zone_range / cumulative_residual;
   }
 };
 
@@ -175,9 +199,10 @@ const std::vector<HostSharedPtr>& LoadBalancerBase::tryChooseLocalZoneHosts() {
 
   ASSERT(zone_routing_state_ == ZoneRoutingState::ZoneResidual);
 
-  // If we cannot route all requests to the same zone, we already calculated how much we can
-  // push to the local zone, check if we can push to local zone on current iteration.
-  if (random_.random() % 10000 < local_percent_to_route_) {
+  // A single draw against the precomputed cumulative thresholds decides both whether the request
+  // stays in the local zone and, if not, which zone receives the cross zone traffic.
+  const uint64_t draw = random_.random() % 10000;
+  if (draw < zone_routing_thresholds_[0]) {
     stats_.lb_zone_routing_sampled_.inc();
     return host_set_.healthyHostsPerZone()[0];
   }
@@ -185,21 +210,18 @@ const std::vector<HostSharedPtr>& LoadBalancerBase::tryChooseLocalZoneHosts() {
   // At this point we must route cross zone as we cannot route to the local zone.
   stats_.lb_zone_routing_cross_zone_.inc();
 
-  // This is *extremely* unlikely but possible due to rounding errors when calculating
-  // zone percentages. In this case just select random zone.
-  if (residual_capacity_[number_of_zones - 1] == 0) {
+  // Rounding errors can leave no residual capacity anywhere; in that case just select a random
+  // zone.
+  if (zone_residual_exhausted_) {
     stats_.lb_zone_no_capacity_left_.inc();
     return host_set_.healthyHostsPerZone()[random_.random() % number_of_zones];
   }
 
-  // Random sampling to select specific zone for cross zone traffic based on the additional
-  // capacity in zones.
-  uint64_t threshold = random_.random() % residual_capacity_[number_of_zones - 1];
-
   // This potentially can be optimized to be O(log(N)) where N is the number of zones.
   // Linear scan should be faster for smaller N, in most of the scenarios N will be small.
-  int i = 0;
-  while (threshold > residual_capacity_[i]) {
+  // The last threshold is exactly 10000, so the scan cannot run off the end.
+  size_t i = 1;
+  while (draw >= zone_routing_thresholds_[i]) {
     i++;
   }
 
@@ -209,7 +231,7 @@ const std::vector<HostSharedPtr>& LoadBalancerBase::tryChooseLocalZoneHosts() {
 const std::vector<HostSharedPtr>& LoadBalancerBase::hostsToUse() {
   ASSERT(host_set_.healthyHosts().size() <= host_set_.hosts().size());
 
-  if (LoadBalancerUtility::isGlobalPanic(host_set_, runtime_)) {
+  if (global_panic_) {
     stats_.lb_healthy_panic_.inc();
     return host_set_.hosts();
   }
@@ -218,11 +240,13 @@ const std::vector<HostSharedPtr>& LoadBalancerBase::hostsToUse() {
     return host_set_.healthyHosts();
   }
 
+  // The runtime kill switch stays on the pick path so flipping it takes effect immediately,
+  // without waiting for a membership update.
   if (!runtime_.snapshot().featureEnabled(RuntimeZoneEnabled, 100)) {
     return host_set_.healthyHosts();
   }
 
-  if (LoadBalancerUtility::isGlobalPanic(*local_host_set_, runtime_)) {
+  if (local_panic_) {
     stats_.lb_local_cluster_not_ok_.inc();
     return host_set_.healthyHosts();
   }
@@ -230,68 +254,65 @@ const std::vector<HostSharedPtr>& LoadBalancerBase::hostsToUse() {
   return tryChooseLocalZoneHosts();
 }
 
+EdfScheduler<const Host>&
+LoadBalancerBase::edfSchedulerForHosts(const std::vector<HostSharedPtr>& hosts) {
+  auto it = edf_schedulers_.find(&hosts);
+  if (it != edf_schedulers_.end()) {
+    return it->second;
+  }
+
+  EdfScheduler<const Host>& scheduler = edf_schedulers_[&hosts];
+  for (const HostSharedPtr& host : hosts) {
+    scheduler.add(host->weight(), host);
+  }
+
+  return scheduler;
+}
+
 HostConstSharedPtr RoundRobinLoadBalancer::chooseHost(const LoadBalancerContext*) {
   const std::vector<HostSharedPtr>& hosts_to_use = hostsToUse();
   if (hosts_to_use.empty()) {
     return nullptr;
   }
 
-  return hosts_to_use[rr_index_++ % hosts_to_use.size()];
-}
+  // The EDF schedule is only engaged when host weights actually differ; with uniform weights the
+  // plain modulo walk below gives the same result without the heap.
+  if (stats_.max_host_weight_.value() != 1 &&
+      runtime_.snapshot().getInteger("upstream.weight_enabled", 1UL) != 0) {
+    return edfSchedulerForHosts(hosts_to_use).pick();
+  }
 
-LeastRequestLoadBalancer::LeastRequestLoadBalancer(const HostSet& host_set,
-                                                   const HostSet* local_host_set,
-                                                   ClusterStats& stats, Runtime::Loader& runtime,
-                                                   Runtime::RandomGenerator& random)
-    : LoadBalancerBase(host_set, local_host_set, stats, runtime, random) {
-  host_set.addMemberUpdateCb([this](const std::vector<HostSharedPtr>&,
-                                    const std::vector<HostSharedPtr>& hosts_removed) -> void {
-    if (last_host_) {
-      for (const HostSharedPtr& host : hosts_removed) {
-        if (host == last_host_) {
-          hits_left_ = 0;
-          last_host_.reset();
-
-          break;
-        }
-      }
-    }
-  });
+  return hosts_to_use[rr_index_++ % hosts_to_use.size()];
 }
 
 HostConstSharedPtr LeastRequestLoadBalancer::chooseHost(const LoadBalancerContext*) {
-  bool is_weight_imbalanced = stats_.max_host_weight_.value() != 1;
-  bool is_weight_enabled = runtime_.snapshot().getInteger("upstream.weight_enabled", 1UL) != 0;
-
-  if (is_weight_imbalanced && hits_left_ > 0 && is_weight_enabled) {
-    --hits_left_;
-
-    return last_host_;
-  } else {
-    // To avoid hit stale last_host_ when all hosts become weight balanced.
-    hits_left_ = 0;
-    last_host_.reset();
-  }
-
   const std::vector<HostSharedPtr>& hosts_to_use = hostsToUse();
   if (hosts_to_use.empty()) {
     return nullptr;
   }
 
-  // Make weighed random if we have hosts with non 1 weights.
-  if (is_weight_imbalanced & is_weight_enabled) {
-    last_host_ = hosts_to_use[random_.random() % hosts_to_use.size()];
-    hits_left_ = last_host_->weight() - 1;
+  // With non 1 weights, pick hosts in proportion to their weight via the EDF schedule.
+  if (stats_.max_host_weight_.value() != 1 &&
+      runtime_.snapshot().getInteger("upstream.weight_enabled", 1UL) != 0) {
+    return edfSchedulerForHosts(hosts_to_use).pick();
+  }
 
-    return last_host_;
+  if (hosts_to_use.size() == 1) {
+    return hosts_to_use[0];
+  }
+
+  // Power of two choices: sample two distinct hosts and pick the one with fewer active requests.
+  const uint64_t first = random_.random() % hosts_to_use.size();
+  uint64_t second = random_.random() % (hosts_to_use.size() - 1);
+  if (second >= first) {
+    second++;
+  }
+
+  if (hosts_to_use[first]->stats().rq_active_.value() <
+      hosts_to_use[second]->stats().rq_active_.value()) {
+    return hosts_to_use[first];
   } else {
-    HostSharedPtr host1 = hosts_to_use[random_.random() % hosts_to_use.size()];
-    HostSharedPtr host2 = hosts_to_use[random_.random() % hosts_to_use.size()];
-    if (host1->stats().rq_active_.value() < host2->stats().rq_active_.value()) {
-      return host1;
-    } else {
-      return host2;
-    }
+    return hosts_to_use[second];
   }
 }
 
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/load_balancer.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/upstream/edf_scheduler.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -37,6 +40,12 @@ protected:
    */
   const std::vector<HostSharedPtr>& hostsToUse();
 
+  /**
+   * @return the EDF schedule for the given host list, building it on first use. Schedules pick
+   * hosts in proportion to their weight in O(log n) and are invalidated on membership updates.
+   */
+  EdfScheduler<const Host>& edfSchedulerForHosts(const std::vector<HostSharedPtr>& hosts);
+
   ClusterStats& stats_;
   Runtime::Loader& runtime_;
   Runtime::RandomGenerator& random_;
@@ -70,21 +79,38 @@ private:
 
   const HostSet& host_set_;
   const HostSet* local_host_set_;
-  uint64_t local_percent_to_route_{};
   ZoneRoutingState zone_routing_state_{ZoneRoutingState::NoZoneRouting};
-  std::vector<uint64_t> residual_capacity_;
+  // Cumulative zone selection thresholds scaled to [0, 10000], rebuilt on every membership
+  // update. Entry 0 is the share of requests routed directly to the local zone; entry i > 0
+  // closes the cross zone bucket for zone i. A single random draw compared against these
+  // thresholds selects the zone with no per pick arithmetic beyond the comparisons.
+  std::vector<uint64_t> zone_routing_thresholds_;
+  // True if rounding left no residual capacity in any zone; cross zone traffic then falls back
+  // to a uniformly random zone.
+  bool zone_residual_exhausted_{};
+  // Panic state only changes when membership or health state changes, both of which arrive
+  // through the member update callbacks, so it is computed there instead of on every pick.
+  bool global_panic_{};
+  bool local_panic_{};
   Common::CallbackHandle* local_host_set_member_update_cb_handle_{};
+  // EDF schedules keyed by the host list they were built from. hostsToUse() can return different
+  // lists from call to call (all hosts, healthy hosts, per zone hosts), so each list gets its own
+  // schedule. The map is cleared on every membership update since the lists are rebuilt then.
+  std::unordered_map<const std::vector<HostSharedPtr>*, EdfScheduler<const Host>> edf_schedulers_;
 };
 
 /**
  * Implementation of LoadBalancer that performs RR selection across the hosts in the cluster.
+ * When hosts carry different weights, selection switches to an earliest deadline first (EDF)
+ * scheduler that picks hosts in proportion to their weight in O(log n) time with no per request
+ * allocation. Schedules are invalidated by membership updates and rebuilt on the next pick.
  */
 class RoundRobinLoadBalancer : public LoadBalancer, LoadBalancerBase {
 public:
-  RoundRobinLoadBalancer(const HostSet& host_set, const HostSet* local_host_set_,
+  RoundRobinLoadBalancer(const HostSet& host_set, const HostSet* local_host_set,
                          ClusterStats& stats, Runtime::Loader& runtime,
                          Runtime::RandomGenerator& random)
-      : LoadBalancerBase(host_set, local_host_set_, stats, runtime, random) {}
+      : LoadBalancerBase(host_set, local_host_set, stats, runtime, random) {}
 
   // Upstream::LoadBalancer
   HostConstSharedPtr chooseHost(const LoadBalancerContext* context) override;
@@ -96,28 +122,25 @@ private:
 /**
  * Weighted Least Request load balancer.
  *
- * In a normal setup when all hosts have the same weight of 1 it randomly picks up two healthy hosts
- * and compares number of active requests.
- * Technique is based on http://www.eecs.harvard.edu/~michaelm/postscripts/mythesis.pdf
+ * When all hosts have the same weight of 1 it uses power of two choices: sample two distinct
+ * healthy hosts at random and pick the one with fewer active requests. This is O(1) regardless of
+ * cluster size and is based on
+ * http://www.eecs.harvard.edu/~michaelm/postscripts/mythesis.pdf
  *
- * When any of the hosts have non 1 weight, apply random weighted balancing.
- * Randomly pickup the host and send 'weight' number of requests to it.
- * This technique is acceptable for load testing but
- * will not work well in situations where requests take a long time.
- * In that case a different algorithm using a full scan will be required.
+ * When any of the hosts have a non 1 weight, hosts are picked with the same weight proportional
+ * EDF schedule used by round robin. Active request counts are ignored in that mode, but unlike
+ * the previous sticky "send weight requests to a random host" behavior the schedule never sends a
+ * burst of consecutive requests to one host.
  */
 class LeastRequestLoadBalancer : public LoadBalancer, LoadBalancerBase {
 public:
-  LeastRequestLoadBalancer(const HostSet& host_set, const HostSet* local_host_set_,
+  LeastRequestLoadBalancer(const HostSet& host_set, const HostSet* local_host_set,
                            ClusterStats& stats, Runtime::Loader& runtime,
-                           Runtime::RandomGenerator& random);
+                           Runtime::RandomGenerator& random)
+      : LoadBalancerBase(host_set, local_host_set, stats, runtime, random) {}
 
   // Upstream::LoadBalancer
   HostConstSharedPtr chooseHost(const LoadBalancerContext* context) override;
-
-private:
-  HostSharedPtr last_host_;
-  uint32_t hits_left_{};
 };
 
 /**
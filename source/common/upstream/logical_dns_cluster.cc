@@ -7,6 +7,7 @@
 
 #include "common/config/utility.h"
 #include "common/network/address_impl.h"
+#include "common/network/happy_eyeballs_connection_impl.h"
 #include "common/network/utility.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
@@ -16,6 +17,23 @@
 namespace Envoy {
 namespace Upstream {
 
+namespace {
+
+bool sameAddressList(const std::vector<Network::Address::InstanceConstSharedPtr>& lhs,
+                     const std::vector<Network::Address::InstanceConstSharedPtr>& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (!(*lhs[i] == *rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
 LogicalDnsCluster::LogicalDnsCluster(const envoy::api::v2::Cluster& cluster,
                                      Runtime::Loader& runtime, Stats::Store& stats,
                                      Ssl::ContextManager& ssl_context_manager,
@@ -84,14 +102,18 @@ void LogicalDnsCluster::startResolve() {
         if (!address_list.empty()) {
           // TODO(mattklein123): Move port handling into the DNS interface.
           ASSERT(address_list.front() != nullptr);
-          Network::Address::InstanceConstSharedPtr new_address =
-              Network::Utility::getAddressWithPort(*address_list.front(),
-                                                   Network::Utility::portFromTcpUrl(dns_url_));
-          if (!current_resolved_address_ || !(*new_address == *current_resolved_address_)) {
-            current_resolved_address_ = new_address;
-            // Capture URL to avoid a race with another update.
-            tls_->runOnAllThreads([this, new_address]() -> void {
-              tls_->getTyped<PerThreadCurrentHostData>().current_resolved_address_ = new_address;
+          const uint32_t port = Network::Utility::portFromTcpUrl(dns_url_);
+          std::vector<Network::Address::InstanceConstSharedPtr> new_address_list;
+          new_address_list.reserve(address_list.size());
+          for (const Network::Address::InstanceConstSharedPtr& dns_address : address_list) {
+            new_address_list.emplace_back(Network::Utility::getAddressWithPort(*dns_address, port));
+          }
+          if (!sameAddressList(new_address_list, current_resolved_address_list_)) {
+            current_resolved_address_list_ = new_address_list;
+            // Capture the list to avoid a race with another update.
+            tls_->runOnAllThreads([this, new_address_list]() -> void {
+              tls_->getTyped<PerThreadCurrentHostData>().current_resolved_address_list_ =
+                  new_address_list;
             });
           }
 
@@ -130,10 +152,27 @@ void LogicalDnsCluster::startResolve() {
 Upstream::Host::CreateConnectionData
 LogicalDnsCluster::LogicalHost::createConnection(Event::Dispatcher& dispatcher) const {
   PerThreadCurrentHostData& data = parent_.tls_->getTyped<PerThreadCurrentHostData>();
-  ASSERT(data.current_resolved_address_);
-  return {HostImpl::createConnection(dispatcher, *parent_.info_, data.current_resolved_address_),
-          HostDescriptionConstSharedPtr{
-              new RealHostDescription(data.current_resolved_address_, shared_from_this())}};
+  ASSERT(!data.current_resolved_address_list_.empty());
+
+  Network::ClientConnectionPtr connection;
+  if (data.current_resolved_address_list_.size() == 1) {
+    connection = HostImpl::createConnection(dispatcher, *parent_.info_,
+                                            data.current_resolved_address_list_[0]);
+  } else {
+    // Race staggered connection attempts across all of the resolved addresses; the caller only
+    // ever sees the winning connection.
+    ClusterInfoConstSharedPtr info = parent_.info_;
+    connection.reset(new Network::HappyEyeballsConnectionImpl(
+        dispatcher, data.current_resolved_address_list_,
+        [&dispatcher, info](Network::Address::InstanceConstSharedPtr address)
+            -> Network::ClientConnectionPtr {
+          return HostImpl::createConnection(dispatcher, *info, address);
+        }));
+  }
+
+  return {std::move(connection),
+          HostDescriptionConstSharedPtr{new RealHostDescription(
+              data.current_resolved_address_list_[0], shared_from_this())}};
 }
 
 } // namespace Upstream
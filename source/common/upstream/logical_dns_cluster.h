@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "envoy/thread_local/thread_local.h"
 
@@ -15,10 +16,12 @@ namespace Upstream {
 
 /**
  * The LogicalDnsCluster is a type of cluster that creates a single logical host that wraps
- * an async DNS resolver. The DNS resolver will continuously resolve, and swap in the first IP
- * address in the resolution set. However the logical owning host will not change. Any created
- * connections against this host will use the currently resolved IP. This means that a connection
- * pool using the logical host may end up with connections to many different real IPs.
+ * an async DNS resolver. The DNS resolver will continuously resolve, and swap in the current
+ * resolution set. However the logical owning host will not change. Any created connections
+ * against this host will use the currently resolved IPs: when the resolution set holds more than
+ * one address, connection attempts are raced across the addresses happy-eyeballs style and the
+ * first one to connect wins. This means that a connection pool using the logical host may end up
+ * with connections to many different real IPs.
  *
  * This cluster type is useful for large web services that use DNS in a round robin fashion, such
  * that DNS resolution may repeatedly return different results. A single connection pool can be
@@ -86,7 +89,7 @@ private:
   };
 
   struct PerThreadCurrentHostData : public ThreadLocal::ThreadLocalObject {
-    Network::Address::InstanceConstSharedPtr current_resolved_address_;
+    std::vector<Network::Address::InstanceConstSharedPtr> current_resolved_address_list_;
   };
 
   void startResolve();
@@ -101,7 +104,7 @@ private:
   Event::TimerPtr resolve_timer_;
   std::string dns_url_;
   std::string hostname_;
-  Network::Address::InstanceConstSharedPtr current_resolved_address_;
+  std::vector<Network::Address::InstanceConstSharedPtr> current_resolved_address_list_;
   HostSharedPtr logical_host_;
   Network::ActiveDnsQuery* active_dns_query_{};
 };
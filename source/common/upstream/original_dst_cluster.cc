@@ -99,31 +99,56 @@ OriginalDstCluster::OriginalDstCluster(const envoy::api::v2::Cluster& config,
                       added_via_api),
       dispatcher_(dispatcher), cleanup_interval_ms_(std::chrono::milliseconds(
                                    PROTOBUF_GET_MS_OR_DEFAULT(config, cleanup_interval, 5000))),
-      cleanup_timer_(dispatcher.createTimer([this]() -> void { cleanup(); })) {
+      cleanup_timer_(dispatcher.createTimer([this]() -> void { cleanup(); })),
+      pending_publish_timer_(
+          dispatcher.createTimer([this]() -> void { publishPendingHosts(); })) {
 
   cleanup_timer_->enableTimer(cleanup_interval_ms_);
 }
 
 void OriginalDstCluster::addHost(HostSharedPtr& host) {
+  pending_hosts_to_add_.emplace_back(std::move(host));
+  // Coalesce however many hosts the workers post before the dispatcher runs the timer; the
+  // publication in publishPendingHosts() then copies the host list once for the whole batch.
+  pending_publish_timer_->enableTimer(std::chrono::milliseconds(0));
+}
+
+void OriginalDstCluster::publishPendingHosts() {
+  if (pending_hosts_to_add_.empty()) {
+    return;
+  }
+
   HostVectorSharedPtr new_hosts(new std::vector<HostSharedPtr>(hosts()));
-  new_hosts->emplace_back(host);
+  new_hosts->reserve(new_hosts->size() + pending_hosts_to_add_.size());
+  new_hosts->insert(new_hosts->end(), pending_hosts_to_add_.begin(), pending_hosts_to_add_.end());
+
+  std::vector<HostSharedPtr> hosts_added;
+  hosts_added.swap(pending_hosts_to_add_);
   updateHosts(new_hosts, createHealthyHostList(*new_hosts), empty_host_lists_, empty_host_lists_,
-              {std::move(host)}, {});
+              hosts_added, {});
 }
 
 void OriginalDstCluster::cleanup() {
-  HostVectorSharedPtr new_hosts(new std::vector<HostSharedPtr>);
-  std::vector<HostSharedPtr> to_be_removed;
   const auto& host_set = hosts();
 
   ENVOY_LOG(debug, "Cleaning up stale original dst hosts.");
-  for (const HostSharedPtr& host : host_set) {
+  HostVectorSharedPtr new_hosts;
+  std::vector<HostSharedPtr> to_be_removed;
+  for (size_t i = 0; i < host_set.size(); i++) {
+    const HostSharedPtr& host = host_set[i];
     if (host->used()) {
       ENVOY_LOG(debug, "Keeping active host {}.", host->address()->asString());
-      new_hosts->emplace_back(host);
       host->used(false); // Mark to be removed during the next round.
+      if (new_hosts) {
+        new_hosts->emplace_back(host);
+      }
     } else {
       ENVOY_LOG(debug, "Removing stale host {}.", host->address()->asString());
+      if (!new_hosts) {
+        // First stale host: copy the prefix that is being kept. A sweep that finds nothing stale
+        // never copies the host list at all.
+        new_hosts.reset(new std::vector<HostSharedPtr>(host_set.begin(), host_set.begin() + i));
+      }
       to_be_removed.emplace_back(host);
     }
   }
@@ -101,11 +101,17 @@ public:
 
 private:
   void addHost(HostSharedPtr&);
+  void publishPendingHosts();
   void cleanup();
 
   Event::Dispatcher& dispatcher_;
   const std::chrono::milliseconds cleanup_interval_ms_;
   Event::TimerPtr cleanup_timer_;
+  // Hosts created by the workers since the last publication. Publication copies the host list, so
+  // it is coalesced via pending_publish_timer_: a burst of new destinations costs one copy rather
+  // than one per host. The creating worker serves the host from its local map in the meantime.
+  std::vector<HostSharedPtr> pending_hosts_to_add_;
+  Event::TimerPtr pending_publish_timer_;
 };
 
 } // namespace Upstream
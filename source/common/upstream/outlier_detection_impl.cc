@@ -1,5 +1,6 @@
 #include "common/upstream/outlier_detection_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <memory>
@@ -141,7 +142,13 @@ void DetectorImpl::initialize(const Cluster& cluster) {
 
 void DetectorImpl::addHostMonitor(HostSharedPtr host) {
   ASSERT(host_monitors_.count(host) == 0);
-  DetectorHostMonitorImpl* monitor = new DetectorHostMonitorImpl(shared_from_this(), host);
+  // The default window of a single bucket (one detection interval) matches the historical
+  // behavior. Raising it makes success rate a sliding window over multiple intervals so that
+  // slowly degrading hosts that never trip the consecutive 5xx counter still get caught.
+  DetectorHostMonitorImpl* monitor = new DetectorHostMonitorImpl(
+      shared_from_this(), host,
+      std::max<uint64_t>(1, runtime_.snapshot().getInteger(
+                                "outlier_detection.success_rate_window_buckets", 1)));
   host_monitors_[host] = monitor;
   host->setOutlierDetector(DetectorHostMonitorPtr{monitor});
 }
@@ -365,8 +372,96 @@ void DetectorImpl::runCallbacks(HostSharedPtr host) {
   }
 }
 
+EventLoggerImpl::~EventLoggerImpl() {
+  if (format_thread_) {
+    {
+      std::unique_lock<std::mutex> lock(queue_lock_);
+      shutdown_ = true;
+    }
+    queue_event_.notify_one();
+    // The formatting thread drains whatever is still queued before exiting.
+    format_thread_->join();
+  }
+}
+
 void EventLoggerImpl::logEject(HostDescriptionConstSharedPtr host, Detector& detector,
                                EjectionType type, bool enforced) {
+  // Everything the log line needs is captured here, where the host and detector can be safely
+  // read. The JSON formatting and the write happen on the formatting thread.
+  Event event;
+  event.eject_ = true;
+  event.type_ = type;
+  event.enforced_ = enforced;
+  event.time_ = time_source_.currentTime();
+  event.secs_since_last_action_ = secsSinceLastAction(host->outlierDetector().lastUnejectionTime(),
+                                                      monotonic_time_source_.currentTime());
+  event.cluster_ = host->cluster().name();
+  event.upstream_url_ = host->address()->asString();
+  event.num_ejections_ = host->outlierDetector().numEjections();
+  if (type == EjectionType::SuccessRate) {
+    event.host_success_rate_ = host->outlierDetector().successRate();
+    event.cluster_average_success_rate_ = detector.successRateAverage();
+    event.cluster_success_rate_ejection_threshold_ = detector.successRateEjectionThreshold();
+  }
+
+  enqueue(std::move(event));
+}
+
+void EventLoggerImpl::logUneject(HostDescriptionConstSharedPtr host) {
+  Event event;
+  event.eject_ = false;
+  event.type_ = EjectionType::Consecutive5xx; // Unused for unejections.
+  event.time_ = time_source_.currentTime();
+  event.secs_since_last_action_ = secsSinceLastAction(host->outlierDetector().lastEjectionTime(),
+                                                      monotonic_time_source_.currentTime());
+  event.cluster_ = host->cluster().name();
+  event.upstream_url_ = host->address()->asString();
+  event.num_ejections_ = host->outlierDetector().numEjections();
+
+  enqueue(std::move(event));
+}
+
+void EventLoggerImpl::enqueue(Event&& event) {
+  // Like the access log flush threads, the formatting thread is not started until there is
+  // something to log.
+  if (!format_thread_) {
+    format_thread_.reset(new Thread::Thread([this]() -> void { formatThreadFunc(); }));
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(queue_lock_);
+    if (queue_.size() >= MAX_QUEUED_EVENTS) {
+      // Detection matters more than its log; shedding here keeps an ejection storm from growing
+      // the queue without bound when the log cannot keep up.
+      dropped_events_++;
+      return;
+    }
+    queue_.emplace_back(std::move(event));
+  }
+  queue_event_.notify_one();
+}
+
+void EventLoggerImpl::formatThreadFunc() {
+  while (true) {
+    std::list<Event> events;
+    {
+      std::unique_lock<std::mutex> lock(queue_lock_);
+      while (queue_.empty() && !shutdown_) {
+        queue_event_.wait(lock);
+      }
+      if (queue_.empty() && shutdown_) {
+        return;
+      }
+      events.swap(queue_);
+    }
+
+    for (const Event& event : events) {
+      file_->write(formatEvent(event));
+    }
+  }
+}
+
+std::string EventLoggerImpl::formatEvent(const Event& event) {
   // TODO(mattklein123): Log friendly host name (e.g., instance ID or DNS name).
   // clang-format off
   static const std::string json_5xx =
@@ -395,33 +490,8 @@ void EventLoggerImpl::logEject(HostDescriptionConstSharedPtr host, Detector& det
     "\"cluster_average_success_rate\": \"{}\", " +
     "\"cluster_success_rate_ejection_threshold\": \"{}\"" +
     "}}\n";
-  // clang-format on
-  SystemTime now = time_source_.currentTime();
-  MonotonicTime monotonic_now = monotonic_time_source_.currentTime();
 
-  switch (type) {
-  case EjectionType::Consecutive5xx:
-    file_->write(fmt::format(
-        json_5xx, AccessLogDateTimeFormatter::fromTime(now),
-        secsSinceLastAction(host->outlierDetector().lastUnejectionTime(), monotonic_now),
-        host->cluster().name(), host->address()->asString(), typeToString(type),
-        host->outlierDetector().numEjections(), enforced));
-    break;
-  case EjectionType::SuccessRate:
-    file_->write(fmt::format(
-        json_success_rate, AccessLogDateTimeFormatter::fromTime(now),
-        secsSinceLastAction(host->outlierDetector().lastUnejectionTime(), monotonic_now),
-        host->cluster().name(), host->address()->asString(), typeToString(type),
-        host->outlierDetector().numEjections(), enforced, host->outlierDetector().successRate(),
-        detector.successRateAverage(), detector.successRateEjectionThreshold()));
-    break;
-  }
-}
-
-void EventLoggerImpl::logUneject(HostDescriptionConstSharedPtr host) {
-  // TODO(mattklein123): Log friendly host name (e.g., instance ID or DNS name).
-  // clang-format off
-  static const std::string json =
+  static const std::string json_uneject =
     std::string("{{") +
     "\"time\": \"{}\", " +
     "\"secs_since_last_action\": \"{}\", " +
@@ -431,12 +501,27 @@ void EventLoggerImpl::logUneject(HostDescriptionConstSharedPtr host) {
     "\"num_ejections\": {}" +
     "}}\n";
   // clang-format on
-  SystemTime now = time_source_.currentTime();
-  MonotonicTime monotonic_now = monotonic_time_source_.currentTime();
-  file_->write(fmt::format(
-      json, AccessLogDateTimeFormatter::fromTime(now),
-      secsSinceLastAction(host->outlierDetector().lastEjectionTime(), monotonic_now),
-      host->cluster().name(), host->address()->asString(), host->outlierDetector().numEjections()));
+
+  if (!event.eject_) {
+    return fmt::format(json_uneject, AccessLogDateTimeFormatter::fromTime(event.time_),
+                       event.secs_since_last_action_, event.cluster_, event.upstream_url_,
+                       event.num_ejections_);
+  }
+
+  switch (event.type_) {
+  case EjectionType::Consecutive5xx:
+    return fmt::format(json_5xx, AccessLogDateTimeFormatter::fromTime(event.time_),
+                       event.secs_since_last_action_, event.cluster_, event.upstream_url_,
+                       typeToString(event.type_), event.num_ejections_, event.enforced_);
+  case EjectionType::SuccessRate:
+    return fmt::format(json_success_rate, AccessLogDateTimeFormatter::fromTime(event.time_),
+                       event.secs_since_last_action_, event.cluster_, event.upstream_url_,
+                       typeToString(event.type_), event.num_ejections_, event.enforced_,
+                       event.host_success_rate_, event.cluster_average_success_rate_,
+                       event.cluster_success_rate_ejection_threshold_);
+  }
+
+  NOT_REACHED;
 }
 
 std::string EventLoggerImpl::typeToString(EjectionType type) {
@@ -459,22 +544,33 @@ int EventLoggerImpl::secsSinceLastAction(const Optional<MonotonicTime>& lastActi
 }
 
 SuccessRateAccumulatorBucket* SuccessRateAccumulator::updateCurrentWriter() {
-  // Right now current is being written to and backup is not. Flush the backup and swap.
-  backup_success_rate_bucket_->success_request_counter_ = 0;
-  backup_success_rate_bucket_->total_request_counter_ = 0;
-
-  current_success_rate_bucket_.swap(backup_success_rate_bucket_);
-
-  return current_success_rate_bucket_.get();
+  // Advance the writer to the oldest bucket in the ring and flush it. This drops that bucket's
+  // data out of the window; the bucket that was just written to becomes readable along with the
+  // rest of the ring.
+  current_bucket_ = (current_bucket_ + 1) % buckets_.size();
+  buckets_[current_bucket_]->success_request_counter_ = 0;
+  buckets_[current_bucket_]->total_request_counter_ = 0;
+
+  return buckets_[current_bucket_].get();
 }
 
 Optional<double> SuccessRateAccumulator::getSuccessRate(uint64_t success_rate_request_volume) {
-  if (backup_success_rate_bucket_->total_request_counter_ < success_rate_request_volume) {
+  uint64_t success_request_counter = 0;
+  uint64_t total_request_counter = 0;
+  for (uint64_t i = 0; i < buckets_.size(); i++) {
+    if (i == current_bucket_) {
+      continue;
+    }
+
+    success_request_counter += buckets_[i]->success_request_counter_;
+    total_request_counter += buckets_[i]->total_request_counter_;
+  }
+
+  if (total_request_counter < success_rate_request_volume) {
     return Optional<double>();
   }
 
-  return Optional<double>(backup_success_rate_bucket_->success_request_counter_ * 100.0 /
-                          backup_success_rate_bucket_->total_request_counter_);
+  return Optional<double>(success_request_counter * 100.0 / total_request_counter);
 }
 
 } // namespace Outlier
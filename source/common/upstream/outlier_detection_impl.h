@@ -2,9 +2,11 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -15,6 +17,8 @@
 #include "envoy/upstream/outlier_detection.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/thread.h"
+
 #include "api/cds.pb.h"
 
 namespace Envoy {
@@ -65,15 +69,20 @@ struct SuccessRateAccumulatorBucket {
 };
 
 /**
- * The SuccessRateAccumulator uses the SuccessRateAccumulatorBucket to get per host success rate
- * stats. This implementation has a fixed window size of time, and thus only needs a
- * bucket to write to, and a bucket to accumulate/run stats over.
+ * The SuccessRateAccumulator uses SuccessRateAccumulatorBuckets to get per host success rate
+ * stats. The buckets form a ring: one bucket is written to by the workers, and the others hold
+ * the data for previous detection intervals. On each interval the writer advances to the oldest
+ * bucket and flushes it, so success rate is computed over a sliding window of the last
+ * window_buckets intervals.
  */
 class SuccessRateAccumulator {
 public:
-  SuccessRateAccumulator()
-      : current_success_rate_bucket_(new SuccessRateAccumulatorBucket()),
-        backup_success_rate_bucket_(new SuccessRateAccumulatorBucket()) {}
+  SuccessRateAccumulator(uint64_t window_buckets) {
+    buckets_.reserve(window_buckets + 1);
+    for (uint64_t i = 0; i < window_buckets + 1; i++) {
+      buckets_.emplace_back(new SuccessRateAccumulatorBucket());
+    }
+  }
 
   /**
    * This function updates the bucket to write data to.
@@ -81,9 +90,9 @@ public:
    */
   SuccessRateAccumulatorBucket* updateCurrentWriter();
   /**
-   * This function returns the success rate of a host over a window of time if the request volume is
-   * high enough. The underlying window of time could be dynamically adjusted. In the current
-   * implementation it is a fixed time window.
+   * This function returns the success rate of a host over the accumulator's window of time if the
+   * request volume is high enough. The window covers every bucket except the one currently being
+   * written to.
    * @param success_rate_request_volume the threshold of requests an accumulator has to have in
    *                                    order to be able to return a significant success rate value.
    * @return a valid Optional<double> with the success rate. If there were not enough requests, an
@@ -92,8 +101,8 @@ public:
   Optional<double> getSuccessRate(uint64_t success_rate_request_volume);
 
 private:
-  std::unique_ptr<SuccessRateAccumulatorBucket> current_success_rate_bucket_;
-  std::unique_ptr<SuccessRateAccumulatorBucket> backup_success_rate_bucket_;
+  std::vector<std::unique_ptr<SuccessRateAccumulatorBucket>> buckets_;
+  uint64_t current_bucket_{};
 };
 
 class DetectorImpl;
@@ -103,8 +112,10 @@ class DetectorImpl;
  */
 class DetectorHostMonitorImpl : public DetectorHostMonitor {
 public:
-  DetectorHostMonitorImpl(std::shared_ptr<DetectorImpl> detector, HostSharedPtr host)
-      : detector_(detector), host_(host), success_rate_(-1) {
+  DetectorHostMonitorImpl(std::shared_ptr<DetectorImpl> detector, HostSharedPtr host,
+                          uint64_t success_rate_window_buckets)
+      : detector_(detector), host_(host),
+        success_rate_accumulator_(success_rate_window_buckets), success_rate_(-1) {
     // Point the success_rate_accumulator_bucket_ pointer to a bucket.
     updateCurrentSuccessRateBucket();
   }
@@ -242,6 +253,7 @@ public:
                   SystemTimeSource& time_source, MonotonicTimeSource& monotonic_time_source)
       : file_(log_manager.createAccessLog(file_name)), time_source_(time_source),
         monotonic_time_source_(monotonic_time_source) {}
+  ~EventLoggerImpl();
 
   // Upstream::Outlier::EventLogger
   void logEject(HostDescriptionConstSharedPtr host, Detector& detector, EjectionType type,
@@ -249,12 +261,46 @@ public:
   void logUneject(HostDescriptionConstSharedPtr host) override;
 
 private:
+  /**
+   * Snapshot of everything a log line needs. Events are captured inline where the host and
+   * detector can be safely read, while the JSON formatting and the write happen on the event
+   * logger's own thread, so an ejection storm does not stall detection processing behind
+   * formatting throughput. The queue is bounded; events beyond the bound are dropped.
+   */
+  struct Event {
+    EjectionType type_;
+    bool eject_;
+    bool enforced_{};
+    SystemTime time_;
+    int secs_since_last_action_;
+    std::string cluster_;
+    std::string upstream_url_;
+    uint32_t num_ejections_;
+    double host_success_rate_{};
+    double cluster_average_success_rate_{};
+    double cluster_success_rate_ejection_threshold_{};
+  };
+
+  void enqueue(Event&& event);
+  void formatThreadFunc();
+  std::string formatEvent(const Event& event);
   std::string typeToString(EjectionType type);
   int secsSinceLastAction(const Optional<MonotonicTime>& lastActionTime, MonotonicTime now);
 
+  // Bound on queued events. An ejection storm beyond this drops log lines rather than growing
+  // the queue without limit.
+  static const size_t MAX_QUEUED_EVENTS = 1024;
+
   Filesystem::FileSharedPtr file_;
   SystemTimeSource& time_source_;
   MonotonicTimeSource& monotonic_time_source_;
+  std::mutex queue_lock_;
+  std::condition_variable queue_event_;
+  std::list<Event> queue_;
+  bool shutdown_{};
+  uint64_t dropped_events_{};
+  // Created on the first event, like the access log flush threads.
+  Thread::ThreadPtr format_thread_;
 };
 
 /**
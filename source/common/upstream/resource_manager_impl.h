@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -9,6 +12,7 @@
 #include "envoy/upstream/resource_manager.h"
 
 #include "common/common/assert.h"
+#include "common/common/macros.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -29,14 +33,18 @@ public:
                       uint64_t max_requests, uint64_t max_retries)
       : connections_(max_connections, runtime, runtime_key + "max_connections"),
         pending_requests_(max_pending_requests, runtime, runtime_key + "max_pending_requests"),
-        requests_(max_requests, runtime, runtime_key + "max_requests"),
-        retries_(max_retries, runtime, runtime_key + "max_retries") {}
+        requests_(max_requests, runtime, runtime_key),
+        retries_(max_retries, runtime, runtime_key + "max_retries",
+                 runtime_key + "retry_budget_percent", requests_, pending_requests_) {}
 
   // Upstream::ResourceManager
   Resource& connections() override { return connections_; }
   Resource& pendingRequests() override { return pending_requests_; }
   Resource& requests() override { return requests_; }
   Resource& retries() override { return retries_; }
+  void recordResponseTime(std::chrono::milliseconds response_time) override {
+    requests_.recordResponseTime(response_time);
+  }
 
 private:
   struct ResourceImpl : public Resource {
@@ -45,24 +53,146 @@ private:
     ~ResourceImpl() { ASSERT(current_ == 0); }
 
     // Upstream::Resource
-    bool canCreate() override { return current_ < max(); }
-    void inc() override { current_++; }
+    //
+    // All operations on current_ use relaxed ordering: the counter only gates admission and no
+    // other data is published through it, so there is nothing for a stronger ordering (or a
+    // fence) to synchronize. Overshoot under contention is already accepted per the class
+    // comment above.
+    bool canCreate() override { return current_.load(std::memory_order_relaxed) < max(); }
+    void inc() override { current_.fetch_add(1, std::memory_order_relaxed); }
     void dec() override {
-      ASSERT(current_ > 0);
-      current_--;
+      const uint64_t previous = current_.fetch_sub(1, std::memory_order_relaxed);
+      ASSERT(previous > 0);
+      UNREFERENCED_PARAMETER(previous);
     }
     uint64_t max() override { return runtime_.snapshot().getInteger(runtime_key_, max_); }
 
     const uint64_t max_;
+    // Every worker hits these counters on each circuit breaker check, and the resources for a
+    // cluster live in adjacent structs, so keep each counter on its own cache line. Padding on
+    // both sides is used instead of alignas() because these objects are heap allocated and C++11
+    // allocation does not honor over-aligned types.
+    char padding_before_current_[64];
     std::atomic<uint64_t> current_{};
+    char padding_after_current_[64];
     Runtime::Loader& runtime_;
     const std::string runtime_key_;
   };
 
+  /**
+   * The request resource can optionally adapt its limit to measured upstream latency instead of
+   * trusting the configured maximum. When the <runtime_key>adaptive_concurrency_enabled runtime
+   * key is non-zero, sampled response times (recorded by the router) are averaged over fixed size
+   * windows and compared against the best window seen: inflated latency shrinks the effective
+   * limit toward the measured inflection point (gradient), while latency at baseline lets the
+   * limit grow back toward the configured maximum by a square root headroom term per window. The
+   * baseline is re-anchored periodically so a legitimately slower upstream does not pin the limit
+   * at the floor forever. As with the rest of this file the accounting is loose: samples recorded
+   * concurrently with a window swap may land in either window.
+   */
+  struct AdaptiveRequestResourceImpl : public ResourceImpl {
+    AdaptiveRequestResourceImpl(uint64_t max, Runtime::Loader& runtime,
+                                const std::string& runtime_key)
+        : ResourceImpl(max, runtime, runtime_key + "max_requests"),
+          enabled_runtime_key_(runtime_key + "adaptive_concurrency_enabled"), limit_(max) {}
+
+    // Upstream::Resource
+    uint64_t max() override {
+      const uint64_t configured_max = ResourceImpl::max();
+      if (runtime_.snapshot().getInteger(enabled_runtime_key_, 0) == 0) {
+        return configured_max;
+      }
+      return std::min(limit_.load(std::memory_order_relaxed), configured_max);
+    }
+
+    void recordResponseTime(std::chrono::milliseconds response_time) {
+      // Number of samples averaged per recalculation.
+      const uint64_t sample_window = 10;
+      // Number of windows after which the baseline is re-anchored to the current window.
+      const uint64_t min_rtt_age_windows = 100;
+      // Floor for the adaptive limit so the cluster always makes enough progress to observe
+      // recovery.
+      const uint64_t min_concurrency_limit = 3;
+
+      sample_sum_ms_.fetch_add(response_time.count(), std::memory_order_relaxed);
+      if (sample_count_.fetch_add(1, std::memory_order_relaxed) + 1 < sample_window) {
+        return;
+      }
+
+      // The caller that completes a window recalculates the limit.
+      sample_count_.store(0, std::memory_order_relaxed);
+      const uint64_t window_avg_ms =
+          std::max<uint64_t>(sample_sum_ms_.exchange(0, std::memory_order_relaxed) / sample_window,
+                             1); // Sub-millisecond averages are treated as 1ms.
+
+      uint64_t min_rtt_ms = min_rtt_ms_.load(std::memory_order_relaxed);
+      if (min_rtt_ms == 0 || window_avg_ms < min_rtt_ms ||
+          windows_since_min_reset_.fetch_add(1, std::memory_order_relaxed) + 1 >=
+              min_rtt_age_windows) {
+        windows_since_min_reset_.store(0, std::memory_order_relaxed);
+        min_rtt_ms_.store(window_avg_ms, std::memory_order_relaxed);
+        min_rtt_ms = window_avg_ms;
+      }
+
+      // The gradient compares this window against the best seen. It is floored so a single awful
+      // window cannot collapse the limit to nothing, and capped at 1 so growth comes only from
+      // the headroom term below.
+      const double gradient =
+          std::min(1.0, std::max(0.5, static_cast<double>(min_rtt_ms) / window_avg_ms));
+      const uint64_t current_limit = limit_.load(std::memory_order_relaxed);
+      const uint64_t new_limit = std::max<uint64_t>(
+          static_cast<uint64_t>(current_limit * gradient + std::sqrt(current_limit)),
+          min_concurrency_limit);
+      limit_.store(new_limit, std::memory_order_relaxed);
+    }
+
+    const std::string enabled_runtime_key_;
+    std::atomic<uint64_t> limit_;
+    std::atomic<uint64_t> sample_count_{};
+    std::atomic<uint64_t> sample_sum_ms_{};
+    std::atomic<uint64_t> min_rtt_ms_{};
+    std::atomic<uint64_t> windows_since_min_reset_{};
+  };
+
+  /**
+   * The retry resource can optionally be governed by a retry budget instead of a fixed maximum.
+   * When the budget runtime key is set to a non-zero percentage, the maximum number of concurrent
+   * retries is that percentage of the currently active (pending + outstanding) requests, with a
+   * small floor so that retries are not starved when the cluster is mostly idle. This bounds
+   * retry amplification during brownouts: as upstream capacity drops and active requests drain,
+   * the retry allowance shrinks with them.
+   */
+  struct RetryBudgetResourceImpl : public ResourceImpl {
+    RetryBudgetResourceImpl(uint64_t max, Runtime::Loader& runtime, const std::string& runtime_key,
+                            const std::string& budget_runtime_key, const ResourceImpl& requests,
+                            const ResourceImpl& pending_requests)
+        : ResourceImpl(max, runtime, runtime_key), budget_runtime_key_(budget_runtime_key),
+          requests_(requests), pending_requests_(pending_requests) {}
+
+    // Upstream::Resource
+    uint64_t max() override {
+      const uint64_t budget_percent = runtime_.snapshot().getInteger(budget_runtime_key_, 0);
+      if (budget_percent == 0) {
+        return ResourceImpl::max();
+      }
+
+      // Keep a handful of retries available even when there is little active traffic, so that a
+      // budget does not completely disable retries for low volume clusters.
+      const uint64_t min_retry_concurrency = 3;
+      const uint64_t active_requests = requests_.current_.load(std::memory_order_relaxed) +
+                                       pending_requests_.current_.load(std::memory_order_relaxed);
+      return std::max<uint64_t>(active_requests * budget_percent / 100, min_retry_concurrency);
+    }
+
+    const std::string budget_runtime_key_;
+    const ResourceImpl& requests_;
+    const ResourceImpl& pending_requests_;
+  };
+
   ResourceImpl connections_;
   ResourceImpl pending_requests_;
-  ResourceImpl requests_;
-  ResourceImpl retries_;
+  AdaptiveRequestResourceImpl requests_;
+  RetryBudgetResourceImpl retries_;
 };
 
 typedef std::unique_ptr<ResourceManagerImpl> ResourceManagerImplPtr;
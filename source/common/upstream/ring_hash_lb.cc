@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "common/common/assert.h"
+#include "common/common/hash.h"
 #include "common/upstream/load_balancer_impl.h"
 
 namespace Envoy {
@@ -23,9 +24,11 @@ RingHashLoadBalancer::RingHashLoadBalancer(HostSet& host_set, ClusterStats& stat
 HostConstSharedPtr RingHashLoadBalancer::chooseHost(const LoadBalancerContext* context) {
   if (LoadBalancerUtility::isGlobalPanic(host_set_, runtime_)) {
     stats_.lb_healthy_panic_.inc();
-    return all_hosts_ring_.chooseHost(context, random_);
+    return use_maglev_ ? all_hosts_maglev_.chooseHost(context, random_)
+                       : all_hosts_ring_.chooseHost(context, random_);
   } else {
-    return healthy_hosts_ring_.chooseHost(context, random_);
+    return use_maglev_ ? healthy_hosts_maglev_.chooseHost(context, random_)
+                       : healthy_hosts_ring_.chooseHost(context, random_);
   }
 }
 
@@ -104,12 +107,21 @@ void RingHashLoadBalancer::Ring::create(Runtime::Loader& runtime,
 
   ENVOY_LOG(trace, "ring hash: min_ring_size={} hashes_per_host={}", min_ring_size,
             hashes_per_host);
+
+  // Switching the hash function moves every host's positions on the ring, so remapping existing
+  // traffic is a deliberate operational step: flip the runtime key when the remap is acceptable.
+  // xxHash64 is both better distributed and much faster to compute than the libstdc++
+  // byte-at-a-time std::hash, which shows up in profiles when rebuilding rings for large clusters.
+  // TODO(danielhochman): default this to xxHash64 once deployments have migrated.
+  const bool use_std_hash =
+      runtime.snapshot().getInteger("upstream.ring_hash.use_std_hash", 1) != 0;
+
   ring_.reserve(hosts.size() * hashes_per_host);
   for (const auto& host : hosts) {
     for (uint64_t i = 0; i < hashes_per_host; i++) {
       std::string hash_key(host->address()->asString() + "_" + std::to_string(i));
-      // TODO(danielhochman): convert to HashUtil::xxHash64 when we have a migration strategy.
-      uint64_t hash = std::hash<std::string>()(hash_key);
+      uint64_t hash = use_std_hash ? std::hash<std::string>()(hash_key)
+                                   : HashUtil::xxHash64(hash_key);
       ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key, hash);
       ring_.push_back({hash, host});
     }
@@ -125,9 +137,78 @@ void RingHashLoadBalancer::Ring::create(Runtime::Loader& runtime,
 #endif
 }
 
+HostConstSharedPtr RingHashLoadBalancer::MaglevTable::chooseHost(const LoadBalancerContext* context,
+                                                                 Runtime::RandomGenerator& random) {
+  if (table_.empty()) {
+    return nullptr;
+  }
+
+  // As with the ring, fall back to a random pick if the context carries no hash.
+  Optional<uint64_t> hash;
+  if (context) {
+    hash = context->hashKey();
+  }
+  const uint64_t h = hash.valid() ? hash.value() : random.random();
+  return table_[h % TableSize];
+}
+
+void RingHashLoadBalancer::MaglevTable::create(const std::vector<HostSharedPtr>& hosts) {
+  ENVOY_LOG(trace, "maglev: building table");
+  table_.clear();
+  if (hosts.empty()) {
+    return;
+  }
+
+  // Each host walks its own permutation of the table slots, defined by a starting offset and a
+  // skip derived from two independent hashes of the host's address. Since TableSize is prime,
+  // any skip in [1, TableSize) visits every slot exactly once.
+  struct Permutation {
+    HostConstSharedPtr host_;
+    uint64_t offset_;
+    uint64_t skip_;
+    uint64_t next_;
+  };
+  std::vector<Permutation> permutations;
+  permutations.reserve(hosts.size());
+  for (const auto& host : hosts) {
+    const std::string& address = host->address()->asString();
+    // Unlike the ring, the table has no legacy placements to preserve (it is opt-in via the
+    // use_maglev runtime key), so it uses xxHash64 unconditionally.
+    const uint64_t offset = HashUtil::xxHash64(address) % TableSize;
+    const uint64_t skip = HashUtil::xxHash64(address + "_skip") % (TableSize - 1) + 1;
+    ENVOY_LOG(trace, "maglev: host={} offset={} skip={}", address, offset, skip);
+    permutations.push_back({host, offset, skip, 0});
+  }
+
+  // Hosts take turns claiming the next unclaimed slot of their permutation until the table is
+  // full. This fills the table within one slot of evenly.
+  table_.resize(TableSize);
+  uint64_t filled = 0;
+  while (true) {
+    for (Permutation& permutation : permutations) {
+      uint64_t slot = (permutation.offset_ + permutation.next_ * permutation.skip_) % TableSize;
+      while (table_[slot] != nullptr) {
+        permutation.next_++;
+        slot = (permutation.offset_ + permutation.next_ * permutation.skip_) % TableSize;
+      }
+      table_[slot] = permutation.host_;
+      permutation.next_++;
+      if (++filled == TableSize) {
+        return;
+      }
+    }
+  }
+}
+
 void RingHashLoadBalancer::refresh() {
-  all_hosts_ring_.create(runtime_, host_set_.hosts());
-  healthy_hosts_ring_.create(runtime_, host_set_.healthyHosts());
+  use_maglev_ = runtime_.snapshot().getInteger("upstream.ring_hash.use_maglev", 0) != 0;
+  if (use_maglev_) {
+    all_hosts_maglev_.create(host_set_.hosts());
+    healthy_hosts_maglev_.create(host_set_.healthyHosts());
+  } else {
+    all_hosts_ring_.create(runtime_, host_set_.hosts());
+    healthy_hosts_ring_.create(runtime_, host_set_.healthyHosts());
+  }
 }
 
 } // namespace Upstream
@@ -15,6 +15,12 @@ namespace Upstream {
  * A load balancer that implements consistent modulo hashing ("ketama"). Currently, zone aware
  * routing is not supported. A ring is kept for all hosts as well as a ring for healthy hosts.
  * Unless we are in panic mode, the healthy host ring is used.
+ *
+ * Optionally (see the upstream.ring_hash.use_maglev runtime key), a Maglev style fixed size
+ * lookup table is built instead of the ring. This makes picks O(1) instead of O(log n) and
+ * rebuilds O(table size) regardless of ring replication factor, at the cost of slightly less
+ * stable hashing when membership changes.
+ *
  * In the future it would be nice to support:
  * 1) Weighting.
  * 2) Per-zone rings and optional zone aware routing (not all applications will want this).
@@ -42,14 +48,33 @@ private:
     std::vector<RingEntry> ring_;
   };
 
+  /**
+   * Maglev style lookup table (https://research.google.com/pubs/pub44824.html section 3.4).
+   * Every host claims slots of the table by walking its own permutation of the slot indices
+   * until the table is full, which fills the table nearly evenly and keeps most slots assigned
+   * to the same host across rebuilds.
+   */
+  struct MaglevTable {
+    HostConstSharedPtr chooseHost(const LoadBalancerContext* context,
+                                  Runtime::RandomGenerator& random);
+    void create(const std::vector<HostSharedPtr>& hosts);
+
+    // The table size must be prime so that any skip in [1, TableSize) visits every slot.
+    static const uint64_t TableSize = 65537;
+    std::vector<HostConstSharedPtr> table_;
+  };
+
   void refresh();
 
   HostSet& host_set_;
   ClusterStats& stats_;
   Runtime::Loader& runtime_;
   Runtime::RandomGenerator& random_;
+  bool use_maglev_{};
   Ring all_hosts_ring_;
   Ring healthy_hosts_ring_;
+  MaglevTable all_hosts_maglev_;
+  MaglevTable healthy_hosts_maglev_;
 };
 
 } // namespace Upstream
@@ -0,0 +1,166 @@
+#include "common/upstream/subset_lb.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/empty_string.h"
+#include "common/config/metadata.h"
+#include "common/config/well_known_names.h"
+#include "common/protobuf/utility.h"
+#include "common/upstream/load_balancer_impl.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+void appendSubsetKeyEntry(std::string& key, const std::string& name,
+                          const ProtobufWkt::Value& value) {
+  // Values are serialized deterministically and length prefixed, so equal values always produce
+  // the same key and distinct values cannot alias.
+  const std::string serialized = MessageUtil::deterministicSerialization(value);
+  key.append(name);
+  key.push_back('\0');
+  key.append(std::to_string(serialized.size()));
+  key.push_back(':');
+  key.append(serialized);
+}
+
+} // namespace
+
+SubsetLoadBalancer::SubsetLoadBalancer(LoadBalancerType lb_type, const HostSet& host_set,
+                                       const HostSet* local_host_set, ClusterStats& stats,
+                                       Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+                                       const std::vector<std::string>& subset_keys)
+    : lb_type_(lb_type), host_set_(host_set), stats_(stats), runtime_(runtime), random_(random),
+      subset_keys_([&subset_keys]() -> std::vector<std::string> {
+        std::vector<std::string> sorted_keys(subset_keys);
+        std::sort(sorted_keys.begin(), sorted_keys.end());
+        return sorted_keys;
+      }()),
+      fallback_lb_(createLoadBalancer(host_set, local_host_set)) {
+  refreshSubsets();
+  member_update_cb_handle_ = host_set.addMemberUpdateCb(
+      [this](const std::vector<HostSharedPtr>&, const std::vector<HostSharedPtr>&)
+          -> void { refreshSubsets(); });
+}
+
+SubsetLoadBalancer::~SubsetLoadBalancer() { member_update_cb_handle_->remove(); }
+
+HostConstSharedPtr SubsetLoadBalancer::chooseHost(const LoadBalancerContext* context) {
+  if (context != nullptr && context->metadataMatchCriteria() != nullptr) {
+    const std::string key = subsetKey(*context->metadataMatchCriteria());
+    if (!key.empty()) {
+      auto subset = subsets_.find(key);
+      if (subset != subsets_.end()) {
+        return subset->second->lb_->chooseHost(context);
+      }
+    }
+  }
+
+  return fallback_lb_->chooseHost(context);
+}
+
+LoadBalancerPtr SubsetLoadBalancer::createLoadBalancer(const HostSet& host_set,
+                                                       const HostSet* local_host_set) {
+  switch (lb_type_) {
+  case LoadBalancerType::RoundRobin:
+    return LoadBalancerPtr{
+        new RoundRobinLoadBalancer(host_set, local_host_set, stats_, runtime_, random_)};
+  case LoadBalancerType::LeastRequest:
+    return LoadBalancerPtr{
+        new LeastRequestLoadBalancer(host_set, local_host_set, stats_, runtime_, random_)};
+  case LoadBalancerType::Random:
+    return LoadBalancerPtr{
+        new RandomLoadBalancer(host_set, local_host_set, stats_, runtime_, random_)};
+  case LoadBalancerType::RingHash:
+  case LoadBalancerType::OriginalDst:
+    // Neither ring hash nor original dst clusters support subset load balancing.
+    break;
+  }
+
+  NOT_REACHED;
+}
+
+void SubsetLoadBalancer::refreshSubsets() {
+  // Group the current hosts by subset key. Hosts that do not carry values for every subset key
+  // only participate in the fallback balancer.
+  std::unordered_map<std::string, std::vector<HostSharedPtr>> hosts_by_subset;
+  for (const HostSharedPtr& host : host_set_.hosts()) {
+    const std::string key = subsetKeyForHost(host);
+    if (!key.empty()) {
+      hosts_by_subset[key].push_back(host);
+    }
+  }
+
+  // Drop subsets that no longer have any hosts.
+  for (auto subset = subsets_.begin(); subset != subsets_.end();) {
+    if (hosts_by_subset.count(subset->first) == 0) {
+      subset = subsets_.erase(subset);
+    } else {
+      ++subset;
+    }
+  }
+
+  for (auto& entry : hosts_by_subset) {
+    SubsetPtr& subset = subsets_[entry.first];
+    if (subset == nullptr) {
+      // The inner balancer tracks the subset's host set through the normal member update
+      // callbacks, so updateHosts() below refreshes its structures.
+      subset.reset(new Subset());
+      subset->lb_ = createLoadBalancer(subset->host_set_, nullptr);
+    }
+
+    HostVectorSharedPtr hosts(new std::vector<HostSharedPtr>(std::move(entry.second)));
+    HostVectorSharedPtr healthy_hosts(new std::vector<HostSharedPtr>());
+    healthy_hosts->reserve(hosts->size());
+    for (const HostSharedPtr& host : *hosts) {
+      if (host->healthy()) {
+        healthy_hosts->push_back(host);
+      }
+    }
+
+    subset->host_set_.updateHosts(
+        hosts, healthy_hosts,
+        HostListsConstSharedPtr{new std::vector<std::vector<HostSharedPtr>>()},
+        HostListsConstSharedPtr{new std::vector<std::vector<HostSharedPtr>>()}, {}, {});
+  }
+}
+
+std::string SubsetLoadBalancer::subsetKeyForHost(const HostSharedPtr& host) {
+  std::string key;
+  for (const std::string& subset_key : subset_keys_) {
+    const ProtobufWkt::Value& value = Config::Metadata::metadataValue(
+        host->metadata(), Config::MetadataFilters::get().ENVOY_LB, subset_key);
+    if (value.kind_case() == ProtobufWkt::Value::KIND_NOT_SET) {
+      return EMPTY_STRING;
+    }
+
+    appendSubsetKeyEntry(key, subset_key, value);
+  }
+
+  return key;
+}
+
+std::string SubsetLoadBalancer::subsetKey(const SubsetMetadataCriteria& criteria) {
+  if (criteria.size() != subset_keys_.size()) {
+    return EMPTY_STRING;
+  }
+
+  std::string key;
+  for (uint64_t i = 0; i < criteria.size(); i++) {
+    // The criteria must cover exactly the configured subset keys; anything else falls back.
+    if (criteria[i].first != subset_keys_[i]) {
+      return EMPTY_STRING;
+    }
+
+    appendSubsetKeyEntry(key, criteria[i].first, criteria[i].second);
+  }
+
+  return key;
+}
+
+} // namespace Upstream
+} // namespace Envoy
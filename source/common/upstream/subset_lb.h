@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/runtime/runtime.h"
+#include "envoy/upstream/load_balancer.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/upstream/upstream_impl.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Load balancer that partitions a cluster's hosts into subsets keyed on host metadata and
+ * delegates host selection to a per subset load balancer. Subsets are precomputed on membership
+ * update, so a pick is a single hash lookup plus the inner load balancer's selection; hosts are
+ * never filtered per request. Requests that carry no metadata match criteria, or whose criteria
+ * do not correspond to a precomputed subset, fall back to balancing across all hosts.
+ *
+ * A host belongs to a subset only if its "envoy.lb" filter metadata has a value for every
+ * configured subset key. Zone aware routing applies to the fallback balancer only; subsets are
+ * typically too small for the zone math to be meaningful.
+ */
+class SubsetLoadBalancer : public LoadBalancer {
+public:
+  SubsetLoadBalancer(LoadBalancerType lb_type, const HostSet& host_set,
+                     const HostSet* local_host_set, ClusterStats& stats, Runtime::Loader& runtime,
+                     Runtime::RandomGenerator& random, const std::vector<std::string>& subset_keys);
+  ~SubsetLoadBalancer();
+
+  // Upstream::LoadBalancer
+  HostConstSharedPtr chooseHost(const LoadBalancerContext* context) override;
+
+private:
+  struct Subset {
+    HostSetImpl host_set_;
+    LoadBalancerPtr lb_;
+  };
+  typedef std::unique_ptr<Subset> SubsetPtr;
+
+  LoadBalancerPtr createLoadBalancer(const HostSet& host_set, const HostSet* local_host_set);
+  void refreshSubsets();
+
+  /**
+   * @return the subset lookup key for a host, or an empty string if the host is missing a value
+   *         for any of the subset keys.
+   */
+  std::string subsetKeyForHost(const HostSharedPtr& host);
+
+  /**
+   * @return the subset lookup key for a request's match criteria. The criteria must be sorted by
+   *         key, matching the order subset keys are configured in.
+   */
+  std::string subsetKey(const SubsetMetadataCriteria& criteria);
+
+  const LoadBalancerType lb_type_;
+  const HostSet& host_set_;
+  ClusterStats& stats_;
+  Runtime::Loader& runtime_;
+  Runtime::RandomGenerator& random_;
+  const std::vector<std::string> subset_keys_;
+  LoadBalancerPtr fallback_lb_;
+  std::unordered_map<std::string, SubsetPtr> subsets_;
+  Common::CallbackHandle* member_update_cb_handle_{};
+};
+
+} // namespace Upstream
+} // namespace Envoy
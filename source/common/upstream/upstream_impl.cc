@@ -5,6 +5,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -14,6 +15,7 @@
 #include "envoy/ssl/context.h"
 #include "envoy/upstream/health_checker.h"
 
+#include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/utility.h"
 #include "common/config/protocol_json.h"
@@ -82,7 +84,8 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
       stats_scope_(stats.createScope(fmt::format("cluster.{}.", name_))),
-      stats_(generateStats(*stats_scope_)), features_(parseFeatures(config)),
+      stats_(generateStats(*stats_scope_)),
+      response_code_stat_family_(*stats_scope_, EMPTY_STRING), features_(parseFeatures(config)),
       http2_settings_(Http::Utility::parseHttp2Settings(config.http2_protocol_options())),
       resource_managers_(config, runtime, name_),
       maintenance_mode_runtime_key_(fmt::format("upstream.maintenance_mode.{}", name_)),
@@ -129,7 +132,8 @@ ClusterSharedPtr ClusterImplBase::create(const envoy::api::v2::Cluster& cluster,
                                          Event::Dispatcher& dispatcher,
                                          const LocalInfo::LocalInfo& local_info,
                                          Outlier::EventLoggerSharedPtr outlier_event_logger,
-                                         bool added_via_api) {
+                                         bool added_via_api,
+                                         Event::Dispatcher* health_check_dispatcher) {
   std::unique_ptr<ClusterImplBase> new_cluster;
 
   // We make this a shared pointer to deal with the distinct ownership
@@ -189,7 +193,9 @@ ClusterSharedPtr ClusterImplBase::create(const envoy::api::v2::Cluster& cluster,
     // TODO(htuch): Need to support multiple health checks in v2.
     ASSERT(cluster.health_checks().size() == 1);
     new_cluster->setHealthChecker(HealthCheckerFactory::create(
-        cluster.health_checks()[0], *new_cluster, runtime, random, dispatcher));
+        cluster.health_checks()[0], *new_cluster, runtime, random,
+        health_check_dispatcher != nullptr ? *health_check_dispatcher : dispatcher,
+        health_check_dispatcher != nullptr ? &dispatcher : nullptr));
   }
 
   new_cluster->setOutlierDetector(Outlier::DetectorImplFactory::createForCluster(
@@ -204,6 +210,15 @@ ClusterImplBase::ClusterImplBase(const envoy::api::v2::Cluster& cluster,
     : runtime_(runtime), info_(new ClusterInfoImpl(cluster, source_address, runtime, stats,
                                                    ssl_context_manager, added_via_api)) {}
 
+ClusterImplBase::~ClusterImplBase() {
+  // The health checker may be running its sessions on a dedicated dispatcher thread; shutdown()
+  // blocks until they have been drained there, since sessions read through the cluster reference
+  // that becomes invalid once this destructor completes.
+  if (health_checker_) {
+    health_checker_->shutdown();
+  }
+}
+
 HostVectorConstSharedPtr
 ClusterImplBase::createHealthyHostList(const std::vector<HostSharedPtr>& hosts) {
   HostVectorSharedPtr healthy_list(new std::vector<HostSharedPtr>());
@@ -352,37 +367,37 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const std::vector<HostSharedP
   uint64_t max_host_weight = 1;
 
   // Go through and see if the list we have is different from what we just got. If it is, we
-  // make a new host list and raise a change notification. This uses an N^2 search given that
-  // this does not happen very often and the list sizes should be small. We also check for
-  // duplicates here. It's possible for DNS to return the same address multiple times, and a bad
-  // SDS implementation could do the same thing.
+  // make a new host list and raise a change notification. Hosts are matched by address through an
+  // index built over the current list, so large dynamic clusters do not pay a quadratic scan on
+  // every update. We also check for duplicates here. It's possible for DNS to return the same
+  // address multiple times, and a bad EDS/SDS implementation could do the same thing.
+  std::unordered_map<std::string, HostSharedPtr> existing_hosts_by_address;
+  existing_hosts_by_address.reserve(current_hosts.size());
+  for (const HostSharedPtr& host : current_hosts) {
+    existing_hosts_by_address[host->address()->asString()] = host;
+  }
+
   std::unordered_set<std::string> host_addresses;
   std::vector<HostSharedPtr> final_hosts;
   for (const HostSharedPtr& host : new_hosts) {
-    if (host_addresses.count(host->address()->asString())) {
+    const std::string host_address = host->address()->asString();
+    if (host_addresses.count(host_address)) {
       continue;
     }
-    host_addresses.emplace(host->address()->asString());
+    host_addresses.emplace(host_address);
 
-    bool found = false;
-    for (auto i = current_hosts.begin(); i != current_hosts.end();) {
+    auto existing_host = existing_hosts_by_address.find(host_address);
+    if (existing_host != existing_hosts_by_address.end()) {
       // If we find a host matched based on address, we keep it. However we do change weight inline
       // so do that here.
-      if (*(*i)->address() == *host->address()) {
-        if (host->weight() > max_host_weight) {
-          max_host_weight = host->weight();
-        }
-
-        (*i)->weight(host->weight());
-        final_hosts.push_back(*i);
-        i = current_hosts.erase(i);
-        found = true;
-      } else {
-        i++;
+      if (host->weight() > max_host_weight) {
+        max_host_weight = host->weight();
       }
-    }
 
-    if (!found) {
+      existing_host->second->weight(host->weight());
+      final_hosts.push_back(existing_host->second);
+      existing_hosts_by_address.erase(existing_host);
+    } else {
       if (host->weight() > max_host_weight) {
         max_host_weight = host->weight();
       }
@@ -397,6 +412,21 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const std::vector<HostSharedP
     }
   }
 
+  // Every host still in the index was not matched by the new host list and is a removal
+  // candidate. Rebuild current_hosts from the original list to keep its order stable.
+  if (existing_hosts_by_address.empty()) {
+    current_hosts.clear();
+  } else {
+    std::vector<HostSharedPtr> unmatched_hosts;
+    unmatched_hosts.reserve(existing_hosts_by_address.size());
+    for (const HostSharedPtr& host : current_hosts) {
+      if (existing_hosts_by_address.count(host->address()->asString())) {
+        unmatched_hosts.push_back(host);
+      }
+    }
+    current_hosts = std::move(unmatched_hosts);
+  }
+
   // If there are removed hosts, check to see if we should only delete if unhealthy.
   if (!current_hosts.empty() && depend_on_hc) {
     for (auto i = current_hosts.begin(); i != current_hosts.end();) {
@@ -7,6 +7,7 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,7 @@
 #include "common/common/logger.h"
 #include "common/config/metadata.h"
 #include "common/config/well_known_names.h"
+#include "common/http/codes.h"
 #include "common/stats/stats_impl.h"
 #include "common/upstream/outlier_detection_impl.h"
 #include "common/upstream/resource_manager_impl.h"
@@ -57,7 +59,7 @@ public:
                                                 Config::MetadataEnvoyLbKeys::get().CANARY)
                     .bool_value()),
         metadata_(metadata),
-        zone_(zone), stats_{ALL_HOST_STATS(POOL_COUNTER(stats_store_), POOL_GAUGE(stats_store_))} {}
+        zone_(zone) {}
 
   // Upstream::HostDescription
   bool canary() const override { return canary_; }
@@ -81,7 +83,17 @@ public:
       return *null_outlier_detector;
     }
   }
-  const HostStats& stats() const override { return stats_; }
+  // Allocated on first use rather than at construction: an EDS update constructs every host in
+  // the cluster at once, and most per-host stats are never touched. Hosts are shared across
+  // worker threads, so initialization is guarded by a once flag.
+  const HostStats& stats() const override {
+    std::call_once(stats_init_, [this]() -> void {
+      stats_store_.reset(new Stats::IsolatedStoreImpl());
+      stats_.reset(
+          new HostStats{ALL_HOST_STATS(POOL_COUNTER(*stats_store_), POOL_GAUGE(*stats_store_))});
+    });
+    return *stats_;
+  }
   const std::string& hostname() const override { return hostname_; }
   Network::Address::InstanceConstSharedPtr address() const override { return address_; }
   const std::string& zone() const override { return zone_; }
@@ -93,8 +105,9 @@ protected:
   const bool canary_;
   const envoy::api::v2::Metadata metadata_;
   const std::string zone_;
-  Stats::IsolatedStoreImpl stats_store_;
-  HostStats stats_;
+  mutable std::once_flag stats_init_;
+  mutable std::unique_ptr<Stats::IsolatedStoreImpl> stats_store_;
+  mutable std::unique_ptr<HostStats> stats_;
   Outlier::DetectorHostMonitorPtr outlier_detector_;
   HealthCheckHostMonitorPtr health_checker_;
 };
@@ -115,9 +128,14 @@ public:
   }
 
   // Upstream::Host
-  std::list<Stats::CounterSharedPtr> counters() const override { return stats_store_.counters(); }
+  std::list<Stats::CounterSharedPtr> counters() const override {
+    return stats_store_ != nullptr ? stats_store_->counters()
+                                   : std::list<Stats::CounterSharedPtr>{};
+  }
   CreateConnectionData createConnection(Event::Dispatcher& dispatcher) const override;
-  std::list<Stats::GaugeSharedPtr> gauges() const override { return stats_store_.gauges(); }
+  std::list<Stats::GaugeSharedPtr> gauges() const override {
+    return stats_store_ != nullptr ? stats_store_->gauges() : std::list<Stats::GaugeSharedPtr>{};
+  }
   void healthFlagClear(HealthFlag flag) override { health_flags_ &= ~enumToInt(flag); }
   bool healthFlagGet(HealthFlag flag) const override { return health_flags_ & enumToInt(flag); }
   void healthFlagSet(HealthFlag flag) override { health_flags_ |= enumToInt(flag); }
@@ -227,6 +245,9 @@ public:
   uint64_t maxRequestsPerConnection() const override { return max_requests_per_connection_; }
   const std::string& name() const override { return name_; }
   ResourceManager& resourceManager(ResourcePriority priority) const override;
+  Http::ResponseCodeStatFamily& responseCodeStatFamily() const override {
+    return response_code_stat_family_;
+  }
   Ssl::ClientContext* sslContext() const override { return ssl_ctx_.get(); }
   ClusterStats& stats() const override { return stats_; }
   Stats::Scope& statsScope() const override { return *stats_scope_; }
@@ -256,6 +277,7 @@ private:
   const uint32_t per_connection_buffer_limit_bytes_;
   Stats::ScopePtr stats_scope_;
   mutable ClusterStats stats_;
+  mutable Http::ResponseCodeStatFamily response_code_stat_family_;
   Ssl::ClientContextPtr ssl_ctx_;
   const uint64_t features_;
   const Http::Http2Settings http2_settings_;
@@ -274,6 +296,11 @@ class ClusterImplBase : public Cluster,
                         protected Logger::Loggable<Logger::Id::upstream> {
 
 public:
+  /**
+   * Create a cluster. dispatcher is the main dispatcher. health_check_dispatcher optionally
+   * supplies a dedicated dispatcher for this cluster's active health checking; when nullptr the
+   * health checker runs on the main dispatcher as before.
+   */
   static ClusterSharedPtr create(const envoy::api::v2::Cluster& cluster, ClusterManager& cm,
                                  Stats::Store& stats, ThreadLocal::Instance& tls,
                                  Network::DnsResolverSharedPtr dns_resolver,
@@ -281,7 +308,10 @@ public:
                                  Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
                                  const LocalInfo::LocalInfo& local_info,
                                  Outlier::EventLoggerSharedPtr outlier_event_logger,
-                                 bool added_via_api);
+                                 bool added_via_api,
+                                 Event::Dispatcher* health_check_dispatcher = nullptr);
+
+  ~ClusterImplBase();
 
   /**
    * Optionally set the health checker for the primary cluster. This is done after cluster
@@ -55,7 +55,7 @@ int main_common(OptionsImpl& options) {
   std::unique_ptr<Server::HotRestartNopImpl> restarter;
   restarter.reset(new Server::HotRestartNopImpl());
 
-  Thread::MutexBasicLockable log_lock, access_log_lock;
+  Thread::MutexBasicLockable log_lock("log"), access_log_lock("access_log");
   Stats::HeapRawStatDataAllocator stats_allocator;
 #endif
 
@@ -74,6 +74,9 @@ int main_common(OptionsImpl& options) {
   ares_library_init(ARES_LIB_INIT_ALL);
 
   Logger::Registry::initialize(options.logLevel(), log_lock);
+  // Hand stderr writes below the err level to a dedicated thread so that verbose logging
+  // (accidental or otherwise) drops lines rather than stalling workers on log I/O.
+  Logger::Registry::getSink()->startAsync();
   DefaultTestHooks default_test_hooks;
   ThreadLocal::InstanceImpl tls;
   Stats::ThreadLocalStoreImpl stats_store(stats_allocator);
@@ -1,5 +1,6 @@
 #include "server/config/http/file_access_log.h"
 
+#include "envoy/common/exception.h"
 #include "envoy/registry/registry.h"
 #include "envoy/server/filter_config.h"
 
@@ -34,11 +35,37 @@ ProtobufTypes::MessagePtr FileAccessLogFactory::createEmptyConfigProto() {
 
 std::string FileAccessLogFactory::name() const { return Config::AccessLogNames::get().FILE; }
 
+Http::AccessLog::InstanceSharedPtr BinaryFileAccessLogFactory::createAccessLogInstance(
+    const Protobuf::Message& config, Http::AccessLog::FilterPtr&& filter, FactoryContext& context) {
+  const auto& fal_config = dynamic_cast<const envoy::api::v2::filter::FileAccessLog&>(config);
+  if (fal_config.format().empty()) {
+    throw EnvoyException("binary file access log requires a format schema");
+  }
+  Http::AccessLog::FormatterPtr formatter{
+      new Http::AccessLog::BinaryFormatterImpl(fal_config.format())};
+  return Http::AccessLog::InstanceSharedPtr{new Http::AccessLog::FileAccessLog(
+      fal_config.path(), std::move(filter), std::move(formatter), context.accessLogManager())};
+}
+
+ProtobufTypes::MessagePtr BinaryFileAccessLogFactory::createEmptyConfigProto() {
+  return ProtobufTypes::MessagePtr{new envoy::api::v2::filter::FileAccessLog()};
+}
+
+std::string BinaryFileAccessLogFactory::name() const {
+  return Config::AccessLogNames::get().BINARY_FILE;
+}
+
 /**
  * Static registration for the file access log. @see RegisterFactory.
  */
 static Registry::RegisterFactory<FileAccessLogFactory, AccessLogInstanceFactory> register_;
 
+/**
+ * Static registration for the binary file access log. @see RegisterFactory.
+ */
+static Registry::RegisterFactory<BinaryFileAccessLogFactory, AccessLogInstanceFactory>
+    binary_register_;
+
 } // namespace Configuration
 } // namespace Server
 } // namespace Envoy
\ No newline at end of file
@@ -22,6 +22,21 @@ public:
   std::string name() const override;
 };
 
+/**
+ * Config registration for the binary file access log. It shares the file access log config proto;
+ * the format string is used as the binary record schema. @see AccessLogInstanceFactory.
+ */
+class BinaryFileAccessLogFactory : public AccessLogInstanceFactory {
+public:
+  Http::AccessLog::InstanceSharedPtr createAccessLogInstance(const Protobuf::Message& config,
+                                                             Http::AccessLog::FilterPtr&& filter,
+                                                             FactoryContext& context) override;
+
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+  std::string name() const override;
+};
+
 } // namespace Configuration
 } // namespace Server
 } // namespace Envoy
\ No newline at end of file
@@ -101,9 +101,11 @@ HttpConnectionManagerConfigUtility::determineNextProtocol(Network::Connection& c
 
   // See if the data we have so far shows the HTTP/2 prefix. We ignore the case where someone sends
   // us the first few bytes of the HTTP/2 prefix since in all public cases we use SSL/ALPN. For
-  // internal cases this should practically never happen.
-  if (-1 != data.search(Http::Http2::CLIENT_MAGIC_PREFIX.c_str(),
-                        Http::Http2::CLIENT_MAGIC_PREFIX.size(), 0)) {
+  // internal cases this should practically never happen. The prefix must be at the very start of
+  // the connection; an HTTP/1 request whose first read happens to contain these bytes further in
+  // (e.g. in a body) must not select the HTTP/2 codec.
+  if (0 == data.search(Http::Http2::CLIENT_MAGIC_PREFIX.c_str(),
+                       Http::Http2::CLIENT_MAGIC_PREFIX.size(), 0)) {
     return Http::Http2::ALPN_STRING;
   }
 
@@ -219,6 +221,7 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
   }
 
   const auto& filters = config.http_filters();
+  filter_factories_.reserve(filters.size());
   for (int32_t i = 0; i < filters.size(); i++) {
     const ProtobufTypes::String& string_name = filters[i].name();
     const auto& proto_config = filters[i];
@@ -240,7 +243,7 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
           Config::Utility::translateToFactoryConfig(proto_config, factory);
       callback = factory.createFilterFactoryFromProto(*message, stats_prefix_, context);
     }
-    filter_factories_.push_back(callback);
+    filter_factories_.push_back(std::move(callback));
   }
 }
 
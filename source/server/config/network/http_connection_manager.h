@@ -5,6 +5,7 @@
 #include <functional>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "envoy/http/filter.h"
 #include "envoy/router/route_config_provider_manager.h"
@@ -99,7 +100,9 @@ private:
   enum class CodecType { HTTP1, HTTP2, AUTO };
 
   FactoryContext& context_;
-  std::list<HttpFilterFactoryCb> filter_factories_;
+  // Built once at listener config time and walked per stream; a flat vector keeps the walk a
+  // contiguous scan rather than a pointer chase per filter.
+  std::vector<HttpFilterFactoryCb> filter_factories_;
   std::list<Http::AccessLog::InstanceSharedPtr> access_logs_;
   const std::string stats_prefix_;
   Http::ConnectionManagerStats stats_;
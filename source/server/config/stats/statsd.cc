@@ -30,7 +30,7 @@ Stats::SinkPtr StatsdSinkFactory::createStatsSink(const Protobuf::Message& confi
     ENVOY_LOG(info, "statsd TCP cluster: {}", statsd_sink.tcp_cluster_name());
     return Stats::SinkPtr(new Stats::Statsd::TcpStatsdSink(
         server.localInfo(), statsd_sink.tcp_cluster_name(), server.threadLocal(),
-        server.clusterManager(), server.stats()));
+        server.clusterManager(), server.stats(), server.random()));
     break;
   default:
     throw EnvoyException(
@@ -1,14 +1,17 @@
 #include "server/config_validation/server.h"
 
+#include "common/common/utility.h"
 #include "common/common/version.h"
 #include "common/config/bootstrap_json.h"
 #include "common/local_info/local_info_impl.h"
+#include "common/memory/stats.h"
 #include "common/protobuf/utility.h"
 #include "common/singleton/manager_impl.h"
 
 #include "server/configuration_impl.h"
 
 #include "api/bootstrap.pb.h"
+#include "fmt/format.h"
 
 namespace Envoy {
 namespace Server {
@@ -22,6 +25,11 @@ bool validateConfig(Options& options, Network::Address::InstanceConstSharedPtr l
     ValidationInstance server(options, local_address, stats_store, access_log_lock,
                               component_factory);
     std::cout << "configuration '" << options.configPath() << "' OK" << std::endl;
+    for (const ValidationTiming& timing : server.timings()) {
+      std::cout << fmt::format("  {}: {} ms, {} bytes", timing.name_, timing.duration_.count(),
+                               timing.memory_used_)
+                << std::endl;
+    }
     server.shutdown();
     return true;
   } catch (const EnvoyException& e) {
@@ -63,16 +71,18 @@ void ValidationInstance::initialize(Options& options,
   // be ready to serve, then the config has passed validation.
   // Handle configuration that needs to take place prior to the main configuration load.
   envoy::api::v2::Bootstrap bootstrap;
-  try {
-    MessageUtil::loadFromFile(options.configPath(), bootstrap);
-  } catch (const EnvoyException& e) {
-    // TODO(htuch): When v1 is deprecated, make this a warning encouraging config upgrade.
-    ENVOY_LOG(debug, "Unable to initialize config as v2, will retry as v1: {}", e.what());
-  }
-  if (!bootstrap.has_admin()) {
-    Json::ObjectSharedPtr config_json = Json::Factory::loadFromFile(options.configPath());
-    Config::BootstrapJson::translateBootstrap(*config_json, bootstrap);
-  }
+  timeSection("bootstrap", [&]() -> void {
+    try {
+      MessageUtil::loadFromFile(options.configPath(), bootstrap);
+    } catch (const EnvoyException& e) {
+      // TODO(htuch): When v1 is deprecated, make this a warning encouraging config upgrade.
+      ENVOY_LOG(debug, "Unable to initialize config as v2, will retry as v1: {}", e.what());
+    }
+    if (!bootstrap.has_admin()) {
+      Json::ObjectSharedPtr config_json = Json::Factory::loadFromFile(options.configPath());
+      Config::BootstrapJson::translateBootstrap(*config_json, bootstrap);
+    }
+  });
   bootstrap.mutable_node()->set_build_version(VersionInfo::version());
 
   local_info_.reset(
@@ -81,7 +91,9 @@ void ValidationInstance::initialize(Options& options,
 
   Configuration::InitialImpl initial_config(bootstrap);
   thread_local_.registerThread(*dispatcher_, true);
-  runtime_loader_ = component_factory.createRuntime(*this, initial_config);
+  timeSection("runtime", [&]() -> void {
+    runtime_loader_ = component_factory.createRuntime(*this, initial_config);
+  });
   ssl_context_manager_.reset(new Ssl::ContextManagerImpl(*runtime_loader_));
   cluster_manager_factory_.reset(new Upstream::ValidationClusterManagerFactory(
       runtime(), stats(), threadLocal(), random(), dnsResolver(), sslContextManager(), dispatcher(),
@@ -89,12 +101,36 @@ void ValidationInstance::initialize(Options& options,
 
   Configuration::MainImpl* main_config = new Configuration::MainImpl();
   config_.reset(main_config);
-  main_config->initialize(bootstrap, *this, *cluster_manager_factory_);
+  // This covers clusters, listeners, tracing, and stats sinks; each listener's filter chain also
+  // gets its own nested section via createFilterFactoryList() below.
+  timeSection("configuration", [&]() -> void {
+    main_config->initialize(bootstrap, *this, *cluster_manager_factory_);
+  });
 
   clusterManager().setInitializedCb(
       [this]() -> void { init_manager_.initialize([]() -> void {}); });
 }
 
+std::vector<Configuration::NetworkFilterFactoryCb> ValidationInstance::createFilterFactoryList(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::Filter>& filters,
+    Configuration::FactoryContext& context) {
+  std::vector<Configuration::NetworkFilterFactoryCb> factories;
+  timeSection(fmt::format("listener #{}", listener_index_++), [&]() -> void {
+    factories = ProdListenerComponentFactory::createFilterFactoryList_(filters, context);
+  });
+  return factories;
+}
+
+void ValidationInstance::timeSection(const std::string& name, std::function<void()> section) {
+  const uint64_t memory_before = Memory::Stats::totalCurrentlyAllocated();
+  const MonotonicTime start = ProdMonotonicTimeSource::instance_.currentTime();
+  section();
+  const MonotonicTime end = ProdMonotonicTimeSource::instance_.currentTime();
+  const uint64_t memory_after = Memory::Stats::totalCurrentlyAllocated();
+  timings_.push_back({name, std::chrono::duration_cast<std::chrono::milliseconds>(end - start),
+                      memory_after > memory_before ? memory_after - memory_before : 0});
+}
+
 void ValidationInstance::shutdown() {
   // This normally happens at the bottom of InstanceImpl::run(), but we don't have a run(). We can
   // do an abbreviated shutdown here since there's less to clean up -- for example, no workers to
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "envoy/common/optional.h"
 #include "envoy/server/drain_manager.h"
@@ -34,6 +38,17 @@ namespace Server {
 bool validateConfig(Options& options, Network::Address::InstanceConstSharedPtr local_address,
                     ComponentFactory& component_factory);
 
+/**
+ * One timed section of a validation run. The wall time and heap growth attributed to each section
+ * are reported after a successful validation, so that slow or bloated parts of a config can be
+ * identified without profiling a real server boot.
+ */
+struct ValidationTiming {
+  std::string name_;
+  std::chrono::milliseconds duration_;
+  uint64_t memory_used_;
+};
+
 /**
  * ValidationInstance does the bulk of the work for config-validation runs of Envoy. It implements
  * Server::Instance, but some functionality not needed until serving time, such as updating
@@ -88,12 +103,16 @@ public:
   ThreadLocal::Instance& threadLocal() override { return thread_local_; }
   const LocalInfo::LocalInfo& localInfo() override { return *local_info_; }
 
+  /**
+   * @return the per-section timings gathered while initializing, in order of completion (so
+   *         sections nested inside another section appear before it).
+   */
+  const std::vector<ValidationTiming>& timings() const { return timings_; }
+
   // Server::ListenerComponentFactory
   std::vector<Configuration::NetworkFilterFactoryCb>
   createFilterFactoryList(const Protobuf::RepeatedPtrField<envoy::api::v2::Filter>& filters,
-                          Configuration::FactoryContext& context) override {
-    return ProdListenerComponentFactory::createFilterFactoryList_(filters, context);
-  }
+                          Configuration::FactoryContext& context) override;
   Network::ListenSocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr,
                                                     bool) override {
     // Returned sockets are not currently used so we can return nothing here safely vs. a
@@ -114,6 +133,11 @@ private:
   void initialize(Options& options, Network::Address::InstanceConstSharedPtr local_address,
                   ComponentFactory& component_factory);
 
+  /**
+   * Run a section of initialization, recording its wall time and heap growth under the given name.
+   */
+  void timeSection(const std::string& name, std::function<void()> section);
+
   Options& options_;
   Stats::IsolatedStoreImpl& stats_store_;
   ThreadLocal::InstanceImpl thread_local_;
@@ -131,6 +155,10 @@ private:
   std::unique_ptr<Upstream::ValidationClusterManagerFactory> cluster_manager_factory_;
   InitManagerImpl init_manager_;
   ListenerManagerImpl listener_manager_;
+  std::vector<ValidationTiming> timings_;
+  // Index of the next listener to have its filter chain validated, used to label the per-listener
+  // timing sections to match the "listener #N" log lines from the main config load.
+  uint64_t listener_index_{};
 };
 
 } // namespace Server
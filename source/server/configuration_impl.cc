@@ -70,8 +70,8 @@ void MainImpl::initialize(const envoy::api::v2::Bootstrap& bootstrap, Instance&
   initializeTracers(bootstrap.tracing(), server);
 
   if (bootstrap.has_rate_limit_service()) {
-    ratelimit_client_factory_.reset(
-        new RateLimit::GrpcFactoryImpl(bootstrap.rate_limit_service(), *cluster_manager_));
+    ratelimit_client_factory_.reset(new RateLimit::GrpcFactoryImpl(
+        bootstrap.rate_limit_service(), *cluster_manager_, server.threadLocal()));
   } else {
     ratelimit_client_factory_.reset(new RateLimit::NullFactoryImpl());
   }
@@ -0,0 +1,57 @@
+#include "server/connection_budget.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Server {
+
+uint64_t ConnectionBudget::drawBlock() {
+  uint64_t current = remaining_.load(std::memory_order_relaxed);
+  while (true) {
+    // Near exhaustion we draw whatever is left, so the final permits are still usable.
+    const uint64_t draw = std::min(current, BLOCK_SIZE);
+    if (draw == 0) {
+      return 0;
+    }
+    if (remaining_.compare_exchange_weak(current, current - draw, std::memory_order_relaxed)) {
+      return draw;
+    }
+  }
+}
+
+ConnectionBudget::Client::~Client() {
+  if (budget_ != nullptr && budget_->enforce_) {
+    budget_->returnPermits(local_);
+  }
+}
+
+bool ConnectionBudget::Client::tryAcquire() {
+  if (budget_ == nullptr || !budget_->enforce_) {
+    return true;
+  }
+
+  if (local_ == 0) {
+    local_ = budget_->drawBlock();
+    if (local_ == 0) {
+      return false;
+    }
+  }
+
+  local_--;
+  return true;
+}
+
+void ConnectionBudget::Client::release() {
+  if (budget_ == nullptr || !budget_->enforce_) {
+    return;
+  }
+
+  local_++;
+  if (local_ >= 2 * BLOCK_SIZE) {
+    budget_->returnPermits(BLOCK_SIZE);
+    local_ -= BLOCK_SIZE;
+  }
+}
+
+} // namespace Server
+} // namespace Envoy
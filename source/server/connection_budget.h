@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Process-wide budget of downstream connections. Each worker's connection handler owns a Client
+ * that draws permits from the shared budget in blocks and accounts accepts and closes against its
+ * local block, so in the steady state an accept costs a local decrement and the shared atomic is
+ * only touched when a block is exhausted or returned. This gives a hard process-wide connection
+ * cap without cross-core traffic on every accept.
+ */
+class ConnectionBudget : NonCopyable {
+public:
+  /**
+   * @param max_connections supplies the process-wide connection cap. 0 disables enforcement.
+   */
+  ConnectionBudget(uint64_t max_connections)
+      : enforce_(max_connections != 0), remaining_(max_connections) {}
+
+  /**
+   * @return the number of permits currently held by the shared budget. Permits held in worker
+   *         local blocks are not included.
+   */
+  uint64_t remaining() const { return remaining_.load(std::memory_order_relaxed); }
+
+  /**
+   * Per worker view of the budget. Not thread safe; each worker owns its own client.
+   */
+  class Client {
+  public:
+    /**
+     * @param budget supplies the shared budget to draw from, or nullptr for a client that always
+     *        grants (used where no budget is configured).
+     */
+    Client(ConnectionBudget* budget) : budget_(budget) {}
+    ~Client();
+
+    /**
+     * Take one permit, drawing a new block from the shared budget if the local block is empty.
+     * @return bool whether a permit was available.
+     */
+    bool tryAcquire();
+
+    /**
+     * Return one permit to the local block. Permits beyond one full block are returned to the
+     * shared budget so a worker whose connections drained does not strand them locally.
+     */
+    void release();
+
+  private:
+    ConnectionBudget* const budget_;
+    // Permits drawn from the shared budget and not yet spent on a connection.
+    uint64_t local_{};
+  };
+
+private:
+  // Permits move between the shared pool and worker local blocks this many at a time. The block
+  // must be small relative to sensible caps so a handful of workers cannot strand the budget in
+  // local blocks, but large enough that the shared atomic is touched rarely.
+  static const uint64_t BLOCK_SIZE = 64;
+
+  uint64_t drawBlock();
+  void returnPermits(uint64_t count) { remaining_.fetch_add(count, std::memory_order_relaxed); }
+
+  const bool enforce_;
+  std::atomic<uint64_t> remaining_;
+};
+
+} // namespace Server
+} // namespace Envoy
@@ -1,14 +1,21 @@
 #include "server/connection_handler_impl.h"
 
+#include <unistd.h>
+
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
 #include "envoy/network/filter.h"
 
+#include "common/common/tracepoint.h"
+
 namespace Envoy {
 namespace Server {
 
-ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
-    : logger_(logger), dispatcher_(dispatcher) {}
+ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                                             Network::ConnectionPassHandler pass_handler,
+                                             ConnectionBudget* budget)
+    : logger_(logger), dispatcher_(dispatcher), pass_handler_(pass_handler),
+      budget_client_(budget) {}
 
 void ConnectionHandlerImpl::addListener(Network::FilterChainFactory& factory,
                                         Network::ListenSocket& socket, Stats::Scope& scope,
@@ -16,6 +23,9 @@ void ConnectionHandlerImpl::addListener(Network::FilterChainFactory& factory,
                                         const Network::ListenerOptions& listener_options) {
   ActiveListenerPtr l(
       new ActiveListener(*this, socket, factory, scope, listener_tag, listener_options));
+  if (disable_listeners_) {
+    l->listener_->disable();
+  }
   listeners_.emplace_back(socket.localAddress(), std::move(l));
 }
 
@@ -26,6 +36,9 @@ void ConnectionHandlerImpl::addSslListener(Network::FilterChainFactory& factory,
                                            const Network::ListenerOptions& listener_options) {
   ActiveListenerPtr l(new SslActiveListener(*this, ssl_ctx, socket, factory, scope, listener_tag,
                                             listener_options));
+  if (disable_listeners_) {
+    l->listener_->disable();
+  }
   listeners_.emplace_back(socket.localAddress(), std::move(l));
 }
 
@@ -53,6 +66,25 @@ void ConnectionHandlerImpl::stopListeners() {
   }
 }
 
+void ConnectionHandlerImpl::disableListeners() {
+  disable_listeners_ = true;
+  for (auto& listener : listeners_) {
+    // Stopped listeners (see stopListeners()) have no listener to pause.
+    if (listener.second->listener_ != nullptr) {
+      listener.second->listener_->disable();
+    }
+  }
+}
+
+void ConnectionHandlerImpl::enableListeners() {
+  disable_listeners_ = false;
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_ != nullptr) {
+      listener.second->listener_->enable();
+    }
+  }
+}
+
 void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& connection) {
   ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, info, "adding to cleanup list",
                            *connection.connection_);
@@ -60,6 +92,7 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
   parent_.dispatcher_.deferredDelete(std::move(removed));
   ASSERT(parent_.num_connections_ > 0);
   parent_.num_connections_--;
+  parent_.budget_client_.release();
 }
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(
@@ -79,7 +112,25 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& par
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
   while (!connections_.empty()) {
-    connections_.front()->connection_->close(Network::ConnectionCloseType::NoFlush);
+    Network::Connection& connection = *connections_.front()->connection_;
+
+    // Offer idle connections to the pass handler before tearing them down, so that long-lived
+    // keep-alive connections can survive a hot restart rather than all reconnecting at once.
+    // detachFd() raises LocalClose on success, which removes the connection from the list.
+    if (parent_.pass_handler_ != nullptr) {
+      const int fd = connection.detachFd();
+      if (fd != -1) {
+        if (parent_.pass_handler_(fd, connection.localAddress(), connection.remoteAddress())) {
+          stats_.downstream_cx_migrated_.inc();
+        }
+
+        // The new process (if any) received its own duplicate of the socket.
+        ::close(fd);
+        continue;
+      }
+    }
+
+    connection.close(Network::ConnectionCloseType::NoFlush);
   }
 
   parent_.dispatcher_.clearDeferredDeleteList();
@@ -126,6 +177,18 @@ ConnectionHandlerImpl::findListenerByAddress(const Network::Address::Instance& a
 void ConnectionHandlerImpl::ActiveListener::onNewConnection(
     Network::ConnectionPtr&& new_connection) {
   ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, info, "new connection", *new_connection);
+
+  // Enforce the process-wide connection budget before doing any further setup work for the
+  // connection. Shedding here keeps fd usage bounded when one listener is attacked, rather than
+  // letting fd exhaustion take down the whole process.
+  if (!parent_.budget_client_.tryAcquire()) {
+    ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, warn, "closing connection: connection budget used up",
+                             *new_connection);
+    stats_.downstream_cx_overflow_.inc();
+    new_connection->close(Network::ConnectionCloseType::NoFlush);
+    return;
+  }
+
   bool empty_filter_chain = !factory_.createFilterChain(*new_connection);
 
   // If the connection is already closed, we can just let this connection immediately die.
@@ -140,8 +203,12 @@ void ConnectionHandlerImpl::ActiveListener::onNewConnection(
       ActiveConnectionPtr active_connection(new ActiveConnection(*this, std::move(new_connection)));
       active_connection->moveIntoList(std::move(active_connection), connections_);
       parent_.num_connections_++;
+      return;
     }
   }
+
+  // The connection did not survive setup; give its permit back.
+  parent_.budget_client_.release();
 }
 
 ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listener,
@@ -154,6 +221,7 @@ ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listen
   connection_->addConnectionCallbacks(*this);
   listener_.stats_.downstream_cx_total_.inc();
   listener_.stats_.downstream_cx_active_.inc();
+  ENVOY_PROBE1(connection_accepted, connection_->id());
 }
 
 ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
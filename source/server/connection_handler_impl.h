@@ -16,6 +16,8 @@
 #include "common/common/linked_object.h"
 #include "common/common/non_copyable.h"
 
+#include "server/connection_budget.h"
+
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -25,6 +27,8 @@ namespace Server {
 #define ALL_LISTENER_STATS(COUNTER, GAUGE, TIMER)                                                  \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_destroy)                                                                   \
+  COUNTER(downstream_cx_migrated)                                                                  \
+  COUNTER(downstream_cx_overflow)                                                                  \
   GAUGE  (downstream_cx_active)                                                                    \
   TIMER  (downstream_cx_length_ms)
 // clang-format on
@@ -42,7 +46,16 @@ struct ListenerStats {
  */
 class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
 public:
-  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  /**
+   * @param pass_handler if non-null, migratable connections are offered to this handler instead
+   *        of being closed when their listener is torn down. See
+   *        Network::ConnectionPassHandler.
+   * @param budget if non-null, the process-wide connection budget that accepts are accounted
+   *        against. Connections accepted while the budget is exhausted are closed immediately.
+   */
+  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                        Network::ConnectionPassHandler pass_handler = nullptr,
+                        ConnectionBudget* budget = nullptr);
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
@@ -56,6 +69,8 @@ public:
   void removeListeners(uint64_t listener_tag) override;
   void stopListeners(uint64_t listener_tag) override;
   void stopListeners() override;
+  void disableListeners() override;
+  void enableListeners() override;
 
 private:
   struct ActiveConnection;
@@ -133,8 +148,11 @@ private:
 
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
+  const Network::ConnectionPassHandler pass_handler_;
+  ConnectionBudget::Client budget_client_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
   std::atomic<uint64_t> num_connections_{};
+  bool disable_listeners_{};
 };
 
 } // Server
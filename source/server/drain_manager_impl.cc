@@ -1,5 +1,6 @@
 #include "server/drain_manager_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
@@ -31,15 +32,54 @@ bool DrainManagerImpl::drainClose() const {
     return false;
   }
 
-  // We use the tick time as in increasing chance that we shutdown connections.
-  return static_cast<uint64_t>(drain_time_completed_.load()) >
-         (server_.random().random() % server_.options().drainTime().count());
+  // The drain probability is recomputed on every tick from the number of connections that
+  // actually remain, so drain closes track the drain schedule instead of blindly ramping with
+  // elapsed time.
+  return (server_.random().random() % DRAIN_PROBABILITY_DENOMINATOR) < drain_probability_.load();
+}
+
+void DrainManagerImpl::updateDrainProbability() {
+  const uint64_t drain_time = server_.options().drainTime().count();
+  const uint64_t elapsed = drain_time_completed_.load();
+  const uint64_t remaining_connections = server_.listenerManager().numConnections();
+  if (elapsed >= drain_time || remaining_connections == 0) {
+    drain_probability_.store(DRAIN_PROBABILITY_DENOMINATOR);
+    return;
+  }
+
+  // By default pace the drain so that the connections observed at drain start reach zero as the
+  // drain window closes. The runtime override allows operators of long-lived-connection tiers to
+  // pin an explicit connections/sec rate instead.
+  uint64_t rate = server_.runtime().snapshot().getInteger(
+      "drain_manager.target_connections_per_sec", 0);
+  if (rate == 0) {
+    rate = std::max<uint64_t>(initial_connections_ / drain_time, 1);
+  }
+
+  const uint64_t drained_target = rate * elapsed;
+  const uint64_t target_remaining =
+      initial_connections_ > drained_target ? initial_connections_ - drained_target : 0;
+  if (remaining_connections <= target_remaining) {
+    // At or ahead of schedule; no need to push connections away.
+    drain_probability_.store(0);
+    return;
+  }
+
+  // Behind schedule. Close the fraction of remaining connections needed to get back on target.
+  uint64_t probability =
+      (remaining_connections - target_remaining) * DRAIN_PROBABILITY_DENOMINATOR /
+      remaining_connections;
+  if (probability > DRAIN_PROBABILITY_DENOMINATOR) {
+    probability = DRAIN_PROBABILITY_DENOMINATOR;
+  }
+  drain_probability_.store(probability);
 }
 
 void DrainManagerImpl::drainSequenceTick() {
   ENVOY_LOG(trace, "drain tick #{}", drain_time_completed_.load());
   ASSERT(drain_time_completed_.load() < server_.options().drainTime().count());
   ++drain_time_completed_;
+  updateDrainProbability();
 
   if (drain_time_completed_.load() < server_.options().drainTime().count()) {
     drain_tick_timer_->enableTimer(std::chrono::milliseconds(1000));
@@ -51,6 +91,7 @@ void DrainManagerImpl::drainSequenceTick() {
 void DrainManagerImpl::startDrainSequence(std::function<void()> completion) {
   drain_sequence_completion_ = completion;
   ASSERT(!drain_tick_timer_);
+  initial_connections_ = server_.listenerManager().numConnections();
   drain_tick_timer_ = server_.dispatcher().createTimer([this]() -> void { drainSequenceTick(); });
   drainSequenceTick();
 }
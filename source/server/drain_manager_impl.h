@@ -14,8 +14,8 @@ namespace Server {
 /**
  * Implementation of drain manager that does the following by default:
  * 1) Terminates the parent process after 15 minutes.
- * 2) Drains the parent process over a period of 10 minutes where drain close becomes more
- *    likely each second that passes.
+ * 2) Drains the parent process over a period of 10 minutes, pacing drain closes against the
+ *    number of connections that actually remain so that draining neither stalls nor stampedes.
  */
 class DrainManagerImpl : Logger::Loggable<Logger::Id::main>, public DrainManager {
 public:
@@ -29,10 +29,17 @@ public:
 private:
   bool draining() const { return drain_tick_timer_ != nullptr; }
   void drainSequenceTick();
+  void updateDrainProbability();
+
+  // Drain probabilities are expressed out of this denominator.
+  static const uint64_t DRAIN_PROBABILITY_DENOMINATOR = 10000;
 
   Instance& server_;
   Event::TimerPtr drain_tick_timer_;
   std::atomic<uint32_t> drain_time_completed_{};
+  uint64_t initial_connections_{};
+  // Computed on each tick on the main thread, read by drainClose() on workers.
+  std::atomic<uint64_t> drain_probability_{};
   Event::TimerPtr parent_shutdown_timer_;
   std::function<void()> drain_sequence_completion_;
 };
@@ -1,9 +1,12 @@
 #include "server/guarddog_impl.h"
 
 #include <chrono>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "common/common/assert.h"
+#include "common/memory/stats.h"
 
 #include "server/watchdog_impl.h"
 
@@ -26,20 +29,46 @@ GuardDogImpl::GuardDogImpl(Stats::Scope& stats_scope, const Server::Configuratio
                          multikillEnabled() ? multi_kill_timeout_ : min_of_nonfatal,
                          min_of_nonfatal});
       }()),
+      memory_release_interval_(std::chrono::seconds(10)),
       watchdog_miss_counter_(stats_scope.counter("server.watchdog_miss")),
       watchdog_megamiss_counter_(stats_scope.counter("server.watchdog_mega_miss")),
+      memory_pageheap_free_gauge_(stats_scope.gauge("server.memory_pageheap_free")),
+      memory_pageheap_unmapped_gauge_(stats_scope.gauge("server.memory_pageheap_unmapped")),
+      last_memory_release_(tsource.currentTime()), stats_scope_(stats_scope),
+      watched_dogs_(std::make_shared<const std::vector<WatchedDogSharedPtr>>()),
       run_thread_(true) {
   start();
 }
 
+GuardDogImpl::WatchedDog::WatchedDog(Stats::Scope& stats_scope, const WatchDogSharedPtr& dog)
+    : dog_(dog), miss_counter_(stats_scope.counter(
+                     fmt::format("server.watchdog_miss.thread_{}", dog->threadId()))),
+      megamiss_counter_(stats_scope.counter(
+          fmt::format("server.watchdog_mega_miss.thread_{}", dog->threadId()))) {}
+
 GuardDogImpl::~GuardDogImpl() { stop(); }
 
 void GuardDogImpl::threadRoutine() {
   do {
     const auto now = time_source_.currentTime();
+
+    // This thread already wakes up periodically and is not latency sensitive, which makes it a
+    // good place to return free pages to the OS. Without this, RSS stays pinned at its peak after
+    // a traffic spike because freed buffer memory is kept on the allocator's free lists. The
+    // gauges are refreshed before the release so they reflect the pressure that was observed.
+    if (now - last_memory_release_ >= memory_release_interval_) {
+      memory_pageheap_free_gauge_.set(Memory::Stats::totalPageHeapFree());
+      memory_pageheap_unmapped_gauge_.set(Memory::Stats::totalPageHeapUnmapped());
+      Memory::Stats::releaseFreeMemory();
+      last_memory_release_ = now;
+    }
+
     bool seen_one_multi_timeout(false);
-    std::lock_guard<std::mutex> guard(wd_lock_);
-    for (auto& watched_dog : watched_dogs_) {
+    // The scan takes no lock: it reads whatever list was last published and the per dog scan
+    // state is only ever written from this thread.
+    const WatchedDogListSharedPtr watched_dogs = std::atomic_load(&watched_dogs_);
+    for (const WatchedDogSharedPtr& watched_dog_ptr : *watched_dogs) {
+      WatchedDog& watched_dog = *watched_dog_ptr;
       const auto ltt = watched_dog.dog_->lastTouchTime();
       const auto delta = now - ltt;
       if (watched_dog.last_alert_time_.valid() && watched_dog.last_alert_time_.value() < ltt) {
@@ -49,6 +78,7 @@ void GuardDogImpl::threadRoutine() {
       if (delta > miss_timeout_) {
         if (!watched_dog.miss_alerted_) {
           watchdog_miss_counter_.inc();
+          watched_dog.miss_counter_.inc();
           watched_dog.last_alert_time_.value(ltt);
           watched_dog.miss_alerted_ = true;
         }
@@ -56,6 +86,7 @@ void GuardDogImpl::threadRoutine() {
       if (delta > megamiss_timeout_) {
         if (!watched_dog.megamiss_alerted_) {
           watchdog_megamiss_counter_.inc();
+          watched_dog.megamiss_counter_.inc();
           watched_dog.last_alert_time_.value(ltt);
           watched_dog.megamiss_alerted_ = true;
         }
@@ -86,11 +117,13 @@ WatchDogSharedPtr GuardDogImpl::createWatchDog(int32_t thread_id) {
   auto wd_interval = loop_interval_ / 2;
   WatchDogSharedPtr new_watchdog =
       std::make_shared<WatchDogImpl>(thread_id, time_source_, wd_interval);
-  WatchedDog watched_dog;
-  watched_dog.dog_ = new_watchdog;
+  WatchedDogSharedPtr watched_dog(new WatchedDog(stats_scope_, new_watchdog));
   {
     std::lock_guard<std::mutex> guard(wd_lock_);
-    watched_dogs_.push_back(watched_dog);
+    std::vector<WatchedDogSharedPtr> new_list(*std::atomic_load(&watched_dogs_));
+    new_list.push_back(watched_dog);
+    std::atomic_store(&watched_dogs_, std::make_shared<const std::vector<WatchedDogSharedPtr>>(
+                                          std::move(new_list)));
   }
   new_watchdog->touch();
   return new_watchdog;
@@ -98,10 +131,14 @@ WatchDogSharedPtr GuardDogImpl::createWatchDog(int32_t thread_id) {
 
 void GuardDogImpl::stopWatching(WatchDogSharedPtr wd) {
   std::lock_guard<std::mutex> guard(wd_lock_);
-  auto found_wd = std::find_if(watched_dogs_.begin(), watched_dogs_.end(),
-                               [&wd](const WatchedDog& d) -> bool { return d.dog_ == wd; });
-  if (found_wd != watched_dogs_.end()) {
-    watched_dogs_.erase(found_wd);
+  std::vector<WatchedDogSharedPtr> new_list(*std::atomic_load(&watched_dogs_));
+  auto found_wd =
+      std::find_if(new_list.begin(), new_list.end(),
+                   [&wd](const WatchedDogSharedPtr& d) -> bool { return d->dog_ == wd; });
+  if (found_wd != new_list.end()) {
+    new_list.erase(found_wd);
+    std::atomic_store(&watched_dogs_, std::make_shared<const std::vector<WatchedDogSharedPtr>>(
+                                          std::move(new_list)));
   } else {
     ASSERT(false);
   }
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -25,6 +26,10 @@ namespace Server {
  * intervals.  If it finds starved threads or suspected deadlocks it will take
  * the appropriate action depending on the config parameters described below.
  *
+ * Since the thread wakes up periodically anyway and is not latency sensitive,
+ * it also returns free heap pages to the OS at a fixed interval and publishes
+ * page heap gauges, so RSS tracks actual usage after traffic spikes.
+ *
  * Thread lifetime is tied to GuardDog object lifetime (RAII style).
  */
 class GuardDogImpl : public GuardDog {
@@ -68,21 +73,38 @@ private:
   bool multikillEnabled() const { return multi_kill_timeout_ > std::chrono::milliseconds(0); }
 
   struct WatchedDog {
-    WatchDogSharedPtr dog_;
+    WatchedDog(Stats::Scope& stats_scope, const WatchDogSharedPtr& dog);
+
+    const WatchDogSharedPtr dog_;
+    // Per thread miss counters allow alerting on a specific stuck worker rather than just the
+    // process level totals.
+    Stats::Counter& miss_counter_;
+    Stats::Counter& megamiss_counter_;
     Optional<MonotonicTime> last_alert_time_;
     bool miss_alerted_{};
     bool megamiss_alerted_{};
   };
 
+  typedef std::shared_ptr<WatchedDog> WatchedDogSharedPtr;
+  typedef std::shared_ptr<const std::vector<WatchedDogSharedPtr>> WatchedDogListSharedPtr;
+
   MonotonicTimeSource& time_source_;
   const std::chrono::milliseconds miss_timeout_;
   const std::chrono::milliseconds megamiss_timeout_;
   const std::chrono::milliseconds kill_timeout_;
   const std::chrono::milliseconds multi_kill_timeout_;
   const std::chrono::milliseconds loop_interval_;
+  const std::chrono::milliseconds memory_release_interval_;
   Stats::Counter& watchdog_miss_counter_;
   Stats::Counter& watchdog_megamiss_counter_;
-  std::vector<WatchedDog> watched_dogs_;
+  Stats::Gauge& memory_pageheap_free_gauge_;
+  Stats::Gauge& memory_pageheap_unmapped_gauge_;
+  MonotonicTime last_memory_release_;
+  Stats::Scope& stats_scope_;
+  // The watched dog list is published copy on write: createWatchDog() and stopWatching() build a
+  // new list under wd_lock_ and swap it in with an atomic store, so the guard thread scans a
+  // consistent snapshot without ever taking a lock.
+  WatchedDogListSharedPtr watched_dogs_;
   std::mutex wd_lock_;
   Thread::ThreadPtr thread_;
   std::mutex exit_lock_;
@@ -1,11 +1,13 @@
 #include "server/hot_restart_impl.h"
 
 #include <signal.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/prctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <unistd.h>
 
 #include <cstdint>
 #include <string>
@@ -15,6 +17,7 @@
 #include "envoy/server/instance.h"
 #include "envoy/server/options.h"
 
+#include "common/common/hash.h"
 #include "common/common/utility.h"
 #include "common/network/utility.h"
 
@@ -25,7 +28,51 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 8;
+const uint64_t SharedMemory::VERSION = 12;
+
+Stats::SymbolTable::Symbol ShmemSymbolTable::intern(const std::string& segment) {
+  if (segment.size() > SharedSymbolTableData::MAX_SEGMENT_SIZE) {
+    // Storing the segment truncated would be worse than failing: find() compares against the
+    // full string so a truncated entry never matches, and every allocation of such a stat would
+    // append another duplicate until the table fills. Fail the intern and let the stat fall back
+    // to the heap allocator.
+    return 0;
+  }
+
+  const Symbol existing = find(segment);
+  if (existing != 0) {
+    return existing;
+  }
+
+  const uint32_t size = data_.size_.load(std::memory_order_acquire);
+  if (size == SharedSymbolTableData::MAX_SYMBOLS) {
+    return 0;
+  }
+
+  // Write the segment before publishing the new size so lock free readers never see a
+  // partially written entry.
+  StringUtil::strlcpy(data_.entries_[size].segment_, segment.c_str(),
+                      SharedSymbolTableData::MAX_SEGMENT_SIZE + 1);
+  data_.size_.store(size + 1, std::memory_order_release);
+  return size + 1;
+}
+
+Stats::SymbolTable::Symbol ShmemSymbolTable::find(const std::string& segment) const {
+  // Interning only happens at stat allocation time under the shared stat lock, so a linear
+  // scan is acceptable here.
+  const uint32_t size = data_.size_.load(std::memory_order_acquire);
+  for (uint32_t i = 0; i < size; i++) {
+    if (0 == strcmp(segment.c_str(), data_.entries_[i].segment_)) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+std::string ShmemSymbolTable::segment(Symbol symbol) const {
+  ASSERT(symbol != 0 && symbol <= data_.size_.load(std::memory_order_acquire));
+  return data_.entries_[symbol - 1].segment_;
+}
 
 SharedMemory& SharedMemory::initialize(Options& options) {
   int flags = O_RDWR;
@@ -60,6 +107,15 @@ SharedMemory& SharedMemory::initialize(Options& options) {
     shmem->initializeMutex(shmem->access_log_lock_);
     shmem->initializeMutex(shmem->stat_lock_);
     shmem->initializeMutex(shmem->init_lock_);
+
+    // Thread every stat slot onto the free list. The hash buckets start out empty, which the
+    // zero filled fresh region already encodes. On hot restart the structures carry over from
+    // the parent and stay consistent because all mutation happens under stat_lock_.
+    shmem->stats_free_head_ = 1;
+    for (uint32_t i = 0; i < NUM_STAT_SLOTS - 1; i++) {
+      shmem->stats_next_[i] = i + 2;
+    }
+    shmem->stats_next_[NUM_STAT_SLOTS - 1] = 0;
   } else {
     RELEASE_ASSERT(shmem->size_ == sizeof(SharedMemory));
     RELEASE_ASSERT(shmem->version_ == VERSION);
@@ -89,10 +145,18 @@ void SharedMemory::initializeMutex(pthread_mutex_t& mutex) {
 std::string SharedMemory::version() { return fmt::format("{}.{}", VERSION, sizeof(SharedMemory)); }
 
 HotRestartImpl::HotRestartImpl(Options& options)
-    : options_(options), shmem_(SharedMemory::initialize(options)), log_lock_(shmem_.log_lock_),
+    : options_(options), shmem_(SharedMemory::initialize(options)),
+      symbol_table_(shmem_.symbol_table_data_), log_lock_(shmem_.log_lock_),
       access_log_lock_(shmem_.access_log_lock_), stat_lock_(shmem_.stat_lock_),
       init_lock_(shmem_.init_lock_) {
 
+  // Our stats snapshot slot may carry data from a long dead process that was assigned the same
+  // slot, so clear it before a child can observe it.
+  SharedMemory::ProcessStatsSnapshot& snapshot =
+      shmem_.process_stats_[options.restartEpoch() % SharedMemory::MAX_CONCURRENT_PROCESSES];
+  snapshot.memory_allocated_.store(0, std::memory_order_relaxed);
+  snapshot.num_connections_.store(0, std::memory_order_relaxed);
+
   my_domain_socket_ = bindDomainSocket(options.restartEpoch());
   child_address_ = createDomainSocketAddress((options.restartEpoch() + 1));
   if (options.restartEpoch() != 0) {
@@ -107,19 +171,41 @@ HotRestartImpl::HotRestartImpl(Options& options)
 }
 
 Stats::RawStatData* HotRestartImpl::alloc(const std::string& name) {
-  // Try to find the existing slot in shared memory, otherwise allocate a new one.
+  // NOTE: xxHash64 is used instead of std::hash so the bucket for a given name is the same in
+  //       the parent and child processes across a hot restart even if they were built with
+  //       different standard libraries.
+  const uint32_t bucket = HashUtil::xxHash64(name) % SharedMemory::NUM_STAT_BUCKETS;
   std::unique_lock<Thread::BasicLockable> lock(stat_lock_);
-  for (Stats::RawStatData& data : shmem_.stats_slots_) {
-    if (!data.initialized()) {
-      data.initialize(name);
-      return &data;
-    } else if (data.matches(name)) {
+
+  // Walk the bucket's hash chain looking for an existing slot with the same name.
+  for (uint32_t index = shmem_.stats_buckets_[bucket]; index != 0;
+       index = shmem_.stats_next_[index - 1]) {
+    Stats::RawStatData& data = shmem_.stats_slots_[index - 1];
+    if (data.matches(name, symbol_table_)) {
       data.ref_count_++;
       return &data;
     }
   }
 
-  return nullptr;
+  // No match. Pop a slot off the free list and link it into the bucket's chain.
+  const uint32_t index = shmem_.stats_free_head_;
+  if (index == 0) {
+    return nullptr;
+  }
+  shmem_.stats_free_head_ = shmem_.stats_next_[index - 1];
+  Stats::RawStatData& data = shmem_.stats_slots_[index - 1];
+  ASSERT(!data.initialized());
+  if (!data.initialize(name, symbol_table_)) {
+    // The symbol table is exhausted or rejected a segment. Return the slot to the free list and
+    // fail the allocation so the stat degrades to the heap allocator, the same way slot
+    // exhaustion does above.
+    shmem_.stats_next_[index - 1] = shmem_.stats_free_head_;
+    shmem_.stats_free_head_ = index;
+    return nullptr;
+  }
+  shmem_.stats_next_[index - 1] = shmem_.stats_buckets_[bucket];
+  shmem_.stats_buckets_[bucket] = index;
+  return &data;
 }
 
 void HotRestartImpl::free(Stats::RawStatData& data) {
@@ -130,7 +216,21 @@ void HotRestartImpl::free(Stats::RawStatData& data) {
     return;
   }
 
+  // Unlink the slot from its hash chain and return it to the free list. The name (and thus the
+  // bucket) must be resolved before the slot is cleared.
+  const uint32_t index = (&data - shmem_.stats_slots_.data()) + 1;
+  const uint32_t bucket =
+      HashUtil::xxHash64(data.name(symbol_table_)) % SharedMemory::NUM_STAT_BUCKETS;
+  uint32_t* link = &shmem_.stats_buckets_[bucket];
+  while (*link != index) {
+    ASSERT(*link != 0);
+    link = &shmem_.stats_next_[*link - 1];
+  }
+  *link = shmem_.stats_next_[index - 1];
+
   memset(&data, 0, sizeof(Stats::RawStatData));
+  shmem_.stats_next_[index - 1] = shmem_.stats_free_head_;
+  shmem_.stats_free_head_ = index;
 }
 
 int HotRestartImpl::bindDomainSocket(uint64_t id) {
@@ -148,10 +248,7 @@ int HotRestartImpl::bindDomainSocket(uint64_t id) {
 }
 
 sockaddr_un HotRestartImpl::createDomainSocketAddress(uint64_t id) {
-  // Right now we only allow a maximum of 3 concurrent envoy processes to be running. When the third
-  // stats up it will kill the oldest parent.
-  const uint64_t MAX_CONCURRENT_PROCESSES = 3;
-  id = id % MAX_CONCURRENT_PROCESSES;
+  id = id % SharedMemory::MAX_CONCURRENT_PROCESSES;
 
   // This creates an anonymous domain socket name (where the first byte of the name of \0).
   sockaddr_un address;
@@ -190,35 +287,28 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
 }
 
 void HotRestartImpl::getParentStats(GetParentStatsInfo& info) {
-  // There exists a race condition during hot restart involving fetching parent stats. It looks like
-  // this:
-  // 1) There currently exist 2 Envoy processes (draining has not completed): P0 and P1.
-  // 2) New process (P2) comes up and passes the INITIALIZING check.
-  // 3) P2 proceeds to the parent admin shutdown phase.
-  // 4) This races with P1 fetching parent stats from P0.
-  // 5) Calling receiveTypedRpc() below picks up the wrong message.
-  //
-  // There are not any great solutions to this problem. We could potentially guard this using flags,
-  // but this is a legitimate race condition even under normal restart conditions, so exiting P2
-  // with an error is not great. We could also rework all of this code so that P0<->P1 and P1<->P2
-  // communication occur over different socket pairs. This could work, but is a large change. We
-  // could also potentially use connection oriented sockets and accept connections from our child,
-  // and connect to our parent, but again, this becomes complicated.
-  //
-  // Instead, we guard this condition with a lock. However, to avoid deadlock, we must try_lock()
-  // in this path, since this call runs in the same thread as the event loop that is receiving
-  // messages. If try_lock() fails it is sufficient to not return any parent stats.
-  std::unique_lock<Thread::BasicLockable> lock(init_lock_, std::defer_lock);
+  // The server calls this on every stat flush, so use it to also refresh our own snapshot in
+  // shared memory. A child (if any) merges the snapshot below instead of both processes paying
+  // a blocking RPC round trip over the domain socket on each flush during the restart overlap.
+  if (server_ != nullptr) {
+    GetParentStatsInfo our_info;
+    server_->getParentStats(our_info);
+    SharedMemory::ProcessStatsSnapshot& our_snapshot =
+        shmem_.process_stats_[options_.restartEpoch() % SharedMemory::MAX_CONCURRENT_PROCESSES];
+    our_snapshot.memory_allocated_.store(our_info.memory_allocated_, std::memory_order_relaxed);
+    our_snapshot.num_connections_.store(our_info.num_connections_, std::memory_order_relaxed);
+  }
+
   memset(&info, 0, sizeof(info));
-  if (options_.restartEpoch() == 0 || parent_terminated_ || !lock.try_lock()) {
+  if (options_.restartEpoch() == 0 || parent_terminated_) {
     return;
   }
 
-  RpcBase rpc(RpcMessageType::GetStatsRequest);
-  sendMessage(parent_address_, rpc);
-  RpcGetStatsReply* reply = receiveTypedRpc<RpcGetStatsReply, RpcMessageType::GetStatsReply>();
-  info.memory_allocated_ = reply->memory_allocated_;
-  info.num_connections_ = reply->num_connections_;
+  SharedMemory::ProcessStatsSnapshot& parent_snapshot =
+      shmem_.process_stats_[(options_.restartEpoch() - 1) %
+                            SharedMemory::MAX_CONCURRENT_PROCESSES];
+  info.memory_allocated_ = parent_snapshot.memory_allocated_.load(std::memory_order_relaxed);
+  info.num_connections_ = parent_snapshot.num_connections_.load(std::memory_order_relaxed);
 }
 
 void HotRestartImpl::initialize(Event::Dispatcher& dispatcher, Server::Instance& server) {
@@ -274,9 +364,9 @@ HotRestartImpl::RpcBase* HotRestartImpl::receiveRpc(bool block) {
   RpcBase* rpc = reinterpret_cast<RpcBase*>(&rpc_buffer_[0]);
   RELEASE_ASSERT(static_cast<uint64_t>(rc) == rpc->length_);
 
-  // We should only get control data in a GetListenSocketReply. If that's the case, pull the
-  // cloned fd out of the control data and stick it into the RPC so that higher level code does
-  // need to deal with any of this.
+  // We should only get control data in a GetListenSocketReply or a PassConnectionMessage. If
+  // that's the case, pull the cloned fd out of the control data and stick it into the RPC so that
+  // higher level code does not need to deal with any of this.
   for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
        cmsg = CMSG_NXTHDR(&message, cmsg)) {
 
@@ -285,6 +375,11 @@ HotRestartImpl::RpcBase* HotRestartImpl::receiveRpc(bool block) {
 
       reinterpret_cast<RpcGetListenSocketReply*>(rpc)->fd_ =
           *reinterpret_cast<int*>(CMSG_DATA(cmsg));
+    } else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+               rpc->type_ == RpcMessageType::PassConnectionMessage) {
+
+      reinterpret_cast<RpcPassConnectionMessage*>(rpc)->fd_ =
+          *reinterpret_cast<int*>(CMSG_DATA(cmsg));
     } else {
       RELEASE_ASSERT(false);
     }
@@ -309,6 +404,32 @@ void HotRestartImpl::sendMessage(sockaddr_un& address, RpcBase& rpc) {
   UNREFERENCED_PARAMETER(rc);
 }
 
+bool HotRestartImpl::sendFdMessage(sockaddr_un& address, RpcBase& rpc, int fd) {
+  iovec iov[1];
+  iov[0].iov_base = &rpc;
+  iov[0].iov_len = rpc.length_;
+
+  uint8_t control_buffer[CMSG_SPACE(sizeof(int))];
+  memset(control_buffer, 0, CMSG_SPACE(sizeof(int)));
+
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_name = &address;
+  message.msg_namelen = sizeof(address);
+  message.msg_iov = iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control_buffer;
+  message.msg_controllen = CMSG_SPACE(sizeof(int));
+
+  cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+  control_message->cmsg_level = SOL_SOCKET;
+  control_message->cmsg_type = SCM_RIGHTS;
+  control_message->cmsg_len = CMSG_LEN(sizeof(int));
+  *reinterpret_cast<int*>(CMSG_DATA(control_message)) = fd;
+
+  return sendmsg(my_domain_socket_, &message, 0) != -1;
+}
+
 void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
   RpcGetListenSocketReply reply;
   reply.fd_ = -1;
@@ -326,31 +447,47 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
     // In this case there is no fd to duplicate so we just send a normal message.
     sendMessage(child_address_, reply);
   } else {
-    iovec iov[1];
-    iov[0].iov_base = &reply;
-    iov[0].iov_len = reply.length_;
-
-    uint8_t control_buffer[CMSG_SPACE(sizeof(int))];
-    memset(control_buffer, 0, CMSG_SPACE(sizeof(int)));
-
-    msghdr message;
-    memset(&message, 0, sizeof(message));
-    message.msg_name = &child_address_;
-    message.msg_namelen = sizeof(child_address_);
-    message.msg_iov = iov;
-    message.msg_iovlen = 1;
-    message.msg_control = control_buffer;
-    message.msg_controllen = CMSG_SPACE(sizeof(int));
-
-    cmsghdr* control_message = CMSG_FIRSTHDR(&message);
-    control_message->cmsg_level = SOL_SOCKET;
-    control_message->cmsg_type = SCM_RIGHTS;
-    control_message->cmsg_len = CMSG_LEN(sizeof(int));
-    *reinterpret_cast<int*>(CMSG_DATA(control_message)) = reply.fd_;
-
-    int rc = sendmsg(my_domain_socket_, &message, 0);
-    RELEASE_ASSERT(rc != -1);
-    UNREFERENCED_PARAMETER(rc);
+    const bool sent = sendFdMessage(child_address_, reply, reply.fd_);
+    RELEASE_ASSERT(sent);
+    UNREFERENCED_PARAMETER(sent);
+  }
+}
+
+bool HotRestartImpl::passConnection(int fd, const std::string& local_address,
+                                    const std::string& remote_address) {
+  // Until the child asks us to terminate there is no child guaranteed to be initialized and
+  // listening for passed connections.
+  if (!child_requested_terminate_) {
+    return false;
+  }
+
+  RpcPassConnectionMessage rpc;
+  if (local_address.size() >= sizeof(rpc.local_address_) ||
+      remote_address.size() >= sizeof(rpc.remote_address_)) {
+    return false;
+  }
+
+  StringUtil::strlcpy(rpc.local_address_, local_address.c_str(), sizeof(rpc.local_address_));
+  StringUtil::strlcpy(rpc.remote_address_, remote_address.c_str(), sizeof(rpc.remote_address_));
+
+  // Unlike the request/reply RPCs this is best effort: if the child has died in the window since
+  // it asked us to terminate we just close the connection like we would have anyway.
+  return sendFdMessage(child_address_, rpc, fd);
+}
+
+void HotRestartImpl::onPassConnection(RpcPassConnectionMessage& rpc) {
+  if (rpc.fd_ == -1) {
+    return;
+  }
+
+  Network::Address::InstanceConstSharedPtr local_address =
+      Network::Utility::resolveUrl(std::string(rpc.local_address_));
+  Network::Address::InstanceConstSharedPtr remote_address =
+      Network::Utility::resolveUrl(std::string(rpc.remote_address_));
+  if (!server_->listenerManager().adoptPassedConnection(rpc.fd_, local_address, remote_address)) {
+    ENVOY_LOG(debug, "no listener for connection passed from parent ({}), closing",
+              rpc.local_address_);
+    close(rpc.fd_);
   }
 }
 
@@ -377,23 +514,22 @@ void HotRestartImpl::onSocketEvent() {
       break;
     }
 
-    case RpcMessageType::GetStatsRequest: {
-      GetParentStatsInfo info;
-      server_->getParentStats(info);
-      RpcGetStatsReply rpc;
-      rpc.memory_allocated_ = info.memory_allocated_;
-      rpc.num_connections_ = info.num_connections_;
-      sendMessage(child_address_, rpc);
+    case RpcMessageType::DrainListenersRequest: {
+      server_->drainListeners();
       break;
     }
 
-    case RpcMessageType::DrainListenersRequest: {
-      server_->drainListeners();
+    case RpcMessageType::PassConnectionMessage: {
+      RpcPassConnectionMessage* message = reinterpret_cast<RpcPassConnectionMessage*>(base_message);
+      onPassConnection(*message);
       break;
     }
 
     case RpcMessageType::TerminateRequest: {
       ENVOY_LOG(warn, "shutting down due to child request");
+      // From this point on our child is ready to adopt any connections we pass to it while
+      // shutting down.
+      child_requested_terminate_ = true;
       kill(getpid(), SIGTERM);
       break;
     }
@@ -408,7 +544,10 @@ void HotRestartImpl::onSocketEvent() {
 }
 
 void HotRestartImpl::shutdownParentAdmin(ShutdownParentAdminInfo& info) {
-  // See large comment in getParentStats() on why this operation is locked.
+  // All processes share a small set of domain sockets, so if P2 comes up while P0 and P1 are
+  // still draining, an RPC reply bound for P1 could be picked up by the wrong receiveTypedRpc()
+  // call. Serializing the blocking request/reply exchanges with this lock avoids that. This runs
+  // once at startup, so blocking on the lock is acceptable here.
   std::unique_lock<Thread::BasicLockable> lock(init_lock_);
   if (options_.restartEpoch() == 0) {
     return;
@@ -17,6 +17,41 @@
 namespace Envoy {
 namespace Server {
 
+/**
+ * Backing storage for the shared memory symbol table. This is a POD laid directly into shared
+ * memory (it must not have a vtable), wrapped by ShmemSymbolTable below. Entries are append
+ * only: segments are written before size_ is incremented, so readers may resolve symbols
+ * without holding the stat lock. intern() must be called under the shared stat lock.
+ */
+struct SharedSymbolTableData {
+  static const uint32_t MAX_SYMBOLS = 8192;
+  static const size_t MAX_SEGMENT_SIZE = 63;
+
+  struct Entry {
+    char segment_[MAX_SEGMENT_SIZE + 1];
+  };
+
+  std::atomic<uint32_t> size_;
+  std::array<Entry, MAX_SYMBOLS> entries_;
+};
+
+/**
+ * A Stats::SymbolTable that resolves against SharedSymbolTableData, so stat name symbols mean
+ * the same thing in the parent and child across a hot restart.
+ */
+class ShmemSymbolTable : public Stats::SymbolTable {
+public:
+  ShmemSymbolTable(SharedSymbolTableData& data) : data_(data) {}
+
+  // Stats::SymbolTable
+  Symbol intern(const std::string& segment) override;
+  Symbol find(const std::string& segment) const override;
+  std::string segment(Symbol symbol) const override;
+
+private:
+  SharedSymbolTableData& data_;
+};
+
 /**
  * Shared memory segment. This structure is laid directly into shared memory and is used amongst
  * all running envoy processes.
@@ -44,6 +79,21 @@ private:
   void initializeMutex(pthread_mutex_t& mutex);
 
   static const uint64_t VERSION;
+  static const uint32_t NUM_STAT_SLOTS = 16384;
+  // Bucket count for the stat hash index. Prime to spread the slot hashes evenly.
+  static const uint32_t NUM_STAT_BUCKETS = 16381;
+  // Right now we only allow a maximum of 3 concurrent envoy processes to be running. When the
+  // third starts up it will kill the oldest parent.
+  static const uint64_t MAX_CONCURRENT_PROCESSES = 3;
+
+  // Per process snapshot of the stats a child merges from its parent during the hot restart
+  // overlap (see HotRestartImpl::getParentStats()). Each process refreshes its own slot on every
+  // stat flush and a child reads its parent's slot directly, instead of both processes doing a
+  // blocking RPC round trip over the domain socket every flush interval.
+  struct ProcessStatsSnapshot {
+    std::atomic<uint64_t> memory_allocated_;
+    std::atomic<uint64_t> num_connections_;
+  };
 
   uint64_t size_;
   uint64_t version_;
@@ -52,7 +102,17 @@ private:
   pthread_mutex_t access_log_lock_;
   pthread_mutex_t stat_lock_;
   pthread_mutex_t init_lock_;
-  std::array<Stats::RawStatData, 16384> stats_slots_;
+  SharedSymbolTableData symbol_table_data_;
+  // Free list and hash index over stats_slots_, all mutated under stat_lock_ (see
+  // HotRestartImpl::alloc()). Values are slot indices offset by one so that the zero filled
+  // fresh shared memory region reads as empty buckets / end of chain. stats_next_[i] chains
+  // slot i into either its hash bucket (when allocated) or the free list (when free).
+  uint32_t stats_free_head_;
+  std::array<uint32_t, NUM_STAT_SLOTS> stats_next_;
+  std::array<uint32_t, NUM_STAT_BUCKETS> stats_buckets_;
+  std::array<Stats::RawStatData, NUM_STAT_SLOTS> stats_slots_;
+  // Indexed by restart epoch modulo MAX_CONCURRENT_PROCESSES.
+  std::array<ProcessStatsSnapshot, MAX_CONCURRENT_PROCESSES> process_stats_;
 
   friend class HotRestartImpl;
 };
@@ -116,6 +176,8 @@ public:
   int duplicateParentListenSocket(const std::string& address) override;
   void getParentStats(GetParentStatsInfo& info) override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
+  bool passConnection(int fd, const std::string& local_address,
+                      const std::string& remote_address) override;
   void shutdownParentAdmin(ShutdownParentAdminInfo& info) override;
   void terminateParent() override;
   void shutdown() override;
@@ -124,6 +186,7 @@ public:
   // RawStatDataAllocator
   Stats::RawStatData* alloc(const std::string& name) override;
   void free(Stats::RawStatData& data) override;
+  Stats::SymbolTable& symbolTable() override { return symbol_table_; }
 
 private:
   enum class RpcMessageType {
@@ -134,8 +197,7 @@ private:
     ShutdownAdminReply = 5,
     TerminateRequest = 6,
     UnknownRequestReply = 7,
-    GetStatsRequest = 8,
-    GetStatsReply = 9
+    PassConnectionMessage = 10
   };
 
   struct RpcBase {
@@ -164,12 +226,14 @@ private:
     uint64_t original_start_time_{0};
   } __attribute__((packed));
 
-  struct RpcGetStatsReply : public RpcBase {
-    RpcGetStatsReply() : RpcBase(RpcMessageType::GetStatsReply, sizeof(*this)) {}
+  // Parent to child, no reply expected. The socket rides along in SCM_RIGHTS control data and
+  // receiveRpc() fills in fd_ with the local duplicate.
+  struct RpcPassConnectionMessage : public RpcBase {
+    RpcPassConnectionMessage() : RpcBase(RpcMessageType::PassConnectionMessage, sizeof(*this)) {}
 
-    uint64_t memory_allocated_{0};
-    uint64_t num_connections_{0};
-    uint64_t unused_[16]{0};
+    int fd_{-1};
+    char local_address_[256]{0};
+    char remote_address_[256]{0};
   } __attribute__((packed));
 
   template <class rpc_class, RpcMessageType rpc_type> rpc_class* receiveTypedRpc() {
@@ -182,12 +246,15 @@ private:
   int bindDomainSocket(uint64_t id);
   sockaddr_un createDomainSocketAddress(uint64_t id);
   void onGetListenSocket(RpcGetListenSocketRequest& rpc);
+  void onPassConnection(RpcPassConnectionMessage& rpc);
   void onSocketEvent();
   RpcBase* receiveRpc(bool block);
   void sendMessage(sockaddr_un& address, RpcBase& rpc);
+  bool sendFdMessage(sockaddr_un& address, RpcBase& rpc, int fd);
 
   Options& options_;
   SharedMemory& shmem_;
+  ShmemSymbolTable symbol_table_;
   ProcessSharedMutex log_lock_;
   ProcessSharedMutex access_log_lock_;
   ProcessSharedMutex stat_lock_;
@@ -199,6 +266,9 @@ private:
   std::array<uint8_t, 4096> rpc_buffer_;
   Server::Instance* server_{};
   bool parent_terminated_{};
+  // Set on the main thread when our child asks us to terminate; read by worker threads deciding
+  // whether there is a child to pass connections to.
+  std::atomic<bool> child_requested_terminate_{};
 };
 
 } // namespace Server
@@ -18,6 +18,7 @@ public:
   int duplicateParentListenSocket(const std::string&) override { return -1; }
   void getParentStats(GetParentStatsInfo& info) override { memset(&info, 0, sizeof(info)); }
   void initialize(Event::Dispatcher&, Server::Instance&) override {}
+  bool passConnection(int, const std::string&, const std::string&) override { return false; }
   void shutdownParentAdmin(ShutdownParentAdminInfo&) override {}
   void terminateParent() override {}
   void shutdown() override {}
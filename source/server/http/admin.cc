@@ -1,10 +1,17 @@
 #include "server/http/admin.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstdint>
 #include <fstream>
+#include <regex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "envoy/common/optional.h"
 #include "envoy/filesystem/filesystem.h"
 #include "envoy/server/hot_restart.h"
 #include "envoy/server/instance.h"
@@ -16,14 +23,17 @@
 #include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
+#include "common/common/thread.h"
 #include "common/common/utility.h"
 #include "common/common/version.h"
+#include "common/filesystem/filesystem_impl.h"
 #include "common/http/access_log/access_log_formatter.h"
 #include "common/http/access_log/access_log_impl.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 #include "common/http/http1/codec_impl.h"
+#include "common/http/utility.h"
 #include "common/json/json_loader.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/profiler/profiler.h"
@@ -35,6 +45,45 @@
 
 namespace Envoy {
 namespace Server {
+namespace {
+
+// Accumulating output lines into a chunk of roughly this size before appending to the response
+// buffer keeps the buffer from taking one small append (and potentially one slice) per line. The
+// same size bounds each write of the chunk streamed /clusters and /certs responses.
+const uint64_t ResponseChunkSize = 65536;
+
+void flushChunk(std::string& chunk, Buffer::Instance& response) {
+  response.add(chunk);
+  chunk.clear();
+}
+
+// Returns whether a stat passes the optional /stats query narrowing. Filtering on the raw name
+// before sorting and formatting means a scoped query only pays for the entries it returns.
+bool shouldShowStat(const std::string& name, bool used, bool used_only, const std::string& prefix,
+                    const Optional<std::regex>& regex) {
+  if (used_only && !used) {
+    return false;
+  }
+
+  if (!prefix.empty() && name.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+
+  if (regex.valid() && !std::regex_search(name, regex.value())) {
+    return false;
+  }
+
+  return true;
+}
+
+std::string prometheusSanitizedName(const std::string& name) {
+  std::string stat_name = name;
+  std::replace_if(stat_name.begin(), stat_name.end(),
+                  [](char c) { return !isalnum(static_cast<unsigned char>(c)) && c != ':'; }, '_');
+  return "envoy_" + stat_name;
+}
+
+} // namespace
 
 AdminFilter::AdminFilter(AdminImpl& parent) : parent_(parent) {}
 
@@ -107,44 +156,77 @@ bool AdminImpl::changeLogLevel(const Http::Utility::QueryParams& params) {
   return true;
 }
 
-void AdminImpl::addOutlierInfo(const std::string& cluster_name,
-                               const Upstream::Outlier::Detector* outlier_detector,
-                               Buffer::Instance& response) {
-  if (outlier_detector) {
-    response.add(fmt::format("{}::outlier::success_rate_average::{}\n", cluster_name,
-                             outlier_detector->successRateAverage()));
-    response.add(fmt::format("{}::outlier::success_rate_ejection_threshold::{}\n", cluster_name,
-                             outlier_detector->successRateEjectionThreshold()));
+namespace {
+
+/**
+ * Streams /clusters output roughly one response chunk at a time. Cluster names are snapshotted up
+ * front and re-looked-up per chunk, so clusters added or removed while the response is in flight
+ * are simply skipped or missed rather than invalidating the cursor.
+ */
+class ClustersChunkedHandler : public AdminImpl::ChunkedHandler {
+public:
+  ClustersChunkedHandler(Server::Instance& server) : server_(server) {
+    for (auto& cluster : server_.clusterManager().clusters()) {
+      cluster_names_.push_back(cluster.first);
+    }
   }
-}
 
-void AdminImpl::addCircuitSettings(const std::string& cluster_name, const std::string& priority_str,
-                                   Upstream::ResourceManager& resource_manager,
-                                   Buffer::Instance& response) {
-  response.add(fmt::format("{}::{}_priority::max_connections::{}\n", cluster_name, priority_str,
-                           resource_manager.connections().max()));
-  response.add(fmt::format("{}::{}_priority::max_pending_requests::{}\n", cluster_name,
-                           priority_str, resource_manager.pendingRequests().max()));
-  response.add(fmt::format("{}::{}_priority::max_requests::{}\n", cluster_name, priority_str,
-                           resource_manager.requests().max()));
-  response.add(fmt::format("{}::{}_priority::max_retries::{}\n", cluster_name, priority_str,
-                           resource_manager.retries().max()));
-}
+  // AdminImpl::ChunkedHandler
+  bool nextChunk(Buffer::Instance& chunk) override {
+    uint64_t added = 0;
+    while (next_cluster_ < cluster_names_.size() && added < ResponseChunkSize) {
+      added += addCluster(cluster_names_[next_cluster_++], chunk);
+    }
+    return next_cluster_ < cluster_names_.size();
+  }
 
-Http::Code AdminImpl::handlerClusters(const std::string&, Buffer::Instance& response) {
-  for (auto& cluster : server_.clusterManager().clusters()) {
-    addOutlierInfo(cluster.second.get().info()->name(), cluster.second.get().outlierDetector(),
-                   response);
-
-    addCircuitSettings(
-        cluster.second.get().info()->name(), "default",
-        cluster.second.get().info()->resourceManager(Upstream::ResourcePriority::Default),
-        response);
-    addCircuitSettings(
-        cluster.second.get().info()->name(), "high",
-        cluster.second.get().info()->resourceManager(Upstream::ResourcePriority::High), response);
-
-    for (auto& host : cluster.second.get().hosts()) {
+private:
+  void addOutlierInfo(const std::string& cluster_name,
+                      const Upstream::Outlier::Detector* outlier_detector,
+                      Buffer::Instance& response) {
+    if (outlier_detector) {
+      response.add(fmt::format("{}::outlier::success_rate_average::{}\n", cluster_name,
+                               outlier_detector->successRateAverage()));
+      response.add(fmt::format("{}::outlier::success_rate_ejection_threshold::{}\n", cluster_name,
+                               outlier_detector->successRateEjectionThreshold()));
+    }
+  }
+
+  void addCircuitSettings(const std::string& cluster_name, const std::string& priority_str,
+                          Upstream::ResourceManager& resource_manager,
+                          Buffer::Instance& response) {
+    response.add(fmt::format("{}::{}_priority::max_connections::{}\n", cluster_name, priority_str,
+                             resource_manager.connections().max()));
+    response.add(fmt::format("{}::{}_priority::max_pending_requests::{}\n", cluster_name,
+                             priority_str, resource_manager.pendingRequests().max()));
+    response.add(fmt::format("{}::{}_priority::max_requests::{}\n", cluster_name, priority_str,
+                             resource_manager.requests().max()));
+    response.add(fmt::format("{}::{}_priority::max_retries::{}\n", cluster_name, priority_str,
+                             resource_manager.retries().max()));
+  }
+
+  /**
+   * Appends one cluster's full output.
+   * @return the number of bytes appended, or 0 if the cluster no longer exists.
+   */
+  uint64_t addCluster(const std::string& name, Buffer::Instance& response) {
+    auto clusters = server_.clusterManager().clusters();
+    auto entry = clusters.find(name);
+    if (entry == clusters.end()) {
+      return 0;
+    }
+
+    const uint64_t start_length = response.length();
+    auto& cluster = entry->second.get();
+    addOutlierInfo(cluster.info()->name(), cluster.outlierDetector(), response);
+
+    addCircuitSettings(cluster.info()->name(), "default",
+                       cluster.info()->resourceManager(Upstream::ResourcePriority::Default),
+                       response);
+    addCircuitSettings(cluster.info()->name(), "high",
+                       cluster.info()->resourceManager(Upstream::ResourcePriority::High), response);
+
+    for (auto& host : cluster.hosts()) {
       std::map<std::string, uint64_t> all_stats;
       for (const Stats::CounterSharedPtr& counter : host->counters()) {
         all_stats[counter->name()] = counter->value();
@@ -155,24 +237,82 @@ Http::Code AdminImpl::handlerClusters(const std::string&, Buffer::Instance& resp
       }
 
       for (auto stat : all_stats) {
-        response.add(fmt::format("{}::{}::{}::{}\n", cluster.second.get().info()->name(),
+        response.add(fmt::format("{}::{}::{}::{}\n", cluster.info()->name(),
                                  host->address()->asString(), stat.first, stat.second));
       }
 
-      response.add(fmt::format("{}::{}::health_flags::{}\n", cluster.second.get().info()->name(),
+      response.add(fmt::format("{}::{}::health_flags::{}\n", cluster.info()->name(),
                                host->address()->asString(),
                                Upstream::HostUtility::healthFlagsToString(*host)));
-      response.add(fmt::format("{}::{}::weight::{}\n", cluster.second.get().info()->name(),
+      response.add(fmt::format("{}::{}::weight::{}\n", cluster.info()->name(),
                                host->address()->asString(), host->weight()));
-      response.add(fmt::format("{}::{}::zone::{}\n", cluster.second.get().info()->name(),
+      response.add(fmt::format("{}::{}::zone::{}\n", cluster.info()->name(),
                                host->address()->asString(), host->zone()));
-      response.add(fmt::format("{}::{}::canary::{}\n", cluster.second.get().info()->name(),
+      response.add(fmt::format("{}::{}::canary::{}\n", cluster.info()->name(),
                                host->address()->asString(), host->canary()));
-      response.add(fmt::format("{}::{}::success_rate::{}\n", cluster.second.get().info()->name(),
+      response.add(fmt::format("{}::{}::success_rate::{}\n", cluster.info()->name(),
                                host->address()->asString(), host->outlierDetector().successRate()));
     }
+
+    return response.length() - start_length;
+  }
+
+  Server::Instance& server_;
+  std::vector<std::string> cluster_names_;
+  size_t next_cluster_{};
+};
+
+/**
+ * Streams /certs output. Contexts can be released at any time, so their information is captured
+ * up front and only the write-out is chunked.
+ */
+class CertsChunkedHandler : public AdminImpl::ChunkedHandler {
+public:
+  CertsChunkedHandler(Server::Instance& server) {
+    // This set is used to track distinct certificates. We may have multiple listeners, upstreams,
+    // etc using the same cert.
+    std::unordered_set<std::string> context_info_set;
+    std::string context_format = "{{\n\t\"ca_cert\": \"{}\",\n\t\"cert_chain\": \"{}\"\n}}\n";
+    server.sslContextManager().iterateContexts([&](Ssl::Context& context) -> void {
+      context_info_set.insert(fmt::format(context_format, context.getCaCertInformation(),
+                                          context.getCertChainInformation()));
+    });
+    context_info_.assign(context_info_set.begin(), context_info_set.end());
+  }
+
+  // AdminImpl::ChunkedHandler
+  bool nextChunk(Buffer::Instance& chunk) override {
+    std::string out;
+    out.reserve(ResponseChunkSize);
+    while (next_ < context_info_.size() && out.size() < ResponseChunkSize) {
+      out.append(context_info_[next_++]);
+    }
+    chunk.add(out);
+    return next_ < context_info_.size();
   }
 
+private:
+  std::vector<std::string> context_info_;
+  size_t next_{};
+};
+
+} // namespace
+
+AdminImpl::ChunkedHandlerPtr AdminImpl::makeChunkedHandler(const std::string& path) {
+  if (path.find("/clusters") == 0) {
+    return ChunkedHandlerPtr{new ClustersChunkedHandler(server_)};
+  }
+  if (path.find("/certs") == 0) {
+    return ChunkedHandlerPtr{new CertsChunkedHandler(server_)};
+  }
+  return nullptr;
+}
+
+Http::Code AdminImpl::handlerClusters(const std::string&, Buffer::Instance& response) {
+  // Non-streaming path used by runCallback(); drains every chunk synchronously.
+  ClustersChunkedHandler handler(server_);
+  while (handler.nextChunk(response)) {
+  }
   return Http::Code::OK;
 }
 
@@ -193,6 +333,41 @@ Http::Code AdminImpl::handlerCpuProfiler(const std::string& url, Buffer::Instanc
 
   } else if (!enable && Profiler::Cpu::profilerEnabled()) {
     Profiler::Cpu::stopProfiler();
+
+    // Send the written profile back in the response so it can be captured without access to the
+    // host. If the file cannot be read for some reason just respond OK as before.
+    try {
+      response.add(Filesystem::fileReadToEnd(profile_path_));
+      return Http::Code::OK;
+    } catch (const EnvoyException&) {
+    }
+  }
+
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerHeapProfiler(const std::string& url, Buffer::Instance& response) {
+  Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  if (query_params.size() != 1 || query_params.begin()->first != "enable" ||
+      (query_params.begin()->second != "y" && query_params.begin()->second != "n")) {
+    response.add("?enable=<y|n>\n");
+    return Http::Code::BadRequest;
+  }
+
+  bool enable = query_params.begin()->second == "y";
+  if (enable && !Profiler::Heap::profilerEnabled()) {
+    if (!Profiler::Heap::startProfiler(profile_path_)) {
+      response.add("failure to start the profiler");
+      return Http::Code::InternalServerError;
+    }
+
+  } else if (!enable && Profiler::Heap::profilerEnabled()) {
+    // Send the final profile back in the response, then stop. Intermediate dump files are still
+    // written with profile_path_ as their prefix.
+    response.add(Profiler::Heap::profileDump());
+    Profiler::Heap::stopProfiler();
+    return Http::Code::OK;
   }
 
   response.add("OK\n");
@@ -216,6 +391,17 @@ Http::Code AdminImpl::handlerHotRestartVersion(const std::string&, Buffer::Insta
   return Http::Code::OK;
 }
 
+Http::Code AdminImpl::handlerLockContention(const std::string&, Buffer::Instance& response) {
+  const std::string summary = Thread::MutexTracer::summary();
+  if (summary.empty()) {
+    response.add("no traced mutexes. Compile with --define=mutex_tracing=enabled and construct "
+                 "mutexes with a site name to trace them.\n");
+  } else {
+    response.add(summary);
+  }
+  return Http::Code::OK;
+}
+
 Http::Code AdminImpl::handlerLogging(const std::string& url, Buffer::Instance& response) {
   Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
 
@@ -250,6 +436,28 @@ Http::Code AdminImpl::handlerResetCounters(const std::string&, Buffer::Instance&
   return Http::Code::OK;
 }
 
+Http::Code AdminImpl::handlerRuntimeModify(const std::string& url, Buffer::Instance& response) {
+  Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  if (params.empty()) {
+    response.add("usage: /runtime_modify?key1=value1&key2=value2&...\n");
+    response.add("use an empty value to remove a previously added override\n");
+    return Http::Code::BadRequest;
+  }
+
+  std::unordered_map<std::string, std::string> overrides;
+  overrides.insert(params.begin(), params.end());
+  try {
+    server_.runtime().mergeValues(overrides);
+  } catch (const EnvoyException& e) {
+    response.add(e.what());
+    response.add("\n");
+    return Http::Code::ServiceUnavailable;
+  }
+
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
 Http::Code AdminImpl::handlerServerInfo(const std::string&, Buffer::Instance& response) {
   time_t current_time = time(nullptr);
   response.add(fmt::format("envoy {} {} {} {} {}\n", VersionInfo::version(),
@@ -260,22 +468,124 @@ Http::Code AdminImpl::handlerServerInfo(const std::string&, Buffer::Instance& re
   return Http::Code::OK;
 }
 
-Http::Code AdminImpl::handlerStats(const std::string&, Buffer::Instance& response) {
-  // We currently don't support timers locally (only via statsd) so just group all the counters
-  // and gauges together, alpha sort them, and spit them out.
-  std::map<std::string, uint64_t> all_stats;
+Http::Code AdminImpl::handlerStats(const std::string& url, Buffer::Instance& response) {
+  // Optional server side query narrowing: ?prefix=<name prefix>, ?filter=<regex> and ?usedonly.
+  // Dashboards that want a handful of stats no longer need to fetch and discard the full dump.
+  const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  const bool used_only = params.find("usedonly") != params.end();
+  std::string prefix;
+  auto prefix_param = params.find("prefix");
+  if (prefix_param != params.end()) {
+    prefix = prefix_param->second;
+  }
+
+  Optional<std::regex> regex;
+  auto filter_param = params.find("filter");
+  if (filter_param != params.end()) {
+    try {
+      regex.value(std::regex(filter_param->second));
+    } catch (const std::regex_error& e) {
+      response.add(fmt::format("usage: /stats?filter=<regex>: {}\n", e.what()));
+      return Http::Code::BadRequest;
+    }
+  }
+
+  // Group all the counters and gauges together, alpha sort them, and spit them out. Histogram
+  // summaries (count, mean, and approximate quantiles) follow in their own alpha sorted section.
+  // A flat vector sorted in place is used rather than a std::map so that a large store does not
+  // cost one node allocation per stat, and output is batched into large appends to the response
+  // buffer instead of one append per line. Filters are applied before the sort so that a scoped
+  // query sorts and formats only the matching entries.
+  const std::list<Stats::CounterSharedPtr> counters = server_.stats().counters();
+  const std::list<Stats::GaugeSharedPtr> gauges = server_.stats().gauges();
+  std::vector<std::pair<std::string, uint64_t>> all_stats;
+  all_stats.reserve(counters.size() + gauges.size());
+  for (const Stats::CounterSharedPtr& counter : counters) {
+    if (shouldShowStat(counter->name(), counter->used(), used_only, prefix, regex)) {
+      all_stats.emplace_back(counter->name(), counter->value());
+    }
+  }
+
+  for (const Stats::GaugeSharedPtr& gauge : gauges) {
+    if (shouldShowStat(gauge->name(), gauge->used(), used_only, prefix, regex)) {
+      all_stats.emplace_back(gauge->name(), gauge->value());
+    }
+  }
+
+  // The stable sort keeps a counter ahead of a gauge with the same name so that skipping
+  // duplicates below preserves the first-insert-wins behavior of the map this code used to build.
+  std::stable_sort(all_stats.begin(), all_stats.end(),
+                   [](const std::pair<std::string, uint64_t>& lhs,
+                      const std::pair<std::string, uint64_t>& rhs) { return lhs.first < rhs.first; });
+
+  std::string chunk;
+  chunk.reserve(ResponseChunkSize);
+  for (auto stat = all_stats.begin(); stat != all_stats.end(); ++stat) {
+    if (stat != all_stats.begin() && stat->first == std::prev(stat)->first) {
+      continue;
+    }
+
+    chunk.append(fmt::format("{}: {}\n", stat->first, stat->second));
+    if (chunk.size() >= ResponseChunkSize) {
+      flushChunk(chunk, response);
+    }
+  }
+
+  // The histogram interface has no used flag, so ?usedonly does not apply to this section.
+  std::vector<std::pair<std::string, std::string>> all_histograms;
+  for (const Stats::HistogramSharedPtr& histogram : server_.stats().histograms()) {
+    if (shouldShowStat(histogram->name(), true, false, prefix, regex)) {
+      all_histograms.emplace_back(histogram->name(), histogram->summary());
+    }
+  }
+
+  std::sort(all_histograms.begin(), all_histograms.end());
+  for (const auto& histogram : all_histograms) {
+    chunk.append(fmt::format("{}: {}\n", histogram.first, histogram.second));
+    if (chunk.size() >= ResponseChunkSize) {
+      flushChunk(chunk, response);
+    }
+  }
+
+  flushChunk(chunk, response);
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerPrometheusStats(const std::string&, Buffer::Instance& response) {
+  // Emit counters and gauges in the Prometheus text exposition format. Names are prefixed with
+  // "envoy_" and characters outside [a-zA-Z0-9:_] are replaced with underscores. Histograms are
+  // not emitted because the histogram interface only exposes a preformatted summary string.
+  std::vector<std::pair<std::string, uint64_t>> counters;
   for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
-    all_stats.emplace(counter->name(), counter->value());
+    counters.emplace_back(prometheusSanitizedName(counter->name()), counter->value());
   }
 
+  std::vector<std::pair<std::string, uint64_t>> gauges;
   for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
-    all_stats.emplace(gauge->name(), gauge->value());
+    gauges.emplace_back(prometheusSanitizedName(gauge->name()), gauge->value());
   }
 
-  for (auto stat : all_stats) {
-    response.add(fmt::format("{}: {}\n", stat.first, stat.second));
+  std::sort(counters.begin(), counters.end());
+  std::sort(gauges.begin(), gauges.end());
+
+  std::string chunk;
+  chunk.reserve(ResponseChunkSize);
+  for (const auto& counter : counters) {
+    chunk.append(
+        fmt::format("# TYPE {} counter\n{} {}\n", counter.first, counter.first, counter.second));
+    if (chunk.size() >= ResponseChunkSize) {
+      flushChunk(chunk, response);
+    }
+  }
+
+  for (const auto& gauge : gauges) {
+    chunk.append(fmt::format("# TYPE {} gauge\n{} {}\n", gauge.first, gauge.first, gauge.second));
+    if (chunk.size() >= ResponseChunkSize) {
+      flushChunk(chunk, response);
+    }
   }
 
+  flushChunk(chunk, response);
   return Http::Code::OK;
 }
 
@@ -295,20 +605,10 @@ Http::Code AdminImpl::handlerListenerInfo(const std::string&, Buffer::Instance&
 }
 
 Http::Code AdminImpl::handlerCerts(const std::string&, Buffer::Instance& response) {
-  // This set is used to track distinct certificates. We may have multiple listeners, upstreams, etc
-  // using the same cert.
-  std::unordered_set<std::string> context_info_set;
-  std::string context_format = "{{\n\t\"ca_cert\": \"{}\",\n\t\"cert_chain\": \"{}\"\n}}\n";
-  server_.sslContextManager().iterateContexts([&](Ssl::Context& context) -> void {
-    context_info_set.insert(fmt::format(context_format, context.getCaCertInformation(),
-                                        context.getCertChainInformation()));
-  });
-
-  std::string cert_result_string;
-  for (const std::string& context_info : context_info_set) {
-    cert_result_string += context_info;
+  // Non-streaming path used by runCallback(); drains every chunk synchronously.
+  CertsChunkedHandler handler(server_);
+  while (handler.nextChunk(response)) {
   }
-  response.add(cert_result_string);
   return Http::Code::OK;
 }
 
@@ -316,11 +616,20 @@ void AdminFilter::onComplete() {
   std::string path = request_headers_->Path()->value().c_str();
   ENVOY_STREAM_LOG(info, "request complete: path: {}", *callbacks_, path);
 
+  chunked_handler_ = parent_.makeChunkedHandler(path);
+  if (chunked_handler_ != nullptr) {
+    Http::HeaderMapPtr headers{new Http::HeaderMapImpl{
+        {Http::Headers::get().Status, Http::Utility::numericStatusString(Http::Code::OK)}}};
+    callbacks_->encodeHeaders(std::move(headers), false);
+    encodeNextChunk();
+    return;
+  }
+
   Buffer::OwnedImpl response;
   Http::Code code = parent_.runCallback(path, response);
 
-  Http::HeaderMapPtr headers{
-      new Http::HeaderMapImpl{{Http::Headers::get().Status, std::to_string(enumToInt(code))}}};
+  Http::HeaderMapPtr headers{new Http::HeaderMapImpl{
+      {Http::Headers::get().Status, Http::Utility::numericStatusString(code)}}};
   callbacks_->encodeHeaders(std::move(headers), response.length() == 0);
 
   if (response.length() > 0) {
@@ -328,6 +637,25 @@ void AdminFilter::onComplete() {
   }
 }
 
+void AdminFilter::encodeNextChunk() {
+  Buffer::OwnedImpl chunk;
+  const bool more = chunked_handler_->nextChunk(chunk);
+  callbacks_->encodeData(chunk, !more);
+  if (!more) {
+    return;
+  }
+
+  // Yield so other main thread work (config updates, health check state changes) runs between
+  // chunks instead of waiting for the whole response to be built.
+  AdminFilter* filter = this;
+  std::shared_ptr<bool> destroyed = destroyed_;
+  callbacks_->dispatcher().post([filter, destroyed]() -> void {
+    if (!*destroyed) {
+      filter->encodeNextChunk();
+    }
+  });
+}
+
 AdminImpl::NullRouteConfigProvider::NullRouteConfigProvider()
     : config_(new Router::NullConfigImpl()) {}
 
@@ -348,15 +676,26 @@ AdminImpl::AdminImpl(const std::string& access_log_path, const std::string& prof
            MAKE_ADMIN_HANDLER(handlerHealthcheckFail), false},
           {"/healthcheck/ok", "cause the server to pass health checks",
            MAKE_ADMIN_HANDLER(handlerHealthcheckOk), false},
+          {"/heapprofiler", "enable/disable the heap profiler",
+           MAKE_ADMIN_HANDLER(handlerHeapProfiler), false},
           {"/hot_restart_version", "print the hot restart compatability version",
            MAKE_ADMIN_HANDLER(handlerHotRestartVersion), false},
+          {"/lock_contention", "print mutex contention statistics",
+           MAKE_ADMIN_HANDLER(handlerLockContention), false},
           {"/logging", "query/change logging levels", MAKE_ADMIN_HANDLER(handlerLogging), false},
           {"/quitquitquit", "exit the server", MAKE_ADMIN_HANDLER(handlerQuitQuitQuit), false},
           {"/reset_counters", "reset all counters to zero",
            MAKE_ADMIN_HANDLER(handlerResetCounters), false},
+          {"/runtime_modify", "modify runtime values by adding in memory overrides",
+           MAKE_ADMIN_HANDLER(handlerRuntimeModify), false},
           {"/server_info", "print server version/status information",
            MAKE_ADMIN_HANDLER(handlerServerInfo), false},
-          {"/stats", "print server stats", MAKE_ADMIN_HANDLER(handlerStats), false},
+          // NOTE: The "/stats/prometheus" handler must come before "/stats" since callbacks are
+          //       matched on prefix.
+          {"/stats/prometheus", "print server stats in prometheus format",
+           MAKE_ADMIN_HANDLER(handlerPrometheusStats), false},
+          {"/stats", "print server stats; optional prefix=, filter=<regex>, usedonly params",
+           MAKE_ADMIN_HANDLER(handlerStats), false},
           {"/listeners", "print listener addresses", MAKE_ADMIN_HANDLER(handlerListenerInfo),
            false}} {
 
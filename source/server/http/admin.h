@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <list>
+#include <memory>
 #include <string>
 
 #include "envoy/http/filter.h"
@@ -39,6 +40,30 @@ public:
   const Network::ListenSocket& socket() override { return *socket_; }
   Network::ListenSocket& mutable_socket() { return *socket_; }
 
+  /**
+   * Produces a response a chunk at a time with a cursor over the underlying data. The admin
+   * filter yields to the event loop between chunks so that multi-MB outputs (e.g. /clusters with
+   * hundreds of clusters) never stall the main dispatcher and delay config updates.
+   */
+  class ChunkedHandler {
+  public:
+    virtual ~ChunkedHandler() {}
+
+    /**
+     * Appends the next chunk to the supplied buffer and advances the cursor.
+     * @return true if more chunks remain.
+     */
+    virtual bool nextChunk(Buffer::Instance& chunk) PURE;
+  };
+
+  typedef std::unique_ptr<ChunkedHandler> ChunkedHandlerPtr;
+
+  /**
+   * @return a chunked handler for the path, or nullptr if the path does not have a chunked
+   * implementation.
+   */
+  ChunkedHandlerPtr makeChunkedHandler(const std::string& path);
+
   // Server::Admin
   bool addHandler(const std::string& prefix, const std::string& help_text, HandlerCb callback,
                   bool removable) override;
@@ -109,11 +134,6 @@ private:
    * @return TRUE if level change succeeded, FALSE otherwise.
    */
   bool changeLogLevel(const Http::Utility::QueryParams& params);
-  void addCircuitSettings(const std::string& cluster_name, const std::string& priority_str,
-                          Upstream::ResourceManager& resource_manager, Buffer::Instance& response);
-  void addOutlierInfo(const std::string& cluster_name,
-                      const Upstream::Outlier::Detector* outlier_detector,
-                      Buffer::Instance& response);
 
   /**
    * URL handlers.
@@ -123,11 +143,15 @@ private:
   Http::Code handlerCpuProfiler(const std::string& url, Buffer::Instance& response);
   Http::Code handlerHealthcheckFail(const std::string& url, Buffer::Instance& response);
   Http::Code handlerHealthcheckOk(const std::string& url, Buffer::Instance& response);
+  Http::Code handlerHeapProfiler(const std::string& url, Buffer::Instance& response);
   Http::Code handlerHotRestartVersion(const std::string& url, Buffer::Instance& response);
+  Http::Code handlerLockContention(const std::string& url, Buffer::Instance& response);
   Http::Code handlerLogging(const std::string& url, Buffer::Instance& response);
   Http::Code handlerResetCounters(const std::string& url, Buffer::Instance& response);
+  Http::Code handlerRuntimeModify(const std::string& url, Buffer::Instance& response);
   Http::Code handlerServerInfo(const std::string& url, Buffer::Instance& response);
   Http::Code handlerStats(const std::string& url, Buffer::Instance& response);
+  Http::Code handlerPrometheusStats(const std::string& url, Buffer::Instance& response);
   Http::Code handlerQuitQuitQuit(const std::string& url, Buffer::Instance& response);
   Http::Code handlerListenerInfo(const std::string& url, Buffer::Instance& response);
 
@@ -153,7 +177,7 @@ public:
   AdminFilter(AdminImpl& parent);
 
   // Http::StreamFilterBase
-  void onDestroy() override {}
+  void onDestroy() override { *destroyed_ = true; }
 
   // Http::StreamDecoderFilter
   Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
@@ -169,9 +193,19 @@ private:
    */
   void onComplete();
 
+  /**
+   * Encodes the next chunk of a chunked response and, if more data remains, posts a continuation
+   * to the dispatcher so other main thread work runs between chunks.
+   */
+  void encodeNextChunk();
+
   AdminImpl& parent_;
   Http::StreamDecoderFilterCallbacks* callbacks_{};
   Http::HeaderMap* request_headers_{};
+  AdminImpl::ChunkedHandlerPtr chunked_handler_;
+  // Set when the stream is destroyed so that a posted chunk continuation does not touch a dead
+  // filter.
+  std::shared_ptr<bool> destroyed_{new bool(false)};
 };
 
 } // namespace Server
@@ -133,8 +133,9 @@ void HealthCheckFilter::onComplete() {
   if (context_.healthCheckFailed()) {
     callbacks_->requestInfo().setResponseFlag(
         Http::AccessLog::ResponseFlag::FailedLocalHealthCheck);
-    headers.reset(new Http::HeaderMapImpl{
-        {Http::Headers::get().Status, std::to_string(enumToInt(Http::Code::ServiceUnavailable))}});
+    headers.reset(new Http::HeaderMapImpl{{Http::Headers::get().Status,
+                                           Http::Utility::numericStatusString(
+                                               Http::Code::ServiceUnavailable)}});
   } else {
     Http::Code final_status = Http::Code::OK;
     if (cache_manager_) {
@@ -147,7 +148,7 @@ void HealthCheckFilter::onComplete() {
     }
 
     headers.reset(new Http::HeaderMapImpl{
-        {Http::Headers::get().Status, std::to_string(enumToInt(final_status))}});
+        {Http::Headers::get().Status, Http::Utility::numericStatusString(final_status)}});
   }
 
   callbacks_->encodeHeaders(std::move(headers), true);
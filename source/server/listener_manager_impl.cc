@@ -3,7 +3,10 @@
 #include "envoy/registry/registry.h"
 
 #include "common/common/assert.h"
+#include "common/common/utility.h"
 #include "common/config/utility.h"
+#include "common/network/accept_rate_limiter_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
@@ -55,13 +58,27 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   // used for testing. First we try to get the socket from our parent if applicable.
   // TODO(mattklein123): UDS support.
   ASSERT(address->type() == Network::Address::Type::Ip);
+
+  Network::TcpListenSocketOptions socket_options;
+  socket_options.tcp_fastopen_queue_length_ = server_.options().tcpFastOpenQueueLength();
+  socket_options.defer_accept_timeout_seconds_ = server_.options().deferAcceptTimeoutSeconds();
+
+  // With --reuse-port every worker (and every process) binds its own socket, so there is no
+  // socket to inherit from the parent during hot restart. The kernel balances accepts between
+  // the old and new process while both are bound during the drain sequence.
+  if (server_.options().reusePort() && bind_to_port) {
+    socket_options.reuse_port_ = true;
+    return std::make_shared<Network::TcpListenSocket>(address, true, socket_options);
+  }
+
   const std::string addr = fmt::format("tcp://{}", address->asString());
   const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
   if (fd != -1) {
+    // Sockets inherited from the parent already have their options applied.
     ENVOY_LOG(info, "obtained socket for address {} from parent", addr);
     return std::make_shared<Network::TcpListenSocket>(fd, address);
   } else {
-    return std::make_shared<Network::TcpListenSocket>(address, bind_to_port);
+    return std::make_shared<Network::TcpListenSocket>(address, bind_to_port, socket_options);
   }
 }
 
@@ -78,6 +95,7 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, ListenerManag
                                                  config.address().socket_address().port_value())),
       global_scope_(parent_.server_.stats().createScope("")),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      defer_accept_(bind_to_port_ && parent_.server_.options().deferAcceptTimeoutSeconds() > 0),
       use_proxy_proto_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.filter_chains()[0], use_proxy_proto, false)),
       use_original_dst_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
@@ -85,12 +103,22 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, ListenerManag
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
       listener_tag_(parent_.factory_.nextListenerTag()), name_(name),
       workers_started_(workers_started), hash_(hash),
+      socket_level_hash_(computeSocketLevelHash(config)),
       local_drain_manager_(parent.factory_.createDrainManager()) {
-  // TODO(htuch): Support multiple filter chains #1280, add constraint to ensure we have at least on
-  // filter chain #1308.
-  ASSERT(config.filter_chains().size() == 1);
+  // TODO(htuch): Add constraint to ensure we have at least one filter chain #1308. Additional
+  // filter chains are supported only for SNI based TLS context selection; see below.
+  ASSERT(!config.filter_chains().empty());
   const auto& filter_chain = config.filter_chains()[0];
 
+  if (parent_.server_.options().exactConnectionBalance()) {
+    connection_balancer_ = std::make_shared<Network::ExactConnectionBalancerImpl>();
+  }
+
+  if (parent_.server_.options().maxAcceptsPerSecond() > 0) {
+    accept_rate_limiter_ = std::make_shared<Network::AcceptRateLimiterImpl>(
+        parent_.server_.options().maxAcceptsPerSecond(), ProdMonotonicTimeSource::instance_);
+  }
+
   // ':' is a reserved char in statsd. Do the translation here to avoid costly inline translations
   // later.
   std::string final_stat_name = fmt::format("listener.{}.", address_->asString());
@@ -103,9 +131,48 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, ListenerManag
                                                                               context_config);
   }
 
+  // Additional filter chains provide certificates for more server names on the same address:
+  // their tls_context is selected when the client's SNI matches one of the chain's sni_domains.
+  // The first chain's filters and socket options apply to every connection, so consolidating
+  // per-certificate listeners onto one address does not duplicate filter state per worker.
+  for (int i = 1; i < config.filter_chains().size(); i++) {
+    const auto& sni_chain = config.filter_chains()[i];
+    if (ssl_context_ == nullptr || !sni_chain.has_tls_context() ||
+        sni_chain.filter_chain_match().sni_domains().empty()) {
+      throw EnvoyException(fmt::format(
+          "error adding listener '{}': additional filter chains are supported only for SNI based "
+          "TLS context selection and require a tls_context and filter_chain_match sni_domains",
+          address_->asString()));
+    }
+    if (!sni_chain.filters().empty()) {
+      throw EnvoyException(fmt::format(
+          "error adding listener '{}': additional filter chains cannot define their own filters; "
+          "the first filter chain's filters apply to all connections",
+          address_->asString()));
+    }
+
+    Ssl::ServerContextConfigImpl sni_context_config(sni_chain.tls_context());
+    sni_ssl_contexts_.emplace_back(parent_.server_.sslContextManager().createSslServerContext(
+        *listener_scope_, sni_context_config));
+    for (const auto& sni_domain : sni_chain.filter_chain_match().sni_domains()) {
+      ssl_context_->addSniContext(sni_domain, *sni_ssl_contexts_.back());
+    }
+  }
+
   filter_factories_ = parent_.factory_.createFilterFactoryList(filter_chain.filters(), *this);
 }
 
+uint64_t ListenerImpl::computeSocketLevelHash(const envoy::api::v2::Listener& config) {
+  // Hash the configuration with per-filter configuration stripped out. Everything that remains
+  // (address, binding options, proxy protocol, TLS context, buffer limits, etc.) affects how the
+  // socket or transport is set up, so a change to any of it requires the full drain path.
+  envoy::api::v2::Listener socket_config = config;
+  for (auto& filter_chain : *socket_config.mutable_filter_chains()) {
+    filter_chain.clear_filters();
+  }
+  return MessageUtil::hash(socket_config);
+}
+
 ListenerImpl::~ListenerImpl() {
   // The filter factories may have pending initialize actions (like in the case of RDS). Those
   // actions will fire in the destructor to avoid blocking initial server startup. If we are using
@@ -121,6 +188,13 @@ bool ListenerImpl::createFilterChain(Network::Connection& connection) {
 }
 
 bool ListenerImpl::drainClose() const {
+  // A listener retired by a filter-only update does not prod its connections to close: only new
+  // connections needed the new configuration. The server wide drain manager still applies so that
+  // events like /healthcheck/fail behave as usual.
+  if (filter_only_drain_) {
+    return parent_.server_.drainManager().drainClose();
+  }
+
   // When a listener is draining, the "drain close" decision is the union of the per-listener drain
   // manager and the server wide drain manager. This allows individual listeners to be drained and
   // removed independently of a server-wide drain event (e.g., /healthcheck/fail or hot restart).
@@ -153,9 +227,21 @@ Init::Manager& ListenerImpl::initManager() {
   }
 }
 
-void ListenerImpl::setSocket(const Network::ListenSocketSharedPtr& socket) {
-  ASSERT(!socket_);
-  socket_ = socket;
+void ListenerImpl::setSockets(const std::vector<Network::ListenSocketSharedPtr>& sockets) {
+  ASSERT(sockets_.empty());
+  ASSERT(!sockets.empty());
+  sockets_ = sockets;
+}
+
+Network::ListenSocket& ListenerImpl::socketForWorker(uint32_t worker_index) {
+  // Unless per-worker SO_REUSEPORT sockets are in use there is a single socket shared by all
+  // workers.
+  if (sockets_.size() == 1) {
+    return *sockets_[0];
+  }
+
+  ASSERT(worker_index < sockets_.size());
+  return *sockets_[worker_index];
 }
 
 ListenerManagerImpl::ListenerManagerImpl(Instance& server,
@@ -220,12 +306,12 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->infoLog("update warming listener");
-    new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->setSockets((*existing_warming_listener)->getSockets());
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
-    // have been started or not. Either way we get the socket from the existing listener.
-    new_listener->setSocket((*existing_active_listener)->getSocket());
+    // have been started or not. Either way we get the sockets from the existing listener.
+    new_listener->setSockets((*existing_active_listener)->getSockets());
     if (workers_started_) {
       new_listener->infoLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -254,20 +340,28 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::ListenSocketSharedPtr draining_listener_socket;
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
           return *new_listener->address() == *listener.listener_->socket().localAddress();
         });
     if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
+      new_listener->setSockets(existing_draining_listener->listener_->getSockets());
+    } else {
+      // With --reuse-port each worker accepts on its own socket bound to the same address, so
+      // that the kernel shards new connections across workers instead of all workers contending
+      // on a single accept queue. The first socket is bound before the others are created so
+      // that a port zero bind resolves to a single port shared by every worker.
+      std::vector<Network::ListenSocketSharedPtr> sockets;
+      sockets.emplace_back(
+          factory_.createListenSocket(new_listener->address(), new_listener->bindToPort()));
+      if (server_.options().reusePort() && new_listener->bindToPort()) {
+        for (uint64_t i = 1; i < workers_.size(); i++) {
+          sockets.emplace_back(factory_.createListenSocket(sockets[0]->localAddress(), true));
+        }
+      }
+      new_listener->setSockets(sockets);
     }
-
-    new_listener->setSocket(
-        draining_listener_socket
-            ? draining_listener_socket
-            : factory_.createListenSocket(new_listener->address(), new_listener->bindToPort()));
     if (workers_started_) {
       new_listener->infoLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -354,6 +448,46 @@ ListenerManagerImpl::getListenerByName(ListenerList& listeners, const std::strin
   return ret;
 }
 
+bool ListenerManagerImpl::adoptPassedConnection(
+    int fd, Network::Address::InstanceConstSharedPtr local_address,
+    Network::Address::InstanceConstSharedPtr remote_address) {
+  if (!workers_started_ || workers_.empty()) {
+    return false;
+  }
+
+  // Find the active listener the connection belongs to. The connection's local address is always
+  // concrete, so as with redirected connections we fall back to a wildcard listener on the same
+  // port if there is no exact match.
+  ListenerImpl* match = nullptr;
+  for (const auto& listener : active_listeners_) {
+    const Network::Address::Instance& address = *listener->socket().localAddress();
+    if (address.type() == Network::Address::Type::Ip && address == *local_address) {
+      match = listener.get();
+      break;
+    }
+  }
+  if (match == nullptr && local_address->type() == Network::Address::Type::Ip) {
+    for (const auto& listener : active_listeners_) {
+      const Network::Address::Instance& address = *listener->socket().localAddress();
+      if (address.type() == Network::Address::Type::Ip &&
+          address.ip()->port() == local_address->ip()->port() && address.ip()->isAnyAddress()) {
+        match = listener.get();
+        break;
+      }
+    }
+  }
+
+  // SSL and PROXY protocol listeners negotiate per-connection state that did not cross the
+  // process boundary, so their connections cannot be adopted mid-stream.
+  if (match == nullptr || match->sslContext() != nullptr || match->useProxyProto()) {
+    return false;
+  }
+
+  auto worker = std::next(workers_.begin(), next_adopting_worker_++ % workers_.size());
+  (*worker)->addPassedConnection(fd, local_address, remote_address);
+  return true;
+}
+
 std::vector<std::reference_wrapper<Listener>> ListenerManagerImpl::listeners() {
   std::vector<std::reference_wrapper<Listener>> ret;
   ret.reserve(active_listeners_.size());
@@ -400,6 +534,15 @@ void ListenerManagerImpl::onListenerWarmed(ListenerImpl& listener) {
   auto existing_warming_listener = getListenerByName(warming_listeners_, listener.name());
   (*existing_warming_listener)->infoLog("warm complete. updating active listener");
   if (existing_active_listener != active_listeners_.end()) {
+    // If nothing at the socket level changed, this update only touched filter configuration. New
+    // connections pick it up from the replacement listener; existing connections are left alone
+    // instead of being drained, and the old listener is removed at the end of the normal drain
+    // window as usual.
+    if ((*existing_active_listener)->socketLevelHash() == listener.socketLevelHash()) {
+      (*existing_active_listener)->infoLog("filter-only update. not draining connections");
+      (*existing_active_listener)->setFilterOnlyDrain();
+      stats_.listener_in_place_updated_.inc();
+    }
     drainListener(std::move(*existing_active_listener));
     *existing_active_listener = std::move(*existing_warming_listener);
   } else {
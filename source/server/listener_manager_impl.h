@@ -56,6 +56,7 @@ typedef std::unique_ptr<ListenerImpl> ListenerImplPtr;
 // clang-format off
 #define ALL_LISTENER_MANAGER_STATS(COUNTER, GAUGE)                                                 \
   COUNTER(listener_added)                                                                          \
+  COUNTER(listener_in_place_updated)                                                               \
   COUNTER(listener_modified)                                                                       \
   COUNTER(listener_removed)                                                                        \
   COUNTER(listener_create_success)                                                                 \
@@ -84,6 +85,8 @@ public:
 
   // Server::ListenerManager
   bool addOrUpdateListener(const envoy::api::v2::Listener& config) override;
+  bool adoptPassedConnection(int fd, Network::Address::InstanceConstSharedPtr local_address,
+                             Network::Address::InstanceConstSharedPtr remote_address) override;
   std::vector<std::reference_wrapper<Listener>> listeners() override;
   uint64_t numConnections() override;
   bool removeListener(const std::string& listener_name) override;
@@ -145,6 +148,8 @@ private:
   std::list<WorkerPtr> workers_;
   bool workers_started_{};
   ListenerManagerStats stats_;
+  // Round robin cursor for spreading adopted connections across workers.
+  uint64_t next_adopting_worker_{};
 };
 
 // TODO(mattklein123): Consider getting rid of pre-worker start and post-worker start code by
@@ -183,19 +188,42 @@ public:
   }
 
   Network::Address::InstanceConstSharedPtr address() const { return address_; }
-  const Network::ListenSocketSharedPtr& getSocket() const { return socket_; }
+  const std::vector<Network::ListenSocketSharedPtr>& getSockets() const { return sockets_; }
   uint64_t hash() const { return hash_; }
   void infoLog(const std::string& message);
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
-  void setSocket(const Network::ListenSocketSharedPtr& socket);
+
+  /**
+   * Mark this listener as being retired by an update that did not change any socket level
+   * configuration. Its existing connections are left untouched while it drains; only the final
+   * removal at the end of the drain window closes whatever connections remain.
+   */
+  void setFilterOnlyDrain() { filter_only_drain_ = true; }
+  void setSockets(const std::vector<Network::ListenSocketSharedPtr>& sockets);
+
+  /**
+   * @return uint64_t a hash of the configuration that affects the socket or transport (address,
+   *         binding options, TLS context, etc.) but ignores per-filter configuration. Two
+   *         listeners with the same socket level hash can be swapped without draining existing
+   *         connections.
+   */
+  uint64_t socketLevelHash() const { return socket_level_hash_; }
 
   // Server::Listener
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
-  Network::ListenSocket& socket() override { return *socket_; }
+  Network::ListenSocket& socket() override { return *sockets_[0]; }
+  Network::ListenSocket& socketForWorker(uint32_t worker_index) override;
+  Network::ConnectionBalancerSharedPtr connectionBalancer() override {
+    return connection_balancer_;
+  }
+  Network::AcceptRateLimiterSharedPtr acceptRateLimiter() override {
+    return accept_rate_limiter_;
+  }
   bool bindToPort() override { return bind_to_port_; }
   Ssl::ServerContext* sslContext() override { return ssl_context_.get(); }
   bool useProxyProto() override { return use_proxy_proto_; }
+  bool deferAccept() override { return defer_accept_; }
   bool useOriginalDst() override { return use_original_dst_; }
   uint32_t perConnectionBufferLimitBytes() override { return per_connection_buffer_limit_bytes_; }
   Stats::Scope& listenerScope() override { return *listener_scope_; }
@@ -231,13 +259,26 @@ public:
   bool createFilterChain(Network::Connection& connection) override;
 
 private:
+  static uint64_t computeSocketLevelHash(const envoy::api::v2::Listener& config);
+
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
-  Network::ListenSocketSharedPtr socket_;
+  // All listen sockets for the listener. This is a single socket shared by all workers unless
+  // per-worker SO_REUSEPORT sockets are in use, in which case there is one socket per worker.
+  std::vector<Network::ListenSocketSharedPtr> sockets_;
   Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
   Stats::ScopePtr listener_scope_; // Stats with listener named scope.
+  // Contexts built from additional filter chains, selected by SNI during the handshake. They are
+  // registered on ssl_context_ and declared before it so that they outlive it.
+  // @see Ssl::ServerContext::addSniContext.
+  std::vector<Ssl::ServerContextPtr> sni_ssl_contexts_;
   Ssl::ServerContextPtr ssl_context_;
+  // Shared by all workers' listeners when --exact-connection-balance is in use.
+  Network::ConnectionBalancerSharedPtr connection_balancer_;
+  // Shared by all workers' listeners when --max-accepts-per-second is in use.
+  Network::AcceptRateLimiterSharedPtr accept_rate_limiter_;
   const bool bind_to_port_;
+  const bool defer_accept_;
   const bool use_proxy_proto_;
   const bool use_original_dst_;
   const uint32_t per_connection_buffer_limit_bytes_;
@@ -245,8 +286,10 @@ private:
   const std::string name_;
   const bool workers_started_;
   const uint64_t hash_;
+  const uint64_t socket_level_hash_;
   InitManagerImpl dynamic_init_manager_;
   bool initialize_canceled_{};
+  bool filter_only_drain_{};
   std::vector<Configuration::NetworkFilterFactoryCb> filter_factories_;
   DrainManagerPtr local_drain_manager_;
   bool saw_listener_create_failure_{};
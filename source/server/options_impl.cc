@@ -6,6 +6,7 @@
 #include <string>
 
 #include "common/common/macros.h"
+#include "common/common/utility.h"
 #include "common/common/version.h"
 
 #include "fmt/format.h"
@@ -29,6 +30,11 @@ OptionsImpl::OptionsImpl(int argc, char** argv, const std::string& hot_restart_v
       "uint64_t", cmd);
   TCLAP::ValueArg<uint32_t> concurrency("", "concurrency", "# of worker threads to run", false,
                                         std::thread::hardware_concurrency(), "uint32_t", cmd);
+  TCLAP::ValueArg<std::string> worker_cpu_affinity(
+      "", "worker-cpu-affinity",
+      "comma separated list of CPU ids to pin worker threads to, assigned to workers round-robin "
+      "(empty disables pinning)",
+      false, "", "string", cmd);
   TCLAP::ValueArg<std::string> config_path("c", "config-path", "Path to configuration file", false,
                                            "", "string", cmd);
   TCLAP::ValueArg<std::string> admin_address_path("", "admin-address-path", "Admin address path",
@@ -42,6 +48,34 @@ OptionsImpl::OptionsImpl(int argc, char** argv, const std::string& hot_restart_v
                                          cmd);
   TCLAP::ValueArg<uint64_t> restart_epoch("", "restart-epoch", "hot restart epoch #", false, 0,
                                           "uint64_t", cmd);
+  TCLAP::SwitchArg reuse_port("", "reuse-port",
+                              "use a separate SO_REUSEPORT listen socket per worker", cmd, false);
+  TCLAP::ValueArg<uint32_t> tcp_fastopen_queue_length(
+      "", "tcp-fastopen-queue-length",
+      "enable TCP Fast Open on listen sockets with the given SYN backlog queue length (0 "
+      "disables)",
+      false, 0, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> defer_accept_timeout(
+      "", "defer-accept-timeout-seconds",
+      "enable TCP_DEFER_ACCEPT on listen sockets with the given timeout in seconds (0 disables)",
+      false, 0, "uint32_t", cmd);
+  TCLAP::SwitchArg exact_connection_balance(
+      "", "exact-connection-balance",
+      "balance accepted connections exactly across worker threads", cmd, false);
+  TCLAP::ValueArg<uint32_t> max_accepts_per_second(
+      "", "max-accepts-per-second",
+      "limit each listener to this many accepted connections per second across all workers (0 "
+      "disables)",
+      false, 0, "uint32_t", cmd);
+  TCLAP::ValueArg<uint64_t> max_connections(
+      "", "max-connections",
+      "limit the process to this many open downstream connections across all workers (0 "
+      "disables)",
+      false, 0, "uint64_t", cmd);
+  TCLAP::SwitchArg dedicated_health_check_thread(
+      "", "dedicated-health-check-thread",
+      "run active health checking on its own dispatcher thread instead of the main thread", cmd,
+      false);
   TCLAP::SwitchArg hot_restart_version_option("", "hot-restart-version",
                                               "hot restart compatability version", cmd);
   TCLAP::ValueArg<std::string> service_cluster("", "service-cluster", "Cluster name", false, "",
@@ -104,9 +138,24 @@ OptionsImpl::OptionsImpl(int argc, char** argv, const std::string& hot_restart_v
   // For base ID, scale what the user inputs by 10 so that we have spread for domain sockets.
   base_id_ = base_id.getValue() * 10;
   concurrency_ = concurrency.getValue();
+  for (const std::string& cpu : StringUtil::split(worker_cpu_affinity.getValue(), ',')) {
+    uint64_t cpu_id;
+    if (!StringUtil::atoul(cpu.c_str(), cpu_id)) {
+      std::cerr << "error: invalid CPU id '" << cpu << "' in --worker-cpu-affinity" << std::endl;
+      exit(1);
+    }
+    worker_cpu_affinity_.push_back(cpu_id);
+  }
   config_path_ = config_path.getValue();
   admin_address_path_ = admin_address_path.getValue();
   restart_epoch_ = restart_epoch.getValue();
+  reuse_port_ = reuse_port.getValue();
+  tcp_fastopen_queue_length_ = tcp_fastopen_queue_length.getValue();
+  defer_accept_timeout_seconds_ = defer_accept_timeout.getValue();
+  exact_connection_balance_ = exact_connection_balance.getValue();
+  max_accepts_per_second_ = max_accepts_per_second.getValue();
+  max_connections_ = max_connections.getValue();
+  dedicated_health_check_thread_ = dedicated_health_check_thread.getValue();
   service_cluster_ = service_cluster.getValue();
   service_node_ = service_node.getValue();
   service_zone_ = service_zone.getValue();
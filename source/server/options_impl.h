@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/server/options.h"
 
@@ -20,6 +21,7 @@ public:
   // Server::Options
   uint64_t baseId() override { return base_id_; }
   uint32_t concurrency() override { return concurrency_; }
+  const std::vector<uint32_t>& workerCpuAffinity() override { return worker_cpu_affinity_; }
   const std::string& configPath() override { return config_path_; }
   const std::string& adminAddressPath() override { return admin_address_path_; }
   Network::Address::IpVersion localAddressIpVersion() override { return local_address_ip_version_; }
@@ -27,6 +29,13 @@ public:
   spdlog::level::level_enum logLevel() override { return log_level_; }
   std::chrono::seconds parentShutdownTime() override { return parent_shutdown_time_; }
   uint64_t restartEpoch() override { return restart_epoch_; }
+  bool reusePort() override { return reuse_port_; }
+  uint32_t tcpFastOpenQueueLength() override { return tcp_fastopen_queue_length_; }
+  uint32_t deferAcceptTimeoutSeconds() override { return defer_accept_timeout_seconds_; }
+  bool exactConnectionBalance() override { return exact_connection_balance_; }
+  uint32_t maxAcceptsPerSecond() override { return max_accepts_per_second_; }
+  uint64_t maxConnections() override { return max_connections_; }
+  bool dedicatedHealthCheckThread() override { return dedicated_health_check_thread_; }
   Server::Mode mode() const override { return mode_; }
   std::chrono::milliseconds fileFlushIntervalMsec() override { return file_flush_interval_msec_; }
   const std::string& serviceClusterName() override { return service_cluster_; }
@@ -36,11 +45,19 @@ public:
 private:
   uint64_t base_id_;
   uint32_t concurrency_;
+  std::vector<uint32_t> worker_cpu_affinity_;
   std::string config_path_;
   std::string admin_address_path_;
   Network::Address::IpVersion local_address_ip_version_;
   spdlog::level::level_enum log_level_;
   uint64_t restart_epoch_;
+  bool reuse_port_;
+  uint32_t tcp_fastopen_queue_length_;
+  uint32_t defer_accept_timeout_seconds_;
+  bool exact_connection_balance_;
+  uint32_t max_accepts_per_second_;
+  uint64_t max_connections_;
+  bool dedicated_health_check_thread_;
   std::string service_cluster_;
   std::string service_node_;
   std::string service_zone_;
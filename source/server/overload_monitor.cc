@@ -0,0 +1,65 @@
+#include "server/overload_monitor.h"
+
+#include <chrono>
+
+namespace Envoy {
+namespace Server {
+namespace {
+
+// Number of consecutive delayed samples required before shedding starts. A single long stall
+// (e.g. one expensive config update) does not pause accepting; sustained overload trips within a
+// few hundred milliseconds.
+const uint32_t ShedSampleCount = 3;
+
+// Number of consecutive on-time samples required before accepting resumes. This is deliberately
+// longer than the shed threshold so the monitor does not oscillate at the boundary.
+const uint32_t RecoverSampleCount = 10;
+
+} // namespace
+
+const std::chrono::milliseconds OverloadMonitor::SampleInterval{100};
+const std::chrono::milliseconds OverloadMonitor::HighWatermark{100};
+const std::chrono::milliseconds OverloadMonitor::LowWatermark{25};
+
+OverloadMonitor::OverloadMonitor(Event::Dispatcher& dispatcher,
+                                 Network::ConnectionHandler& handler,
+                                 MonotonicTimeSource& time_source)
+    : handler_(handler), time_source_(time_source),
+      timer_(dispatcher.createTimer([this]() -> void { onSampleTimer(); })),
+      last_sample_(time_source.currentTime()) {
+  timer_->enableTimer(SampleInterval);
+}
+
+void OverloadMonitor::onSampleTimer() {
+  const MonotonicTime now = time_source_.currentTime();
+  const std::chrono::milliseconds elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - last_sample_);
+  const std::chrono::milliseconds delay = elapsed - SampleInterval;
+  last_sample_ = now;
+
+  if (delay >= HighWatermark) {
+    consecutive_over_++;
+    consecutive_under_ = 0;
+  } else if (delay <= LowWatermark) {
+    consecutive_under_++;
+    consecutive_over_ = 0;
+  } else {
+    consecutive_over_ = 0;
+    consecutive_under_ = 0;
+  }
+
+  if (!shedding_ && consecutive_over_ >= ShedSampleCount) {
+    ENVOY_LOG(warn, "event loop delay {}ms above high watermark; pausing accept", delay.count());
+    handler_.disableListeners();
+    shedding_ = true;
+  } else if (shedding_ && consecutive_under_ >= RecoverSampleCount) {
+    ENVOY_LOG(info, "event loop delay recovered; resuming accept");
+    handler_.enableListeners();
+    shedding_ = false;
+  }
+
+  timer_->enableTimer(SampleInterval);
+}
+
+} // namespace Server
+} // namespace Envoy
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/connection_handler.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Monitors event loop responsiveness on a single dispatcher and sheds load when the loop falls
+ * behind. A periodic timer measures its own scheduling delay (how late the timer fires relative
+ * to when it was armed), which approximates how long new work waits before the loop services it.
+ * After several consecutive samples above the high watermark the monitor pauses accepting new
+ * connections on the supplied connection handler; after a longer run of samples below the low
+ * watermark accepting resumes. Connections that cannot be accepted queue in the kernel backlog,
+ * so a brief overload brownout delays new connections instead of collapsing the ones already
+ * established.
+ *
+ * The monitor must be created and destroyed on the dispatcher's thread.
+ */
+class OverloadMonitor : Logger::Loggable<Logger::Id::main> {
+public:
+  OverloadMonitor(Event::Dispatcher& dispatcher, Network::ConnectionHandler& handler,
+                  MonotonicTimeSource& time_source);
+
+  /**
+   * @return whether the monitor is currently shedding load.
+   */
+  bool isShedding() const { return shedding_; }
+
+  // Exposed for testing purposes only.
+  static const std::chrono::milliseconds SampleInterval;
+  static const std::chrono::milliseconds HighWatermark;
+  static const std::chrono::milliseconds LowWatermark;
+
+private:
+  void onSampleTimer();
+
+  Network::ConnectionHandler& handler_;
+  MonotonicTimeSource& time_source_;
+  Event::TimerPtr timer_;
+  MonotonicTime last_sample_;
+  uint32_t consecutive_over_{};
+  uint32_t consecutive_under_{};
+  bool shedding_{};
+};
+
+typedef std::unique_ptr<OverloadMonitor> OverloadMonitorPtr;
+
+} // namespace Server
+} // namespace Envoy
@@ -4,7 +4,9 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/signal.h"
@@ -20,6 +22,7 @@
 #include "common/local_info/local_info_impl.h"
 #include "common/memory/stats.h"
 #include "common/network/address_impl.h"
+#include "common/network/dns_impl.h"
 #include "common/protobuf/utility.h"
 #include "common/router/rds_impl.h"
 #include "common/runtime/runtime_impl.h"
@@ -47,8 +50,10 @@ InstanceImpl::InstanceImpl(Options& options, Network::Address::InstanceConstShar
       thread_local_(tls), api_(new Api::Impl(options.fileFlushIntervalMsec())),
       dispatcher_(api_->allocateDispatcher()), singleton_manager_(new Singleton::ManagerImpl()),
       handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_)),
-      listener_component_factory_(*this), worker_factory_(thread_local_, *api_, hooks),
-      dns_resolver_(dispatcher_->createDnsResolver({})),
+      listener_component_factory_(*this),
+      worker_factory_(thread_local_, *api_, stats_store_, hooks, restarter, options),
+      dns_resolver_(new Network::CachingDnsResolverImpl(dispatcher_->createDnsResolver({}),
+                                                        ProdMonotonicTimeSource::instance_)),
       access_log_manager_(*api_, *dispatcher_, access_log_lock, store) {
 
   failHealthcheck(false);
@@ -90,26 +95,40 @@ void InstanceImpl::failHealthcheck(bool fail) {
   server_stats_.live_.set(!fail);
 }
 
-void InstanceUtil::flushCountersAndGaugesToSinks(const std::list<Stats::SinkPtr>& sinks,
-                                                 Stats::Store& store) {
+void InstanceUtil::snapshotCountersAndGauges(Stats::Store& store, StatsSnapshot& snapshot) {
+  // Only stats that changed since the previous flush are snapshotted. Counters flush deltas so an
+  // idle counter has nothing to report; gauges carry a dirty flag that is latched here. This
+  // keeps the periodic walk from paying the sink and name resolution cost for the large majority
+  // of stats that did not move in the interval.
+  for (const Stats::CounterSharedPtr& counter : store.counters()) {
+    uint64_t delta = counter->latch();
+    if (counter->used() && delta > 0) {
+      snapshot.counters_.push_back(std::make_pair(counter->name(), delta));
+    }
+  }
+
+  for (const Stats::GaugeSharedPtr& gauge : store.gauges()) {
+    if (gauge->used() && gauge->latchDirty()) {
+      snapshot.gauges_.push_back(std::make_pair(gauge->name(), gauge->value()));
+    }
+  }
+}
+
+void InstanceUtil::flushSnapshotToSinks(const std::list<Stats::SinkPtr>& sinks,
+                                        const StatsSnapshot& snapshot) {
   for (const auto& sink : sinks) {
     sink->beginFlush();
   }
 
-  for (const Stats::CounterSharedPtr& counter : store.counters()) {
-    uint64_t delta = counter->latch();
-    if (counter->used()) {
-      for (const auto& sink : sinks) {
-        sink->flushCounter(counter->name(), delta);
-      }
+  for (const auto& counter : snapshot.counters_) {
+    for (const auto& sink : sinks) {
+      sink->flushCounter(counter.first, counter.second);
     }
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : store.gauges()) {
-    if (gauge->used()) {
-      for (const auto& sink : sinks) {
-        sink->flushGauge(gauge->name(), gauge->value());
-      }
+  for (const auto& gauge : snapshot.gauges_) {
+    for (const auto& sink : sinks) {
+      sink->flushGauge(gauge.first, gauge.second);
     }
   }
 
@@ -118,6 +137,13 @@ void InstanceUtil::flushCountersAndGaugesToSinks(const std::list<Stats::SinkPtr>
   }
 }
 
+void InstanceUtil::flushCountersAndGaugesToSinks(const std::list<Stats::SinkPtr>& sinks,
+                                                 Stats::Store& store) {
+  StatsSnapshot snapshot;
+  snapshotCountersAndGauges(store, snapshot);
+  flushSnapshotToSinks(sinks, snapshot);
+}
+
 void InstanceImpl::flushStats() {
   ENVOY_LOG(debug, "flushing stats");
   HotRestart::GetParentStatsInfo info;
@@ -130,8 +156,21 @@ void InstanceImpl::flushStats() {
   server_stats_.total_connections_.set(numConnections() + info.num_connections_);
   server_stats_.days_until_first_cert_expiring_.set(
       sslContextManager().daysUntilFirstCertExpires());
-
-  InstanceUtil::flushCountersAndGaugesToSinks(config_->statsSinks(), stats_store_);
+  server_stats_.log_lines_dropped_.set(Logger::Registry::getSink()->droppedLines());
+
+  if (stat_flush_thread_) {
+    // Snapshotting the changed stats is the cheap part of the flush; all formatting and sink I/O
+    // happens on the flusher thread so a slow sink cannot delay main thread work such as xDS
+    // processing.
+    std::shared_ptr<InstanceUtil::StatsSnapshot> snapshot(new InstanceUtil::StatsSnapshot());
+    InstanceUtil::snapshotCountersAndGauges(stats_store_, *snapshot);
+    stat_flush_thread_->dispatcher().post([this, snapshot]() -> void {
+      InstanceUtil::flushSnapshotToSinks(config_->statsSinks(), *snapshot);
+    });
+  } else {
+    // Final flush during shutdown after the flusher thread has already exited.
+    InstanceUtil::flushCountersAndGaugesToSinks(config_->statsSinks(), stats_store_);
+  }
   stat_flush_timer_->enableTimer(config_->statsFlushInterval());
 }
 
@@ -153,6 +192,12 @@ void InstanceImpl::initialize(Options& options,
   try {
     MessageUtil::loadFromFile(options.configPath(), bootstrap);
   } catch (const EnvoyException& e) {
+    // A binary or text protobuf bootstrap is unambiguously v2, so there is no v1 fallback to
+    // try; surface the real parse error instead of a confusing JSON one.
+    if (StringUtil::endsWith(options.configPath(), ".pb") ||
+        StringUtil::endsWith(options.configPath(), ".pb_text")) {
+      throw;
+    }
     // TODO(htuch): When v1 is deprecated, make this a warning encouraging config upgrade.
     ENVOY_LOG(debug, "Unable to initialize config as v2, will retry as v1: {}", e.what());
   }
@@ -191,6 +236,21 @@ void InstanceImpl::initialize(Options& options,
   // whether it runs on the main thread or on workers can still use TLS.
   thread_local_.registerThread(*dispatcher_, true);
 
+  if (options.dedicatedHealthCheckThread()) {
+    // The health check thread must be registered for thread local updates before threading is
+    // initialized below, since health checking reads runtime snapshots and stats through TLS on
+    // that thread. Work posted to it (e.g. initial session setup during configuration load)
+    // queues until the thread is started once the guard dog exists at the end of initialization.
+    health_check_thread_.reset(new Event::DispatchedThreadImpl());
+    thread_local_.registerThread(health_check_thread_->dispatcher(), false);
+  }
+
+  // Stat flushes run their sink formatting and I/O on a dedicated thread so that a slow sink
+  // cannot delay the main thread. The thread must be registered for thread local updates before
+  // threading is initialized since the sinks (e.g. statsd writers) keep per thread state.
+  stat_flush_thread_.reset(new Event::DispatchedThreadImpl());
+  thread_local_.registerThread(stat_flush_thread_->dispatcher(), false);
+
   // We can now initialize stats for threading.
   stats_store_.initializeThreading(*dispatcher_, thread_local_);
 
@@ -203,7 +263,7 @@ void InstanceImpl::initialize(Options& options,
 
   cluster_manager_factory_.reset(new Upstream::ProdClusterManagerFactory(
       runtime(), stats(), threadLocal(), random(), dnsResolver(), sslContextManager(), dispatcher(),
-      localInfo()));
+      localInfo(), health_check_thread_ ? &health_check_thread_->dispatcher() : nullptr));
 
   // Now the configuration gets parsed. The configuration may start setting thread local data
   // per above. See MainImpl::initialize() for why we do this pointer dance.
@@ -224,6 +284,11 @@ void InstanceImpl::initialize(Options& options,
   // started and before our own run() loop runs.
   guard_dog_.reset(
       new Server::GuardDogImpl(stats_store_, *config_, ProdMonotonicTimeSource::instance_));
+
+  if (health_check_thread_) {
+    health_check_thread_->start(*guard_dog_);
+  }
+  stat_flush_thread_->start(*guard_dog_);
 }
 
 void InstanceImpl::startWorkers() {
@@ -331,12 +396,27 @@ void InstanceImpl::run() {
   // Shutdown all the workers now that the main dispatch loop is done.
   listener_manager_->stopWorkers();
 
-  // Only flush if we have not been hot restarted.
+  // Drain and stop the stat flusher before the final flush below so the two cannot interleave.
+  // As with workers, the thread's TLS data is cleaned up on the thread itself before its dispatch
+  // loop exits.
+  stat_flush_thread_->dispatcher().post([this]() -> void { thread_local_.shutdownThread(); });
+  stat_flush_thread_->exit();
+  stat_flush_thread_.reset();
+
+  // Only flush if we have not been hot restarted. With the flusher thread gone this last flush
+  // runs synchronously here; nothing latency sensitive remains on this thread.
   if (stat_flush_timer_) {
     flushStats();
   }
 
   config_->clusterManager().shutdown();
+  if (health_check_thread_) {
+    // Cluster teardown above posted the final health check session teardown onto the health
+    // check thread; drain it and exit. As with workers, the thread's TLS data is cleaned up on
+    // the thread itself before its dispatch loop exits.
+    health_check_thread_->dispatcher().post([this]() -> void { thread_local_.shutdownThread(); });
+    health_check_thread_->exit();
+  }
   handler_.reset();
   thread_local_.shutdownThread();
   ENVOY_LOG(warn, "exiting");
@@ -6,6 +6,8 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "envoy/common/optional.h"
 #include "envoy/server/configuration.h"
@@ -17,6 +19,7 @@
 #include "envoy/tracing/http_tracer.h"
 
 #include "common/access_log/access_log_manager_impl.h"
+#include "common/event/dispatched_thread.h"
 #include "common/runtime/runtime_impl.h"
 #include "common/ssl/context_manager_impl.h"
 
@@ -38,6 +41,7 @@ namespace Server {
   GAUGE(memory_allocated)                                                                          \
   GAUGE(memory_heap_size)                                                                          \
   GAUGE(live)                                                                                      \
+  GAUGE(log_lines_dropped)                                                                         \
   GAUGE(parent_connections)                                                                        \
   GAUGE(total_connections)                                                                         \
   GAUGE(version)                                                                                   \
@@ -78,8 +82,35 @@ public:
   static Runtime::LoaderPtr createRuntime(Instance& server, Server::Configuration::Initial& config);
 
   /**
-   * Helper for flushing counters and gauges to sinks. This takes care of calling beginFlush(),
-   * latching of counters and flushing, flushing of gauges, and calling endFlush(), on each sink.
+   * Stats that changed since the previous flush, snapshotted out of the store so that sink
+   * formatting and I/O can run on a different thread. Counter entries carry the latched delta,
+   * gauge entries the current value.
+   */
+  struct StatsSnapshot {
+    std::vector<std::pair<std::string, uint64_t>> counters_;
+    std::vector<std::pair<std::string, uint64_t>> gauges_;
+  };
+
+  /**
+   * Latch the stats that changed since the previous flush out of the store into a snapshot. This
+   * is the cheap part of a flush; no sink is touched.
+   * @param store supplies the store to snapshot.
+   * @param snapshot supplies the snapshot to fill.
+   */
+  static void snapshotCountersAndGauges(Stats::Store& store, StatsSnapshot& snapshot);
+
+  /**
+   * Deliver a snapshot to each sink, wrapped in beginFlush()/endFlush() calls.
+   * @param sinks supplies the list of sinks.
+   * @param snapshot supplies the snapshot to deliver.
+   */
+  static void flushSnapshotToSinks(const std::list<Stats::SinkPtr>& sinks,
+                                   const StatsSnapshot& snapshot);
+
+  /**
+   * Helper for flushing counters and gauges to sinks synchronously. This takes care of calling
+   * beginFlush(), latching of counters and flushing, flushing of gauges, and calling endFlush(),
+   * on each sink.
    * @param sinks supplies the list of sinks.
    * @param store supplies the store to flush.
    */
@@ -173,6 +204,14 @@ private:
   Network::ConnectionHandlerPtr handler_;
   Runtime::RandomGeneratorImpl random_generator_;
   Runtime::LoaderPtr runtime_loader_;
+  // Optional dedicated thread for active health checking (--dedicated-health-check-thread).
+  // Declared before config_ since cluster teardown posts the final health check session
+  // teardown onto this thread.
+  std::unique_ptr<Event::DispatchedThreadImpl> health_check_thread_;
+  // Dedicated thread that runs sink formatting and I/O for periodic stat flushes so a slow sink
+  // (e.g. a backed up statsd relay) cannot delay main thread work such as xDS processing.
+  // Declared before config_ since posted flushes read the sink list owned by config_.
+  std::unique_ptr<Event::DispatchedThreadImpl> stat_flush_thread_;
   std::unique_ptr<Ssl::ContextManagerImpl> ssl_context_manager_;
   ProdListenerComponentFactory listener_component_factory_;
   ProdWorkerFactory worker_factory_;
@@ -39,7 +39,13 @@ public:
 private:
   const int32_t thread_id_;
   MonotonicTimeSource& time_source_;
+  // The touch slot is written by the watched thread on every pass through its event loop and read
+  // by the guard thread. Padding on both sides keeps it on its own cache line so touches never
+  // false share with neighboring members or allocations. Plain padding is used instead of
+  // alignas() because C++11 heap allocation does not honor over-aligned types.
+  char padding_before_touch_slot_[64];
   std::atomic<std::chrono::steady_clock::duration> latest_touch_time_since_epoch_;
+  char padding_after_touch_slot_[64];
   Event::TimerPtr timer_;
   const std::chrono::milliseconds timer_interval_;
 };
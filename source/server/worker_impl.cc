@@ -1,5 +1,12 @@
 #include "server/worker_impl.h"
 
+#include <unistd.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <functional>
 
 #include "envoy/event/dispatcher.h"
@@ -8,22 +15,53 @@
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/thread.h"
+#include "common/common/utility.h"
+#include "common/network/listener_impl.h"
 
 #include "server/connection_handler_impl.h"
+#include "server/overload_monitor.h"
+
+#include "fmt/format.h"
 
 namespace Envoy {
 namespace Server {
 
 WorkerPtr ProdWorkerFactory::createWorker() {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
-  return WorkerPtr{new WorkerImpl(
-      tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)})};
+  Stats::ScopePtr scope = stats_.createScope(fmt::format("server.worker_{}.", next_worker_index_));
+  // When this worker's listeners are torn down during a hot restart, idle connections are offered
+  // to the new process instead of being closed. Only TCP sockets can be matched to a listener on
+  // the other side.
+  Network::ConnectionPassHandler pass_handler =
+      [this](int fd, const Network::Address::Instance& local_address,
+             const Network::Address::Instance& remote_address) -> bool {
+    if (local_address.type() != Network::Address::Type::Ip ||
+        remote_address.type() != Network::Address::Type::Ip) {
+      return false;
+    }
+    return hot_restart_.passConnection(fd, fmt::format("tcp://{}", local_address.asString()),
+                                       fmt::format("tcp://{}", remote_address.asString()));
+  };
+  // Workers are pinned to the configured CPU list round-robin, so with a list covering one NUMA
+  // node per socket the memory each worker touches stays node local.
+  Optional<uint32_t> cpu;
+  const std::vector<uint32_t>& affinity = options_.workerCpuAffinity();
+  if (!affinity.empty()) {
+    cpu.value(affinity[next_worker_index_ % affinity.size()]);
+  }
+  return WorkerPtr{new WorkerImpl(tls_, hooks_, std::move(scope), std::move(dispatcher),
+                                  Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(
+                                      ENVOY_LOGGER(), *dispatcher, pass_handler,
+                                      &connection_budget_)},
+                                  next_worker_index_++, cpu)};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
-                       Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler)
-    : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)) {
+                       Stats::ScopePtr&& stats_scope, Event::DispatcherPtr&& dispatcher,
+                       Network::ConnectionHandlerPtr handler, uint32_t index,
+                       Optional<uint32_t> cpu)
+    : tls_(tls), hooks_(hooks), stats_scope_(std::move(stats_scope)),
+      dispatcher_(std::move(dispatcher)), handler_(std::move(handler)), index_(index), cpu_(cpu) {
   tls_.registerThread(*dispatcher_, false);
 }
 
@@ -47,19 +85,60 @@ void WorkerImpl::addListenerWorker(Listener& listener) {
                                                      .use_proxy_proto_ = listener.useProxyProto(),
                                                      .use_original_dst_ = listener.useOriginalDst(),
                                                      .per_connection_buffer_limit_bytes_ =
-                                                         listener.perConnectionBufferLimitBytes()};
+                                                         listener.perConnectionBufferLimitBytes(),
+                                                     .connection_balancer_ =
+                                                         listener.connectionBalancer(),
+                                                     .accept_rate_limiter_ =
+                                                         listener.acceptRateLimiter(),
+                                                     .deferred_accept_ = listener.deferAccept()};
   if (listener.sslContext()) {
     handler_->addSslListener(listener.filterChainFactory(), *listener.sslContext(),
-                             listener.socket(), listener.listenerScope(), listener.listenerTag(),
-                             listener_options);
+                             listener.socketForWorker(index_), listener.listenerScope(),
+                             listener.listenerTag(), listener_options);
   } else {
-    handler_->addListener(listener.filterChainFactory(), listener.socket(),
+    handler_->addListener(listener.filterChainFactory(), listener.socketForWorker(index_),
                           listener.listenerScope(), listener.listenerTag(), listener_options);
   }
 
   hooks_.onWorkerListenerAdded();
 }
 
+void WorkerImpl::addPassedConnection(int fd, Network::Address::InstanceConstSharedPtr local_address,
+                                     Network::Address::InstanceConstSharedPtr remote_address) {
+  // As with balancer handoffs, the owning listener is looked up by address once we are running
+  // on the worker thread, since listeners may be stopped or removed while the post is in flight.
+  dispatcher_->post([this, fd, local_address, remote_address]() -> void {
+    Network::ListenerImpl* listener =
+        dynamic_cast<Network::ListenerImpl*>(handler_->findListenerByAddress(*local_address));
+    if (listener == nullptr) {
+      ::close(fd);
+      return;
+    }
+
+    listener->newConnection(fd, remote_address, local_address, false);
+  });
+}
+
+void WorkerImpl::applyCpuAffinity() {
+  ASSERT(cpu_.valid());
+  // Expose the assignment through the worker's scope (server.worker_N.cpu) so operators can line
+  // up IRQ steering with the worker that owns a given CPU.
+  stats_scope_->gauge("cpu").set(cpu_.value());
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu_.value(), &cpuset);
+  const int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+  if (rc != 0) {
+    ENVOY_LOG(warn, "failed to pin worker {} to cpu {}: {}", index_, cpu_.value(), rc);
+  } else {
+    ENVOY_LOG(info, "worker {} pinned to cpu {}", index_, cpu_.value());
+  }
+#else
+  ENVOY_LOG(warn, "--worker-cpu-affinity is not supported on this platform");
+#endif
+}
+
 uint64_t WorkerImpl::numConnections() {
   uint64_t ret = 0;
   if (handler_) {
@@ -104,12 +183,24 @@ void WorkerImpl::stopListeners() {
 }
 
 void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
+  if (cpu_.valid()) {
+    applyCpuAffinity();
+  }
   ENVOY_LOG(info, "worker entering dispatch loop");
   auto watchdog = guard_dog.createWatchDog(Thread::Thread::currentThreadId());
   watchdog->startWatchdog(*dispatcher_);
+  // Stats are initialized here rather than at construction time so that the first scheduling
+  // delay sample is not polluted by however long the server took between creating the worker
+  // and starting it.
+  dispatcher_->initializeStats(*stats_scope_);
+  // The monitor's timer must be created on this thread, so it cannot be a construction time
+  // member.
+  overload_monitor_.reset(
+      new OverloadMonitor(*dispatcher_, *handler_, ProdMonotonicTimeSource::instance_));
   dispatcher_->run(Event::Dispatcher::RunType::Block);
   ENVOY_LOG(info, "worker exited dispatch loop");
   guard_dog.stopWatching(watchdog);
+  overload_monitor_.reset();
 
   // We must close all active connections before we actually exit the thread. This prevents any
   // destructors from running on the main thread which might reference thread locals. Destroying
@@ -4,15 +4,21 @@
 #include <memory>
 
 #include "envoy/api/api.h"
+#include "envoy/common/optional.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/server/guarddog.h"
+#include "envoy/server/hot_restart.h"
 #include "envoy/server/listener_manager.h"
+#include "envoy/server/options.h"
 #include "envoy/server/worker.h"
+#include "envoy/stats/stats.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 
+#include "server/connection_budget.h"
+#include "server/overload_monitor.h"
 #include "server/test_hooks.h"
 
 namespace Envoy {
@@ -20,8 +26,10 @@ namespace Server {
 
 class ProdWorkerFactory : public WorkerFactory, Logger::Loggable<Logger::Id::main> {
 public:
-  ProdWorkerFactory(ThreadLocal::Instance& tls, Api::Api& api, TestHooks& hooks)
-      : tls_(tls), api_(api), hooks_(hooks) {}
+  ProdWorkerFactory(ThreadLocal::Instance& tls, Api::Api& api, Stats::Store& stats,
+                    TestHooks& hooks, HotRestart& hot_restart, Options& options)
+      : tls_(tls), api_(api), stats_(stats), hooks_(hooks), hot_restart_(hot_restart),
+        options_(options), connection_budget_(options.maxConnections()) {}
 
   // Server::WorkerFactory
   WorkerPtr createWorker() override;
@@ -29,7 +37,14 @@ public:
 private:
   ThreadLocal::Instance& tls_;
   Api::Api& api_;
+  Stats::Store& stats_;
   TestHooks& hooks_;
+  // Used to pass migratable connections to our child during hot restart shutdown.
+  HotRestart& hot_restart_;
+  Options& options_;
+  // Process-wide downstream connection budget shared by all worker connection handlers.
+  ConnectionBudget connection_budget_;
+  uint32_t next_worker_index_{};
 };
 
 /**
@@ -37,11 +52,14 @@ private:
  */
 class WorkerImpl : public Worker, Logger::Loggable<Logger::Id::main> {
 public:
-  WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks, Event::DispatcherPtr&& dispatcher,
-             Network::ConnectionHandlerPtr handler);
+  WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks, Stats::ScopePtr&& stats_scope,
+             Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler,
+             uint32_t index, Optional<uint32_t> cpu = Optional<uint32_t>());
 
   // Server::Worker
   void addListener(Listener& listener, AddListenerCompletion completion) override;
+  void addPassedConnection(int fd, Network::Address::InstanceConstSharedPtr local_address,
+                           Network::Address::InstanceConstSharedPtr remote_address) override;
   uint64_t numConnections() override;
   void removeListener(Listener& listener, std::function<void()> completion) override;
   void start(GuardDog& guard_dog) override;
@@ -51,13 +69,25 @@ public:
 
 private:
   void addListenerWorker(Listener& listener);
+  void applyCpuAffinity();
   void threadRoutine(GuardDog& guard_dog);
 
   ThreadLocal::Instance& tls_;
   TestHooks& hooks_;
+  // Per-worker stats scope (e.g. server.worker_0.) so that a single saturated worker is visible
+  // rather than hiding inside process level aggregates.
+  Stats::ScopePtr stats_scope_;
   Event::DispatcherPtr dispatcher_;
   Network::ConnectionHandlerPtr handler_;
+  // Index of this worker within the server, used to select a listener's per-worker socket when
+  // SO_REUSEPORT sockets are in use.
+  const uint32_t index_;
+  // CPU this worker's thread is pinned to, if --worker-cpu-affinity is in use. Pinning keeps the
+  // per-connection buffer memory the worker allocates NUMA-local via first touch.
+  const Optional<uint32_t> cpu_;
   Thread::ThreadPtr thread_;
+  // Created and destroyed on the worker thread; sheds load when the event loop falls behind.
+  OverloadMonitorPtr overload_monitor_;
 };
 
 } // namespace Server
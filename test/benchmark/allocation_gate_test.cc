@@ -0,0 +1,258 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/http/access_log.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/access_log/access_log_formatter.h"
+#include "common/http/access_log/access_log_impl.h"
+#include "common/http/conn_manager_impl.h"
+#include "common/http/date_provider_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/network/address_impl.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::Test;
+using testing::_;
+
+// Interposed counting allocator. These strong definitions replace the global allocator for this
+// test binary only and count every heap allocation, so the gates below can assert per-request
+// allocation budgets.
+static std::atomic<uint64_t> allocation_count(0);
+
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+void operator delete[](void* ptr) noexcept { free(ptr); }
+
+namespace Envoy {
+namespace Http {
+
+// Per-scenario allocation budgets for one steady-state, headers-only request. The measured counts
+// include gmock dispatch overhead, so the absolute numbers are only meaningful relative to
+// previous runs of this test; the budgets are loose ceilings that exist to make a PR which adds
+// per-request allocations fail with a count diff. When a change legitimately moves a count,
+// re-measure and adjust the budget in the same PR — and when a change lowers allocations, ratchet
+// the budget down so the win sticks.
+const uint64_t PlainProxyBudget = 5000;
+const uint64_t AccessLogBudget = 5000;
+const uint64_t TracingBudget = 5000;
+const uint64_t FilterChainBudget = 5000;
+
+// Drives a headers-only request through ConnectionManagerImpl and measures the allocation count
+// of the second (steady-state) request, so one-time costs such as codec creation and lazily
+// initialized statics are excluded from the gate.
+class AllocationGateTest : public Test, public ConnectionManagerConfig {
+public:
+  struct RouteConfigProvider : public Router::RouteConfigProvider {
+    // Router::RouteConfigProvider
+    Router::ConfigConstSharedPtr config() override { return route_config_; }
+    const std::string versionInfo() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
+
+    std::shared_ptr<Router::MockConfig> route_config_{new NiceMock<Router::MockConfig>()};
+  };
+
+  AllocationGateTest()
+      : codec_(new NiceMock<MockServerConnection>()),
+        stats_{{ALL_HTTP_CONN_MAN_STATS(POOL_COUNTER(fake_stats_), POOL_GAUGE(fake_stats_),
+                                        POOL_TIMER(fake_stats_))},
+               "",
+               fake_stats_},
+        tracing_stats_{CONN_MAN_TRACING_STATS(POOL_COUNTER(fake_stats_))} {}
+
+  ~AllocationGateTest() { filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList(); }
+
+  void setup() {
+    ON_CALL(filter_callbacks_.connection_, remoteAddress())
+        .WillByDefault(testing::ReturnRef(remote_address_));
+    conn_manager_.reset(new ConnectionManagerImpl(*this, drain_close_, random_, tracer_, runtime_,
+                                                  local_info_, cluster_manager_));
+    conn_manager_->initializeReadFilterCallbacks(filter_callbacks_);
+  }
+
+  // Installs a chain of pass-through decoder filters; the last filter answers the request with a
+  // 200 so the stream completes without an upstream.
+  void setupRequestPipeline(int num_filters) {
+    for (int i = 0; i < num_filters; i++) {
+      filters_.push_back(std::make_shared<NiceMock<MockStreamDecoderFilter>>());
+    }
+
+    for (int i = 0; i < num_filters - 1; i++) {
+      ON_CALL(*filters_[i], decodeHeaders(_, true))
+          .WillByDefault(Return(FilterHeadersStatus::Continue));
+    }
+    ON_CALL(*filters_.back(), decodeHeaders(_, true))
+        .WillByDefault(Return(FilterHeadersStatus::StopIteration));
+
+    ON_CALL(filter_factory_, createFilterChain(_))
+        .WillByDefault(Invoke([this](FilterChainFactoryCallbacks& callbacks) -> void {
+          for (const auto& filter : filters_) {
+            callbacks.addStreamDecoderFilter(filter);
+          }
+        }));
+
+    ON_CALL(*codec_, dispatch(_)).WillByDefault(Invoke([this](Buffer::Instance& data) -> void {
+      StreamDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+      HeaderMapPtr headers{
+          new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+      decoder->decodeHeaders(std::move(headers), true);
+
+      HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+      filters_.back()->callbacks_->encodeHeaders(std::move(response_headers), true);
+      data.drain(data.length());
+    }));
+  }
+
+  uint64_t measureRequest() {
+    Buffer::OwnedImpl fake_input("1234");
+    const uint64_t before = allocation_count.load(std::memory_order_relaxed);
+    conn_manager_->onData(fake_input);
+    return allocation_count.load(std::memory_order_relaxed) - before;
+  }
+
+  uint64_t measureSteadyStateRequest() {
+    measureRequest();
+    filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+    return measureRequest();
+  }
+
+  // Http::ConnectionManagerConfig
+  const std::list<AccessLog::InstanceSharedPtr>& accessLogs() override { return access_logs_; }
+  ServerConnectionPtr createCodec(Network::Connection&, const Buffer::Instance&,
+                                  ServerConnectionCallbacks&) override {
+    return ServerConnectionPtr{codec_};
+  }
+  DateProvider& dateProvider() override { return date_provider_; }
+  std::chrono::milliseconds drainTimeout() override { return std::chrono::milliseconds(100); }
+  FilterChainFactory& filterFactory() override { return filter_factory_; }
+  bool generateRequestId() override { return true; }
+  const Optional<std::chrono::milliseconds>& idleTimeout() override { return idle_timeout_; }
+  Router::RouteConfigProvider& routeConfigProvider() override { return route_config_provider_; }
+  const std::string& serverName() override { return server_name_; }
+  ConnectionManagerStats& stats() override { return stats_; }
+  ConnectionManagerTracingStats& tracingStats() override { return tracing_stats_; }
+  bool useRemoteAddress() override { return true; }
+  Http::ForwardClientCertType forwardClientCert() override {
+    return Http::ForwardClientCertType::Sanitize;
+  }
+  const std::vector<Http::ClientCertDetailsType>& setCurrentClientCertDetails() const override {
+    return set_current_client_cert_details_;
+  }
+  const Network::Address::Instance& localAddress() override { return local_address_; }
+  const Optional<std::string>& userAgent() override { return user_agent_; }
+  const TracingConnectionManagerConfig* tracingConfig() override { return tracing_config_.get(); }
+
+  NiceMock<Tracing::MockHttpTracer> tracer_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Envoy::AccessLog::MockAccessLogManager> log_manager_;
+  std::list<AccessLog::InstanceSharedPtr> access_logs_;
+  Stats::IsolatedStoreImpl fake_stats_;
+  NiceMock<Network::MockReadFilterCallbacks> filter_callbacks_;
+  MockServerConnection* codec_;
+  NiceMock<MockFilterChainFactory> filter_factory_;
+  ConnectionManagerStats stats_;
+  ConnectionManagerTracingStats tracing_stats_;
+  NiceMock<Network::MockDrainDecision> drain_close_;
+  std::unique_ptr<ConnectionManagerImpl> conn_manager_;
+  std::string server_name_{"envoy"};
+  Network::Address::Ipv4Instance local_address_{"127.0.0.1"};
+  Network::Address::Ipv4Instance remote_address_{"0.0.0.0"};
+  std::vector<Http::ClientCertDetailsType> set_current_client_cert_details_;
+  Optional<std::string> user_agent_;
+  Optional<std::chrono::milliseconds> idle_timeout_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  RouteConfigProvider route_config_provider_;
+  TracingConnectionManagerConfigPtr tracing_config_;
+  SlowDateProviderImpl date_provider_;
+  NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  NiceMock<MockStreamEncoder> response_encoder_;
+  std::vector<std::shared_ptr<NiceMock<MockStreamDecoderFilter>>> filters_;
+};
+
+TEST_F(AllocationGateTest, PlainProxy) {
+  setup();
+  setupRequestPipeline(1);
+
+  const uint64_t allocations = measureSteadyStateRequest();
+  RecordProperty("allocations", std::to_string(allocations));
+  EXPECT_LE(allocations, PlainProxyBudget);
+}
+
+TEST_F(AllocationGateTest, WithAccessLog) {
+  access_logs_.emplace_back(new AccessLog::FileAccessLog(
+      "dummy_path", {}, AccessLog::AccessLogFormatUtils::defaultAccessLogFormatter(),
+      log_manager_));
+  setup();
+  setupRequestPipeline(1);
+
+  const uint64_t allocations = measureSteadyStateRequest();
+  RecordProperty("allocations", std::to_string(allocations));
+  EXPECT_LE(allocations, AccessLogBudget);
+}
+
+TEST_F(AllocationGateTest, WithTracing) {
+  tracing_config_.reset(new TracingConnectionManagerConfig(
+      {Tracing::OperationName::Ingress, {LowerCaseString(":method")}}));
+  setup();
+  setupRequestPipeline(1);
+
+  const uint64_t allocations = measureSteadyStateRequest();
+  RecordProperty("allocations", std::to_string(allocations));
+  EXPECT_LE(allocations, TracingBudget);
+}
+
+// Stand-in for a multi-filter configuration such as ratelimit + router: the per-stream filter
+// bookkeeping dominates the cost a real side-call filter adds on the cache-hit path.
+TEST_F(AllocationGateTest, ThreeFilterChain) {
+  setup();
+  setupRequestPipeline(3);
+
+  const uint64_t allocations = measureSteadyStateRequest();
+  RecordProperty("allocations", std::to_string(allocations));
+  EXPECT_LE(allocations, FilterChainBudget);
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,64 @@
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Buffer {
+
+static void BM_BufferAdd(benchmark::State& state) {
+  const std::string data(state.range(0), 'a');
+
+  while (state.KeepRunning()) {
+    OwnedImpl buffer;
+    // Write 64K in chunks of the configured size, which is what the codecs and filters tend to
+    // do rather than a single large add.
+    for (uint64_t added = 0; added < 65536; added += data.size()) {
+      buffer.add(data.data(), data.size());
+    }
+    benchmark::DoNotOptimize(buffer.length());
+  }
+}
+BENCHMARK(BM_BufferAdd)->Arg(128)->Arg(4096)->Arg(16384);
+
+static void BM_BufferMove(benchmark::State& state) {
+  const std::string data(4096, 'a');
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    OwnedImpl source;
+    for (uint64_t added = 0; added < static_cast<uint64_t>(state.range(0)); added += data.size()) {
+      source.add(data.data(), data.size());
+    }
+    OwnedImpl destination;
+    state.ResumeTiming();
+
+    destination.move(source);
+    benchmark::DoNotOptimize(destination.length());
+  }
+}
+BENCHMARK(BM_BufferMove)->Arg(4096)->Arg(65536)->Arg(1048576);
+
+static void BM_BufferDrain(benchmark::State& state) {
+  const std::string data(4096, 'a');
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    OwnedImpl buffer;
+    for (uint64_t added = 0; added < 65536; added += data.size()) {
+      buffer.add(data.data(), data.size());
+    }
+    state.ResumeTiming();
+
+    while (buffer.length() > 0) {
+      buffer.drain(state.range(0));
+    }
+  }
+}
+BENCHMARK(BM_BufferDrain)->Arg(128)->Arg(4096)->Arg(16384);
+
+} // namespace Buffer
+} // namespace Envoy
+
+BENCHMARK_MAIN()
@@ -0,0 +1,36 @@
+#include <functional>
+#include <string>
+
+#include "common/common/hash.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+
+// Ring hash and hash policy keys are short (an address plus a replica suffix, or a header
+// value); stats and config hashing see longer inputs. Cover both ends of that range.
+static void BM_XxHash64(benchmark::State& state) {
+  const std::string input(state.range(0), 'a');
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(HashUtil::xxHash64(input));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_XxHash64)->Arg(24)->Arg(128)->Arg(4096);
+
+// The legacy hash still used for ring placement until deployments flip
+// upstream.ring_hash.use_std_hash; kept here for comparison.
+static void BM_StdHash(benchmark::State& state) {
+  const std::string input(state.range(0), 'a');
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(std::hash<std::string>()(input));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_StdHash)->Arg(24)->Arg(128)->Arg(4096);
+
+} // namespace Envoy
+
+BENCHMARK_MAIN()
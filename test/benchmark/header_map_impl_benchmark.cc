@@ -0,0 +1,62 @@
+#include <string>
+#include <vector>
+
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Http {
+
+static std::vector<LowerCaseString> makeCustomKeys(uint64_t num_keys) {
+  std::vector<LowerCaseString> keys;
+  for (uint64_t i = 0; i < num_keys; i++) {
+    keys.emplace_back(fmt::format("x-custom-header-{}", i));
+  }
+  return keys;
+}
+
+static void BM_HeaderMapImplInsert(benchmark::State& state) {
+  const std::vector<LowerCaseString> keys = makeCustomKeys(state.range(0));
+  const std::string value = "01234567890123456789";
+
+  while (state.KeepRunning()) {
+    HeaderMapImpl headers;
+    for (const LowerCaseString& key : keys) {
+      headers.addCopy(key, value);
+    }
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_HeaderMapImplInsert)->Arg(4)->Arg(16)->Arg(64);
+
+static void BM_HeaderMapImplLookupInline(benchmark::State& state) {
+  HeaderMapImpl headers;
+  headers.addCopy(Headers::get().Status, "200");
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(headers.get(Headers::get().Status));
+  }
+}
+BENCHMARK(BM_HeaderMapImplLookupInline);
+
+static void BM_HeaderMapImplLookupCustom(benchmark::State& state) {
+  const std::vector<LowerCaseString> keys = makeCustomKeys(state.range(0));
+  HeaderMapImpl headers;
+  for (const LowerCaseString& key : keys) {
+    headers.addCopy(key, "value");
+  }
+
+  while (state.KeepRunning()) {
+    // Worst case: the key inserted last requires a scan over every entry.
+    benchmark::DoNotOptimize(headers.get(keys.back()));
+  }
+}
+BENCHMARK(BM_HeaderMapImplLookupCustom)->Arg(4)->Arg(16)->Arg(64);
+
+} // namespace Http
+} // namespace Envoy
+
+BENCHMARK_MAIN()
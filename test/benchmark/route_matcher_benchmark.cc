@@ -0,0 +1,105 @@
+#include <string>
+
+#include "common/config/rds_json.h"
+#include "common/http/header_map_impl.h"
+#include "common/json/json_loader.h"
+#include "common/router/config_impl.h"
+
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Router {
+
+static envoy::api::v2::RouteConfiguration parseRouteConfigurationFromJson(
+    const std::string& json_string) {
+  envoy::api::v2::RouteConfiguration route_config;
+  Json::ObjectSharedPtr json_object_ptr = Json::Factory::loadFromString(json_string);
+  Envoy::Config::RdsJson::translateRouteConfiguration(*json_object_ptr, route_config);
+  return route_config;
+}
+
+static std::string routeConfigJson() {
+  return R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "www",
+      "domains": ["www.lyft.com", "w.lyft.com", "ww.lyft.com", "wwww.lyft.com"],
+      "routes": [
+        {"prefix": "/new_endpoint", "prefix_rewrite": "/api/new_endpoint", "cluster": "www"},
+        {"path": "/exact/path", "cluster": "www_exact"},
+        {"prefix": "/api", "cluster": "www_api"},
+        {"prefix": "/", "cluster": "www"}
+      ]
+    },
+    {
+      "name": "api",
+      "domains": ["api.lyft.com"],
+      "routes": [
+        {"prefix": "/", "cluster": "api"}
+      ]
+    },
+    {
+      "name": "wildcard",
+      "domains": ["*"],
+      "routes": [
+        {"prefix": "/", "cluster": "default"}
+      ]
+    }
+  ]
+}
+  )EOF";
+}
+
+static void BM_RouteMatcherPrefixMatch(benchmark::State& state) {
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(routeConfigJson()), runtime, cm, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", "www.lyft.com"}, {":path", "/api/locations"}, {":method", "GET"}};
+
+  uint64_t random_value = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(config.route(headers, random_value++));
+  }
+}
+BENCHMARK(BM_RouteMatcherPrefixMatch);
+
+static void BM_RouteMatcherExactPathMatch(benchmark::State& state) {
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(routeConfigJson()), runtime, cm, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", "www.lyft.com"}, {":path", "/exact/path"}, {":method", "GET"}};
+
+  uint64_t random_value = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(config.route(headers, random_value++));
+  }
+}
+BENCHMARK(BM_RouteMatcherExactPathMatch);
+
+static void BM_RouteMatcherWildcardVirtualHost(benchmark::State& state) {
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(routeConfigJson()), runtime, cm, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", "unknown.example.com"}, {":path", "/foo"}, {":method", "GET"}};
+
+  uint64_t random_value = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(config.route(headers, random_value++));
+  }
+}
+BENCHMARK(BM_RouteMatcherWildcardVirtualHost);
+
+} // namespace Router
+} // namespace Envoy
+
+BENCHMARK_MAIN()
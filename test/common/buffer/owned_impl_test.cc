@@ -0,0 +1,179 @@
+#include <unistd.h>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+std::string toString(const Instance& buffer) {
+  uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  RawSlice slices[num_slices];
+  buffer.getRawSlices(slices, num_slices);
+  std::string out;
+  for (RawSlice& slice : slices) {
+    out.append(static_cast<const char*>(slice.mem_), slice.len_);
+  }
+  return out;
+}
+
+TEST(OwnedImplTest, AddAndDrain) {
+  OwnedImpl buffer;
+  EXPECT_EQ(0UL, buffer.length());
+  buffer.add("hello");
+  buffer.add(" world", 6);
+  EXPECT_EQ(11UL, buffer.length());
+  EXPECT_EQ("hello world", toString(buffer));
+
+  buffer.drain(6);
+  EXPECT_EQ(5UL, buffer.length());
+  EXPECT_EQ("world", toString(buffer));
+  buffer.drain(5);
+  EXPECT_EQ(0UL, buffer.length());
+}
+
+TEST(OwnedImplTest, AddSpanningSlices) {
+  OwnedImpl buffer;
+  const std::string big(10000, 'a');
+  buffer.add(big);
+  EXPECT_EQ(big.size(), buffer.length());
+  EXPECT_GT(buffer.getRawSlices(nullptr, 0), 1UL);
+  EXPECT_EQ(big, toString(buffer));
+}
+
+TEST(OwnedImplTest, Move) {
+  OwnedImpl buffer1("hello");
+  OwnedImpl buffer2;
+  buffer2.move(buffer1);
+  EXPECT_EQ(0UL, buffer1.length());
+  EXPECT_EQ("hello", toString(buffer2));
+}
+
+TEST(OwnedImplTest, PartialMove) {
+  OwnedImpl buffer1("hello world");
+  OwnedImpl buffer2;
+  buffer2.move(buffer1, 5);
+  EXPECT_EQ(6UL, buffer1.length());
+  EXPECT_EQ(" world", toString(buffer1));
+  EXPECT_EQ("hello", toString(buffer2));
+}
+
+TEST(OwnedImplTest, Linearize) {
+  OwnedImpl buffer;
+  const std::string big(10000, 'b');
+  buffer.add(big);
+  ASSERT_GT(buffer.getRawSlices(nullptr, 0), 1UL);
+  const char* data = static_cast<const char*>(buffer.linearize(10000));
+  EXPECT_EQ(big, std::string(data, 10000));
+  EXPECT_EQ(big.size(), buffer.length());
+}
+
+TEST(OwnedImplTest, ReserveCommit) {
+  OwnedImpl buffer;
+  RawSlice slices[2];
+  uint64_t num_slices = buffer.reserve(100, slices, 2);
+  ASSERT_GE(num_slices, 1UL);
+  memcpy(slices[0].mem_, "abcd", 4);
+  slices[0].len_ = 4;
+  buffer.commit(slices, 1);
+  EXPECT_EQ(4UL, buffer.length());
+  EXPECT_EQ("abcd", toString(buffer));
+}
+
+TEST(OwnedImplTest, ReserveSingleIovecCoversFullLength) {
+  OwnedImpl buffer;
+  RawSlice slice;
+  ASSERT_EQ(1UL, buffer.reserve(4096, &slice, 1));
+  // Leave a small reservable tail on the slice.
+  slice.len_ = 4000;
+  buffer.commit(&slice, 1);
+
+  // The tail alone cannot satisfy the request, so a single iovec reservation must skip it and
+  // hand out a fresh slice covering the full length; callers write up to the requested length
+  // without rechecking.
+  ASSERT_EQ(1UL, buffer.reserve(4096, &slice, 1));
+  EXPECT_EQ(4096UL, slice.len_);
+  buffer.commit(&slice, 1);
+  EXPECT_EQ(8096UL, buffer.length());
+}
+
+TEST(OwnedImplTest, ReadTrimsUnusedReservation) {
+  SlicePool pool;
+  pool.installOnThread();
+
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  ASSERT_EQ(4, write(pipe_fds[1], "abcd", 4));
+
+  OwnedImpl buffer;
+  EXPECT_EQ(4, buffer.read(pipe_fds[0], 3 * Slice::default_slice_size_));
+  EXPECT_EQ("abcd", toString(buffer));
+  // The slices reserved for the read that received no data go back to the pool instead of being
+  // retained as empty tail slices.
+  EXPECT_EQ(2UL, pool.freeSlices());
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+TEST(OwnedImplTest, Search) {
+  OwnedImpl buffer;
+  // Build a buffer with multiple slices so the match can span a slice boundary.
+  const std::string filler(Slice::default_slice_size_ - 2, 'x');
+  buffer.add(filler);
+  buffer.add("needle");
+  EXPECT_EQ(static_cast<ssize_t>(filler.size()), buffer.search("needle", 6, 0));
+  EXPECT_EQ(-1, buffer.search("missing", 7, 0));
+  EXPECT_EQ(-1, buffer.search("needle", 6, filler.size() + 1));
+  EXPECT_EQ(0, buffer.search("x", 1, 0));
+  EXPECT_EQ(static_cast<ssize_t>(filler.size()), buffer.search("needle", 6, filler.size()));
+  // Every 'x' in the filler is a false candidate for this needle; only the last one matches, and
+  // the match spans the slice boundary.
+  EXPECT_EQ(static_cast<ssize_t>(filler.size() - 1), buffer.search("xneedle", 7, 0));
+}
+
+TEST(SlicePoolTest, RecycleThroughActivePool) {
+  SlicePool pool;
+  pool.installOnThread();
+  EXPECT_EQ(&pool, SlicePool::activePool());
+  EXPECT_EQ(0UL, pool.freeSlices());
+
+  {
+    OwnedImpl buffer;
+    buffer.add("hello");
+  }
+  EXPECT_EQ(1UL, pool.freeSlices());
+
+  // A new buffer picks the slice back up.
+  OwnedImpl buffer;
+  buffer.add("world");
+  EXPECT_EQ(0UL, pool.freeSlices());
+  EXPECT_EQ("world", toString(buffer));
+}
+
+TEST(SlicePoolTest, LargeSlicesAreNotPooled) {
+  SlicePool pool;
+  pool.installOnThread();
+  {
+    OwnedImpl buffer;
+    RawSlice slice;
+    buffer.reserve(3 * Slice::default_slice_size_, &slice, 1);
+    slice.len_ = 1;
+    buffer.commit(&slice, 1);
+  }
+  EXPECT_EQ(0UL, pool.freeSlices());
+}
+
+TEST(SlicePoolTest, UninstalledOnDestruction) {
+  {
+    SlicePool pool;
+    pool.installOnThread();
+    EXPECT_EQ(&pool, SlicePool::activePool());
+  }
+  EXPECT_EQ(nullptr, SlicePool::activePool());
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
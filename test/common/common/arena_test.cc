@@ -0,0 +1,66 @@
+#include <cstdint>
+#include <memory>
+
+#include "common/common/arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+struct TrackedObject {
+  TrackedObject(int value, int& live) : value_(value), live_(live) { live_++; }
+  ~TrackedObject() { live_--; }
+
+  const int value_;
+  int& live_;
+};
+
+} // namespace
+
+TEST(ArenaTest, AlignedAllocation) {
+  Arena arena;
+  EXPECT_EQ(0U, arena.numChunks());
+
+  void* p = arena.allocate(8, 8);
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 8);
+  EXPECT_EQ(1U, arena.numChunks());
+
+  // Force misalignment and make sure the next allocation is realigned.
+  arena.allocate(1, 1);
+  p = arena.allocate(16, 16);
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 16);
+  EXPECT_EQ(1U, arena.numChunks());
+}
+
+TEST(ArenaTest, ChunkGrowth) {
+  Arena arena(64);
+  arena.allocate(8, 8);
+  EXPECT_EQ(1U, arena.numChunks());
+
+  // An allocation larger than the chunk size gets a dedicated chunk.
+  arena.allocate(1024, 8);
+  EXPECT_EQ(2U, arena.numChunks());
+
+  // Filling up a chunk rolls over to a new one.
+  for (int i = 0; i < 200; i++) {
+    arena.allocate(8, 8);
+  }
+  EXPECT_LT(2U, arena.numChunks());
+}
+
+TEST(ArenaTest, MakeAndDeleter) {
+  Arena arena;
+  int live = 0;
+  {
+    std::unique_ptr<TrackedObject, ArenaDeleter> object(arena.make<TrackedObject>(37, live));
+    EXPECT_EQ(37, object->value_);
+    EXPECT_EQ(1, live);
+  }
+
+  // The deleter runs the destructor; the memory is not reclaimed until the arena dies.
+  EXPECT_EQ(0, live);
+  EXPECT_EQ(1U, arena.numChunks());
+}
+
+} // namespace Envoy
@@ -34,4 +34,31 @@ TEST(Logger, All) {
   // Misc logging with no facility.
   ENVOY_LOG_MISC(info, "fake message");
 }
+
+TEST(Logger, LazyEvaluation) {
+  // Format arguments must not be evaluated when the line's level is disabled.
+  spdlog::logger& logger = Logger::Registry::getLog(Logger::Id::testing);
+  const spdlog::level::level_enum original_level = logger.level();
+  logger.set_level(spdlog::level::critical);
+  uint32_t evaluations = 0;
+  auto expensive_argument = [&evaluations]() -> std::string {
+    evaluations++;
+    return "expensive";
+  };
+  ENVOY_LOG_TO_LOGGER(logger, info, "{}", expensive_argument());
+  EXPECT_EQ(0U, evaluations);
+  logger.set_level(original_level);
+}
+
+TEST(Logger, AsyncSink) {
+  Logger::LockingStderrSink sink;
+  sink.startAsync(4);
+  spdlog::details::log_msg msg;
+  msg.level = spdlog::level::info;
+  msg.formatted << "async sink test line\n";
+  sink.log(msg);
+  // flush() returns only once the log thread has drained the queue.
+  sink.flush();
+  EXPECT_EQ(0UL, sink.droppedLines());
+}
 } // namespace Envoy
\ No newline at end of file
@@ -26,5 +26,17 @@ TEST(ToLowerTableTest, All) {
     table.toLowerCase(input);
     EXPECT_EQ(input, "\x90hello\x90");
   }
+  {
+    // The characters bracketing the upper case range must pass through untouched, including in
+    // strings long enough to take the word-at-a-time path.
+    std::string input("@AZ[`az{@AZ[`az{@AZ[`az{");
+    table.toLowerCase(input);
+    EXPECT_EQ(input, "@az[`az{@az[`az{@az[`az{");
+  }
+  {
+    std::string input("X-ENVOY-UPSTREAM-SERVICE-TIME");
+    table.toLowerCase(input);
+    EXPECT_EQ(input, "x-envoy-upstream-service-time");
+  }
 }
 } // namespace Envoy
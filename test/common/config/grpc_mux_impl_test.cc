@@ -45,7 +45,7 @@ public:
 
   void expectSendMessage(const std::string& type_url,
                          const std::vector<std::string>& resource_names,
-                         const std::string& version) {
+                         const std::string& version, const std::string& nonce = "") {
     envoy::api::v2::DiscoveryRequest expected_request;
     expected_request.mutable_node()->CopyFrom(node_);
     for (const auto& resource : resource_names) {
@@ -54,7 +54,7 @@ public:
     if (!version.empty()) {
       expected_request.set_version_info(version);
     }
-    expected_request.set_response_nonce("");
+    expected_request.set_response_nonce(nonce);
     expected_request.set_type_url(type_url);
     EXPECT_CALL(async_stream_, sendMessage(ProtoEq(expected_request), false));
   }
@@ -115,6 +115,37 @@ TEST_F(GrpcMuxImplTest, ResetStream) {
   expectSendMessage("foo", {}, "");
 }
 
+// Validate that a response nonce is not replayed across stream reconnects, while the last
+// accepted version is still resumed from.
+TEST_F(GrpcMuxImplTest, NonceClearedOnStreamReset) {
+  InSequence s;
+  auto foo_sub = grpc_mux_->subscribe("foo", {"x", "y"}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage("foo", {"x", "y"}, "");
+  grpc_mux_->start();
+
+  // Accept an update, which is ACKed with the response's version and nonce.
+  std::unique_ptr<envoy::api::v2::DiscoveryResponse> response(
+      new envoy::api::v2::DiscoveryResponse());
+  response->set_type_url("foo");
+  response->set_version_info("1");
+  response->set_nonce("A");
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"));
+  expectSendMessage("foo", {"x", "y"}, "1", "A");
+  grpc_mux_->onReceiveMessage(std::move(response));
+
+  // The request on the new stream resumes from the accepted version but must not carry the nonce
+  // from the dead stream.
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_));
+  EXPECT_CALL(*timer_, enableTimer(_));
+  grpc_mux_->onRemoteClose(Grpc::Status::GrpcStatus::Canceled, "");
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage("foo", {"x", "y"}, "1");
+  timer_cb_();
+
+  expectSendMessage("foo", {}, "1");
+}
+
 // Validate behavior when type URL mismatches occur.
 TEST_F(GrpcMuxImplTest, TypeUrlMismatch) {
   InSequence s;
@@ -40,6 +40,103 @@ TEST_F(HttpSubscriptionImplTest, BadJsonRecovery) {
   verifyStats(3, 1, 0, 1);
 }
 
+// Validate that a binary protobuf response body is parsed natively.
+TEST_F(HttpSubscriptionImplTest, BinaryProtobufResponse) {
+  startSubscription({"cluster0", "cluster1"});
+
+  envoy::api::v2::DiscoveryResponse response_pb;
+  EXPECT_TRUE(Protobuf::util::JsonStringToMessage(responseJson({"cluster0", "cluster1"}, "0"),
+                                                  &response_pb)
+                  .ok());
+  Http::HeaderMapPtr response_headers{new Http::TestHeaderMapImpl{
+      {":status", "200"}, {"content-type", "application/x-protobuf"}}};
+  Http::MessagePtr message{new Http::ResponseMessageImpl(std::move(response_headers))};
+  message->body().reset(new Buffer::OwnedImpl(response_pb.SerializeAsString()));
+  EXPECT_CALL(callbacks_,
+              onConfigUpdate(RepeatedProtoEq(
+                  Config::Utility::getTypedResources<envoy::api::v2::ClusterLoadAssignment>(
+                      response_pb))));
+  EXPECT_CALL(random_gen_, random()).WillOnce(Return(0));
+  EXPECT_CALL(*timer_, enableTimer(_));
+  http_callbacks_->onSuccess(std::move(message));
+  EXPECT_EQ("0", subscription_->versionInfo());
+  verifyStats(1, 1, 0, 0);
+  version_ = "0";
+  request_in_progress_ = false;
+  timerTick();
+}
+
+// Validate that the client can recover from a corrupt binary protobuf response.
+TEST_F(HttpSubscriptionImplTest, BadBinaryProtobufRecovery) {
+  startSubscription({"cluster0", "cluster1"});
+  Http::HeaderMapPtr response_headers{new Http::TestHeaderMapImpl{
+      {":status", "200"}, {"content-type", "application/x-protobuf"}}};
+  Http::MessagePtr message{new Http::ResponseMessageImpl(std::move(response_headers))};
+  message->body().reset(new Buffer::OwnedImpl("\x01\x02notaproto"));
+  EXPECT_CALL(random_gen_, random()).WillOnce(Return(0));
+  EXPECT_CALL(*timer_, enableTimer(_));
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_));
+  http_callbacks_->onSuccess(std::move(message));
+  verifyStats(1, 0, 0, 1);
+  request_in_progress_ = false;
+  timerTick();
+  verifyStats(2, 0, 0, 1);
+  deliverConfigUpdate({"cluster0", "cluster1"}, "0", true);
+  verifyStats(3, 1, 0, 1);
+}
+
+// Validate that a response with a byte for byte identical body is not re-parsed.
+TEST_F(HttpSubscriptionImplTest, UnchangedBodySkipsParse) {
+  startSubscription({"cluster0", "cluster1"});
+  deliverConfigUpdate({"cluster0", "cluster1"}, "0", true);
+  verifyStats(2, 1, 0, 0);
+
+  Http::HeaderMapPtr response_headers{new Http::TestHeaderMapImpl{{":status", "200"}}};
+  Http::MessagePtr message{new Http::ResponseMessageImpl(std::move(response_headers))};
+  message->body().reset(new Buffer::OwnedImpl(responseJson({"cluster0", "cluster1"}, "0")));
+  EXPECT_CALL(callbacks_, onConfigUpdate(_)).Times(0);
+  EXPECT_CALL(random_gen_, random()).WillOnce(Return(0));
+  EXPECT_CALL(*timer_, enableTimer(_));
+  http_callbacks_->onSuccess(std::move(message));
+  verifyStats(2, 1, 0, 0);
+  request_in_progress_ = false;
+  timerTick();
+}
+
+// Validate that a 304 is treated as an unchanged document and the poll continues.
+TEST_F(HttpSubscriptionImplTest, NotModifiedResponse) {
+  startSubscription({"cluster0", "cluster1"});
+  deliverConfigUpdate({"cluster0", "cluster1"}, "0", true);
+
+  Http::HeaderMapPtr response_headers{new Http::TestHeaderMapImpl{{":status", "304"}}};
+  Http::MessagePtr message{new Http::ResponseMessageImpl(std::move(response_headers))};
+  EXPECT_CALL(callbacks_, onConfigUpdate(_)).Times(0);
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_)).Times(0);
+  EXPECT_CALL(random_gen_, random()).WillOnce(Return(0));
+  EXPECT_CALL(*timer_, enableTimer(_));
+  http_callbacks_->onSuccess(std::move(message));
+  request_in_progress_ = false;
+  timerTick();
+}
+
+// Validate that a response ETag is echoed back as If-None-Match on the next fetch.
+TEST_F(HttpSubscriptionImplTest, EtagEchoedAsIfNoneMatch) {
+  startSubscription({"cluster0", "cluster1"});
+
+  Http::HeaderMapPtr response_headers{
+      new Http::TestHeaderMapImpl{{":status", "200"}, {"etag", "\"xyz\""}}};
+  Http::MessagePtr message{new Http::ResponseMessageImpl(std::move(response_headers))};
+  message->body().reset(new Buffer::OwnedImpl(responseJson({"cluster0", "cluster1"}, "0")));
+  EXPECT_CALL(callbacks_, onConfigUpdate(_));
+  EXPECT_CALL(random_gen_, random()).WillOnce(Return(0));
+  EXPECT_CALL(*timer_, enableTimer(_));
+  http_callbacks_->onSuccess(std::move(message));
+  version_ = "0";
+  request_in_progress_ = false;
+  expected_if_none_match_ = "\"xyz\"";
+  timerTick();
+}
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
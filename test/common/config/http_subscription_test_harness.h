@@ -3,6 +3,7 @@
 #include "common/common/utility.h"
 #include "common/config/http_subscription_impl.h"
 #include "common/config/utility.h"
+#include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/protobuf/protobuf.h"
 
@@ -62,6 +63,12 @@ public:
           EXPECT_EQ("eds_cluster", std::string(request->headers().Host()->value().c_str()));
           EXPECT_EQ("/v2/discovery:endpoints",
                     std::string(request->headers().Path()->value().c_str()));
+          EXPECT_EQ(Http::Headers::get().ContentTypeValues.Json,
+                    std::string(request->headers().ContentType()->value().c_str()));
+          EXPECT_EQ(Http::Headers::get().ContentTypeValues.Protobuf + ", " +
+                        Http::Headers::get().ContentTypeValues.Json,
+                    std::string(
+                        request->headers().get(Http::Headers::get().Accept)->value().c_str()));
           std::string expected_request = "{";
           if (!version_.empty()) {
             expected_request += "\"version_info\":\"" + version + "\",";
@@ -73,11 +80,34 @@ public:
           }
           expected_request += "}";
           EXPECT_EQ(expected_request, request->bodyAsString());
+          const Http::HeaderEntry* if_none_match =
+              request->headers().get(Http::Headers::get().IfNoneMatch);
+          if (expected_if_none_match_.empty()) {
+            EXPECT_EQ(nullptr, if_none_match);
+          } else {
+            EXPECT_NE(nullptr, if_none_match);
+            if (if_none_match != nullptr) {
+              EXPECT_EQ(expected_if_none_match_, std::string(if_none_match->value().c_str()));
+            }
+          }
           request_in_progress_ = true;
           return &http_request_;
         }));
   }
 
+  std::string responseJson(const std::vector<std::string>& cluster_names,
+                           const std::string& version) {
+    std::string response_json = "{\"version_info\":\"" + version + "\",\"resources\":[";
+    for (const auto& cluster : cluster_names) {
+      response_json += "{\"@type\":\"type.googleapis.com/"
+                       "envoy.api.v2.ClusterLoadAssignment\",\"cluster_name\":\"" +
+                       cluster + "\"},";
+    }
+    response_json.pop_back();
+    response_json += "]}";
+    return response_json;
+  }
+
   void startSubscription(const std::vector<std::string>& cluster_names) override {
     version_ = "";
     cluster_names_ = cluster_names;
@@ -94,14 +124,7 @@ public:
 
   void deliverConfigUpdate(const std::vector<std::string> cluster_names, const std::string& version,
                            bool accept) override {
-    std::string response_json = "{\"version_info\":\"" + version + "\",\"resources\":[";
-    for (const auto& cluster : cluster_names) {
-      response_json += "{\"@type\":\"type.googleapis.com/"
-                       "envoy.api.v2.ClusterLoadAssignment\",\"cluster_name\":\"" +
-                       cluster + "\"},";
-    }
-    response_json.pop_back();
-    response_json += "]}";
+    const std::string response_json = responseJson(cluster_names, version);
     envoy::api::v2::DiscoveryResponse response_pb;
     EXPECT_TRUE(Protobuf::util::JsonStringToMessage(response_json, &response_pb).ok());
     Http::HeaderMapPtr response_headers{new Http::TestHeaderMapImpl{{":status", "200"}}};
@@ -133,6 +156,7 @@ public:
 
   bool request_in_progress_{};
   std::string version_;
+  std::string expected_if_none_match_;
   std::vector<std::string> cluster_names_;
   const Protobuf::MethodDescriptor* method_descriptor_;
   Upstream::MockClusterManager cm_;
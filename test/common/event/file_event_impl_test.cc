@@ -150,6 +150,8 @@ TEST_F(FileEventImplTest, SetEnabled) {
   file_event->setEnabled(FileReadyType::Read);
   dispatcher.run(Event::Dispatcher::RunType::NonBlock);
 
+  file_event->setEnabled(FileReadyType::Write);
+  // Re-asserting an unchanged mask is a no-op and must not redeliver the edge.
   file_event->setEnabled(FileReadyType::Write);
   dispatcher.run(Event::Dispatcher::RunType::NonBlock);
 
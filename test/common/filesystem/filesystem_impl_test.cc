@@ -1,4 +1,6 @@
 #include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <string>
 
 #include "common/common/thread.h"
@@ -23,6 +25,17 @@ using testing::Throw;
 using testing::_;
 
 namespace Envoy {
+namespace {
+
+std::string toString(const iovec* iov, int num_iov) {
+  std::string written;
+  for (int i = 0; i < num_iov; i++) {
+    written.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  }
+  return written;
+}
+
+} // namespace
 
 TEST(FileSystemImpl, BadFile) {
   Event::MockDispatcher dispatcher;
@@ -72,13 +85,13 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
                             std::chrono::milliseconds(40));
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("test", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.length();
       }));
 
   file.write("test");
@@ -90,13 +103,13 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
     }
   }
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("test2", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.length();
       }));
 
   // make sure timer is re-enabled on callback call
@@ -112,6 +125,52 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
   }
 }
 
+TEST(FileSystemImpl, asyncWriteCompletion) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Thread::MutexBasicLockable mutex;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Filesystem::MockOsSysCalls> os_sys_calls;
+
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
+  Filesystem::FileImpl file("", dispatcher, mutex, os_sys_calls, stats_store,
+                            std::chrono::milliseconds(40));
+
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        UNREFERENCED_PARAMETER(fd);
+
+        return toString(iov, num_iov).length();
+      }));
+
+  // The completion must be posted back to the dispatcher, never invoked from the flush thread.
+  Thread::MutexBasicLockable post_mutex;
+  std::condition_variable_any post_event;
+  std::function<void()> post_cb;
+  EXPECT_CALL(dispatcher, post(_))
+      .WillOnce(Invoke([&](std::function<void()> cb) -> void {
+        std::unique_lock<Thread::BasicLockable> lock(post_mutex);
+        post_cb = cb;
+        post_event.notify_one();
+      }));
+
+  bool completed = false;
+  file.write("test", [&completed](bool success) -> void {
+    EXPECT_TRUE(success);
+    completed = true;
+  });
+
+  {
+    std::unique_lock<Thread::BasicLockable> lock(post_mutex);
+    while (post_cb == nullptr) {
+      post_event.wait(post_mutex);
+    }
+  }
+
+  EXPECT_FALSE(completed);
+  post_cb();
+  EXPECT_TRUE(completed);
+}
+
 TEST(FileSystemImpl, reopenFile) {
   NiceMock<Event::MockDispatcher> dispatcher;
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher);
@@ -125,14 +184,14 @@ TEST(FileSystemImpl, reopenFile) {
   Filesystem::FileImpl file("", dispatcher, mutex, os_sys_calls, stats_store,
                             std::chrono::milliseconds(40));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("before", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.length();
       }));
 
   file.write("before");
@@ -148,14 +207,14 @@ TEST(FileSystemImpl, reopenFile) {
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(10));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = toString(iov, num_iov);
         EXPECT_EQ("reopened", written);
         EXPECT_EQ(10, fd);
 
-        return num_bytes;
+        return written.length();
       }));
 
   EXPECT_CALL(os_sys_calls, close(10)).InSequence(sq);
@@ -180,12 +239,11 @@ TEST(FilesystemImpl, reopenThrows) {
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Filesystem::MockOsSysCalls> os_sys_calls;
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillRepeatedly(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
-        UNREFERENCED_PARAMETER(buffer);
 
-        return num_bytes;
+        return toString(iov, num_iov).length();
       }));
 
   Sequence sq;
@@ -230,15 +288,15 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
   Filesystem::FileImpl file("", dispatcher, mutex, os_sys_calls, stats_store,
                             std::chrono::milliseconds(40));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
 
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+        const std::string written = toString(iov, num_iov);
         std::string expected("a");
         EXPECT_EQ(expected, written);
 
-        return num_bytes;
+        return written.length();
       }));
 
   file.write("a");
@@ -252,15 +310,15 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
 
   // First write happens without waiting on thread_flush_. Now make a big string and it should be
   // flushed even when timer is not enabled
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
 
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+        const std::string written = toString(iov, num_iov);
         std::string expected(1024 * 64 + 1, 'b');
         EXPECT_EQ(expected, written);
 
-        return num_bytes;
+        return written.length();
       }));
 
   std::string big_string(1024 * 64 + 1, 'b');
@@ -38,6 +38,22 @@ TEST(ClientSslAuthAllowedPrincipalsTest, EmptyString) {
   EXPECT_EQ(0UL, principals.size());
 }
 
+TEST(ClientSslAuthAllowedPrincipalsTest, DigestMatching) {
+  AllowedPrincipals principals;
+  principals.add("1b7d42ef0025ad89c1c911d6c10d7e86a4cb7c5863b2980abcbad1895f8b5314");
+  principals.add("1b7d42ef0025ad89c1c911d6c10d7e86a4cb7c5863b2980abcbad1895f8b5314"); // Duplicate.
+  principals.add("not a digest");
+  EXPECT_EQ(1UL, principals.size());
+  EXPECT_TRUE(
+      principals.allowed("1b7d42ef0025ad89c1c911d6c10d7e86a4cb7c5863b2980abcbad1895f8b5314"));
+  // Digests are matched on the decoded bytes, so case does not matter.
+  EXPECT_TRUE(
+      principals.allowed("1B7D42EF0025AD89C1C911D6C10D7E86A4CB7C5863B2980ABCBAD1895F8B5314"));
+  EXPECT_FALSE(
+      principals.allowed("2b7d42ef0025ad89c1c911d6c10d7e86a4cb7c5863b2980abcbad1895f8b5314"));
+  EXPECT_FALSE(principals.allowed("digest"));
+}
+
 class ClientSslAuthFilterTest : public testing::Test {
 public:
   ClientSslAuthFilterTest()
@@ -10,6 +10,7 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/buffer/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/host.h"
@@ -521,6 +522,79 @@ TEST_F(TcpProxyTest, UpstreamConnectionLimit) {
                     .value());
 }
 
+#if defined(__linux__)
+class TcpProxySpliceTest : public TcpProxyTest {
+public:
+  TcpProxySpliceTest() {
+    std::string json = R"EOF(
+    {
+      "stat_prefix": "name",
+      "splice": true,
+      "route_config": {
+        "routes": [
+          {
+            "cluster": "fake_cluster"
+          }
+        ]
+      }
+    }
+    )EOF";
+
+    Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
+    config_.reset(
+        new TcpProxyConfig(*config, cluster_manager_,
+                           cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_));
+  }
+};
+
+TEST_F(TcpProxySpliceTest, SpliceEngagedOnConnect) {
+  EXPECT_TRUE(config_->splice());
+
+  // In splice mode the downstream read stays disabled while the upstream connection is being
+  // established so no data enters the userspace filter path.
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(true));
+  setup(true);
+
+  // On connect both fds are handed over to the splicer.
+  EXPECT_CALL(*upstream_connection_, readDisable(true));
+  Event::MockFileEvent* downstream_event = new NiceMock<Event::MockFileEvent>();
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, createFileEvent_(_, _, _, _))
+      .WillOnce(Return(downstream_event));
+  Event::MockFileEvent* upstream_event = new NiceMock<Event::MockFileEvent>();
+  EXPECT_CALL(upstream_connection_->dispatcher_, createFileEvent_(_, _, _, _))
+      .WillOnce(Return(upstream_event));
+  EXPECT_CALL(*connect_timer_, disableTimer());
+  upstream_connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // A downstream close tears down the splicer and closes the upstream connection.
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+#else
+TEST(TcpProxyConfigTest, SpliceNotSupported) {
+  std::string json = R"EOF(
+    {
+      "stat_prefix": "name",
+      "splice": true,
+      "route_config": {
+        "routes": [
+          {
+            "cluster": "fake_cluster"
+          }
+        ]
+      }
+    }
+    )EOF";
+
+  Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  EXPECT_THROW(TcpProxyConfig(*config, cluster_manager,
+                              cluster_manager.thread_local_cluster_.cluster_.info_->stats_store_),
+               EnvoyException);
+}
+#endif // __linux__
+
 class TcpProxyRoutingTest : public testing::Test {
 public:
   TcpProxyRoutingTest() {
@@ -34,7 +34,6 @@ using Envoy::Protobuf::util::MessageDifferencer;
 using Envoy::ProtobufUtil::Status;
 using Envoy::ProtobufUtil::error::Code;
 using google::api::HttpRule;
-using google::grpc::transcoding::Transcoder;
 
 namespace Envoy {
 namespace Grpc {
@@ -106,6 +106,21 @@ TEST(AccessLogFormatterTest, requestInfoFormatter) {
     EXPECT_EQ("10", response_duration_format.format(header, header, request_info));
   }
 
+  {
+    RequestInfoFormatter route_match_duration_format("ROUTE_MATCH_DURATION");
+    std::chrono::microseconds duration{2000};
+    EXPECT_CALL(request_info, phaseDuration(RequestPhase::RouteMatched))
+        .WillOnce(Return(duration));
+    EXPECT_EQ("2", route_match_duration_format.format(header, header, request_info));
+  }
+
+  {
+    RequestInfoFormatter pool_ready_duration_format("POOL_READY_DURATION");
+    std::chrono::microseconds duration{3000};
+    EXPECT_CALL(request_info, phaseDuration(RequestPhase::PoolReady)).WillOnce(Return(duration));
+    EXPECT_EQ("3", pool_ready_duration_format.format(header, header, request_info));
+  }
+
   {
     RequestInfoFormatter bytes_received_format("BYTES_RECEIVED");
     EXPECT_CALL(request_info, bytesReceived()).WillOnce(Return(1));
@@ -261,6 +276,55 @@ TEST(AccessLogFormatterTest, CompositeFormatterSuccess) {
   }
 }
 
+TEST(AccessLogFormatterTest, BinaryFormatter) {
+  MockRequestInfo request_info;
+  TestHeaderMapImpl request_header{{":method", "GET"}, {":path", "/"}};
+  TestHeaderMapImpl response_header{{"second", "PUT"}};
+
+  EXPECT_CALL(request_info, protocol()).WillRepeatedly(Return(Protocol::Http11));
+
+  BinaryFormatterImpl formatter("%REQ(:METHOD)%%PROTOCOL%%RESP(second)%");
+
+  // Build the expected record: a 4 byte little endian payload length, then one length prefixed
+  // field per schema element.
+  auto prefixed = [](const std::string& data) {
+    std::string out;
+    const uint32_t length = data.length();
+    out.push_back(static_cast<char>(length & 0xff));
+    out.push_back(static_cast<char>((length >> 8) & 0xff));
+    out.push_back(static_cast<char>((length >> 16) & 0xff));
+    out.push_back(static_cast<char>((length >> 24) & 0xff));
+    out.append(data);
+    return out;
+  };
+  const std::string payload = prefixed("GET") + prefixed("HTTP/1.1") + prefixed("PUT");
+
+  EXPECT_EQ(prefixed(payload), formatter.format(request_header, response_header, request_info));
+
+  // Records append to a reused buffer the same way the line formatter does.
+  std::string output;
+  formatter.format(request_header, response_header, request_info, output);
+  formatter.format(request_header, response_header, request_info, output);
+  EXPECT_EQ(prefixed(payload) + prefixed(payload), output);
+}
+
+TEST(AccessLogFormatterTest, AppendToReusedBuffer) {
+  MockRequestInfo request_info;
+  TestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
+  TestHeaderMapImpl response_header{{"second", "PUT"}, {"test", "test"}};
+
+  FormatterImpl formatter("%REQ(first)% %RESP(test)%\n");
+
+  // Formatting appends to the supplied buffer without clearing it, so the same buffer can be
+  // reused across entries.
+  std::string output;
+  formatter.format(request_header, response_header, request_info, output);
+  EXPECT_EQ("GET test\n", output);
+
+  formatter.format(request_header, response_header, request_info, output);
+  EXPECT_EQ("GET test\nGET test\n", output);
+}
+
 TEST(AccessLogFormatterTest, ParserFailures) {
   AccessLogFormatParser parser;
 
@@ -449,6 +449,49 @@ TEST_F(AccessLogImplTest, orFilter) {
   }
 }
 
+TEST_F(AccessLogImplTest, nestedSameOperatorFilter) {
+  // A logical_and directly inside a logical_and is inlined into the parent at config time; the
+  // combined filter must still evaluate all leaves.
+  const std::string json = R"EOF(
+  {
+    "path": "/dev/null",
+    "filter": {"type": "logical_and", "filters": [
+        {"type": "not_healthcheck"},
+        {"type": "logical_and", "filters": [
+            {"type": "status_code", "op": ">=", "value": 200},
+            {"type": "status_code", "op": ">=", "value": 500}
+          ]
+        }
+      ]
+    }
+  }
+  )EOF";
+
+  InstanceSharedPtr log = AccessLogFactory::fromProto(parseAccessLogFromJson(json), context_);
+  request_info_.response_code_.value(500);
+
+  {
+    EXPECT_CALL(*file_, write(_));
+    TestHeaderMapImpl header_map{{"user-agent", "NOT/Envoy/HC"}};
+    log->log(&header_map, &response_headers_, request_info_);
+  }
+
+  {
+    EXPECT_CALL(*file_, write(_)).Times(0);
+    TestHeaderMapImpl header_map{};
+    request_info_.hc_request_ = true;
+    log->log(&header_map, &response_headers_, request_info_);
+  }
+
+  {
+    EXPECT_CALL(*file_, write(_)).Times(0);
+    TestHeaderMapImpl header_map{{"user-agent", "NOT/Envoy/HC"}};
+    request_info_.hc_request_ = false;
+    request_info_.response_code_.value(404);
+    log->log(&header_map, &response_headers_, request_info_);
+  }
+}
+
 TEST_F(AccessLogImplTest, multipleOperators) {
   const std::string json = R"EOF(
   {
@@ -64,10 +64,23 @@ TEST(RequestInfoImplTest, TimingTest) {
       },
       "response received");
 
+  wrapper.checkTimingBounds(
+      [](RequestInfoImpl& request_info) {
+        request_info.markPhase(RequestPhase::PoolReady, std::chrono::steady_clock::now());
+        return request_info.phaseDuration(RequestPhase::PoolReady);
+      },
+      "pool ready phase");
+
   wrapper.checkTimingBounds([](RequestInfoImpl& request_info) { return request_info.duration(); },
                             "stream duration");
 }
 
+TEST(RequestInfoImplTest, UnreachedPhaseIsZero) {
+  RequestInfoImpl request_info(Protocol::Http2);
+  EXPECT_EQ(0, request_info.phaseDuration(RequestPhase::RouteMatched).count());
+  EXPECT_EQ(0, request_info.phaseDuration(RequestPhase::EncodeComplete).count());
+}
+
 TEST(RequestInfoImplTest, BytesTest) {
   RequestInfoImpl request_info(Protocol::Http2);
   const uint64_t bytes_sent = 7;
@@ -105,6 +105,35 @@ TEST_F(CodecClientTest, BasicResponseWithBody) {
   inner_decoder->decodeData(buffer, true);
 }
 
+TEST_F(CodecClientTest, WrapperReuseAcrossRequests) {
+  Http::StreamDecoder* inner_decoder;
+  NiceMock<Http::MockStreamEncoder> inner_encoder;
+  EXPECT_CALL(*codec_, newStream(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](Http::StreamDecoder& decoder) -> Http::StreamEncoder& {
+        inner_decoder = &decoder;
+        return inner_encoder;
+      }));
+
+  Http::MockStreamDecoder outer_decoder1;
+  client_->newStream(outer_decoder1);
+
+  Http::HeaderMapPtr response_headers1{new TestHeaderMapImpl{{":status", "200"}}};
+  EXPECT_CALL(outer_decoder1, decodeHeaders_(Pointee(Ref(*response_headers1)), true));
+  inner_decoder->decodeHeaders(std::move(response_headers1), true);
+  Http::StreamDecoder* first_request_decoder = inner_decoder;
+
+  // The second request must recycle the retired wrapper and route its response to the second
+  // request's decoder.
+  Http::MockStreamDecoder outer_decoder2;
+  client_->newStream(outer_decoder2);
+  EXPECT_EQ(first_request_decoder, inner_decoder);
+
+  Http::HeaderMapPtr response_headers2{new TestHeaderMapImpl{{":status", "503"}}};
+  EXPECT_CALL(outer_decoder2, decodeHeaders_(Pointee(Ref(*response_headers2)), true));
+  inner_decoder->decodeHeaders(std::move(response_headers2), true);
+}
+
 TEST_F(CodecClientTest, DisconnectBeforeHeaders) {
   Http::StreamDecoder* inner_decoder;
   NiceMock<Http::MockStreamEncoder> inner_encoder;
@@ -174,6 +174,65 @@ TEST_F(CodeUtilityTest, PerZoneStats) {
   EXPECT_EQ(1U, cluster_scope_.counter("prefix.zone.from_az.to_az.upstream_rq_2xx").value());
 }
 
+TEST_F(CodeUtilityTest, ResponseStatFamily) {
+  ResponseCodeStatFamily family(cluster_scope_, "prefix.");
+
+  // Charging through the family produces the same stat names as the dynamic path; the second
+  // charge hits the pre-resolved counters.
+  TestHeaderMapImpl headers{{":status", "200"}};
+  CodeUtility::ResponseStatInfo info{global_store_,  cluster_scope_, "prefix.",    headers, true,
+                                     "test-vhost",   "test-cluster", EMPTY_STRING,
+                                     EMPTY_STRING,   true};
+  CodeUtility::chargeResponseStat(family, info);
+  CodeUtility::chargeResponseStat(family, info);
+
+  EXPECT_EQ(2U, cluster_scope_.counter("prefix.upstream_rq_2xx").value());
+  EXPECT_EQ(2U, cluster_scope_.counter("prefix.upstream_rq_200").value());
+  EXPECT_EQ(2U, cluster_scope_.counter("prefix.canary.upstream_rq_2xx").value());
+  EXPECT_EQ(2U, cluster_scope_.counter("prefix.canary.upstream_rq_200").value());
+  EXPECT_EQ(2U, cluster_scope_.counter("prefix.internal.upstream_rq_2xx").value());
+  EXPECT_EQ(2U, cluster_scope_.counter("prefix.internal.upstream_rq_200").value());
+  EXPECT_EQ(
+      2U, global_store_.counter("vhost.test-vhost.vcluster.test-cluster.upstream_rq_2xx").value());
+  EXPECT_EQ(
+      2U, global_store_.counter("vhost.test-vhost.vcluster.test-cluster.upstream_rq_200").value());
+
+  TestHeaderMapImpl error_headers{{":status", "503"}};
+  CodeUtility::ResponseStatInfo error_info{global_store_, cluster_scope_, "prefix.",
+                                           error_headers, false,          EMPTY_STRING,
+                                           EMPTY_STRING,  EMPTY_STRING,   EMPTY_STRING,
+                                           false};
+  CodeUtility::chargeResponseStat(family, error_info);
+
+  EXPECT_EQ(1U, cluster_scope_.counter("prefix.upstream_rq_5xx").value());
+  EXPECT_EQ(1U, cluster_scope_.counter("prefix.upstream_rq_503").value());
+  EXPECT_EQ(1U, cluster_scope_.counter("prefix.external.upstream_rq_5xx").value());
+  EXPECT_EQ(1U, cluster_scope_.counter("prefix.external.upstream_rq_503").value());
+  EXPECT_EQ(0U, cluster_scope_.counter("prefix.canary.upstream_rq_5xx").value());
+}
+
+TEST_F(CodeUtilityTest, LazyResponseCodeStats) {
+  LazyResponseCodeStats stats("vhost.test-vhost.vcluster.test-cluster.");
+
+  // The first get() creates the stats over the supplied scope; later calls return the same
+  // object.
+  ResponseCodeStats& created = stats.get(global_store_);
+  EXPECT_EQ(&created, &stats.get(global_store_));
+
+  created.charge(200);
+  created.charge(200);
+  created.charge(503);
+
+  EXPECT_EQ(
+      2U, global_store_.counter("vhost.test-vhost.vcluster.test-cluster.upstream_rq_2xx").value());
+  EXPECT_EQ(
+      2U, global_store_.counter("vhost.test-vhost.vcluster.test-cluster.upstream_rq_200").value());
+  EXPECT_EQ(
+      1U, global_store_.counter("vhost.test-vhost.vcluster.test-cluster.upstream_rq_5xx").value());
+  EXPECT_EQ(
+      1U, global_store_.counter("vhost.test-vhost.vcluster.test-cluster.upstream_rq_503").value());
+}
+
 TEST(CodeUtilityResponseTimingTest, All) {
   Stats::MockStore global_store;
   Stats::MockStore cluster_scope;
@@ -197,5 +256,30 @@ TEST(CodeUtilityResponseTimingTest, All) {
   CodeUtility::chargeResponseTiming(info);
 }
 
+TEST(CodeUtilityResponseTimingTest, Family) {
+  Stats::MockStore global_store;
+  Stats::MockStore cluster_scope;
+  ResponseCodeStatFamily family(cluster_scope, "prefix.");
+
+  // Charging through the family delivers the same histogram names as the dynamic path.
+  CodeUtility::ResponseTimingInfo info{
+      global_store, cluster_scope, "prefix.",    std::chrono::milliseconds(5),
+      true,         true,          "vhost_name", "req_vcluster_name",
+      "from_az",    "to_az"};
+
+  EXPECT_CALL(cluster_scope,
+              deliverTimingToSinks("prefix.upstream_rq_time", std::chrono::milliseconds(5)));
+  EXPECT_CALL(cluster_scope,
+              deliverTimingToSinks("prefix.canary.upstream_rq_time", std::chrono::milliseconds(5)));
+  EXPECT_CALL(cluster_scope, deliverTimingToSinks("prefix.internal.upstream_rq_time",
+                                                  std::chrono::milliseconds(5)));
+  EXPECT_CALL(global_store,
+              deliverTimingToSinks("vhost.vhost_name.vcluster.req_vcluster_name.upstream_rq_time",
+                                   std::chrono::milliseconds(5)));
+  EXPECT_CALL(cluster_scope, deliverTimingToSinks("prefix.zone.from_az.to_az.upstream_rq_time",
+                                                  std::chrono::milliseconds(5)));
+  CodeUtility::chargeResponseTiming(family, info);
+}
+
 } // namespace Http
 } // namespace Envoy
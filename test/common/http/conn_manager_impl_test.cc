@@ -589,6 +589,48 @@ TEST_F(HttpConnectionManagerImplTest, NoPath) {
   conn_manager_->onData(fake_input);
 }
 
+TEST_F(HttpConnectionManagerImplTest, QueryParamsCachedOnStream) {
+  InSequence s;
+  setup(false, "");
+
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/path?a=b&c=d"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+  }));
+
+  setupFilterChain(2, 0);
+
+  EXPECT_CALL(*decoder_filters_[0], decodeHeaders(_, true))
+      .WillOnce(Invoke([&](HeaderMap& headers, bool) -> FilterHeadersStatus {
+        const QueryParams& params = decoder_filters_[0]->callbacks_->queryParams();
+        EXPECT_EQ(2UL, params.size());
+        EXPECT_EQ("b", params.at("a"));
+        EXPECT_EQ("d", params.at("c"));
+
+        // A second lookup must return the cached decomposition rather than re-parsing.
+        EXPECT_EQ(&params, &decoder_filters_[0]->callbacks_->queryParams());
+
+        // A path rewrite invalidates the cache for later filters.
+        headers.Path()->value(std::string("/other?x=y"));
+        return FilterHeadersStatus::Continue;
+      }));
+  EXPECT_CALL(*decoder_filters_[1], decodeHeaders(_, true))
+      .WillOnce(Invoke([&](HeaderMap&, bool) -> FilterHeadersStatus {
+        const QueryParams& params = decoder_filters_[1]->callbacks_->queryParams();
+        EXPECT_EQ(1UL, params.size());
+        EXPECT_EQ("y", params.at("x"));
+        return FilterHeadersStatus::StopIteration;
+      }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input);
+
+  expectOnDestroy();
+  conn_manager_->onEvent(Network::ConnectionEvent::RemoteClose);
+}
+
 TEST_F(HttpConnectionManagerImplTest, RejectWebSocketOnNonWebSocketRoute) {
   setup(false, "");
 
@@ -720,6 +762,65 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketPrefixRewrite) {
   EXPECT_EQ(0U, stats_.named_.downstream_cx_websocket_active_.value());
 }
 
+TEST_F(HttpConnectionManagerImplTest, WebSocketHandshakeCompleteReleasesHttpResources) {
+  setup(false, "");
+
+  StreamDecoder* decoder = nullptr;
+  NiceMock<MockStreamEncoder> encoder;
+  NiceMock<Network::MockClientConnection>* upstream_connection_ =
+      new NiceMock<Network::MockClientConnection>();
+  Upstream::MockHost::MockCreateConnectionData conn_info;
+
+  conn_info.connection_ = upstream_connection_;
+  conn_info.host_description_.reset(
+      new Upstream::HostImpl(cluster_manager_.thread_local_cluster_.cluster_.info_, "newhost",
+                             Network::Utility::resolveUrl("tcp://127.0.0.1:80"),
+                             envoy::api::v2::Metadata::default_instance(), 1, ""));
+  EXPECT_CALL(cluster_manager_, tcpConnForCluster_("fake_cluster", _)).WillOnce(Return(conn_info));
+
+  ON_CALL(route_config_provider_.route_config_->route_->route_entry_, useWebSocket())
+      .WillByDefault(Return(true));
+
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    decoder = &conn_manager_->newStream(encoder);
+    HeaderMapPtr headers{new TestHeaderMapImpl{{":authority", "host"},
+                                               {":method", "GET"},
+                                               {":path", "/"},
+                                               {"connection", "Upgrade"},
+                                               {"upgrade", "websocket"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+    data.drain(4);
+  }));
+
+  // Catch-all for the handshake headers encoded to the upstream connection.
+  EXPECT_CALL(*upstream_connection_, write(_)).Times(AnyNumber());
+
+  // Frames that arrive in the same read as the upgrade request must be relayed to the upstream
+  // in the same onData() call instead of waiting for the next read event.
+  Buffer::OwnedImpl early_frames("frame");
+  EXPECT_CALL(*upstream_connection_, write(BufferEqual(&early_frames)));
+  Buffer::OwnedImpl fake_input("1234frame");
+  conn_manager_->onData(fake_input);
+  EXPECT_EQ(1U, stats_.named_.downstream_rq_active_.value());
+
+  // Completing the upstream handshake releases the stream and the codec; the connection is a raw
+  // relay from here on.
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, deferredDelete_(_));
+  upstream_connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, stats_.named_.downstream_rq_active_.value());
+
+  // Subsequent reads bypass the codec entirely. dispatch() above is expected exactly once.
+  Buffer::OwnedImpl frames("frames");
+  EXPECT_CALL(*upstream_connection_, write(BufferEqual(&frames)));
+  Buffer::OwnedImpl fake_input2("frames");
+  conn_manager_->onData(fake_input2);
+
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_websocket_active_.value());
+  conn_manager_.reset();
+  EXPECT_EQ(0U, stats_.named_.downstream_cx_websocket_active_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, DrainClose) {
   setup(true, "");
 
@@ -28,7 +28,7 @@ class BufferFilterTest : public testing::Test {
 public:
   BufferFilterTest()
       : config_{new BufferFilterConfig{BufferFilter::generateStats("", store_), 1024 * 1024,
-                                       std::chrono::seconds(0)}},
+                                       std::chrono::seconds(0), false}},
         filter_(config_) {
     filter_.setDecoderFilterCallbacks(callbacks_);
   }
@@ -62,6 +62,26 @@ TEST_F(BufferFilterTest, RequestWithData) {
   EXPECT_EQ(FilterDataStatus::Continue, filter_.decodeData(data2, true));
 }
 
+TEST_F(BufferFilterTest, RequestWithDataWatermarkBackpressure) {
+  InSequence s;
+
+  std::shared_ptr<BufferFilterConfig> config{new BufferFilterConfig{
+      BufferFilter::generateStats("", store_), 1024 * 1024, std::chrono::seconds(0), true}};
+  BufferFilter filter(config);
+  filter.setDecoderFilterCallbacks(callbacks_);
+
+  expectTimerCreate();
+
+  TestHeaderMapImpl headers;
+  EXPECT_EQ(FilterHeadersStatus::StopIteration, filter.decodeHeaders(headers, false));
+
+  Buffer::OwnedImpl data1("hello");
+  EXPECT_EQ(FilterDataStatus::StopIterationAndWatermark, filter.decodeData(data1, false));
+
+  Buffer::OwnedImpl data2(" world");
+  EXPECT_EQ(FilterDataStatus::Continue, filter.decodeData(data2, true));
+}
+
 TEST_F(BufferFilterTest, RequestTimeout) {
   InSequence s;
 
@@ -68,6 +68,15 @@ public:
     }
     )EOF";
 
+  const std::string zero_percent_abort_json = R"EOF(
+    {
+      "abort" : {
+        "abort_percent" : 0,
+        "http_status" : 429
+      }
+    }
+    )EOF";
+
   const std::string fixed_delay_and_abort_json = R"EOF(
     {
       "delay" : {
@@ -244,6 +253,24 @@ TEST(FaultFilterBadConfigTest, MissingDelayDuration) {
   faultFilterBadConfigHelper(json);
 }
 
+TEST_F(FaultFilterTest, NoRuntimeKeysFastPath) {
+  SetUpTest(zero_percent_abort_json);
+
+  // With no statically configured fault and no fault.http. keys in the snapshot, a single prefix
+  // existence check short circuits the filter without evaluating any individual keys.
+  EXPECT_CALL(runtime_.snapshot_, keysWithPrefixExist("fault.http.")).WillOnce(Return(false));
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled(_, _)).Times(0);
+  EXPECT_CALL(runtime_.snapshot_, getInteger(_, _)).Times(0);
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(data_, false));
+  EXPECT_EQ(FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
+
+  EXPECT_EQ(0UL, config_->stats().aborts_injected_.value());
+  EXPECT_EQ(0UL, config_->stats().delays_injected_.value());
+  filter_->onDestroy();
+}
+
 TEST_F(FaultFilterTest, AbortWithHttpStatus) {
   SetUpTest(abort_only_json);
 
@@ -23,7 +23,7 @@ public:
       "ip_tags" : [
         {
           "ip_tag_name" : "test_internal",
-          "ip_list" : ["1.2.3.4"]
+          "ip_list" : ["10.0.0.0/8"]
         }
       ]
     }
@@ -71,27 +71,56 @@ public:
 
 TEST_F(IpTaggingFilterTest, InternalRequest) {
   SetUpTest(internal_request_json);
+  request_headers_.addCopy("x-forwarded-for", "10.0.0.1");
 
   EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("test_internal", request_headers_.get_(Headers::get().EnvoyIpTags));
   EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(data_, false));
   EXPECT_EQ(FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
 }
 
+TEST_F(IpTaggingFilterTest, InternalRequestTypeSkipsExternal) {
+  SetUpTest(internal_request_json);
+  request_headers_.addCopy("x-forwarded-for", "1.2.3.4");
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_FALSE(request_headers_.has(Headers::get().EnvoyIpTags));
+}
+
 TEST_F(IpTaggingFilterTest, ExternalRequest) {
   SetUpTest(external_request_json);
+  request_headers_.addCopy("x-forwarded-for", "1.2.3.4");
 
   EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("test_external", request_headers_.get_(Headers::get().EnvoyIpTags));
   EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(data_, false));
   EXPECT_EQ(FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
 }
 
 TEST_F(IpTaggingFilterTest, BothRequest) {
   SetUpTest(both_request_json);
+  request_headers_.addCopy("x-forwarded-for", "1.2.3.4");
 
   EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("test_both", request_headers_.get_(Headers::get().EnvoyIpTags));
   EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(data_, false));
   EXPECT_EQ(FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
 }
 
+TEST_F(IpTaggingFilterTest, NoXffNoTag) {
+  SetUpTest(both_request_json);
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_FALSE(request_headers_.has(Headers::get().EnvoyIpTags));
+}
+
+TEST_F(IpTaggingFilterTest, NoMatchNoTag) {
+  SetUpTest(both_request_json);
+  request_headers_.addCopy("x-forwarded-for", "5.6.7.8");
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_FALSE(request_headers_.has(Headers::get().EnvoyIpTags));
+}
+
 } // namespace Http
 } // namespace Envoy
@@ -1,3 +1,4 @@
+#include <list>
 #include <string>
 
 #include "common/http/header_map_impl.h"
@@ -311,6 +312,32 @@ TEST(HeaderMapImplTest, Remove) {
   EXPECT_EQ(0UL, headers.size());
 }
 
+TEST(HeaderMapImplTest, BulkRemove) {
+  HeaderMapImpl headers;
+  headers.insertContentLength().value(5);
+  headers.insertConnection().value(std::string("close"));
+  headers.addCopy(LowerCaseString("custom1"), "value1");
+  headers.addCopy(LowerCaseString("custom2"), "value2");
+  headers.addCopy(LowerCaseString("custom2"), "value3");
+  headers.addCopy(LowerCaseString("keep"), "value4");
+  EXPECT_EQ(6UL, headers.size());
+
+  // A mix of inline, non-inline, repeated, and missing keys removed in one call.
+  headers.remove(std::list<LowerCaseString>{Headers::get().Connection, LowerCaseString("custom1"),
+                                            LowerCaseString("custom2"),
+                                            LowerCaseString("missing")});
+  EXPECT_EQ(nullptr, headers.Connection());
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("custom1")));
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("custom2")));
+  EXPECT_STREQ("value4", headers.get(LowerCaseString("keep"))->value().c_str());
+  EXPECT_STREQ("5", headers.ContentLength()->value().c_str());
+  EXPECT_EQ(2UL, headers.size());
+
+  // An empty removal list is a no-op.
+  headers.remove(std::list<LowerCaseString>{});
+  EXPECT_EQ(2UL, headers.size());
+}
+
 TEST(HeaderMapImplTest, DoubleInlineAdd) {
   HeaderMapImpl headers;
   headers.addReferenceKey(Headers::get().ContentLength, 5);
@@ -394,6 +421,65 @@ TEST(HeaderMapImplTest, Equality) {
   EXPECT_FALSE(headers1 == headers2);
 }
 
+TEST(HeaderMapImplTest, CopyPreservesReferenceStrings) {
+  HeaderMapImpl headers;
+  LowerCaseString static_key("hello");
+  std::string ref_value("value");
+  headers.addReference(static_key, ref_value);
+  headers.addCopy(LowerCaseString("foo"), "bar");
+
+  HeaderMapImpl copy(headers);
+  EXPECT_EQ(HeaderString::Type::Reference, copy.get(static_key)->value().type());
+  EXPECT_EQ(ref_value.c_str(), copy.get(static_key)->value().c_str());
+  EXPECT_STREQ("bar", copy.get(LowerCaseString("foo"))->value().c_str());
+}
+
+TEST(HeaderMapImplTest, NearMissInlineKey) {
+  // Same length and same sampled characters as content-length, but not an inline header; the
+  // static lookup's full key comparison must reject it so it lands in the generic list.
+  HeaderMapImpl headers;
+  LowerCaseString near_miss_key("conxent-length");
+  std::string value("value");
+  headers.addReference(near_miss_key, value);
+  EXPECT_EQ(nullptr, headers.ContentLength());
+  EXPECT_STREQ("value", headers.get(near_miss_key)->value().c_str());
+}
+
+TEST(HeaderMapImplTest, IndexedLookupLargeMap) {
+  // Enough headers that get() consults the lookup index rather than scanning the list.
+  HeaderMapImpl headers;
+  for (uint32_t i = 0; i < 50; i++) {
+    headers.addCopy(LowerCaseString("custom-header-" + std::to_string(i)),
+                    "value-" + std::to_string(i));
+  }
+  for (uint32_t i = 0; i < 50; i++) {
+    const HeaderEntry* entry = headers.get(LowerCaseString("custom-header-" + std::to_string(i)));
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ("value-" + std::to_string(i), std::string(entry->value().c_str()));
+  }
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("custom-header-50")));
+
+  // Inserts after the index is built keep it up to date and removals rebuild it.
+  headers.addCopy(LowerCaseString("custom-header-50"), "value-50");
+  EXPECT_STREQ("value-50", headers.get(LowerCaseString("custom-header-50"))->value().c_str());
+  headers.remove(LowerCaseString("custom-header-0"));
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("custom-header-0")));
+  EXPECT_STREQ("value-1", headers.get(LowerCaseString("custom-header-1"))->value().c_str());
+}
+
+TEST(HeaderMapImplTest, IndexedLookupRepeatedKey) {
+  // An indexed get() must keep returning the first added entry for a repeated key, like the
+  // linear scan it replaces.
+  HeaderMapImpl headers;
+  LowerCaseString dup_key("duplicate");
+  headers.addCopy(dup_key, "first");
+  for (uint32_t i = 0; i < 20; i++) {
+    headers.addCopy(LowerCaseString("filler-" + std::to_string(i)), "x");
+  }
+  headers.addCopy(dup_key, "second");
+  EXPECT_STREQ("first", headers.get(dup_key)->value().c_str());
+}
+
 TEST(HeaderMapImplTest, LargeCharInHeader) {
   HeaderMapImpl headers;
   LowerCaseString static_key("\x90hello");
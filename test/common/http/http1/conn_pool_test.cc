@@ -10,6 +10,7 @@
 #include "test/common/http/common.h"
 #include "test/common/upstream/utility.h"
 #include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/network/mocks.h"
@@ -26,6 +27,8 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnArg;
+using testing::ReturnPointee;
 using testing::ReturnRef;
 using testing::SaveArg;
 using testing::_;
@@ -40,9 +43,10 @@ namespace Http1 {
 class ConnPoolImplForTest : public ConnPoolImpl {
 public:
   ConnPoolImplForTest(Event::MockDispatcher& dispatcher,
-                      Upstream::ClusterInfoConstSharedPtr cluster)
+                      Upstream::ClusterInfoConstSharedPtr cluster, Runtime::Loader& runtime,
+                      MonotonicTimeSource& time_source)
       : ConnPoolImpl(dispatcher, Upstream::makeTestHost(cluster, "tcp://127.0.0.1:9000"),
-                     Upstream::ResourcePriority::Default),
+                     Upstream::ResourcePriority::Default, runtime, time_source),
         mock_dispatcher_(dispatcher) {}
 
   ~ConnPoolImplForTest() {
@@ -104,7 +108,7 @@ public:
  */
 class Http1ConnPoolImplTest : public testing::Test {
 public:
-  Http1ConnPoolImplTest() : conn_pool_(dispatcher_, cluster_) {}
+  Http1ConnPoolImplTest() : conn_pool_(dispatcher_, cluster_, runtime_, time_source_) {}
 
   ~Http1ConnPoolImplTest() {
     // Make sure all gauges are 0.
@@ -115,8 +119,9 @@ public:
 
   NiceMock<Event::MockDispatcher> dispatcher_;
   std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
-  ConnPoolImplForTest conn_pool_;
   NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  ConnPoolImplForTest conn_pool_;
 };
 
 /**
@@ -238,6 +243,138 @@ TEST_F(Http1ConnPoolImplTest, MultipleRequestAndResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that the pool dials a spare connection ahead of demand when prefetching is enabled via
+ * runtime.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchConnections) {
+  uint64_t prefetch = 0;
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.prefetch", 0))
+      .WillRepeatedly(ReturnPointee(&prefetch));
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.prefetch.fake_cluster", _))
+      .WillRepeatedly(ReturnArg<1>());
+
+  // Request 1 creates a connection as usual while prefetching is still disabled.
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  r1.completeResponse(false);
+
+  // With a warm target of 1, consuming the ready connection for request 2 dials a spare.
+  prefetch = 1;
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r2.startRequest();
+  r2.completeResponse(true);
+
+  // Cause the connections to go away. Prefetching is disabled again so the pool does not replace
+  // them.
+  prefetch = 0;
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that a ready connection is closed once it has been idle for the runtime configured
+ * timeout.
+ */
+TEST_F(Http1ConnPoolImplTest, IdleTimeout) {
+  uint64_t timeout_ms = 50;
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.idle_timeout_ms", 0))
+      .WillRepeatedly(ReturnPointee(&timeout_ms));
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.idle_timeout_ms.fake_cluster", _))
+      .WillRepeatedly(ReturnArg<1>());
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  // The idle timer is created when the connection first goes idle and armed for the full timeout.
+  EXPECT_CALL(time_source_, currentTime())
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::milliseconds(0))));
+  Event::MockTimer* idle_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(50)));
+  r1.completeResponse(false);
+
+  // When the timer fires past the deadline the idle connection is closed.
+  EXPECT_CALL(time_source_, currentTime())
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::milliseconds(60))));
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  idle_timer->callback_();
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_idle_timeout_.value());
+}
+
+/**
+ * Test that the idle timer is cancelled when the last ready connection is taken for a new
+ * request, instead of firing as a no-op wakeup while the pool has no idle connections.
+ */
+TEST_F(Http1ConnPoolImplTest, IdleTimerDisabledWhenReadyListEmpties) {
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.idle_timeout_ms", 0))
+      .WillRepeatedly(Return(50));
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.idle_timeout_ms.fake_cluster", _))
+      .WillRepeatedly(ReturnArg<1>());
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  EXPECT_CALL(time_source_, currentTime())
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::milliseconds(0))));
+  Event::MockTimer* idle_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(50)));
+  r1.completeResponse(false);
+
+  // Taking the only ready connection empties the ready list and cancels the pending wakeup.
+  EXPECT_CALL(*idle_timer, disableTimer());
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+
+  // The connection going idle again re-arms the timer for a fresh timeout.
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(50)));
+  r2.completeResponse(false);
+
+  // Fire past the deadline to clean up the idle connection.
+  EXPECT_CALL(time_source_, currentTime())
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::milliseconds(60))));
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  idle_timer->callback_();
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_idle_timeout_.value());
+}
+
+/**
+ * Test that the pool sheds the longest idle connection when the runtime configured max idle
+ * connection limit is exceeded.
+ */
+TEST_F(Http1ConnPoolImplTest, MaxIdleConnections) {
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.max_idle", 0))
+      .WillRepeatedly(Return(1));
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.conn_pool.max_idle.fake_cluster", _))
+      .WillRepeatedly(ReturnArg<1>());
+
+  // Two concurrent requests create two connections.
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::CreateConnection);
+  r2.startRequest();
+
+  // The first response completing leaves one idle connection, which is within the limit.
+  r1.completeResponse(false);
+
+  // The second response completing puts the pool over the limit, shedding the longest idle
+  // connection (request 1's).
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  r2.completeResponse(false);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_idle_overflow_.value());
+
+  // Clean up the remaining connection.
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test when we overflow max pending requests.
  */
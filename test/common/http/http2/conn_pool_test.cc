@@ -45,8 +45,10 @@ public:
   MOCK_METHOD1(createCodecClient_, CodecClient*(Upstream::Host::CreateConnectionData& data));
 
   uint32_t maxTotalStreams() override { return max_streams_; }
+  uint32_t maxConcurrentStreams() override { return max_concurrent_streams_; }
 
   uint32_t max_streams_{std::numeric_limits<uint32_t>::max()};
+  uint32_t max_concurrent_streams_{std::numeric_limits<uint32_t>::max()};
 };
 
 class Http2ConnPoolImplTest : public testing::Test {
@@ -377,6 +379,46 @@ TEST_F(Http2ConnPoolImplTest, MaxGlobalRequests) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+TEST_F(Http2ConnPoolImplTest, MaxConcurrentStreams) {
+  InSequence s;
+  pool_.max_concurrent_streams_ = 1;
+
+  // The first connection saturates at one concurrent stream, so the second stream establishes a
+  // second connection.
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(1);
+
+  // Completing the first stream frees capacity on the first connection, so the third stream
+  // goes to the now least loaded first connection instead of creating a third one.
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  ActiveTestRequest r3(*this, 0);
+  EXPECT_CALL(r3.inner_encoder_, encodeHeaders(_, true));
+  r3.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(r3.decoder_, decodeHeaders_(_, true));
+  r3.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_http2_total_.value());
+}
+
 TEST_F(Http2ConnPoolImplTest, GoAway) {
   InSequence s;
 
@@ -39,6 +39,15 @@ TEST(HttpUtility, getResponseStatus) {
   EXPECT_EQ(200U, Utility::getResponseStatus(TestHeaderMapImpl{{":status", "200"}}));
 }
 
+TEST(HttpUtility, numericStatusString) {
+  EXPECT_EQ("200", Utility::numericStatusString(Http::Code::OK));
+  EXPECT_EQ("404", Utility::numericStatusString(Http::Code::NotFound));
+  EXPECT_EQ("599", Utility::numericStatusString(static_cast<Http::Code>(599)));
+  // The strings are statics, so repeated lookups return the same storage.
+  EXPECT_EQ(&Utility::numericStatusString(Http::Code::ServiceUnavailable),
+            &Utility::numericStatusString(Http::Code::ServiceUnavailable));
+}
+
 TEST(HttpUtility, isInternalRequest) {
   EXPECT_FALSE(Utility::isInternalRequest(TestHeaderMapImpl{}));
   EXPECT_FALSE(
@@ -306,6 +306,26 @@ TEST(JsonLoaderTest, Schema) {
   }
 }
 
+TEST(JsonLoaderTest, SchemaReuse) {
+  // Compiled schemas are cached and shared across validations; repeated use of the same schema
+  // string must keep producing independent pass/fail results.
+  const std::string schema = R"EOF(
+  {
+    "properties": {
+      "value1": {"type" : "number"}
+    },
+    "additionalProperties": false
+  }
+  )EOF";
+
+  ObjectSharedPtr valid = Factory::loadFromString("{\"value1\": 1}");
+  ObjectSharedPtr invalid = Factory::loadFromString("{\"value1\": \"nan\"}");
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NO_THROW(valid->validateSchema(schema));
+    EXPECT_THROW(invalid->validateSchema(schema), Exception);
+  }
+}
+
 TEST(JsonLoaderTest, NestedSchema) {
 
   std::string schema = R"EOF(
@@ -418,6 +438,76 @@ TEST(JsonLoaderTest, ListAsString) {
   }
 }
 
+TEST(JsonLoaderTest, Streaming) {
+  {
+    // Elements of the streamed array are delivered in order and are not retained in the
+    // returned document; the other members are.
+    std::vector<std::string> names;
+    ObjectSharedPtr json = Factory::loadFromStringStreaming(
+        "{\"version\": \"1\", \"clusters\": [{\"name\": \"a\"}, {\"name\": \"b\"}]}", "clusters",
+        [&names](ObjectSharedPtr cluster) -> void { names.push_back(cluster->getString("name")); });
+    EXPECT_EQ(std::vector<std::string>({"a", "b"}), names);
+    EXPECT_EQ("1", json->getString("version"));
+    EXPECT_TRUE(json->getObjectArray("clusters").empty());
+  }
+
+  {
+    // Scalar elements and elements containing nested containers stream as well.
+    std::vector<std::string> values;
+    Factory::loadFromStringStreaming(
+        "{\"items\": [\"one\", {\"nested\": [1, 2]}, [\"three\"]]}", "items",
+        [&values](ObjectSharedPtr item) -> void { values.push_back(item->asJsonString()); });
+    EXPECT_EQ(3, values.size());
+  }
+
+  {
+    // Only the root object's key opens the streaming array; a nested key with the same name
+    // builds normally.
+    uint64_t callbacks = 0;
+    ObjectSharedPtr json = Factory::loadFromStringStreaming(
+        "{\"wrapper\": {\"clusters\": [1, 2, 3]}}", "clusters",
+        [&callbacks](ObjectSharedPtr) -> void { callbacks++; });
+    EXPECT_EQ(0, callbacks);
+    EXPECT_EQ(3, json->getObject("wrapper")->getObjectArray("clusters").size());
+  }
+
+  {
+    // Missing key and non-array values for the key never invoke the callback.
+    uint64_t callbacks = 0;
+    Factory::loadFromStringStreaming("{\"other\": [1]}", "clusters",
+                                     [&callbacks](ObjectSharedPtr) -> void { callbacks++; });
+    Factory::loadFromStringStreaming("{\"clusters\": {\"foo\": [1]}}", "clusters",
+                                     [&callbacks](ObjectSharedPtr) -> void { callbacks++; });
+    EXPECT_EQ(0, callbacks);
+  }
+
+  {
+    // Parse errors are surfaced the same way as the non-streaming path.
+    EXPECT_THROW(Factory::loadFromStringStreaming("{\"clusters\": [", "clusters",
+                                                  [](ObjectSharedPtr) -> void {}),
+                 Exception);
+  }
+}
+
+TEST(JsonLoaderTest, ScalarSchemaValidation) {
+  // Streamed elements are schema validated individually by their consumers, so scalars must
+  // produce a proper schema violation rather than being unrepresentable.
+  const std::string object_schema = R"EOF(
+  {
+    "$schema": "http://json-schema.org/schema#",
+    "type" : "object"
+  }
+  )EOF";
+  std::vector<ObjectSharedPtr> elements;
+  Factory::loadFromStringStreaming(
+      "{\"items\": [\"scalar\", 1, 1.5, true, null]}", "items",
+      [&elements](ObjectSharedPtr item) -> void { elements.push_back(item); });
+  EXPECT_EQ(5, elements.size());
+  for (const ObjectSharedPtr& element : elements) {
+    EXPECT_THROW(element->validateSchema(object_schema), Exception);
+  }
+}
+
 TEST(JsonLoaderTest, YamlScalar) {
   EXPECT_EQ(true, Factory::loadFromYamlString("true")->asBoolean());
   EXPECT_EQ("true", Factory::loadFromYamlString("\"true\"")->asString());
@@ -24,6 +24,28 @@ TEST(BsonImplTest, Equal) {
   EXPECT_FALSE(*doc1 == *doc2);
 }
 
+TEST(BsonImplTest, LazyDecode) {
+  Buffer::OwnedImpl buffer;
+  DocumentSharedPtr source =
+      DocumentImpl::create()
+          ->addString("hello", "world")
+          ->addDocument("nested", DocumentImpl::create()->addInt32("a", 1));
+  source->encode(buffer);
+
+  // byteSize() and encode() work directly off the raw bytes without parsing elements.
+  DocumentSharedPtr decoded = DocumentImpl::create(buffer);
+  EXPECT_EQ(source->byteSize(), decoded->byteSize());
+  Buffer::OwnedImpl round_trip;
+  decoded->encode(round_trip);
+  EXPECT_EQ(static_cast<uint64_t>(source->byteSize()), round_trip.length());
+
+  // Accessing fields materializes them.
+  const Field* field = decoded->find("hello", Field::Type::STRING);
+  ASSERT_TRUE(field != nullptr);
+  EXPECT_EQ("world", field->asString());
+  EXPECT_TRUE(*source == *decoded);
+}
+
 TEST(BsonImplTest, InvalidMessageLength) {
   Buffer::OwnedImpl buffer;
   BufferHelper::writeInt32(buffer, 100);
@@ -37,7 +59,9 @@ TEST(BsonImplTest, InvalidElementType) {
   uint8_t invalid_element_type = 0x20;
   buffer.add(&invalid_element_type, sizeof(invalid_element_type));
   BufferHelper::writeCString(buffer, key_name);
-  EXPECT_THROW(DocumentImpl::create(buffer), EnvoyException);
+  // Element parsing is lazy, so the invalid element is not seen until the fields are accessed.
+  DocumentSharedPtr doc = DocumentImpl::create(buffer);
+  EXPECT_THROW(doc->toString(), EnvoyException);
 }
 
 TEST(BsonImplTest, InvalodDocumentTermination) {
@@ -379,6 +379,73 @@ TEST_F(MongoProxyFilterTest, DecodeError) {
   EXPECT_EQ(1U, store_.counter("test.decoding_error").value());
 }
 
+TEST_F(MongoProxyFilterTest, SampledDecoding) {
+  initializeFilter();
+
+  EXPECT_CALL(runtime_.snapshot_, getInteger("mongo.decode_sample_rate", 1))
+      .WillRepeatedly(Return(3));
+
+  // Three complete GET_MORE messages. With a sample rate of 3, the first is decoded fully and the
+  // other two are counted from their headers without running the decoder.
+  for (int i = 0; i < 3; i++) {
+    Bson::BufferHelper::writeInt32(fake_data_, 20); // Message length.
+    Bson::BufferHelper::writeInt32(fake_data_, i);  // Request ID.
+    Bson::BufferHelper::writeInt32(fake_data_, 0);  // Response to.
+    Bson::BufferHelper::writeInt32(fake_data_, static_cast<int32_t>(Message::OpCode::OP_GET_MORE));
+    Bson::BufferHelper::writeInt32(fake_data_, 0); // Payload.
+  }
+
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    EXPECT_EQ(20U, data.length());
+    data.drain(data.length());
+
+    GetMoreMessagePtr message(new GetMoreMessageImpl(0, 0));
+    message->fullCollectionName("db.test");
+    message->cursorId(1);
+    filter_->callbacks_->decodeGetMore(std::move(message));
+  }));
+  filter_->onData(fake_data_);
+
+  EXPECT_EQ(3U, store_.counter("test.op_get_more").value());
+}
+
+TEST_F(MongoProxyFilterTest, SampledDecodingSkippedReply) {
+  initializeFilter();
+
+  EXPECT_CALL(runtime_.snapshot_, getInteger("mongo.decode_sample_rate", 1))
+      .WillRepeatedly(Return(2));
+
+  // A query message that falls on the sample boundary and is decoded fully.
+  Bson::BufferHelper::writeInt32(fake_data_, 16);
+  Bson::BufferHelper::writeInt32(fake_data_, 1);
+  Bson::BufferHelper::writeInt32(fake_data_, 0);
+  Bson::BufferHelper::writeInt32(fake_data_, static_cast<int32_t>(Message::OpCode::OP_QUERY));
+
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    data.drain(data.length());
+
+    QueryMessagePtr message(new QueryMessageImpl(1, 0));
+    message->fullCollectionName("db.test");
+    message->flags(0b1110010);
+    message->query(Bson::DocumentImpl::create());
+    filter_->callbacks_->decodeQuery(std::move(message));
+  }));
+  filter_->onData(fake_data_);
+  EXPECT_EQ(1U, store_.gauge("test.op_query_active").value());
+
+  // The reply is not sampled. It is counted from the header alone and the query it answers is
+  // retired from the active query list.
+  Buffer::OwnedImpl reply_data;
+  Bson::BufferHelper::writeInt32(reply_data, 16);
+  Bson::BufferHelper::writeInt32(reply_data, 0);
+  Bson::BufferHelper::writeInt32(reply_data, 1); // Response to the query above.
+  Bson::BufferHelper::writeInt32(reply_data, static_cast<int32_t>(Message::OpCode::OP_REPLY));
+  filter_->onWrite(reply_data);
+
+  EXPECT_EQ(1U, store_.counter("test.op_reply").value());
+  EXPECT_EQ(0U, store_.gauge("test.op_query_active").value());
+}
+
 TEST_F(MongoProxyFilterTest, ConcurrentQuery) {
   initializeFilter();
 
@@ -0,0 +1,48 @@
+#include <chrono>
+
+#include "common/network/accept_rate_limiter_impl.h"
+
+#include "test/mocks/common.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+TEST(AcceptRateLimiterImplTest, All) {
+  MockMonotonicTimeSource time_source;
+  const MonotonicTime start(std::chrono::seconds(100));
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start));
+  AcceptRateLimiterImpl limiter(10, time_source);
+
+  // The bucket starts full with one second worth of tokens; grants are capped by the request.
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start));
+  EXPECT_EQ(4UL, limiter.take(4));
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start));
+  EXPECT_EQ(6UL, limiter.take(8));
+
+  // The budget is exhausted until time advances.
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start));
+  EXPECT_EQ(0UL, limiter.take(8));
+
+  // 250ms at 10 tokens/second refills 2.5 tokens. Only whole tokens are granted and the
+  // fractional remainder carries over to the next refill.
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start + std::chrono::milliseconds(250)));
+  EXPECT_EQ(2UL, limiter.take(8));
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start + std::chrono::milliseconds(500)));
+  EXPECT_EQ(3UL, limiter.take(8));
+
+  // A long idle period refills at most one second worth of tokens.
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start + std::chrono::seconds(60)));
+  EXPECT_EQ(8UL, limiter.take(8));
+  EXPECT_CALL(time_source, currentTime()).WillOnce(Return(start + std::chrono::seconds(60)));
+  EXPECT_EQ(2UL, limiter.take(8));
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,48 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class TestBalancedConnectionHandler : public BalancedConnectionHandler {
+public:
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() override { return num_connections_; }
+  void post(int, Address::InstanceConstSharedPtr, Address::InstanceConstSharedPtr,
+            bool) override {}
+
+  uint64_t num_connections_{};
+};
+
+TEST(ExactConnectionBalancerImplTest, All) {
+  ExactConnectionBalancerImpl balancer;
+  TestBalancedConnectionHandler handler1;
+  TestBalancedConnectionHandler handler2;
+  TestBalancedConnectionHandler handler3;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.registerHandler(handler3);
+
+  // When everything is equally loaded the connection stays with the accepting handler.
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler2));
+
+  // The least loaded handler is picked even when it is not the accepting handler.
+  handler1.num_connections_ = 2;
+  handler2.num_connections_ = 1;
+  EXPECT_EQ(&handler3, &balancer.pickTargetHandler(handler1));
+
+  // Ties between the accepting handler and another handler stay local.
+  handler3.num_connections_ = 1;
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler2));
+
+  // An unregistered handler is never picked.
+  handler3.num_connections_ = 0;
+  balancer.unregisterHandler(handler3);
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler1));
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
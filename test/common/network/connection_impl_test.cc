@@ -43,23 +43,30 @@ TEST(ConnectionImplUtility, updateBufferStats) {
   StrictMock<Stats::MockCounter> counter;
   StrictMock<Stats::MockGauge> gauge;
   uint64_t previous_total = 0;
+  uint64_t unflushed_total = 0;
 
+  // Small deltas accumulate in the local counter without touching the shared total; the buffered
+  // gauge is always updated immediately.
   InSequence s;
-  EXPECT_CALL(counter, add(5));
   EXPECT_CALL(gauge, add(5));
-  ConnectionImplUtility::updateBufferStats(5, 5, previous_total, counter, gauge);
+  ConnectionImplUtility::updateBufferStats(5, 5, previous_total, unflushed_total, counter, gauge);
   EXPECT_EQ(5UL, previous_total);
+  EXPECT_EQ(5UL, unflushed_total);
 
-  EXPECT_CALL(counter, add(1));
   EXPECT_CALL(gauge, sub(1));
-  ConnectionImplUtility::updateBufferStats(1, 4, previous_total, counter, gauge);
+  ConnectionImplUtility::updateBufferStats(1, 4, previous_total, unflushed_total, counter, gauge);
+  EXPECT_EQ(6UL, unflushed_total);
 
   EXPECT_CALL(gauge, sub(4));
-  ConnectionImplUtility::updateBufferStats(0, 0, previous_total, counter, gauge);
-
-  EXPECT_CALL(counter, add(3));
-  EXPECT_CALL(gauge, add(3));
-  ConnectionImplUtility::updateBufferStats(3, 3, previous_total, counter, gauge);
+  ConnectionImplUtility::updateBufferStats(0, 0, previous_total, unflushed_total, counter, gauge);
+
+  // A delta that takes the accumulator over the flush threshold pushes everything accumulated to
+  // the shared counter at once.
+  EXPECT_CALL(counter, add(6 + 64 * 1024));
+  EXPECT_CALL(gauge, add(64 * 1024));
+  ConnectionImplUtility::updateBufferStats(64 * 1024, 64 * 1024, previous_total, unflushed_total,
+                                           counter, gauge);
+  EXPECT_EQ(0UL, unflushed_total);
 }
 
 class ConnectionImplDeathTest : public testing::TestWithParam<Address::IpVersion> {};
@@ -244,9 +251,11 @@ TEST_P(ConnectionImplTest, ConnectionStats) {
       }));
 
   Sequence s2;
-  EXPECT_CALL(server_connection_stats.rx_total_, add(4)).InSequence(s2);
   EXPECT_CALL(server_connection_stats.rx_current_, add(4)).InSequence(s2);
   EXPECT_CALL(server_connection_stats.rx_current_, sub(4)).InSequence(s2);
+  // Byte totals below the batching threshold are only pushed to the shared counter when the
+  // connection closes.
+  EXPECT_CALL(server_connection_stats.rx_total_, add(4)).InSequence(s2);
   EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::LocalClose)).InSequence(s2);
 
   EXPECT_CALL(*read_filter_, onNewConnection());
@@ -402,6 +411,33 @@ TEST_P(ConnectionImplTest, BasicWrite) {
   disconnect(true);
 }
 
+// Write enough data in one shot that the zero copy send path is exercised on kernels that
+// support it (elsewhere the plain writev path is taken) and verify every byte arrives.
+TEST_P(ConnectionImplTest, BulkWrite) {
+  setUpBasicConnection();
+  connect();
+
+  std::string data_to_write(1024 * 1024, 'a');
+  Buffer::OwnedImpl buffer_to_write(data_to_write);
+  client_connection_->write(buffer_to_write);
+
+  uint64_t bytes_received = 0;
+  EXPECT_CALL(*read_filter_, onNewConnection());
+  EXPECT_CALL(*read_filter_, onData(_))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        bytes_received += data.length();
+        data.drain(data.length());
+        if (bytes_received == data_to_write.size()) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(data_to_write.size(), bytes_received);
+
+  disconnect(true);
+}
+
 // Similar to BasicWrite, only with watermarks set.
 TEST_P(ConnectionImplTest, WriteWithWatermarks) {
   useMockBuffer();
@@ -19,6 +19,7 @@
 #include "common/network/utility.h"
 #include "common/stats/stats_impl.h"
 
+#include "test/mocks/common.h"
 #include "test/mocks/network/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
@@ -28,10 +29,13 @@
 #include "ares_dns.h"
 #include "gtest/gtest.h"
 
+using testing::DoAll;
 using testing::InSequence;
 using testing::Mock;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnPointee;
+using testing::SaveArg;
 using testing::_;
 
 namespace Envoy {
@@ -605,5 +609,124 @@ TEST(DnsImplUnitTest, PendingTimerEnable) {
                                       }));
 }
 
+class CachingDnsResolverImplTest : public testing::Test {
+public:
+  CachingDnsResolverImplTest()
+      : wrapped_(new NiceMock<MockDnsResolver>()),
+        resolver_(DnsResolverSharedPtr{wrapped_}, time_source_, std::chrono::milliseconds(1000)) {
+    ON_CALL(time_source_, currentTime()).WillByDefault(ReturnPointee(&now_));
+  }
+
+  DnsResolver::ResolveCb expectResolvedAddress(const std::string& expected_address) {
+    return [this, expected_address](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+      ASSERT_EQ(1U, results.size());
+      EXPECT_EQ(expected_address, results.front()->ip()->addressAsString());
+      callbacks_issued_++;
+    };
+  }
+
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  MonotonicTime now_;
+  MockDnsResolver* wrapped_;
+  CachingDnsResolverImpl resolver_;
+  uint64_t callbacks_issued_{};
+};
+
+// Concurrent queries for the same name coalesce onto a single upstream query, and subsequent
+// queries within the TTL are served from the cache without going upstream.
+TEST_F(CachingDnsResolverImplTest, CoalesceAndCache) {
+  DnsResolver::ResolveCb upstream_cb;
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(DoAll(SaveArg<2>(&upstream_cb), Return(&wrapped_->active_query_)));
+
+  EXPECT_NE(nullptr, resolver_.resolve("foo.com", DnsLookupFamily::V4Only,
+                                       expectResolvedAddress("10.0.0.1")));
+  EXPECT_NE(nullptr, resolver_.resolve("foo.com", DnsLookupFamily::V4Only,
+                                       expectResolvedAddress("10.0.0.1")));
+  EXPECT_EQ(0U, callbacks_issued_);
+
+  upstream_cb({Utility::parseInternetAddress("10.0.0.1")});
+  EXPECT_EQ(2U, callbacks_issued_);
+
+  // A cache hit is answered synchronously and returns no cancellable query.
+  EXPECT_EQ(nullptr, resolver_.resolve("foo.com", DnsLookupFamily::V4Only,
+                                       expectResolvedAddress("10.0.0.1")));
+  EXPECT_EQ(3U, callbacks_issued_);
+}
+
+// Queries for different lookup families of the same name do not share cache entries.
+TEST_F(CachingDnsResolverImplTest, FamilyIsPartOfTheKey) {
+  DnsResolver::ResolveCb upstream_cb;
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(DoAll(SaveArg<2>(&upstream_cb), Return(&wrapped_->active_query_)));
+  resolver_.resolve("foo.com", DnsLookupFamily::V4Only, expectResolvedAddress("10.0.0.1"));
+  upstream_cb({Utility::parseInternetAddress("10.0.0.1")});
+
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::Auto, _))
+      .WillOnce(DoAll(SaveArg<2>(&upstream_cb), Return(&wrapped_->active_query_)));
+  EXPECT_NE(nullptr, resolver_.resolve("foo.com", DnsLookupFamily::Auto,
+                                       expectResolvedAddress("10.0.0.2")));
+  upstream_cb({Utility::parseInternetAddress("10.0.0.2")});
+  EXPECT_EQ(2U, callbacks_issued_);
+}
+
+// Once an entry passes half of its TTL a cache hit still answers synchronously but kicks off a
+// background refresh, whose result replaces the cached addresses.
+TEST_F(CachingDnsResolverImplTest, RefreshAheadOfExpiry) {
+  DnsResolver::ResolveCb upstream_cb;
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(DoAll(SaveArg<2>(&upstream_cb), Return(&wrapped_->active_query_)));
+  resolver_.resolve("foo.com", DnsLookupFamily::V4Only, expectResolvedAddress("10.0.0.1"));
+  upstream_cb({Utility::parseInternetAddress("10.0.0.1")});
+
+  now_ += std::chrono::milliseconds(600);
+  DnsResolver::ResolveCb refresh_cb;
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(DoAll(SaveArg<2>(&refresh_cb), Return(&wrapped_->active_query_)));
+  EXPECT_EQ(nullptr, resolver_.resolve("foo.com", DnsLookupFamily::V4Only,
+                                       expectResolvedAddress("10.0.0.1")));
+  EXPECT_EQ(2U, callbacks_issued_);
+
+  refresh_cb({Utility::parseInternetAddress("10.0.0.2")});
+  EXPECT_EQ(nullptr, resolver_.resolve("foo.com", DnsLookupFamily::V4Only,
+                                       expectResolvedAddress("10.0.0.2")));
+  EXPECT_EQ(3U, callbacks_issued_);
+}
+
+// A failed query after expiry serves the previously cached addresses to its waiters, matching
+// how the DNS cluster types hold on to their last good hosts.
+TEST_F(CachingDnsResolverImplTest, StaleServedOnFailure) {
+  DnsResolver::ResolveCb upstream_cb;
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(DoAll(SaveArg<2>(&upstream_cb), Return(&wrapped_->active_query_)));
+  resolver_.resolve("foo.com", DnsLookupFamily::V4Only, expectResolvedAddress("10.0.0.1"));
+  upstream_cb({Utility::parseInternetAddress("10.0.0.1")});
+
+  now_ += std::chrono::milliseconds(1001);
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(DoAll(SaveArg<2>(&upstream_cb), Return(&wrapped_->active_query_)));
+  EXPECT_NE(nullptr, resolver_.resolve("foo.com", DnsLookupFamily::V4Only,
+                                       expectResolvedAddress("10.0.0.1")));
+  upstream_cb({});
+  EXPECT_EQ(2U, callbacks_issued_);
+}
+
+// A cancelled waiter does not have its callback invoked when the coalesced query completes, but
+// other waiters do.
+TEST_F(CachingDnsResolverImplTest, Cancel) {
+  DnsResolver::ResolveCb upstream_cb;
+  EXPECT_CALL(*wrapped_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce(DoAll(SaveArg<2>(&upstream_cb), Return(&wrapped_->active_query_)));
+
+  ActiveDnsQuery* query = resolver_.resolve(
+      "foo.com", DnsLookupFamily::V4Only,
+      [](std::list<Address::InstanceConstSharedPtr>&&) -> void { FAIL(); });
+  resolver_.resolve("foo.com", DnsLookupFamily::V4Only, expectResolvedAddress("10.0.0.1"));
+  query->cancel();
+
+  upstream_cb({Utility::parseInternetAddress("10.0.0.1")});
+  EXPECT_EQ(1U, callbacks_issued_);
+}
+
 } // namespace Network
 } // namespace Envoy
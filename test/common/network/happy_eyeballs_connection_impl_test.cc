@@ -0,0 +1,166 @@
+#include <memory>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/happy_eyeballs_connection_impl.h"
+
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::_;
+
+namespace Envoy {
+namespace Network {
+
+class HappyEyeballsConnectionImplTest : public testing::Test {
+public:
+  void createConnection(size_t num_addresses) {
+    for (size_t i = 0; i < num_addresses; i++) {
+      address_list_.emplace_back(new Address::Ipv4Instance("127.0.0.1", 10000 + i));
+    }
+
+    next_attempt_timer_ = new NiceMock<Event::MockTimer>(&dispatcher_);
+    connection_.reset(new HappyEyeballsConnectionImpl(
+        dispatcher_, address_list_,
+        [this](Address::InstanceConstSharedPtr address) -> ClientConnectionPtr {
+          auto* created = new NiceMock<MockClientConnection>();
+          created_connections_.push_back(created);
+          created_addresses_.push_back(address);
+          return ClientConnectionPtr{created};
+        }));
+  }
+
+  std::vector<Address::InstanceConstSharedPtr> address_list_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Event::MockTimer>* next_attempt_timer_{};
+  std::vector<NiceMock<MockClientConnection>*> created_connections_;
+  std::vector<Address::InstanceConstSharedPtr> created_addresses_;
+  NiceMock<MockConnectionCallbacks> callbacks_;
+  ClientConnectionPtr connection_;
+};
+
+// The first attempt connects before the stagger timer fires: no other attempts are made and the
+// state queued while connecting is replayed onto the winner.
+TEST_F(HappyEyeballsConnectionImplTest, FirstAttemptWins) {
+  createConnection(2);
+  ASSERT_EQ(1U, created_connections_.size());
+  EXPECT_EQ(*address_list_[0], *created_addresses_[0]);
+
+  connection_->addConnectionCallbacks(callbacks_);
+  EXPECT_CALL(*created_connections_[0], connect());
+  EXPECT_CALL(*next_attempt_timer_, enableTimer(_));
+  connection_->connect();
+
+  // Queue state while no attempt has connected yet.
+  connection_->noDelay(true);
+  connection_->readDisable(true);
+  Buffer::OwnedImpl data("hello");
+  connection_->write(data);
+  EXPECT_FALSE(connection_->readEnabled());
+
+  EXPECT_CALL(*next_attempt_timer_, disableTimer());
+  EXPECT_CALL(*created_connections_[0], noDelay(true));
+  EXPECT_CALL(*created_connections_[0], readDisable(true));
+  EXPECT_CALL(*created_connections_[0], write(BufferStringEqual("hello")));
+  EXPECT_CALL(callbacks_, onEvent(ConnectionEvent::Connected));
+  created_connections_[0]->raiseEvent(ConnectionEvent::Connected);
+  EXPECT_EQ(1U, created_connections_.size());
+
+  // Calls now delegate straight to the winner.
+  EXPECT_CALL(*created_connections_[0], readDisable(false));
+  connection_->readDisable(false);
+
+  connection_->close(ConnectionCloseType::NoFlush);
+}
+
+// When the stagger timer fires before the first attempt connects, a second attempt is raced
+// against it; the winner's losers are closed.
+TEST_F(HappyEyeballsConnectionImplTest, StaggeredAttemptLosesRace) {
+  createConnection(3);
+
+  EXPECT_CALL(*created_connections_[0], connect());
+  connection_->connect();
+  connection_->addConnectionCallbacks(callbacks_);
+
+  next_attempt_timer_->callback_();
+  ASSERT_EQ(2U, created_connections_.size());
+  EXPECT_EQ(*address_list_[1], *created_addresses_[1]);
+
+  // The second attempt connects first and wins; the first is closed and deferred deleted.
+  EXPECT_CALL(*created_connections_[0], close(ConnectionCloseType::NoFlush));
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(callbacks_, onEvent(ConnectionEvent::Connected));
+  created_connections_[1]->raiseEvent(ConnectionEvent::Connected);
+
+  // The third address was never tried.
+  EXPECT_EQ(2U, created_connections_.size());
+
+  connection_->close(ConnectionCloseType::NoFlush);
+}
+
+// A failed attempt immediately starts the next one without waiting for the stagger timer.
+TEST_F(HappyEyeballsConnectionImplTest, FailoverOnAttemptFailure) {
+  createConnection(2);
+
+  EXPECT_CALL(*created_connections_[0], connect());
+  connection_->connect();
+  connection_->addConnectionCallbacks(callbacks_);
+
+  EXPECT_CALL(*next_attempt_timer_, disableTimer());
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  created_connections_[0]->raiseEvent(ConnectionEvent::RemoteClose);
+  ASSERT_EQ(2U, created_connections_.size());
+  EXPECT_EQ(*address_list_[1], *created_addresses_[1]);
+
+  EXPECT_CALL(callbacks_, onEvent(ConnectionEvent::Connected));
+  created_connections_[1]->raiseEvent(ConnectionEvent::Connected);
+
+  connection_->close(ConnectionCloseType::NoFlush);
+}
+
+// When every attempt fails the final failure is surfaced to the registered callbacks.
+TEST_F(HappyEyeballsConnectionImplTest, AllAttemptsFail) {
+  createConnection(2);
+
+  EXPECT_CALL(*created_connections_[0], connect());
+  connection_->connect();
+  connection_->addConnectionCallbacks(callbacks_);
+
+  created_connections_[0]->raiseEvent(ConnectionEvent::RemoteClose);
+  ASSERT_EQ(2U, created_connections_.size());
+
+  EXPECT_CALL(callbacks_, onEvent(ConnectionEvent::RemoteClose));
+  created_connections_[1]->raiseEvent(ConnectionEvent::RemoteClose);
+
+  // The last (closed) connection remains as the delegate for queries.
+  EXPECT_EQ(Connection::State::Closed, connection_->state());
+}
+
+// Closing before any attempt has connected closes all in-flight attempts and raises LocalClose
+// exactly once.
+TEST_F(HappyEyeballsConnectionImplTest, CloseBeforeWinner) {
+  createConnection(3);
+
+  EXPECT_CALL(*created_connections_[0], connect());
+  connection_->connect();
+  connection_->addConnectionCallbacks(callbacks_);
+
+  next_attempt_timer_->callback_();
+  ASSERT_EQ(2U, created_connections_.size());
+
+  EXPECT_CALL(*created_connections_[0], close(_));
+  EXPECT_CALL(*created_connections_[1], close(_));
+  EXPECT_CALL(callbacks_, onEvent(ConnectionEvent::LocalClose));
+  connection_->close(ConnectionCloseType::NoFlush);
+
+  EXPECT_EQ(Connection::State::Closed, connection_->state());
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,95 @@
+#include <string>
+#include <vector>
+
+#include "common/network/lc_trie.h"
+#include "common/network/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+
+class LcTrieTest : public testing::Test {
+public:
+  void setup(const std::vector<std::pair<std::string, std::vector<std::string>>>& tag_data) {
+    std::vector<std::pair<std::string, std::vector<Address::CidrRange>>> input;
+    for (const auto& entry : tag_data) {
+      std::pair<std::string, std::vector<Address::CidrRange>> pair;
+      pair.first = entry.first;
+      for (const std::string& range : entry.second) {
+        pair.second.push_back(Address::CidrRange::create(range));
+      }
+      input.push_back(std::move(pair));
+    }
+    trie_.reset(new LcTrie<std::string>(input));
+  }
+
+  std::vector<std::string> getTags(const std::string& address) {
+    return trie_->getTags(*Utility::parseInternetAddress(address));
+  }
+
+  std::unique_ptr<LcTrie<std::string>> trie_;
+};
+
+TEST_F(LcTrieTest, Ipv4) {
+  setup({{"rfc1918", {"10.0.0.0/8", "172.16.0.0/12", "192.168.0.0/16"}},
+         {"loopback", {"127.0.0.1/32"}},
+         {"dense", {"1.2.0.0/16", "1.3.0.0/16", "1.2.128.0/17"}}});
+
+  EXPECT_EQ(std::vector<std::string>({"rfc1918"}), getTags("10.255.255.255"));
+  EXPECT_EQ(std::vector<std::string>({"rfc1918"}), getTags("172.16.0.1"));
+  EXPECT_EQ(std::vector<std::string>({"rfc1918"}), getTags("192.168.255.1"));
+  EXPECT_EQ(std::vector<std::string>({"loopback"}), getTags("127.0.0.1"));
+  EXPECT_EQ(std::vector<std::string>({"dense"}), getTags("1.2.0.1"));
+  EXPECT_EQ(std::vector<std::string>({"dense"}), getTags("1.3.255.255"));
+
+  EXPECT_TRUE(getTags("127.0.0.2").empty());
+  EXPECT_TRUE(getTags("192.169.0.1").empty());
+  EXPECT_TRUE(getTags("1.4.0.1").empty());
+}
+
+TEST_F(LcTrieTest, NestedRanges) {
+  setup({{"coarse", {"10.0.0.0/8"}},
+         {"fine", {"10.1.0.0/16"}},
+         {"finest", {"10.1.2.3/32"}}});
+
+  // A lookup returns the tags of every enclosing range.
+  EXPECT_EQ(std::vector<std::string>({"coarse"}), getTags("10.2.0.1"));
+  EXPECT_EQ(std::vector<std::string>({"coarse", "fine"}), getTags("10.1.0.1"));
+  EXPECT_EQ(std::vector<std::string>({"coarse", "fine", "finest"}), getTags("10.1.2.3"));
+  EXPECT_TRUE(getTags("11.0.0.1").empty());
+}
+
+TEST_F(LcTrieTest, Ipv6) {
+  setup({{"internal", {"fd00::/8"}}, {"host", {"2001:db8::1/128"}}});
+
+  EXPECT_EQ(std::vector<std::string>({"internal"}), getTags("fd01::1"));
+  EXPECT_EQ(std::vector<std::string>({"host"}), getTags("2001:db8::1"));
+  EXPECT_TRUE(getTags("2001:db8::2").empty());
+
+  // IPv4 addresses do not hit the IPv6 trie.
+  EXPECT_TRUE(getTags("253.0.0.1").empty());
+}
+
+TEST_F(LcTrieTest, MatchEverything) {
+  setup({{"all", {"0.0.0.0/0", "::/0"}}});
+
+  EXPECT_EQ(std::vector<std::string>({"all"}), getTags("1.2.3.4"));
+  EXPECT_EQ(std::vector<std::string>({"all"}), getTags("2001:db8::1"));
+}
+
+TEST_F(LcTrieTest, Empty) {
+  setup({});
+
+  EXPECT_TRUE(getTags("1.2.3.4").empty());
+  EXPECT_TRUE(getTags("::1").empty());
+}
+
+TEST_F(LcTrieTest, InvalidRange) {
+  std::vector<std::pair<std::string, std::vector<Address::CidrRange>>> input;
+  input.push_back({"bad", {Address::CidrRange::create("foo")}});
+  EXPECT_THROW(LcTrie<std::string> trie(input), EnvoyException);
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -1,3 +1,6 @@
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
 #include "envoy/common/exception.h"
 
 #include "common/network/listen_socket_impl.h"
@@ -49,6 +52,34 @@ TEST_P(ListenSocketImplTest, BindSpecificPort) {
   EXPECT_EQ(addr->asString(), socket3.localAddress()->asString());
 }
 
+#ifdef TCP_FASTOPEN
+TEST_P(ListenSocketImplTest, TcpFastOpen) {
+  auto loopback = Network::Test::getCanonicalLoopbackAddress(version_);
+  TcpListenSocketOptions options;
+  options.tcp_fastopen_queue_length_ = 5;
+  TcpListenSocket socket(loopback, true, options);
+
+  int qlen = 0;
+  socklen_t len = sizeof(qlen);
+  EXPECT_EQ(0, getsockopt(socket.fd(), IPPROTO_TCP, TCP_FASTOPEN, &qlen, &len));
+  EXPECT_EQ(5, qlen);
+}
+#endif
+
+#ifdef TCP_DEFER_ACCEPT
+TEST_P(ListenSocketImplTest, DeferAccept) {
+  auto loopback = Network::Test::getCanonicalLoopbackAddress(version_);
+  TcpListenSocketOptions options;
+  options.defer_accept_timeout_seconds_ = 5;
+  TcpListenSocket socket(loopback, true, options);
+
+  int timeout = 0;
+  socklen_t len = sizeof(timeout);
+  EXPECT_EQ(0, getsockopt(socket.fd(), IPPROTO_TCP, TCP_DEFER_ACCEPT, &timeout, &len));
+  EXPECT_LT(0, timeout);
+}
+#endif
+
 // Validate that we get port allocation when binding to port zero.
 TEST_P(ListenSocketImplTest, BindPortZero) {
   auto loopback = Network::Test::getCanonicalLoopbackAddress(version_);
@@ -327,5 +327,38 @@ TEST_P(ListenerImplTest, WildcardListenerUseActualDst) {
   dispatcher.run(Event::Dispatcher::RunType::Block);
 }
 
+TEST_P(ListenerImplTest, DeferredAcceptNoDataStat) {
+  Stats::IsolatedStoreImpl stats_store;
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(version_), true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::TestListenerImpl listener(connection_handler, dispatcher, socket, listener_callbacks,
+                                     stats_store,
+                                     {.bind_to_port_ = true,
+                                      .use_proxy_proto_ = false,
+                                      .use_original_dst_ = false,
+                                      .per_connection_buffer_limit_bytes_ = 0,
+                                      .deferred_accept_ = true});
+
+  // The client never writes, so when the connection is handed over there is no data to read and
+  // the no-data counter must record it.
+  Network::ClientConnectionPtr client_connection = dispatcher.createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr());
+  client_connection->connect();
+
+  EXPECT_CALL(listener, newConnection(_, _, _, _)).Times(1);
+  EXPECT_CALL(listener_callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        client_connection->close(ConnectionCloseType::NoFlush);
+        conn->close(ConnectionCloseType::NoFlush);
+        dispatcher.exit();
+      }));
+
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(1UL, stats_store.counter("downstream_cx_deferred_accept_no_data").value());
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -67,6 +67,11 @@ public:
     conn_->write(buf);
   }
 
+  void write(const uint8_t* data, size_t len) {
+    Buffer::OwnedImpl buf(data, len);
+    conn_->write(buf);
+  }
+
   void disconnect() {
     EXPECT_CALL(connection_callbacks_, onEvent(ConnectionEvent::LocalClose));
     EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::RemoteClose))
@@ -141,6 +146,171 @@ TEST_P(ProxyProtocolTest, BasicV6) {
   disconnect();
 }
 
+TEST_P(ProxyProtocolTest, V2Basic) {
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
+                            0x54, 0x0a, 0x21, 0x11, 0x00, 0x0c, 1,    2,    3,    4,
+                            254,  254,  254,  254,  0x04, 0xd2, 0x01, 0xbb};
+  connect();
+  write(header, sizeof(header));
+  write("more data");
+
+  EXPECT_CALL(*read_filter_, onNewConnection());
+  EXPECT_CALL(*read_filter_, onData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer) -> FilterStatus {
+        EXPECT_EQ(server_connection_->remoteAddress().ip()->addressAsString(), "1.2.3.4");
+        EXPECT_EQ(server_connection_->remoteAddress().ip()->port(), 1234U);
+
+        EXPECT_EQ(TestUtility::bufferToString(buffer), "more data");
+        buffer.drain(9);
+        return Network::FilterStatus::Continue;
+      }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  disconnect();
+}
+
+TEST_P(ProxyProtocolTest, V2BasicV6) {
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49, 0x54,
+                            0x0a, 0x21, 0x21, 0x00, 0x24, 0x00, 0x01, 0x00, 0x02, 0x00, 0x03,
+                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00,
+                            0x05, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                            0x00, 0x07, 0x00, 0x08, 0x04, 0xd2, 0x01, 0xbb};
+  connect();
+  write(header, sizeof(header));
+  write("more data");
+
+  EXPECT_CALL(*read_filter_, onNewConnection());
+  EXPECT_CALL(*read_filter_, onData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer) -> FilterStatus {
+        EXPECT_EQ(server_connection_->remoteAddress().ip()->addressAsString(), "1:2:3::4");
+        EXPECT_EQ(server_connection_->remoteAddress().ip()->port(), 1234U);
+
+        EXPECT_EQ(TestUtility::bufferToString(buffer), "more data");
+        buffer.drain(9);
+        return Network::FilterStatus::Continue;
+      }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  disconnect();
+}
+
+TEST_P(ProxyProtocolTest, V2Fragmented) {
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
+                            0x54, 0x0a, 0x21, 0x11, 0x00, 0x0c, 1,    2,    3,    4,
+                            254,  254,  254,  254,  0x04, 0xd2, 0x01, 0xbb};
+  connect();
+  // Deliver a prefix of the signature, the rest of the fixed header, and finally the address
+  // block, with event loop runs in between.
+  write(header, 10);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  write(header + 10, 8);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  write(header + 18, sizeof(header) - 18);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  disconnect();
+
+  EXPECT_EQ(server_connection_->remoteAddress().ip()->addressAsString(), "1.2.3.4");
+}
+
+TEST_P(ProxyProtocolTest, V2TlvData) {
+  // The address length covers four bytes of TLV data past the address block; the TLV bytes must
+  // be consumed with the header and not delivered to the connection.
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51,
+                            0x55, 0x49, 0x54, 0x0a, 0x21, 0x11, 0x00, 0x10,
+                            1,    2,    3,    4,    254,  254,  254,  254,
+                            0x04, 0xd2, 0x01, 0xbb, 0x04, 0x00, 0x00, 0x00};
+  connect();
+  write(header, sizeof(header));
+  write("more data");
+
+  EXPECT_CALL(*read_filter_, onNewConnection());
+  EXPECT_CALL(*read_filter_, onData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer) -> FilterStatus {
+        EXPECT_EQ(server_connection_->remoteAddress().ip()->addressAsString(), "1.2.3.4");
+
+        EXPECT_EQ(TestUtility::bufferToString(buffer), "more data");
+        buffer.drain(9);
+        return Network::FilterStatus::Continue;
+      }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  disconnect();
+}
+
+TEST_P(ProxyProtocolTest, V2LocalCommand) {
+  // A LOCAL connection carries no address block; the connection's own addresses are used.
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51,
+                            0x55, 0x49, 0x54, 0x0a, 0x20, 0x00, 0x00, 0x00};
+  connect();
+  write(header, sizeof(header));
+  write("more data");
+
+  EXPECT_CALL(*read_filter_, onNewConnection());
+  EXPECT_CALL(*read_filter_, onData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer) -> FilterStatus {
+        EXPECT_EQ(server_connection_->remoteAddress().ip()->addressAsString(),
+                  Network::Test::getCanonicalLoopbackAddress(GetParam())->ip()->addressAsString());
+
+        EXPECT_EQ(TestUtility::bufferToString(buffer), "more data");
+        buffer.drain(9);
+        return Network::FilterStatus::Continue;
+      }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  disconnect();
+}
+
+TEST_P(ProxyProtocolTest, V2BadVersion) {
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
+                            0x54, 0x0a, 0x31, 0x11, 0x00, 0x0c, 1,    2,    3,    4,
+                            254,  254,  254,  254,  0x04, 0xd2, 0x01, 0xbb};
+  connectNoRead();
+  write(header, sizeof(header));
+  expectProxyProtoError();
+}
+
+TEST_P(ProxyProtocolTest, V2BadCommand) {
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
+                            0x54, 0x0a, 0x22, 0x11, 0x00, 0x0c, 1,    2,    3,    4,
+                            254,  254,  254,  254,  0x04, 0xd2, 0x01, 0xbb};
+  connectNoRead();
+  write(header, sizeof(header));
+  expectProxyProtoError();
+}
+
+TEST_P(ProxyProtocolTest, V2UnsupportedAddressFamily) {
+  // UDP over IPv4.
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49,
+                            0x54, 0x0a, 0x21, 0x12, 0x00, 0x0c, 1,    2,    3,    4,
+                            254,  254,  254,  254,  0x04, 0xd2, 0x01, 0xbb};
+  connectNoRead();
+  write(header, sizeof(header));
+  expectProxyProtoError();
+}
+
+TEST_P(ProxyProtocolTest, V2ShortAddressBlock) {
+  // The declared address length is too short to hold two IPv4 addresses and ports.
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51, 0x55, 0x49, 0x54, 0x0a,
+                            0x21, 0x11, 0x00, 0x08, 1,    2,    3,    4,    254,  254,  254,  254};
+  connectNoRead();
+  write(header, sizeof(header));
+  expectProxyProtoError();
+}
+
+TEST_P(ProxyProtocolTest, V2HeaderTooLarge) {
+  // The declared address length is more TLV data than will be buffered.
+  const uint8_t header[] = {0x0d, 0x0a, 0x0d, 0x0a, 0x00, 0x0d, 0x0a, 0x51,
+                            0x55, 0x49, 0x54, 0x0a, 0x21, 0x11, 0x10, 0x00};
+  connectNoRead();
+  write(header, sizeof(header));
+  expectProxyProtoError();
+}
+
 TEST_P(ProxyProtocolTest, Fragmented) {
   connect();
   write("PROXY TCP4");
@@ -6,7 +6,10 @@
 #include "common/http/headers.h"
 #include "common/ratelimit/ratelimit_impl.h"
 
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/grpc/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
@@ -16,7 +19,7 @@
 
 using testing::AtLeast;
 using testing::Invoke;
-using testing::Ref;
+using testing::NiceMock;
 using testing::Return;
 using testing::WithArg;
 using testing::_;
@@ -34,61 +37,80 @@ public:
   RateLimitGrpcClientTest()
       : async_client_(new Grpc::MockAsyncClient<pb::lyft::ratelimit::RateLimitRequest,
                                                 pb::lyft::ratelimit::RateLimitResponse>()),
-        client_(RateLimitAsyncClientPtr{async_client_}, Optional<std::chrono::milliseconds>()) {}
+        batch_timer_(new NiceMock<Event::MockTimer>(&dispatcher_)),
+        batcher_(RateLimitAsyncClientPtr{async_client_}, dispatcher_, time_source_),
+        client_(batcher_, Optional<std::chrono::milliseconds>()) {}
+
+  // Fire the batch timer as the dispatcher would at the end of the current iteration.
+  void flush() { batch_timer_->callback_(); }
+
+  void expectSend(const pb::lyft::ratelimit::RateLimitRequest& expected_request) {
+    EXPECT_CALL(*async_client_, send(_, ProtoEq(expected_request), _, _))
+        .WillOnce(Invoke([this](
+                             const Protobuf::MethodDescriptor& service_method,
+                             const pb::lyft::ratelimit::RateLimitRequest&,
+                             Grpc::AsyncRequestCallbacks<pb::lyft::ratelimit::RateLimitResponse>&
+                                 callbacks,
+                             const Optional<std::chrono::milliseconds>&) -> Grpc::AsyncRequest* {
+          EXPECT_EQ("pb.lyft.ratelimit.RateLimitService", service_method.service()->full_name());
+          EXPECT_EQ("ShouldRateLimit", service_method.name());
+          callbacks_ = &callbacks;
+          return &async_request_;
+        }));
+  }
 
   Grpc::MockAsyncClient<pb::lyft::ratelimit::RateLimitRequest,
                         pb::lyft::ratelimit::RateLimitResponse>* async_client_;
   Grpc::MockAsyncRequest async_request_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  NiceMock<Event::MockTimer>* batch_timer_;
+  GrpcBatcherImpl batcher_;
   GrpcClientImpl client_;
+  RateLimitAsyncCallbacks* callbacks_{};
   MockRequestCallbacks request_callbacks_;
 };
 
 TEST_F(RateLimitGrpcClientTest, Basic) {
   std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse> response;
+  EXPECT_CALL(*batch_timer_, enableTimer(std::chrono::milliseconds(0))).Times(3);
 
   {
     pb::lyft::ratelimit::RateLimitRequest request;
     Http::HeaderMapImpl headers;
     GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}}}});
-    EXPECT_CALL(*async_client_, send(_, ProtoEq(request), Ref(client_), _))
-        .WillOnce(Invoke([this](
-                             const Protobuf::MethodDescriptor& service_method,
-                             const pb::lyft::ratelimit::RateLimitRequest&,
-                             Grpc::AsyncRequestCallbacks<pb::lyft::ratelimit::RateLimitResponse>&,
-                             const Optional<std::chrono::milliseconds>&) -> Grpc::AsyncRequest* {
-          EXPECT_EQ("pb.lyft.ratelimit.RateLimitService", service_method.service()->full_name());
-          EXPECT_EQ("ShouldRateLimit", service_method.name());
-          return &async_request_;
-        }));
+    expectSend(request);
 
     client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+    flush();
 
-    client_.onCreateInitialMetadata(headers);
+    callbacks_->onCreateInitialMetadata(headers);
     EXPECT_EQ(nullptr, headers.RequestId());
 
     response.reset(new pb::lyft::ratelimit::RateLimitResponse());
     response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
     EXPECT_CALL(request_callbacks_, complete(LimitStatus::OverLimit));
-    client_.onSuccess(std::move(response));
+    callbacks_->onSuccess(std::move(response));
   }
 
   {
     pb::lyft::ratelimit::RateLimitRequest request;
     Http::HeaderMapImpl headers;
     GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}, {"bar", "baz"}}}});
-    EXPECT_CALL(*async_client_, send(_, ProtoEq(request), _, _)).WillOnce(Return(&async_request_));
+    expectSend(request);
 
     client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}, {"bar", "baz"}}}},
                   {"requestid", "context"});
+    flush();
 
-    client_.onCreateInitialMetadata(headers);
+    callbacks_->onCreateInitialMetadata(headers);
     EXPECT_EQ(headers.RequestId()->value(), "requestid");
     EXPECT_EQ(headers.OtSpanContext()->value(), "context");
 
     response.reset(new pb::lyft::ratelimit::RateLimitResponse());
     response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OK);
     EXPECT_CALL(request_callbacks_, complete(LimitStatus::OK));
-    client_.onSuccess(std::move(response));
+    callbacks_->onSuccess(std::move(response));
   }
 
   {
@@ -96,45 +118,207 @@ TEST_F(RateLimitGrpcClientTest, Basic) {
     GrpcClientImpl::createRequest(
         request, "foo",
         {{{{"foo", "bar"}, {"bar", "baz"}}}, {{{"foo2", "bar2"}, {"bar2", "baz2"}}}});
-    EXPECT_CALL(*async_client_, send(_, ProtoEq(request), _, _)).WillOnce(Return(&async_request_));
+    expectSend(request);
 
     client_.limit(request_callbacks_, "foo",
                   {{{{"foo", "bar"}, {"bar", "baz"}}}, {{{"foo2", "bar2"}, {"bar2", "baz2"}}}},
                   Tracing::EMPTY_CONTEXT);
+    flush();
 
     response.reset(new pb::lyft::ratelimit::RateLimitResponse());
     EXPECT_CALL(request_callbacks_, complete(LimitStatus::Error));
-    client_.onFailure(Grpc::Status::Unknown, "");
+    callbacks_->onFailure(Grpc::Status::Unknown, "");
   }
 }
 
-TEST_F(RateLimitGrpcClientTest, Cancel) {
-  std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse> response;
+TEST_F(RateLimitGrpcClientTest, Batching) {
+  // Checks issued before the batch timer fires are coalesced into a single request per domain,
+  // using the smallest timeout of the batched checks, and each check gets the verdict for its
+  // own descriptors.
+  GrpcClientImpl client2(batcher_,
+                         Optional<std::chrono::milliseconds>(std::chrono::milliseconds(42)));
+  MockRequestCallbacks request_callbacks2;
 
-  EXPECT_CALL(*async_client_, send(_, _, _, _)).WillOnce(Return(&async_request_));
+  pb::lyft::ratelimit::RateLimitRequest request;
+  GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}}}, {{{"foo2", "bar2"}}}});
+  EXPECT_CALL(*async_client_,
+              send(_, ProtoEq(request), _,
+                   Optional<std::chrono::milliseconds>(std::chrono::milliseconds(42))))
+      .WillOnce(WithArg<2>(
+          Invoke([this](Grpc::AsyncRequestCallbacks<pb::lyft::ratelimit::RateLimitResponse>&
+                            callbacks) -> Grpc::AsyncRequest* {
+            callbacks_ = &callbacks;
+            return &async_request_;
+          })));
 
+  EXPECT_CALL(*batch_timer_, enableTimer(std::chrono::milliseconds(0)));
   client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  client2.limit(request_callbacks2, "foo", {{{{"foo2", "bar2"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
 
-  EXPECT_CALL(async_request_, cancel());
+  std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse> response(
+      new pb::lyft::ratelimit::RateLimitResponse());
+  response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
+  response->add_statuses()->set_code(pb::lyft::ratelimit::RateLimitResponse_Code_OK);
+  response->add_statuses()->set_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
+  EXPECT_CALL(request_callbacks_, complete(LimitStatus::OK));
+  EXPECT_CALL(request_callbacks2, complete(LimitStatus::OverLimit));
+  callbacks_->onSuccess(std::move(response));
+}
+
+TEST_F(RateLimitGrpcClientTest, BatchPerDomain) {
+  GrpcClientImpl client2(batcher_, Optional<std::chrono::milliseconds>());
+  MockRequestCallbacks request_callbacks2;
+
+  pb::lyft::ratelimit::RateLimitRequest request1;
+  GrpcClientImpl::createRequest(request1, "foo", {{{{"foo", "bar"}}}});
+  pb::lyft::ratelimit::RateLimitRequest request2;
+  GrpcClientImpl::createRequest(request2, "bar", {{{{"foo", "bar"}}}});
+  RateLimitAsyncCallbacks* callbacks2{};
+  EXPECT_CALL(*async_client_, send(_, ProtoEq(request1), _, _))
+      .WillOnce(WithArg<2>(
+          Invoke([this](Grpc::AsyncRequestCallbacks<pb::lyft::ratelimit::RateLimitResponse>&
+                            callbacks) -> Grpc::AsyncRequest* {
+            callbacks_ = &callbacks;
+            return &async_request_;
+          })));
+  EXPECT_CALL(*async_client_, send(_, ProtoEq(request2), _, _))
+      .WillOnce(WithArg<2>(
+          Invoke([&callbacks2](Grpc::AsyncRequestCallbacks<pb::lyft::ratelimit::RateLimitResponse>&
+                                   callbacks) -> Grpc::AsyncRequest* {
+            callbacks2 = &callbacks;
+            return &async_request_;
+          })));
+
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  client2.limit(request_callbacks2, "bar", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
+
+  std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse> response(
+      new pb::lyft::ratelimit::RateLimitResponse());
+  response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OK);
+  EXPECT_CALL(request_callbacks_, complete(LimitStatus::OK));
+  callbacks_->onSuccess(std::move(response));
+
+  response.reset(new pb::lyft::ratelimit::RateLimitResponse());
+  response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
+  EXPECT_CALL(request_callbacks2, complete(LimitStatus::OverLimit));
+  callbacks2->onSuccess(std::move(response));
+}
+
+TEST_F(RateLimitGrpcClientTest, CancelBeforeFlush) {
+  // A check cancelled before the batch timer fires never makes it onto the wire.
+  EXPECT_CALL(*async_client_, send(_, _, _, _)).Times(0);
+
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  client_.cancel();
+  flush();
+}
+
+TEST_F(RateLimitGrpcClientTest, CancelInFlight) {
+  pb::lyft::ratelimit::RateLimitRequest request;
+  GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}}}});
+  expectSend(request);
+
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
+  client_.cancel();
+
+  // The response still arrives but the cancelled check is not completed.
+  EXPECT_CALL(request_callbacks_, complete(_)).Times(0);
+  std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse> response(
+      new pb::lyft::ratelimit::RateLimitResponse());
+  response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OK);
+  callbacks_->onSuccess(std::move(response));
+}
+
+TEST_F(RateLimitGrpcClientTest, OverLimitCache) {
+  const MonotonicTime start;
+  ON_CALL(time_source_, currentTime()).WillByDefault(Return(start));
+
+  pb::lyft::ratelimit::RateLimitRequest request;
+  GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}}}});
+  expectSend(request);
+
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
+
+  // An over limit status that reports the limit that fired is cached.
+  std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse> response(
+      new pb::lyft::ratelimit::RateLimitResponse());
+  response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
+  pb::lyft::ratelimit::RateLimitResponse_DescriptorStatus* status = response->add_statuses();
+  status->set_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
+  status->mutable_current_limit()->set_unit(pb::lyft::ratelimit::RateLimit_Unit_MINUTE);
+  EXPECT_CALL(request_callbacks_, complete(LimitStatus::OverLimit));
+  callbacks_->onSuccess(std::move(response));
+
+  // The same descriptor is answered from the cache without another RPC.
+  EXPECT_CALL(*async_client_, send(_, _, _, _)).Times(0);
+  EXPECT_CALL(request_callbacks_, complete(LimitStatus::OverLimit));
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+
+  // A different descriptor misses the cache.
+  pb::lyft::ratelimit::RateLimitRequest other_request;
+  GrpcClientImpl::createRequest(other_request, "foo", {{{{"other", "bar"}}}});
+  expectSend(other_request);
+  client_.limit(request_callbacks_, "foo", {{{{"other", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
+  client_.cancel();
+
+  // Past the cap on the derived TTL the cached decision expires and the service is asked again.
+  ON_CALL(time_source_, currentTime()).WillByDefault(Return(start + std::chrono::seconds(6)));
+  expectSend(request);
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
   client_.cancel();
+
+  // Both cancelled checks left their RPCs in flight; the batcher cancels them on destruction.
+  EXPECT_CALL(async_request_, cancel()).Times(2);
+}
+
+TEST_F(RateLimitGrpcClientTest, OverLimitWithoutLimitNotCached) {
+  pb::lyft::ratelimit::RateLimitRequest request;
+  GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}}}});
+  expectSend(request);
+
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
+
+  // Without the limit that fired there is nothing to derive a TTL from, so nothing is cached and
+  // the next check goes back to the service.
+  std::unique_ptr<pb::lyft::ratelimit::RateLimitResponse> response(
+      new pb::lyft::ratelimit::RateLimitResponse());
+  response->set_overall_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
+  response->add_statuses()->set_code(pb::lyft::ratelimit::RateLimitResponse_Code_OVER_LIMIT);
+  EXPECT_CALL(request_callbacks_, complete(LimitStatus::OverLimit));
+  callbacks_->onSuccess(std::move(response));
+
+  expectSend(request);
+  client_.limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::EMPTY_CONTEXT);
+  flush();
+  client_.cancel();
+  EXPECT_CALL(async_request_, cancel());
 }
 
 TEST(RateLimitGrpcFactoryTest, NoCluster) {
   envoy::api::v2::RateLimitServiceConfig config;
   config.set_cluster_name("foo");
   Upstream::MockClusterManager cm;
+  NiceMock<ThreadLocal::MockInstance> tls;
 
   EXPECT_CALL(cm, get("foo")).WillOnce(Return(nullptr));
-  EXPECT_THROW(GrpcFactoryImpl(config, cm), EnvoyException);
+  EXPECT_THROW(GrpcFactoryImpl(config, cm, tls), EnvoyException);
 }
 
 TEST(RateLimitGrpcFactoryTest, Create) {
   envoy::api::v2::RateLimitServiceConfig config;
   config.set_cluster_name("foo");
   Upstream::MockClusterManager cm;
+  NiceMock<ThreadLocal::MockInstance> tls;
 
   EXPECT_CALL(cm, get("foo")).Times(AtLeast(1));
-  GrpcFactoryImpl factory(config, cm);
+  GrpcFactoryImpl factory(config, cm, tls);
   factory.create(Optional<std::chrono::milliseconds>());
 }
 
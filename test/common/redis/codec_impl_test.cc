@@ -155,6 +155,83 @@ TEST_F(RedisEncoderDecoderImplTest, NestedArray) {
   EXPECT_EQ(value, *decoded_values_[0]);
 }
 
+TEST_F(RedisEncoderDecoderImplTest, RecycledValue) {
+  std::vector<RespValue> values(2);
+  values[0].type(RespType::BulkString);
+  values[0].asString() = "get";
+  values[1].type(RespType::BulkString);
+  values[1].asString() = "foo";
+
+  RespValue value;
+  value.type(RespType::Array);
+  value.asArray().swap(values);
+  encoder_.encode(value, buffer_);
+  decoder_.decode(buffer_);
+  EXPECT_EQ(value, *decoded_values_[0]);
+
+  // Hand the decoded value back and make sure a subsequent decode that reuses it (including its
+  // array storage) still produces a correct value.
+  decoder_.recycle(std::move(decoded_values_[0]));
+  value.asArray()[1].asString() = "barbaz";
+  encoder_.encode(value, buffer_);
+  decoder_.decode(buffer_);
+  EXPECT_EQ(value, *decoded_values_[1]);
+  EXPECT_EQ(0UL, buffer_.length());
+}
+
+TEST_F(RedisEncoderDecoderImplTest, LargeBulkString) {
+  RespValue value;
+  value.type(RespType::BulkString);
+  value.asString() = std::string(4096, 'a');
+  encoder_.encode(value, buffer_);
+  std::string encoded = TestUtility::bufferToString(buffer_);
+  decoder_.decode(buffer_);
+  EXPECT_TRUE(decoded_values_[0]->hasBufferStorage());
+  EXPECT_EQ(value, *decoded_values_[0]);
+  EXPECT_EQ(0UL, buffer_.length());
+
+  // Re-encoding writes from the buffer storage and must produce identical bytes.
+  encoder_.encode(*decoded_values_[0], buffer_);
+  EXPECT_EQ(encoded, TestUtility::bufferToString(buffer_));
+}
+
+TEST_F(RedisEncoderDecoderImplTest, LargeBulkStringPartialDecode) {
+  std::string payload(2048, 'b');
+  buffer_.add("$2048\r\n");
+  buffer_.add(payload.data(), 1000);
+  decoder_.decode(buffer_);
+  EXPECT_EQ(0UL, buffer_.length());
+  EXPECT_TRUE(decoded_values_.empty());
+
+  buffer_.add(payload.data() + 1000, 1048);
+  buffer_.add("\r\n");
+  decoder_.decode(buffer_);
+  EXPECT_TRUE(decoded_values_[0]->hasBufferStorage());
+  EXPECT_EQ(payload, decoded_values_[0]->asString());
+  EXPECT_EQ(0UL, buffer_.length());
+
+  // A mutable string reference drops the buffer storage.
+  EXPECT_FALSE(decoded_values_[0]->hasBufferStorage());
+}
+
+TEST_F(RedisEncoderDecoderImplTest, LargeBulkStringInArray) {
+  std::vector<RespValue> values(2);
+  values[0].type(RespType::BulkString);
+  values[0].asString() = "small";
+  values[1].type(RespType::BulkString);
+  values[1].asString() = std::string(1024, 'c');
+
+  RespValue value;
+  value.type(RespType::Array);
+  value.asArray().swap(values);
+  encoder_.encode(value, buffer_);
+  decoder_.decode(buffer_);
+  EXPECT_FALSE(decoded_values_[0]->asArray()[0].hasBufferStorage());
+  EXPECT_TRUE(decoded_values_[0]->asArray()[1].hasBufferStorage());
+  EXPECT_EQ(value, *decoded_values_[0]);
+  EXPECT_EQ(0UL, buffer_.length());
+}
+
 TEST_F(RedisEncoderDecoderImplTest, NullArray) {
   buffer_.add("*-1\r\n");
   decoder_.decode(buffer_);
@@ -28,6 +28,26 @@ namespace Envoy {
 namespace Redis {
 namespace CommandSplitter {
 
+TEST(RedisRedirectErrorTest, Parse) {
+  Utility::RedirectInfo info;
+
+  EXPECT_TRUE(Utility::parseRedirectError("MOVED 1111 10.0.0.1:6379", info));
+  EXPECT_FALSE(info.ask_);
+  EXPECT_EQ(1111U, info.slot_);
+  EXPECT_EQ("10.0.0.1:6379", info.host_address_);
+
+  EXPECT_TRUE(Utility::parseRedirectError("ASK 12182 10.0.0.2:6380", info));
+  EXPECT_TRUE(info.ask_);
+  EXPECT_EQ(12182U, info.slot_);
+  EXPECT_EQ("10.0.0.2:6380", info.host_address_);
+
+  EXPECT_FALSE(Utility::parseRedirectError("WRONGTYPE Operation against a key", info));
+  EXPECT_FALSE(Utility::parseRedirectError("MOVED", info));
+  EXPECT_FALSE(Utility::parseRedirectError("MOVED 1111", info));
+  EXPECT_FALSE(Utility::parseRedirectError("MOVED 1111 ", info));
+  EXPECT_FALSE(Utility::parseRedirectError("MOVED abc 10.0.0.1:6379", info));
+}
+
 class RedisCommandSplitterImplTest : public testing::Test {
 public:
   void makeBulkStringArray(RespValue& value, const std::vector<std::string>& strings) {
@@ -195,6 +215,91 @@ TEST_P(RedisSingleServerRequestTest, NoUpstream) {
   EXPECT_EQ(nullptr, handle_);
 };
 
+TEST_P(RedisSingleServerRequestTest, MovedRedirection) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {GetParam(), "hello"});
+  makeRequest("hello", request);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValuePtr moved(new RespValue());
+  moved->type(RespType::Error);
+  moved->asString() = "MOVED 1111 10.0.0.1:6379";
+  ConnPool::MockPoolRequest pool_request2;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost("10.0.0.1:6379", Ref(request), _, false))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_)), Return(&pool_request2)));
+  EXPECT_CALL(*conn_pool_, updateSlotOwner(1111, "10.0.0.1:6379"));
+  pool_callbacks_->onResponse(std::move(moved));
+
+  respond();
+};
+
+TEST_P(RedisSingleServerRequestTest, AskRedirection) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {GetParam(), "hello"});
+  makeRequest("hello", request);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValuePtr ask(new RespValue());
+  ask->type(RespType::Error);
+  ask->asString() = "ASK 1111 10.0.0.1:6379";
+  ConnPool::MockPoolRequest pool_request2;
+  // ASK is a one-off redirection: the slot map must not be updated.
+  EXPECT_CALL(*conn_pool_, makeRequestToHost("10.0.0.1:6379", Ref(request), _, true))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_)), Return(&pool_request2)));
+  pool_callbacks_->onResponse(std::move(ask));
+
+  respond();
+};
+
+TEST_P(RedisSingleServerRequestTest, RedirectionFailure) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {GetParam(), "hello"});
+  makeRequest("hello", request);
+  EXPECT_NE(nullptr, handle_);
+
+  // If the redirection target cannot be resolved, the error goes downstream unchanged.
+  RespValuePtr moved(new RespValue());
+  moved->type(RespType::Error);
+  moved->asString() = "MOVED 1111 10.0.0.1:6379";
+  RespValue* moved_ptr = moved.get();
+  EXPECT_CALL(*conn_pool_, makeRequestToHost("10.0.0.1:6379", Ref(request), _, false))
+      .WillOnce(Return(nullptr));
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(moved_ptr)));
+  pool_callbacks_->onResponse(std::move(moved));
+};
+
+TEST_P(RedisSingleServerRequestTest, SingleRedirectionOnly) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {GetParam(), "hello"});
+  makeRequest("hello", request);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValuePtr moved(new RespValue());
+  moved->type(RespType::Error);
+  moved->asString() = "MOVED 1111 10.0.0.1:6379";
+  ConnPool::MockPoolRequest pool_request2;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost("10.0.0.1:6379", Ref(request), _, false))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_)), Return(&pool_request2)));
+  EXPECT_CALL(*conn_pool_, updateSlotOwner(1111, "10.0.0.1:6379"));
+  pool_callbacks_->onResponse(std::move(moved));
+
+  // A second redirection is not followed; the error is forwarded downstream.
+  RespValuePtr moved2(new RespValue());
+  moved2->type(RespType::Error);
+  moved2->asString() = "MOVED 1111 10.0.0.2:6379";
+  RespValue* moved2_ptr = moved2.get();
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(moved2_ptr)));
+  pool_callbacks_->onResponse(std::move(moved2));
+};
+
 INSTANTIATE_TEST_CASE_P(RedisSingleServerRequestTest, RedisSingleServerRequestTest,
                         testing::ValuesIn(SupportedCommands::simpleCommands()));
 
@@ -331,6 +436,48 @@ TEST_F(RedisMGETCommandHandlerTest, Normal) {
   EXPECT_EQ(1UL, store_.counter("redis.foo.command.mget.total").value());
 };
 
+TEST_F(RedisMGETCommandHandlerTest, MovedRedirection) {
+  InSequence s;
+
+  setup(2, {});
+  EXPECT_NE(nullptr, handle_);
+
+  RespValue expected_response;
+  expected_response.type(RespType::Array);
+  std::vector<RespValue> elements(2);
+  elements[0].type(RespType::BulkString);
+  elements[0].asString() = "response";
+  elements[1].type(RespType::BulkString);
+  elements[1].asString() = "5";
+  expected_response.asArray().swap(elements);
+
+  // The first fragment is redirected and re-sent to the new owner; the response count is
+  // unaffected.
+  RespValuePtr moved(new RespValue());
+  moved->type(RespType::Error);
+  moved->asString() = "MOVED 1111 10.0.0.1:6379";
+  ConnPool::MockPoolRequest redirected_request;
+  EXPECT_CALL(*conn_pool_,
+              makeRequestToHost("10.0.0.1:6379", Eq(ByRef(expected_requests_[0])), _, false))
+      .WillOnce(
+          DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_[0])), Return(&redirected_request)));
+  EXPECT_CALL(*conn_pool_, updateSlotOwner(1111, "10.0.0.1:6379"));
+  pool_callbacks_[0]->onResponse(std::move(moved));
+
+  RespValuePtr response2(new RespValue());
+  response2->type(RespType::BulkString);
+  response2->asString() = "5";
+  pool_callbacks_[1]->onResponse(std::move(response2));
+
+  RespValuePtr response1(new RespValue());
+  response1->type(RespType::BulkString);
+  response1->asString() = "response";
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[0]->onResponse(std::move(response1));
+
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.mget.total").value());
+};
+
 TEST_F(RedisMGETCommandHandlerTest, NormalWithNull) {
   InSequence s;
 
@@ -3,6 +3,7 @@
 
 #include "common/network/utility.h"
 #include "common/redis/conn_pool_impl.h"
+#include "common/redis/crc16.h"
 #include "common/upstream/upstream_impl.h"
 
 #include "test/mocks/network/mocks.h"
@@ -14,6 +15,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::ByRef;
 using testing::Eq;
 using testing::InSequence;
 using testing::Invoke;
@@ -80,6 +82,9 @@ public:
   const std::string cluster_name_{"foo"};
   std::shared_ptr<Upstream::MockHost> host_{new NiceMock<Upstream::MockHost>()};
   Event::MockDispatcher dispatcher_;
+  // Declared before connect_or_op_timer_ so that the timers are returned in the order the client
+  // creates them (mock createTimer_() expectations match newest first).
+  Event::MockTimer* flush_timer_{new NiceMock<Event::MockTimer>(&dispatcher_)};
   Event::MockTimer* connect_or_op_timer_{new Event::MockTimer(&dispatcher_)};
   MockEncoder* encoder_{new MockEncoder()};
   MockDecoder* decoder_{new MockDecoder()};
@@ -136,6 +141,37 @@ TEST_F(RedisClientImplTest, Basic) {
   client_->close();
 }
 
+TEST_F(RedisClientImplTest, WriteCoalescing) {
+  InSequence s;
+
+  setup();
+
+  // The first request of an event loop iteration schedules the flush; requests that pile on in
+  // the same iteration do not re-arm the timer and everything leaves in a single write.
+  RespValue request1;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _));
+  EXPECT_CALL(*flush_timer_, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_NE(nullptr, client_->makeRequest(request1, callbacks1));
+
+  onConnected();
+
+  RespValue request2;
+  MockPoolCallbacks callbacks2;
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _));
+  EXPECT_CALL(*connect_or_op_timer_, enableTimer(_));
+  EXPECT_NE(nullptr, client_->makeRequest(request2, callbacks2));
+
+  EXPECT_CALL(*upstream_connection_, write(_));
+  flush_timer_->callback_();
+
+  EXPECT_CALL(host_->outlier_detector_, putHttpResponseCode(503));
+  EXPECT_CALL(callbacks1, onFailure());
+  EXPECT_CALL(callbacks2, onFailure());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  upstream_connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+
 TEST_F(RedisClientImplTest, Cancel) {
   InSequence s;
 
@@ -392,6 +428,133 @@ TEST_F(RedisConnPoolImplTest, Basic) {
   tls_.shutdownThread();
 };
 
+TEST_F(RedisConnPoolImplTest, BatchedRequests) {
+  InSequence s;
+
+  RespValue value1;
+  RespValue value2;
+  RespValue value3;
+  MockPoolRequest active_request1;
+  MockPoolRequest active_request2;
+  MockPoolCallbacks callbacks1;
+  MockPoolCallbacks callbacks2;
+  MockPoolCallbacks callbacks3;
+  MockClient* client = new NiceMock<MockClient>();
+
+  std::vector<RequestFragment> fragments;
+  fragments.emplace_back("foo", value1, callbacks1);
+  fragments.emplace_back("bar", value2, callbacks2);
+  fragments.emplace_back("baz", value3, callbacks3);
+
+  // "foo" and "bar" map to the same host, so they share one client and are pipelined in fragment
+  // order. "baz" has no upstream host and gets a null handle.
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_))
+      .WillOnce(Return(cm_.thread_local_cluster_.lb_.host_))
+      .WillOnce(Return(cm_.thread_local_cluster_.lb_.host_))
+      .WillOnce(Return(nullptr));
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(Ref(value1), Ref(callbacks1)))
+      .WillOnce(Return(&active_request1));
+  EXPECT_CALL(*client, makeRequest(Ref(value2), Ref(callbacks2)))
+      .WillOnce(Return(&active_request2));
+
+  std::vector<PoolRequest*> handles = conn_pool_->makeRequests(fragments);
+  ASSERT_EQ(3U, handles.size());
+  EXPECT_EQ(&active_request1, handles[0]);
+  EXPECT_EQ(&active_request2, handles[1]);
+  EXPECT_EQ(nullptr, handles[2]);
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+};
+
+TEST_F(RedisConnPoolImplTest, SlotOwnerRouting) {
+  InSequence s;
+
+  RespValue value;
+  MockPoolRequest active_request;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+
+  std::shared_ptr<Upstream::MockHost> host(new NiceMock<Upstream::MockHost>());
+  ON_CALL(*host, address())
+      .WillByDefault(Return(Network::Utility::resolveUrl("tcp://10.0.0.1:6379")));
+  cm_.thread_local_cluster_.cluster_.hosts_.push_back(host);
+
+  // Once a slot owner has been learned from a MOVED redirection, keys in that slot route
+  // straight to the owning host without consulting the load balancer.
+  conn_pool_->updateSlotOwner(Crc16::hashSlot("foo"), "10.0.0.1:6379");
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).Times(0);
+  EXPECT_CALL(*this, create_(Eq(host))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(Ref(value), Ref(callbacks))).WillOnce(Return(&active_request));
+  PoolRequest* request = conn_pool_->makeRequest("foo", value, callbacks);
+  EXPECT_EQ(&active_request, request);
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+};
+
+TEST_F(RedisConnPoolImplTest, SlotOwnerRevertsOnHostRemove) {
+  InSequence s;
+
+  RespValue value;
+  MockPoolCallbacks callbacks;
+
+  std::shared_ptr<Upstream::MockHost> host(new NiceMock<Upstream::MockHost>());
+  ON_CALL(*host, address())
+      .WillByDefault(Return(Network::Utility::resolveUrl("tcp://10.0.0.1:6379")));
+  cm_.thread_local_cluster_.cluster_.hosts_.push_back(host);
+
+  conn_pool_->updateSlotOwner(Crc16::hashSlot("foo"), "10.0.0.1:6379");
+
+  // Removing the owning host reverts its slots to load balancer routing.
+  cm_.thread_local_cluster_.cluster_.hosts_.clear();
+  cm_.thread_local_cluster_.cluster_.runCallbacks({}, {host});
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(nullptr));
+  EXPECT_EQ(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  tls_.shutdownThread();
+};
+
+TEST_F(RedisConnPoolImplTest, MakeRequestToHost) {
+  InSequence s;
+
+  RespValue value;
+  MockPoolRequest active_request;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+
+  std::shared_ptr<Upstream::MockHost> host(new NiceMock<Upstream::MockHost>());
+  ON_CALL(*host, address())
+      .WillByDefault(Return(Network::Utility::resolveUrl("tcp://10.0.0.1:6379")));
+  cm_.thread_local_cluster_.cluster_.hosts_.push_back(host);
+
+  // A redirection target that is not a cluster member yields a null handle.
+  EXPECT_EQ(nullptr, conn_pool_->makeRequestToHost("10.0.0.2:6379", value, callbacks, false));
+
+  EXPECT_CALL(*this, create_(Eq(host))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(Ref(value), Ref(callbacks))).WillOnce(Return(&active_request));
+  EXPECT_EQ(&active_request,
+            conn_pool_->makeRequestToHost("10.0.0.1:6379", value, callbacks, false));
+
+  // An ASK redirection sends ASKING ahead of the request on the same connection.
+  RespValue asking;
+  asking.type(RespType::Array);
+  asking.asArray().resize(1);
+  asking.asArray()[0].type(RespType::BulkString);
+  asking.asArray()[0].asString() = "asking";
+  MockPoolRequest active_request2;
+  EXPECT_CALL(*client, makeRequest(Eq(ByRef(asking)), _)).WillOnce(Return(nullptr));
+  EXPECT_CALL(*client, makeRequest(Ref(value), Ref(callbacks))).WillOnce(Return(&active_request2));
+  EXPECT_EQ(&active_request2,
+            conn_pool_->makeRequestToHost("10.0.0.1:6379", value, callbacks, true));
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+};
+
 TEST_F(RedisConnPoolImplTest, HostRemove) {
   InSequence s;
   MockPoolCallbacks callbacks;
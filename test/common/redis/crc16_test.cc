@@ -0,0 +1,37 @@
+#include <string>
+
+#include "common/redis/crc16.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Redis {
+
+TEST(Crc16Test, KnownVectors) {
+  EXPECT_EQ(0, Crc16::crc16("", 0));
+  EXPECT_EQ(0x31C3, Crc16::crc16("123456789", 9));
+}
+
+TEST(Crc16Test, HashSlotRange) {
+  EXPECT_LT(Crc16::hashSlot("foo"), Crc16::NumSlots);
+  EXPECT_LT(Crc16::hashSlot(""), Crc16::NumSlots);
+  EXPECT_LT(Crc16::hashSlot(std::string(1024, 'x')), Crc16::NumSlots);
+}
+
+TEST(Crc16Test, HashTag) {
+  // Keys that share a hash tag hash to the same slot as the tag contents alone.
+  EXPECT_EQ(Crc16::hashSlot("bar"), Crc16::hashSlot("foo{bar}baz"));
+  EXPECT_EQ(Crc16::hashSlot("{bar}"), Crc16::hashSlot("foo{bar}baz"));
+
+  // Only the first tag counts.
+  EXPECT_EQ(Crc16::hashSlot("bar"), Crc16::hashSlot("{bar}{zap}"));
+
+  // An empty tag means the whole key is hashed.
+  EXPECT_EQ(Crc16::hashSlot("foo{}{bar}"), Crc16::crc16("foo{}{bar}", 10) % Crc16::NumSlots);
+
+  // An unterminated tag also hashes the whole key.
+  EXPECT_EQ(Crc16::hashSlot("foo{bar"), Crc16::crc16("foo{bar", 7) % Crc16::NumSlots);
+}
+
+} // namespace Redis
+} // namespace Envoy
@@ -199,7 +199,7 @@ TEST(RouteMatcherTest, TestRoutes) {
         {"pattern": "^/rides$", "method": "POST", "name": "ride_request"},
         {"pattern": "^/rides/\\d+$", "method": "PUT", "name": "update_ride"},
         {"pattern": "^/users/\\d+/chargeaccounts$", "method": "POST", "name": "cc_add"},
-        {"pattern": "^/users/\\d+/chargeaccounts/(?!validate)\\w+$", "method": "PUT",
+        {"pattern": "^/users/\\d+/chargeaccounts/\\w*\\d\\w*$", "method": "PUT",
          "name": "cc_add"},
         {"pattern": "^/users$", "method": "POST", "name": "create_user_login"},
         {"pattern": "^/users/\\d+$", "method": "PUT", "name": "update_user"},
@@ -642,6 +642,92 @@ TEST(RouteMatcherTest, Priority) {
             config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)->routeEntry()->priority());
 }
 
+// Config order must win over trie candidate order when indexed (prefix/path) routes are mixed
+// with unindexed (regex/case insensitive) routes.
+TEST(RouteMatcherTest, ConfigOrderAcrossIndexedAndUnindexedRoutes) {
+  std::string json = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "regex": "/foo/.*/bar",
+          "cluster": "regex_first"
+        },
+        {
+          "prefix": "/foo",
+          "cluster": "prefix_second"
+        },
+        {
+          "path": "/foo/exact/bar",
+          "cluster": "exact_unreachable"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+
+  EXPECT_EQ("regex_first",
+            config.route(genHeaders("www.lyft.com", "/foo/exact/bar", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("prefix_second",
+            config.route(genHeaders("www.lyft.com", "/foo/baz", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  // The exact path route is shadowed by the earlier prefix route even though both are trie
+  // candidates for this path.
+  EXPECT_EQ("regex_first",
+            config.route(genHeaders("www.lyft.com", "/foo/exact/bar?x=1", "POST"), 0)
+                ->routeEntry()
+                ->clusterName());
+}
+
+// Prefix matching runs over the full :path including the query string, but the trie walk stops
+// at '?'. A prefix containing '?' must therefore match via the unindexed path.
+TEST(RouteMatcherTest, PrefixContainingQueryDelimiter) {
+  std::string json = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "prefix": "/api?debug=1",
+          "cluster": "debug_service"
+        },
+        {
+          "prefix": "/api",
+          "cluster": "api_service"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+
+  EXPECT_EQ("debug_service",
+            config.route(genHeaders("www.lyft.com", "/api?debug=1&verbose=1", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("api_service",
+            config.route(genHeaders("www.lyft.com", "/api?debug=0", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+}
+
 TEST(RouteMatcherTest, NoHostRewriteAndAutoRewrite) {
   std::string json = R"EOF(
 {
@@ -737,6 +823,14 @@ TEST(RouteMatcherTest, HeaderMatchedRouting) {
             {"name": "test_header_pattern", "value": "^customer=test-\\d+$"}
           ]
         },
+        {
+          "prefix": "/",
+          "cluster": "local_service_with_same_header_twice",
+          "headers" : [
+            {"name": "test_header_twice"},
+            {"name": "test_header_twice", "value": "^id=\\d+$", "regex": true}
+          ]
+        },
         {
           "prefix": "/",
           "cluster": "local_service_without_headers"
@@ -799,6 +893,21 @@ TEST(RouteMatcherTest, HeaderMatchedRouting) {
     EXPECT_EQ("local_service_without_headers",
               config.route(headers, 0)->routeEntry()->clusterName());
   }
+
+  // Multiple matchers that reference the same header must all pass.
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/", "GET");
+    headers.addCopy("test_header_twice", "id=1223");
+    EXPECT_EQ("local_service_with_same_header_twice",
+              config.route(headers, 0)->routeEntry()->clusterName());
+  }
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/", "GET");
+    headers.addCopy("test_header_twice", "id=bogus");
+    EXPECT_EQ("local_service_without_headers",
+              config.route(headers, 0)->routeEntry()->clusterName());
+  }
 }
 
 TEST(RouterMatcherTest, HashPolicy) {
@@ -905,6 +1014,81 @@ TEST(RouteMatcherTest, ClusterHeader) {
   }
 }
 
+TEST(RouteMatcherTest, ClusterHandleBinding) {
+  std::string json = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "prefix": "/foo",
+          "cluster": "some_cluster"
+        },
+        {
+          "prefix": "/bar",
+          "cluster_header": "some_header"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ON_CALL(cm, clusterHandle("some_cluster")).WillByDefault(Return(77));
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+
+  // Static cluster routes bind the interned handle at config load time.
+  Router::RouteConstSharedPtr route = config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0);
+  EXPECT_TRUE(route->routeEntry()->clusterHandle().valid());
+  EXPECT_EQ(77UL, route->routeEntry()->clusterHandle().value());
+
+  // Header selected clusters are only known per-request, so no handle can be bound.
+  Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/bar", "GET");
+  headers.addCopy("some_header", "some_cluster");
+  route = config.route(headers, 0);
+  EXPECT_FALSE(route->routeEntry()->clusterHandle().valid());
+}
+
+TEST(RouteMatcherTest, InternedStrings) {
+  std::string json = R"EOF(
+{
+  "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "prefix": "/foo",
+          "cluster": "some_cluster"
+        },
+        {
+          "prefix": "/bar",
+          "cluster": "some_cluster"
+        }
+      ]
+    }
+  ]
+}
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+
+  // Strings that repeat across route entries are interned in the config's pool: both routes hand
+  // back the exact same cluster name storage rather than per-entry copies.
+  const std::string& name1 =
+      config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)->routeEntry()->clusterName();
+  const std::string& name2 =
+      config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)->routeEntry()->clusterName();
+  EXPECT_EQ("some_cluster", name1);
+  EXPECT_EQ(&name1, &name2);
+}
+
 TEST(RouteMatcherTest, ContentType) {
   std::string json = R"EOF(
 {
@@ -1668,6 +1852,12 @@ TEST(RouteMatcherTest, WeightedClusters) {
     EXPECT_EQ("cluster1", config.route(headers, 115)->routeEntry()->clusterName());
     EXPECT_EQ("cluster2", config.route(headers, 445)->routeEntry()->clusterName());
     EXPECT_EQ("cluster3", config.route(headers, 560)->routeEntry()->clusterName());
+
+    // Boundaries of the lookup table compiled for fixed weights.
+    EXPECT_EQ("cluster1", config.route(headers, 0)->routeEntry()->clusterName());
+    EXPECT_EQ("cluster1", config.route(headers, 29)->routeEntry()->clusterName());
+    EXPECT_EQ("cluster2", config.route(headers, 30)->routeEntry()->clusterName());
+    EXPECT_EQ("cluster3", config.route(headers, 99)->routeEntry()->clusterName());
   }
 
   // Make sure weighted cluster entries call through to the parent when needed.
@@ -343,7 +343,9 @@ TEST_F(RdsImplTest, Basic) {
 
   EXPECT_EQ(2UL, store_.counter("foo.rds.config_reload").value());
   EXPECT_EQ(3UL, store_.counter("foo.rds.update_attempt").value());
-  EXPECT_EQ(3UL, store_.counter("foo.rds.update_success").value());
+  // The 2nd request delivered a byte for byte identical response which is not re-parsed, so only
+  // two updates were processed.
+  EXPECT_EQ(2UL, store_.counter("foo.rds.update_success").value());
 }
 
 TEST_F(RdsImplTest, Failure) {
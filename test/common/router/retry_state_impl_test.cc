@@ -28,8 +28,9 @@ public:
   }
 
   void setup(Http::HeaderMap& request_headers) {
-    state_ = RetryStateImpl::create(policy_, request_headers, cluster_, runtime_, random_,
-                                    dispatcher_, Upstream::ResourcePriority::Default);
+    state_ = RetryStateImpl::create(policy_, request_headers, cluster_, runtime_,
+                                    use_retry_handle_, random_, dispatcher_,
+                                    Upstream::ResourcePriority::Default);
   }
 
   void expectTimerCreateAndEnable() {
@@ -40,6 +41,10 @@ public:
   TestRetryPolicy policy_;
   NiceMock<Upstream::MockClusterInfo> cluster_;
   NiceMock<Runtime::MockLoader> runtime_;
+  // The default mock handle forwards to runtime_.snapshot_, so the featureEnabled() expectations
+  // in this file behave as if the production code still queried the snapshot directly.
+  Runtime::KeyHandleConstSharedPtr use_retry_handle_{
+      runtime_.registerKey("upstream.use_retry", 100)};
   NiceMock<Runtime::MockRandomGenerator> random_;
   Event::MockDispatcher dispatcher_;
   Event::MockTimer* retry_timer_{};
@@ -8,6 +8,7 @@
 #include "common/upstream/upstream_impl.h"
 
 #include "test/common/http/common.h"
+#include "test/mocks/buffer/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/router/mocks.h"
@@ -595,7 +596,10 @@ TEST_F(RouterTest, RetryUpstreamPerTryTimeout) {
         callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
         return nullptr;
       }));
-  expectPerTryTimerCreate();
+  // The retry reuses the timer from the first attempt rather than creating a new one: it is
+  // disabled when the retry is set up and re-enabled for the new attempt.
+  EXPECT_CALL(*per_try_timeout_, disableTimer());
+  EXPECT_CALL(*per_try_timeout_, enableTimer(_));
   router_.retry_state_->callback_();
 
   // Normal response.
@@ -880,29 +884,72 @@ TEST_F(RouterTest, Shadow) {
 
   EXPECT_CALL(runtime_.snapshot_, featureEnabled("bar", 0, 43, 10000)).WillOnce(Return(true));
 
+  // The shadow is started when headers arrive and fed incrementally; the request is not buffered
+  // on its behalf.
+  MockShadowStream* shadow_stream = new MockShadowStream();
+  EXPECT_CALL(*shadow_writer_, streamShadow_("foo", _, false, std::chrono::milliseconds(10)))
+      .WillOnce(Invoke([&](const std::string&, Http::HeaderMapPtr& headers, bool,
+                           std::chrono::milliseconds) -> ShadowStream* {
+        EXPECT_NE(nullptr, headers->Host());
+        return shadow_stream;
+      }));
+
   Http::TestHeaderMapImpl headers;
   HttpTestUtility::addDefaultHeaders(headers);
   router_.decodeHeaders(headers, false);
 
   Buffer::InstancePtr body_data(new Buffer::OwnedImpl("hello"));
-  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, router_.decodeData(*body_data, false));
+  EXPECT_CALL(*shadow_stream, writeData(BufferStringEqual("hello"), false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, router_.decodeData(*body_data, false));
 
   Http::TestHeaderMapImpl trailers{{"some", "trailer"}};
-  EXPECT_CALL(callbacks_, decodingBuffer())
-      .Times(AtLeast(1))
-      .WillRepeatedly(Return(body_data.get()));
-  EXPECT_CALL(*shadow_writer_, shadow_("foo", _, std::chrono::milliseconds(10)))
-      .WillOnce(Invoke(
-          [](const std::string&, Http::MessagePtr& request, std::chrono::milliseconds) -> void {
-            EXPECT_NE(nullptr, request->body());
-            EXPECT_NE(nullptr, request->trailers());
-          }));
+  EXPECT_CALL(*shadow_stream, writeTrailers(HeaderMapEqualRef(&trailers)));
   router_.decodeTrailers(trailers);
 
   Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
   response_decoder->decodeHeaders(std::move(response_headers), true);
 }
 
+TEST_F(RouterTest, ShadowCancelledPastBufferLimit) {
+  EXPECT_CALL(callbacks_, decoderBufferLimit()).WillOnce(Return(10));
+  router_.setDecoderFilterCallbacks(callbacks_);
+  callbacks_.route_->route_entry_.shadow_policy_.cluster_ = "foo";
+  callbacks_.route_->route_entry_.shadow_policy_.runtime_key_ = "bar";
+  ON_CALL(callbacks_, streamId()).WillByDefault(Return(43));
+
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("bar", 0, 43, 10000)).WillOnce(Return(true));
+
+  MockShadowStream* shadow_stream = new MockShadowStream();
+  EXPECT_CALL(*shadow_writer_, streamShadow_("foo", _, false, std::chrono::milliseconds(10)))
+      .WillOnce(Return(shadow_stream));
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, false);
+
+  // A body larger than the buffer limit cancels the shadow rather than buffering the primary.
+  Buffer::InstancePtr body_data(new Buffer::OwnedImpl("0123456789!"));
+  EXPECT_CALL(*shadow_stream, writeData(_, _)).Times(0);
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, router_.decodeData(*body_data, true));
+  EXPECT_EQ(1U, cm_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .counter("retry_or_shadow_abandoned")
+                    .value());
+
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+}
+
 TEST_F(RouterTest, AltStatName) {
   // Also test no upstream timeout here.
   EXPECT_CALL(callbacks_.route_->route_entry_, timeout())
@@ -1,11 +1,15 @@
 #include <chrono>
 #include <string>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/router/shadow_writer_impl.h"
 
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/http/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -59,5 +63,82 @@ TEST(ShadowWriterImplTest, All) {
   callback->onFailure(Http::AsyncClient::FailureReason::Reset);
 }
 
+class StreamingShadowTest : public testing::Test {
+public:
+  ShadowStreamPtr startShadow(bool end_stream) {
+    EXPECT_CALL(cm_, httpAsyncClientForCluster("foo")).WillOnce(ReturnRef(cm_.async_client_));
+    EXPECT_CALL(cm_.async_client_,
+                start(_, Optional<std::chrono::milliseconds>(std::chrono::milliseconds(5))))
+        .WillOnce(Invoke([&](Http::AsyncClient::StreamCallbacks& callbacks,
+                             const Optional<std::chrono::milliseconds>&)
+                             -> Http::AsyncClient::Stream* {
+          callbacks_ = &callbacks;
+          return &stream_;
+        }));
+    EXPECT_CALL(stream_, sendHeaders(_, end_stream))
+        .WillOnce(Invoke([](Http::HeaderMap& headers, bool) -> void {
+          EXPECT_STREQ("cluster1-shadow", headers.Host()->value().c_str());
+        }));
+
+    Http::HeaderMapPtr headers(new Http::TestHeaderMapImpl{{":authority", "cluster1"}});
+    return writer_.streamShadow("foo", std::move(headers), end_stream,
+                                std::chrono::milliseconds(5));
+  }
+
+  Upstream::MockClusterManager cm_;
+  ShadowWriterImpl writer_{cm_};
+  Http::MockAsyncClientStream stream_;
+  Http::AsyncClient::StreamCallbacks* callbacks_{};
+};
+
+TEST_F(StreamingShadowTest, StreamedBodyAndTrailers) {
+  ShadowStreamPtr shadow_stream = startShadow(false);
+  EXPECT_NE(nullptr, shadow_stream);
+
+  // Body data is copied and not consumed from the caller's buffer.
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(stream_, sendData(BufferStringEqual("hello"), false));
+  shadow_stream->writeData(data, false);
+  EXPECT_EQ(5UL, data.length());
+
+  Http::TestHeaderMapImpl trailers{{"some", "trailer"}};
+  EXPECT_CALL(stream_, sendTrailers(_))
+      .WillOnce(Invoke([](Http::HeaderMap& inner_trailers) -> void {
+        EXPECT_STREQ("trailer", inner_trailers.get(Http::LowerCaseString("some"))->value().c_str());
+      }));
+  shadow_stream->writeTrailers(trailers);
+
+  // The response completes and the handle outlives it harmlessly; the stream is not reset.
+  EXPECT_CALL(stream_, reset()).Times(0);
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  callbacks_->onHeaders(std::move(response_headers), true);
+  shadow_stream.reset();
+}
+
+TEST_F(StreamingShadowTest, CancelledByHandleDestruction) {
+  ShadowStreamPtr shadow_stream = startShadow(false);
+  EXPECT_NE(nullptr, shadow_stream);
+
+  // Destroying the handle before the request has been fully written cancels the shadow.
+  EXPECT_CALL(stream_, reset()).WillOnce(Invoke([&]() -> void { callbacks_->onReset(); }));
+  shadow_stream.reset();
+}
+
+TEST_F(StreamingShadowTest, ResponseCompletesBeforeRequest) {
+  ShadowStreamPtr shadow_stream = startShadow(false);
+  EXPECT_NE(nullptr, shadow_stream);
+
+  // The shadow response completes before the request has finished streaming. The next write
+  // tears the stream down instead of sending more data.
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  callbacks_->onHeaders(std::move(response_headers), true);
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(stream_, sendData(_, _)).Times(0);
+  EXPECT_CALL(stream_, reset()).WillOnce(Invoke([&]() -> void { callbacks_->onReset(); }));
+  shadow_stream->writeData(data, false);
+  shadow_stream.reset();
+}
+
 } // namespace Router
 } // namespace Envoy
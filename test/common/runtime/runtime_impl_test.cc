@@ -1,3 +1,4 @@
+#include <fstream>
 #include <memory>
 #include <string>
 
@@ -16,6 +17,8 @@
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnNew;
+using testing::SaveArg;
+using testing::_;
 
 namespace Envoy {
 namespace Runtime {
@@ -77,6 +80,13 @@ TEST_F(RuntimeImplTest, All) {
   EXPECT_EQ(2UL, loader->snapshot().getInteger("file3", 1));
   EXPECT_EQ(123UL, loader->snapshot().getInteger("file4", 1));
 
+  // Prefix existence.
+  EXPECT_TRUE(loader->snapshot().keysWithPrefixExist("file"));
+  EXPECT_TRUE(loader->snapshot().keysWithPrefixExist("subdir."));
+  EXPECT_TRUE(loader->snapshot().keysWithPrefixExist(""));
+  EXPECT_FALSE(loader->snapshot().keysWithPrefixExist("fault.http."));
+  EXPECT_FALSE(loader->snapshot().keysWithPrefixExist("subdir.file3.more"));
+
   // Feature enablement.
   EXPECT_CALL(generator, random()).WillOnce(Return(1));
   EXPECT_TRUE(loader->snapshot().featureEnabled("file3", 1));
@@ -98,19 +108,110 @@ TEST_F(RuntimeImplTest, All) {
 
 TEST_F(RuntimeImplTest, BadDirectory) { setup("/baddir", "/baddir"); }
 
+TEST_F(RuntimeImplTest, MergeValues) {
+  setup("test/common/runtime/test_data/current", "envoy_override");
+
+  // An override shadows the disk value and parses as an integer where possible.
+  loader->mergeValues({{"file2", "new world"}, {"file3", "100"}});
+  EXPECT_EQ("new world", loader->snapshot().get("file2"));
+  EXPECT_EQ(100UL, loader->snapshot().getInteger("file3", 1));
+  EXPECT_EQ(2UL, store.gauge("runtime.admin_overrides_active").value());
+
+  // Overrides can introduce keys that have no disk backing at all.
+  loader->mergeValues({{"dynamic_key", "dynamic"}});
+  EXPECT_EQ("dynamic", loader->snapshot().get("dynamic_key"));
+  EXPECT_TRUE(loader->snapshot().keysWithPrefixExist("dynamic_"));
+
+  // An empty value removes the override so the disk value shows through again.
+  loader->mergeValues({{"file2", ""}, {"dynamic_key", ""}});
+  EXPECT_EQ("world", loader->snapshot().get("file2"));
+  EXPECT_EQ("", loader->snapshot().get("dynamic_key"));
+  EXPECT_EQ(1UL, store.gauge("runtime.admin_overrides_active").value());
+}
+
 TEST_F(RuntimeImplTest, OverrideFolderDoesNotExist) {
   setup("test/common/runtime/test_data/current", "envoy_override_does_not_exist");
 
   EXPECT_EQ("hello", loader->snapshot().get("file1"));
 }
 
+TEST_F(RuntimeImplTest, IncrementalReload) {
+  Filesystem::Watcher::OnChangedCb watch_cb;
+  Filesystem::MockWatcher* watcher = new NiceMock<Filesystem::MockWatcher>();
+  EXPECT_CALL(dispatcher, createFilesystemWatcher_()).WillOnce(Return(watcher));
+  EXPECT_CALL(*watcher, addWatch(_, Filesystem::Watcher::Events::MovedTo, _))
+      .WillOnce(SaveArg<2>(&watch_cb));
+  loader.reset(new LoaderImpl(
+      dispatcher, tls, TestEnvironment::temporaryPath("test/common/runtime/test_data/current"),
+      "envoy", "envoy_override", store, generator));
+
+  EXPECT_EQ("world", loader->snapshot().get("file2"));
+
+  // Change one file and reload. The changed file must be re-read while entries for unchanged
+  // files are reused from the previous load.
+  const std::string file2_path =
+      TestEnvironment::temporaryPath("test/common/runtime/test_data/root/envoy/file2");
+  {
+    std::ofstream file(file2_path);
+    file << "goodbye";
+  }
+  watch_cb(Filesystem::Watcher::Events::MovedTo);
+  EXPECT_EQ("goodbye", loader->snapshot().get("file2"));
+  EXPECT_EQ("hello\nworld", loader->snapshot().get("subdir.file3"));
+  EXPECT_EQ("hello override", loader->snapshot().get("file1"));
+  EXPECT_EQ(2UL, store.counter("runtime.load_success").value());
+
+  // Restore the original contents for any tests that run after this one.
+  {
+    std::ofstream file(file2_path);
+    file << "world\n";
+  }
+}
+
+TEST_F(RuntimeImplTest, KeyHandles) {
+  setup("test/common/runtime/test_data/current", "envoy_override");
+
+  // A handle resolves against the current snapshot at registration time.
+  KeyHandleConstSharedPtr file3 = loader->registerKey("file3", 1);
+  EXPECT_EQ(2UL, file3->getInteger());
+
+  // Missing keys report the registered default.
+  KeyHandleConstSharedPtr missing = loader->registerKey("invalid", 5);
+  EXPECT_EQ(5UL, missing->getInteger());
+
+  // featureEnabled() behaves like the snapshot variant, including skipping the PRNG when the
+  // cutoff makes the answer certain.
+  EXPECT_CALL(generator, random()).WillOnce(Return(1));
+  EXPECT_TRUE(file3->featureEnabled());
+  EXPECT_CALL(generator, random()).WillOnce(Return(2));
+  EXPECT_FALSE(file3->featureEnabled());
+
+  // Loading a new snapshot re-resolves every live handle.
+  loader->mergeValues({{"file3", "100"}});
+  EXPECT_EQ(100UL, file3->getInteger());
+  EXPECT_TRUE(file3->featureEnabled());
+
+  // A released handle must not be touched by later reloads.
+  missing.reset();
+  loader->mergeValues({{"file3", ""}});
+  EXPECT_EQ(2UL, file3->getInteger());
+}
+
 TEST(NullRuntimeImplTest, All) {
   MockRandomGenerator generator;
   NullLoaderImpl loader(generator);
   EXPECT_EQ("", loader.snapshot().get("foo"));
+  EXPECT_FALSE(loader.snapshot().keysWithPrefixExist("foo"));
   EXPECT_EQ(1UL, loader.snapshot().getInteger("foo", 1));
   EXPECT_CALL(generator, random()).WillOnce(Return(49));
   EXPECT_TRUE(loader.snapshot().featureEnabled("foo", 50));
+
+  // Handles from the null loader just report their registered default.
+  KeyHandleConstSharedPtr handle = loader.registerKey("foo", 50);
+  EXPECT_EQ(50UL, handle->getInteger());
+  EXPECT_CALL(generator, random()).WillOnce(Return(49));
+  EXPECT_TRUE(handle->featureEnabled());
+  EXPECT_FALSE(loader.registerKey("bar", 0)->featureEnabled());
 }
 
 } // namespace Runtime
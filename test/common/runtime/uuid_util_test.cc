@@ -19,6 +19,8 @@ TEST(UUIDUtilsTest, mod) {
 
   EXPECT_FALSE(UuidUtils::uuidModBy("", result, 100));
 
+  EXPECT_FALSE(UuidUtils::uuidModBy("000000zz-0000-0000-0000-000000000000", result, 100));
+
   EXPECT_TRUE(UuidUtils::uuidModBy("000000ff-0000-0000-0000-000000000000", result, 100));
   EXPECT_EQ(55, result);
 
@@ -28,6 +28,7 @@
 #include "openssl/ssl.h"
 
 using testing::Invoke;
+using testing::Return;
 using testing::StrictMock;
 using testing::_;
 
@@ -379,6 +380,218 @@ TEST_P(SslConnectionImplTest, ClientAuthMultipleCAs) {
   EXPECT_EQ(1UL, stats_store.counter("ssl.handshake").value());
 }
 
+TEST_P(SslConnectionImplTest, SniContextSelection) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+
+  std::string default_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_rundir }}/test/common/ssl/test_data/no_san_cert.pem",
+    "private_key_file": "{{ test_rundir }}/test/common/ssl/test_data/no_san_key.pem"
+  }
+  )EOF";
+
+  std::string sni_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_rundir }}/test/common/ssl/test_data/san_uri_cert.pem",
+    "private_key_file": "{{ test_rundir }}/test/common/ssl/test_data/san_uri_key.pem"
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr default_ctx_loader = TestEnvironment::jsonLoadFromString(default_ctx_json);
+  ServerContextConfigImpl default_ctx_config(*default_ctx_loader);
+  ContextManagerImpl manager(runtime);
+  ServerContextPtr server_ctx(manager.createSslServerContext(stats_store, default_ctx_config));
+
+  Json::ObjectSharedPtr sni_ctx_loader = TestEnvironment::jsonLoadFromString(sni_ctx_json);
+  ServerContextConfigImpl sni_ctx_config(*sni_ctx_loader);
+  ServerContextPtr sni_ctx(manager.createSslServerContext(stats_store, sni_ctx_config));
+
+  // A wildcard registration exercises the exact lookup falling through to the wildcard form.
+  server_ctx->addSniContext("*.example.com", *sni_ctx);
+
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), true);
+  Network::MockListenerCallbacks callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener =
+      dispatcher.createSslListener(connection_handler, *server_ctx, socket, callbacks, stats_store,
+                                   Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  std::string client_ctx_json = R"EOF(
+  {
+    "sni": "server1.example.com"
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString(client_ctx_json);
+  ClientContextConfigImpl client_ctx_config(*client_ctx_loader);
+  ClientContextPtr client_ctx(manager.createSslClientContext(stats_store, client_ctx_config));
+  Network::ClientConnectionPtr client_connection = dispatcher.createSslClientConnection(
+      *client_ctx, socket.localAddress(), Network::Address::InstanceConstSharedPtr());
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  Network::ConnectionPtr server_connection;
+  EXPECT_CALL(callbacks, onNewConnection_(_))
+      .WillOnce(Invoke(
+          [&](Network::ConnectionPtr& conn) -> void { server_connection = std::move(conn); }));
+
+  // The certificate presented to the client must come from the SNI selected context, not the
+  // default context whose certificate carries no SAN.
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        EXPECT_EQ("spiffe://lyft.com/test-team",
+                  client_connection->ssl()->uriSanPeerCertificate());
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher.exit();
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+}
+
+TEST_P(SslConnectionImplTest, SessionResumption) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr server_ctx_loader = TestEnvironment::jsonLoadFromString(server_ctx_json);
+  ServerContextConfigImpl server_ctx_config(*server_ctx_loader);
+  ContextManagerImpl manager(runtime);
+  ServerContextPtr server_ctx(manager.createSslServerContext(stats_store, server_ctx_config));
+
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), true);
+  Network::MockListenerCallbacks callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener =
+      dispatcher.createSslListener(connection_handler, *server_ctx, socket, callbacks, stats_store,
+                                   Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  std::string client_ctx_json = "{}";
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString(client_ctx_json);
+  ClientContextConfigImpl client_ctx_config(*client_ctx_loader);
+  ClientContextPtr client_ctx(manager.createSslClientContext(stats_store, client_ctx_config));
+
+  // Connect twice with the same client context. The second handshake resumes the session that the
+  // context cached during the first one.
+  for (int i = 0; i < 2; i++) {
+    Network::ClientConnectionPtr client_connection = dispatcher.createSslClientConnection(
+        *client_ctx, socket.localAddress(), Network::Address::InstanceConstSharedPtr());
+    Network::MockConnectionCallbacks client_connection_callbacks;
+    client_connection->addConnectionCallbacks(client_connection_callbacks);
+    client_connection->connect();
+
+    Network::ConnectionPtr server_connection;
+    Network::MockConnectionCallbacks server_connection_callbacks;
+    EXPECT_CALL(callbacks, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          server_connection = std::move(conn);
+          server_connection->addConnectionCallbacks(server_connection_callbacks);
+        }));
+
+    // Wait for the handshake to complete on both ends before tearing down so that both sides
+    // count their handshakes deterministically.
+    size_t connected_events = 0;
+    auto on_connected = [&](Network::ConnectionEvent) -> void {
+      if (++connected_events == 2) {
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        server_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher.exit();
+      }
+    };
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke(on_connected));
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke(on_connected));
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+    dispatcher.run(Event::Dispatcher::RunType::Block);
+  }
+
+  // The client and server contexts share the stats store, so each resumed handshake counts once
+  // per side.
+  EXPECT_EQ(4UL, stats_store.counter("ssl.handshake").value());
+  EXPECT_EQ(2UL, stats_store.counter("ssl.session_reused").value());
+}
+
+TEST_P(SslConnectionImplTest, HandshakeOffload) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+  ON_CALL(runtime.snapshot_, featureEnabled("ssl.handshake_offload", 0)).WillByDefault(Return(true));
+
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr server_ctx_loader = TestEnvironment::jsonLoadFromString(server_ctx_json);
+  ServerContextConfigImpl server_ctx_config(*server_ctx_loader);
+  ContextManagerImpl manager(runtime);
+  ServerContextPtr server_ctx(manager.createSslServerContext(stats_store, server_ctx_config));
+
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), true);
+  Network::MockListenerCallbacks callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener =
+      dispatcher.createSslListener(connection_handler, *server_ctx, socket, callbacks, stats_store,
+                                   Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  std::string client_ctx_json = "{}";
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString(client_ctx_json);
+  ClientContextConfigImpl client_ctx_config(*client_ctx_loader);
+  ClientContextPtr client_ctx(manager.createSslClientContext(stats_store, client_ctx_config));
+  Network::ClientConnectionPtr client_connection = dispatcher.createSslClientConnection(
+      *client_ctx, socket.localAddress(), Network::Address::InstanceConstSharedPtr());
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  // Wait for the handshake to complete on both ends so that the offload completion path has run
+  // fully before tearing down.
+  size_t connected_events = 0;
+  auto on_connected = [&](Network::ConnectionEvent) -> void {
+    if (++connected_events == 2) {
+      client_connection->close(Network::ConnectionCloseType::NoFlush);
+      server_connection->close(Network::ConnectionCloseType::NoFlush);
+      dispatcher.exit();
+    }
+  };
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke(on_connected));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke(on_connected));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+
+  // The client and server contexts share the stats store, so a single successful handshake counts
+  // once per side.
+  EXPECT_EQ(2UL, stats_store.counter("ssl.handshake").value());
+  EXPECT_EQ(0UL, stats_store.counter("ssl.connection_error").value());
+}
+
 TEST_P(SslConnectionImplTest, SslError) {
   Stats::IsolatedStoreImpl stats_store;
   Runtime::MockLoader runtime;
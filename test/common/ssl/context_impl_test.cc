@@ -30,6 +30,27 @@ TEST_F(SslContextImplTest, TestdNSNameMatching) {
   EXPECT_FALSE(ContextImpl::dNSNameMatch("lyft.com", ""));
 }
 
+TEST_F(SslContextImplTest, TestParseTicketKeys) {
+  EXPECT_TRUE(ServerContextImpl::parseTicketKeys("").empty());
+  EXPECT_TRUE(ServerContextImpl::parseTicketKeys("not-hex").empty());
+  // 79 bytes is too short; malformed entries are skipped.
+  EXPECT_TRUE(ServerContextImpl::parseTicketKeys(std::string(158, 'a')).empty());
+
+  const std::string hmac_hex(64, 'b');
+  const std::string aes_hex(64, 'c');
+  const std::string primary = std::string(32, 'a') + hmac_hex + aes_hex;
+  const std::string secondary = std::string(32, 'd') + hmac_hex + aes_hex;
+
+  std::vector<ServerContextImpl::SessionTicketKey> keys =
+      ServerContextImpl::parseTicketKeys(primary + ",bogus," + secondary);
+  ASSERT_EQ(2UL, keys.size());
+  EXPECT_EQ(0, memcmp(keys[0].name_, std::string(16, '\xaa').data(), sizeof(keys[0].name_)));
+  EXPECT_EQ(0,
+            memcmp(keys[0].hmac_key_, std::string(32, '\xbb').data(), sizeof(keys[0].hmac_key_)));
+  EXPECT_EQ(0, memcmp(keys[0].aes_key_, std::string(32, '\xcc').data(), sizeof(keys[0].aes_key_)));
+  EXPECT_EQ(0, memcmp(keys[1].name_, std::string(16, '\xdd').data(), sizeof(keys[1].name_)));
+}
+
 TEST_F(SslContextImplTest, TestVerifySubjectAltNameDNSMatched) {
   FILE* fp = fopen(
       TestEnvironment::runfilesPath("test/common/ssl/test_data/san_dns_cert.pem").c_str(), "r");
@@ -56,6 +77,28 @@ TEST_F(SslContextImplTest, TestVerifySubjectAltNameURIMatched) {
   fclose(fp);
 }
 
+TEST_F(SslContextImplTest, TestUriSanAndSubjectFromCertificate) {
+  FILE* fp = fopen(
+      TestEnvironment::runfilesPath("test/common/ssl/test_data/san_uri_cert.pem").c_str(), "r");
+  EXPECT_NE(fp, nullptr);
+  X509* cert = PEM_read_X509(fp, nullptr, nullptr, nullptr);
+  EXPECT_NE(cert, nullptr);
+  EXPECT_EQ("spiffe://lyft.com/test-team", ContextImpl::uriSanFromCertificate(cert));
+  EXPECT_NE("", ContextImpl::subjectFromCertificate(cert));
+  X509_free(cert);
+  fclose(fp);
+
+  // A certificate with only DNS SANs has no URI SAN.
+  fp = fopen(
+      TestEnvironment::runfilesPath("test/common/ssl/test_data/san_dns_cert.pem").c_str(), "r");
+  EXPECT_NE(fp, nullptr);
+  cert = PEM_read_X509(fp, nullptr, nullptr, nullptr);
+  EXPECT_NE(cert, nullptr);
+  EXPECT_EQ("", ContextImpl::uriSanFromCertificate(cert));
+  X509_free(cert);
+  fclose(fp);
+}
+
 TEST_F(SslContextImplTest, TestVerifySubjectAltNameNotMatched) {
   FILE* fp = fopen(
       TestEnvironment::runfilesPath("test/common/ssl/test_data/san_dns_cert.pem").c_str(), "r");
@@ -36,6 +36,81 @@ TEST(StatsIsolatedStoreImplTest, All) {
 
   EXPECT_EQ(3UL, store.counters().size());
   EXPECT_EQ(2UL, store.gauges().size());
+  EXPECT_EQ(0UL, store.histograms().size());
+}
+
+TEST(HistogramImplTest, Empty) {
+  HistogramImpl histogram("h");
+  EXPECT_EQ("h", histogram.name());
+  EXPECT_EQ("no values recorded", histogram.summary());
+}
+
+TEST(HistogramImplTest, Summary) {
+  HistogramImpl histogram("h");
+  for (uint64_t i = 1; i <= 100; i++) {
+    histogram.recordValue(i);
+  }
+
+  // Values 1-99 land in exact (0-9) or log linear decade buckets, so P50/P90 resolve to their
+  // bucket lower bounds.
+  EXPECT_EQ("count=100 mean=50.5 P50=50 P90=90 P95=90 P99=90 P100=100", histogram.summary());
+}
+
+TEST(HeapSymbolTableTest, InternAndResolve) {
+  HeapSymbolTable table;
+  const SymbolTable::Symbol foo = table.intern("foo");
+  const SymbolTable::Symbol bar = table.intern("bar");
+  EXPECT_NE(0U, foo);
+  EXPECT_NE(0U, bar);
+  EXPECT_NE(foo, bar);
+  EXPECT_EQ(foo, table.intern("foo"));
+  EXPECT_EQ(foo, table.find("foo"));
+  EXPECT_EQ(0U, table.find("unknown"));
+  EXPECT_EQ("foo", table.segment(foo));
+  EXPECT_EQ("bar", table.segment(bar));
+}
+
+TEST(RawStatDataTest, SymbolizedNames) {
+  HeapSymbolTable table;
+  RawStatData data;
+  memset(&data, 0, sizeof(RawStatData));
+  EXPECT_FALSE(data.initialized());
+
+  EXPECT_TRUE(data.initialize("cluster.foo.upstream_rq_total", table));
+  EXPECT_TRUE(data.initialized());
+  EXPECT_EQ("cluster.foo.upstream_rq_total", data.name(table));
+  EXPECT_TRUE(data.matches("cluster.foo.upstream_rq_total", table));
+  EXPECT_FALSE(data.matches("cluster.foo.upstream_rq_time", table));
+  EXPECT_FALSE(data.matches("cluster.foo", table));
+
+  // Shared segments resolve to the same symbols across stats.
+  RawStatData other;
+  memset(&other, 0, sizeof(RawStatData));
+  other.initialize("cluster.foo.upstream_rq_time", table);
+  EXPECT_EQ(data.symbols_[0], other.symbols_[0]);
+  EXPECT_EQ(data.symbols_[1], other.symbols_[1]);
+  EXPECT_NE(data.symbols_[2], other.symbols_[2]);
+}
+
+TEST(RawStatDataTest, InternFailureLeavesSlotReusable) {
+  // A table that cannot intern anything, as when the shared memory symbol table is full or a
+  // segment is too long for it.
+  class FullSymbolTable : public SymbolTable {
+  public:
+    Symbol intern(const std::string&) override { return 0; }
+    Symbol find(const std::string&) const override { return 0; }
+    std::string segment(Symbol) const override { return ""; }
+  };
+
+  FullSymbolTable table;
+  RawStatData data;
+  memset(&data, 0, sizeof(RawStatData));
+  EXPECT_FALSE(data.initialize("cluster.foo.upstream_rq_total", table));
+
+  // The failure rolled the object back so the allocator can return the slot to its free list
+  // and degrade to the heap allocator instead of aborting.
+  EXPECT_FALSE(data.initialized());
+  EXPECT_EQ(0, data.ref_count_.load());
 }
 
 } // namespace Stats
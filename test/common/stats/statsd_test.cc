@@ -7,8 +7,10 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 
@@ -19,6 +21,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::_;
 
 namespace Envoy {
@@ -28,9 +31,11 @@ namespace Statsd {
 class TcpStatsdSinkTest : public testing::Test {
 public:
   TcpStatsdSinkTest() {
+    ON_CALL(time_source_, currentTime()).WillByDefault(ReturnPointee(&time_));
     sink_.reset(
         new TcpStatsdSink(local_info_, "fake_cluster", tls_, cluster_manager_,
-                          cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_));
+                          cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_,
+                          random_, time_source_));
   }
 
   void expectCreateConnection() {
@@ -51,6 +56,9 @@ public:
   std::unique_ptr<TcpStatsdSink> sink_;
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
   Network::MockClientConnection* connection_{};
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  MonotonicTime time_;
 };
 
 TEST_F(TcpStatsdSinkTest, EmptyFlush) {
@@ -74,8 +82,9 @@ TEST_F(TcpStatsdSinkTest, BasicFlow) {
               write(BufferStringEqual("envoy.test_counter:1|c\nenvoy.test_gauge:2|g\n")));
   sink_->endFlush();
 
-  // Test a disconnect. We should connect again.
+  // Test a disconnect. We should connect again once the reconnect backoff has passed.
   connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  time_ += std::chrono::seconds(1);
 
   expectCreateConnection();
   EXPECT_CALL(*connection_, write(BufferStringEqual("envoy.test_timer:5|ms\n")));
@@ -140,6 +149,38 @@ TEST_F(TcpStatsdSinkTest, Overflow) {
   tls_.shutdownThread();
 }
 
+TEST_F(TcpStatsdSinkTest, ReconnectBackoff) {
+  InSequence s;
+
+  sink_->beginFlush();
+  sink_->flushCounter("test_counter", 1);
+  expectCreateConnection();
+  EXPECT_CALL(*connection_, write(BufferStringEqual("envoy.test_counter:1|c\n")));
+  sink_->endFlush();
+
+  connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+
+  // A flush inside the backoff window must not reconnect; the payload is dropped and counted.
+  EXPECT_CALL(cluster_manager_, tcpConnForCluster_(_, _)).Times(0);
+  sink_->beginFlush();
+  sink_->flushCounter("test_counter", 2);
+  sink_->endFlush();
+  EXPECT_EQ(1UL, cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
+                     .counter("statsd.backoff_drop")
+                     .value());
+
+  // Once the backoff has expired the sink connects and flushes normally again.
+  time_ += std::chrono::seconds(31);
+  sink_->beginFlush();
+  sink_->flushCounter("test_counter", 3);
+  expectCreateConnection();
+  EXPECT_CALL(*connection_, write(BufferStringEqual("envoy.test_counter:3|c\n")));
+  sink_->endFlush();
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::NoFlush));
+  tls_.shutdownThread();
+}
+
 } // namespace Statsd
 } // namespace Stats
 } // namespace Envoy
@@ -17,6 +17,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::SaveArg;
 using testing::_;
 
 namespace Envoy {
@@ -35,7 +36,7 @@ public:
     if (!stat_ref) {
       stat_ref.reset(new RawStatData());
       memset(stat_ref.get(), 0, sizeof(RawStatData));
-      stat_ref->initialize(name);
+      stat_ref->initialize(name, symbol_table_);
     } else {
       stat_ref->ref_count_++;
     }
@@ -58,7 +59,10 @@ public:
     FAIL();
   }
 
+  SymbolTable& symbolTable() override { return symbol_table_; }
+
 private:
+  HeapSymbolTable symbol_table_;
   std::unordered_map<std::string, std::unique_ptr<RawStatData>> stats_;
 };
 
@@ -80,6 +84,7 @@ public:
 
   MOCK_METHOD1(alloc, RawStatData*(const std::string& name));
   MOCK_METHOD1(free, void(RawStatData& data));
+  SymbolTable& symbolTable() override { return alloc_.symbolTable(); }
 
   NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
   NiceMock<ThreadLocal::MockInstance> tls_;
@@ -135,9 +140,16 @@ TEST_F(StatsThreadLocalStoreTest, Tls) {
   Timer& t1 = store_->timer("t1");
   EXPECT_EQ(&t1, &store_->timer("t1"));
 
+  // With TLS initialized the returned counter is this thread's shard of the backing counter.
+  // Increments land on the shard and become visible centrally when counters() folds them in.
+  c1.inc();
+  EXPECT_EQ(1UL, c1.value());
+
   EXPECT_EQ(2UL, store_->counters().size());
-  EXPECT_EQ(&c1, store_->counters().front().get());
-  EXPECT_EQ(3L, store_->counters().front().use_count());
+  CounterSharedPtr central = TestUtility::findCounter(*store_, "c1");
+  EXPECT_NE(&c1, central.get());
+  EXPECT_EQ(1UL, central->value());
+  EXPECT_EQ(3L, central.use_count());
   EXPECT_EQ(1UL, store_->gauges().size());
   EXPECT_EQ(&g1, store_->gauges().front().get());
   EXPECT_EQ(3L, store_->gauges().front().use_count());
@@ -145,9 +157,11 @@ TEST_F(StatsThreadLocalStoreTest, Tls) {
   store_->shutdownThreading();
   tls_.shutdownThread();
 
+  // Shard teardown drops its reference to the backing counter without losing the count.
   EXPECT_EQ(2UL, store_->counters().size());
-  EXPECT_EQ(&c1, store_->counters().front().get());
-  EXPECT_EQ(2L, store_->counters().front().use_count());
+  central = TestUtility::findCounter(*store_, "c1");
+  EXPECT_EQ(1UL, central->value());
+  EXPECT_EQ(2L, central.use_count());
   EXPECT_EQ(1UL, store_->gauges().size());
   EXPECT_EQ(&g1, store_->gauges().front().get());
   EXPECT_EQ(2L, store_->gauges().front().use_count());
@@ -156,6 +170,38 @@ TEST_F(StatsThreadLocalStoreTest, Tls) {
   EXPECT_CALL(*this, free(_)).Times(3);
 }
 
+TEST_F(StatsThreadLocalStoreTest, Histograms) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  // Timings and histogram deliveries are recorded into local histograms in addition to being
+  // forwarded to the sinks.
+  EXPECT_CALL(sink_, onTimespanComplete("t1", std::chrono::milliseconds(5)));
+  store_->deliverTimingToSinks("t1", std::chrono::milliseconds(5));
+
+  EXPECT_CALL(sink_, onHistogramComplete("h1", 100)).Times(2);
+  store_->deliverHistogramToSinks("h1", 100);
+  store_->deliverHistogramToSinks("h1", 100);
+
+  std::list<HistogramSharedPtr> histograms = store_->histograms();
+  EXPECT_EQ(2UL, histograms.size());
+  for (const HistogramSharedPtr& histogram : histograms) {
+    if (histogram->name() == "h1") {
+      EXPECT_EQ("count=2 mean=100.0 P50=100 P90=100 P95=100 P99=100 P100=100",
+                histogram->summary());
+    } else {
+      EXPECT_EQ("t1", histogram->name());
+      EXPECT_EQ("count=1 mean=5.0 P50=5 P90=5 P95=5 P99=5 P100=5", histogram->summary());
+    }
+  }
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+
+  // Includes overflow stat.
+  EXPECT_CALL(*this, free(_));
+}
+
 TEST_F(StatsThreadLocalStoreTest, BasicScope) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -219,6 +265,65 @@ TEST_F(StatsThreadLocalStoreTest, ScopeDelete) {
   EXPECT_CALL(*this, free(_));
 }
 
+TEST_F(StatsThreadLocalStoreTest, BatchedScopeDelete) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  ScopePtr scope1 = store_->createScope("scope1.");
+  ScopePtr scope2 = store_->createScope("scope2.");
+
+  // Deleting multiple scopes before the main thread runs the flush results in a single post and
+  // a single cross thread cache clear covering the whole batch.
+  Event::PostCb flush_cb;
+  EXPECT_CALL(main_thread_dispatcher_, post(_)).WillOnce(SaveArg<0>(&flush_cb));
+  scope1.reset();
+  scope2.reset();
+
+  EXPECT_CALL(tls_, runOnAllThreads(_));
+  flush_cb();
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+
+  // Includes overflow stat.
+  EXPECT_CALL(*this, free(_));
+}
+
+TEST_F(StatsThreadLocalStoreTest, CounterShardFlush) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  ScopePtr scope1 = store_->createScope("scope1.");
+  EXPECT_CALL(*this, alloc(_));
+  Counter& c1 = scope1->counter("c1");
+  c1.add(5);
+
+  // Nothing has been folded in yet; the shard carries the pending delta and reflects it in its
+  // own value. findCounter() queries the store which folds the shards in.
+  EXPECT_EQ(5UL, c1.value());
+  CounterSharedPtr central = TestUtility::findCounter(*store_, "scope1.c1");
+  EXPECT_EQ(5UL, central->value());
+  EXPECT_EQ(5UL, central->latch());
+
+  // A delta still pending when the scope (and with it the shard) goes away is committed rather
+  // than dropped.
+  c1.add(3);
+  EXPECT_CALL(main_thread_dispatcher_, post(_));
+  EXPECT_CALL(tls_, runOnAllThreads(_));
+  scope1.reset();
+  EXPECT_EQ(8UL, central->value());
+  EXPECT_EQ(3UL, central->latch());
+
+  EXPECT_CALL(*this, free(_));
+  central.reset();
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+
+  // Includes overflow stat.
+  EXPECT_CALL(*this, free(_));
+}
+
 TEST_F(StatsThreadLocalStoreTest, NestedScopes) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -234,8 +339,10 @@ TEST_F(StatsThreadLocalStoreTest, NestedScopes) {
   EXPECT_NE(&c1, &c2);
   EXPECT_EQ("scope1.foo.bar", c2.name());
 
-  // Different allocations point to the same referenced counted backing memory.
+  // Different allocations point to the same referenced counted backing memory. Each one is a per
+  // thread shard, so the increment shows up on the other once the shards are folded in.
   c1.inc();
+  store_->counters();
   EXPECT_EQ(1UL, c1.value());
   EXPECT_EQ(c1.value(), c2.value());
 
@@ -265,9 +372,11 @@ TEST_F(StatsThreadLocalStoreTest, OverlappingScopes) {
   Counter& c2 = scope2->counter("c");
   EXPECT_NE(&c1, &c2);
   c1.inc();
+  store_->counters();
   EXPECT_EQ(1UL, c1.value());
   EXPECT_EQ(1UL, c2.value());
   c2.inc();
+  store_->counters();
   EXPECT_EQ(2UL, c1.value());
   EXPECT_EQ(2UL, c2.value());
 
@@ -33,8 +33,10 @@ TEST_P(UdpStatsdSinkTest, InitWithIpAddress) {
   EXPECT_NE(fd, -1);
 
   // Check that fd has not changed.
+  sink.beginFlush();
   sink.flushCounter("test_counter", 1);
   sink.flushGauge("test_gauge", 1);
+  sink.endFlush();
   sink.onHistogramComplete("histogram_test_timer", 5);
   sink.onTimespanComplete("test_timer", std::chrono::milliseconds(5));
   EXPECT_EQ(fd, sink.getFdForTests());
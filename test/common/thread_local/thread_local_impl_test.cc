@@ -59,6 +59,10 @@ TEST_F(ThreadLocalInstanceImplTest, All) {
   SlotPtr slot2 = tls_.allocateSlot();
   TestThreadLocalObject& object_ref2 = setObject(*slot2);
 
+  // get() returns the stored object by reference without copying the owning shared_ptr.
+  EXPECT_EQ(&object_ref2, &slot2->get());
+  EXPECT_EQ(&object_ref2, &slot2->getTyped<TestThreadLocalObject>());
+
   EXPECT_CALL(thread_dispatcher_, post(_));
   EXPECT_CALL(object_ref2, onDestroy());
   slot2.reset();
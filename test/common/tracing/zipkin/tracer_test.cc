@@ -22,7 +22,7 @@ namespace Zipkin {
 class TestReporterImpl : public Reporter {
 public:
   TestReporterImpl(int value) : value_(value) {}
-  void reportSpan(const Span& span) { reported_spans_.push_back(span); }
+  void reportSpan(Span&& span) { reported_spans_.push_back(std::move(span)); }
   int getValue() { return value_; }
   std::vector<Span>& reportedSpans() { return reported_spans_; }
 
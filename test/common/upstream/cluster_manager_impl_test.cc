@@ -1,3 +1,4 @@
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -381,6 +382,34 @@ TEST_F(ClusterManagerImplTest, UnknownCluster) {
   factory_.tls_.shutdownThread();
 }
 
+TEST_F(ClusterManagerImplTest, ClusterHandles) {
+  const std::string json =
+      fmt::sprintf("{%s}", clustersJson({defaultStaticClusterJson("cluster_1")}));
+
+  create(parseBootstrapFromJson(json));
+
+  // Handles are stable and resolve to the same thread local cluster as lookup by name.
+  const uint64_t handle = cluster_manager_->clusterHandle("cluster_1");
+  EXPECT_EQ(handle, cluster_manager_->clusterHandle("cluster_1"));
+  EXPECT_EQ(cluster_manager_->get("cluster_1"), cluster_manager_->getByHandle(handle));
+
+  // A handle can be interned before the cluster exists. It resolves to nothing until a cluster
+  // with that name is added, and keeps its slot after the cluster is removed.
+  const uint64_t fake_handle = cluster_manager_->clusterHandle("fake_cluster");
+  EXPECT_NE(handle, fake_handle);
+  EXPECT_EQ(nullptr, cluster_manager_->getByHandle(fake_handle));
+
+  EXPECT_TRUE(cluster_manager_->addOrUpdatePrimaryCluster(defaultStaticCluster("fake_cluster")));
+  EXPECT_EQ(fake_handle, cluster_manager_->clusterHandle("fake_cluster"));
+  EXPECT_EQ(cluster_manager_->get("fake_cluster"), cluster_manager_->getByHandle(fake_handle));
+
+  EXPECT_TRUE(cluster_manager_->removePrimaryCluster("fake_cluster"));
+  EXPECT_EQ(nullptr, cluster_manager_->getByHandle(fake_handle));
+  EXPECT_EQ(fake_handle, cluster_manager_->clusterHandle("fake_cluster"));
+
+  factory_.tls_.shutdownThread();
+}
+
 /**
  * Test that buffer limits are set on new TCP connections.
  */
@@ -632,6 +661,70 @@ TEST_F(ClusterManagerImplTest, DynamicAddRemove) {
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster2.get()));
 }
 
+// Validate that with a configured settle window, membership updates accumulate on the main thread
+// and are published to the workers as one batch when the window elapses.
+TEST_F(ClusterManagerImplTest, UpdateSettleWindowCoalescing) {
+  const std::string json = R"EOF(
+  {
+    "clusters": []
+  }
+  )EOF";
+
+  // The settle window is read from runtime in the constructor, and a non-zero value makes the
+  // cluster manager create its settle timer.
+  ON_CALL(factory_.runtime_.snapshot_, getInteger("cluster_manager.update_settle_window_ms", 0))
+      .WillByDefault(Return(10));
+  Event::MockTimer* settle_timer = new Event::MockTimer(&factory_.dispatcher_);
+  create(parseBootstrapFromJson(json));
+
+  std::shared_ptr<MockCluster> cluster1(new NiceMock<MockCluster>());
+  cluster1->info_->name_ = "cluster1";
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _)).WillOnce(Return(cluster1));
+  EXPECT_TRUE(cluster_manager_->addOrUpdatePrimaryCluster(defaultStaticCluster("cluster1")));
+
+  std::shared_ptr<MockCluster> cluster2(new NiceMock<MockCluster>());
+  cluster2->info_->name_ = "cluster2";
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _)).WillOnce(Return(cluster2));
+  EXPECT_TRUE(cluster_manager_->addOrUpdatePrimaryCluster(defaultStaticCluster("cluster2")));
+
+  // The first stashed update arms the timer; the second rides along in the same window.
+  EXPECT_CALL(*settle_timer, enableTimer(std::chrono::milliseconds(10)));
+  cluster1->hosts_ = {makeTestHost(cluster1->info_, "tcp://127.0.0.1:80")};
+  cluster1->runCallbacks(cluster1->hosts_, {});
+  cluster2->hosts_ = {makeTestHost(cluster2->info_, "tcp://127.0.0.1:81")};
+  cluster2->runCallbacks(cluster2->hosts_, {});
+
+  // Nothing reaches the thread local clusters until the window elapses.
+  EXPECT_EQ(0UL, cluster_manager_->get("cluster1")->hostSet().hosts().size());
+  EXPECT_EQ(0UL, cluster_manager_->get("cluster2")->hostSet().hosts().size());
+
+  settle_timer->callback_();
+  EXPECT_EQ(1UL, cluster_manager_->get("cluster1")->hostSet().hosts().size());
+  EXPECT_EQ(1UL, cluster_manager_->get("cluster2")->hostSet().hosts().size());
+
+  // Two updates for the same cluster within one window coalesce: the snapshots published to the
+  // workers are the newest ones.
+  EXPECT_CALL(*settle_timer, enableTimer(std::chrono::milliseconds(10)));
+  HostSharedPtr removed_host = cluster1->hosts_[0];
+  cluster1->hosts_ = {makeTestHost(cluster1->info_, "tcp://127.0.0.1:82")};
+  cluster1->runCallbacks({}, {removed_host});
+  cluster1->hosts_.push_back(makeTestHost(cluster1->info_, "tcp://127.0.0.1:83"));
+  cluster1->runCallbacks({cluster1->hosts_[1]}, {});
+
+  settle_timer->callback_();
+  EXPECT_EQ(2UL, cluster_manager_->get("cluster1")->hostSet().hosts().size());
+
+  // Removing a cluster drops its pending update, and the timer is disarmed when nothing else is
+  // waiting out the window.
+  EXPECT_CALL(*settle_timer, enableTimer(std::chrono::milliseconds(10)));
+  cluster2->runCallbacks({}, {});
+  EXPECT_CALL(*settle_timer, disableTimer());
+  EXPECT_TRUE(cluster_manager_->removePrimaryCluster("cluster2"));
+  EXPECT_EQ(nullptr, cluster_manager_->get("cluster2"));
+
+  factory_.tls_.shutdownThread();
+}
+
 TEST_F(ClusterManagerImplTest, AddOrUpdatePrimaryClusterStaticExists) {
   const std::string json =
       fmt::sprintf("{%s}", clustersJson({defaultStaticClusterJson("some_cluster")}));
@@ -931,6 +1024,58 @@ TEST(ClusterManagerInitHelper, AddSecondaryAfterSecondaryInit) {
   cluster2.initialize_callback_();
 }
 
+TEST(ClusterManagerInitHelper, InitParallelismCap) {
+  InSequence s;
+  ClusterManagerInitHelper init_helper(1);
+
+  NiceMock<MockCluster> cluster1;
+  ON_CALL(cluster1, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+  EXPECT_CALL(cluster1, initialize());
+  init_helper.addCluster(cluster1);
+
+  NiceMock<MockCluster> cluster2;
+  ON_CALL(cluster2, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+  init_helper.addCluster(cluster2);
+
+  init_helper.onStaticLoadComplete();
+
+  ReadyWatcher cm_initialized;
+  init_helper.setInitializedCb([&]() -> void { cm_initialized.ready(); });
+
+  // cluster2 only gets its initialization slot once cluster1 completes.
+  EXPECT_CALL(cluster2, initialize());
+  cluster1.initialize_callback_();
+
+  EXPECT_CALL(cm_initialized, ready());
+  cluster2.initialize_callback_();
+}
+
+TEST(ClusterManagerInitHelper, InitReadyPercent) {
+  InSequence s;
+  ClusterManagerInitHelper init_helper(0, 50);
+
+  NiceMock<MockCluster> cluster1;
+  ON_CALL(cluster1, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+  EXPECT_CALL(cluster1, initialize());
+  init_helper.addCluster(cluster1);
+
+  NiceMock<MockCluster> cluster2;
+  ON_CALL(cluster2, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+  EXPECT_CALL(cluster2, initialize());
+  init_helper.addCluster(cluster2);
+
+  init_helper.onStaticLoadComplete();
+
+  ReadyWatcher cm_initialized;
+  init_helper.setInitializedCb([&]() -> void { cm_initialized.ready(); });
+
+  // With a 50% threshold the callback fires when the first of the two clusters becomes ready,
+  // and must not fire again when initialization fully completes.
+  EXPECT_CALL(cm_initialized, ready());
+  cluster1.initialize_callback_();
+  cluster2.initialize_callback_();
+}
+
 TEST(ClusterManagerInitHelper, RemoveClusterWithinInitLoop) {
   // Tests the scenario encountered in Issue 903: The cluster was removed from
   // the secondary init list while traversing the list.
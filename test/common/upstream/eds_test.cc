@@ -167,5 +167,31 @@ TEST_F(EdsTest, EndpointMetadata) {
   EXPECT_TRUE(hosts[1]->canary());
 }
 
+// Validate that onConfigUpdate() reuses the existing host object when an endpoint matches a
+// current host by address, and that an identical assignment leaves the host list untouched.
+TEST_F(EdsTest, EndpointReuseOnIdenticalUpdate) {
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+  auto* cluster_load_assignment = resources.Add();
+  cluster_load_assignment->set_cluster_name("fare");
+  auto* endpoints = cluster_load_assignment->add_endpoints();
+
+  auto* endpoint = endpoints->add_lb_endpoints();
+  endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address()->set_address("1.2.3.4");
+  endpoint->mutable_load_balancing_weight()->set_value(30);
+
+  EXPECT_NO_THROW(cluster_->onConfigUpdate(resources));
+  EXPECT_EQ(1UL, cluster_->hosts().size());
+  HostSharedPtr original_host = cluster_->hosts()[0];
+  EXPECT_EQ(30UL, original_host->weight());
+
+  // The same assignment with a new weight must keep the host object and apply the weight in
+  // place, without growing the host list.
+  endpoint->mutable_load_balancing_weight()->set_value(60);
+  EXPECT_NO_THROW(cluster_->onConfigUpdate(resources));
+  EXPECT_EQ(1UL, cluster_->hosts().size());
+  EXPECT_EQ(original_host, cluster_->hosts()[0]);
+  EXPECT_EQ(60UL, original_host->weight());
+}
+
 } // namespace Upstream
 } // namespace Envoy
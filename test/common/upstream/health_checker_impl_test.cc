@@ -243,6 +243,28 @@ TEST_F(HttpHealthCheckerImplTest, Success) {
   EXPECT_TRUE(cluster_->hosts_[0]->healthy());
 }
 
+TEST_F(HttpHealthCheckerImplTest, InitialSpread) {
+  setupNoServiceValidationHC();
+  cluster_->hosts_ = {makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  cluster_->info_->stats().upstream_cx_total_.inc();
+  expectSessionCreate();
+
+  // With a spread window configured, the first check does not fire immediately. Instead the
+  // interval timer is armed with a deterministic offset within the window.
+  EXPECT_CALL(runtime_.snapshot_, getInteger("health_check.initial_spread_ms", 0))
+      .WillOnce(Return(1000));
+  std::chrono::milliseconds first_offset;
+  EXPECT_CALL(*test_sessions_[0]->interval_timer_, enableTimer(_))
+      .WillOnce(SaveArg<0>(&first_offset));
+  health_checker_->start();
+  EXPECT_LT(first_offset, std::chrono::milliseconds(1000));
+
+  // Firing the interval timer runs the delayed first check.
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  test_sessions_[0]->interval_timer_->callback_();
+}
+
 TEST_F(HttpHealthCheckerImplTest, SuccessServiceCheck) {
   setupServiceValidationHC();
   EXPECT_CALL(runtime_.snapshot_, featureEnabled("health_check.verify_cluster", 100))
@@ -586,6 +608,57 @@ TEST_F(HttpHealthCheckerImplTest, ConnectionClose) {
   test_sessions_[0]->interval_timer_->callback_();
 }
 
+TEST_F(HttpHealthCheckerImplTest, SuccessBeforeBodyComplete) {
+  setupNoServiceValidationHC();
+  EXPECT_CALL(*this, onHostStatus(_, false));
+
+  cluster_->hosts_ = {makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  expectSessionCreate();
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  health_checker_->start();
+
+  // The verdict is delivered as soon as the response head is validated; the timers recycle
+  // before any of the body has arrived.
+  EXPECT_CALL(*test_sessions_[0]->interval_timer_, enableTimer(_));
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, disableTimer());
+  std::unique_ptr<Http::TestHeaderMapImpl> response_headers(
+      new Http::TestHeaderMapImpl{{":status", "200"}});
+  test_sessions_[0]->stream_response_callbacks_->decodeHeaders(std::move(response_headers), false);
+  EXPECT_TRUE(cluster_->hosts_[0]->healthy());
+  testing::Mock::VerifyAndClearExpectations(test_sessions_[0]->interval_timer_);
+  testing::Mock::VerifyAndClearExpectations(test_sessions_[0]->timeout_timer_);
+
+  // The trailing body is drained without any further effect.
+  Buffer::OwnedImpl response_data;
+  test_sessions_[0]->stream_response_callbacks_->decodeData(response_data, true);
+}
+
+TEST_F(HttpHealthCheckerImplTest, ConnectionCycling) {
+  setupNoServiceValidationHC();
+  EXPECT_CALL(*this, onHostStatus(_, false));
+
+  cluster_->hosts_ = {makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  expectSessionCreate();
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  health_checker_->start();
+
+  // With a one check per connection limit, the connection is closed after the response completes
+  // and a fresh one is created for the next interval.
+  EXPECT_CALL(runtime_.snapshot_, getInteger("health_check.requests_per_connection", 0))
+      .WillRepeatedly(Return(1));
+  EXPECT_CALL(*test_sessions_[0]->interval_timer_, enableTimer(_));
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, disableTimer());
+  respond(0, "200", false, true);
+  EXPECT_TRUE(cluster_->hosts_[0]->healthy());
+
+  expectClientCreate(0);
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  test_sessions_[0]->interval_timer_->callback_();
+}
+
 TEST_F(HttpHealthCheckerImplTest, RemoteCloseBetweenChecks) {
   setupNoServiceValidationHC();
   EXPECT_CALL(*this, onHostStatus(_, false)).Times(2);
@@ -654,6 +727,58 @@ TEST_F(HttpHealthCheckerImplTest, ConnectionReachesWatermarkDuringCheck) {
   EXPECT_TRUE(cluster_->hosts_[0]->healthy());
 }
 
+TEST_F(HttpHealthCheckerImplTest, DedicatedDispatcherBatchesResults) {
+  setupNoServiceValidationHC();
+  // In dedicated dispatcher mode the fixture dispatcher plays the role of the health check
+  // thread and host status callbacks are delivered to the main dispatcher instead of running
+  // inline. The mock dispatchers run posted callbacks inline, so start() and member updates
+  // (which post onto the health check dispatcher) behave as in the other tests.
+  NiceMock<Event::MockDispatcher> main_dispatcher;
+  health_checker_->setResultDispatcher(main_dispatcher);
+
+  cluster_->hosts_ = {makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  expectSessionCreate();
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  health_checker_->start();
+
+  expectSessionCreate();
+  expectStreamCreate(1);
+  cluster_->hosts_.push_back(makeTestHost(cluster_->info_, "tcp://127.0.0.1:81"));
+  EXPECT_CALL(*test_sessions_[1]->timeout_timer_, enableTimer(_));
+  cluster_->runCallbacks({cluster_->hosts_.back()}, {});
+
+  // Both completions are batched into a single post to the main dispatcher, and the host status
+  // callbacks only run once the posted flush does.
+  std::function<void()> flush_cb;
+  EXPECT_CALL(main_dispatcher, post(_)).WillOnce(SaveArg<0>(&flush_cb));
+  EXPECT_CALL(*test_sessions_[0]->interval_timer_, enableTimer(_));
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, disableTimer());
+  respond(0, "200", false);
+  EXPECT_CALL(*test_sessions_[1]->interval_timer_, enableTimer(_));
+  EXPECT_CALL(*test_sessions_[1]->timeout_timer_, disableTimer());
+  respond(1, "200", false);
+
+  EXPECT_CALL(*this, onHostStatus(_, false)).Times(2);
+  flush_cb();
+}
+
+TEST_F(HttpHealthCheckerImplTest, DedicatedDispatcherShutdown) {
+  setupNoServiceValidationHC();
+  NiceMock<Event::MockDispatcher> main_dispatcher;
+  health_checker_->setResultDispatcher(main_dispatcher);
+
+  cluster_->hosts_ = {makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  expectSessionCreate();
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  health_checker_->start();
+
+  // shutdown() tears down the session (and its connection) on the health check dispatcher.
+  EXPECT_CALL(*test_sessions_[0]->client_connection_, close(_));
+  health_checker_->shutdown();
+}
+
 TEST(TcpHealthCheckMatcher, loadJsonBytes) {
   {
     Protobuf::RepeatedPtrField<envoy::api::v2::HealthCheck::Payload> repeated_payload;
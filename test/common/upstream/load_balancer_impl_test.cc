@@ -64,6 +64,59 @@ TEST_F(RoundRobinLoadBalancerTest, Normal) {
   EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
 }
 
+TEST_F(RoundRobinLoadBalancerTest, Weighted) {
+  init(false);
+  stats_.max_host_weight_.set(2UL);
+  cluster_.healthy_hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80", 1),
+                             makeTestHost(cluster_.info_, "tcp://127.0.0.1:81", 2)};
+  cluster_.hosts_ = cluster_.healthy_hosts_;
+
+  // The EDF schedule with weights 1 and 2 deterministically picks the weight 2 host twice as
+  // often.
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_->chooseHost(nullptr));
+}
+
+TEST_F(RoundRobinLoadBalancerTest, WeightedScheduleRebuiltOnMemberUpdate) {
+  init(false);
+  stats_.max_host_weight_.set(2UL);
+  cluster_.healthy_hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80", 1),
+                             makeTestHost(cluster_.info_, "tcp://127.0.0.1:81", 2)};
+  cluster_.hosts_ = cluster_.healthy_hosts_;
+
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
+
+  // A membership update invalidates the schedule; the rebuilt one starts from scratch with the
+  // new host list.
+  cluster_.healthy_hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:82", 2),
+                             makeTestHost(cluster_.info_, "tcp://127.0.0.1:83", 1)};
+  cluster_.hosts_ = cluster_.healthy_hosts_;
+  cluster_.runCallbacks({}, {});
+
+  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_->chooseHost(nullptr));
+}
+
+TEST_F(RoundRobinLoadBalancerTest, WeightedRuntimeDisabled) {
+  init(false);
+  stats_.max_host_weight_.set(2UL);
+  cluster_.healthy_hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80", 1),
+                             makeTestHost(cluster_.info_, "tcp://127.0.0.1:81", 2)};
+  cluster_.hosts_ = cluster_.healthy_hosts_;
+
+  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.weight_enabled", 1))
+      .WillRepeatedly(Return(0));
+  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
+}
+
 TEST_F(RoundRobinLoadBalancerTest, MaxUnhealthyPanic) {
   init(false);
   cluster_.healthy_hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80"),
@@ -74,16 +127,19 @@ TEST_F(RoundRobinLoadBalancerTest, MaxUnhealthyPanic) {
                      makeTestHost(cluster_.info_, "tcp://127.0.0.1:83"),
                      makeTestHost(cluster_.info_, "tcp://127.0.0.1:84"),
                      makeTestHost(cluster_.info_, "tcp://127.0.0.1:85")};
+  cluster_.runCallbacks({}, {});
 
   EXPECT_EQ(cluster_.hosts_[0], lb_->chooseHost(nullptr));
   EXPECT_EQ(cluster_.hosts_[1], lb_->chooseHost(nullptr));
   EXPECT_EQ(cluster_.hosts_[2], lb_->chooseHost(nullptr));
 
-  // Take the threshold back above the panic threshold.
+  // Take the threshold back above the panic threshold. The panic state is recomputed on the
+  // member update callback, not on every pick.
   cluster_.healthy_hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80"),
                              makeTestHost(cluster_.info_, "tcp://127.0.0.1:81"),
                              makeTestHost(cluster_.info_, "tcp://127.0.0.1:82"),
                              makeTestHost(cluster_.info_, "tcp://127.0.0.1:83")};
+  cluster_.runCallbacks({}, {});
 
   EXPECT_EQ(cluster_.healthy_hosts_[3], lb_->chooseHost(nullptr));
   EXPECT_EQ(cluster_.healthy_hosts_[0], lb_->chooseHost(nullptr));
@@ -238,10 +294,16 @@ TEST_F(RoundRobinLoadBalancerTest, ZoneAwareRoutingSmallZone) {
   EXPECT_EQ(cluster_.healthy_hosts_per_zone_[0][0], lb_->chooseHost(nullptr));
   EXPECT_EQ(1U, stats_.lb_zone_routing_sampled_.value());
 
-  // Force request out of small zone.
-  EXPECT_CALL(random_, random()).WillOnce(Return(9999)).WillOnce(Return(2));
+  // Force request out of small zone. The same draw that rejected the local zone falls into the
+  // cumulative bucket of the first zone with residual capacity.
+  EXPECT_CALL(random_, random()).WillOnce(Return(6500));
   EXPECT_EQ(cluster_.healthy_hosts_per_zone_[1][1], lb_->chooseHost(nullptr));
   EXPECT_EQ(1U, stats_.lb_zone_routing_cross_zone_.value());
+
+  // A draw past the last populated bucket lands in the final zone.
+  EXPECT_CALL(random_, random()).WillOnce(Return(9999));
+  EXPECT_EQ(cluster_.healthy_hosts_per_zone_[2][0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(2U, stats_.lb_zone_routing_cross_zone_.value());
 }
 
 TEST_F(RoundRobinLoadBalancerTest, LowPrecisionForDistribution) {
@@ -393,16 +455,16 @@ TEST_F(LeastRequestLoadBalancerTest, SingleHost) {
   cluster_.healthy_hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80")};
   cluster_.hosts_ = cluster_.healthy_hosts_;
 
-  // Host weight is 1.
+  // Host weight is 1. A single host is returned directly without sampling.
   {
-    EXPECT_CALL(random_, random()).WillOnce(Return(2)).WillOnce(Return(3));
+    EXPECT_CALL(random_, random()).Times(0);
     stats_.max_host_weight_.set(1UL);
     EXPECT_EQ(cluster_.healthy_hosts_[0], lb_.chooseHost(nullptr));
   }
 
-  // Host weight is 100.
+  // Host weight is 100. The EDF schedule does not sample.
   {
-    EXPECT_CALL(random_, random()).WillOnce(Return(2));
+    EXPECT_CALL(random_, random()).Times(0);
     stats_.max_host_weight_.set(100UL);
     EXPECT_EQ(cluster_.healthy_hosts_[0], lb_.chooseHost(nullptr));
   }
@@ -410,7 +472,7 @@ TEST_F(LeastRequestLoadBalancerTest, SingleHost) {
   std::vector<HostSharedPtr> empty;
   {
     cluster_.runCallbacks(empty, empty);
-    EXPECT_CALL(random_, random()).WillOnce(Return(2));
+    EXPECT_CALL(random_, random()).Times(0);
     EXPECT_EQ(cluster_.healthy_hosts_[0], lb_.chooseHost(nullptr));
   }
 
@@ -472,43 +534,32 @@ TEST_F(LeastRequestLoadBalancerTest, WeightImbalance) {
   stats_.max_host_weight_.set(3UL);
 
   cluster_.hosts_ = cluster_.healthy_hosts_;
-  EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.healthy_panic_threshold", 50))
-      .WillRepeatedly(Return(50));
-
   EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.weight_enabled", 1))
       .WillRepeatedly(Return(1));
   EXPECT_CALL(runtime_.snapshot_, getInteger("upstream.healthy_panic_threshold", 50))
       .WillRepeatedly(Return(50));
 
-  // As max weight higher then 1 we do random host pick and keep it for weight requests.
-  EXPECT_CALL(random_, random()).WillOnce(Return(1));
-  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_.chooseHost(nullptr));
-
-  // Same host stays as we have to hit it 3 times.
+  // Active request counts are ignored in weighted mode.
   cluster_.healthy_hosts_[0]->stats().rq_active_.set(2);
   cluster_.healthy_hosts_[1]->stats().rq_active_.set(1);
-  EXPECT_CALL(random_, random()).Times(0);
-  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_.chooseHost(nullptr));
 
-  // Same host stays as we have to hit it 3 times.
+  // With weights 1 and 3 the EDF schedule deterministically sends three requests to the weight 3
+  // host for every one to the weight 1 host, with no random sampling and no bursts longer than
+  // the schedule produces.
   EXPECT_CALL(random_, random()).Times(0);
-  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_.chooseHost(nullptr));
-
-  // Get random host after previous one was selected 3 times in a row.
-  EXPECT_CALL(random_, random()).WillOnce(Return(2));
-  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_.chooseHost(nullptr));
-
-  // Select second host again.
-  EXPECT_CALL(random_, random()).WillOnce(Return(1));
-  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_.chooseHost(nullptr));
+  uint64_t picks[2] = {0, 0};
+  for (int i = 0; i < 8; i++) {
+    HostConstSharedPtr host = lb_.chooseHost(nullptr);
+    picks[host == cluster_.healthy_hosts_[0] ? 0 : 1]++;
+  }
+  EXPECT_EQ(2UL, picks[0]);
+  EXPECT_EQ(6UL, picks[1]);
 
-  // Set weight to 1, we will switch to the two random hosts mode.
+  // Set weight to 1, we will switch to the power of two choices mode and pick the host with
+  // fewer active requests.
   stats_.max_host_weight_.set(1UL);
-  EXPECT_CALL(random_, random()).WillOnce(Return(2)).WillOnce(Return(3));
-  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_.chooseHost(nullptr));
-
   EXPECT_CALL(random_, random()).WillOnce(Return(2)).WillOnce(Return(2));
-  EXPECT_EQ(cluster_.healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_EQ(cluster_.healthy_hosts_[1], lb_.chooseHost(nullptr));
 }
 
 TEST_F(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
@@ -518,10 +569,12 @@ TEST_F(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
 
   cluster_.hosts_ = cluster_.healthy_hosts_;
 
-  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  // The weight 3 host has the earliest deadline in the EDF schedule.
+  EXPECT_CALL(random_, random()).Times(0);
   EXPECT_EQ(cluster_.healthy_hosts_[1], lb_.chooseHost(nullptr));
 
-  // Same host stays as we have to hit it 3 times, but we remove it and fire callback.
+  // Remove the picked host and fire the callback. The schedule is rebuilt from the remaining
+  // host on the next pick.
   std::vector<HostSharedPtr> empty;
   std::vector<HostSharedPtr> hosts_removed;
   hosts_removed.push_back(cluster_.hosts_[1]);
@@ -529,7 +582,7 @@ TEST_F(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
   cluster_.healthy_hosts_.erase(cluster_.healthy_hosts_.begin() + 1);
   cluster_.runCallbacks(empty, hosts_removed);
 
-  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  EXPECT_CALL(random_, random()).Times(0);
   EXPECT_EQ(cluster_.healthy_hosts_[0], lb_.chooseHost(nullptr));
 }
 
@@ -45,10 +45,14 @@ public:
 
 class OriginalDstClusterTest : public testing::Test {
 public:
-  // cleanup timer must be created before the cluster (in setup()), so that we can set expectations
-  // on it. Ownership is transferred to the cluster at the cluster constructor, so the cluster will
-  // take care of destructing it!
-  OriginalDstClusterTest() : cleanup_timer_(new Event::MockTimer(&dispatcher_)) {}
+  // The timers must be created before the cluster (in setup()), so that we can set expectations
+  // on them. Ownership is transferred to the cluster at the cluster constructor, so the cluster
+  // will take care of destructing them! Mock timer expectations are matched newest first, so the
+  // publish timer mock is created first to pair with the second createTimer() call in the cluster
+  // constructor.
+  OriginalDstClusterTest()
+      : publish_timer_(new Event::MockTimer(&dispatcher_)),
+        cleanup_timer_(new Event::MockTimer(&dispatcher_)) {}
 
   void setup(const std::string& json) {
     NiceMock<MockClusterManager> cm;
@@ -68,6 +72,7 @@ public:
   ReadyWatcher initialized_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Event::MockDispatcher> dispatcher_;
+  Event::MockTimer* publish_timer_;
   Event::MockTimer* cleanup_timer_;
 };
 
@@ -210,8 +215,10 @@ TEST_F(OriginalDstClusterTest, Membership) {
   OriginalDstCluster::LoadBalancer lb(*cluster_, cluster_);
   Event::PostCb post_cb;
   EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_CALL(*publish_timer_, enableTimer(std::chrono::milliseconds(0)));
   HostConstSharedPtr host = lb.chooseHost(&lb_context);
   post_cb();
+  publish_timer_->callback_();
   auto cluster_hosts = cluster_->hosts();
 
   ASSERT_NE(host, nullptr);
@@ -251,8 +258,10 @@ TEST_F(OriginalDstClusterTest, Membership) {
   // New host gets created
   EXPECT_CALL(membership_updated_, ready());
   EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_CALL(*publish_timer_, enableTimer(std::chrono::milliseconds(0)));
   HostConstSharedPtr host3 = lb.chooseHost(&lb_context);
   post_cb();
+  publish_timer_->callback_();
   EXPECT_NE(host3, nullptr);
   EXPECT_NE(host3, host);
   EXPECT_NE(cluster_hosts, cluster_->hosts()); // hosts vector changes
@@ -299,15 +308,19 @@ TEST_F(OriginalDstClusterTest, Membership2) {
   EXPECT_CALL(membership_updated_, ready());
   Event::PostCb post_cb;
   EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_CALL(*publish_timer_, enableTimer(std::chrono::milliseconds(0)));
   HostConstSharedPtr host1 = lb.chooseHost(&lb_context1);
   post_cb();
+  publish_timer_->callback_();
   ASSERT_NE(host1, nullptr);
   EXPECT_EQ(local_address1, *host1->address());
 
   EXPECT_CALL(membership_updated_, ready());
   EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_CALL(*publish_timer_, enableTimer(std::chrono::milliseconds(0)));
   HostConstSharedPtr host2 = lb.chooseHost(&lb_context2);
   post_cb();
+  publish_timer_->callback_();
   ASSERT_NE(host2, nullptr);
   EXPECT_EQ(local_address2, *host2->address());
 
@@ -345,6 +358,55 @@ TEST_F(OriginalDstClusterTest, Membership2) {
   EXPECT_EQ(0UL, cluster_->hosts().size());
 }
 
+TEST_F(OriginalDstClusterTest, CoalescedPublish) {
+  std::string json = R"EOF(
+  {
+    "name": "name",
+    "connect_timeout_ms": 1250,
+    "type": "original_dst",
+    "lb_type": "original_dst_lb"
+  }
+  )EOF";
+
+  EXPECT_CALL(initialized_, ready());
+  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
+  setup(json);
+
+  NiceMock<Network::MockConnection> connection1;
+  TestLoadBalancerContext lb_context1(&connection1);
+  Network::Address::Ipv4Instance local_address1("10.10.11.11");
+  EXPECT_CALL(connection1, localAddress()).WillRepeatedly(ReturnRef(local_address1));
+  EXPECT_CALL(connection1, usingOriginalDst()).WillRepeatedly(Return(true));
+
+  NiceMock<Network::MockConnection> connection2;
+  TestLoadBalancerContext lb_context2(&connection2);
+  Network::Address::Ipv4Instance local_address2("10.10.11.12");
+  EXPECT_CALL(connection2, localAddress()).WillRepeatedly(ReturnRef(local_address2));
+  EXPECT_CALL(connection2, usingOriginalDst()).WillRepeatedly(Return(true));
+
+  OriginalDstCluster::LoadBalancer lb(*cluster_, cluster_);
+
+  // Two hosts created before the publish timer fires result in a single membership update for
+  // the whole batch.
+  Event::PostCb post_cb1;
+  Event::PostCb post_cb2;
+  EXPECT_CALL(dispatcher_, post(_))
+      .WillOnce(SaveArg<0>(&post_cb1))
+      .WillOnce(SaveArg<0>(&post_cb2));
+  EXPECT_CALL(*publish_timer_, enableTimer(std::chrono::milliseconds(0))).Times(2);
+  HostConstSharedPtr host1 = lb.chooseHost(&lb_context1);
+  HostConstSharedPtr host2 = lb.chooseHost(&lb_context2);
+  post_cb1();
+  post_cb2();
+
+  EXPECT_CALL(membership_updated_, ready());
+  publish_timer_->callback_();
+
+  EXPECT_EQ(2UL, cluster_->hosts().size());
+  EXPECT_EQ(host1, cluster_->hosts()[0]);
+  EXPECT_EQ(host2, cluster_->hosts()[1]);
+}
+
 TEST_F(OriginalDstClusterTest, Connection) {
   std::string json = R"EOF(
   {
@@ -376,8 +438,10 @@ TEST_F(OriginalDstClusterTest, Connection) {
   OriginalDstCluster::LoadBalancer lb(*cluster_, cluster_);
   Event::PostCb post_cb;
   EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_CALL(*publish_timer_, enableTimer(std::chrono::milliseconds(0)));
   HostConstSharedPtr host = lb.chooseHost(&lb_context);
   post_cb();
+  publish_timer_->callback_();
   ASSERT_NE(host, nullptr);
   EXPECT_EQ(local_address, *host->address());
 
@@ -425,8 +489,10 @@ TEST_F(OriginalDstClusterTest, MultipleClusters) {
   OriginalDstCluster::LoadBalancer lb2(second, cluster_);
   Event::PostCb post_cb;
   EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_CALL(*publish_timer_, enableTimer(std::chrono::milliseconds(0)));
   HostConstSharedPtr host = lb1.chooseHost(&lb_context);
   post_cb();
+  publish_timer_->callback_();
   ASSERT_NE(host, nullptr);
   EXPECT_EQ(local_address, *host->address());
 
@@ -319,6 +319,68 @@ TEST_F(OutlierDetectorImplTest, BasicFlowSuccessRate) {
   EXPECT_EQ(-1, detector->successRateEjectionThreshold());
 }
 
+TEST_F(OutlierDetectorImplTest, SuccessRateWindowSpansIntervals) {
+  EXPECT_CALL(cluster_, addMemberUpdateCb(_));
+  addHosts({
+      "tcp://127.0.0.1:80",
+      "tcp://127.0.0.1:81",
+      "tcp://127.0.0.1:82",
+      "tcp://127.0.0.1:83",
+      "tcp://127.0.0.1:84",
+  });
+
+  // Use a window of 3 buckets so request volume accumulates across detection intervals.
+  ON_CALL(runtime_.snapshot_, getInteger("outlier_detection.success_rate_window_buckets", 1))
+      .WillByDefault(Return(3));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  std::shared_ptr<DetectorImpl> detector(DetectorImpl::create(
+      cluster_, empty_outlier_detection_, dispatcher_, runtime_, time_source_, event_logger_));
+  detector->addChangedStateCb([&](HostSharedPtr host) -> void { checker_.check(host); });
+
+  // Turn off 5xx detection to test SR detection in isolation.
+  ON_CALL(runtime_.snapshot_, featureEnabled("outlier_detection.enforcing_consecutive_5xx", 100))
+      .WillByDefault(Return(false));
+  // Expect non-enforcing logging to happen every time the consecutive_5xx_ counter
+  // gets saturated (every 5 times).
+  EXPECT_CALL(*event_logger_,
+              logEject(std::static_pointer_cast<const HostDescription>(cluster_.hosts_[4]), _,
+                       EjectionType::Consecutive5xx, false))
+      .Times(24);
+
+  // A single interval's worth of traffic does not give the healthy hosts enough request volume,
+  // so no ejection can happen yet.
+  loadRq(cluster_.hosts_, 60, 200);
+  loadRq(cluster_.hosts_[4], 60, 503);
+
+  EXPECT_CALL(time_source_, currentTime())
+      .WillOnce(Return(MonotonicTime(std::chrono::milliseconds(10000))));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_EQ(-1, detector->successRateAverage());
+  EXPECT_EQ(-1, detector->successRateEjectionThreshold());
+  EXPECT_EQ(0UL, cluster_.info_->stats_store_.gauge("outlier_detection.ejections_active").value());
+
+  // A second interval's worth of traffic brings every host over the volume threshold since the
+  // window now spans both intervals, so the bad host gets ejected.
+  loadRq(cluster_.hosts_, 60, 200);
+  loadRq(cluster_.hosts_[4], 60, 503);
+
+  EXPECT_CALL(time_source_, currentTime())
+      .Times(2)
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::milliseconds(20000))));
+  EXPECT_CALL(checker_, check(cluster_.hosts_[4]));
+  EXPECT_CALL(*event_logger_,
+              logEject(std::static_pointer_cast<const HostDescription>(cluster_.hosts_[4]), _,
+                       EjectionType::SuccessRate, true));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_EQ(50, cluster_.hosts_[4]->outlierDetector().successRate());
+  EXPECT_EQ(90, detector->successRateAverage());
+  EXPECT_EQ(52, detector->successRateEjectionThreshold());
+  EXPECT_TRUE(cluster_.hosts_[4]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+  EXPECT_EQ(1UL, cluster_.info_->stats_store_.gauge("outlier_detection.ejections_active").value());
+}
+
 TEST_F(OutlierDetectorImplTest, RemoveWhileEjected) {
   EXPECT_CALL(cluster_, addMemberUpdateCb(_));
   addHosts({"tcp://127.0.0.1:80"});
@@ -525,59 +587,66 @@ TEST(OutlierDetectionEventLoggerImplTest, All) {
   Optional<MonotonicTime> monotonic_time;
   NiceMock<MockDetector> detector;
 
-  EXPECT_CALL(log_manager, createAccessLog("foo")).WillOnce(Return(file));
-  EventLoggerImpl event_logger(log_manager, "foo", time_source, monotonic_time_source);
-
   std::string log1;
-  EXPECT_CALL(host->outlier_detector_, lastUnejectionTime()).WillOnce(ReturnRef(monotonic_time));
-  EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
-                           "\"-1\", \"cluster\": "
-                           "\"fake_cluster\", \"upstream_url\": \"10.0.0.1:443\", \"action\": "
-                           "\"eject\", \"type\": \"5xx\", \"num_ejections\": \"0\", "
-                           "\"enforced\": \"true\"}\n"))
-      .WillOnce(SaveArg<0>(&log1));
-  event_logger.logEject(host, detector, EjectionType::Consecutive5xx, true);
-  Json::Factory::loadFromString(log1);
-
   std::string log2;
-  EXPECT_CALL(host->outlier_detector_, lastEjectionTime()).WillOnce(ReturnRef(monotonic_time));
-  EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
-                           "\"-1\", \"cluster\": \"fake_cluster\", "
-                           "\"upstream_url\": \"10.0.0.1:443\", \"action\": \"uneject\", "
-                           "\"num_ejections\": 0}\n"))
-      .WillOnce(SaveArg<0>(&log2));
-  event_logger.logUneject(host);
-  Json::Factory::loadFromString(log2);
+  std::string log3;
+  std::string log4;
 
-  // now test with time since last action.
-  time.value(time_source.currentTime() - std::chrono::seconds(30));
-  monotonic_time.value(monotonic_time_source.currentTime() - std::chrono::seconds(30));
+  {
+    EXPECT_CALL(log_manager, createAccessLog("foo")).WillOnce(Return(file));
+    EventLoggerImpl event_logger(log_manager, "foo", time_source, monotonic_time_source);
+
+    EXPECT_CALL(host->outlier_detector_, lastUnejectionTime()).WillOnce(ReturnRef(monotonic_time));
+    EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
+                             "\"-1\", \"cluster\": "
+                             "\"fake_cluster\", \"upstream_url\": \"10.0.0.1:443\", \"action\": "
+                             "\"eject\", \"type\": \"5xx\", \"num_ejections\": \"0\", "
+                             "\"enforced\": \"true\"}\n"))
+        .WillOnce(SaveArg<0>(&log1));
+    event_logger.logEject(host, detector, EjectionType::Consecutive5xx, true);
+
+    EXPECT_CALL(host->outlier_detector_, lastEjectionTime()).WillOnce(ReturnRef(monotonic_time));
+    EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
+                             "\"-1\", \"cluster\": \"fake_cluster\", "
+                             "\"upstream_url\": \"10.0.0.1:443\", \"action\": \"uneject\", "
+                             "\"num_ejections\": 0}\n"))
+        .WillOnce(SaveArg<0>(&log2));
+    event_logger.logUneject(host);
+
+    // now test with time since last action.
+    time.value(time_source.currentTime() - std::chrono::seconds(30));
+    monotonic_time.value(monotonic_time_source.currentTime() - std::chrono::seconds(30));
+
+    EXPECT_CALL(host->outlier_detector_, lastUnejectionTime()).WillOnce(ReturnRef(monotonic_time));
+    EXPECT_CALL(host->outlier_detector_, successRate()).WillOnce(Return(-1));
+    EXPECT_CALL(detector, successRateAverage()).WillOnce(Return(-1));
+    EXPECT_CALL(detector, successRateEjectionThreshold()).WillOnce(Return(-1));
+    EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
+                             "\"30\", \"cluster\": "
+                             "\"fake_cluster\", \"upstream_url\": \"10.0.0.1:443\", \"action\": "
+                             "\"eject\", \"type\": \"SuccessRate\", \"num_ejections\": \"0\", "
+                             "\"enforced\": \"false\", "
+                             "\"host_success_rate\": \"-1\", \"cluster_average_success_rate\": "
+                             "\"-1\", \"cluster_success_rate_ejection_threshold\": \"-1\""
+                             "}\n"))
+        .WillOnce(SaveArg<0>(&log3));
+    event_logger.logEject(host, detector, EjectionType::SuccessRate, false);
+
+    EXPECT_CALL(host->outlier_detector_, lastEjectionTime()).WillOnce(ReturnRef(monotonic_time));
+    EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
+                             "\"30\", \"cluster\": \"fake_cluster\", "
+                             "\"upstream_url\": \"10.0.0.1:443\", \"action\": \"uneject\", "
+                             "\"num_ejections\": 0}\n"))
+        .WillOnce(SaveArg<0>(&log4));
+    event_logger.logUneject(host);
+
+    // Destroying the logger drains the queue and joins the formatting thread, so all the writes
+    // are visible after this block.
+  }
 
-  std::string log3;
-  EXPECT_CALL(host->outlier_detector_, lastUnejectionTime()).WillOnce(ReturnRef(monotonic_time));
-  EXPECT_CALL(host->outlier_detector_, successRate()).WillOnce(Return(-1));
-  EXPECT_CALL(detector, successRateAverage()).WillOnce(Return(-1));
-  EXPECT_CALL(detector, successRateEjectionThreshold()).WillOnce(Return(-1));
-  EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
-                           "\"30\", \"cluster\": "
-                           "\"fake_cluster\", \"upstream_url\": \"10.0.0.1:443\", \"action\": "
-                           "\"eject\", \"type\": \"SuccessRate\", \"num_ejections\": \"0\", "
-                           "\"enforced\": \"false\", "
-                           "\"host_success_rate\": \"-1\", \"cluster_average_success_rate\": "
-                           "\"-1\", \"cluster_success_rate_ejection_threshold\": \"-1\""
-                           "}\n"))
-      .WillOnce(SaveArg<0>(&log3));
-  event_logger.logEject(host, detector, EjectionType::SuccessRate, false);
+  Json::Factory::loadFromString(log1);
+  Json::Factory::loadFromString(log2);
   Json::Factory::loadFromString(log3);
-
-  std::string log4;
-  EXPECT_CALL(host->outlier_detector_, lastEjectionTime()).WillOnce(ReturnRef(monotonic_time));
-  EXPECT_CALL(*file, write("{\"time\": \"1970-01-01T00:00:00.000Z\", \"secs_since_last_action\": "
-                           "\"30\", \"cluster\": \"fake_cluster\", "
-                           "\"upstream_url\": \"10.0.0.1:443\", \"action\": \"uneject\", "
-                           "\"num_ejections\": 0}\n"))
-      .WillOnce(SaveArg<0>(&log4));
-  event_logger.logUneject(host);
   Json::Factory::loadFromString(log4);
 }
 
@@ -1,3 +1,5 @@
+#include <chrono>
+
 #include "common/upstream/resource_manager_impl.h"
 
 #include "test/mocks/runtime/mocks.h"
@@ -47,5 +49,72 @@ TEST(ResourceManagerImplTest, RuntimeResourceManager) {
   EXPECT_FALSE(resource_manager.retries().canCreate());
 }
 
+TEST(ResourceManagerImplTest, RetryBudget) {
+  NiceMock<Runtime::MockLoader> runtime;
+  ResourceManagerImpl resource_manager(runtime, "circuit_breakers.retry_budget_test.default.", 100,
+                                       100, 100, 2);
+
+  // With no budget configured, the static maximum applies.
+  EXPECT_EQ(2U, resource_manager.retries().max());
+
+  // A 20% budget with no active requests still allows the minimum retry concurrency.
+  EXPECT_CALL(runtime.snapshot_,
+              getInteger("circuit_breakers.retry_budget_test.default.retry_budget_percent", 0U))
+      .WillRepeatedly(Return(20U));
+  EXPECT_EQ(3U, resource_manager.retries().max());
+
+  // The budget scales with active (pending + outstanding) requests.
+  for (uint64_t i = 0; i < 30; i++) {
+    resource_manager.requests().inc();
+  }
+  for (uint64_t i = 0; i < 10; i++) {
+    resource_manager.pendingRequests().inc();
+  }
+  EXPECT_EQ(8U, resource_manager.retries().max());
+
+  for (uint64_t i = 0; i < 30; i++) {
+    resource_manager.requests().dec();
+  }
+  for (uint64_t i = 0; i < 10; i++) {
+    resource_manager.pendingRequests().dec();
+  }
+}
+
+TEST(ResourceManagerImplTest, AdaptiveRequestLimit) {
+  NiceMock<Runtime::MockLoader> runtime;
+  ResourceManagerImpl resource_manager(runtime, "circuit_breakers.adaptive_test.default.", 100, 100,
+                                       100, 1);
+
+  auto record_window = [&resource_manager](uint64_t sample_ms) {
+    for (uint64_t i = 0; i < 10; i++) {
+      resource_manager.recordResponseTime(std::chrono::milliseconds(sample_ms));
+    }
+  };
+
+  // With the runtime key unset the configured maximum applies, samples or not.
+  record_window(10);
+  EXPECT_EQ(100U, resource_manager.requests().max());
+
+  EXPECT_CALL(
+      runtime.snapshot_,
+      getInteger("circuit_breakers.adaptive_test.default.adaptive_concurrency_enabled", 0U))
+      .WillRepeatedly(Return(1U));
+
+  // Latency at the baseline grows the internal limit, but the configured maximum still caps it.
+  record_window(10);
+  EXPECT_EQ(100U, resource_manager.requests().max());
+
+  // Inflated latency halves the limit (gradient floor) plus the sqrt headroom term. The internal
+  // limit is 120 at this point: two baseline windows above grew it from 100 by sqrt() headroom.
+  record_window(40);
+  EXPECT_EQ(70U, resource_manager.requests().max());
+  record_window(40);
+  EXPECT_EQ(43U, resource_manager.requests().max());
+
+  // Latency back at baseline lets the limit climb again by the headroom term.
+  record_window(10);
+  EXPECT_EQ(49U, resource_manager.requests().max());
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -1,6 +1,8 @@
 #include <cstdint>
+#include <map>
 #include <string>
 
+#include "common/common/hash.h"
 #include "common/network/utility.h"
 #include "common/upstream/ring_hash_lb.h"
 #include "common/upstream/upstream_impl.h"
@@ -139,5 +141,86 @@ TEST_F(RingHashLoadBalancerTest, UnevenHosts) {
   }
 }
 
+TEST_F(RingHashLoadBalancerTest, XxHash) {
+  cluster_.hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80"),
+                     makeTestHost(cluster_.info_, "tcp://127.0.0.1:81")};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+
+  ON_CALL(runtime_.snapshot_, getInteger("upstream.ring_hash.use_std_hash", _))
+      .WillByDefault(Return(0));
+  ON_CALL(runtime_.snapshot_, getInteger("upstream.ring_hash.min_ring_size", _))
+      .WillByDefault(Return(2));
+  cluster_.runCallbacks({}, {});
+
+  // Unlike std::hash, xxHash64 is stable across platforms and standard libraries, so the ring
+  // entries can be recomputed here. A lookup with a hash equal to a ring entry lands exactly on
+  // that entry.
+  {
+    TestLoadBalancerContext context(HashUtil::xxHash64("127.0.0.1:80_0"));
+    EXPECT_EQ(cluster_.hosts_[0], lb_.chooseHost(&context));
+  }
+  {
+    TestLoadBalancerContext context(HashUtil::xxHash64("127.0.0.1:81_0"));
+    EXPECT_EQ(cluster_.hosts_[1], lb_.chooseHost(&context));
+  }
+}
+
+TEST_F(RingHashLoadBalancerTest, Maglev) {
+  ON_CALL(runtime_.snapshot_, getInteger("upstream.ring_hash.use_maglev", _))
+      .WillByDefault(Return(1));
+  cluster_.hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80"),
+                     makeTestHost(cluster_.info_, "tcp://127.0.0.1:81"),
+                     makeTestHost(cluster_.info_, "tcp://127.0.0.1:82"),
+                     makeTestHost(cluster_.info_, "tcp://127.0.0.1:83")};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+  cluster_.runCallbacks({}, {});
+
+  // The table layout depends on the implementation defined std::hash, so verify structural
+  // properties rather than specific slot assignments: every slot is filled and each host owns a
+  // nearly even share of the 65537 slots (within one slot of each other).
+  std::map<HostConstSharedPtr, uint64_t> counts;
+  for (uint64_t i = 0; i < 65537; i++) {
+    TestLoadBalancerContext context(i);
+    HostConstSharedPtr host = lb_.chooseHost(&context);
+    ASSERT_NE(nullptr, host);
+    counts[host]++;
+  }
+  EXPECT_EQ(4UL, counts.size());
+  for (const auto& count : counts) {
+    EXPECT_LE(65537UL / 4, count.second);
+    EXPECT_GE(65537UL / 4 + 1, count.second);
+  }
+
+  // Picks are deterministic per hash key.
+  {
+    TestLoadBalancerContext context(42);
+    EXPECT_EQ(lb_.chooseHost(&context), lb_.chooseHost(&context));
+  }
+
+  // Remove a host and fire the callback. The rebuilt table no longer contains it.
+  std::vector<HostSharedPtr> hosts_removed{cluster_.hosts_.back()};
+  cluster_.hosts_.pop_back();
+  cluster_.healthy_hosts_.pop_back();
+  cluster_.runCallbacks({}, hosts_removed);
+  for (uint64_t i = 0; i < 65537; i++) {
+    TestLoadBalancerContext context(i);
+    EXPECT_NE(hosts_removed[0], lb_.chooseHost(&context));
+  }
+}
+
+TEST_F(RingHashLoadBalancerTest, MaglevNoHostAndPanic) {
+  ON_CALL(runtime_.snapshot_, getInteger("upstream.ring_hash.use_maglev", _))
+      .WillByDefault(Return(1));
+  cluster_.runCallbacks({}, {});
+  EXPECT_EQ(nullptr, lb_.chooseHost(nullptr));
+
+  // With no healthy hosts we fall back to the all hosts table in panic mode.
+  cluster_.hosts_ = {makeTestHost(cluster_.info_, "tcp://127.0.0.1:80")};
+  cluster_.runCallbacks({}, {});
+  TestLoadBalancerContext context(0);
+  EXPECT_EQ(cluster_.hosts_[0], lb_.chooseHost(&context));
+  EXPECT_EQ(1UL, stats_.lb_healthy_panic_.value());
+}
+
 } // namespace Upstream
 } // namespace Envoy
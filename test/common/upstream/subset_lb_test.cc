@@ -0,0 +1,158 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/config/metadata.h"
+#include "common/config/well_known_names.h"
+#include "common/network/utility.h"
+#include "common/upstream/subset_lb.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Upstream {
+
+class TestLoadBalancerContext : public LoadBalancerContext {
+public:
+  TestLoadBalancerContext(const std::string& key, const std::string& value) {
+    ProtobufWkt::Value criteria_value;
+    criteria_value.set_string_value(value);
+    criteria_.push_back({key, criteria_value});
+  }
+
+  // Upstream::LoadBalancerContext
+  Optional<uint64_t> hashKey() const override { return {}; }
+  const Network::Connection* downstreamConnection() const override { return nullptr; }
+  const SubsetMetadataCriteria* metadataMatchCriteria() const override { return &criteria_; }
+
+  SubsetMetadataCriteria criteria_;
+};
+
+class SubsetLoadBalancerTest : public testing::Test {
+public:
+  SubsetLoadBalancerTest() : stats_(ClusterInfoImpl::generateStats(stats_store_)) {}
+
+  void init() {
+    lb_.reset(new SubsetLoadBalancer(LoadBalancerType::RoundRobin, cluster_, nullptr, stats_,
+                                     runtime_, random_, {"version"}));
+  }
+
+  HostSharedPtr makeHost(const std::string& url, const std::string& version) {
+    envoy::api::v2::Metadata metadata;
+    Config::Metadata::mutableMetadataValue(metadata, Config::MetadataFilters::get().ENVOY_LB,
+                                           "version")
+        .set_string_value(version);
+    return HostSharedPtr{
+        new HostImpl(cluster_.info_, "", Network::Utility::resolveUrl(url), metadata, 1, "")};
+  }
+
+  HostSharedPtr makeHostNoMetadata(const std::string& url) {
+    return HostSharedPtr{new HostImpl(cluster_.info_, "", Network::Utility::resolveUrl(url),
+                                      envoy::api::v2::Metadata::default_instance(), 1, "")};
+  }
+
+  NiceMock<MockCluster> cluster_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_;
+  std::shared_ptr<LoadBalancer> lb_;
+};
+
+TEST_F(SubsetLoadBalancerTest, NoHosts) {
+  init();
+  EXPECT_EQ(nullptr, lb_->chooseHost(nullptr));
+
+  TestLoadBalancerContext context("version", "1.0");
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context));
+}
+
+TEST_F(SubsetLoadBalancerTest, ChooseSubset) {
+  cluster_.hosts_ = {makeHost("tcp://127.0.0.1:80", "1.0"), makeHost("tcp://127.0.0.1:81", "1.0"),
+                     makeHost("tcp://127.0.0.1:82", "1.1")};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+  init();
+  cluster_.runCallbacks({}, {});
+
+  TestLoadBalancerContext context_10("version", "1.0");
+  TestLoadBalancerContext context_11("version", "1.1");
+
+  // The "1.1" subset has a single host, so every pick lands on it. The "1.0" subset cycles over
+  // its two hosts and never selects the "1.1" host.
+  EXPECT_EQ(cluster_.hosts_[2], lb_->chooseHost(&context_11));
+  EXPECT_EQ(cluster_.hosts_[2], lb_->chooseHost(&context_11));
+  for (uint64_t i = 0; i < 4; i++) {
+    HostConstSharedPtr host = lb_->chooseHost(&context_10);
+    EXPECT_TRUE(host == cluster_.hosts_[0] || host == cluster_.hosts_[1]);
+  }
+}
+
+TEST_F(SubsetLoadBalancerTest, FallbackOnNoCriteria) {
+  cluster_.hosts_ = {makeHost("tcp://127.0.0.1:80", "1.0")};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+  init();
+
+  // No context at all, and a context without criteria, both use the fallback balancer.
+  EXPECT_EQ(cluster_.hosts_[0], lb_->chooseHost(nullptr));
+
+  TestLoadBalancerContext context("version", "1.0");
+  context.criteria_.clear();
+  EXPECT_EQ(cluster_.hosts_[0], lb_->chooseHost(&context));
+}
+
+TEST_F(SubsetLoadBalancerTest, FallbackOnUnknownSubset) {
+  cluster_.hosts_ = {makeHost("tcp://127.0.0.1:80", "1.0")};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+  init();
+  cluster_.runCallbacks({}, {});
+
+  // No host carries version "2.0" and "stage" is not a configured subset key, so both requests
+  // fall back to all hosts.
+  TestLoadBalancerContext unknown_value("version", "2.0");
+  EXPECT_EQ(cluster_.hosts_[0], lb_->chooseHost(&unknown_value));
+
+  TestLoadBalancerContext unknown_key("stage", "prod");
+  EXPECT_EQ(cluster_.hosts_[0], lb_->chooseHost(&unknown_key));
+}
+
+TEST_F(SubsetLoadBalancerTest, HostWithoutMetadataExcludedFromSubsets) {
+  cluster_.hosts_ = {makeHost("tcp://127.0.0.1:80", "1.0"),
+                     makeHostNoMetadata("tcp://127.0.0.1:81")};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+  init();
+  cluster_.runCallbacks({}, {});
+
+  // The host without "envoy.lb" metadata only participates in fallback picks.
+  TestLoadBalancerContext context("version", "1.0");
+  EXPECT_EQ(cluster_.hosts_[0], lb_->chooseHost(&context));
+  EXPECT_EQ(cluster_.hosts_[0], lb_->chooseHost(&context));
+}
+
+TEST_F(SubsetLoadBalancerTest, UpdateMembership) {
+  cluster_.hosts_ = {makeHost("tcp://127.0.0.1:80", "1.0"), makeHost("tcp://127.0.0.1:81", "1.1")};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+  init();
+  cluster_.runCallbacks({}, {});
+
+  TestLoadBalancerContext context_11("version", "1.1");
+  EXPECT_EQ(cluster_.hosts_[1], lb_->chooseHost(&context_11));
+
+  // Swap the "1.1" host for a new one; the subset is rebuilt on the membership update.
+  HostSharedPtr removed_host = cluster_.hosts_[1];
+  HostSharedPtr added_host = makeHost("tcp://127.0.0.1:82", "1.1");
+  cluster_.hosts_ = {cluster_.hosts_[0], added_host};
+  cluster_.healthy_hosts_ = cluster_.hosts_;
+  cluster_.runCallbacks({added_host}, {removed_host});
+
+  EXPECT_EQ(added_host, lb_->chooseHost(&context_11));
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -265,6 +265,20 @@ TEST(HostImplTest, HostCluster) {
   EXPECT_EQ("", host->zone());
 }
 
+TEST(HostImplTest, LazyStats) {
+  MockCluster cluster;
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", 1);
+
+  // No stats exist until the first stats() access creates the full set.
+  EXPECT_TRUE(host->counters().empty());
+  EXPECT_TRUE(host->gauges().empty());
+
+  host->stats().rq_total_.inc();
+  EXPECT_EQ(1UL, host->stats().rq_total_.value());
+  EXPECT_FALSE(host->counters().empty());
+  EXPECT_FALSE(host->gauges().empty());
+}
+
 TEST(HostImplTest, Weight) {
   MockCluster cluster;
 
@@ -6,6 +6,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "envoy/server/options.h"
 
@@ -42,6 +43,14 @@ public:
   spdlog::level::level_enum logLevel() override { NOT_IMPLEMENTED; }
   std::chrono::seconds parentShutdownTime() override { return std::chrono::seconds(2); }
   uint64_t restartEpoch() override { return 0; }
+  bool reusePort() override { return false; }
+  uint32_t tcpFastOpenQueueLength() override { return 0; }
+  uint32_t deferAcceptTimeoutSeconds() override { return 0; }
+  bool exactConnectionBalance() override { return false; }
+  uint32_t maxAcceptsPerSecond() override { return 0; }
+  uint64_t maxConnections() override { return 0; }
+  bool dedicatedHealthCheckThread() override { return false; }
+  const std::vector<uint32_t>& workerCpuAffinity() override { return worker_cpu_affinity_; }
   std::chrono::milliseconds fileFlushIntervalMsec() override {
     return std::chrono::milliseconds(10000);
   }
@@ -57,6 +66,7 @@ private:
   const std::string service_cluster_name_;
   const std::string service_node_name_;
   const std::string service_zone_;
+  const std::vector<uint32_t> worker_cpu_affinity_;
 };
 
 class TestDrainManager : public DrainManager {
@@ -163,6 +173,10 @@ public:
     std::unique_lock<std::mutex> lock(lock_);
     return store_.gauges();
   }
+  std::list<HistogramSharedPtr> histograms() const override {
+    std::unique_lock<std::mutex> lock(lock_);
+    return store_.histograms();
+  }
 
   // Stats::StoreRoot
   void addSink(Sink&) override {}
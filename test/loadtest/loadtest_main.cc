@@ -0,0 +1,394 @@
+// Standalone load generation harness. Stands up the real server with an integration test config,
+// fronts it with a canned-response HTTP/1.1 upstream, and drives open-loop load at a fixed request
+// rate while recording end-to-end latency. Results are printed as a single JSON object so CI can
+// parse them and gate on p99 latency or requests-per-second regressions. Run it with, e.g.:
+//
+//   bazel run -c opt //test/loadtest:http1_loadtest -- --rps 5000 --duration 10
+//
+// The send rate is open loop: requests are paced by the clock, not by responses, so a slow server
+// shows up as growing latency instead of a silently reduced request rate.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/api/api_impl.h"
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/event/libevent.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/utility.h"
+
+#include "server/connection_handler_impl.h"
+
+#include "test/integration/server.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "fmt/format.h"
+#include "spdlog/spdlog.h"
+
+namespace Envoy {
+namespace {
+
+// Counts complete HTTP/1.1 header blocks ("\r\n\r\n" terminators) across arbitrarily fragmented
+// buffers. Both the canned upstream and the load client exchange body-less messages only, so
+// terminator counting is a complete message framing.
+struct MessageCounter {
+  uint64_t count(const Buffer::Instance& data) {
+    static const char needle[] = "\r\n\r\n";
+    uint64_t messages = 0;
+    const uint64_t num_slices = data.getRawSlices(nullptr, 0);
+    std::vector<Buffer::RawSlice> slices(num_slices);
+    data.getRawSlices(&slices[0], num_slices);
+    for (const Buffer::RawSlice& slice : slices) {
+      const char* bytes = static_cast<const char*>(slice.mem_);
+      for (uint64_t i = 0; i < slice.len_; i++) {
+        if (bytes[i] == needle[match_]) {
+          if (++match_ == 4) {
+            match_ = 0;
+            messages++;
+          }
+        } else {
+          match_ = bytes[i] == '\r' ? 1 : 0;
+        }
+      }
+    }
+    return messages;
+  }
+
+  size_t match_{};
+};
+
+/**
+ * Minimal upstream that answers every request with a canned body-less 200 response. It skips
+ * the HTTP codecs entirely so that upstream processing cost does not pollute the measurement of
+ * the server under test.
+ */
+class CannedResponseUpstream : Logger::Loggable<Logger::Id::testing>,
+                               public Network::FilterChainFactory {
+public:
+  CannedResponseUpstream(Network::Address::IpVersion version)
+      : socket_(new Network::TcpListenSocket(
+            Network::Utility::parseInternetAddressAndPort(
+                fmt::format("{}:0", Network::Test::getAnyAddressUrlString(version))),
+            true)),
+        api_(new Api::Impl(std::chrono::milliseconds(10000))),
+        dispatcher_(api_->allocateDispatcher()),
+        handler_(new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_)) {
+    thread_.reset(new Thread::Thread([this]() -> void { threadRoutine(); }));
+    initialized_.waitReady();
+  }
+
+  ~CannedResponseUpstream() {
+    dispatcher_->exit();
+    thread_->join();
+  }
+
+  uint32_t port() { return socket_->localAddress()->ip()->port(); }
+
+  // Network::FilterChainFactory
+  bool createFilterChain(Network::Connection& connection) override {
+    connection.addReadFilter(Network::ReadFilterSharedPtr{new ResponderFilter()});
+    return true;
+  }
+
+private:
+  struct ResponderFilter : public Network::ReadFilterBaseImpl {
+    Network::FilterStatus onData(Buffer::Instance& data) override {
+      const uint64_t requests = counter_.count(data);
+      data.drain(data.length());
+      if (requests > 0) {
+        static const std::string response = "HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n";
+        Buffer::OwnedImpl buffer;
+        for (uint64_t i = 0; i < requests; i++) {
+          buffer.add(response);
+        }
+        read_callbacks_->connection().write(buffer);
+      }
+      return Network::FilterStatus::StopIteration;
+    }
+
+    MessageCounter counter_;
+  };
+
+  void threadRoutine() {
+    handler_->addListener(*this, *socket_, stats_store_, 0,
+                          Network::ListenerOptions::listenerOptionsWithBindToPort());
+    initialized_.setReady();
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    handler_.reset();
+  }
+
+  Network::ListenSocketPtr socket_;
+  ConditionalInitializer initialized_;
+  Thread::ThreadPtr thread_;
+  Stats::IsolatedStoreImpl stats_store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  Network::ConnectionHandlerPtr handler_;
+};
+
+/**
+ * Open-loop HTTP/1.1 load client. Paces requests by the clock across a fixed set of pipelined
+ * connections and records per-request latency; since HTTP/1.1 responses come back in order,
+ * latency is matched by pairing each complete response with the oldest outstanding send time on
+ * its connection.
+ */
+class LoadGenerator {
+public:
+  LoadGenerator(uint32_t port, Network::Address::IpVersion version, uint64_t num_connections,
+                uint64_t target_rps, std::chrono::seconds duration)
+      : port_(port), version_(version), target_rps_(target_rps), duration_(duration),
+        api_(new Api::Impl(std::chrono::milliseconds(10000))),
+        dispatcher_(api_->allocateDispatcher()) {
+    samples_.reserve(target_rps * (duration.count() + 1));
+    for (uint64_t i = 0; i < num_connections; i++) {
+      connections_.emplace_back(new Connection(*this));
+    }
+  }
+
+  void run() {
+    for (ConnectionPtr& connection : connections_) {
+      connection->connect(*dispatcher_, port_, version_);
+    }
+
+    tick_timer_ = dispatcher_->createTimer([this]() -> void { onTick(); });
+    start_time_ = std::chrono::steady_clock::now();
+    onTick();
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    elapsed_ = std::chrono::steady_clock::now() - start_time_;
+
+    for (ConnectionPtr& connection : connections_) {
+      connection->close();
+    }
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  std::string resultsJson() {
+    std::sort(samples_.begin(), samples_.end());
+    const double elapsed_s =
+        std::chrono::duration_cast<std::chrono::duration<double>>(elapsed_).count();
+    return fmt::format("{{\"target_rps\": {}, \"achieved_rps\": {:.1f}, \"requests\": {}, "
+                       "\"responses\": {}, \"errors\": {}, \"duration_s\": {:.3f}, "
+                       "\"p50_us\": {}, \"p90_us\": {}, \"p99_us\": {}, \"p999_us\": {}, "
+                       "\"max_us\": {}}}",
+                       target_rps_, elapsed_s > 0 ? samples_.size() / elapsed_s : 0,
+                       requests_sent_, samples_.size(), errors_, elapsed_s, percentile(0.5),
+                       percentile(0.9), percentile(0.99), percentile(0.999), percentile(1));
+  }
+
+private:
+  struct Connection;
+  typedef std::unique_ptr<Connection> ConnectionPtr;
+
+  struct Connection : public Network::ReadFilterBaseImpl, public Network::ConnectionCallbacks {
+    Connection(LoadGenerator& parent) : parent_(parent) {}
+
+    void connect(Event::Dispatcher& dispatcher, uint32_t port,
+                 Network::Address::IpVersion version) {
+      connection_ = dispatcher.createClientConnection(
+          Network::Utility::resolveUrl(fmt::format(
+              "tcp://{}:{}", Network::Test::getLoopbackAddressUrlString(version), port)),
+          Network::Address::InstanceConstSharedPtr());
+      connection_->addReadFilter(Network::ReadFilterSharedPtr{this, [](Network::ReadFilter*) {}});
+      connection_->addConnectionCallbacks(*this);
+      connection_->noDelay(true);
+      connection_->connect();
+    }
+
+    void send(const std::string& request, MonotonicTime now) {
+      Buffer::OwnedImpl buffer(request);
+      connection_->write(buffer);
+      in_flight_.push_back(now);
+    }
+
+    void close() {
+      if (!closed_) {
+        connection_->close(Network::ConnectionCloseType::NoFlush);
+      }
+    }
+
+    // Network::ReadFilter
+    Network::FilterStatus onData(Buffer::Instance& data) override {
+      const uint64_t responses = counter_.count(data);
+      data.drain(data.length());
+      const MonotonicTime now = std::chrono::steady_clock::now();
+      for (uint64_t i = 0; i < responses && !in_flight_.empty(); i++) {
+        parent_.recordLatency(now - in_flight_.front());
+        in_flight_.pop_front();
+      }
+      return Network::FilterStatus::StopIteration;
+    }
+
+    // Network::ConnectionCallbacks
+    void onEvent(Network::ConnectionEvent event) override {
+      if (event == Network::ConnectionEvent::RemoteClose ||
+          event == Network::ConnectionEvent::LocalClose) {
+        closed_ = true;
+        parent_.errors_ += in_flight_.size();
+        in_flight_.clear();
+      }
+    }
+    void onAboveWriteBufferHighWatermark() override {}
+    void onBelowWriteBufferLowWatermark() override {}
+
+    LoadGenerator& parent_;
+    Network::ClientConnectionPtr connection_;
+    std::deque<MonotonicTime> in_flight_;
+    MessageCounter counter_;
+    bool closed_{};
+  };
+
+  void onTick() {
+    const MonotonicTime now = std::chrono::steady_clock::now();
+    if (now - start_time_ >= duration_) {
+      // Stop sending and give outstanding requests a short grace period to complete.
+      if (outstanding() == 0 || now - start_time_ >= duration_ + std::chrono::seconds(1)) {
+        dispatcher_->exit();
+        return;
+      }
+      tick_timer_->enableTimer(std::chrono::milliseconds(1));
+      return;
+    }
+
+    // Open loop: the number of requests due depends only on elapsed time.
+    const uint64_t due =
+        target_rps_ *
+            std::chrono::duration_cast<std::chrono::microseconds>(now - start_time_).count() /
+            1000000 -
+        requests_sent_;
+    static const std::string request = "GET /test/long/url HTTP/1.1\r\nhost: host\r\n\r\n";
+    for (uint64_t i = 0; i < due; i++) {
+      Connection& connection = *connections_[next_connection_++ % connections_.size()];
+      if (!connection.closed_) {
+        connection.send(request, now);
+      } else {
+        errors_++;
+      }
+      requests_sent_++;
+    }
+    tick_timer_->enableTimer(std::chrono::milliseconds(1));
+  }
+
+  uint64_t outstanding() {
+    uint64_t total = 0;
+    for (ConnectionPtr& connection : connections_) {
+      total += connection->in_flight_.size();
+    }
+    return total;
+  }
+
+  void recordLatency(std::chrono::steady_clock::duration latency) {
+    samples_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  }
+
+  uint64_t percentile(double q) {
+    if (samples_.empty()) {
+      return 0;
+    }
+    const size_t index = std::min(samples_.size() - 1, static_cast<size_t>(samples_.size() * q));
+    return samples_[index];
+  }
+
+  const uint32_t port_;
+  const Network::Address::IpVersion version_;
+  const uint64_t target_rps_;
+  const std::chrono::seconds duration_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  std::vector<ConnectionPtr> connections_;
+  Event::TimerPtr tick_timer_;
+  MonotonicTime start_time_;
+  std::chrono::steady_clock::duration elapsed_{};
+  uint64_t requests_sent_{};
+  uint64_t next_connection_{};
+  uint64_t errors_{};
+  std::vector<uint64_t> samples_;
+};
+
+} // namespace
+} // namespace Envoy
+
+// NOLINT(namespace-envoy)
+int main(int argc, char** argv) {
+  uint64_t rps = 1000;
+  uint64_t connections = 4;
+  uint64_t duration_s = 5;
+  std::string config = "test/config/integration/server.json";
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string flag = argv[i];
+    const std::string value = argv[i + 1];
+    if (flag == "--rps") {
+      rps = std::stoull(value);
+    } else if (flag == "--connections") {
+      connections = std::stoull(value);
+    } else if (flag == "--duration") {
+      duration_s = std::stoull(value);
+    } else if (flag == "--config") {
+      config = value;
+    } else {
+      std::cerr << "usage: loadtest [--rps n] [--connections n] [--duration seconds] "
+                   "[--config path]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  // Provide the bazel test environment variables the integration server machinery expects when
+  // running outside of bazel test (e.g. bazel run).
+  if (::getenv("TEST_TMPDIR") == nullptr) {
+    char tmpdir[] = "/tmp/envoy_loadtest.XXXXXX";
+    RELEASE_ASSERT(::mkdtemp(tmpdir) != nullptr);
+    ::setenv("TEST_TMPDIR", tmpdir, 1);
+  }
+  if (::getenv("TEST_RUNDIR") == nullptr) {
+    if (::getenv("TEST_SRCDIR") != nullptr && ::getenv("TEST_WORKSPACE") != nullptr) {
+      ::setenv("TEST_RUNDIR",
+               (Envoy::TestEnvironment::getCheckedEnvVar("TEST_SRCDIR") + "/" +
+                Envoy::TestEnvironment::getCheckedEnvVar("TEST_WORKSPACE"))
+                   .c_str(),
+               1);
+    } else {
+      // bazel run executes binaries in their runfiles directory.
+      ::setenv("TEST_RUNDIR", ".", 1);
+    }
+  }
+
+  Envoy::Event::Libevent::Global::initialize();
+  Envoy::Thread::MutexBasicLockable log_lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn, log_lock);
+
+  const Envoy::Network::Address::IpVersion version = Envoy::Network::Address::IpVersion::v4;
+  Envoy::CannedResponseUpstream upstream(version);
+  Envoy::TestEnvironment::PortMap port_map;
+  port_map["upstream_0"] = upstream.port();
+  port_map["upstream_1"] = upstream.port();
+
+  Envoy::IntegrationTestServerPtr server = Envoy::IntegrationTestServer::create(
+      Envoy::TestEnvironment::temporaryFileSubstitute(config, port_map, version), version);
+  const uint32_t http_port = server->server()
+                                 .listenerManager()
+                                 .listeners()[0]
+                                 .get()
+                                 .socket()
+                                 .localAddress()
+                                 ->ip()
+                                 ->port();
+
+  Envoy::LoadGenerator generator(http_port, version, connections, rps,
+                                 std::chrono::seconds(duration_s));
+  generator.run();
+  std::cout << generator.resultsJson() << std::endl;
+  return 0;
+}
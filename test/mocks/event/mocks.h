@@ -79,6 +79,12 @@ public:
   }
 
   // Event::Dispatcher
+  // Real clock reads rather than mocks so that durations computed from these in tests behave
+  // like production.
+  MonotonicTime approximateMonotonicTime() const override {
+    return std::chrono::steady_clock::now();
+  }
+  SystemTime approximateSystemTime() const override { return std::chrono::system_clock::now(); }
   MOCK_METHOD0(clearDeferredDeleteList, void());
   MOCK_METHOD2(createClientConnection_,
                Network::ClientConnection*(Network::Address::InstanceConstSharedPtr address,
@@ -106,6 +112,7 @@ public:
   MOCK_METHOD1(createTimer_, Timer*(TimerCb cb));
   MOCK_METHOD1(deferredDelete_, void(DeferredDeletablePtr& to_delete));
   MOCK_METHOD0(exit, void());
+  MOCK_METHOD1(initializeStats, void(Stats::Scope& scope));
   MOCK_METHOD2(listenForSignal_, SignalEvent*(int signal_num, SignalCb cb));
   MOCK_METHOD1(post, void(std::function<void()> callback));
   MOCK_METHOD1(run, void(RunType type));
@@ -29,6 +29,16 @@ ssize_t MockOsSysCalls::write(int fd, const void* buffer, size_t num_bytes) {
   return result;
 }
 
+ssize_t MockOsSysCalls::writev(int fd, const iovec* iov, int num_iov) {
+  std::unique_lock<Thread::BasicLockable> lock(write_mutex_);
+
+  ssize_t result = writev_(fd, iov, num_iov);
+  num_writes_++;
+  write_event_.notify_one();
+
+  return result;
+}
+
 MockFile::MockFile() {}
 MockFile::~MockFile() {}
 
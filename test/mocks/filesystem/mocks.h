@@ -20,11 +20,13 @@ public:
 
   // Filesystem::OsSysCalls
   ssize_t write(int fd, const void* buffer, size_t num_bytes) override;
+  ssize_t writev(int fd, const iovec* iov, int num_iov) override;
   int open(const std::string& full_path, int flags, int mode) override;
   MOCK_METHOD1(close, int(int));
 
   MOCK_METHOD3(open_, int(const std::string& full_path, int flags, int mode));
   MOCK_METHOD3(write_, ssize_t(int, const void*, size_t));
+  MOCK_METHOD3(writev_, ssize_t(int, const iovec*, int));
 
   size_t num_writes_;
   size_t num_open_;
@@ -41,6 +43,7 @@ public:
 
   // Filesystem::File
   MOCK_METHOD1(write, void(const std::string& data));
+  MOCK_METHOD2(write, void(const std::string& data, WriteCompletionCb cb));
   MOCK_METHOD0(reopen, void());
 };
 
@@ -80,6 +80,7 @@ template <class T> static void initializeMockStreamFilterCallbacks(T& callbacks)
 MockStreamDecoderFilterCallbacks::MockStreamDecoderFilterCallbacks() {
   initializeMockStreamFilterCallbacks(*this);
   ON_CALL(*this, decodingBuffer()).WillByDefault(Return(buffer_.get()));
+  ON_CALL(*this, queryParams()).WillByDefault(ReturnRef(query_params_));
 
   ON_CALL(*this, addDownstreamWatermarkCallbacks(_))
       .WillByDefault(Invoke([this](DownstreamWatermarkCallbacks& callbacks) -> void {
@@ -52,6 +52,8 @@ public:
   MOCK_METHOD1(requestReceivedDuration, void(MonotonicTime time));
   MOCK_CONST_METHOD0(responseReceivedDuration, std::chrono::microseconds());
   MOCK_METHOD1(responseReceivedDuration, void(MonotonicTime time));
+  MOCK_METHOD2(markPhase, void(RequestPhase phase, MonotonicTime time));
+  MOCK_CONST_METHOD1(phaseDuration, std::chrono::microseconds(RequestPhase phase));
   MOCK_CONST_METHOD0(bytesReceived, uint64_t());
   MOCK_CONST_METHOD0(protocol, Protocol());
   MOCK_METHOD1(protocol, void(Protocol protocol));
@@ -266,6 +268,7 @@ public:
   MOCK_METHOD1(removeDownstreamWatermarkCallbacks, void(DownstreamWatermarkCallbacks&));
   MOCK_METHOD1(setDecoderBufferLimit, void(uint32_t));
   MOCK_METHOD0(decoderBufferLimit, uint32_t());
+  MOCK_METHOD0(queryParams, const QueryParams&());
 
   // Http::StreamDecoderFilterCallbacks
   void encodeHeaders(HeaderMapPtr&& headers, bool end_stream) override {
@@ -282,6 +285,7 @@ public:
 
   Buffer::InstancePtr buffer_;
   std::list<DownstreamWatermarkCallbacks*> callbacks_{};
+  QueryParams query_params_;
 };
 
 class MockStreamEncoderFilterCallbacks : public StreamEncoderFilterCallbacks,
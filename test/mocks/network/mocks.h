@@ -55,6 +55,7 @@ public:
   MOCK_METHOD1(addReadFilter, void(ReadFilterSharedPtr filter));
   MOCK_METHOD1(close, void(ConnectionCloseType type));
   MOCK_METHOD0(dispatcher, Event::Dispatcher&());
+  MOCK_METHOD0(fd, int());
   MOCK_CONST_METHOD0(id, uint64_t());
   MOCK_METHOD0(initializeReadFilters, bool());
   MOCK_CONST_METHOD0(nextProtocol, std::string());
@@ -73,6 +74,8 @@ public:
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
   MOCK_CONST_METHOD0(usingOriginalDst, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
+  MOCK_METHOD1(setMigratable, void(bool migratable));
+  MOCK_METHOD0(detachFd, int());
 };
 
 /**
@@ -91,6 +94,7 @@ public:
   MOCK_METHOD1(addReadFilter, void(ReadFilterSharedPtr filter));
   MOCK_METHOD1(close, void(ConnectionCloseType type));
   MOCK_METHOD0(dispatcher, Event::Dispatcher&());
+  MOCK_METHOD0(fd, int());
   MOCK_CONST_METHOD0(id, uint64_t());
   MOCK_METHOD0(initializeReadFilters, bool());
   MOCK_CONST_METHOD0(nextProtocol, std::string());
@@ -109,6 +113,8 @@ public:
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
   MOCK_CONST_METHOD0(usingOriginalDst, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
+  MOCK_METHOD1(setMigratable, void(bool migratable));
+  MOCK_METHOD0(detachFd, int());
 
   // Network::ClientConnection
   MOCK_METHOD0(connect, void());
@@ -226,6 +232,8 @@ public:
   ~MockListener();
 
   MOCK_METHOD0(onDestroy, void());
+  MOCK_METHOD0(disable, void());
+  MOCK_METHOD0(enable, void());
 };
 
 class MockConnectionHandler : public ConnectionHandler {
@@ -247,6 +255,8 @@ public:
   MOCK_METHOD1(removeListeners, void(uint64_t listener_tag));
   MOCK_METHOD1(stopListeners, void(uint64_t listener_tag));
   MOCK_METHOD0(stopListeners, void());
+  MOCK_METHOD0(disableListeners, void());
+  MOCK_METHOD0(enableListeners, void());
 };
 
 } // namespace Network
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "envoy/redis/command_splitter.h"
 #include "envoy/redis/conn_pool.h"
@@ -35,6 +36,7 @@ public:
   ~MockDecoder();
 
   MOCK_METHOD1(decode, void(Buffer::Instance& data));
+  void recycle(RespValuePtr&&) override {}
 };
 
 namespace ConnPool {
@@ -81,8 +83,22 @@ public:
   MockInstance();
   ~MockInstance();
 
+  // Fan the batch back out through makeRequest() so tests can set per-fragment expectations.
+  std::vector<PoolRequest*> makeRequests(const std::vector<RequestFragment>& fragments) override {
+    std::vector<PoolRequest*> handles;
+    handles.reserve(fragments.size());
+    for (const RequestFragment& fragment : fragments) {
+      handles.push_back(makeRequest(fragment.hash_key_, fragment.request_, fragment.callbacks_));
+    }
+    return handles;
+  }
+
   MOCK_METHOD3(makeRequest, PoolRequest*(const std::string& hash_key, const RespValue& request,
                                          PoolCallbacks& callbacks));
+  MOCK_METHOD4(makeRequestToHost,
+               PoolRequest*(const std::string& host_address, const RespValue& request,
+                            PoolCallbacks& callbacks, bool asking));
+  MOCK_METHOD2(updateSlotOwner, void(uint32_t slot, const std::string& host_address));
 };
 
 } // namespace ConnPool
@@ -22,6 +22,8 @@
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/http/codes.h"
+
 #include "gmock/gmock.h"
 
 namespace Envoy {
@@ -125,6 +127,16 @@ public:
   std::string runtime_key_;
 };
 
+class MockShadowStream : public ShadowStream {
+public:
+  MockShadowStream();
+  ~MockShadowStream();
+
+  // Router::ShadowStream
+  MOCK_METHOD2(writeData, void(const Buffer::Instance& data, bool end_stream));
+  MOCK_METHOD1(writeTrailers, void(const Http::HeaderMap& trailers));
+};
+
 class MockShadowWriter : public ShadowWriter {
 public:
   MockShadowWriter();
@@ -135,17 +147,32 @@ public:
               std::chrono::milliseconds timeout) override {
     shadow_(cluster, request, timeout);
   }
+  ShadowStreamPtr streamShadow(const std::string& cluster, Http::HeaderMapPtr&& headers,
+                               bool end_stream, std::chrono::milliseconds timeout) override {
+    return ShadowStreamPtr{streamShadow_(cluster, headers, end_stream, timeout)};
+  }
 
   MOCK_METHOD3(shadow_, void(const std::string& cluster, Http::MessagePtr& request,
                              std::chrono::milliseconds timeout));
+  MOCK_METHOD4(streamShadow_,
+               ShadowStream*(const std::string& cluster, Http::HeaderMapPtr& headers,
+                             bool end_stream, std::chrono::milliseconds timeout));
 };
 
 class TestVirtualCluster : public VirtualCluster {
 public:
   // Router::VirtualCluster
   const std::string& name() const override { return name_; }
+  void chargeResponseStat(Stats::Scope& scope, uint64_t response_code) const override {
+    stats_.get(scope).charge(response_code);
+  }
+  void chargeResponseTiming(Stats::Scope& scope,
+                            std::chrono::milliseconds response_time) const override {
+    stats_.get(scope).chargeTiming(response_time);
+  }
 
   std::string name_{"fake_virtual_cluster"};
+  mutable Http::LazyResponseCodeStats stats_{"vhost.fake_vhost.vcluster.fake_virtual_cluster."};
 };
 
 class MockVirtualHost : public VirtualHost {
@@ -179,6 +206,7 @@ public:
 
   // Router::Config
   MOCK_CONST_METHOD0(clusterName, const std::string&());
+  MOCK_CONST_METHOD0(clusterHandle, Optional<uint64_t>());
   MOCK_CONST_METHOD1(finalizeRequestHeaders, void(Http::HeaderMap& headers));
   MOCK_CONST_METHOD0(hashPolicy, const HashPolicy*());
   MOCK_CONST_METHOD0(priority, Upstream::ResourcePriority());
@@ -3,6 +3,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::Invoke;
 using testing::Return;
 using testing::ReturnArg;
 using testing::_;
@@ -14,11 +15,24 @@ MockRandomGenerator::MockRandomGenerator() { ON_CALL(*this, uuid()).WillByDefaul
 
 MockRandomGenerator::~MockRandomGenerator() {}
 
-MockSnapshot::MockSnapshot() { ON_CALL(*this, getInteger(_, _)).WillByDefault(ReturnArg<1>()); }
+MockSnapshot::MockSnapshot() {
+  ON_CALL(*this, getInteger(_, _)).WillByDefault(ReturnArg<1>());
+
+  // Default to "keys exist" so callers that use this as a fast path guard fall through to the
+  // full lookup path, which is what most tests want to exercise.
+  ON_CALL(*this, keysWithPrefixExist(_)).WillByDefault(Return(true));
+}
 
 MockSnapshot::~MockSnapshot() {}
 
-MockLoader::MockLoader() { ON_CALL(*this, snapshot()).WillByDefault(ReturnRef(snapshot_)); }
+MockLoader::MockLoader() {
+  ON_CALL(*this, snapshot()).WillByDefault(ReturnRef(snapshot_));
+  ON_CALL(*this, registerKey(_, _))
+      .WillByDefault(Invoke(
+          [this](const std::string& key, uint64_t default_value) -> KeyHandleConstSharedPtr {
+            return KeyHandleConstSharedPtr{new TestKeyHandle(snapshot_, key, default_value)};
+          }));
+}
 
 MockLoader::~MockLoader() {}
 
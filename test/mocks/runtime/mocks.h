@@ -32,15 +32,39 @@ public:
   MOCK_CONST_METHOD4(featureEnabled, bool(const std::string& key, uint64_t default_value,
                                           uint64_t random_value, uint16_t num_buckets));
   MOCK_CONST_METHOD1(get, const std::string&(const std::string& key));
+  MOCK_CONST_METHOD1(keysWithPrefixExist, bool(const std::string& prefix));
   MOCK_CONST_METHOD2(getInteger, uint64_t(const std::string& key, uint64_t default_value));
 };
 
+/**
+ * Key handle returned by MockLoader::registerKey() by default. Forwards reads to the mock's
+ * snapshot so existing featureEnabled()/getInteger() expectations keep working for callers that
+ * pre-resolve their keys.
+ */
+class TestKeyHandle : public KeyHandle {
+public:
+  TestKeyHandle(Snapshot& snapshot, const std::string& key, uint64_t default_value)
+      : snapshot_(snapshot), key_(key), default_value_(default_value) {}
+
+  // Runtime::KeyHandle
+  uint64_t getInteger() const override { return snapshot_.getInteger(key_, default_value_); }
+  bool featureEnabled() const override { return snapshot_.featureEnabled(key_, default_value_); }
+
+private:
+  Snapshot& snapshot_;
+  const std::string key_;
+  const uint64_t default_value_;
+};
+
 class MockLoader : public Loader {
 public:
   MockLoader();
   ~MockLoader();
 
   MOCK_METHOD0(snapshot, Snapshot&());
+  MOCK_METHOD1(mergeValues, void(const std::unordered_map<std::string, std::string>& values));
+  MOCK_METHOD2(registerKey,
+               KeyHandleConstSharedPtr(const std::string& key, uint64_t default_value));
 
   testing::NiceMock<MockSnapshot> snapshot_;
 };
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "envoy/server/admin.h"
 #include "envoy/server/configuration.h"
@@ -45,6 +46,7 @@ public:
 
   MOCK_METHOD0(baseId, uint64_t());
   MOCK_METHOD0(concurrency, uint32_t());
+  MOCK_METHOD0(workerCpuAffinity, const std::vector<uint32_t>&());
   MOCK_METHOD0(configPath, const std::string&());
   MOCK_METHOD0(adminAddressPath, const std::string&());
   MOCK_METHOD0(localAddressIpVersion, Network::Address::IpVersion());
@@ -52,6 +54,13 @@ public:
   MOCK_METHOD0(logLevel, spdlog::level::level_enum());
   MOCK_METHOD0(parentShutdownTime, std::chrono::seconds());
   MOCK_METHOD0(restartEpoch, uint64_t());
+  MOCK_METHOD0(reusePort, bool());
+  MOCK_METHOD0(tcpFastOpenQueueLength, uint32_t());
+  MOCK_METHOD0(deferAcceptTimeoutSeconds, uint32_t());
+  MOCK_METHOD0(exactConnectionBalance, bool());
+  MOCK_METHOD0(maxAcceptsPerSecond, uint32_t());
+  MOCK_METHOD0(maxConnections, uint64_t());
+  MOCK_METHOD0(dedicatedHealthCheckThread, bool());
   MOCK_METHOD0(fileFlushIntervalMsec, std::chrono::milliseconds());
   MOCK_CONST_METHOD0(mode, Mode());
   MOCK_METHOD0(serviceClusterName, const std::string&());
@@ -60,6 +69,7 @@ public:
 
   std::string config_path_;
   std::string admin_address_path_;
+  std::vector<uint32_t> worker_cpu_affinity_;
   std::string service_cluster_name_;
   std::string service_node_name_;
   std::string service_zone_name_;
@@ -124,6 +134,8 @@ public:
   MOCK_METHOD1(duplicateParentListenSocket, int(const std::string& address));
   MOCK_METHOD1(getParentStats, void(GetParentStatsInfo& info));
   MOCK_METHOD2(initialize, void(Event::Dispatcher& dispatcher, Server::Instance& server));
+  MOCK_METHOD3(passConnection, bool(int fd, const std::string& local_address,
+                                    const std::string& remote_address));
   MOCK_METHOD1(shutdownParentAdmin, void(ShutdownParentAdminInfo& info));
   MOCK_METHOD0(terminateParent, void());
   MOCK_METHOD0(shutdown, void());
@@ -156,6 +168,9 @@ public:
   ~MockListenerManager();
 
   MOCK_METHOD1(addOrUpdateListener, bool(const envoy::api::v2::Listener& config));
+  MOCK_METHOD3(adoptPassedConnection,
+               bool(int fd, Network::Address::InstanceConstSharedPtr local_address,
+                    Network::Address::InstanceConstSharedPtr remote_address));
   MOCK_METHOD0(listeners, std::vector<std::reference_wrapper<Listener>>());
   MOCK_METHOD0(numConnections, uint64_t());
   MOCK_METHOD1(removeListener, bool(const std::string& listener_name));
@@ -171,8 +186,12 @@ public:
 
   MOCK_METHOD0(filterChainFactory, Network::FilterChainFactory&());
   MOCK_METHOD0(socket, Network::ListenSocket&());
+  MOCK_METHOD1(socketForWorker, Network::ListenSocket&(uint32_t worker_index));
+  MOCK_METHOD0(connectionBalancer, Network::ConnectionBalancerSharedPtr());
+  MOCK_METHOD0(acceptRateLimiter, Network::AcceptRateLimiterSharedPtr());
   MOCK_METHOD0(sslContext, Ssl::ServerContext*());
   MOCK_METHOD0(useProxyProto, bool());
+  MOCK_METHOD0(deferAccept, bool());
   MOCK_METHOD0(bindToPort, bool());
   MOCK_METHOD0(useOriginalDst, bool());
   MOCK_METHOD0(perConnectionBufferLimitBytes, uint32_t());
@@ -216,6 +235,9 @@ public:
 
   // Server::Worker
   MOCK_METHOD2(addListener, void(Listener& listener, AddListenerCompletion completion));
+  MOCK_METHOD3(addPassedConnection,
+               void(int fd, Network::Address::InstanceConstSharedPtr local_address,
+                    Network::Address::InstanceConstSharedPtr remote_address));
   MOCK_METHOD0(numConnections, uint64_t());
   MOCK_METHOD2(removeListener, void(Listener& listener, std::function<void()> completion));
   MOCK_METHOD1(start, void(GuardDog& guard_dog));
@@ -11,7 +11,9 @@ namespace Stats {
 MockCounter::MockCounter() {}
 MockCounter::~MockCounter() {}
 
-MockGauge::MockGauge() {}
+MockGauge::MockGauge() {
+  ON_CALL(*this, latchDirty()).WillByDefault(testing::Return(true));
+}
 MockGauge::~MockGauge() {}
 
 MockTimespan::MockTimespan() {}
@@ -20,7 +22,10 @@ MockTimespan::~MockTimespan() {}
 MockSink::MockSink() {}
 MockSink::~MockSink() {}
 
-MockStore::MockStore() { ON_CALL(*this, counter(_)).WillByDefault(ReturnRef(counter_)); }
+MockStore::MockStore() {
+  ON_CALL(*this, counter(_)).WillByDefault(ReturnRef(counter_));
+  ON_CALL(*this, gauge(_)).WillByDefault(ReturnRef(gauge_));
+}
 MockStore::~MockStore() {}
 
 MockIsolatedStatsStore::MockIsolatedStatsStore() {}
@@ -50,7 +50,7 @@ public:
     }
 
     // ThreadLocal::Slot
-    ThreadLocalObjectSharedPtr get() override { return parent_.data_[index_]; }
+    ThreadLocalObject& get() override { return *parent_.data_[index_]; }
     void runOnAllThreads(Event::PostCb cb) override { parent_.runOnAllThreads(cb); }
     void set(InitializeCb cb) override { parent_.data_[index_] = cb(parent_.dispatcher_); }
 
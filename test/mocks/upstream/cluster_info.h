@@ -8,6 +8,8 @@
 #include "envoy/upstream/cluster_manager.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/http/codes.h"
+
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
 
@@ -35,6 +37,7 @@ public:
   MOCK_CONST_METHOD0(maxRequestsPerConnection, uint64_t());
   MOCK_CONST_METHOD0(name, const std::string&());
   MOCK_CONST_METHOD1(resourceManager, ResourceManager&(ResourcePriority priority));
+  MOCK_CONST_METHOD0(responseCodeStatFamily, Http::ResponseCodeStatFamily&());
   MOCK_CONST_METHOD0(sslContext, Ssl::ClientContext*());
   MOCK_CONST_METHOD0(stats, ClusterStats&());
   MOCK_CONST_METHOD0(statsScope, Stats::Scope&());
@@ -45,6 +48,7 @@ public:
   uint64_t max_requests_per_connection_{};
   NiceMock<Stats::MockIsolatedStatsStore> stats_store_;
   ClusterStats stats_;
+  Http::ResponseCodeStatFamily response_code_stat_family_{stats_store_, ""};
   NiceMock<Runtime::MockLoader> runtime_;
   std::unique_ptr<Upstream::ResourceManager> resource_manager_;
   Network::Address::InstanceConstSharedPtr source_address_;
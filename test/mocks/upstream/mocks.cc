@@ -72,6 +72,7 @@ MockClusterInfo::MockClusterInfo()
       .WillByDefault(ReturnPointee(&max_requests_per_connection_));
   ON_CALL(*this, stats()).WillByDefault(ReturnRef(stats_));
   ON_CALL(*this, statsScope()).WillByDefault(ReturnRef(stats_store_));
+  ON_CALL(*this, responseCodeStatFamily()).WillByDefault(ReturnRef(response_code_stat_family_));
   ON_CALL(*this, sourceAddress()).WillByDefault(ReturnRef(source_address_));
   ON_CALL(*this, resourceManager(_))
       .WillByDefault(Invoke(
@@ -122,6 +123,7 @@ MockClusterManager::MockClusterManager() {
   // Matches are LIFO so "" will match first.
   ON_CALL(*this, get(_)).WillByDefault(Return(&thread_local_cluster_));
   ON_CALL(*this, get("")).WillByDefault(Return(nullptr));
+  ON_CALL(*this, getByHandle(_)).WillByDefault(Return(&thread_local_cluster_));
 }
 
 MockClusterManager::~MockClusterManager() {}
@@ -103,6 +103,8 @@ public:
   MOCK_METHOD1(setInitializedCb, void(std::function<void()>));
   MOCK_METHOD0(clusters, ClusterInfoMap());
   MOCK_METHOD1(get, ThreadLocalCluster*(const std::string& cluster));
+  MOCK_METHOD1(clusterHandle, uint64_t(const std::string& cluster));
+  MOCK_METHOD1(getByHandle, ThreadLocalCluster*(uint64_t handle));
   MOCK_METHOD3(httpConnPoolForCluster,
                Http::ConnectionPool::Instance*(const std::string& cluster,
                                                ResourcePriority priority,
@@ -128,6 +130,7 @@ public:
   ~MockHealthChecker();
 
   MOCK_METHOD1(addHostCheckCompleteCb, void(HostStatusCb callback));
+  MOCK_METHOD0(shutdown, void());
   MOCK_METHOD0(start, void());
 
   void runCallbacks(Upstream::HostSharedPtr host, bool changed_state) {
@@ -38,7 +38,8 @@ TEST(HttpFilterConfigTest, BufferFilter) {
   std::string json_string = R"EOF(
   {
     "max_request_bytes" : 1028,
-    "max_request_time_s" : 2
+    "max_request_time_s" : 2,
+    "watermark_backpressure" : true
   }
   )EOF";
 
@@ -313,6 +314,37 @@ TEST(AccessLogConfigTest, FileAccessLogTest) {
   EXPECT_NE(nullptr, dynamic_cast<Http::AccessLog::FileAccessLog*>(instance.get()));
 }
 
+TEST(AccessLogConfigTest, BinaryFileAccessLogTest) {
+  auto factory = Registry::FactoryRegistry<AccessLogInstanceFactory>::getFactory(
+      Config::AccessLogNames::get().BINARY_FILE);
+  ASSERT_NE(nullptr, factory);
+
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  ASSERT_NE(nullptr, message);
+
+  envoy::api::v2::filter::FileAccessLog file_access_log;
+  file_access_log.set_path("/dev/null");
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  {
+    // The schema is required.
+    MessageUtil::jsonConvert(file_access_log, *message);
+    Http::AccessLog::FilterPtr filter;
+    EXPECT_THROW_WITH_MESSAGE(
+        factory->createAccessLogInstance(*message, std::move(filter), context), EnvoyException,
+        "binary file access log requires a format schema");
+  }
+
+  file_access_log.set_format("%START_TIME%%PROTOCOL%");
+  MessageUtil::jsonConvert(file_access_log, *message);
+
+  Http::AccessLog::FilterPtr filter;
+  Http::AccessLog::InstanceSharedPtr instance =
+      factory->createAccessLogInstance(*message, std::move(filter), context);
+  EXPECT_NE(nullptr, instance);
+  EXPECT_NE(nullptr, dynamic_cast<Http::AccessLog::FileAccessLog*>(instance.get()));
+}
+
 } // namespace Configuration
 } // namespace Server
 } // namespace Envoy
@@ -187,6 +187,13 @@ TEST(HttpConnectionManagerConfigUtilityTest, DetermineNextProtocol) {
     Buffer::OwnedImpl data("PRI * HTTP/");
     EXPECT_EQ("", HttpConnectionManagerConfigUtility::determineNextProtocol(connection, data));
   }
+
+  {
+    Network::MockConnection connection;
+    EXPECT_CALL(connection, nextProtocol()).WillRepeatedly(Return(""));
+    Buffer::OwnedImpl data("POST / HTTP/1.1\r\n\r\nPRI * HTTP/2");
+    EXPECT_EQ("", HttpConnectionManagerConfigUtility::determineNextProtocol(connection, data));
+  }
 }
 
 } // namespace
@@ -33,6 +33,20 @@ TEST_P(ValidationServerTest, Validate) {
       validateConfig(options_, Network::Address::InstanceConstSharedPtr(), component_factory_));
 }
 
+TEST_P(ValidationServerTest, SectionTimings) {
+  Thread::MutexBasicLockable access_log_lock;
+  Stats::IsolatedStoreImpl stats_store;
+  ValidationInstance server(options_, Network::Address::InstanceConstSharedPtr(), stats_store,
+                            access_log_lock, component_factory_);
+
+  // Every config has at least the bootstrap, runtime, and main configuration sections, and the
+  // bootstrap load always completes first.
+  ASSERT_LE(3U, server.timings().size());
+  EXPECT_EQ("bootstrap", server.timings().front().name_);
+  EXPECT_EQ("configuration", server.timings().back().name_);
+  server.shutdown();
+}
+
 // TODO(rlazarus): We'd like use this setup to replace //test/config_test (that is, run it against
 // all the example configs) but can't until light validation is implemented, mocking out access to
 // the filesystem for TLS certs, etc. In the meantime, these are the example configs that work
@@ -0,0 +1,89 @@
+#include "server/connection_budget.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Server {
+
+TEST(ConnectionBudgetTest, CapEnforced) {
+  ConnectionBudget budget(2);
+  ConnectionBudget::Client client(&budget);
+
+  EXPECT_TRUE(client.tryAcquire());
+  EXPECT_TRUE(client.tryAcquire());
+  EXPECT_FALSE(client.tryAcquire());
+
+  client.release();
+  EXPECT_TRUE(client.tryAcquire());
+  EXPECT_FALSE(client.tryAcquire());
+}
+
+TEST(ConnectionBudgetTest, ZeroMeansUnlimited) {
+  ConnectionBudget budget(0);
+  ConnectionBudget::Client client(&budget);
+
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(client.tryAcquire());
+  }
+  EXPECT_EQ(0UL, budget.remaining());
+}
+
+TEST(ConnectionBudgetTest, NullBudgetAlwaysGrants) {
+  ConnectionBudget::Client client(nullptr);
+  EXPECT_TRUE(client.tryAcquire());
+  client.release();
+}
+
+TEST(ConnectionBudgetTest, PermitsSharedAcrossClients) {
+  ConnectionBudget budget(100);
+  ConnectionBudget::Client worker1(&budget);
+  ConnectionBudget::Client worker2(&budget);
+
+  for (int i = 0; i < 60; i++) {
+    EXPECT_TRUE(worker1.tryAcquire());
+  }
+  for (int i = 0; i < 36; i++) {
+    EXPECT_TRUE(worker2.tryAcquire());
+  }
+
+  // 96 permits are spent; worker1 still holds 4 unspent permits in its local block.
+  EXPECT_TRUE(worker1.tryAcquire());
+  EXPECT_TRUE(worker1.tryAcquire());
+  EXPECT_TRUE(worker1.tryAcquire());
+  EXPECT_TRUE(worker1.tryAcquire());
+  EXPECT_FALSE(worker1.tryAcquire());
+  EXPECT_FALSE(worker2.tryAcquire());
+}
+
+TEST(ConnectionBudgetTest, DestructionReturnsLocalBlock) {
+  ConnectionBudget budget(100);
+  {
+    ConnectionBudget::Client client(&budget);
+    // Drawing the first permit moves a whole block out of the shared budget.
+    EXPECT_TRUE(client.tryAcquire());
+    EXPECT_EQ(36UL, budget.remaining());
+    client.release();
+  }
+  EXPECT_EQ(100UL, budget.remaining());
+}
+
+TEST(ConnectionBudgetTest, ReleaseReturnsSurplusBlocks) {
+  ConnectionBudget budget(500);
+  ConnectionBudget::Client worker1(&budget);
+  ConnectionBudget::Client worker2(&budget);
+
+  for (int i = 0; i < 500; i++) {
+    EXPECT_TRUE(worker1.tryAcquire());
+  }
+  EXPECT_FALSE(worker2.tryAcquire());
+
+  // As worker1's connections drain, surplus blocks flow back to the shared budget rather than
+  // being stranded in its local block.
+  for (int i = 0; i < 500; i++) {
+    worker1.release();
+  }
+  EXPECT_TRUE(worker2.tryAcquire());
+}
+
+} // namespace Server
+} // namespace Envoy
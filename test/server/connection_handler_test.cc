@@ -1,3 +1,5 @@
+#include <sys/socket.h>
+
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
 #include "common/stats/stats_impl.h"
@@ -15,6 +17,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnRef;
 using testing::_;
 
 namespace Envoy {
@@ -96,6 +99,66 @@ TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
   handler_.reset();
 }
 
+TEST_F(ConnectionHandlerTest, PassMigratableConnectionsOnDestroy) {
+  InSequence s;
+
+  int passed_fd = -1;
+  std::string passed_local;
+  std::string passed_remote;
+  handler_.reset(new ConnectionHandlerImpl(
+      ENVOY_LOGGER(), dispatcher_,
+      [&](int fd, const Network::Address::Instance& local_address,
+          const Network::Address::Instance& remote_address) -> bool {
+        passed_fd = fd;
+        passed_local = local_address.asString();
+        passed_remote = remote_address.asString();
+        return true;
+      }));
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::ConnectionHandler&, Network::ListenSocket&,
+                           Network::ListenerCallbacks& cb, Stats::Scope&,
+                           const Network::ListenerOptions&) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+
+      }));
+  handler_->addListener(factory_, socket_, stats_store_, 1,
+                        Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  // The first connection refuses to detach (default detachFd() returns -1) and must be closed.
+  Network::MockConnection* pinned_connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(factory_, createFilterChain(_)).WillOnce(Return(true));
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{pinned_connection});
+
+  // The second connection hands over a real fd, since the handler closes its copy after passing.
+  Network::Address::Ipv4Instance local_address("127.0.0.1", 80);
+  Network::Address::Ipv4Instance remote_address("127.0.0.1", 40000);
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  Network::MockConnection* migratable_connection = new NiceMock<Network::MockConnection>();
+  ON_CALL(*migratable_connection, localAddress()).WillByDefault(ReturnRef(local_address));
+  ON_CALL(*migratable_connection, remoteAddress()).WillByDefault(ReturnRef(remote_address));
+  EXPECT_CALL(factory_, createFilterChain(_)).WillOnce(Return(true));
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{migratable_connection});
+  EXPECT_EQ(2UL, handler_->numConnections());
+
+  EXPECT_CALL(*migratable_connection, detachFd()).WillOnce(Invoke([&]() -> int {
+    migratable_connection->raiseEvent(Network::ConnectionEvent::LocalClose);
+    return fd;
+  }));
+  EXPECT_CALL(*pinned_connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(dispatcher_, clearDeferredDeleteList());
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+
+  EXPECT_EQ(fd, passed_fd);
+  EXPECT_EQ("127.0.0.1:80", passed_local);
+  EXPECT_EQ("127.0.0.1:40000", passed_remote);
+  EXPECT_EQ(1UL, stats_store_.counter("downstream_cx_migrated").value());
+}
+
 TEST_F(ConnectionHandlerTest, CloseDuringFilterChainCreate) {
   InSequence s;
 
@@ -215,5 +278,73 @@ TEST_F(ConnectionHandlerTest, FindListenerByAddress) {
   EXPECT_CALL(*listener3, onDestroy());
 }
 
+TEST_F(ConnectionHandlerTest, DisableListeners) {
+  InSequence s;
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _)).WillOnce(Return(listener));
+  handler_->addListener(factory_, socket_, stats_store_, 1,
+                        Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  EXPECT_CALL(*listener, disable());
+  handler_->disableListeners();
+
+  // Listeners added while disabled start out disabled.
+  Network::MockListener* listener2 = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _)).WillOnce(Return(listener2));
+  EXPECT_CALL(*listener2, disable());
+  handler_->addListener(factory_, socket_, stats_store_, 2,
+                        Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  EXPECT_CALL(*listener, enable());
+  EXPECT_CALL(*listener2, enable());
+  handler_->enableListeners();
+}
+
+TEST_F(ConnectionHandlerTest, ConnectionBudgetExhausted) {
+  InSequence s;
+
+  ConnectionBudget budget(1);
+  handler_.reset(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, nullptr, &budget));
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _, _))
+      .WillOnce(Invoke([&](Network::ConnectionHandler&, Network::ListenSocket&,
+                           Network::ListenerCallbacks& cb, Stats::Scope&,
+                           const Network::ListenerOptions&) -> Network::Listener* {
+        listener_callbacks = &cb;
+        return listener;
+
+      }));
+  handler_->addListener(factory_, socket_, stats_store_, 1,
+                        Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(factory_, createFilterChain(_)).WillOnce(Return(true));
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  // The budget is spent, so the next accept is shed before any filter chain is created.
+  Network::MockConnection* rejected = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(*rejected, close(Network::ConnectionCloseType::NoFlush));
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{rejected});
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_EQ(1UL, stats_store_.counter("downstream_cx_overflow").value());
+
+  // Closing the first connection returns its permit, making room for another accept.
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(0UL, handler_->numConnections());
+
+  Network::MockConnection* connection2 = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(factory_, createFilterChain(_)).WillOnce(Return(true));
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection2});
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_EQ(1UL, stats_store_.counter("downstream_cx_overflow").value());
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
 } // namespace Server
 } // namespace Envoy
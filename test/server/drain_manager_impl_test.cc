@@ -9,6 +9,7 @@
 
 using testing::InSequence;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::SaveArg;
 using testing::_;
 
@@ -57,5 +58,46 @@ TEST(DrainManagerImplTest, All) {
   EXPECT_TRUE(drain_manager.drainClose());
 }
 
+TEST(DrainManagerImplTest, ConnectionPacedDrain) {
+  NiceMock<MockInstance> server;
+  ON_CALL(server.options_, drainTime()).WillByDefault(Return(std::chrono::seconds(100)));
+  uint64_t connections = 1000;
+  ON_CALL(server.listener_manager_, numConnections()).WillByDefault(ReturnPointee(&connections));
+
+  DrainManagerImpl drain_manager(server);
+  Event::MockTimer* drain_timer = new Event::MockTimer(&server.dispatcher_);
+  drain_manager.startDrainSequence([]() -> void {});
+
+  // 1000 connections over 100s means a 10 connections/sec target. After the first tick we are
+  // 10 connections over the 990 target, so 1% of requests should drain.
+  ON_CALL(server.random_, random()).WillByDefault(Return(100));
+  EXPECT_FALSE(drain_manager.drainClose());
+  ON_CALL(server.random_, random()).WillByDefault(Return(99));
+  EXPECT_TRUE(drain_manager.drainClose());
+
+  // At or ahead of the target no connections are drained, even for a losing roll.
+  connections = 980;
+  drain_timer->callback_();
+  ON_CALL(server.random_, random()).WillByDefault(Return(0));
+  EXPECT_FALSE(drain_manager.drainClose());
+
+  // A runtime rate override takes precedence over the computed rate. 100 connections/sec after
+  // 3 ticks targets 700 remaining; 280 of the remaining 980 should drain (28%).
+  ON_CALL(server.runtime_loader_.snapshot_,
+          getInteger("drain_manager.target_connections_per_sec", 0))
+      .WillByDefault(Return(100));
+  drain_timer->callback_();
+  ON_CALL(server.random_, random()).WillByDefault(Return(2857));
+  EXPECT_FALSE(drain_manager.drainClose());
+  ON_CALL(server.random_, random()).WillByDefault(Return(2856));
+  EXPECT_TRUE(drain_manager.drainClose());
+
+  // Once no connections remain everything drains.
+  connections = 0;
+  drain_timer->callback_();
+  ON_CALL(server.random_, random()).WillByDefault(Return(9999));
+  EXPECT_TRUE(drain_manager.drainClose());
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -160,6 +160,8 @@ TEST_F(GuardDogMissTest, MissTest) {
   mock_time_ += 250;
   gd.forceCheckForTest();
   EXPECT_EQ(1UL, stats_store_.counter("server.watchdog_miss").value());
+  // The per thread counter identifies which thread missed.
+  EXPECT_EQ(1UL, stats_store_.counter("server.watchdog_miss.thread_0").value());
   gd.stopWatching(unpet_dog);
   unpet_dog = nullptr;
 }
@@ -182,10 +184,27 @@ TEST_F(GuardDogMissTest, MegaMissTest) {
   mock_time_ += 2;
   gd.forceCheckForTest();
   EXPECT_EQ(1UL, stats_store_.counter("server.watchdog_mega_miss").value());
+  EXPECT_EQ(1UL, stats_store_.counter("server.watchdog_mega_miss.thread_0").value());
   gd.stopWatching(unpet_dog);
   unpet_dog = nullptr;
 }
 
+TEST_F(GuardDogMissTest, PerThreadMissTest) {
+  // Two watched threads where only one stops touching its dog: only that thread's counter
+  // increments.
+  GuardDogImpl gd(stats_store_, config_miss_, time_source_);
+  auto unpet_dog = gd.createWatchDog(0);
+  auto pet_dog = gd.createWatchDog(1);
+  mock_time_ += 501;
+  pet_dog->touch();
+  gd.forceCheckForTest();
+  EXPECT_EQ(1UL, stats_store_.counter("server.watchdog_miss").value());
+  EXPECT_EQ(1UL, stats_store_.counter("server.watchdog_miss.thread_0").value());
+  EXPECT_EQ(0UL, stats_store_.counter("server.watchdog_miss.thread_1").value());
+  gd.stopWatching(unpet_dog);
+  gd.stopWatching(pet_dog);
+}
+
 TEST_F(GuardDogMissTest, MissCountTest) {
   // This tests a flake discovered in the MissTest where real timeout or
   // spurious condition_variable wakeup causes the counter to get incremented
@@ -230,6 +249,18 @@ TEST_F(GuardDogMissTest, MissCountTest) {
   sometimes_pet_dog = nullptr;
 }
 
+TEST_F(GuardDogMissTest, MemoryReleaseTest) {
+  // Once the release interval has elapsed the guard dog thread refreshes the
+  // page heap gauges and releases free memory. In builds without tcmalloc the
+  // values are always zero, but the gauges are written either way.
+  GuardDogImpl gd(stats_store_, config_miss_, time_source_);
+  EXPECT_FALSE(stats_store_.gauge("server.memory_pageheap_free").used());
+  mock_time_ += 10000;
+  gd.forceCheckForTest();
+  EXPECT_TRUE(stats_store_.gauge("server.memory_pageheap_free").used());
+  EXPECT_TRUE(stats_store_.gauge("server.memory_pageheap_unmapped").used());
+}
+
 TEST(GuardDogBasicTest, StartStopTest) {
   NiceMock<Stats::MockStore> stats;
   NiceMock<Configuration::MockMain> config(0, 0, 0, 0);
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <unordered_map>
 
 #include "common/http/message_impl.h"
 #include "common/profiler/profiler.h"
@@ -61,6 +62,15 @@ TEST_P(AdminFilterTest, Trailers) {
   filter_.decodeTrailers(request_headers_);
 }
 
+TEST_P(AdminFilterTest, ChunkedClusters) {
+  // /clusters streams: headers go out without end_stream, and with no clusters configured the
+  // first chunk is also the last.
+  Http::TestHeaderMapImpl request_headers{{":path", "/clusters"}};
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  filter_.decodeHeaders(request_headers, true);
+}
+
 class AdminInstanceTest : public testing::TestWithParam<Network::Address::IpVersion> {
 public:
   AdminInstanceTest()
@@ -93,6 +103,18 @@ TEST_P(AdminInstanceTest, AdminProfiler) {
   EXPECT_FALSE(Profiler::Cpu::profilerEnabled());
 }
 
+TEST_P(AdminInstanceTest, AdminHeapProfiler) {
+  Buffer::OwnedImpl data;
+  admin_.runCallback("/heapprofiler?enable=y", data);
+  EXPECT_TRUE(Profiler::Heap::profilerEnabled());
+
+  // Disabling returns the profile itself rather than "OK".
+  Buffer::OwnedImpl profile;
+  admin_.runCallback("/heapprofiler?enable=n", profile);
+  EXPECT_FALSE(Profiler::Heap::profilerEnabled());
+  EXPECT_NE("OK\n", TestUtility::bufferToString(profile));
+}
+
 #endif
 
 TEST_P(AdminInstanceTest, AdminBadProfiler) {
@@ -104,6 +126,20 @@ TEST_P(AdminInstanceTest, AdminBadProfiler) {
   EXPECT_FALSE(Profiler::Cpu::profilerEnabled());
 }
 
+TEST_P(AdminInstanceTest, RuntimeModify) {
+  // Without query parameters the handler prints usage and fails.
+  Buffer::OwnedImpl usage;
+  EXPECT_EQ(Http::Code::BadRequest, admin_.runCallback("/runtime_modify", usage));
+
+  std::unordered_map<std::string, std::string> overrides;
+  overrides["foo"] = "bar";
+  overrides["x"] = "42";
+  EXPECT_CALL(server_.runtime_loader_, mergeValues(overrides));
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/runtime_modify?foo=bar&x=42", response));
+  EXPECT_EQ("OK\n", TestUtility::bufferToString(response));
+}
+
 TEST_P(AdminInstanceTest, WriteAddressToFile) {
   std::ifstream address_file(address_out_path_);
   std::string address_from_file;
@@ -119,6 +155,60 @@ TEST_P(AdminInstanceTest, AdminBadAddressOutPath) {
   EXPECT_FALSE(std::ifstream(bad_path));
 }
 
+TEST_P(AdminInstanceTest, StatsSortedOutput) {
+  server_.stats_store_.counter("foo.bar").add(5);
+  server_.stats_store_.gauge("baz").set(7);
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/stats", response));
+  const std::string output = TestUtility::bufferToString(response);
+  EXPECT_NE(std::string::npos, output.find("baz: 7\n"));
+  EXPECT_NE(std::string::npos, output.find("foo.bar: 5\n"));
+  EXPECT_LT(output.find("baz: 7\n"), output.find("foo.bar: 5\n"));
+}
+
+TEST_P(AdminInstanceTest, StatsFilteredOutput) {
+  server_.stats_store_.counter("foo.bar").add(5);
+  server_.stats_store_.counter("foo.baz"); // Created but never written to, so not "used".
+  server_.stats_store_.gauge("qux").set(7);
+
+  // Prefix narrowing.
+  Buffer::OwnedImpl prefix_response;
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/stats?prefix=foo.", prefix_response));
+  std::string output = TestUtility::bufferToString(prefix_response);
+  EXPECT_NE(std::string::npos, output.find("foo.bar: 5\n"));
+  EXPECT_NE(std::string::npos, output.find("foo.baz: 0\n"));
+  EXPECT_EQ(std::string::npos, output.find("qux"));
+
+  // Regex narrowing.
+  Buffer::OwnedImpl regex_response;
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/stats?filter=bar$", regex_response));
+  output = TestUtility::bufferToString(regex_response);
+  EXPECT_NE(std::string::npos, output.find("foo.bar: 5\n"));
+  EXPECT_EQ(std::string::npos, output.find("foo.baz"));
+  EXPECT_EQ(std::string::npos, output.find("qux"));
+
+  // Only stats that have been written to.
+  Buffer::OwnedImpl used_response;
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/stats?prefix=foo.&usedonly", used_response));
+  output = TestUtility::bufferToString(used_response);
+  EXPECT_NE(std::string::npos, output.find("foo.bar: 5\n"));
+  EXPECT_EQ(std::string::npos, output.find("foo.baz"));
+
+  // A malformed regex is a client error.
+  Buffer::OwnedImpl bad_regex_response;
+  EXPECT_EQ(Http::Code::BadRequest, admin_.runCallback("/stats?filter=*", bad_regex_response));
+}
+
+TEST_P(AdminInstanceTest, PrometheusStats) {
+  server_.stats_store_.counter("foo.bar").add(5);
+  server_.stats_store_.gauge("baz-qux").set(7);
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/stats/prometheus", response));
+  const std::string output = TestUtility::bufferToString(response);
+  EXPECT_NE(std::string::npos, output.find("# TYPE envoy_foo_bar counter\nenvoy_foo_bar 5\n"));
+  EXPECT_NE(std::string::npos, output.find("# TYPE envoy_baz_qux gauge\nenvoy_baz_qux 7\n"));
+}
+
 TEST_P(AdminInstanceTest, CustomHandler) {
   auto callback = [&](const std::string&, Buffer::Instance&) -> Http::Code {
     return Http::Code::Accepted;
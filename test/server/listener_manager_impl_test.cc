@@ -421,6 +421,62 @@ TEST_F(ListenerManagerImplTest, AddOrUpdateListener) {
   EXPECT_CALL(*listener_baz_update1, onDestroy());
 }
 
+TEST_F(ListenerManagerImplTest, FilterOnlyUpdateDoesNotDrainConnections) {
+  InSequence s;
+
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+
+  // Add foo listener.
+  const std::string listener_foo_json = R"EOF(
+  {
+    "name": "foo",
+    "address": "tcp://127.0.0.1:1234",
+    "filters": []
+  }
+  )EOF";
+
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, true));
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json)));
+  worker_->callAddCompletion(true);
+
+  // Update foo with a filter config change only. The old listener still goes through the normal
+  // drain machinery but its connections are not told to close.
+  const std::string listener_foo_update1_json = R"EOF(
+  {
+    "name": "foo",
+    "address": "tcp://127.0.0.1:1234",
+    "filters": [
+      { "type" : "read", "name" : "fake", "config" : {} }
+    ]
+  }
+  )EOF";
+
+  ListenerHandle* listener_foo_update1 = expectListenerCreate(false);
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_CALL(*worker_, stopListener(_));
+  EXPECT_CALL(*listener_foo->drain_manager_, startDrainSequence(_));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_update1_json)));
+  worker_->callAddCompletion(true);
+  EXPECT_EQ(
+      1UL, server_.stats_store_.counter("listener_manager.listener_in_place_updated").value());
+
+  // The retired listener bypasses its local drain manager; only the server wide drain decision
+  // applies to its connections.
+  EXPECT_CALL(*listener_foo->drain_manager_, drainClose()).Times(0);
+  EXPECT_CALL(server_.drain_manager_, drainClose()).WillOnce(Return(false));
+  EXPECT_FALSE(listener_foo->context_->drainDecision().drainClose());
+
+  EXPECT_CALL(*worker_, removeListener(_, _));
+  listener_foo->drain_manager_->drain_sequence_completion_();
+  EXPECT_CALL(*listener_foo, onDestroy());
+  worker_->callRemovalCompletion();
+
+  EXPECT_CALL(*listener_foo_update1, onDestroy());
+}
+
 TEST_F(ListenerManagerImplTest, AddDrainingListener) {
   InSequence s;
 
@@ -470,6 +526,53 @@ TEST_F(ListenerManagerImplTest, AddDrainingListener) {
   EXPECT_CALL(*listener_foo2, onDestroy());
 }
 
+TEST_F(ListenerManagerImplTest, AdoptPassedConnection) {
+  InSequence s;
+
+  Network::Address::InstanceConstSharedPtr connection_local_address(
+      new Network::Address::Ipv4Instance("127.0.0.1", 1234));
+  Network::Address::InstanceConstSharedPtr connection_remote_address(
+      new Network::Address::Ipv4Instance("10.0.0.3", 50000));
+
+  // Nothing can be adopted before the workers have started.
+  EXPECT_FALSE(
+      manager_->adoptPassedConnection(-1, connection_local_address, connection_remote_address));
+
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+
+  const std::string listener_foo_json = R"EOF(
+  {
+    "name": "foo",
+    "address": "tcp://127.0.0.1:1234",
+    "filters": []
+  }
+  )EOF";
+
+  Network::Address::InstanceConstSharedPtr local_address(
+      new Network::Address::Ipv4Instance("127.0.0.1", 1234));
+  ON_CALL(*listener_factory_.socket_, localAddress()).WillByDefault(Return(local_address));
+
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, true));
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json)));
+  worker_->callAddCompletion(true);
+
+  // A connection whose local address matches an active listener goes to a worker.
+  EXPECT_CALL(*worker_, addPassedConnection(10, _, _));
+  EXPECT_TRUE(
+      manager_->adoptPassedConnection(10, connection_local_address, connection_remote_address));
+
+  // No listener on this port, so the caller keeps the socket.
+  Network::Address::InstanceConstSharedPtr other_local_address(
+      new Network::Address::Ipv4Instance("127.0.0.1", 4321));
+  EXPECT_FALSE(
+      manager_->adoptPassedConnection(10, other_local_address, connection_remote_address));
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
 TEST_F(ListenerManagerImplTest, CantBindSocket) {
   InSequence s;
 
@@ -699,5 +802,35 @@ TEST_F(ListenerManagerImplTest, DuplicateAddressDontBind) {
   EXPECT_CALL(*listener_foo, onDestroy());
 }
 
+TEST_F(ListenerManagerImplTest, ReusePortSocketPerWorker) {
+  InSequence s;
+
+  // Build a new manager with 2 workers and per-worker SO_REUSEPORT sockets enabled.
+  ON_CALL(server_.options_, reusePort()).WillByDefault(Return(true));
+  ON_CALL(server_.options_, concurrency()).WillByDefault(Return(2));
+  MockWorker* worker1 = new MockWorker();
+  MockWorker* worker2 = new MockWorker();
+  EXPECT_CALL(worker_factory_, createWorker_())
+      .WillOnce(Return(worker1))
+      .WillOnce(Return(worker2));
+  ListenerManagerImpl manager(server_, listener_factory_, worker_factory_);
+
+  const std::string listener_foo_json = R"EOF(
+  {
+    "name": "foo",
+    "address": "tcp://127.0.0.1:1234",
+    "filters": []
+  }
+  )EOF";
+
+  // One socket is created per worker, all bound to the same address.
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, true)).Times(2);
+  EXPECT_TRUE(manager.addOrUpdateListener(parseListenerFromJson(listener_foo_json)));
+  EXPECT_EQ(1UL, manager.listeners().size());
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
 } // namespace Server
 } // namespace Envoy
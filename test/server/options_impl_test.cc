@@ -40,13 +40,24 @@ TEST(OptionsImplTest, All) {
       "envoy --mode validate --concurrency 2 -c hello --admin-address-path path --restart-epoch 1 "
       "--local-address-ip-version v6 -l info --service-cluster cluster --service-node node "
       "--service-zone zone --file-flush-interval-msec 9000 --drain-time-s 60 "
-      "--parent-shutdown-time-s 90");
+      "--parent-shutdown-time-s 90 --reuse-port --tcp-fastopen-queue-length 256 "
+      "--defer-accept-timeout-seconds 5 "
+      "--exact-connection-balance --max-accepts-per-second 500 --max-connections 50000 "
+      "--dedicated-health-check-thread --worker-cpu-affinity 0,2,4");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
   EXPECT_EQ("hello", options->configPath());
   EXPECT_EQ("path", options->adminAddressPath());
   EXPECT_EQ(Network::Address::IpVersion::v6, options->localAddressIpVersion());
   EXPECT_EQ(1U, options->restartEpoch());
+  EXPECT_TRUE(options->reusePort());
+  EXPECT_EQ(256U, options->tcpFastOpenQueueLength());
+  EXPECT_EQ(5U, options->deferAcceptTimeoutSeconds());
+  EXPECT_TRUE(options->exactConnectionBalance());
+  EXPECT_EQ(500U, options->maxAcceptsPerSecond());
+  EXPECT_EQ(50000U, options->maxConnections());
+  EXPECT_TRUE(options->dedicatedHealthCheckThread());
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 4}), options->workerCpuAffinity());
   EXPECT_EQ(spdlog::level::info, options->logLevel());
   EXPECT_EQ("cluster", options->serviceClusterName());
   EXPECT_EQ("node", options->serviceNodeName());
@@ -63,6 +74,19 @@ TEST(OptionsImplTest, DefaultParams) {
   EXPECT_EQ("", options->adminAddressPath());
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
+  EXPECT_FALSE(options->reusePort());
+  EXPECT_EQ(0U, options->tcpFastOpenQueueLength());
+  EXPECT_EQ(0U, options->deferAcceptTimeoutSeconds());
+  EXPECT_FALSE(options->exactConnectionBalance());
+  EXPECT_EQ(0U, options->maxAcceptsPerSecond());
+  EXPECT_EQ(0U, options->maxConnections());
+  EXPECT_FALSE(options->dedicatedHealthCheckThread());
+  EXPECT_TRUE(options->workerCpuAffinity().empty());
+}
+
+TEST(OptionsImplDeathTest, InvalidWorkerCpuAffinity) {
+  EXPECT_EXIT(createOptionsImpl("envoy -c hello --worker-cpu-affinity 0,blah"),
+              testing::ExitedWithCode(1), "invalid CPU id 'blah'");
 }
 
 TEST(OptionsImplTest, BadCliOption) {
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <chrono>
+
+#include "server/overload_monitor.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Server {
+
+class OverloadMonitorTest : public testing::Test {
+protected:
+  OverloadMonitorTest() : mock_time_(0), timer_(new Event::MockTimer(&dispatcher_)) {
+    ON_CALL(time_source_, currentTime()).WillByDefault(testing::Invoke([this]() {
+      return std::chrono::steady_clock::time_point(std::chrono::milliseconds(mock_time_));
+    }));
+  }
+
+  // Run one sample with the given extra scheduling delay beyond the sample interval.
+  void sample(uint64_t delay_ms) {
+    mock_time_ += OverloadMonitor::SampleInterval.count() + delay_ms;
+    timer_->callback_();
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Network::MockConnectionHandler> handler_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  std::atomic<uint64_t> mock_time_;
+  Event::MockTimer* timer_;
+};
+
+TEST_F(OverloadMonitorTest, NoSheddingWhenOnTime) {
+  OverloadMonitor monitor(dispatcher_, handler_, time_source_);
+  EXPECT_CALL(handler_, disableListeners()).Times(0);
+  for (int i = 0; i < 10; i++) {
+    sample(0);
+  }
+  EXPECT_FALSE(monitor.isShedding());
+}
+
+TEST_F(OverloadMonitorTest, ShedsAndRecovers) {
+  OverloadMonitor monitor(dispatcher_, handler_, time_source_);
+
+  // Consecutive delayed samples trip the high watermark.
+  EXPECT_CALL(handler_, disableListeners());
+  int i = 0;
+  while (!monitor.isShedding()) {
+    ASSERT_LT(i++, 100);
+    sample(400);
+  }
+
+  // A longer run of on time samples resumes accepting.
+  EXPECT_CALL(handler_, enableListeners());
+  i = 0;
+  while (monitor.isShedding()) {
+    ASSERT_LT(i++, 100);
+    sample(0);
+  }
+}
+
+TEST_F(OverloadMonitorTest, SingleSpikeDoesNotShed) {
+  OverloadMonitor monitor(dispatcher_, handler_, time_source_);
+  EXPECT_CALL(handler_, disableListeners()).Times(0);
+  // One long stall followed by on time samples resets the consecutive sample count.
+  sample(300);
+  for (int i = 0; i < 10; i++) {
+    sample(0);
+  }
+  EXPECT_FALSE(monitor.isShedding());
+}
+
+} // namespace Server
+} // namespace Envoy
@@ -26,14 +26,28 @@ TEST(ServerInstanceUtil, flushHelper) {
   store.counter("hello").inc();
   store.gauge("world").set(5);
   std::unique_ptr<Stats::MockSink> sink(new StrictMock<Stats::MockSink>());
-  EXPECT_CALL(*sink, beginFlush());
-  EXPECT_CALL(*sink, flushCounter("hello", 1));
-  EXPECT_CALL(*sink, flushGauge("world", 5));
-  EXPECT_CALL(*sink, endFlush());
+  Stats::MockSink& sink_ref = *sink;
+  EXPECT_CALL(sink_ref, beginFlush());
+  EXPECT_CALL(sink_ref, flushCounter("hello", 1));
+  EXPECT_CALL(sink_ref, flushGauge("world", 5));
+  EXPECT_CALL(sink_ref, endFlush());
 
   std::list<Stats::SinkPtr> sinks;
   sinks.emplace_back(std::move(sink));
   InstanceUtil::flushCountersAndGaugesToSinks(sinks, store);
+
+  // A second flush with no intervening activity delivers nothing: the counter has no delta and
+  // the gauge has not changed.
+  EXPECT_CALL(sink_ref, beginFlush());
+  EXPECT_CALL(sink_ref, endFlush());
+  InstanceUtil::flushCountersAndGaugesToSinks(sinks, store);
+
+  // Only the changed stat is delivered on the next flush.
+  store.gauge("world").set(6);
+  EXPECT_CALL(sink_ref, beginFlush());
+  EXPECT_CALL(sink_ref, flushGauge("world", 6));
+  EXPECT_CALL(sink_ref, endFlush());
+  InstanceUtil::flushCountersAndGaugesToSinks(sinks, store);
 }
 
 class RunHelperTest : public testing::Test {
@@ -1,4 +1,5 @@
 #include "common/event/dispatcher_impl.h"
+#include "common/stats/stats_impl.h"
 
 #include "server/worker_impl.h"
 
@@ -28,12 +29,17 @@ public:
   }
 
   NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl stats_store_;
   Event::DispatcherImpl* dispatcher_ = new Event::DispatcherImpl();
   Network::MockConnectionHandler* handler_ = new Network::MockConnectionHandler();
   NiceMock<MockGuardDog> guard_dog_;
   DefaultTestHooks hooks_;
-  WorkerImpl worker_{tls_, hooks_, Event::DispatcherPtr{dispatcher_},
-                     Network::ConnectionHandlerPtr{handler_}};
+  WorkerImpl worker_{tls_,
+                     hooks_,
+                     stats_store_.createScope("server.worker_0."),
+                     Event::DispatcherPtr{dispatcher_},
+                     Network::ConnectionHandlerPtr{handler_},
+                     0};
   Event::TimerPtr no_exit_timer_ = dispatcher_->createTimer([]() -> void {});
 };
 
@@ -113,6 +119,20 @@ TEST_F(WorkerImplTest, BasicFlow) {
   worker_.stop();
 }
 
+TEST_F(WorkerImplTest, CpuAffinity) {
+  // A pinned worker publishes its CPU assignment in its stats scope when the thread starts, even
+  // if the pin itself fails.
+  Event::DispatcherImpl* dispatcher = new Event::DispatcherImpl();
+  WorkerImpl worker(tls_, hooks_, stats_store_.createScope("server.worker_1."),
+                    Event::DispatcherPtr{dispatcher},
+                    Network::ConnectionHandlerPtr{new Network::MockConnectionHandler()}, 1,
+                    Optional<uint32_t>(0));
+  worker.start(guard_dog_);
+  worker.stop();
+  EXPECT_TRUE(stats_store_.gauge("server.worker_1.cpu").used());
+  EXPECT_EQ(0UL, stats_store_.gauge("server.worker_1.cpu").value());
+}
+
 TEST_F(WorkerImplTest, ListenerException) {
   InSequence s;
 